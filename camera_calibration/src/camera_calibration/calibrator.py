@@ -32,12 +32,15 @@
 # ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 # POSSIBILITY OF SUCH DAMAGE.
 
+from concurrent.futures import ThreadPoolExecutor
 from io import BytesIO
 import cv2
 import cv_bridge
+import hashlib
 import image_geometry
 import math
 import numpy.linalg
+import os
 import pickle
 import random
 import sensor_msgs.msg
@@ -106,6 +109,47 @@ class ChessboardInfo():
                     self.n_cols, self.n_rows, self.dim, self.marker_size, self.aruco_dict)
 
 
+class CornerCache():
+    """
+    Calibration target detections of images, keyed by the pixels of each image and the
+    detection settings, kept in a file so that calibrating again from the same images
+    skips detection. The file is a pickle, only load ones you wrote.
+    """
+
+    def __init__(self, filename):
+        self.filename = filename
+        self.changed = False
+        try:
+            with open(filename, 'rb') as f:
+                self.detections = pickle.load(f)
+        except (OSError, EOFError, pickle.UnpicklingError):
+            self.detections = {}
+
+    @staticmethod
+    def key(settings, img):
+        digest = hashlib.sha1(settings.encode())
+        digest.update(repr((img.shape, img.dtype.str)).encode())
+        digest.update(numpy.ascontiguousarray(img).data)
+        return digest.hexdigest()
+
+    def get(self, key):
+        return self.detections.get(key)
+
+    def put(self, key, detection):
+        self.detections[key] = detection
+        self.changed = True
+
+    def save(self):
+        if not self.changed:
+            return
+        # Written aside and moved over, so an interrupted save leaves the old cache
+        tmp = self.filename + '.tmp'
+        with open(tmp, 'wb') as f:
+            pickle.dump(self.detections, f)
+        os.replace(tmp, self.filename)
+        self.changed = False
+
+
 # Make all private!!!!!
 def lmin(seq1, seq2):
     """ Pairwise minimum of two sequences """
@@ -291,6 +335,39 @@ def _get_corners(img, board, refine=True, checkerboard_flags=0):
     return (ok, corners)
 
 
+def _get_corners_in_roi(img, board, roi, checkerboard_flags=0):
+    """
+    Get corners for a chessboard searched only in the region (x, y, w, h) of an image,
+    in the coordinates of the whole image. Fast check is always used, so a board that
+    left the region is given up on quickly.
+    """
+    (x, y, w, h) = roi
+    (ok, corners) = _get_corners(img[y:y + h, x:x + w], board, True,
+                                 checkerboard_flags | cv2.CALIB_CB_FAST_CHECK)
+    if ok:
+        corners[:, :, 0] += x
+        corners[:, :, 1] += y
+    return (ok, corners)
+
+
+def _get_corners_roi(corners, shape, margin=0.5):
+    """
+    Region (x, y, w, h) around the corners of a detected chessboard to search the next
+    frame in, grown by margin times the size of the board on every side so it still
+    holds a board that moved. None if that is most of the image anyway.
+    """
+    (x0, y0) = corners.min(axis=(0, 1))
+    (x1, y1) = corners.max(axis=(0, 1))
+    grow = margin * max(x1 - x0, y1 - y0) + 16
+    x0 = max(int(x0 - grow), 0)
+    y0 = max(int(y0 - grow), 0)
+    x1 = min(int(math.ceil(x1 + grow)), shape[1])
+    y1 = min(int(math.ceil(y1 + grow)), shape[0])
+    if (x1 - x0) * (y1 - y0) > 0.75 * shape[0] * shape[1]:
+        return None
+    return (x0, y0, x1 - x0, y1 - y0)
+
+
 def _get_charuco_corners(img, board, refine):
     """
     Get chessboard corners from image of ChArUco board
@@ -369,7 +446,8 @@ class Calibrator():
     """
 
     def __init__(self, boards, flags=0, fisheye_flags=0, pattern=Patterns.Chessboard, name='',
-                 checkerboard_flags=cv2.CALIB_CB_FAST_CHECK, max_chessboard_speed=-1.0):
+                 checkerboard_flags=cv2.CALIB_CB_FAST_CHECK, max_chessboard_speed=-1.0,
+                 workers=1, corner_cache=None):
         # Ordering the dimensions for the different detectors is actually a minefield...
         if pattern == Patterns.Chessboard:
             # Make sure n_cols > n_rows to agree with OpenCV CB detector output
@@ -409,6 +487,17 @@ class Calibrator():
         self.last_frame_corners = None
         self.last_frame_ids = None
         self.max_chessboard_speed = max_chessboard_speed
+        # Board and region of the downsampled image each tracked stream ('left', 'right', ...)
+        # last had a chessboard detected in, searched first in its next frame
+        self._tracked_boards = {}
+        # Detects in the right image of a stereo pair while the calling thread does the left
+        # one. OpenCV releases the GIL, so both run at once
+        self._detect_pool = ThreadPoolExecutor(max_workers=1)
+        # Threads detecting the images of a batch calibration, and solving the cameras of a
+        # stereo pair at once
+        self.workers = max(1, workers)
+        # File of a CornerCache for the detections of batch calibrations, or None
+        self.corner_cache = corner_cache
 
     def mkgray(self, msg):
         """
@@ -586,7 +675,50 @@ class Calibrator():
                 return (ok, corners, ids, b)
         return (False, None, None, None)
 
-    def downsample_and_detect(self, img):
+    def map_workers(self, function, items):
+        """
+        List of function applied to every item, on the worker threads if there are
+        several. OpenCV releases the GIL, so its functions run at once.
+        """
+        if self.workers == 1 or len(items) < 2:
+            return [function(i) for i in items]
+        with ThreadPoolExecutor(max_workers=self.workers) as pool:
+            return list(pool.map(function, items))
+
+    def detect_all(self, detect, images, method):
+        """
+        Run detect, returning (corners, ids, board) with corners None where no target is
+        found, on all the images, looking them up in the corner cache if there is one.
+        method names what detect does, so cached detections of another one are not used.
+
+        Returns [ (corners, ids, board) ]
+        """
+        if self.corner_cache is None:
+            return self.map_workers(detect, images)
+
+        cache = CornerCache(self.corner_cache)
+        settings = repr((method, self.pattern, self.checkerboard_flags, [
+            (b.pattern, b.n_cols, b.n_rows, b.dim, b.marker_size) for b in self._boards]))
+
+        def cached_detect(img):
+            key = CornerCache.key(settings, img)
+            cached = cache.get(key)
+            if cached is not None:
+                (corners, ids, index) = cached
+                return (corners, ids, None if index is None else self._boards[index])
+            (corners, ids, board) = detect(img)
+            # Boards are stored by their position in the list, as given on the command line
+            index = None
+            if board is not None:
+                index = next(i for (i, b) in enumerate(self._boards) if b is board)
+            cache.put(key, (corners, ids, index))
+            return (corners, ids, board)
+
+        detections = self.map_workers(cached_detect, images)
+        cache.save()
+        return detections
+
+    def downsample_and_detect(self, img, track=None):
         """
         Downsample the input image to approximately VGA resolution and detect the
         calibration target corners in the full-size image.
@@ -595,6 +727,10 @@ class Calibrator():
         detection is too expensive on large images, so it's better to do detection on
         the smaller display image and scale the corners back up to the correct size.
 
+        If track names a stream of consecutive frames, a chessboard is first searched
+        around where it was found in the previous frame of that stream, and in the whole
+        image only if it is not there.
+
         Returns (scrib, corners, downsampled_corners, ids, board, (x_scale, y_scale)).
         """
         # Scale the input image down to ~VGA size
@@ -610,9 +746,23 @@ class Calibrator():
         y_scale = float(height) / scrib.shape[0]
 
         if self.pattern == Patterns.Chessboard:
-            # Detect checkerboard
-            (ok, downsampled_corners, ids, board) = self.get_corners(
-                scrib, refine=True)
+            # Detect checkerboard, first where the stream last had it
+            ok = False
+            tracked = self._tracked_boards.get(track) if track is not None else None
+            if tracked is not None:
+                (board, roi) = tracked
+                (ok, downsampled_corners) = _get_corners_in_roi(
+                    scrib, board, roi, self.checkerboard_flags)
+                ids = None
+            if not ok:
+                (ok, downsampled_corners, ids, board) = self.get_corners(
+                    scrib, refine=True)
+            if track is not None:
+                self._tracked_boards[track] = None
+                if ok:
+                    roi = _get_corners_roi(downsampled_corners, scrib.shape)
+                    if roi is not None:
+                        self._tracked_boards[track] = (board, roi)
 
             # Scale corners back to full size image
             corners = None
@@ -831,9 +981,13 @@ class MonoCalibrator(Calibrator):
         Return [ (corners, ids, ChessboardInfo) ]
         """
         self.size = (images[0].shape[1], images[0].shape[0])
-        corners = [self.get_corners(i) for i in images]
 
-        goodcorners = [(co, ids, b) for (ok, co, ids, b) in corners if ok]
+        def detect(img):
+            (ok, corners, ids, board) = self.get_corners(img)
+            return (corners if ok else None, ids, board)
+        corners = self.detect_all(detect, images, 'get_corners')
+
+        goodcorners = [(co, ids, b) for (co, ids, b) in corners if co is not None]
         if not goodcorners:
             raise CalibrationException("No corners found in images!")
         return goodcorners
@@ -1050,7 +1204,7 @@ class MonoCalibrator(Calibrator):
 
         # Get display-image-to-be (scrib) and detection of the calibration target
         scrib_mono, corners, downsampled_corners, ids, board, (
-            x_scale, y_scale) = self.downsample_and_detect(gray)
+            x_scale, y_scale) = self.downsample_and_detect(gray, track='mono')
 
         if self.calibrated:
             # Show rectified image
@@ -1206,14 +1360,12 @@ class StereoCalibrator(Calibrator):
         left and right have a chessboard, and return  their corners as a list of pairs.
         """
         # Pick out (corners, ids, board) tuples
-        lcorners = []
-        rcorners = []
-        for img in limages:
+        def detect(img):
             (_, corners, _, ids, board, _) = self.downsample_and_detect(img)
-            lcorners.append((corners, ids, board))
-        for img in rimages:
-            (_, corners, _, ids, board, _) = self.downsample_and_detect(img)
-            rcorners.append((corners, ids, board))
+            return (corners, ids, board)
+        corners = self.detect_all(detect, list(limages) + list(rimages), 'downsample_and_detect')
+        lcorners = corners[:len(limages)]
+        rcorners = corners[len(limages):]
 
         good = [(lco, rco, lid, rid, b) for ((lco, lid, b), (rco, rid, br))
                 in zip(lcorners, rcorners) if (lco is not None and rco is not None)]
@@ -1226,8 +1378,14 @@ class StereoCalibrator(Calibrator):
         # Perform monocular calibrations
         lcorners = [(lco, lid, b) for (lco, rco, lid, rid, b) in good]
         rcorners = [(rco, rid, b) for (lco, rco, lid, rid, b) in good]
-        self.l.cal_fromcorners(lcorners)
-        self.r.cal_fromcorners(rcorners)
+        if self.workers > 1:
+            with ThreadPoolExecutor(max_workers=1) as pool:
+                right = pool.submit(self.r.cal_fromcorners, rcorners)
+                self.l.cal_fromcorners(lcorners)
+                right.result()
+        else:
+            self.l.cal_fromcorners(lcorners)
+            self.r.cal_fromcorners(rcorners)
 
         (lipts, ripts, _, _, boards) = zip(*good)
 
@@ -1458,15 +1616,17 @@ class StereoCalibrator(Calibrator):
     def handle_msg(self, msg):
         # TODO Various asserts that images have same dimension, same board detected...
         (lmsg, rmsg) = msg
-        lgray = self.mkgray(lmsg)
-        rgray = self.mkgray(rmsg)
         epierror = -1
 
-        # Get display-images-to-be and detections of the calibration target
-        lscrib_mono, lcorners, ldownsampled_corners, lids, lboard, (
-            x_scale, y_scale) = self.downsample_and_detect(lgray)
-        rscrib_mono, rcorners, rdownsampled_corners, rids, rboard, _ = self.downsample_and_detect(
-            rgray)
+        def detect(msg, track):
+            gray = self.mkgray(msg)
+            return (gray, self.downsample_and_detect(gray, track=track))
+
+        # Get display-images-to-be and detections of the calibration target, both at once
+        right = self._detect_pool.submit(detect, rmsg, 'right')
+        (lgray, (lscrib_mono, lcorners, ldownsampled_corners, lids, lboard, (
+            x_scale, y_scale))) = detect(lmsg, 'left')
+        (rgray, (rscrib_mono, rcorners, rdownsampled_corners, rids, rboard, _)) = right.result()
 
         if self.calibrated:
             # Show rectified images
@@ -96,7 +96,7 @@ class CalibrationNode(Node):
     def __init__(self, name, boards, service_check=True,
                  synchronizer=message_filters.TimeSynchronizer, flags=0, fisheye_flags=0,
                  pattern=Patterns.Chessboard, camera_name='', checkerboard_flags=0,
-                 max_chessboard_speed=-1, queue_size=1):
+                 max_chessboard_speed=-1, queue_size=1, workers=1):
         super().__init__(name)
 
         self.set_camera_info_service = self.create_client(
@@ -130,6 +130,7 @@ class CalibrationNode(Node):
         self._pattern = pattern
         self._camera_name = camera_name
         self._max_chessboard_speed = max_chessboard_speed
+        self._workers = workers
         lsub = message_filters.Subscriber(
             self, sensor_msgs.msg.Image, 'left', qos_profile=self.get_topic_qos("left"))
         rsub = message_filters.Subscriber(
@@ -174,12 +175,12 @@ class CalibrationNode(Node):
                 self.c = MonoCalibrator(
                     self._boards, self._calib_flags, self._fisheye_calib_flags, self._pattern,
                     name=self._camera_name, checkerboard_flags=self._checkerboard_flags,
-                    max_chessboard_speed=self._max_chessboard_speed)
+                    max_chessboard_speed=self._max_chessboard_speed, workers=self._workers)
             else:
                 self.c = MonoCalibrator(
                     self._boards, self._calib_flags, self._fisheye_calib_flags, self._pattern,
                     checkerboard_flags=self._checkerboard_flags,
-                    max_chessboard_speed=self._max_chessboard_speed)
+                    max_chessboard_speed=self._max_chessboard_speed, workers=self._workers)
 
         # This should just call the MonoCalibrator
         drawable = self.c.handle_msg(msg)
@@ -192,12 +193,12 @@ class CalibrationNode(Node):
                 self.c = StereoCalibrator(
                     self._boards, self._calib_flags, self._fisheye_calib_flags, self._pattern,
                     name=self._camera_name, checkerboard_flags=self._checkerboard_flags,
-                    max_chessboard_speed=self._max_chessboard_speed)
+                    max_chessboard_speed=self._max_chessboard_speed, workers=self._workers)
             else:
                 self.c = StereoCalibrator(
                     self._boards, self._calib_flags, self._fisheye_calib_flags, self._pattern,
                     checkerboard_flags=self._checkerboard_flags,
-                    max_chessboard_speed=self._max_chessboard_speed)
+                    max_chessboard_speed=self._max_chessboard_speed, workers=self._workers)
 
         drawable = self.c.handle_msg(msg)
         self.displaywidth = drawable.lscrib.shape[1] + drawable.rscrib.shape[1]
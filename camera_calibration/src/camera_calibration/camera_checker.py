@@ -32,6 +32,7 @@
 # ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 # POSSIBILITY OF SUCH DAMAGE.
 
+from concurrent.futures import ThreadPoolExecutor
 import cv2
 import cv_bridge
 import functools
@@ -46,11 +47,6 @@ import threading
 from camera_calibration.calibrator import MonoCalibrator, StereoCalibrator, ChessboardInfo
 from message_filters import ApproximateTimeSynchronizer
 
-try:
-    from queue import Queue
-except ImportError:
-    from Queue import Queue
-
 
 def mean(seq):
     return sum(seq) / len(seq)
@@ -66,23 +62,9 @@ def lmax(seq1, seq2):
     return [max(a, b) for (a, b) in zip(seq1, seq2)]
 
 
-class ConsumerThread(threading.Thread):
-    def __init__(self, queue, function):
-        threading.Thread.__init__(self)
-        self.queue = queue
-        self.function = function
-
-    def run(self):
-        while rclpy.ok():
-            m = self.queue.get()
-            if self.queue.empty():
-                break
-        self.function(m)
-
-
 class CameraCheckerNode(Node):
 
-    def __init__(self, name, chess_size, dim, approximate=0):
+    def __init__(self, name, chess_size, dim, approximate=0, workers=1):
         super().__init__(name)
         self.board = ChessboardInfo()
         self.board.n_cols = chess_size[0]
@@ -129,25 +111,34 @@ class CameraCheckerNode(Node):
 
         self.br = cv_bridge.CvBridge()
 
-        self.q_mono = Queue()
-        self.q_stereo = Queue()
-
-        mth = ConsumerThread(self.q_mono, self.handle_monocular)
-        mth.setDaemon(True)
-        mth.start()
-
-        sth = ConsumerThread(self.q_stereo, self.handle_stereo)
-        sth.setDaemon(True)
-        sth.start()
+        # Frames are checked on a pool of workers, and dropped while all of them are busy
+        self.workers = max(1, workers)
+        self.pool = ThreadPoolExecutor(max_workers=self.workers)
+        self.in_flight = 0
+        self.in_flight_lock = threading.Lock()
 
         self.mc = MonoCalibrator([self.board])
         self.sc = StereoCalibrator([self.board])
 
     def queue_monocular(self, msg, cmsg):
-        self.q_mono.put((msg, cmsg))
+        self.submit(self.handle_monocular, (msg, cmsg))
 
     def queue_stereo(self, lmsg, lcmsg, rmsg, rcmsg):
-        self.q_stereo.put((lmsg, lcmsg, rmsg, rcmsg))
+        self.submit(self.handle_stereo, (lmsg, lcmsg, rmsg, rcmsg))
+
+    def submit(self, function, msg):
+        with self.in_flight_lock:
+            if self.in_flight == self.workers:
+                return
+            self.in_flight += 1
+
+        def run():
+            try:
+                function(msg)
+            finally:
+                with self.in_flight_lock:
+                    self.in_flight -= 1
+        self.pool.submit(run)
 
     def mkgray(self, msg):
         return self.mc.mkgray(msg)
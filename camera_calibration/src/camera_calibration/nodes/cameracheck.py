@@ -46,6 +46,8 @@ def main():
     parser.add_option(
         "--approximate", type="float", default=0.0,
         help="allow specified slop (in seconds) when pairing images from unsynchronized stereo cameras")
+    parser.add_option("--workers", type="int", default=1,
+                      help="frames checked at once, newer ones are dropped meanwhile [default: %default]")
 
     options, _ = parser.parse_args(rclpy.utilities.remove_ros_args())
     rclpy.init()
@@ -53,7 +55,7 @@ def main():
     size = tuple([int(c) for c in options.size.split('x')])
     dim = float(options.square)
     approximate = float(options.approximate)
-    node = CameraCheckerNode("cameracheck", size, dim, approximate)
+    node = CameraCheckerNode("cameracheck", size, dim, approximate, options.workers)
     rclpy.spin(node)
 
 
@@ -56,11 +56,14 @@ def display(win_name, img):
 
 
 def cal_from_tarfile(
-        boards, tarname, mono=False, upload=False, calib_flags=0, visualize=False, alpha=1.0):
+        boards, tarname, mono=False, upload=False, calib_flags=0, visualize=False, alpha=1.0,
+        workers=1, corner_cache=None):
     if mono:
-        calibrator = MonoCalibrator(boards, calib_flags)
+        calibrator = MonoCalibrator(boards, calib_flags, workers=workers,
+                                    corner_cache=corner_cache)
     else:
-        calibrator = StereoCalibrator(boards, calib_flags)
+        calibrator = StereoCalibrator(boards, calib_flags, workers=workers,
+                                      corner_cache=corner_cache)
 
     calibrator.do_tarfile_calibration(tarname)
 
@@ -190,6 +193,11 @@ def main():
         "-a", "--alpha", type="float", default=1.0, metavar="ALPHA",
         help="zoom for visualization of rectifies images. Ranges from 0 (zoomed in, all pixels in calibrated image are valid) to 1 (zoomed out, all pixels in  original image are in calibrated image). default %default)")
 
+    parser.add_option("--workers", type="int", default=1,
+                      help="threads detecting the calibration target in the images [default: %default]")
+    parser.add_option("--corner-cache", default=None, metavar="FILE",
+                      help="file keeping the detections, to skip them when calibrating again from the same images")
+
     options, args = parser.parse_args()
 
     if len(options.size) != len(options.square):
@@ -245,7 +253,8 @@ def main():
         calib_flags |= cv2.CALIB_FIX_K1
 
     cal_from_tarfile(boards, tarname, options.mono, options.upload,
-                     calib_flags, options.visualize, options.alpha)
+                     calib_flags, options.visualize, options.alpha,
+                     options.workers, options.corner_cache)
 
 
 if __name__ == '__main__':
@@ -34,12 +34,16 @@
 #define DEPTH_IMAGE_PROC__CONVERSIONS_HPP_
 
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "image_geometry/pinhole_camera_model.hpp"
 
 #include <opencv2/core/mat.hpp>
+#include <opencv2/core/matx.hpp>
 
 #include <depth_image_proc/depth_traits.hpp>
+#include <depth_image_proc/radial_table.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
@@ -47,6 +51,106 @@
 namespace depth_image_proc
 {
 
+// Per-column and per-row ray coefficients of a pinhole camera model. A depth
+// image is converted by scaling the cached coefficients by each depth, instead
+// of recomputing (u - cx) / fx for every pixel.
+class DepthRayLut
+{
+public:
+  // Rebuilds the table if the model or image size changed, returns true if it did.
+  // Pixel (u, v) of a downsampled image is given the ray of the full resolution
+  // pixel (u * factor + offset, v * factor + offset).
+  bool update(
+    const image_geometry::PinholeCameraModel & model, int width, int height,
+    int factor = 1, double offset = 0.0);
+
+  // Table for the same model, size and downsampling, shared with every other
+  // user of them in this process through image_proc::CameraCache. It is built
+  // on first use.
+  static std::shared_ptr<const DepthRayLut> get(
+    const image_geometry::PinholeCameraModel & model, int width, int height,
+    int factor = 1, double offset = 0.0);
+
+  int width() const {return static_cast<int>(x_.size());}
+  int height() const {return static_cast<int>(y_.size());}
+
+  // (u - cx) / fx for every column
+  const float * x() const {return x_.data();}
+  // (v - cy) / fy for every row
+  const float * y() const {return y_.data();}
+
+private:
+  std::vector<float> x_;
+  std::vector<float> y_;
+  double fx_ = 0.0;
+  double fy_ = 0.0;
+  double cx_ = 0.0;
+  double cy_ = 0.0;
+  int factor_ = 1;
+  double offset_ = 0.0;
+};
+
+// Where every depth pixel takes its color from in an RGB image, possibly of
+// another resolution. Depth pixel (u, v) samples RGB pixel (u / ratio,
+// v / ratio), ratio being depth width / RGB width as the point cloud nodes
+// scale the camera model by, so the color lookup of a frame is a plain gather.
+class ColorSampling
+{
+public:
+  // Rebuilds the tables if a size, the RGB row step or color_step (bytes per
+  // RGB pixel) changed. Returns false if the RGB image does not cover the
+  // depth image at that ratio, in which case the tables must not be used.
+  bool update(
+    int depth_width, int depth_height, const sensor_msgs::msg::Image & rgb_msg,
+    int color_step);
+
+  // Byte offset in the RGB data of the row sampled by every depth row
+  const size_t * rows() const {return rows_.data();}
+  // Byte offset in an RGB row of the pixel sampled by every depth column
+  const uint32_t * columns() const {return columns_.data();}
+
+private:
+  std::vector<size_t> rows_;
+  std::vector<uint32_t> columns_;
+  uint32_t rgb_width_ = 0;
+  uint32_t rgb_height_ = 0;
+  uint32_t rgb_step_ = 0;
+  int color_step_ = 0;
+  bool covered_ = false;
+};
+
+// Handles float or uint16 depths. Fast path of convertDepth for clouds whose
+// x, y and z are consecutive float fields, writing them directly with SIMD
+// kernels over bands of rows in parallel. lut must match the image size.
+// Given a transform, the points are moved into its frame in the same pass:
+// the point of depth d on ray r is d * (R * r) + t, at the cost of a few
+// multiply-adds per point.
+template<typename T>
+void convertDepth(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth = 0.0,
+  const cv::Matx34f * transform = nullptr);
+
+// Rectifies uint16 (mm) or float (m) depths through the fixed-point maps of
+// image_proc::RectificationMaps into float meters, NaN where invalid, in one
+// pass over bands of rows in parallel. Depths are never interpolated: every
+// pixel takes the source depth nearest to where the maps send it or, with
+// min_filter, the closest valid one of the four around it. rect_msg gets the
+// size, encoding, step and data, the header is up to the caller. Given a
+// cloud_msg of the rectified size, its x, y and z are filled from every
+// rectified row while it is still in cache, lut matching the rectified image.
+template<typename T>
+void rectifyDepth(
+  const sensor_msgs::msg::Image & raw_msg, const cv::Mat & map1, const cv::Mat & map2,
+  bool min_filter, sensor_msgs::msg::Image & rect_msg,
+  const DepthRayLut * lut = nullptr, sensor_msgs::msg::PointCloud2 * cloud_msg = nullptr);
+
+// Moves the FLOAT32 x, y and z of every point of cloud_msg by transform, for
+// clouds not built by the fused kernels such as the voxel ones
+void transformPoints(sensor_msgs::msg::PointCloud2 & cloud_msg, const cv::Matx34f & transform);
+
 // Handles float or uint16 depths
 template<typename T>
 void convertDepth(
@@ -99,6 +203,15 @@ void convertDepth(
   }
 }
 
+// Handles float or uint16 depths. Fast path of convertDepthRadial, with the
+// same requirements as the DepthRayLut overload of convertDepth. table must
+// match the image size.
+template<typename T>
+void convertDepthRadial(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const RadialTable & table);
+
 // Handles float or uint16 depths
 template<typename T>
 void convertDepthRadial(
@@ -149,12 +262,48 @@ void convertIntensity(
   }
 }
 
-// Handles RGB8, BGR8, and MONO8
+// Handles float or uint16 depths, and uint8, uint16 or float intensities of
+// the size of the depth image. Fills x, y, z and intensity of every point in a
+// single pass over bands of rows in parallel, storing whole xyzi points at a
+// time when they are the only fields. Same requirements as the DepthRayLut
+// overload of convertDepth.
+template<typename T, typename I>
+void convertDepthIntensity(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth = 0.0);
+
+// Handles RGB8, BGR8, and MONO8. The RGB image must have the size of the cloud.
 void convertRgb(
   const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
-  sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
   int red_offset, int green_offset, int blue_offset, int color_step);
 
+// Same, for an RGB image of any size sampled through an updated sampling,
+// over bands of rows in parallel
+void convertRgb(
+  const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const ColorSampling & sampling,
+  int red_offset, int green_offset, int blue_offset);
+
+// Handles float or uint16 depths. Fills x, y, z and rgb of every point in a
+// single pass over the rows, gathering the colors through sampling while the
+// points of the row are still in cache. Same requirements as the DepthRayLut
+// overload of convertDepth, plus an updated sampling, and the same optional
+// transform.
+template<typename T>
+void convertDepthRgb(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut, const ColorSampling & sampling,
+  int red_offset, int green_offset, int blue_offset,
+  double invalid_depth = 0.0,
+  const cv::Matx34f * transform = nullptr);
+
 cv::Mat initMatrix(cv::Mat cameraMatrix, cv::Mat distCoeffs, int width, int height, bool radial);
 
 }  // namespace depth_image_proc
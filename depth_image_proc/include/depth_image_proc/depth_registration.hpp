@@ -0,0 +1,216 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef DEPTH_IMAGE_PROC__DEPTH_REGISTRATION_HPP_
+#define DEPTH_IMAGE_PROC__DEPTH_REGISTRATION_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Eigen/Geometry"
+#include "tf2_msgs/msg/tf_message.hpp"
+#include "tf2_ros/buffer.h"
+#include "tf2_ros/transform_listener.h"
+
+#include <opencv2/core/matx.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <std_msgs/msg/header.hpp>
+
+namespace depth_image_proc
+{
+
+// Looks up transforms between two frames with tf2. With static_transforms the
+// transform is looked up once and again only when /tf_static changes, instead
+// of at the time stamp of every frame. The registration nodes use it for the
+// depth to RGB extrinsic, the point cloud nodes to move their clouds into a
+// target frame.
+class StaticTransformCache
+{
+public:
+  StaticTransformCache(rclcpp::Node & node, bool static_transforms);
+
+  // Returns false and logs an error if no transform is available
+  bool lookup(
+    const sensor_msgs::msg::CameraInfo & depth_info,
+    const sensor_msgs::msg::CameraInfo & rgb_info,
+    Eigen::Affine3d & depth_to_rgb);
+
+  // Transform from the frame of source to target_frame, as the 3x4 matrix the
+  // point cloud kernels take
+  bool lookup(
+    const std_msgs::msg::Header & source, const std::string & target_frame,
+    cv::Matx34f & transform);
+
+private:
+  rclcpp::Logger logger_;
+  bool static_;
+  std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::shared_ptr<tf2_ros::TransformListener> tf_;
+  rclcpp::Subscription<tf2_msgs::msg::TFMessage>::SharedPtr sub_tf_static_;
+
+  // Transform kept with static_transforms, and its frames
+  Eigen::Affine3d transform_;
+  std::string frames_;
+  std::atomic<bool> stale_{true};
+
+  bool lookupFrames(
+    const std_msgs::msg::Header & source, const std::string & target_frame,
+    Eigen::Affine3d & transform);
+};
+
+// Key of a transform looked up for a cloud, 0 if null, for the change
+// detection of the nodes (see image_proc::ChangeDetection)
+uint64_t hashTransform(const cv::Matx34f * transform);
+
+// Projection of the depth pixel (u, v) with depth d to homogeneous RGB image
+// coordinates, d * (column[u] + row[v]) + offset. This folds reprojection,
+// the depth to RGB transform and the RGB projection into one 3x4 matrix on
+// (d, 1), split into per-column and per-row terms. The last coordinate is
+// the depth in the RGB frame.
+struct DepthToRgbProjection
+{
+  std::vector<float> column_x, column_y, column_z;
+  std::vector<float> row_x, row_y, row_z;
+  float offset_x, offset_y, offset_z;
+};
+
+// Depth image registered to the RGB camera, as the z-buffer the depths were
+// projected into. Every registration fills one of its own, so that
+// registrations do not share any state besides the projection.
+class RegisteredDepth
+{
+public:
+  // Sizes the z-buffer to width x height, with nothing projected to it
+  void reset(int width, int height);
+
+  int width() const {return width_;}
+  int height() const {return height_;}
+
+  // Registered depth in meters of pixel i, NaN if nothing was projected to it
+  float depth(size_t i) const
+  {
+    const uint32_t key = z_buffer_[i].load(std::memory_order_relaxed);
+    if (key == kEmptyDepth) {
+      return std::numeric_limits<float>::quiet_NaN();
+    }
+    float z;
+    std::memcpy(&z, &key, sizeof(z));
+    return z;
+  }
+
+  // Writes the registered depths into an image of the RGB resolution, leaving
+  // the pixels nothing was projected to untouched
+  template<typename T>
+  void write(sensor_msgs::msg::Image & registered_msg) const;
+
+  // Z-buffer holding the bits of float depths, row after row
+  std::atomic<uint32_t> * zBuffer() {return z_buffer_.get();}
+
+private:
+  // Z-buffer value of pixels nothing was projected to
+  static constexpr uint32_t kEmptyDepth = UINT32_MAX;
+
+  std::unique_ptr<std::atomic<uint32_t>[]> z_buffer_;
+  int width_ = 0;
+  int height_ = 0;
+};
+
+// Z-buffered reprojection of depth images into the RGB camera. The projection
+// is cached and rebuilt only when the calibrations or the transform change.
+class DepthRegistration
+{
+public:
+  // Rebuilds the projection if its inputs changed, returns true if it did
+  bool update(
+    const sensor_msgs::msg::CameraInfo & depth_info,
+    const sensor_msgs::msg::CameraInfo & rgb_info,
+    const Eigen::Affine3d & depth_to_rgb);
+
+  // Size of the depth images the projection expects
+  int depthWidth() const {return static_cast<int>(projection_.column_x.size());}
+  int depthHeight() const {return static_cast<int>(projection_.row_x.size());}
+
+  // Size of the registered image, the RGB resolution
+  int width() const {return width_;}
+  int height() const {return height_;}
+
+  const DepthToRgbProjection & projection() const {return projection_;}
+
+  // Handles float or uint16 depths. Projects every depth pixel to the RGB
+  // pixel it lands on into registered, keeping the nearest depth.
+  template<typename T>
+  void registerPoints(
+    const sensor_msgs::msg::Image & depth_msg, RegisteredDepth & registered) const;
+
+  // Handles float or uint16 depths. Rasterizes the two triangles between
+  // every four neighbouring depth pixels into registered, skipping those whose
+  // depth range exceeds max_depth_discontinuity relative to their nearest vertex.
+  template<typename T>
+  void registerTriangles(
+    const sensor_msgs::msg::Image & depth_msg, double max_depth_discontinuity,
+    RegisteredDepth & registered) const;
+
+private:
+  DepthToRgbProjection projection_;
+  int width_ = 0;
+  int height_ = 0;
+
+  // What the projection was built from
+  bool has_projection_ = false;
+  sensor_msgs::msg::CameraInfo depth_info_;
+  sensor_msgs::msg::CameraInfo rgb_info_;
+  Eigen::Affine3d depth_to_rgb_;
+
+  // Depth pixels projected to the RGB image, z is NaN for invalid pixels.
+  // Built by every registerTriangles call for itself.
+  struct Vertices
+  {
+    std::vector<float> u, v, z;
+  };
+
+  void rasterizeTriangle(
+    const Vertices & vertices, int a, int b, int c, int tile_begin, int tile_end,
+    float max_depth_discontinuity, std::atomic<uint32_t> * z_buffer) const;
+};
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__DEPTH_REGISTRATION_HPP_
@@ -0,0 +1,91 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DEPTH_IMAGE_PROC__DEPTH_TO_SCAN_HPP_
+#define DEPTH_IMAGE_PROC__DEPTH_TO_SCAN_HPP_
+
+#include <vector>
+
+#include <depth_image_proc/conversions.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace depth_image_proc
+{
+
+// Where every column of a depth image falls in a virtual laser scan, in a
+// frame with x forward and y to the left of the camera. Column u is the ray at
+// angle -atan((u - cx) / fx), and the bins are spaced by the mean angle
+// between neighbouring columns from the rightmost column to the leftmost.
+// Columns are wider in angle near the optical axis than at the edges, so a
+// bin no column rounds to takes the range of the column nearest to it.
+class ScanLayout
+{
+public:
+  // Rebuilds the layout from the per-column rays of lut
+  void update(const DepthRayLut & lut);
+
+  int width() const {return static_cast<int>(bin_.size());}
+  int bins() const {return static_cast<int>(bin_count_);}
+  float angleMin() const {return angle_min_;}
+  float angleMax() const {return angle_max_;}
+  float angleIncrement() const {return angle_increment_;}
+
+  // Bin of every column
+  const int * bin() const {return bin_.data();}
+  // Column nearest to the angle of every bin
+  const int * nearest() const {return nearest_.data();}
+  // sqrt(1 + ((u - cx) / fx)^2) for every column, the range in the scan
+  // plane of a point at depth 1
+  const float * scale() const {return scale_.data();}
+
+private:
+  std::vector<int> bin_;
+  std::vector<int> nearest_;
+  std::vector<float> scale_;
+  size_t bin_count_ = 0;
+  float angle_min_ = 0.0f;
+  float angle_max_ = 0.0f;
+  float angle_increment_ = 0.0f;
+};
+
+// Reduces rows [first_row, first_row + rows) of a 16UC1 or 32FC1 depth image
+// to the ranges of a scan laid out by layout: the smallest range from range_min
+// to range_max of every bin. As in REP 117, a bin without one is -inf if a
+// valid depth is closer than range_min and +inf otherwise. Returns false for
+// other encodings, or a layout of another width.
+bool depthToScan(
+  const sensor_msgs::msg::Image & depth_msg, int first_row, int rows,
+  const ScanLayout & layout, float range_min, float range_max, std::vector<float> & ranges);
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__DEPTH_TO_SCAN_HPP_
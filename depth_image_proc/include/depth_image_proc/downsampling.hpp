@@ -0,0 +1,128 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef DEPTH_IMAGE_PROC__DOWNSAMPLING_HPP_
+#define DEPTH_IMAGE_PROC__DOWNSAMPLING_HPP_
+
+#include "depth_image_proc/conversions.hpp"
+
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace depth_image_proc
+{
+
+// How the point cloud nodes thin out points before building the cloud, and
+// how DecimateNode pools depth blocks
+enum class DownsampleMode
+{
+  NONE,
+  // Every factor-th pixel in both directions
+  STRIDE,
+  // Nearest valid depth of every factor x factor block
+  MIN,
+  // Median of the valid depths of every block, the lower one of an even count
+  MEDIAN,
+  // Valid depth closest to the center of every block
+  NEAREST,
+  // Centroid of the points in every voxel_size cube
+  VOXEL,
+};
+
+struct Downsampling
+{
+  DownsampleMode mode = DownsampleMode::NONE;
+  int factor = 2;
+  // Edge length in meters of the voxels
+  double voxel_size = 0.05;
+
+  // Whether a downsampled pixel stands for its whole block rather than its
+  // top left pixel
+  bool pooled() const
+  {
+    return mode == DownsampleMode::MIN || mode == DownsampleMode::MEDIAN ||
+           mode == DownsampleMode::NEAREST;
+  }
+  // Full resolution offset of the pixel whose ray a downsampled pixel uses
+  double rayOffset() const {return pooled() ? 0.5 * (factor - 1) : 0.0;}
+  // Full resolution offset of the pixel a downsampled pixel takes its color from
+  int sampleOffset() const {return pooled() ? factor / 2 : 0;}
+};
+
+// Declares the downsample, downsample_factor and voxel_size parameters
+Downsampling declareDownsamplingParameters(rclcpp::Node & node);
+
+// Handles float or uint16 depths. Reduces depth_msg by the STRIDE, MIN,
+// MEDIAN or NEAREST factor in both directions, dropping partial blocks at the
+// right and bottom borders. Blocks without a valid depth come out invalid.
+// Returns false for other encodings.
+bool downsampleDepth(
+  const sensor_msgs::msg::Image & depth_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::Image & reduced_msg);
+
+// Camera info matching the images of downsampleDepth: the size, K, P and ROI
+// are divided by the factor, and the principal point is moved to account for
+// the pixel every block stands for.
+void downsampleCameraInfo(
+  const sensor_msgs::msg::CameraInfo & info_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::CameraInfo & reduced_msg);
+
+// Keeps the pixels of an image of any encoding at the same places as
+// downsampleDepth, one per factor x factor block
+void downsampleImage(
+  const sensor_msgs::msg::Image & image_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::Image & reduced_msg);
+
+// Handles float or uint16 depths. Builds an unorganized xyz cloud holding the
+// centroid of the points of every voxel, straight from the depth image. The
+// full resolution cloud is never built. lut must match the image size.
+template<typename T>
+void voxelizeDepth(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+// Same as voxelizeDepth, additionally averaging the colors of the points in
+// every voxel into an rgb field. rgb_msg must have the size of the depth
+// image, with color_step bytes per pixel.
+template<typename T>
+void voxelizeDepth(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  const sensor_msgs::msg::Image & rgb_msg,
+  int red_offset, int green_offset, int blue_offset, int color_step,
+  sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__DOWNSAMPLING_HPP_
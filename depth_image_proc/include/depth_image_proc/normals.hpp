@@ -0,0 +1,64 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DEPTH_IMAGE_PROC__NORMALS_HPP_
+#define DEPTH_IMAGE_PROC__NORMALS_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace depth_image_proc
+{
+
+// Surface normals of an organized cloud, from its neighbouring pixels rather
+// than from a nearest neighbour search. The points are averaged over
+// (2 * radius + 1) pixel boxes, summed with running box filters, and the
+// normal of a pixel is the cross product of the differences between the
+// averages radius pixels to its left and right, and above and below.
+struct NormalEstimation
+{
+  // Half the edge of the averaging boxes, in pixels
+  int radius = 3;
+  // Largest depth change between the averages a normal is taken across,
+  // relative to the depth of the pixel. Larger jumps are object boundaries.
+  float max_depth_change = 0.05f;
+};
+
+// Fills the FLOAT32 normal_x, normal_y and normal_z fields of every point of
+// an organized cloud from its FLOAT32 x, y and z, with normals pointing
+// towards the camera. Normals are NaN for invalid points, near boundaries and
+// within 2 * radius pixels of the image edges.
+void computeNormals(
+  const NormalEstimation & estimation, sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__NORMALS_HPP_
@@ -0,0 +1,102 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DEPTH_IMAGE_PROC__POINT_CLOUD_OUTPUT_HPP_
+#define DEPTH_IMAGE_PROC__POINT_CLOUD_OUTPUT_HPP_
+
+#include <string>
+
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace depth_image_proc
+{
+
+// Layout of the published point coordinates
+enum class PointFormat
+{
+  // FLOAT32 coordinates with the usual alignment padding
+  FLOAT32,
+  // INT16 fixed point coordinates, without padding
+  INT16,
+};
+
+// Output options shared by the point cloud nodes
+struct PointCloudOutput
+{
+  PointFormat format = PointFormat::FLOAT32;
+  // Meters per count of INT16 coordinates
+  double quantization_scale = 0.001;
+  // Publish only the valid points, as an unorganized cloud
+  bool dense = false;
+  // Add the pixel coordinates of every point to dense clouds
+  bool dense_uv = false;
+};
+
+// Declares the output_format, quantization_scale, dense and dense_uv parameters
+PointCloudOutput declarePointCloudOutputParameters(rclcpp::Node & node);
+
+// Cloud to publish for cloud_msg in the requested output format. cloud_msg is
+// returned as is when it needs no conversion.
+sensor_msgs::msg::PointCloud2::SharedPtr finishPointCloud(
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const PointCloudOutput & output);
+
+// Copies the points of the organized cloud with a finite z into a single row,
+// optionally adding their UINT16 column and row as u and v fields. Rows are
+// counted and then copied in parallel bands, each band writing at an offset
+// given by the prefix sum of the counts.
+void compactPointCloud(
+  const sensor_msgs::msg::PointCloud2 & cloud, bool add_uv,
+  sensor_msgs::msg::PointCloud2 & dense);
+
+// Repacks the FLOAT32 x, y and z fields of cloud as INT16 counts of scale
+// meters and drops all padding. Other fields are copied unchanged. Invalid and
+// out of range coordinates are stored as the smallest INT16 value.
+//
+// The scale travels in the field names, "x*0.001" for x in millimeters, so
+// that a consumer reading "x" as meters finds no such field rather than
+// points a thousand times too far. parseQuantizedField reads it back.
+void quantizePointCloud(
+  const sensor_msgs::msg::PointCloud2 & cloud, double scale,
+  sensor_msgs::msg::PointCloud2 & quantized);
+
+// Name of the quantized field of axis, in counts of scale meters
+std::string quantizedFieldName(const std::string & axis, double scale);
+
+// Splits the name of a quantized field into its axis and scale, returns false
+// for the name of any other field
+bool parseQuantizedField(const std::string & name, std::string & axis, double & scale);
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__POINT_CLOUD_OUTPUT_HPP_
@@ -33,15 +33,29 @@
 #ifndef DEPTH_IMAGE_PROC__POINT_CLOUD_XYZ_HPP_
 #define DEPTH_IMAGE_PROC__POINT_CLOUD_XYZ_HPP_
 
+#include <memory>
 #include <mutex>
+#include <string>
 
+#include "depth_image_proc/depth_registration.hpp"
+#include "depth_image_proc/downsampling.hpp"
 #include "depth_image_proc/visibility.h"
+#include "depth_image_proc/point_cloud_output.hpp"
 #include "image_geometry/pinhole_camera_model.hpp"
+#include "message_filters/subscriber.hpp"
+#include "message_filters/synchronizer.hpp"
+#include "message_filters/sync_policies/exact_time.hpp"
 
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_transport/image_transport.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <depth_image_proc/conversions.hpp>
@@ -62,23 +76,80 @@ private:
   using PointCloud2 = sensor_msgs::msg::PointCloud2;
   using Image = sensor_msgs::msg::Image;
   using CameraInfo = sensor_msgs::msg::CameraInfo;
+  using CompressedImage = sensor_msgs::msg::CompressedImage;
 
   // Subscriptions
   image_transport::CameraSubscriber sub_depth_;
   int queue_size_;
 
+  // RVL compressed depth and its camera info, decoded here when rvl is set
+  bool rvl_;
+  message_filters::Subscriber<CompressedImage> sub_rvl_;
+  message_filters::Subscriber<CameraInfo> sub_rvl_info_;
+  using RvlSyncPolicy = message_filters::sync_policies::ExactTime<CompressedImage, CameraInfo>;
+  std::shared_ptr<message_filters::Synchronizer<RvlSyncPolicy>> rvl_sync_;
+
   // Parameters
   double invalid_depth_;
 
+  // Frame the clouds are published in, the camera frame if empty, and the
+  // lookup of the transform the points are moved by as they are made
+  std::string target_frame_;
+  std::unique_ptr<StaticTransformCache> target_transform_;
+
   // Publications
   std::mutex connect_mutex_;
   rclcpp::Publisher<PointCloud2>::SharedPtr pub_point_cloud_;
+  PointCloudOutput output_;
+  PointCloud2 cloud_layout_;
+  Downsampling downsampling_;
 
-  image_geometry::PinholeCameraModel model_;
+  // Latest model and lookup table, held so that they stay in the caches.
+  // Guarded by state_mutex_ as frames may be converted at once
+  std::mutex state_mutex_;
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model_;
+  std::shared_ptr<const DepthRayLut> ray_lut_;
+
+  void keepCameraState(
+    std::shared_ptr<const image_geometry::PinholeCameraModel> model,
+    std::shared_ptr<const DepthRayLut> ray_lut);
 
   void depthCb(
     const Image::ConstSharedPtr & depth_msg,
     const CameraInfo::ConstSharedPtr & info_msg);
+
+  // Transform into target_frame_ for the frame of header, null without a
+  // target frame. Returns false if the lookup failed.
+  bool lookupTargetTransform(
+    const std_msgs::msg::Header & header, std::shared_ptr<const cv::Matx34f> & transform);
+
+  void rvlCb(
+    const CompressedImage::ConstSharedPtr & rvl_msg,
+    const CameraInfo::ConstSharedPtr & info_msg);
+
+  // Returns false if no cloud was published and kept for the frame
+  bool convert(
+    const Image::ConstSharedPtr & depth_msg,
+    const CameraInfo::ConstSharedPtr & info_msg,
+    const std::shared_ptr<const cv::Matx34f> & transform,
+    image_proc::OrderedOutput::Ticket & ticket);
+
+  // Publish the last cloud again, for an unchanged frame
+  void republish(
+    const builtin_interfaces::msg::Time & stamp, image_proc::OrderedOutput::Ticket & ticket);
+
+  // Publish cloud, kept for unchanged frames if republishing
+  void publish(const PointCloud2::SharedPtr & cloud);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::ChangeDetection> change_;
+  image_proc::LastOutput<PointCloud2> last_cloud_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+
+  // Frames converted at once if concurrency > 1. Destroyed first, so no frame
+  // is left using the rest of the node
+  std::unique_ptr<image_proc::OrderedOutput> ordered_;
 };
 
 }  // namespace depth_image_proc
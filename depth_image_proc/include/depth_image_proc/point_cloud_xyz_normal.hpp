@@ -0,0 +1,111 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DEPTH_IMAGE_PROC__POINT_CLOUD_XYZ_NORMAL_HPP_
+#define DEPTH_IMAGE_PROC__POINT_CLOUD_XYZ_NORMAL_HPP_
+
+#include <memory>
+#include <mutex>
+
+#include "depth_image_proc/normals.hpp"
+#include "depth_image_proc/visibility.h"
+#include "depth_image_proc/point_cloud_output.hpp"
+#include "image_geometry/pinhole_camera_model.hpp"
+
+#include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
+#include <image_transport/image_transport.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <depth_image_proc/conversions.hpp>
+
+namespace depth_image_proc
+{
+
+class PointCloudXyzNormalNode : public rclcpp::Node
+{
+public:
+  DEPTH_IMAGE_PROC_PUBLIC PointCloudXyzNormalNode(const rclcpp::NodeOptions & options);
+
+private:
+  using PointCloud2 = sensor_msgs::msg::PointCloud2;
+  using Image = sensor_msgs::msg::Image;
+  using CameraInfo = sensor_msgs::msg::CameraInfo;
+
+  // Subscriptions
+  image_transport::CameraSubscriber sub_depth_;
+  int queue_size_;
+
+  // Parameters
+  NormalEstimation estimation_;
+
+  // Publications
+  std::mutex connect_mutex_;
+  rclcpp::Publisher<PointCloud2>::SharedPtr pub_point_cloud_;
+  PointCloudOutput output_;
+  PointCloud2 cloud_layout_;
+
+  // Latest model and lookup table, held so that they stay in the caches.
+  // Guarded by state_mutex_ as frames may be converted at once
+  std::mutex state_mutex_;
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model_;
+  std::shared_ptr<const DepthRayLut> ray_lut_;
+
+  void keepCameraState(
+    std::shared_ptr<const image_geometry::PinholeCameraModel> model,
+    std::shared_ptr<const DepthRayLut> ray_lut);
+
+  void depthCb(
+    const Image::ConstSharedPtr & depth_msg,
+    const CameraInfo::ConstSharedPtr & info_msg);
+
+  void convert(
+    const Image::ConstSharedPtr & depth_msg,
+    const CameraInfo::ConstSharedPtr & info_msg,
+    image_proc::OrderedOutput::Ticket & ticket);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+
+  // Frames converted at once if concurrency > 1. Destroyed first, so no frame
+  // is left using the rest of the node
+  std::unique_ptr<image_proc::OrderedOutput> ordered_;
+};
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__POINT_CLOUD_XYZ_NORMAL_HPP_
@@ -34,12 +34,18 @@
 #define DEPTH_IMAGE_PROC__POINT_CLOUD_XYZ_RADIAL_HPP_
 
 #include <array>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 #include "depth_image_proc/visibility.h"
+#include "depth_image_proc/point_cloud_output.hpp"
+#include "depth_image_proc/radial_table.hpp"
 #include "image_geometry/pinhole_camera_model.hpp"
 
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_transport/image_transport.hpp>
 #include <opencv2/core/mat.hpp>
 #include <rclcpp/rclcpp.hpp>
@@ -64,18 +70,19 @@ private:
   std::mutex connect_mutex_;
   using PointCloud = sensor_msgs::msg::PointCloud2;
   rclcpp::Publisher<PointCloud>::SharedPtr pub_point_cloud_;
+  PointCloudOutput output_;
+  PointCloud cloud_layout_;
 
-  std::vector<double> D_;
-  std::array<double, 9> K_;
-
-  uint32_t width_;
-  uint32_t height_;
-
-  cv::Mat transform_;
+  // Unprojection table, shared with the other radial nodes in the process
+  std::shared_ptr<const RadialTable> radial_table_;
 
   void depthCb(
     const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 }  // namespace depth_image_proc
@@ -36,12 +36,17 @@
 #include <memory>
 #include <mutex>
 
+#include "depth_image_proc/conversions.hpp"
 #include "depth_image_proc/visibility.h"
+#include "depth_image_proc/point_cloud_output.hpp"
 #include "image_geometry/pinhole_camera_model.hpp"
 #include "message_filters/subscriber.hpp"
 #include "message_filters/sync_policies/approximate_time.hpp"
 #include "message_filters/synchronizer.hpp"
 
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
@@ -77,13 +82,20 @@ private:
   // Publications
   std::mutex connect_mutex_;
   rclcpp::Publisher<PointCloud>::SharedPtr pub_point_cloud_;
+  PointCloudOutput output_;
+  PointCloud cloud_layout_;
 
-  image_geometry::PinholeCameraModel model_;
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model_;
+  std::shared_ptr<const DepthRayLut> ray_lut_;
 
   void imageCb(
     const Image::ConstSharedPtr & depth_msg,
     const Image::ConstSharedPtr & intensity_msg,
     const CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 }  // namespace depth_image_proc
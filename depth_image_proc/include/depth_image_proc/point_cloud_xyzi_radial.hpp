@@ -39,10 +39,15 @@
 #include <vector>
 
 #include "depth_image_proc/visibility.h"
+#include "depth_image_proc/point_cloud_output.hpp"
+#include "depth_image_proc/radial_table.hpp"
 #include "message_filters/subscriber.hpp"
 #include "message_filters/synchronizer.hpp"
 #include "message_filters/sync_policies/exact_time.hpp"
 
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <opencv2/core/mat.hpp>
 #include <rclcpp/rclcpp.hpp>
@@ -78,22 +83,23 @@ private:
   // Publications
   std::mutex connect_mutex_;
   rclcpp::Publisher<PointCloud>::SharedPtr pub_point_cloud_;
+  PointCloudOutput output_;
+  PointCloud cloud_layout_;
 
   using Synchronizer = message_filters::Synchronizer<SyncPolicy>;
   std::shared_ptr<Synchronizer> sync_;
 
-  std::vector<double> D_;
-  std::array<double, 9> K_;
-
-  uint32_t width_;
-  uint32_t height_;
-
-  cv::Mat transform_;
+  // Unprojection table, shared with the other radial nodes in the process
+  std::shared_ptr<const RadialTable> radial_table_;
 
   void imageCb(
     const Image::ConstSharedPtr & depth_msg,
     const Image::ConstSharedPtr & intensity_msg_in,
     const CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 }  // namespace depth_image_proc
@@ -39,6 +39,8 @@
 #include <vector>
 
 #include "depth_image_proc/visibility.h"
+#include "depth_image_proc/point_cloud_output.hpp"
+#include "depth_image_proc/radial_table.hpp"
 #include "image_geometry/pinhole_camera_model.hpp"
 #include "message_filters/subscriber.hpp"
 #include "message_filters/synchronizer.hpp"
@@ -47,6 +49,9 @@
 
 #include <opencv2/core/mat.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <sensor_msgs/image_encodings.hpp>
@@ -82,21 +87,23 @@ private:
   // Publications
   std::mutex connect_mutex_;
   rclcpp::Publisher<PointCloud2>::SharedPtr pub_point_cloud_;
+  PointCloudOutput output_;
+  PointCloud2 cloud_layout_;
 
-  std::vector<double> D_;
-  std::array<double, 9> K_;
+  // Unprojection table, shared with the other radial nodes in the process
+  std::shared_ptr<const RadialTable> radial_table_;
+  ColorSampling color_sampling_;
 
-  uint32_t width_;
-  uint32_t height_;
-
-  cv::Mat transform_;
-
-  image_geometry::PinholeCameraModel model_;
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model_;
 
   void imageCb(
     const Image::ConstSharedPtr & depth_msg,
     const Image::ConstSharedPtr & rgb_msg,
     const CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 }  // namespace depth_image_proc
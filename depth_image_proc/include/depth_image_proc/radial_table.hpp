@@ -0,0 +1,96 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DEPTH_IMAGE_PROC__RADIAL_TABLE_HPP_
+#define DEPTH_IMAGE_PROC__RADIAL_TABLE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace depth_image_proc
+{
+
+// Unit ray of every pixel of a distorted camera, scaled by the radial depth
+// to get a point. The table is stored as separate x, y and z float planes in
+// the same row-major order as the depth image.
+class RadialTable
+{
+public:
+  RadialTable(
+    const std::array<double, 9> & k, const std::vector<double> & d,
+    uint32_t width, uint32_t height);
+
+  // Table for the calibration in info, shared with every other user of the
+  // same calibration in this process through image_proc::CameraCache. It is
+  // built on first use, or mapped from the image_proc::MappedTables cache if
+  // that is on and an earlier run saved it.
+  static std::shared_ptr<const RadialTable> get(const sensor_msgs::msg::CameraInfo & info);
+
+  // Whether the table was built for the calibration in info
+  bool matches(const sensor_msgs::msg::CameraInfo & info) const;
+
+  uint32_t width() const {return width_;}
+  uint32_t height() const {return height_;}
+
+  const float * x(int v) const {return x_.ptr<float>(v);}
+  const float * y(int v) const {return y_.ptr<float>(v);}
+  const float * z(int v) const {return z_.ptr<float>(v);}
+
+private:
+  // Only sets the calibration, the planes are built or loaded by the caller
+  struct Empty {};
+  RadialTable(
+    const std::array<double, 9> & k, const std::vector<double> & d,
+    uint32_t width, uint32_t height, Empty);
+
+  void build();
+
+  std::array<double, 9> k_;
+  std::vector<double> d_;
+  uint32_t width_;
+  uint32_t height_;
+
+  cv::Mat x_;
+  cv::Mat y_;
+  cv::Mat z_;
+  // Holds the file the planes point into, if they were loaded
+  std::shared_ptr<const void> mapped_;
+};
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__RADIAL_TABLE_HPP_
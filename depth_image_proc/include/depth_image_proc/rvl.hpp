@@ -0,0 +1,72 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DEPTH_IMAGE_PROC__RVL_HPP_
+#define DEPTH_IMAGE_PROC__RVL_HPP_
+
+#include <string>
+
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace depth_image_proc
+{
+
+// Lossless compression of uint16 depth images after RVL (A. D. Wilson, "Fast
+// Lossless Depth Image Compression", ISS 2017): runs of invalid zero depths
+// alternate with runs of valid ones, stored as the zigzag coded difference to
+// the previous valid depth. Run lengths and differences are written in
+// nibbles of 3 bits of value and a continuation bit.
+//
+// The rows are split into bands coded independently, and concurrently, each
+// from a previous depth of 0. A compressed image is the little endian header
+// "RVL1", width, height, band count and the byte size of every band, as
+// uint32, followed by the bands.
+
+// Format of the CompressedImage messages holding RVL depth
+extern const char RVL_FORMAT[];
+
+// Compress a 16UC1 or mono16 image into compressed, in bands row bands, or one
+// per OpenCV thread if bands is 0. Returns false for other encodings.
+bool encodeRvl(
+  const sensor_msgs::msg::Image & depth, int bands,
+  sensor_msgs::msg::CompressedImage & compressed);
+
+// Decompress an RVL compressed image into depth, as 16UC1 with the header of
+// compressed. Returns false if compressed is not RVL, is truncated, or has a
+// width or height above 65536 or more rows than its data can hold.
+bool decodeRvl(
+  const sensor_msgs::msg::CompressedImage & compressed, sensor_msgs::msg::Image & depth);
+
+}  // namespace depth_image_proc
+
+#endif  // DEPTH_IMAGE_PROC__RVL_HPP_
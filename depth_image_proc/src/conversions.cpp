@@ -31,12 +31,463 @@
 // POSSIBILITY OF SUCH DAMAGE.
 #include <depth_image_proc/conversions.hpp>
 
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include <image_proc/camera_cache.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
 namespace depth_image_proc
 {
 
+namespace
+{
+
+#if CV_SIMD128
+// Loads four depths in meters, replacing missing ones with invalid
+inline cv::v_float32x4 loadMeters(const uint16_t * depth, const cv::v_float32x4 & invalid)
+{
+  const cv::v_uint32x4 raw = cv::v_load_expand(depth);
+  const cv::v_float32x4 meters =
+    cv::v_cvt_f32(cv::v_reinterpret_as_s32(raw)) * cv::v_setall_f32(0.001f);
+  const cv::v_float32x4 missing = cv::v_reinterpret_as_f32(raw == cv::v_setzero_u32());
+  return cv::v_select(missing, invalid, meters);
+}
+
+inline cv::v_float32x4 loadMeters(const float * depth, const cv::v_float32x4 & invalid)
+{
+  const cv::v_float32x4 meters = cv::v_load(depth);
+  // False for NaN as well as for both infinities
+  const cv::v_float32x4 finite =
+    cv::v_abs(meters) < cv::v_setall_f32(std::numeric_limits<float>::infinity());
+  return cv::v_select(finite, meters, invalid);
+}
+#endif
+
+// Converts one row of depths into points of point_floats floats each. Rows
+// of packed xyz points, with one float of padding, are stored four points
+// at a time, otherwise only x, y and z are written.
+template<typename T>
+void convertDepthRow(
+  const T * depth, const float * ray_x, float ray_y, float invalid,
+  int width, float * out, int point_floats, bool packed)
+{
+  int u = 0;
+#if CV_SIMD128
+  if (packed) {
+    const cv::v_float32x4 v_invalid = cv::v_setall_f32(invalid);
+    const cv::v_float32x4 v_ray_y = cv::v_setall_f32(ray_y);
+    const cv::v_float32x4 v_zero = cv::v_setzero_f32();
+    for (; u + 4 <= width; u += 4) {
+      const cv::v_float32x4 z = loadMeters(depth + u, v_invalid);
+      cv::v_store_interleave(out + 4 * u, cv::v_load(ray_x + u) * z, v_ray_y * z, z, v_zero);
+    }
+  }
+#else
+  (void) packed;
+#endif
+  for (; u < width; ++u) {
+    const T d = depth[u];
+    const float z = DepthTraits<T>::valid(d) ? DepthTraits<T>::toMeters(d) : invalid;
+    float * point = out + u * point_floats;
+    point[0] = ray_x[u] * z;
+    point[1] = ray_y * z;
+    point[2] = z;
+  }
+}
+
+// Same as convertDepthRow, moving the points by transform on the way. The
+// point of depth z on ray (x, y, 1) is z * (x * R0 + (y * R1 + R2)) + t, R0,
+// R1 and R2 being the columns of the rotation and the sum in parentheses
+// fixed for the row.
+template<typename T>
+void convertDepthRowTransformed(
+  const T * depth, const float * ray_x, float ray_y, float invalid,
+  int width, float * out, int point_floats, bool packed, const cv::Matx34f & transform)
+{
+  const cv::Matx34f & m = transform;
+  const float row_x = ray_y * m(0, 1) + m(0, 2);
+  const float row_y = ray_y * m(1, 1) + m(1, 2);
+  const float row_z = ray_y * m(2, 1) + m(2, 2);
+  int u = 0;
+#if CV_SIMD128
+  if (packed) {
+    const cv::v_float32x4 v_invalid = cv::v_setall_f32(invalid);
+    const cv::v_float32x4 v_zero = cv::v_setzero_f32();
+    const cv::v_float32x4 r0x = cv::v_setall_f32(m(0, 0));
+    const cv::v_float32x4 r0y = cv::v_setall_f32(m(1, 0));
+    const cv::v_float32x4 r0z = cv::v_setall_f32(m(2, 0));
+    const cv::v_float32x4 v_row_x = cv::v_setall_f32(row_x);
+    const cv::v_float32x4 v_row_y = cv::v_setall_f32(row_y);
+    const cv::v_float32x4 v_row_z = cv::v_setall_f32(row_z);
+    const cv::v_float32x4 tx = cv::v_setall_f32(m(0, 3));
+    const cv::v_float32x4 ty = cv::v_setall_f32(m(1, 3));
+    const cv::v_float32x4 tz = cv::v_setall_f32(m(2, 3));
+    for (; u + 4 <= width; u += 4) {
+      const cv::v_float32x4 z = loadMeters(depth + u, v_invalid);
+      const cv::v_float32x4 ray = cv::v_load(ray_x + u);
+      cv::v_store_interleave(
+        out + 4 * u, (ray * r0x + v_row_x) * z + tx, (ray * r0y + v_row_y) * z + ty,
+        (ray * r0z + v_row_z) * z + tz, v_zero);
+    }
+  }
+#else
+  (void) packed;
+#endif
+  for (; u < width; ++u) {
+    const T d = depth[u];
+    const float z = DepthTraits<T>::valid(d) ? DepthTraits<T>::toMeters(d) : invalid;
+    float * point = out + u * point_floats;
+    point[0] = (ray_x[u] * m(0, 0) + row_x) * z + m(0, 3);
+    point[1] = (ray_x[u] * m(1, 0) + row_y) * z + m(1, 3);
+    point[2] = (ray_x[u] * m(2, 0) + row_z) * z + m(2, 3);
+  }
+}
+
+#if CV_SIMD128
+// Loads four intensities as floats
+inline cv::v_float32x4 loadIntensity(const uint8_t * intensity)
+{
+  return cv::v_cvt_f32(cv::v_reinterpret_as_s32(cv::v_load_expand_q(intensity)));
+}
+
+inline cv::v_float32x4 loadIntensity(const uint16_t * intensity)
+{
+  return cv::v_cvt_f32(cv::v_reinterpret_as_s32(cv::v_load_expand(intensity)));
+}
+
+inline cv::v_float32x4 loadIntensity(const float * intensity)
+{
+  return cv::v_load(intensity);
+}
+#endif
+
+// Same as convertDepthRow, also writing the intensity of every point
+// intensity_float floats after its x. Rows of xyzi points and nothing else
+// are stored four points at a time.
+template<typename T, typename I>
+void convertDepthIntensityRow(
+  const T * depth, const I * intensity, const float * ray_x, float ray_y, float invalid,
+  int width, float * out, int point_floats, int intensity_float, bool packed)
+{
+  int u = 0;
+#if CV_SIMD128
+  if (packed) {
+    const cv::v_float32x4 v_invalid = cv::v_setall_f32(invalid);
+    const cv::v_float32x4 v_ray_y = cv::v_setall_f32(ray_y);
+    for (; u + 4 <= width; u += 4) {
+      const cv::v_float32x4 z = loadMeters(depth + u, v_invalid);
+      cv::v_store_interleave(
+        out + 4 * u, cv::v_load(ray_x + u) * z, v_ray_y * z, z, loadIntensity(intensity + u));
+    }
+  }
+#else
+  (void) packed;
+#endif
+  for (; u < width; ++u) {
+    const T d = depth[u];
+    const float z = DepthTraits<T>::valid(d) ? DepthTraits<T>::toMeters(d) : invalid;
+    float * point = out + u * point_floats;
+    point[0] = ray_x[u] * z;
+    point[1] = ray_y * z;
+    point[2] = z;
+    point[intensity_float] = static_cast<float>(intensity[u]);
+  }
+}
+
+// Same as convertDepthRow, for a row of unit rays scaled by radial distances
+template<typename T>
+void convertDepthRadialRow(
+  const T * depth, const float * ray_x, const float * ray_y, const float * ray_z,
+  int width, float * out, int point_floats, bool packed)
+{
+  const float invalid = std::numeric_limits<float>::quiet_NaN();
+  int u = 0;
+#if CV_SIMD128
+  if (packed) {
+    const cv::v_float32x4 v_invalid = cv::v_setall_f32(invalid);
+    const cv::v_float32x4 v_zero = cv::v_setzero_f32();
+    for (; u + 4 <= width; u += 4) {
+      const cv::v_float32x4 r = loadMeters(depth + u, v_invalid);
+      cv::v_store_interleave(
+        out + 4 * u, cv::v_load(ray_x + u) * r, cv::v_load(ray_y + u) * r,
+        cv::v_load(ray_z + u) * r, v_zero);
+    }
+  }
+#else
+  (void) packed;
+#endif
+  for (; u < width; ++u) {
+    const T d = depth[u];
+    const float r = DepthTraits<T>::valid(d) ? DepthTraits<T>::toMeters(d) : invalid;
+    float * point = out + u * point_floats;
+    point[0] = ray_x[u] * r;
+    point[1] = ray_y[u] * r;
+    point[2] = ray_z[u] * r;
+  }
+}
+
+// Offset of the x field, floats per point and whether the points are packed
+// xyz points with one float of padding and nothing else, which the row
+// kernels can store whole
+void pointLayout(
+  const sensor_msgs::msg::PointCloud2 & cloud_msg, uint32_t & x_offset, int & point_floats,
+  bool & packed)
+{
+  x_offset = 0;
+  for (const auto & field : cloud_msg.fields) {
+    if (field.name == "x") {
+      x_offset = field.offset;
+    }
+  }
+  point_floats = cloud_msg.point_step / sizeof(float);
+  packed = cloud_msg.fields.size() == 3 && x_offset == 0 && point_floats == 4;
+}
+
+// Calls row_fn(v, depth_row, points, point_floats, packed) for every row of
+// the depth image in parallel, points being the x field of the first point
+// of the matching cloud row. Packed rows are xyz points with one float of
+// padding and nothing else, which the row kernels can store whole.
+template<typename T, typename RowFn>
+void forEachDepthRow(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const RowFn & row_fn)
+{
+  uint32_t x_offset;
+  int point_floats;
+  bool packed;
+  pointLayout(*cloud_msg, x_offset, point_floats, packed);
+
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(cloud_msg->height)), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const T * depth_row =
+          reinterpret_cast<const T *>(&depth_msg->data[v * depth_msg->step]);
+        float * points = reinterpret_cast<float *>(
+          &cloud_msg->data[v * cloud_msg->row_step + x_offset]);
+        row_fn(v, depth_row, points, point_floats, packed);
+      }
+    });
+}
+
+// Rectified depth in meters of the output pixel that the fixed-point maps of
+// image_proc::RectificationMaps send to source pixel (x, y) plus fraction.
+// Depths are never interpolated across: the pixel takes the depth nearest to
+// its source position or, with min_filter, the closest valid one of the four
+// around it, so edges do not get points floating between surfaces.
+template<typename T>
+inline float rectifiedDepth(
+  const sensor_msgs::msg::Image & raw_msg, int x, int y, uint16_t fraction, bool min_filter)
+{
+  const float bad_point = std::numeric_limits<float>::quiet_NaN();
+  const auto meters = [&raw_msg, bad_point](int sx, int sy) {
+      if (sx < 0 || sy < 0 || sx >= static_cast<int>(raw_msg.width) ||
+        sy >= static_cast<int>(raw_msg.height))
+      {
+        return bad_point;
+      }
+      const T depth = reinterpret_cast<const T *>(&raw_msg.data[sy * raw_msg.step])[sx];
+      return DepthTraits<T>::valid(depth) ? DepthTraits<T>::toMeters(depth) : bad_point;
+    };
+
+  if (!min_filter) {
+    constexpr int half = cv::INTER_TAB_SIZE / 2;
+    return meters(
+      x + ((fraction & (cv::INTER_TAB_SIZE - 1)) >= half ? 1 : 0),
+      y + ((fraction >> cv::INTER_BITS) >= half ? 1 : 0));
+  }
+  float z = bad_point;
+  for (int dy = 0; dy < 2; ++dy) {
+    for (int dx = 0; dx < 2; ++dx) {
+      // Comparisons with NaN are false, so the first valid depth is taken
+      const float m = meters(x + dx, y + dy);
+      if (!std::isnan(m) && !(m >= z)) {
+        z = m;
+      }
+    }
+  }
+  return z;
+}
+
+// Offset in every point of the field called name
+uint32_t fieldOffset(const sensor_msgs::msg::PointCloud2 & cloud, const std::string & name)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name == name) {
+      return field.offset;
+    }
+  }
+  return 0;
+}
+
+// Copies the color of every point of a row into the bytes of its rgb field,
+// which hold blue, green, red and unused alpha in that order
+inline void gatherRgbRow(
+  const uint8_t * rgb_row, const uint32_t * columns, int width, uint8_t * out,
+  uint32_t point_step, int red_offset, int green_offset, int blue_offset)
+{
+  for (int u = 0; u < width; ++u, out += point_step) {
+    const uint8_t * pixel = rgb_row + columns[u];
+    out[0] = pixel[blue_offset];
+    out[1] = pixel[green_offset];
+    out[2] = pixel[red_offset];
+    out[3] = 0;
+  }
+}
+
+}  // namespace
+
+bool DepthRayLut::update(
+  const image_geometry::PinholeCameraModel & model, int width, int height,
+  int factor, double offset)
+{
+  if (width == this->width() && height == this->height() &&
+    model.fx() == fx_ && model.fy() == fy_ && model.cx() == cx_ && model.cy() == cy_ &&
+    factor == factor_ && offset == offset_)
+  {
+    return false;
+  }
+
+  fx_ = model.fx();
+  fy_ = model.fy();
+  cx_ = model.cx();
+  cy_ = model.cy();
+  factor_ = factor;
+  offset_ = offset;
+
+  x_.resize(width);
+  for (int u = 0; u < width; ++u) {
+    x_[u] = static_cast<float>((u * factor + offset - cx_) / fx_);
+  }
+  y_.resize(height);
+  for (int v = 0; v < height; ++v) {
+    y_[v] = static_cast<float>((v * factor + offset - cy_) / fy_);
+  }
+  return true;
+}
+
+std::shared_ptr<const DepthRayLut> DepthRayLut::get(
+  const image_geometry::PinholeCameraModel & model, int width, int height,
+  int factor, double offset)
+{
+  using image_proc::CameraCache;
+  uint64_t key = 0;
+  for (double value : {model.fx(), model.fy(), model.cx(), model.cy(), offset}) {
+    key = CameraCache::combineKeys(key, std::hash<double>()(value));
+  }
+  for (int value : {width, height, factor}) {
+    key = CameraCache::combineKeys(key, static_cast<uint64_t>(value));
+  }
+  return CameraCache::instance().get<DepthRayLut>(
+    key, [&]() {
+      auto lut = std::make_shared<DepthRayLut>();
+      lut->update(model, width, height, factor, offset);
+      return lut;
+    });
+}
+
+template<typename T>
+void convertDepth(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth,
+  const cv::Matx34f * transform)
+{
+  // Missing points denoted by NaNs, unless a replacement depth is given
+  float invalid = std::numeric_limits<float>::quiet_NaN();
+  if (invalid_depth != 0.0) {
+    invalid = DepthTraits<T>::toMeters(DepthTraits<T>::fromMeters(invalid_depth));
+  }
+
+  const int width = static_cast<int>(cloud_msg->width);
+  forEachDepthRow<T>(
+    depth_msg, cloud_msg,
+    [&](int v, const T * depth_row, float * points, int point_floats, bool packed) {
+      if (transform) {
+        convertDepthRowTransformed<T>(
+          depth_row, lut.x(), lut.y()[v], invalid, width, points, point_floats, packed,
+          *transform);
+      } else {
+        convertDepthRow<T>(
+          depth_row, lut.x(), lut.y()[v], invalid, width, points, point_floats, packed);
+      }
+    });
+}
+
+void transformPoints(sensor_msgs::msg::PointCloud2 & cloud_msg, const cv::Matx34f & transform)
+{
+  const uint32_t x_offset = fieldOffset(cloud_msg, "x");
+  for (uint32_t v = 0; v < cloud_msg.height; ++v) {
+    uint8_t * point = &cloud_msg.data[v * cloud_msg.row_step + x_offset];
+    for (uint32_t u = 0; u < cloud_msg.width; ++u, point += cloud_msg.point_step) {
+      float * xyz = reinterpret_cast<float *>(point);
+      const cv::Vec3f moved = transform * cv::Vec4f(xyz[0], xyz[1], xyz[2], 1.0f);
+      xyz[0] = moved[0];
+      xyz[1] = moved[1];
+      xyz[2] = moved[2];
+    }
+  }
+}
+
+bool ColorSampling::update(
+  int depth_width, int depth_height, const sensor_msgs::msg::Image & rgb_msg,
+  int color_step)
+{
+  if (depth_width == static_cast<int>(columns_.size()) &&
+    depth_height == static_cast<int>(rows_.size()) &&
+    rgb_msg.width == rgb_width_ && rgb_msg.height == rgb_height_ &&
+    rgb_msg.step == rgb_step_ && color_step == color_step_)
+  {
+    return covered_;
+  }
+
+  rgb_width_ = rgb_msg.width;
+  rgb_height_ = rgb_msg.height;
+  rgb_step_ = rgb_msg.step;
+  color_step_ = color_step;
+
+  // Integer arithmetic, so that at matching resolutions every pixel samples
+  // itself exactly
+  auto sample = [this, depth_width](int i) {
+      return static_cast<uint32_t>(static_cast<uint64_t>(i) * rgb_width_ / depth_width);
+    };
+  columns_.resize(depth_width);
+  for (int u = 0; u < depth_width; ++u) {
+    columns_[u] = sample(u) * color_step;
+  }
+  rows_.resize(depth_height);
+  for (int v = 0; v < depth_height; ++v) {
+    rows_[v] = static_cast<size_t>(sample(v)) * rgb_step_;
+  }
+  covered_ = depth_width > 0 && depth_height > 0 && sample(depth_height - 1) < rgb_height_;
+  return covered_;
+}
+
+template<typename T>
+void convertDepthRadial(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const RadialTable & table)
+{
+  const int width = static_cast<int>(cloud_msg->width);
+  forEachDepthRow<T>(
+    depth_msg, cloud_msg,
+    [&](int v, const T * depth_row, float * points, int point_floats, bool packed) {
+      convertDepthRadialRow<T>(
+        depth_row, table.x(v), table.y(v), table.z(v), width, points, point_floats, packed);
+    });
+}
+
 cv::Mat initMatrix(
   cv::Mat cameraMatrix, cv::Mat distCoeffs,
   int width, int height, bool radial)
@@ -82,27 +533,238 @@ void convertRgb(
   const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
   int red_offset, int green_offset, int blue_offset, int color_step)
 {
-  sensor_msgs::PointCloud2Iterator<uint8_t> iter_r(*cloud_msg, "r");
-  sensor_msgs::PointCloud2Iterator<uint8_t> iter_g(*cloud_msg, "g");
-  sensor_msgs::PointCloud2Iterator<uint8_t> iter_b(*cloud_msg, "b");
-  const uint8_t * rgb = &rgb_msg->data[0];
-  int rgb_skip = rgb_msg->step - rgb_msg->width * color_step;
-  for (int v = 0; v < static_cast<int>(cloud_msg->height); ++v, rgb += rgb_skip) {
-    for (int u = 0; u < static_cast<int>(cloud_msg->width); ++u,
-      rgb += color_step, ++iter_r, ++iter_g, ++iter_b)
-    {
-      *iter_r = rgb[red_offset];
-      *iter_g = rgb[green_offset];
-      *iter_b = rgb[blue_offset];
-    }
+  ColorSampling sampling;
+  sampling.update(cloud_msg->width, cloud_msg->height, *rgb_msg, color_step);
+  convertRgb(rgb_msg, cloud_msg, sampling, red_offset, green_offset, blue_offset);
+}
+
+void convertRgb(
+  const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const ColorSampling & sampling,
+  int red_offset, int green_offset, int blue_offset)
+{
+  const uint32_t rgb_offset = fieldOffset(*cloud_msg, "rgb");
+  const int width = static_cast<int>(cloud_msg->width);
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(cloud_msg->height)), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        gatherRgbRow(
+          &rgb_msg->data[sampling.rows()[v]], sampling.columns(), width,
+          &cloud_msg->data[v * cloud_msg->row_step + rgb_offset], cloud_msg->point_step,
+          red_offset, green_offset, blue_offset);
+      }
+    });
+}
+
+template<typename T>
+void convertDepthRgb(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut, const ColorSampling & sampling,
+  int red_offset, int green_offset, int blue_offset,
+  double invalid_depth,
+  const cv::Matx34f * transform)
+{
+  // Missing points denoted by NaNs, unless a replacement depth is given
+  float invalid = std::numeric_limits<float>::quiet_NaN();
+  if (invalid_depth != 0.0) {
+    invalid = DepthTraits<T>::toMeters(DepthTraits<T>::fromMeters(invalid_depth));
   }
+
+  const uint32_t rgb_offset = fieldOffset(*cloud_msg, "rgb");
+  const int width = static_cast<int>(cloud_msg->width);
+  forEachDepthRow<T>(
+    depth_msg, cloud_msg,
+    [&](int v, const T * depth_row, float * points, int point_floats, bool packed) {
+      if (transform) {
+        convertDepthRowTransformed<T>(
+          depth_row, lut.x(), lut.y()[v], invalid, width, points, point_floats, packed,
+          *transform);
+      } else {
+        convertDepthRow<T>(
+          depth_row, lut.x(), lut.y()[v], invalid, width, points, point_floats, packed);
+      }
+      gatherRgbRow(
+        &rgb_msg->data[sampling.rows()[v]], sampling.columns(), width,
+        &cloud_msg->data[v * cloud_msg->row_step + rgb_offset], cloud_msg->point_step,
+        red_offset, green_offset, blue_offset);
+    });
+}
+
+template<typename T, typename I>
+void convertDepthIntensity(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth)
+{
+  // Missing points denoted by NaNs, unless a replacement depth is given
+  float invalid = std::numeric_limits<float>::quiet_NaN();
+  if (invalid_depth != 0.0) {
+    invalid = DepthTraits<T>::toMeters(DepthTraits<T>::fromMeters(invalid_depth));
+  }
+
+  const int x_offset = static_cast<int>(fieldOffset(*cloud_msg, "x"));
+  const int intensity_float =
+    (static_cast<int>(fieldOffset(*cloud_msg, "intensity")) - x_offset) /
+    static_cast<int>(sizeof(float));
+  const bool packed_xyzi = cloud_msg->fields.size() == 4 && x_offset == 0 &&
+    intensity_float == 3 && cloud_msg->point_step == 4 * sizeof(float);
+  const int width = static_cast<int>(cloud_msg->width);
+  forEachDepthRow<T>(
+    depth_msg, cloud_msg,
+    [&](int v, const T * depth_row, float * points, int point_floats, bool) {
+      const I * intensity_row =
+        reinterpret_cast<const I *>(&intensity_msg->data[v * intensity_msg->step]);
+      convertDepthIntensityRow<T, I>(
+        depth_row, intensity_row, lut.x(), lut.y()[v], invalid, width, points, point_floats,
+        intensity_float, packed_xyzi);
+    });
+}
+
+template<typename T>
+void rectifyDepth(
+  const sensor_msgs::msg::Image & raw_msg, const cv::Mat & map1, const cv::Mat & map2,
+  bool min_filter, sensor_msgs::msg::Image & rect_msg,
+  const DepthRayLut * lut, sensor_msgs::msg::PointCloud2 * cloud_msg)
+{
+  const int width = map1.cols;
+  rect_msg.height = map1.rows;
+  rect_msg.width = width;
+  rect_msg.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+  rect_msg.step = width * sizeof(float);
+  rect_msg.data.resize(rect_msg.height * rect_msg.step);
+
+  uint32_t x_offset = 0;
+  int point_floats = 0;
+  bool packed = false;
+  if (cloud_msg) {
+    pointLayout(*cloud_msg, x_offset, point_floats, packed);
+  }
+  const float bad_point = std::numeric_limits<float>::quiet_NaN();
+
+  cv::parallel_for_(
+    cv::Range(0, map1.rows), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const cv::Vec2s * source = map1.ptr<cv::Vec2s>(v);
+        const uint16_t * fraction = map2.ptr<uint16_t>(v);
+        float * rect = reinterpret_cast<float *>(&rect_msg.data[v * rect_msg.step]);
+        for (int u = 0; u < width; ++u) {
+          rect[u] = rectifiedDepth<T>(raw_msg, source[u][0], source[u][1], fraction[u], min_filter);
+        }
+        // Points of the row while its depths are still in cache
+        if (cloud_msg) {
+          float * points = reinterpret_cast<float *>(
+            &cloud_msg->data[v * cloud_msg->row_step + x_offset]);
+          convertDepthRow<float>(
+            rect, lut->x(), lut->y()[v], bad_point, width, points, point_floats, packed);
+        }
+      }
+    });
 }
 
 // force template instantiation
+template void convertDepth<uint16_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth,
+  const cv::Matx34f * transform);
+
+template void convertDepth<float>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth,
+  const cv::Matx34f * transform);
+
+template void convertDepthRgb<uint16_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut, const ColorSampling & sampling,
+  int red_offset, int green_offset, int blue_offset,
+  double invalid_depth,
+  const cv::Matx34f * transform);
+
+template void convertDepthRgb<float>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & rgb_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut, const ColorSampling & sampling,
+  int red_offset, int green_offset, int blue_offset,
+  double invalid_depth,
+  const cv::Matx34f * transform);
+
+template void convertDepthIntensity<uint16_t, uint8_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth);
+
+template void convertDepthIntensity<uint16_t, uint16_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth);
+
+template void convertDepthIntensity<uint16_t, float>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth);
+
+template void convertDepthIntensity<float, uint8_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth);
+
+template void convertDepthIntensity<float, uint16_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth);
+
+template void convertDepthIntensity<float, float>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut,
+  double invalid_depth);
+
+template void convertDepthRadial<uint16_t>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const RadialTable & table);
+
+template void convertDepthRadial<float>(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const RadialTable & table);
+
 template void convertDepth<uint16_t>(
   const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
   const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
   const image_geometry::PinholeCameraModel & model,
   double invalid_depth);
 
+template void rectifyDepth<uint16_t>(
+  const sensor_msgs::msg::Image & raw_msg, const cv::Mat & map1, const cv::Mat & map2,
+  bool min_filter, sensor_msgs::msg::Image & rect_msg,
+  const DepthRayLut * lut, sensor_msgs::msg::PointCloud2 * cloud_msg);
+
+template void rectifyDepth<float>(
+  const sensor_msgs::msg::Image & raw_msg, const cv::Mat & map1, const cv::Mat & map2,
+  bool min_filter, sensor_msgs::msg::Image & rect_msg,
+  const DepthRayLut * lut, sensor_msgs::msg::PointCloud2 * cloud_msg);
+
 }  // namespace depth_image_proc
@@ -30,22 +30,84 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "depth_image_proc/visibility.h"
 
+#include <opencv2/core/hal/intrin.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
 #include <sensor_msgs/image_encodings.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
 
+namespace
+{
+
+// Meters of every uint16 depth in millimeters, NaN for the invalid zero
+const float * millimetersToMeters()
+{
+  static const std::array<float, 65536> table = [] {
+      std::array<float, 65536> t;
+      t[0] = std::numeric_limits<float>::quiet_NaN();
+      for (size_t raw = 1; raw < t.size(); ++raw) {
+        t[raw] = static_cast<float>(raw * 0.001f);
+      }
+      return t;
+    }();
+  return table.data();
+}
+
+void convertMillimetersRow(const uint16_t * raw, float * depth, int width)
+{
+  const float * table = millimetersToMeters();
+  for (int u = 0; u < width; ++u) {
+    depth[u] = table[raw[u]];
+  }
+}
+
+// Converts m to mm, NaN becoming the invalid zero. depth may alias raw, every
+// block of depths is loaded before the shorter result is stored.
+void convertMetersRow(const float * raw, uint16_t * depth, int width)
+{
+  int u = 0;
+#if CV_SIMD128
+  const cv::v_float32x4 scale = cv::v_setall_f32(1000.0f);
+  const cv::v_float32x4 max_mm = cv::v_setall_f32(65535.0f);
+  const cv::v_float32x4 zero = cv::v_setzero_f32();
+  for (; u + 8 <= width; u += 8) {
+    const cv::v_float32x4 low = cv::v_load(raw + u);
+    const cv::v_float32x4 high = cv::v_load(raw + u + 4);
+    // NaN compares unequal to itself. The pack saturates negative values to zero.
+    const cv::v_int32x4 low_mm =
+      cv::v_trunc(cv::v_select(low == low, cv::v_min(low * scale, max_mm), zero));
+    const cv::v_int32x4 high_mm =
+      cv::v_trunc(cv::v_select(high == high, cv::v_min(high * scale, max_mm), zero));
+    cv::v_store(depth + u, cv::v_pack_u(low_mm, high_mm));
+  }
+#endif
+  for (; u < width; ++u) {
+    const float mm = raw[u] * 1000;
+    depth[u] = std::isnan(mm) ? 0 :
+      static_cast<uint16_t>(std::min(65535.0f, std::max(0.0f, mm)));
+  }
+}
+
+}  // namespace
+
 class ConvertMetricNode : public rclcpp::Node
 {
 public:
@@ -54,12 +116,24 @@ public:
 private:
   // Subscriptions
   image_transport::Subscriber sub_raw_;
+  rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr sub_raw_unique_;
+
+  // Parameters
+  bool intra_process_;
 
   // Publications
   std::mutex connect_mutex_;
   image_transport::Publisher pub_depth_;
 
   void depthCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg);
+  void depthUniqueCb(sensor_msgs::msg::Image::UniquePtr raw_msg);
+
+  // Converts raw_msg into depth_msg, which is raw_msg itself when converting
+  // float to uint16 in place. Returns false for unsupported encodings.
+  bool convert(const sensor_msgs::msg::Image & raw_msg, sensor_msgs::msg::Image & depth_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 ConvertMetricNode::ConvertMetricNode(const rclcpp::NodeOptions & options)
@@ -68,6 +142,11 @@ ConvertMetricNode::ConvertMetricNode(const rclcpp::NodeOptions & options)
   // TransportHints does not actually declare the parameter
   this->declare_parameter<std::string>("image_transport", "raw");
 
+  // Take raw images by unique_ptr, so float images can be converted in place
+  intra_process_ = this->declare_parameter<bool>("intra_process", false);
+
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -76,6 +155,14 @@ ConvertMetricNode::ConvertMetricNode(const rclcpp::NodeOptions & options)
       std::lock_guard<std::mutex> lock(connect_mutex_);
       if (pub_depth_.getNumSubscribers() == 0) {
         sub_raw_.shutdown();
+        sub_raw_unique_.reset();
+      } else if (intra_process_) {
+        if (!sub_raw_unique_) {
+          // Only the raw transport can hand over ownership of the message
+          sub_raw_unique_ = this->create_subscription<sensor_msgs::msg::Image>(
+            "image_raw", latest_only_->qos(rclcpp::QoS(10)),
+            std::bind(&ConvertMetricNode::depthUniqueCb, this, std::placeholders::_1));
+        }
       } else if (!sub_raw_) {
         // For compressed topics to remap appropriately, we need to pass a
         // fully expanded and remapped topic name to image_transport
@@ -86,7 +173,7 @@ ConvertMetricNode::ConvertMetricNode(const rclcpp::NodeOptions & options)
         sub_raw_ = image_transport::create_subscription(
           this, topic,
           std::bind(&ConvertMetricNode::depthCb, this, std::placeholders::_1),
-          hints.getTransport());
+          hints.getTransport(), latest_only_->qos(rmw_qos_profile_default));
       }
     };
   // For compressed topics to remap appropriately, we need to pass a
@@ -95,48 +182,104 @@ ConvertMetricNode::ConvertMetricNode(const rclcpp::NodeOptions & options)
   std::string topic = node_base->resolve_topic_or_service_name("image", false);
   pub_depth_ =
     image_transport::create_publisher(this, topic, rmw_qos_profile_default, pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void ConvertMetricNode::depthCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg)
 {
-  auto depth_msg = std::make_shared<sensor_msgs::msg::Image>();
-  depth_msg->header = raw_msg->header;
-  depth_msg->height = raw_msg->height;
-  depth_msg->width = raw_msg->width;
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/convert_metric", raw_msg.get(), raw_msg->width, raw_msg->height,
+    raw_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(raw_msg->header.stamp, frame)) {
+    return;
+  }
+
+  auto depth_msg = std::make_unique<sensor_msgs::msg::Image>();
+  if (!convert(*raw_msg, *depth_msg)) {
+    return;
+  }
+  pub_depth_.publish(std::move(depth_msg));
+  frame.published(raw_msg->header.stamp);
+}
+
+void ConvertMetricNode::depthUniqueCb(sensor_msgs::msg::Image::UniquePtr raw_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/convert_metric", raw_msg.get(), raw_msg->width, raw_msg->height,
+    raw_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(raw_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // uint16 output is half the size of the float input and fits in its buffer
+  if (raw_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
+    if (convert(*raw_msg, *raw_msg)) {
+      frame.published(raw_msg->header.stamp);
+      pub_depth_.publish(std::move(raw_msg));
+    }
+    return;
+  }
+  auto depth_msg = std::make_unique<sensor_msgs::msg::Image>();
+  if (!convert(*raw_msg, *depth_msg)) {
+    return;
+  }
+  pub_depth_.publish(std::move(depth_msg));
+  frame.published(raw_msg->header.stamp);
+}
+
+bool ConvertMetricNode::convert(
+  const sensor_msgs::msg::Image & raw_msg, sensor_msgs::msg::Image & depth_msg)
+{
+  // Read everything needed from raw_msg before depth_msg, which may be the same
+  // message, is modified
+  const std::string raw_encoding = raw_msg.encoding;
+  const uint32_t raw_step = raw_msg.step;
+  const int width = static_cast<int>(raw_msg.width);
+  const int height = static_cast<int>(raw_msg.height);
+  const bool in_place = &raw_msg == &depth_msg;
+  if (!in_place) {
+    depth_msg.header = raw_msg.header;
+    depth_msg.height = raw_msg.height;
+    depth_msg.width = raw_msg.width;
+  }
 
   // Set data, encoding and step after converting the metric.
-  if (raw_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
-    depth_msg->encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-    depth_msg->step =
-      raw_msg->width * (sensor_msgs::image_encodings::bitDepth(depth_msg->encoding) / 8);
-    depth_msg->data.resize(depth_msg->height * depth_msg->step);
+  if (raw_encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
+    depth_msg.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+    depth_msg.step =
+      raw_msg.width * (sensor_msgs::image_encodings::bitDepth(depth_msg.encoding) / 8);
+    depth_msg.data.resize(depth_msg.height * depth_msg.step);
     // Fill in the depth image data, converting mm to m
-    float bad_point = std::numeric_limits<float>::quiet_NaN();
-    const uint16_t * raw_data = reinterpret_cast<const uint16_t *>(&raw_msg->data[0]);
-    float * depth_data = reinterpret_cast<float *>(&depth_msg->data[0]);
-    for (unsigned index = 0; index < depth_msg->height * depth_msg->width; ++index) {
-      uint16_t raw = raw_data[index];
-      depth_data[index] = (raw == 0) ? bad_point : static_cast<float>(raw * 0.001f);
+    for (int v = 0; v < height; ++v) {
+      convertMillimetersRow(
+        reinterpret_cast<const uint16_t *>(&raw_msg.data[v * raw_step]),
+        reinterpret_cast<float *>(&depth_msg.data[v * depth_msg.step]), width);
+    }
+  } else if (raw_encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
+    const uint32_t depth_step = width * sizeof(uint16_t);
+    if (!in_place) {
+      depth_msg.data.resize(height * depth_step);
     }
-  } else if (raw_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
-    depth_msg->encoding = sensor_msgs::image_encodings::TYPE_16UC1;
-    depth_msg->step =
-      raw_msg->width * (sensor_msgs::image_encodings::bitDepth(depth_msg->encoding) / 8);
-    depth_msg->data.resize(depth_msg->height * depth_msg->step);
-    // Fill in the depth image data, converting m to mm
-    uint16_t bad_point = 0;
-    const float * raw_data = reinterpret_cast<const float *>(&raw_msg->data[0]);
-    uint16_t * depth_data = reinterpret_cast<uint16_t *>(&depth_msg->data[0]);
-    for (unsigned index = 0; index < depth_msg->height * depth_msg->width; ++index) {
-      float raw = raw_data[index];
-      depth_data[index] = std::isnan(raw) ? bad_point : static_cast<uint16_t>(raw * 1000);
+    // Fill in the depth image data, converting m to mm. In place, every
+    // output row starts before its input row, so rows can go in order.
+    for (int v = 0; v < height; ++v) {
+      convertMetersRow(
+        reinterpret_cast<const float *>(&raw_msg.data[v * raw_step]),
+        reinterpret_cast<uint16_t *>(&depth_msg.data[v * depth_step]), width);
     }
+    depth_msg.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+    depth_msg.step = depth_step;
+    depth_msg.data.resize(height * depth_step);
   } else {
-    RCLCPP_ERROR(get_logger(), "Unsupported image conversion from %s.", raw_msg->encoding.c_str());
-    return;
+    RCLCPP_ERROR(get_logger(), "Unsupported image conversion from %s.", raw_encoding.c_str());
+    return false;
   }
-
-  pub_depth_.publish(depth_msg);
+  return true;
 }
 
 }  // namespace depth_image_proc
@@ -30,22 +30,107 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "cv_bridge/cv_bridge.hpp"
 #include "depth_image_proc/visibility.h"
 
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+#include <opencv2/core/utility.hpp>
 
 namespace depth_image_proc
 {
 
 namespace enc = sensor_msgs::image_encodings;
 
+namespace
+{
+
+// Smallest pixel other than zero, or zero if there is none. NaNs are skipped.
+template<typename T>
+T nonZeroMin(const cv::Mat & image)
+{
+  std::vector<T> row_min(image.rows, std::numeric_limits<T>::max());
+  std::vector<uint8_t> row_found(image.rows, 0);
+  cv::parallel_for_(
+    cv::Range(0, image.rows), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const T * row = image.ptr<T>(v);
+        T min = std::numeric_limits<T>::max();
+        bool found = false;
+        for (int u = 0; u < image.cols; ++u) {
+          const T value = row[u];
+          const bool candidate = value != T(0) && value <= min;
+          min = candidate ? value : min;
+          found = found || candidate;
+        }
+        row_min[v] = min;
+        row_found[v] = found;
+      }
+    });
+
+  T min = std::numeric_limits<T>::max();
+  bool found = false;
+  for (int v = 0; v < image.rows; ++v) {
+    if (row_found[v]) {
+      min = std::min(min, row_min[v]);
+      found = true;
+    }
+  }
+  return found ? min : T(0);
+}
+
+// Writes src to dst with every pixel greater than threshold set to zero, like
+// cv::threshold with THRESH_TOZERO_INV. dst may be src.
+template<typename T>
+void cutBeyond(const cv::Mat & src, cv::Mat & dst, double threshold)
+{
+  // Integers are greater than threshold exactly when greater than its floor
+  T limit;
+  if (std::numeric_limits<T>::is_integer) {
+    const double floor_threshold = std::floor(threshold);
+    if (floor_threshold < std::numeric_limits<T>::lowest()) {
+      dst.setTo(0);
+      return;
+    }
+    limit = static_cast<T>(std::min<double>(floor_threshold, std::numeric_limits<T>::max()));
+  } else {
+    limit = static_cast<T>(threshold);
+  }
+
+  cv::parallel_for_(
+    cv::Range(0, src.rows), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const T * src_row = src.ptr<T>(v);
+        T * dst_row = dst.ptr<T>(v);
+        for (int u = 0; u < src.cols; ++u) {
+          dst_row[u] = src_row[u] > limit ? T(0) : src_row[u];
+        }
+      }
+    });
+}
+
+template<typename T>
+void cropForemost(const cv::Mat & src, cv::Mat & dst, double distance)
+{
+  cutBeyond<T>(src, dst, nonZeroMin<T>(src) + distance);
+}
+
+}  // namespace
+
 class CropForemostNode : public rclcpp::Node
 {
 public:
@@ -54,16 +139,26 @@ public:
 private:
   // Subscriptions
   image_transport::Subscriber sub_raw_;
+  rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr sub_raw_unique_;
 
   // Publications
   std::mutex connect_mutex_;
   image_transport::Publisher pub_depth_;
 
   void depthCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg);
+  void depthUniqueCb(sensor_msgs::msg::Image::UniquePtr raw_msg);
+
+  // Crops raw_msg into depth_msg, which may be raw_msg itself. Returns false
+  // for unsupported encodings.
+  bool crop(const sensor_msgs::msg::Image & raw_msg, sensor_msgs::msg::Image & depth_msg);
 
   double distance_;
+  bool intra_process_;
 
   rclcpp::Logger logger_ = rclcpp::get_logger("CropForemostNode");
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 CropForemostNode::CropForemostNode(const rclcpp::NodeOptions & options)
@@ -74,6 +169,11 @@ CropForemostNode::CropForemostNode(const rclcpp::NodeOptions & options)
 
   distance_ = this->declare_parameter("distance", 0.0);
 
+  // Take raw images by unique_ptr, so they can be cropped in place
+  intra_process_ = this->declare_parameter<bool>("intra_process", false);
+
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -82,6 +182,14 @@ CropForemostNode::CropForemostNode(const rclcpp::NodeOptions & options)
       std::lock_guard<std::mutex> lock(connect_mutex_);
       if (pub_depth_.getNumSubscribers() == 0) {
         sub_raw_.shutdown();
+        sub_raw_unique_.reset();
+      } else if (intra_process_) {
+        if (!sub_raw_unique_) {
+          // Only the raw transport can hand over ownership of the message
+          sub_raw_unique_ = this->create_subscription<sensor_msgs::msg::Image>(
+            "image_raw", latest_only_->qos(rclcpp::QoS(10)),
+            std::bind(&CropForemostNode::depthUniqueCb, this, std::placeholders::_1));
+        }
       } else if (!sub_raw_) {
         // For compressed topics to remap appropriately, we need to pass a
         // fully expanded and remapped topic name to image_transport
@@ -92,7 +200,7 @@ CropForemostNode::CropForemostNode(const rclcpp::NodeOptions & options)
         sub_raw_ = image_transport::create_subscription(
           this, topic,
           std::bind(&CropForemostNode::depthCb, this, std::placeholders::_1),
-          hints.getTransport());
+          hints.getTransport(), latest_only_->qos(rmw_qos_profile_default));
       }
     };
   // For compressed topics to remap appropriately, we need to pass a
@@ -101,50 +209,108 @@ CropForemostNode::CropForemostNode(const rclcpp::NodeOptions & options)
   std::string topic = node_base->resolve_topic_or_service_name("image", false);
   pub_depth_ =
     image_transport::create_publisher(this, topic, rmw_qos_profile_default, pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void CropForemostNode::depthCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg)
 {
-  cv_bridge::CvImagePtr cv_ptr;
-  try {
-    cv_ptr = cv_bridge::toCvCopy(raw_msg);
-  } catch (cv_bridge::Exception & e) {
-    RCLCPP_ERROR(logger_, "cv_bridge exception: %s", e.what());
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/crop_foremost", raw_msg.get(), raw_msg->width, raw_msg->height,
+    raw_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(raw_msg->header.stamp, frame)) {
     return;
   }
 
+  auto depth_msg = std::make_unique<sensor_msgs::msg::Image>();
+  if (crop(*raw_msg, *depth_msg)) {
+    pub_depth_.publish(std::move(depth_msg));
+    frame.published(raw_msg->header.stamp);
+  }
+}
+
+void CropForemostNode::depthUniqueCb(sensor_msgs::msg::Image::UniquePtr raw_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/crop_foremost", raw_msg.get(), raw_msg->width, raw_msg->height,
+    raw_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(raw_msg->header.stamp, frame)) {
+    return;
+  }
+
+  if (crop(*raw_msg, *raw_msg)) {
+    frame.published(raw_msg->header.stamp);
+    pub_depth_.publish(std::move(raw_msg));
+  }
+}
+
+bool CropForemostNode::crop(
+  const sensor_msgs::msg::Image & raw_msg, sensor_msgs::msg::Image & depth_msg)
+{
   // Check the number of channels
-  if (sensor_msgs::image_encodings::numChannels(raw_msg->encoding) != 1) {
+  if (sensor_msgs::image_encodings::numChannels(raw_msg.encoding) != 1) {
     RCLCPP_ERROR(
       logger_, "Only grayscale image is acceptable, got [%s]",
-      raw_msg->encoding.c_str());
-    return;
+      raw_msg.encoding.c_str());
+    return false;
+  }
+
+  int imtype;
+  try {
+    imtype = cv_bridge::getCvType(raw_msg.encoding);
+  } catch (cv_bridge::Exception & e) {
+    RCLCPP_ERROR(logger_, "cv_bridge exception: %s", e.what());
+    return false;
   }
 
-  // search the min value without invalid value "0"
-  double minVal;
-  cv::minMaxIdx(cv_ptr->image, &minVal, 0, 0, 0, cv_ptr->image != 0);
+  // The cut writes the output directly, there is no intermediate copy
+  const cv::Mat src(
+    raw_msg.height, raw_msg.width, imtype,
+    const_cast<uint8_t *>(raw_msg.data.data()), raw_msg.step);
+  if (&depth_msg != &raw_msg) {
+    depth_msg.header = raw_msg.header;
+    depth_msg.height = raw_msg.height;
+    depth_msg.width = raw_msg.width;
+    depth_msg.encoding = raw_msg.encoding;
+    depth_msg.is_bigendian = raw_msg.is_bigendian;
+    depth_msg.step = raw_msg.width * static_cast<uint32_t>(src.elemSize());
+    depth_msg.data.resize(depth_msg.height * depth_msg.step);
+  }
+  cv::Mat dst(depth_msg.height, depth_msg.width, imtype, depth_msg.data.data(), depth_msg.step);
 
-  int imtype = cv_bridge::getCvType(raw_msg->encoding);
   switch (imtype) {
     case CV_8UC1:
+      cropForemost<uint8_t>(src, dst, distance_);
+      break;
     case CV_8SC1:
-    case CV_32F:
-      cv::threshold(cv_ptr->image, cv_ptr->image, minVal + distance_, 0, CV_THRESH_TOZERO_INV);
+      cropForemost<int8_t>(src, dst, distance_);
       break;
     case CV_16UC1:
+      cropForemost<uint16_t>(src, dst, distance_);
+      break;
     case CV_16SC1:
+      cropForemost<int16_t>(src, dst, distance_);
+      break;
     case CV_32SC1:
+      cropForemost<int32_t>(src, dst, distance_);
+      break;
+    case CV_32F:
+      cropForemost<float>(src, dst, distance_);
+      break;
     case CV_64F:
-      // 8 bit or 32 bit floating array is required to use cv::threshold
-      cv_ptr->image.convertTo(cv_ptr->image, CV_32F);
-      cv::threshold(cv_ptr->image, cv_ptr->image, minVal + distance_, 1, CV_THRESH_TOZERO_INV);
-
-      cv_ptr->image.convertTo(cv_ptr->image, imtype);
+      cropForemost<double>(src, dst, distance_);
+      break;
+    default:
+      if (dst.data != src.data) {
+        src.copyTo(dst);
+      }
       break;
   }
-
-  pub_depth_.publish(cv_ptr->toImageMsg());
+  return true;
 }
 
 }  // namespace depth_image_proc
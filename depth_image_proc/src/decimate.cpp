@@ -0,0 +1,178 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "depth_image_proc/visibility.h"
+
+#include <depth_image_proc/downsampling.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_transport/image_transport.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+class DecimateNode : public rclcpp::Node
+{
+public:
+  DEPTH_IMAGE_PROC_PUBLIC DecimateNode(const rclcpp::NodeOptions & options);
+
+private:
+  using Image = sensor_msgs::msg::Image;
+  using CameraInfo = sensor_msgs::msg::CameraInfo;
+
+  // Subscriptions
+  image_transport::CameraSubscriber sub_depth_;
+  int queue_size_;
+
+  // Publications
+  std::mutex connect_mutex_;
+  image_transport::CameraPublisher pub_depth_;
+
+  // Pooling mode and block size
+  Downsampling downsampling_;
+
+  void depthCb(
+    const Image::ConstSharedPtr & depth_msg,
+    const CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+};
+
+DecimateNode::DecimateNode(const rclcpp::NodeOptions & options)
+: rclcpp::Node("DecimateNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("depth_image_transport", "raw");
+
+  // Read parameters
+  queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  downsampling_.factor = this->declare_parameter<int>("decimation", 2);
+  std::string pooling = this->declare_parameter<std::string>("pooling", "min");
+
+  downsampling_.mode = DownsampleMode::MIN;
+  if (pooling == "median") {
+    downsampling_.mode = DownsampleMode::MEDIAN;
+  } else if (pooling == "nearest") {
+    downsampling_.mode = DownsampleMode::NEAREST;
+  } else if (pooling != "min") {
+    RCLCPP_WARN(get_logger(), "Unknown pooling [%s], using min instead", pooling.c_str());
+  }
+  if (downsampling_.factor < 1) {
+    RCLCPP_WARN(get_logger(), "Invalid decimation %d, using 2 instead", downsampling_.factor);
+    downsampling_.factor = 2;
+  }
+
+  // Create publisher with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this](rclcpp::MatchedInfo &)
+    {
+      std::lock_guard<std::mutex> lock(connect_mutex_);
+      if (pub_depth_.getNumSubscribers() == 0) {
+        sub_depth_.shutdown();
+      } else if (!sub_depth_) {
+        // For compressed topics to remap appropriately, we need to pass a
+        // fully expanded and remapped topic name to image_transport
+        auto node_base = this->get_node_base_interface();
+        std::string topic = node_base->resolve_topic_or_service_name("image_rect", false);
+
+        // Get transport and QoS
+        image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
+        auto custom_qos = rmw_qos_profile_system_default;
+        custom_qos.depth = latest_only_->queueSize(queue_size_);
+
+        sub_depth_ = image_transport::create_camera_subscription(
+          this,
+          topic,
+          std::bind(
+            &DecimateNode::depthCb, this, std::placeholders::_1,
+            std::placeholders::_2),
+          depth_hints.getTransport(),
+          custom_qos);
+      }
+    };
+  // For compressed topics to remap appropriately, we need to pass a
+  // fully expanded and remapped topic name to image_transport
+  auto node_base = this->get_node_base_interface();
+  std::string topic = node_base->resolve_topic_or_service_name("decimated/image_rect", false);
+  pub_depth_ =
+    image_transport::create_camera_publisher(this, topic, rmw_qos_profile_default, pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void DecimateNode::depthCb(
+  const Image::ConstSharedPtr & depth_msg,
+  const CameraInfo::ConstSharedPtr & info_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/decimate", depth_msg.get(), depth_msg->width, depth_msg->height,
+    depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  auto decimated_msg = std::make_unique<Image>();
+  if (!downsampleDepth(*depth_msg, downsampling_, *decimated_msg)) {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
+    return;
+  }
+
+  // Intrinsics of the pixels every block stands for, so that point clouds
+  // built from the decimated image line up with the full resolution ones
+  auto decimated_info_msg = std::make_unique<CameraInfo>();
+  downsampleCameraInfo(*info_msg, downsampling_, *decimated_info_msg);
+
+  pub_depth_.publish(std::move(decimated_msg), std::move(decimated_info_msg));
+  frame.published(depth_msg->header.stamp);
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::DecimateNode)
@@ -0,0 +1,508 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "depth_image_proc/depth_registration.hpp"
+#include "image_geometry/pinhole_camera_model.hpp"
+#include "tf2_ros/qos.hpp"
+
+#include <depth_image_proc/depth_traits.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <opencv2/core/utility.hpp>
+#include <tf2_eigen/tf2_eigen.hpp>
+
+namespace depth_image_proc
+{
+
+namespace
+{
+
+DepthToRgbProjection makeProjection(
+  const image_geometry::PinholeCameraModel & depth_model,
+  const image_geometry::PinholeCameraModel & rgb_model,
+  const Eigen::Affine3d & depth_to_rgb, int width, int height)
+{
+  Eigen::Matrix3d rgb_k;
+  rgb_k << rgb_model.fx(), 0.0, rgb_model.cx(),
+    0.0, rgb_model.fy(), rgb_model.cy(),
+    0.0, 0.0, 1.0;
+  const Eigen::Matrix3d kr = rgb_k * depth_to_rgb.linear();
+  const Eigen::Vector3d depth_offset(
+    -depth_model.Tx() / depth_model.fx(), -depth_model.Ty() / depth_model.fy(), 0.0);
+  const Eigen::Vector3d offset =
+    rgb_k * (depth_to_rgb.linear() * depth_offset + depth_to_rgb.translation()) +
+    Eigen::Vector3d(rgb_model.Tx(), rgb_model.Ty(), 0.0);
+
+  DepthToRgbProjection projection;
+  projection.column_x.resize(width);
+  projection.column_y.resize(width);
+  projection.column_z.resize(width);
+  for (int u = 0; u < width; ++u) {
+    const Eigen::Vector3d column = kr.col(0) * ((u - depth_model.cx()) / depth_model.fx());
+    projection.column_x[u] = static_cast<float>(column.x());
+    projection.column_y[u] = static_cast<float>(column.y());
+    projection.column_z[u] = static_cast<float>(column.z());
+  }
+  projection.row_x.resize(height);
+  projection.row_y.resize(height);
+  projection.row_z.resize(height);
+  for (int v = 0; v < height; ++v) {
+    const Eigen::Vector3d row =
+      kr.col(1) * ((v - depth_model.cy()) / depth_model.fy()) + kr.col(2);
+    projection.row_x[v] = static_cast<float>(row.x());
+    projection.row_y[v] = static_cast<float>(row.y());
+    projection.row_z[v] = static_cast<float>(row.z());
+  }
+  projection.offset_x = static_cast<float>(offset.x());
+  projection.offset_y = static_cast<float>(offset.y());
+  projection.offset_z = static_cast<float>(offset.z());
+  return projection;
+}
+
+// Bits of a positive float depth, which order like the depths themselves
+inline uint32_t depthKey(float depth)
+{
+  uint32_t key;
+  std::memcpy(&key, &depth, sizeof(key));
+  return key;
+}
+
+// Rows of the registered image rasterized together by one thread
+constexpr int kTileRows = 16;
+
+// Whether a and b describe the same calibration, ignoring the header
+bool sameCalibration(const sensor_msgs::msg::CameraInfo & a, const sensor_msgs::msg::CameraInfo & b)
+{
+  return a.width == b.width && a.height == b.height && a.k == b.k && a.p == b.p &&
+         a.binning_x == b.binning_x && a.binning_y == b.binning_y && a.roi == b.roi;
+}
+
+// Keeps the smaller of target and value. Positive floats order like their bits.
+inline void atomicMin(std::atomic<uint32_t> & target, uint32_t value)
+{
+  uint32_t current = target.load(std::memory_order_relaxed);
+  while (value < current &&
+    !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+  {
+  }
+}
+
+}  // namespace
+
+StaticTransformCache::StaticTransformCache(rclcpp::Node & node, bool static_transforms)
+: logger_(node.get_logger()),
+  static_(static_transforms)
+{
+  tf_buffer_ = std::make_shared<tf2_ros::Buffer>(node.get_clock());
+  tf_ = std::make_shared<tf2_ros::TransformListener>(*tf_buffer_);
+
+  if (static_) {
+    // Resolve the transform again whenever the static transforms change. The
+    // listener may not have seen them yet, so they are given to the buffer
+    // here too, before the next lookup could cache the previous transform.
+    sub_tf_static_ = node.create_subscription<tf2_msgs::msg::TFMessage>(
+      "/tf_static", tf2_ros::StaticListenerQoS(),
+      [this](tf2_msgs::msg::TFMessage::ConstSharedPtr msg) {
+        for (const auto & transform : msg->transforms) {
+          tf_buffer_->setTransform(transform, "depth_image_proc", true);
+        }
+        stale_ = true;
+      });
+  }
+}
+
+bool StaticTransformCache::lookup(
+  const sensor_msgs::msg::CameraInfo & depth_info,
+  const sensor_msgs::msg::CameraInfo & rgb_info,
+  Eigen::Affine3d & depth_to_rgb)
+{
+  return lookupFrames(depth_info.header, rgb_info.header.frame_id, depth_to_rgb);
+}
+
+bool StaticTransformCache::lookup(
+  const std_msgs::msg::Header & source, const std::string & target_frame,
+  cv::Matx34f & transform)
+{
+  Eigen::Affine3d source_to_target;
+  if (!lookupFrames(source, target_frame, source_to_target)) {
+    return false;
+  }
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      transform(row, col) = static_cast<float>(source_to_target(row, col));
+    }
+  }
+  return true;
+}
+
+uint64_t hashTransform(const cv::Matx34f * transform)
+{
+  if (!transform) {
+    return 0;
+  }
+  uint64_t key = 0;
+  for (float value : transform->val) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    key = image_proc::CameraCache::combineKeys(key, bits);
+  }
+  return key;
+}
+
+bool StaticTransformCache::lookupFrames(
+  const std_msgs::msg::Header & source, const std::string & target_frame,
+  Eigen::Affine3d & transform)
+{
+  const std::string frames = target_frame + " " + source.frame_id;
+  // The stale flag is cleared before the lookup rather than after it, so that
+  // /tf_static arriving during the lookup marks its result stale again
+  if (static_ && frames == frames_ && !stale_.exchange(false)) {
+    transform = transform_;
+    return true;
+  }
+
+  try {
+    // A static transform is valid at any time, use the latest one
+    tf2::TimePoint tf2_time = tf2::TimePointZero;
+    if (!static_) {
+      tf2_time = tf2::TimePoint(
+        std::chrono::nanoseconds(source.stamp.nanosec) +
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::seconds(source.stamp.sec)));
+    }
+    geometry_msgs::msg::TransformStamped stamped = tf_buffer_->lookupTransform(
+      target_frame, source.frame_id, tf2_time);
+    transform = tf2::transformToEigen(stamped);
+  } catch (tf2::TransformException & ex) {
+    // Keep using the previous static transform until the new one resolves
+    if (static_ && frames == frames_) {
+      stale_ = true;
+      RCLCPP_WARN(logger_, "TF2 exception, using previous transform:\n%s", ex.what());
+      transform = transform_;
+      return true;
+    }
+    RCLCPP_ERROR(logger_, "TF2 exception:\n%s", ex.what());
+    return false;
+  }
+
+  if (static_) {
+    transform_ = transform;
+    frames_ = frames;
+  }
+  return true;
+}
+
+constexpr uint32_t RegisteredDepth::kEmptyDepth;
+
+void RegisteredDepth::reset(int width, int height)
+{
+  const size_t pixels = static_cast<size_t>(width) * height;
+  if (static_cast<size_t>(width_) * height_ != pixels) {
+    z_buffer_.reset(new std::atomic<uint32_t>[pixels]);
+  }
+  width_ = width;
+  height_ = height;
+  std::atomic<uint32_t> * z_buffer = z_buffer_.get();
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(pixels)), [&](const cv::Range & range) {
+      for (int i = range.start; i < range.end; ++i) {
+        z_buffer[i].store(kEmptyDepth, std::memory_order_relaxed);
+      }
+    });
+}
+
+template<typename T>
+void RegisteredDepth::write(sensor_msgs::msg::Image & registered_msg) const
+{
+  const std::atomic<uint32_t> * z_buffer = z_buffer_.get();
+  T * registered_data = reinterpret_cast<T *>(registered_msg.data.data());
+  cv::parallel_for_(
+    cv::Range(0, width_ * height_), [&](const cv::Range & range) {
+      for (int i = range.start; i < range.end; ++i) {
+        const uint32_t key = z_buffer[i].load(std::memory_order_relaxed);
+        if (key != kEmptyDepth) {
+          float z;
+          std::memcpy(&z, &key, sizeof(z));
+          registered_data[i] = DepthTraits<T>::fromMeters(z);
+        }
+      }
+    });
+}
+
+bool DepthRegistration::update(
+  const sensor_msgs::msg::CameraInfo & depth_info,
+  const sensor_msgs::msg::CameraInfo & rgb_info,
+  const Eigen::Affine3d & depth_to_rgb)
+{
+  if (has_projection_ &&
+    sameCalibration(depth_info, depth_info_) &&
+    sameCalibration(rgb_info, rgb_info_) &&
+    depth_to_rgb.matrix() == depth_to_rgb_.matrix())
+  {
+    return false;
+  }
+
+  // The models take binning and ROI into account
+  image_geometry::PinholeCameraModel depth_model, rgb_model;
+  depth_model.fromCameraInfo(depth_info);
+  rgb_model.fromCameraInfo(rgb_info);
+  const cv::Size depth_resolution = depth_model.reducedResolution();
+  const cv::Size rgb_resolution = rgb_model.reducedResolution();
+  projection_ = makeProjection(
+    depth_model, rgb_model, depth_to_rgb, depth_resolution.width, depth_resolution.height);
+  width_ = rgb_resolution.width;
+  height_ = rgb_resolution.height;
+  depth_info_ = depth_info;
+  rgb_info_ = rgb_info;
+  depth_to_rgb_ = depth_to_rgb;
+  has_projection_ = true;
+  return true;
+}
+
+template<typename T>
+void DepthRegistration::registerPoints(
+  const sensor_msgs::msg::Image & depth_msg, RegisteredDepth & registered) const
+{
+  const int depth_width = static_cast<int>(depth_msg.width);
+  const int depth_height = static_cast<int>(depth_msg.height);
+  const int width = width_;
+  const int height = height_;
+  const DepthToRgbProjection & projection = projection_;
+
+  registered.reset(width, height);
+  std::atomic<uint32_t> * z_buffer = registered.zBuffer();
+
+  // Project bands of depth rows concurrently, resolving overlaps with an
+  // atomic minimum on the z-buffer
+  cv::parallel_for_(
+    cv::Range(0, depth_height), [&](const cv::Range & range) {
+      std::vector<int> target(depth_width);
+      std::vector<uint32_t> key(depth_width);
+      for (int v = range.start; v < range.end; ++v) {
+        const T * depth_row = reinterpret_cast<const T *>(&depth_msg.data[v * depth_msg.step]);
+        const float row_x = projection.row_x[v];
+        const float row_y = projection.row_y[v];
+        const float row_z = projection.row_z[v];
+
+        // Branch free, so that the compiler can vectorize it
+        for (int u = 0; u < depth_width; ++u) {
+          const T raw_depth = depth_row[u];
+          const bool valid = DepthTraits<T>::valid(raw_depth);
+          const float depth = valid ? DepthTraits<T>::toMeters(raw_depth) : 0.0f;
+          const float x = depth * (projection.column_x[u] + row_x) + projection.offset_x;
+          const float y = depth * (projection.column_y[u] + row_y) + projection.offset_y;
+          const float z = depth * (projection.column_z[u] + row_z) + projection.offset_z;
+          const float inv_z = 1.0f / z;
+          // Truncation towards zero, as the cast to int of the original projection
+          const float u_rgb = x * inv_z + 0.5f;
+          const float v_rgb = y * inv_z + 0.5f;
+          const bool inside = valid && z > 0.0f &&
+            u_rgb > -1.0f && u_rgb < width && v_rgb > -1.0f && v_rgb < height;
+          target[u] = inside ?
+            static_cast<int>(v_rgb) * width + static_cast<int>(u_rgb) : -1;
+          key[u] = depthKey(z);
+        }
+
+        for (int u = 0; u < depth_width; ++u) {
+          if (target[u] >= 0) {
+            atomicMin(z_buffer[target[u]], key[u]);
+          }
+        }
+      }
+    });
+}
+
+template<typename T>
+void DepthRegistration::registerTriangles(
+  const sensor_msgs::msg::Image & depth_msg, double max_depth_discontinuity,
+  RegisteredDepth & registered) const
+{
+  const int depth_width = static_cast<int>(depth_msg.width);
+  const int depth_height = static_cast<int>(depth_msg.height);
+  const int height = height_;
+  const DepthToRgbProjection & projection = projection_;
+
+  // Project every depth pixel, keeping the range of RGB rows each depth row ends up on
+  const size_t count = static_cast<size_t>(depth_width) * depth_height;
+  Vertices vertices;
+  vertices.u.resize(count);
+  vertices.v.resize(count);
+  vertices.z.resize(count);
+  std::vector<float> row_min(depth_height), row_max(depth_height);
+  cv::parallel_for_(
+    cv::Range(0, depth_height), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const T * depth_row = reinterpret_cast<const T *>(&depth_msg.data[v * depth_msg.step]);
+        float * vertex_u = &vertices.u[v * depth_width];
+        float * vertex_v = &vertices.v[v * depth_width];
+        float * vertex_z = &vertices.z[v * depth_width];
+        float min_v = std::numeric_limits<float>::infinity();
+        float max_v = -std::numeric_limits<float>::infinity();
+        for (int u = 0; u < depth_width; ++u) {
+          const T raw_depth = depth_row[u];
+          const bool valid = DepthTraits<T>::valid(raw_depth);
+          const float depth = valid ? DepthTraits<T>::toMeters(raw_depth) : 0.0f;
+          const float x = depth * (projection.column_x[u] + projection.row_x[v]) +
+            projection.offset_x;
+          const float y = depth * (projection.column_y[u] + projection.row_y[v]) +
+            projection.offset_y;
+          const float z = depth * (projection.column_z[u] + projection.row_z[v]) +
+            projection.offset_z;
+          const bool visible = valid && z > 0.0f;
+          vertex_u[u] = x / z;
+          vertex_v[u] = y / z;
+          vertex_z[u] = visible ? z : std::numeric_limits<float>::quiet_NaN();
+          min_v = visible ? std::min(min_v, vertex_v[u]) : min_v;
+          max_v = visible ? std::max(max_v, vertex_v[u]) : max_v;
+        }
+        row_min[v] = min_v;
+        row_max[v] = max_v;
+      }
+    });
+
+  registered.reset(width_, height);
+  std::atomic<uint32_t> * z_buffer = registered.zBuffer();
+
+  // Every thread rasterizes whole tiles of RGB rows, so the z-buffer needs no
+  // synchronization. Only depth rows projecting close to a tile are visited.
+  const float max_discontinuity = static_cast<float>(max_depth_discontinuity);
+  const int tiles = (height + kTileRows - 1) / kTileRows;
+  cv::parallel_for_(
+    cv::Range(0, tiles), [&](const cv::Range & range) {
+      for (int tile = range.start; tile < range.end; ++tile) {
+        const int tile_begin = tile * kTileRows;
+        const int tile_end = std::min(height, tile_begin + kTileRows);
+        for (int v = 0; v + 1 < depth_height; ++v) {
+          const float min_v = std::min(row_min[v], row_min[v + 1]);
+          const float max_v = std::max(row_max[v], row_max[v + 1]);
+          if (max_v < tile_begin - 1 || min_v > tile_end) {
+            continue;
+          }
+          for (int u = 0; u + 1 < depth_width; ++u) {
+            // Split the quad between four neighbouring depth pixels in two triangles
+            const int top_left = v * depth_width + u;
+            const int bottom_left = top_left + depth_width;
+            rasterizeTriangle(
+              vertices, top_left, top_left + 1, bottom_left, tile_begin, tile_end,
+              max_discontinuity, z_buffer);
+            rasterizeTriangle(
+              vertices, top_left + 1, bottom_left + 1, bottom_left, tile_begin, tile_end,
+              max_discontinuity, z_buffer);
+          }
+        }
+      }
+    });
+}
+
+void DepthRegistration::rasterizeTriangle(
+  const Vertices & vertices, int a, int b, int c, int tile_begin, int tile_end,
+  float max_depth_discontinuity, std::atomic<uint32_t> * z_buffer) const
+{
+  const float za = vertices.z[a], zb = vertices.z[b], zc = vertices.z[c];
+  // Also rejects the NaNs of invalid vertices
+  if (!(za > 0.0f && zb > 0.0f && zc > 0.0f)) {
+    return;
+  }
+
+  // Do not bridge depth discontinuities, which would smear object boundaries
+  const float z_min = std::min(za, std::min(zb, zc));
+  const float z_max = std::max(za, std::max(zb, zc));
+  if (z_max - z_min > max_depth_discontinuity * z_min) {
+    return;
+  }
+
+  const float xa = vertices.u[a], xb = vertices.u[b], xc = vertices.u[c];
+  const float ya = vertices.v[a], yb = vertices.v[b], yc = vertices.v[c];
+  const float area = (xb - xa) * (yc - ya) - (yb - ya) * (xc - xa);
+  if (std::abs(area) < 1e-6f) {
+    return;
+  }
+
+  // Pixel centers covered by the bounding box, clipped to the tile
+  const int width = width_;
+  const int y_begin = std::max(
+    tile_begin, static_cast<int>(std::ceil(std::min(ya, std::min(yb, yc)))));
+  const int y_end = std::min(
+    tile_end - 1, static_cast<int>(std::floor(std::max(ya, std::max(yb, yc)))));
+  const int x_begin = std::max(0, static_cast<int>(std::ceil(std::min(xa, std::min(xb, xc)))));
+  const int x_end = std::min(
+    width - 1, static_cast<int>(std::floor(std::max(xa, std::max(xb, xc)))));
+
+  // Depth is interpolated perspective correctly, linearly in 1 / z
+  const float inv_area = 1.0f / area;
+  const float inv_za = 1.0f / za, inv_zb = 1.0f / zb, inv_zc = 1.0f / zc;
+
+  for (int y = y_begin; y <= y_end; ++y) {
+    std::atomic<uint32_t> * z_row = z_buffer + static_cast<size_t>(y) * width;
+    for (int x = x_begin; x <= x_end; ++x) {
+      // Barycentric coordinates from the edge functions
+      const float wa = ((xb - x) * (yc - y) - (yb - y) * (xc - x)) * inv_area;
+      const float wb = ((xc - x) * (ya - y) - (yc - y) * (xa - x)) * inv_area;
+      const float wc = 1.0f - wa - wb;
+      if (wa < 0.0f || wb < 0.0f || wc < 0.0f) {
+        continue;
+      }
+      const uint32_t key = depthKey(1.0f / (wa * inv_za + wb * inv_zb + wc * inv_zc));
+      // Rows belong to a single tile, plain loads and stores are enough
+      if (key < z_row[x].load(std::memory_order_relaxed)) {
+        z_row[x].store(key, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+// force template instantiation
+template void RegisteredDepth::write<uint16_t>(
+  sensor_msgs::msg::Image & registered_msg) const;
+template void RegisteredDepth::write<float>(
+  sensor_msgs::msg::Image & registered_msg) const;
+template void DepthRegistration::registerPoints<uint16_t>(
+  const sensor_msgs::msg::Image & depth_msg, RegisteredDepth & registered) const;
+template void DepthRegistration::registerPoints<float>(
+  const sensor_msgs::msg::Image & depth_msg, RegisteredDepth & registered) const;
+template void DepthRegistration::registerTriangles<uint16_t>(
+  const sensor_msgs::msg::Image & depth_msg, double max_depth_discontinuity,
+  RegisteredDepth & registered) const;
+template void DepthRegistration::registerTriangles<float>(
+  const sensor_msgs::msg::Image & depth_msg, double max_depth_discontinuity,
+  RegisteredDepth & registered) const;
+
+}  // namespace depth_image_proc
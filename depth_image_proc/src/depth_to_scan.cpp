@@ -0,0 +1,375 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "depth_image_proc/visibility.h"
+#include "image_geometry/pinhole_camera_model.hpp"
+
+#include <depth_image_proc/conversions.hpp>
+#include <depth_image_proc/depth_to_scan.hpp>
+#include <depth_image_proc/depth_traits.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_transport/image_transport.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/laser_scan.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+namespace enc = sensor_msgs::image_encodings;
+
+void ScanLayout::update(const DepthRayLut & lut)
+{
+  const int width = lut.width();
+  bin_.assign(width, 0);
+  nearest_.assign(width, 0);
+  scale_.resize(width);
+  if (width == 0) {
+    bin_count_ = 0;
+    return;
+  }
+
+  const float * x = lut.x();
+  angle_min_ = -std::atan(x[width - 1]);
+  angle_max_ = -std::atan(x[0]);
+  bin_count_ = width;
+  angle_increment_ = width > 1 ? (angle_max_ - angle_min_) / (width - 1) : 0.0f;
+  for (int u = 0; u < width; ++u) {
+    scale_[u] = std::sqrt(1.0f + x[u] * x[u]);
+    if (angle_increment_ > 0.0f) {
+      const long bin = std::lround((-std::atan(x[u]) - angle_min_) / angle_increment_);  // NOLINT
+      bin_[u] = static_cast<int>(std::min<long>(std::max<long>(bin, 0), width - 1));  // NOLINT
+    }
+  }
+
+  // The angle falls from the first column to the last, so walk the columns
+  // backwards as the bins rise
+  int u = width - 1;
+  for (int b = 0; b < width; ++b) {
+    const float angle = angle_min_ + b * angle_increment_;
+    while (u > 0 && std::abs(-std::atan(x[u - 1]) - angle) <= std::abs(-std::atan(x[u]) - angle)) {
+      --u;
+    }
+    nearest_[b] = u;
+  }
+}
+
+namespace
+{
+
+// Depths of a row in meters, NaN where invalid
+template<typename T>
+const float * metersRow(const T * raw, int width, std::vector<float> & buffer)
+{
+  buffer.resize(width);
+  for (int u = 0; u < width; ++u) {
+    buffer[u] = DepthTraits<T>::valid(raw[u]) ?
+      DepthTraits<T>::toMeters(raw[u]) : std::numeric_limits<float>::quiet_NaN();
+  }
+  return buffer.data();
+}
+
+// Float depths are already meters, and the invalid ones fail the range check
+const float * metersRow(const float * raw, int width, std::vector<float> & buffer)
+{
+  (void) width;
+  (void) buffer;
+  return raw;
+}
+
+// Lowers every ranges[u] to the range of depth[u] if it is from range_min to
+// range_max, and flags too_close[u] if it is below range_min. NaN depths
+// compare false and are left out.
+void minRangeRow(
+  const float * depth, const float * scale, int width, float range_min, float range_max,
+  float * ranges, float * too_close)
+{
+  int u = 0;
+#if CV_SIMD128
+  const cv::v_float32x4 low = cv::v_setall_f32(range_min);
+  const cv::v_float32x4 high = cv::v_setall_f32(range_max);
+  const cv::v_float32x4 none = cv::v_setall_f32(std::numeric_limits<float>::infinity());
+  const cv::v_float32x4 one = cv::v_setall_f32(1.0f);
+  for (; u + 4 <= width; u += 4) {
+    const cv::v_float32x4 range = cv::v_load(depth + u) * cv::v_load(scale + u);
+    const cv::v_float32x4 in_range = (range >= low) & (range <= high);
+    cv::v_store(ranges + u, cv::v_min(cv::v_load(ranges + u), cv::v_select(in_range, range, none)));
+    cv::v_store(too_close + u, cv::v_select(range < low, one, cv::v_load(too_close + u)));
+  }
+#endif
+  for (; u < width; ++u) {
+    const float range = depth[u] * scale[u];
+    if (range >= range_min && range <= range_max) {
+      ranges[u] = std::min(ranges[u], range);
+    } else if (range < range_min) {
+      too_close[u] = 1.0f;
+    }
+  }
+}
+
+// Combines two ranges of a bin: the smaller finite one, else -inf over +inf
+float closerRange(float current, float range)
+{
+  if (std::isnan(current)) {
+    return range;
+  }
+  if (std::isfinite(current) != std::isfinite(range)) {
+    return std::isfinite(current) ? current : range;
+  }
+  return std::min(current, range);
+}
+
+template<typename T>
+void reduceBand(
+  const sensor_msgs::msg::Image & depth_msg, int first_row, int last_row,
+  const ScanLayout & layout, float range_min, float range_max, std::vector<float> & ranges)
+{
+  const int width = static_cast<int>(depth_msg.width);
+
+  // Smallest range of every column over the band, one row at a time
+  std::vector<float> columns(width, std::numeric_limits<float>::infinity());
+  std::vector<float> too_close(width, 0.0f);
+  std::vector<float> buffer;
+  for (int v = first_row; v < last_row; ++v) {
+    const T * raw = reinterpret_cast<const T *>(&depth_msg.data[v * depth_msg.step]);
+    minRangeRow(
+      metersRow(raw, width, buffer), layout.scale(), width, range_min, range_max,
+      columns.data(), too_close.data());
+  }
+  for (int u = 0; u < width; ++u) {
+    if (std::isinf(columns[u]) && too_close[u] != 0.0f) {
+      columns[u] = -std::numeric_limits<float>::infinity();
+    }
+  }
+
+  // Smallest range of the columns of every bin, or of the column nearest to
+  // a bin no column rounds to
+  ranges.assign(layout.bins(), std::numeric_limits<float>::quiet_NaN());
+  const int * bin = layout.bin();
+  for (int u = 0; u < width; ++u) {
+    ranges[bin[u]] = closerRange(ranges[bin[u]], columns[u]);
+  }
+  const int * nearest = layout.nearest();
+  for (size_t b = 0; b < ranges.size(); ++b) {
+    if (std::isnan(ranges[b])) {
+      ranges[b] = columns[nearest[b]];
+    }
+  }
+}
+
+}  // namespace
+
+bool depthToScan(
+  const sensor_msgs::msg::Image & depth_msg, int first_row, int rows,
+  const ScanLayout & layout, float range_min, float range_max, std::vector<float> & ranges)
+{
+  if (layout.width() != static_cast<int>(depth_msg.width)) {
+    return false;
+  }
+  const int last_row = std::min(first_row + rows, static_cast<int>(depth_msg.height));
+  first_row = std::max(first_row, 0);
+  if (depth_msg.encoding == enc::TYPE_32FC1) {
+    reduceBand<float>(depth_msg, first_row, last_row, layout, range_min, range_max, ranges);
+  } else if (depth_msg.encoding == enc::TYPE_16UC1 || depth_msg.encoding == enc::MONO16) {
+    reduceBand<uint16_t>(depth_msg, first_row, last_row, layout, range_min, range_max, ranges);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+class DepthToScanNode : public rclcpp::Node
+{
+public:
+  DEPTH_IMAGE_PROC_PUBLIC DepthToScanNode(const rclcpp::NodeOptions & options);
+
+private:
+  using Image = sensor_msgs::msg::Image;
+  using CameraInfo = sensor_msgs::msg::CameraInfo;
+  using LaserScan = sensor_msgs::msg::LaserScan;
+
+  // Subscriptions
+  image_transport::CameraSubscriber sub_depth_;
+  int queue_size_;
+
+  // Parameters
+  int scan_row_;
+  int scan_height_;
+  double range_min_;
+  double range_max_;
+  double scan_time_;
+  std::string output_frame_;
+
+  // Publications
+  std::mutex connect_mutex_;
+  rclcpp::Publisher<LaserScan>::SharedPtr pub_scan_;
+
+  // Layout of the scans, rebuilt when the ray table changes
+  std::shared_ptr<const DepthRayLut> ray_lut_;
+  ScanLayout layout_;
+
+  void depthCb(
+    const Image::ConstSharedPtr & depth_msg,
+    const CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+};
+
+DepthToScanNode::DepthToScanNode(const rclcpp::NodeOptions & options)
+: Node("DepthToScanNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("depth_image_transport", "raw");
+
+  // Read parameters
+  queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  scan_row_ = this->declare_parameter<int>("scan_row", -1);
+  scan_height_ = this->declare_parameter<int>("scan_height", 1);
+  if (scan_height_ < 1) {
+    RCLCPP_WARN(get_logger(), "Invalid scan_height %d, using 1 instead", scan_height_);
+    scan_height_ = 1;
+  }
+  range_min_ = this->declare_parameter<double>("range_min", 0.45);
+  range_max_ = this->declare_parameter<double>("range_max", 10.0);
+  scan_time_ = this->declare_parameter<double>("scan_time", 0.033);
+  output_frame_ = this->declare_parameter<std::string>("output_frame", "camera_depth_frame");
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
+  // Create publisher with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this](rclcpp::MatchedInfo & s)
+    {
+      std::lock_guard<std::mutex> lock(connect_mutex_);
+      if (s.current_count == 0) {
+        sub_depth_.shutdown();
+      } else if (!sub_depth_) {
+        // For compressed topics to remap appropriately, we need to pass a
+        // fully expanded and remapped topic name to image_transport
+        auto node_base = this->get_node_base_interface();
+        std::string topic = node_base->resolve_topic_or_service_name("image_rect", false);
+
+        // Get transport and QoS
+        image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
+        auto custom_qos = rmw_qos_profile_system_default;
+        custom_qos.depth = latest_only_->queueSize(queue_size_);
+
+        sub_depth_ = image_transport::create_camera_subscription(
+          this,
+          topic,
+          std::bind(
+            &DepthToScanNode::depthCb, this, std::placeholders::_1,
+            std::placeholders::_2),
+          depth_hints.getTransport(),
+          custom_qos);
+      }
+    };
+  pub_scan_ = create_publisher<LaserScan>("scan", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void DepthToScanNode::depthCb(
+  const Image::ConstSharedPtr & depth_msg,
+  const CameraInfo::ConstSharedPtr & info_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/depth_to_scan", depth_msg.get(), depth_msg->width,
+    depth_msg->height, depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Camera model and ray table, shared with the other nodes of the process
+  const auto model = image_proc::CameraCache::instance().pinholeModel(*info_msg);
+  const auto ray_lut = DepthRayLut::get(*model, depth_msg->width, depth_msg->height);
+  if (ray_lut != ray_lut_) {
+    layout_.update(*ray_lut);
+    ray_lut_ = ray_lut;
+  }
+
+  // Band of scan_height rows centered on scan_row, or on the optical center
+  const int center = scan_row_ < 0 ? static_cast<int>(std::lround(model->cy())) : scan_row_;
+  const int first_row = center - scan_height_ / 2;
+
+  auto scan_msg = std::make_unique<LaserScan>();
+  scan_msg->header = depth_msg->header;
+  scan_msg->header.frame_id = output_frame_;
+  scan_msg->angle_min = layout_.angleMin();
+  scan_msg->angle_max = layout_.angleMax();
+  scan_msg->angle_increment = layout_.angleIncrement();
+  scan_msg->time_increment = 0.0f;
+  scan_msg->scan_time = static_cast<float>(scan_time_);
+  scan_msg->range_min = static_cast<float>(range_min_);
+  scan_msg->range_max = static_cast<float>(range_max_);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", depth_msg.get());
+    if (!depthToScan(
+        *depth_msg, first_row, scan_height_, layout_, scan_msg->range_min, scan_msg->range_max,
+        scan_msg->ranges))
+    {
+      RCLCPP_ERROR(
+        get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
+      return;
+    }
+  }
+
+  pub_scan_->publish(std::move(scan_msg));
+  frame.published(depth_msg->header.stamp);
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::DepthToScanNode)
@@ -30,6 +30,9 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -40,17 +43,69 @@
 #include "message_filters/subscriber.hpp"
 #include "message_filters/time_synchronizer.hpp"
 
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <stereo_msgs/msg/disparity_image.hpp>
 #include <depth_image_proc/depth_traits.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
 
+namespace
+{
+
+// 1 / d for every uint16 depth, zero for the invalid zero
+const float * reciprocals()
+{
+  static const std::array<float, 65536> table = [] {
+      std::array<float, 65536> t;
+      t[0] = 0.0f;
+      for (size_t depth = 1; depth < t.size(); ++depth) {
+        t[depth] = 1.0f / depth;
+      }
+      return t;
+    }();
+  return table.data();
+}
+
+// Writes constant / depth for every depth of the row, zero for invalid ones
+void convertRow(const uint16_t * depth, float * disparity, int width, float constant)
+{
+  const float * table = reciprocals();
+  for (int u = 0; u < width; ++u) {
+    disparity[u] = constant * table[depth[u]];
+  }
+}
+
+void convertRow(const float * depth, float * disparity, int width, float constant)
+{
+  int u = 0;
+#if CV_SIMD128
+  const cv::v_float32x4 v_constant = cv::v_setall_f32(constant);
+  const cv::v_float32x4 infinity = cv::v_setall_f32(std::numeric_limits<float>::infinity());
+  const cv::v_float32x4 zero = cv::v_setzero_f32();
+  for (; u + 4 <= width; u += 4) {
+    const cv::v_float32x4 z = cv::v_load(depth + u);
+    // False for NaN as well as for both infinities
+    const cv::v_float32x4 valid = cv::v_abs(z) < infinity;
+    cv::v_store(disparity + u, cv::v_select(valid, v_constant / z, zero));
+  }
+#endif
+  for (; u < width; ++u) {
+    disparity[u] = DepthTraits<float>::valid(depth[u]) ? constant / depth[u] : 0.0f;
+  }
+}
+
+}  // namespace
+
 class DisparityNode : public rclcpp::Node
 {
 public:
@@ -70,6 +125,9 @@ private:
   double max_range_;
   double delta_d_;
 
+  // Reused from frame to frame, so that the pixels are not reallocated
+  DisparityImage disp_msg_;
+
   void depthCb(
     const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg);
@@ -77,7 +135,10 @@ private:
   template<typename T>
   void convert(
     const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
-    stereo_msgs::msg::DisparityImage::SharedPtr & disp_msg);
+    stereo_msgs::msg::DisparityImage & disp_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
 };
 
 DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
@@ -88,6 +149,7 @@ DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
 
   // Read parameters
   int queue_size = this->declare_parameter<int>("queue_size", 5);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
   min_range_ = this->declare_parameter<double>("min_range", 0.0);
   max_range_ = this->declare_parameter<double>(
     "max_range",
@@ -95,7 +157,8 @@ DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
   delta_d_ = this->declare_parameter<double>("delta_d", 0.125);
 
   // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
-  sync_ = std::make_shared<Sync>(sub_depth_image_, sub_info_, queue_size);
+  sync_ = std::make_shared<Sync>(
+    sub_depth_image_, sub_info_, latest_only_->queueSize(queue_size));
   sync_->registerCallback(
     std::bind(
       &DisparityNode::depthCb, this, std::placeholders::_1, std::placeholders::_2));
@@ -115,33 +178,47 @@ DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
         auto node_base = this->get_node_base_interface();
         std::string topic = node_base->resolve_topic_or_service_name("left/image_rect", false);
         image_transport::TransportHints hints(this);
-        sub_depth_image_.subscribe(this, topic, hints.getTransport());
-        sub_info_.subscribe(this, "right/camera_info", rclcpp::QoS(10));
+        sub_depth_image_.subscribe(
+          this, topic, hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_info_.subscribe(this, "right/camera_info", latest_only_->qos(rclcpp::QoS(10)));
       }
     };
   pub_disparity_ = create_publisher<stereo_msgs::msg::DisparityImage>(
     "left/disparity", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void DisparityNode::depthCb(
   const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
 {
-  auto disp_msg = std::make_shared<DisparityImage>();
-  disp_msg->header = depth_msg->header;
-  disp_msg->image.header = disp_msg->header;
-  disp_msg->image.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-  disp_msg->image.height = depth_msg->height;
-  disp_msg->image.width = depth_msg->width;
-  disp_msg->image.step = disp_msg->image.width * sizeof(float);
-  disp_msg->image.data.resize(disp_msg->image.height * disp_msg->image.step, 0.0f);
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/disparity", depth_msg.get(), depth_msg->width, depth_msg->height,
+    depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Every pixel is written by convert(), the buffer needs no clearing
+  DisparityImage & disp_msg = disp_msg_;
+  disp_msg.header = depth_msg->header;
+  disp_msg.image.header = disp_msg.header;
+  disp_msg.image.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+  disp_msg.image.height = depth_msg->height;
+  disp_msg.image.width = depth_msg->width;
+  disp_msg.image.step = disp_msg.image.width * sizeof(float);
+  disp_msg.image.data.resize(disp_msg.image.height * disp_msg.image.step);
   double fx = info_msg->p[0];
-  disp_msg->t = -info_msg->p[3] / fx;
-  disp_msg->f = fx;
+  disp_msg.t = -info_msg->p[3] / fx;
+  disp_msg.f = fx;
   // Remaining fields depend on device characteristics, so rely on user input
-  disp_msg->min_disparity = disp_msg->f * disp_msg->t / max_range_;
-  disp_msg->max_disparity = disp_msg->f * disp_msg->t / min_range_;
-  disp_msg->delta_d = delta_d_;
+  disp_msg.min_disparity = disp_msg.f * disp_msg.t / max_range_;
+  disp_msg.max_disparity = disp_msg.f * disp_msg.t / min_range_;
+  disp_msg.delta_d = delta_d_;
 
   if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
     convert<uint16_t>(depth_msg, disp_msg);
@@ -153,32 +230,32 @@ void DisparityNode::depthCb(
     return;
   }
 
-  pub_disparity_->publish(*disp_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    pub_disparity_->publish(disp_msg);
+    frame.published(depth_msg->header.stamp);
+  }
 }
 
 template<typename T>
 void DisparityNode::convert(
   const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
-  stereo_msgs::msg::DisparityImage::SharedPtr & disp_msg)
+  stereo_msgs::msg::DisparityImage & disp_msg)
 {
   // For each depth Z, disparity d = fT / Z
   float unit_scaling = DepthTraits<T>::toMeters(T(1) );
-  float constant = disp_msg->f * disp_msg->t / unit_scaling;
-
-  const T * depth_row = reinterpret_cast<const T *>(&depth_msg->data[0]);
-  int row_step = depth_msg->step / sizeof(T);
-  float * disp_data = reinterpret_cast<float *>(&disp_msg->image.data[0]);
-  for (int v = 0; v < static_cast<int>(depth_msg->height); ++v) {
-    for (int u = 0; u < static_cast<int>(depth_msg->width); ++u) {
-      T depth = depth_row[u];
-      if (DepthTraits<T>::valid(depth)) {
-        *disp_data = constant / depth;
-      }
-      ++disp_data;
-    }
+  float constant = disp_msg.f * disp_msg.t / unit_scaling;
 
-    depth_row += row_step;
-  }
+  const int width = static_cast<int>(depth_msg->width);
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(depth_msg->height)), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        convertRow(
+          reinterpret_cast<const T *>(&depth_msg->data[v * depth_msg->step]),
+          reinterpret_cast<float *>(&disp_msg.image.data[v * disp_msg.image.step]),
+          width, constant);
+      }
+    });
 }
 
 }  // namespace depth_image_proc
@@ -0,0 +1,521 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <depth_image_proc/downsampling.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <depth_image_proc/depth_traits.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+
+namespace depth_image_proc
+{
+
+namespace
+{
+
+// Running sums of the points in one voxel
+struct Voxel
+{
+  float x, y, z;
+  uint32_t r, g, b;
+  uint32_t count;
+};
+
+using VoxelMap = std::unordered_map<uint64_t, Voxel>;
+
+// Packs the voxel indices of a point into 21 bits per axis, which wrap
+// around only for clouds millions of voxels across
+inline uint64_t voxelKey(float x, float y, float z, float inv_size)
+{
+  auto index = [inv_size](float coordinate) {
+      const int64_t i = static_cast<int64_t>(std::floor(coordinate * inv_size));
+      return static_cast<uint64_t>(i + (1 << 20)) & 0x1fffff;
+    };
+  return index(x) << 42 | index(y) << 21 | index(z);
+}
+
+// Whichever of best and depth is the nearer valid depth
+template<typename T>
+inline T nearer(T best, T depth)
+{
+  return DepthTraits<T>::valid(depth) && !(DepthTraits<T>::valid(best) && best <= depth) ?
+         depth : best;
+}
+
+#if CV_SIMD128
+// Minimum pooling of factor 2 or 4 blocks, 8 blocks at a time. Subtracting
+// one with wrap around turns invalid zeros into the largest key, so the
+// plain minimum of the keys skips them, and adding one back leaves a zero for
+// blocks without a valid depth. Returns the number of blocks done.
+int minPoolRow(const uint8_t * rows, size_t step, int factor, int width, uint16_t * out)
+{
+  if (factor != 2 && factor != 4) {
+    return 0;
+  }
+  const v_uint16x8 one = v_setall_u16(1);
+  int u = 0;
+  for (; u + 8 <= width; u += 8) {
+    v_uint16x8 best = v_setall_u16(0xffff);
+    for (int dy = 0; dy < factor; ++dy) {
+      const uint16_t * block = reinterpret_cast<const uint16_t *>(rows + dy * step) + u * factor;
+      v_uint16x8 a, b, c, d;
+      if (factor == 2) {
+        v_load_deinterleave(block, a, b);
+      } else {
+        v_load_deinterleave(block, a, b, c, d);
+        best = v_min(best, v_min(v_sub_wrap(c, one), v_sub_wrap(d, one)));
+      }
+      best = v_min(best, v_min(v_sub_wrap(a, one), v_sub_wrap(b, one)));
+    }
+    v_store(out + u, v_add_wrap(best, one));
+  }
+  return u;
+}
+
+// Same for float depths, 4 blocks at a time. Non finite depths, NaN included,
+// fail the comparison and are keyed as infinity, which blocks without a valid
+// depth turn back into NaN.
+int minPoolRow(const uint8_t * rows, size_t step, int factor, int width, float * out)
+{
+  if (factor != 2 && factor != 4) {
+    return 0;
+  }
+  const v_float32x4 inf = v_setall_f32(std::numeric_limits<float>::infinity());
+  const v_float32x4 nan = v_setall_f32(std::numeric_limits<float>::quiet_NaN());
+  auto key = [&inf](const v_float32x4 & depth) {
+      return v_select(v_abs(depth) < inf, depth, inf);
+    };
+  int u = 0;
+  for (; u + 4 <= width; u += 4) {
+    v_float32x4 best = inf;
+    for (int dy = 0; dy < factor; ++dy) {
+      const float * block = reinterpret_cast<const float *>(rows + dy * step) + u * factor;
+      v_float32x4 a, b, c, d;
+      if (factor == 2) {
+        v_load_deinterleave(block, a, b);
+      } else {
+        v_load_deinterleave(block, a, b, c, d);
+        best = v_min(best, v_min(key(c), key(d)));
+      }
+      best = v_min(best, v_min(key(a), key(b)));
+    }
+    v_store(out + u, v_select(best < inf, best, nan));
+  }
+  return u;
+}
+#else
+template<typename T>
+int minPoolRow(const uint8_t *, size_t, int, int, T *)
+{
+  return 0;
+}
+#endif
+
+// Offsets within a factor x factor block, nearest to its center first
+std::vector<int> centerOutOffsets(int factor, size_t step, size_t pixel_size)
+{
+  std::vector<int> order(factor * factor);
+  for (int i = 0; i < factor * factor; ++i) {
+    order[i] = i;
+  }
+  auto distance = [factor](int i) {
+      const int dx = 2 * (i % factor) - (factor - 1);
+      const int dy = 2 * (i / factor) - (factor - 1);
+      return dx * dx + dy * dy;
+    };
+  std::stable_sort(
+    order.begin(), order.end(), [&distance](int a, int b) {return distance(a) < distance(b);});
+
+  std::vector<int> offsets(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    offsets[i] = static_cast<int>((order[i] / factor) * step + (order[i] % factor) * pixel_size);
+  }
+  return offsets;
+}
+
+template<typename T>
+void reduceDepth(
+  const sensor_msgs::msg::Image & depth_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::Image & reduced_msg)
+{
+  const int factor = downsampling.factor;
+  const int width = static_cast<int>(reduced_msg.width);
+  const std::vector<int> offsets = downsampling.mode == DownsampleMode::NEAREST ?
+    centerOutOffsets(factor, depth_msg.step, sizeof(T)) : std::vector<int>();
+  // NaN for float depths, 0 for uint16 ones
+  const T invalid = std::numeric_limits<T>::quiet_NaN();
+
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(reduced_msg.height)), [&](const cv::Range & range) {
+      std::vector<T> valid;
+      valid.reserve(factor * factor);
+      for (int v = range.start; v < range.end; ++v) {
+        T * out = reinterpret_cast<T *>(&reduced_msg.data[v * reduced_msg.step]);
+        const uint8_t * rows = &depth_msg.data[v * factor * depth_msg.step];
+        const T * row = reinterpret_cast<const T *>(rows);
+
+        switch (downsampling.mode) {
+          case DownsampleMode::MIN:
+            for (int u = minPoolRow(rows, depth_msg.step, factor, width, out); u < width; ++u) {
+              T best = invalid;
+              for (int dy = 0; dy < factor; ++dy) {
+                const T * block =
+                  reinterpret_cast<const T *>(rows + dy * depth_msg.step) + u * factor;
+                for (int dx = 0; dx < factor; ++dx) {
+                  best = nearer(best, block[dx]);
+                }
+              }
+              out[u] = best;
+            }
+            break;
+          case DownsampleMode::MEDIAN:
+            for (int u = 0; u < width; ++u) {
+              valid.clear();
+              for (int dy = 0; dy < factor; ++dy) {
+                const T * block =
+                  reinterpret_cast<const T *>(rows + dy * depth_msg.step) + u * factor;
+                for (int dx = 0; dx < factor; ++dx) {
+                  if (DepthTraits<T>::valid(block[dx])) {
+                    valid.push_back(block[dx]);
+                  }
+                }
+              }
+              if (valid.empty()) {
+                out[u] = invalid;
+                continue;
+              }
+              auto median = valid.begin() + (valid.size() - 1) / 2;
+              std::nth_element(valid.begin(), median, valid.end());
+              out[u] = *median;
+            }
+            break;
+          case DownsampleMode::NEAREST:
+            for (int u = 0; u < width; ++u) {
+              const uint8_t * block = rows + u * factor * sizeof(T);
+              out[u] = invalid;
+              for (int offset : offsets) {
+                const T depth = *reinterpret_cast<const T *>(block + offset);
+                if (DepthTraits<T>::valid(depth)) {
+                  out[u] = depth;
+                  break;
+                }
+              }
+            }
+            break;
+          default:
+            for (int u = 0; u < width; ++u) {
+              out[u] = row[u * factor];
+            }
+            break;
+        }
+      }
+    });
+}
+
+template<typename T>
+void voxelize(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  const sensor_msgs::msg::Image * rgb_msg,
+  int red_offset, int green_offset, int blue_offset, int color_step,
+  sensor_msgs::msg::PointCloud2 & cloud_msg)
+{
+  const int rows = static_cast<int>(depth_msg.height);
+  const int width = static_cast<int>(depth_msg.width);
+  const float inv_size = static_cast<float>(1.0 / voxel_size);
+
+  // Every band of rows fills its own map, merged afterwards
+  const int bands = std::max(1, std::min(rows, cv::getNumThreads()));
+  std::vector<VoxelMap> maps(bands);
+  cv::parallel_for_(
+    cv::Range(0, bands), [&](const cv::Range & range) {
+      for (int band = range.start; band < range.end; ++band) {
+        VoxelMap & map = maps[band];
+        const int begin = static_cast<int>(static_cast<int64_t>(rows) * band / bands);
+        const int end = static_cast<int>(static_cast<int64_t>(rows) * (band + 1) / bands);
+        for (int v = begin; v < end; ++v) {
+          const T * depth_row = reinterpret_cast<const T *>(&depth_msg.data[v * depth_msg.step]);
+          const uint8_t * color = rgb_msg ? &rgb_msg->data[v * rgb_msg->step] : nullptr;
+          const float ray_y = lut.y()[v];
+          for (int u = 0; u < width; ++u) {
+            const T depth = depth_row[u];
+            if (!DepthTraits<T>::valid(depth)) {
+              continue;
+            }
+            const float z = DepthTraits<T>::toMeters(depth);
+            const float x = lut.x()[u] * z;
+            const float y = ray_y * z;
+            Voxel & voxel = map[voxelKey(x, y, z, inv_size)];
+            voxel.x += x;
+            voxel.y += y;
+            voxel.z += z;
+            ++voxel.count;
+            if (color) {
+              const uint8_t * pixel = color + u * color_step;
+              voxel.r += pixel[red_offset];
+              voxel.g += pixel[green_offset];
+              voxel.b += pixel[blue_offset];
+            }
+          }
+        }
+      }
+    });
+
+  VoxelMap & voxels = maps[0];
+  for (int band = 1; band < bands; ++band) {
+    for (const auto & entry : maps[band]) {
+      Voxel & voxel = voxels[entry.first];
+      voxel.x += entry.second.x;
+      voxel.y += entry.second.y;
+      voxel.z += entry.second.z;
+      voxel.r += entry.second.r;
+      voxel.g += entry.second.g;
+      voxel.b += entry.second.b;
+      voxel.count += entry.second.count;
+    }
+  }
+
+  cloud_msg.header = depth_msg.header;
+  cloud_msg.height = 1;
+  cloud_msg.width = 0;
+  cloud_msg.is_dense = true;
+  cloud_msg.is_bigendian = false;
+  sensor_msgs::PointCloud2Modifier modifier(cloud_msg);
+  if (rgb_msg) {
+    modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+  } else {
+    modifier.setPointCloud2FieldsByString(1, "xyz");
+  }
+  modifier.resize(voxels.size());
+
+  sensor_msgs::PointCloud2Iterator<float> iter_x(cloud_msg, "x");
+  for (const auto & entry : voxels) {
+    const Voxel & voxel = entry.second;
+    const float inv_count = 1.0f / voxel.count;
+    iter_x[0] = voxel.x * inv_count;
+    iter_x[1] = voxel.y * inv_count;
+    iter_x[2] = voxel.z * inv_count;
+    ++iter_x;
+  }
+  if (rgb_msg) {
+    sensor_msgs::PointCloud2Iterator<uint8_t> iter_r(cloud_msg, "r");
+    sensor_msgs::PointCloud2Iterator<uint8_t> iter_g(cloud_msg, "g");
+    sensor_msgs::PointCloud2Iterator<uint8_t> iter_b(cloud_msg, "b");
+    for (const auto & entry : voxels) {
+      const Voxel & voxel = entry.second;
+      *iter_r = static_cast<uint8_t>(voxel.r / voxel.count);
+      *iter_g = static_cast<uint8_t>(voxel.g / voxel.count);
+      *iter_b = static_cast<uint8_t>(voxel.b / voxel.count);
+      ++iter_r;
+      ++iter_g;
+      ++iter_b;
+    }
+  }
+}
+
+}  // namespace
+
+Downsampling declareDownsamplingParameters(rclcpp::Node & node)
+{
+  Downsampling downsampling;
+
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.description =
+    "How to thin out points before the cloud is built: none (default), stride, "
+    "min, median, nearest or voxel.";
+  std::string mode = node.declare_parameter<std::string>("downsample", "none", descriptor);
+  downsampling.factor = node.declare_parameter<int>("downsample_factor", 2);
+  downsampling.voxel_size = node.declare_parameter<double>("voxel_size", 0.05);
+
+  if (mode == "stride") {
+    downsampling.mode = DownsampleMode::STRIDE;
+  } else if (mode == "min") {
+    downsampling.mode = DownsampleMode::MIN;
+  } else if (mode == "median") {
+    downsampling.mode = DownsampleMode::MEDIAN;
+  } else if (mode == "nearest") {
+    downsampling.mode = DownsampleMode::NEAREST;
+  } else if (mode == "voxel") {
+    downsampling.mode = DownsampleMode::VOXEL;
+  } else if (mode != "none") {
+    RCLCPP_WARN(node.get_logger(), "Unknown downsample mode [%s], not downsampling", mode.c_str());
+  }
+  if (downsampling.factor < 1) {
+    RCLCPP_WARN(
+      node.get_logger(), "Invalid downsample_factor %d, using 2 instead", downsampling.factor);
+    downsampling.factor = 2;
+  }
+  if (!(downsampling.voxel_size > 0.0)) {
+    RCLCPP_WARN(
+      node.get_logger(), "Invalid voxel_size %f, using 0.05 instead", downsampling.voxel_size);
+    downsampling.voxel_size = 0.05;
+  }
+  return downsampling;
+}
+
+bool downsampleDepth(
+  const sensor_msgs::msg::Image & depth_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::Image & reduced_msg)
+{
+  const bool is_float = depth_msg.encoding == sensor_msgs::image_encodings::TYPE_32FC1;
+  if (!is_float && depth_msg.encoding != sensor_msgs::image_encodings::TYPE_16UC1 &&
+    depth_msg.encoding != sensor_msgs::image_encodings::MONO16)
+  {
+    return false;
+  }
+
+  reduced_msg.header = depth_msg.header;
+  reduced_msg.encoding = depth_msg.encoding;
+  reduced_msg.is_bigendian = depth_msg.is_bigendian;
+  reduced_msg.width = depth_msg.width / downsampling.factor;
+  reduced_msg.height = depth_msg.height / downsampling.factor;
+  reduced_msg.step = reduced_msg.width * (is_float ? sizeof(float) : sizeof(uint16_t));
+  reduced_msg.data.resize(reduced_msg.height * reduced_msg.step);
+
+  if (is_float) {
+    reduceDepth<float>(depth_msg, downsampling, reduced_msg);
+  } else {
+    reduceDepth<uint16_t>(depth_msg, downsampling, reduced_msg);
+  }
+  return true;
+}
+
+void downsampleCameraInfo(
+  const sensor_msgs::msg::CameraInfo & info_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::CameraInfo & reduced_msg)
+{
+  const uint32_t factor = downsampling.factor;
+  // Offsets are in full resolution sensor pixels, which binning enlarges
+  const double offset_x = downsampling.rayOffset() * std::max<uint32_t>(info_msg.binning_x, 1);
+  const double offset_y = downsampling.rayOffset() * std::max<uint32_t>(info_msg.binning_y, 1);
+
+  reduced_msg = info_msg;
+  reduced_msg.width = info_msg.width / factor;
+  reduced_msg.height = info_msg.height / factor;
+  // Maps reduced pixels onto the original ones, x = factor * x' + offset_x, in
+  // the first two rows of both projections
+  for (int col = 0; col < 3; ++col) {
+    reduced_msg.k[col] = (info_msg.k[col] - offset_x * info_msg.k[6 + col]) / factor;
+    reduced_msg.k[3 + col] = (info_msg.k[3 + col] - offset_y * info_msg.k[6 + col]) / factor;
+  }
+  for (int col = 0; col < 4; ++col) {
+    reduced_msg.p[col] = (info_msg.p[col] - offset_x * info_msg.p[8 + col]) / factor;
+    reduced_msg.p[4 + col] = (info_msg.p[4 + col] - offset_y * info_msg.p[8 + col]) / factor;
+  }
+  reduced_msg.roi.x_offset = info_msg.roi.x_offset / factor;
+  reduced_msg.roi.y_offset = info_msg.roi.y_offset / factor;
+  reduced_msg.roi.width = info_msg.roi.width / factor;
+  reduced_msg.roi.height = info_msg.roi.height / factor;
+}
+
+void downsampleImage(
+  const sensor_msgs::msg::Image & image_msg, const Downsampling & downsampling,
+  sensor_msgs::msg::Image & reduced_msg)
+{
+  const int factor = downsampling.factor;
+  const int offset = downsampling.sampleOffset();
+  const size_t pixel_size =
+    sensor_msgs::image_encodings::numChannels(image_msg.encoding) *
+    sensor_msgs::image_encodings::bitDepth(image_msg.encoding) / 8;
+
+  reduced_msg.header = image_msg.header;
+  reduced_msg.encoding = image_msg.encoding;
+  reduced_msg.is_bigendian = image_msg.is_bigendian;
+  reduced_msg.width = image_msg.width / factor;
+  reduced_msg.height = image_msg.height / factor;
+  reduced_msg.step = static_cast<uint32_t>(reduced_msg.width * pixel_size);
+  reduced_msg.data.resize(reduced_msg.height * reduced_msg.step);
+
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(reduced_msg.height)), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const uint8_t * row = &image_msg.data[(v * factor + offset) * image_msg.step];
+        uint8_t * out = &reduced_msg.data[v * reduced_msg.step];
+        for (uint32_t u = 0; u < reduced_msg.width; ++u) {
+          std::copy_n(row + (u * factor + offset) * pixel_size, pixel_size, out + u * pixel_size);
+        }
+      }
+    });
+}
+
+template<typename T>
+void voxelizeDepth(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  sensor_msgs::msg::PointCloud2 & cloud_msg)
+{
+  voxelize<T>(depth_msg, lut, voxel_size, nullptr, 0, 0, 0, 0, cloud_msg);
+}
+
+template<typename T>
+void voxelizeDepth(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  const sensor_msgs::msg::Image & rgb_msg,
+  int red_offset, int green_offset, int blue_offset, int color_step,
+  sensor_msgs::msg::PointCloud2 & cloud_msg)
+{
+  voxelize<T>(
+    depth_msg, lut, voxel_size, &rgb_msg, red_offset, green_offset, blue_offset, color_step,
+    cloud_msg);
+}
+
+// force template instantiation
+template void voxelizeDepth<uint16_t>(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+template void voxelizeDepth<float>(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+template void voxelizeDepth<uint16_t>(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  const sensor_msgs::msg::Image & rgb_msg,
+  int red_offset, int green_offset, int blue_offset, int color_step,
+  sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+template void voxelizeDepth<float>(
+  const sensor_msgs::msg::Image & depth_msg, const DepthRayLut & lut, double voxel_size,
+  const sensor_msgs::msg::Image & rgb_msg,
+  int red_offset, int green_offset, int blue_offset, int color_step,
+  sensor_msgs::msg::PointCloud2 & cloud_msg);
+
+}  // namespace depth_image_proc
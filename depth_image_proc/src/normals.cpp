@@ -0,0 +1,224 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "depth_image_proc/normals.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace depth_image_proc
+{
+
+namespace
+{
+
+// Offset in every point of the field called name
+uint32_t fieldOffset(const sensor_msgs::msg::PointCloud2 & cloud, const std::string & name)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name == name) {
+      return field.offset;
+    }
+  }
+  return 0;
+}
+
+// Normals of the pixels [begin, end) of a row, from the planes of averaged x,
+// y and z at the row (mid), radius rows above (up) and below (down), and the
+// depth of the points themselves
+void normalRow(
+  const float * const mid[3], const float * const up[3], const float * const down[3],
+  const float * depth, int radius, float max_depth_change, int begin, int end,
+  float * nx, float * ny, float * nz)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  int u = begin;
+#if CV_SIMD128
+  const cv::v_float32x4 v_nan = cv::v_setall_f32(nan);
+  const cv::v_float32x4 v_zero = cv::v_setzero_f32();
+  const cv::v_float32x4 v_max_change = cv::v_setall_f32(max_depth_change);
+  for (; u + 4 <= end; u += 4) {
+    const cv::v_float32x4 dxx = cv::v_load(mid[0] + u + radius) - cv::v_load(mid[0] + u - radius);
+    const cv::v_float32x4 dxy = cv::v_load(mid[1] + u + radius) - cv::v_load(mid[1] + u - radius);
+    const cv::v_float32x4 dxz = cv::v_load(mid[2] + u + radius) - cv::v_load(mid[2] + u - radius);
+    const cv::v_float32x4 dyx = cv::v_load(down[0] + u) - cv::v_load(up[0] + u);
+    const cv::v_float32x4 dyy = cv::v_load(down[1] + u) - cv::v_load(up[1] + u);
+    const cv::v_float32x4 dyz = cv::v_load(down[2] + u) - cv::v_load(up[2] + u);
+    cv::v_float32x4 x = dxy * dyz - dxz * dyy;
+    cv::v_float32x4 y = dxz * dyx - dxx * dyz;
+    cv::v_float32x4 z = dxx * dyy - dxy * dyx;
+
+    // NaN depths fail both comparisons
+    const cv::v_float32x4 limit = v_max_change * cv::v_load(depth + u);
+    const cv::v_float32x4 valid = (cv::v_abs(dxz) <= limit) & (cv::v_abs(dyz) <= limit);
+
+    // Unit length, flipped to face the camera at the origin
+    const cv::v_float32x4 facing =
+      x * cv::v_load(mid[0] + u) + y * cv::v_load(mid[1] + u) + z * cv::v_load(mid[2] + u);
+    cv::v_float32x4 scale = cv::v_invsqrt(x * x + y * y + z * z);
+    scale = cv::v_select(facing > v_zero, v_zero - scale, scale);
+    cv::v_store(nx + u, cv::v_select(valid, x * scale, v_nan));
+    cv::v_store(ny + u, cv::v_select(valid, y * scale, v_nan));
+    cv::v_store(nz + u, cv::v_select(valid, z * scale, v_nan));
+  }
+#endif
+  for (; u < end; ++u) {
+    const float dxx = mid[0][u + radius] - mid[0][u - radius];
+    const float dxy = mid[1][u + radius] - mid[1][u - radius];
+    const float dxz = mid[2][u + radius] - mid[2][u - radius];
+    const float dyx = down[0][u] - up[0][u];
+    const float dyy = down[1][u] - up[1][u];
+    const float dyz = down[2][u] - up[2][u];
+    float x = dxy * dyz - dxz * dyy;
+    float y = dxz * dyx - dxx * dyz;
+    float z = dxx * dyy - dxy * dyx;
+
+    const float limit = max_depth_change * depth[u];
+    if (!(std::abs(dxz) <= limit && std::abs(dyz) <= limit)) {
+      nx[u] = ny[u] = nz[u] = nan;
+      continue;
+    }
+    float scale = 1.0f / std::sqrt(x * x + y * y + z * z);
+    if (x * mid[0][u] + y * mid[1][u] + z * mid[2][u] > 0.0f) {
+      scale = -scale;
+    }
+    nx[u] = x * scale;
+    ny[u] = y * scale;
+    nz[u] = z * scale;
+  }
+}
+
+}  // namespace
+
+void computeNormals(
+  const NormalEstimation & estimation, sensor_msgs::msg::PointCloud2 & cloud_msg)
+{
+  const int width = static_cast<int>(cloud_msg.width);
+  const int height = static_cast<int>(cloud_msg.height);
+  const int radius = std::max(1, estimation.radius);
+  const uint32_t x_offset = fieldOffset(cloud_msg, "x");
+  const uint32_t normal_offset = fieldOffset(cloud_msg, "normal_x");
+  const int point_floats = cloud_msg.point_step / sizeof(float);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  // Planes of x, y and z with 0 for invalid points, the count of valid ones,
+  // and the depths as they are
+  cv::Mat planes[4];
+  for (cv::Mat & plane : planes) {
+    plane.create(height, width, CV_32F);
+  }
+  cv::Mat depth(height, width, CV_32F);
+  cv::parallel_for_(
+    cv::Range(0, height), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const float * point = reinterpret_cast<const float *>(
+          &cloud_msg.data[v * cloud_msg.row_step + x_offset]);
+        float * x = planes[0].ptr<float>(v);
+        float * y = planes[1].ptr<float>(v);
+        float * z = planes[2].ptr<float>(v);
+        float * count = planes[3].ptr<float>(v);
+        float * d = depth.ptr<float>(v);
+        for (int u = 0; u < width; ++u, point += point_floats) {
+          const bool valid = std::isfinite(point[2]);
+          x[u] = valid ? point[0] : 0.0f;
+          y[u] = valid ? point[1] : 0.0f;
+          z[u] = valid ? point[2] : 0.0f;
+          count[u] = valid ? 1.0f : 0.0f;
+          d[u] = valid ? point[2] : nan;
+        }
+      }
+    });
+
+  // Box sums, then averages, NaN for boxes without a valid point
+  cv::Mat means[4];
+  const cv::Size box(2 * radius + 1, 2 * radius + 1);
+  for (int i = 0; i < 4; ++i) {
+    cv::boxFilter(planes[i], means[i], CV_32F, box, cv::Point(-1, -1), false);
+  }
+  cv::parallel_for_(
+    cv::Range(0, height), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const float * count = means[3].ptr<float>(v);
+        for (int i = 0; i < 3; ++i) {
+          float * mean = means[i].ptr<float>(v);
+          for (int u = 0; u < width; ++u) {
+            mean[u] /= count[u];
+          }
+        }
+      }
+    });
+
+  // The differences sample boxes up to 2 * radius pixels away
+  const int border = 2 * radius;
+  cv::parallel_for_(
+    cv::Range(0, height), [&](const cv::Range & range) {
+      std::vector<float> normals(3 * width, nan);
+      float * nx = normals.data();
+      float * ny = nx + width;
+      float * nz = ny + width;
+      for (int v = range.start; v < range.end; ++v) {
+        if (v >= border && v < height - border && width > 2 * border) {
+          const float * mid[3], * up[3], * down[3];
+          for (int i = 0; i < 3; ++i) {
+            mid[i] = means[i].ptr<float>(v);
+            up[i] = means[i].ptr<float>(v - radius);
+            down[i] = means[i].ptr<float>(v + radius);
+          }
+          normalRow(
+            mid, up, down, depth.ptr<float>(v), radius, estimation.max_depth_change,
+            border, width - border, nx, ny, nz);
+        } else {
+          std::fill(normals.begin(), normals.end(), nan);
+        }
+
+        float * out = reinterpret_cast<float *>(
+          &cloud_msg.data[v * cloud_msg.row_step + normal_offset]);
+        for (int u = 0; u < width; ++u, out += point_floats) {
+          out[0] = nx[u];
+          out[1] = ny[u];
+          out[2] = nz[u];
+        }
+      }
+    });
+}
+
+}  // namespace depth_image_proc
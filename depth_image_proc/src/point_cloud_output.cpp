@@ -0,0 +1,319 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <depth_image_proc/point_cloud_output.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <opencv2/core/utility.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+
+namespace depth_image_proc
+{
+
+namespace
+{
+
+constexpr int16_t kInvalidCount = std::numeric_limits<int16_t>::min();
+
+// How one field of a point is carried over to the quantized layout
+struct FieldCopy
+{
+  uint32_t src_offset;
+  uint32_t dst_offset;
+  uint32_t size;
+  bool quantize;
+};
+
+inline int16_t quantize(float value, float counts_per_meter)
+{
+  const float counts = value * counts_per_meter;
+  // Also false for NaN
+  if (!(std::abs(counts) <= std::numeric_limits<int16_t>::max())) {
+    return kInvalidCount;
+  }
+  return static_cast<int16_t>(std::lround(counts));
+}
+
+// Whether the z field at offset of point is finite
+inline bool validPoint(const uint8_t * point, uint32_t offset)
+{
+  float z;
+  std::memcpy(&z, point + offset, sizeof(z));
+  return std::isfinite(z);
+}
+
+}  // namespace
+
+PointCloudOutput declarePointCloudOutputParameters(rclcpp::Node & node)
+{
+  PointCloudOutput output;
+
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.description =
+    "Layout of the point coordinates: float32 (default) or int16 fixed point "
+    "without padding, in units of quantization_scale meters.";
+  std::string format = node.declare_parameter<std::string>("output_format", "float32", descriptor);
+  output.quantization_scale = node.declare_parameter<double>("quantization_scale", 0.001);
+
+  if (format == "int16") {
+    output.format = PointFormat::INT16;
+  } else if (format != "float32") {
+    RCLCPP_WARN(
+      node.get_logger(), "Unknown output_format [%s], using float32 instead", format.c_str());
+  }
+  if (output.format == PointFormat::INT16 && !(output.quantization_scale > 0.0)) {
+    RCLCPP_WARN(
+      node.get_logger(), "Invalid quantization_scale %f, using 0.001 instead",
+      output.quantization_scale);
+    output.quantization_scale = 0.001;
+  }
+
+  output.dense = node.declare_parameter<bool>("dense", false);
+  output.dense_uv = node.declare_parameter<bool>("dense_uv", false);
+  return output;
+}
+
+sensor_msgs::msg::PointCloud2::SharedPtr finishPointCloud(
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const PointCloudOutput & output)
+{
+  sensor_msgs::msg::PointCloud2::SharedPtr result = cloud_msg;
+
+  // Borrowed at their largest possible size, so the pool keeps handing out
+  // the same buffers however many points are valid
+  auto & pool = image_proc::PointCloudBufferPool::instance();
+  if (output.dense) {
+    const size_t uv_size = output.dense_uv ? 2 * sizeof(uint16_t) : 0;
+    auto dense = pool.acquire(
+      (result->point_step + uv_size) * static_cast<size_t>(result->width) * result->height);
+    compactPointCloud(*result, output.dense_uv, *dense);
+    result = dense;
+  }
+
+  if (output.format == PointFormat::INT16) {
+    auto quantized = pool.acquire(result->data.size());
+    quantizePointCloud(*result, output.quantization_scale, *quantized);
+    result = quantized;
+  }
+
+  return result;
+}
+
+void compactPointCloud(
+  const sensor_msgs::msg::PointCloud2 & cloud, bool add_uv,
+  sensor_msgs::msg::PointCloud2 & dense)
+{
+  uint32_t z_offset = 0;
+  for (const auto & field : cloud.fields) {
+    if (field.name == "z") {
+      z_offset = field.offset;
+    }
+  }
+
+  dense.header = cloud.header;
+  dense.fields = cloud.fields;
+  dense.is_bigendian = cloud.is_bigendian;
+  dense.is_dense = true;
+  dense.point_step = cloud.point_step;
+  if (add_uv) {
+    sensor_msgs::msg::PointField field;
+    field.datatype = sensor_msgs::msg::PointField::UINT16;
+    field.count = 1;
+    field.name = "u";
+    field.offset = cloud.point_step;
+    dense.fields.push_back(field);
+    field.name = "v";
+    field.offset = cloud.point_step + sizeof(uint16_t);
+    dense.fields.push_back(field);
+    dense.point_step += 2 * sizeof(uint16_t);
+  }
+
+  // Bands of rows, a few per thread to balance uneven point densities
+  const int rows = static_cast<int>(cloud.height);
+  const int bands = std::max(1, std::min(rows, 4 * cv::getNumThreads()));
+  auto band_start = [rows, bands](int band) {
+      return static_cast<int>(static_cast<int64_t>(rows) * band / bands);
+    };
+
+  // First pass counts the valid points of every band
+  std::vector<size_t> offsets(bands + 1, 0);
+  cv::parallel_for_(
+    cv::Range(0, bands), [&](const cv::Range & range) {
+      for (int band = range.start; band < range.end; ++band) {
+        size_t count = 0;
+        for (int v = band_start(band); v < band_start(band + 1); ++v) {
+          const uint8_t * point = &cloud.data[v * cloud.row_step];
+          for (uint32_t u = 0; u < cloud.width; ++u, point += cloud.point_step) {
+            count += validPoint(point, z_offset);
+          }
+        }
+        offsets[band + 1] = count;
+      }
+    });
+  for (int band = 0; band < bands; ++band) {
+    offsets[band + 1] += offsets[band];
+  }
+
+  const size_t points = offsets[bands];
+  dense.height = 1;
+  dense.width = static_cast<uint32_t>(points);
+  dense.row_step = dense.point_step * dense.width;
+  dense.data.resize(points * dense.point_step);
+
+  // Second pass copies them, every band starting where the previous one ends
+  cv::parallel_for_(
+    cv::Range(0, bands), [&](const cv::Range & range) {
+      for (int band = range.start; band < range.end; ++band) {
+        uint8_t * out = dense.data.data() + offsets[band] * dense.point_step;
+        for (int v = band_start(band); v < band_start(band + 1); ++v) {
+          const uint8_t * point = &cloud.data[v * cloud.row_step];
+          for (uint32_t u = 0; u < cloud.width; ++u, point += cloud.point_step) {
+            if (!validPoint(point, z_offset)) {
+              continue;
+            }
+            std::memcpy(out, point, cloud.point_step);
+            if (add_uv) {
+              const uint16_t uv[2] = {static_cast<uint16_t>(u), static_cast<uint16_t>(v)};
+              std::memcpy(out + cloud.point_step, uv, sizeof(uv));
+            }
+            out += dense.point_step;
+          }
+        }
+      }
+    });
+}
+
+void quantizePointCloud(
+  const sensor_msgs::msg::PointCloud2 & cloud, double scale,
+  sensor_msgs::msg::PointCloud2 & quantized)
+{
+  std::vector<sensor_msgs::msg::PointField> fields = cloud.fields;
+  std::sort(
+    fields.begin(), fields.end(),
+    [](const sensor_msgs::msg::PointField & a, const sensor_msgs::msg::PointField & b) {
+      return a.offset < b.offset;
+    });
+
+  // Lay the fields out back to back, coordinates shrinking to INT16
+  std::vector<FieldCopy> copies;
+  quantized.fields.clear();
+  uint32_t offset = 0;
+  for (auto field : fields) {
+    const bool coordinate =
+      field.datatype == sensor_msgs::msg::PointField::FLOAT32 && field.count == 1 &&
+      (field.name == "x" || field.name == "y" || field.name == "z");
+    const uint32_t src_size =
+      sensor_msgs::impl::sizeOfPointField(field.datatype) * field.count;
+
+    FieldCopy copy{field.offset, offset, src_size, coordinate};
+    field.offset = offset;
+    if (coordinate) {
+      field.name = quantizedFieldName(field.name, scale);
+      field.datatype = sensor_msgs::msg::PointField::INT16;
+      copy.size = sizeof(int16_t);
+    }
+    offset += copy.size;
+    copies.push_back(copy);
+    quantized.fields.push_back(field);
+  }
+
+  quantized.header = cloud.header;
+  quantized.height = cloud.height;
+  quantized.width = cloud.width;
+  quantized.is_bigendian = cloud.is_bigendian;
+  quantized.is_dense = cloud.is_dense;
+  quantized.point_step = offset;
+  quantized.row_step = offset * cloud.width;
+  quantized.data.resize(static_cast<size_t>(quantized.row_step) * cloud.height);
+
+  const float counts_per_meter = static_cast<float>(1.0 / scale);
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(cloud.height)), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const uint8_t * src = &cloud.data[v * cloud.row_step];
+        uint8_t * dst = &quantized.data[v * quantized.row_step];
+        for (uint32_t u = 0; u < cloud.width; ++u) {
+          for (const auto & copy : copies) {
+            if (copy.quantize) {
+              float value;
+              std::memcpy(&value, src + copy.src_offset, sizeof(value));
+              const int16_t counts = quantize(value, counts_per_meter);
+              std::memcpy(dst + copy.dst_offset, &counts, sizeof(counts));
+            } else {
+              std::memcpy(dst + copy.dst_offset, src + copy.src_offset, copy.size);
+            }
+          }
+          src += cloud.point_step;
+          dst += quantized.point_step;
+        }
+      }
+    });
+}
+
+std::string quantizedFieldName(const std::string & axis, double scale)
+{
+  std::ostringstream name;
+  name.imbue(std::locale::classic());
+  name << axis << '*' << std::setprecision(9) << scale;
+  return name.str();
+}
+
+bool parseQuantizedField(const std::string & name, std::string & axis, double & scale)
+{
+  const size_t star = name.find('*');
+  if (star == std::string::npos || star == 0) {
+    return false;
+  }
+  std::istringstream value(name.substr(star + 1));
+  value.imbue(std::locale::classic());
+  double parsed = 0.0;
+  if (!(value >> parsed) || !value.eof() || !(parsed > 0.0)) {
+    return false;
+  }
+  axis = name.substr(0, star);
+  scale = parsed;
+  return true;
+}
+
+}  // namespace depth_image_proc
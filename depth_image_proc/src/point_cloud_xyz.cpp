@@ -34,17 +34,25 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "depth_image_proc/visibility.h"
 #include "image_geometry/pinhole_camera_model.hpp"
 
 #include <depth_image_proc/point_cloud_xyz.hpp>
+#include <depth_image_proc/rvl.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <image_transport/image_transport.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <depth_image_proc/conversions.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
 
 #include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
@@ -57,10 +65,39 @@ PointCloudXyzNode::PointCloudXyzNode(const rclcpp::NodeOptions & options)
 
   // Read parameters
   queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  change_ = std::make_unique<image_proc::ChangeDetection>(this);
 
   // values used for invalid points for pcd conversion
   invalid_depth_ = this->declare_parameter<double>("invalid_depth", 0.0);
 
+  // Publish the clouds in target_frame, moving the points as they are made.
+  // With static_target_transform the transform is looked up once and again
+  // only when /tf_static changes.
+  target_frame_ = this->declare_parameter<std::string>("target_frame", "");
+  const bool static_target_transform =
+    this->declare_parameter<bool>("static_target_transform", false);
+  if (!target_frame_.empty()) {
+    target_transform_ = std::make_unique<StaticTransformCache>(*this, static_target_transform);
+  }
+
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2FieldsByString(1, "xyz");
+  downsampling_ = declareDownsamplingParameters(*this);
+  ordered_ = image_proc::declareConcurrencyParameter(this, 1);
+
+  // Take RVL compressed depth on image_rect/rvl, decoding it in this node
+  rvl_ = this->declare_parameter<bool>("rvl", false);
+  if (rvl_) {
+    rvl_sync_ = std::make_shared<message_filters::Synchronizer<RvlSyncPolicy>>(
+      RvlSyncPolicy(latest_only_->queueSize(queue_size_)), sub_rvl_, sub_rvl_info_);
+    rvl_sync_->registerCallback(
+      std::bind(
+        &PointCloudXyzNode::rvlCb, this, std::placeholders::_1, std::placeholders::_2));
+  }
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -69,6 +106,16 @@ PointCloudXyzNode::PointCloudXyzNode(const rclcpp::NodeOptions & options)
       std::lock_guard<std::mutex> lock(connect_mutex_);
       if (s.current_count == 0) {
         sub_depth_.shutdown();
+        sub_rvl_.unsubscribe();
+        sub_rvl_info_.unsubscribe();
+      } else if (rvl_) {
+        if (!sub_rvl_.getSubscriber()) {
+          auto node_base = this->get_node_base_interface();
+          std::string topic = node_base->resolve_topic_or_service_name("image_rect", false);
+          sub_rvl_.subscribe(this, topic + "/rvl", latest_only_->qos(rclcpp::SensorDataQoS()));
+          sub_rvl_info_.subscribe(
+            this, image_transport::getCameraInfoTopic(topic), latest_only_->qos(rclcpp::QoS(10)));
+        }
       } else if (!sub_depth_) {
         // For compressed topics to remap appropriately, we need to pass a
         // fully expanded and remapped topic name to image_transport
@@ -78,7 +125,7 @@ PointCloudXyzNode::PointCloudXyzNode(const rclcpp::NodeOptions & options)
         // Get transport and QoS
         image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
         auto custom_qos = rmw_qos_profile_system_default;
-        custom_qos.depth = queue_size_;
+        custom_qos.depth = latest_only_->queueSize(queue_size_);
 
         sub_depth_ = image_transport::create_camera_subscription(
           this,
@@ -91,37 +138,214 @@ PointCloudXyzNode::PointCloudXyzNode(const rclcpp::NodeOptions & options)
       }
     };
   pub_point_cloud_ = create_publisher<PointCloud2>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void PointCloudXyzNode::keepCameraState(
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model,
+  std::shared_ptr<const DepthRayLut> ray_lut)
+{
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  model_ = std::move(model);
+  ray_lut_ = std::move(ray_lut);
 }
 
 void PointCloudXyzNode::depthCb(
   const Image::ConstSharedPtr & depth_msg,
   const CameraInfo::ConstSharedPtr & info_msg)
 {
-  const PointCloud2::SharedPtr cloud_msg = std::make_shared<PointCloud2>();
-  cloud_msg->header = depth_msg->header;
-  cloud_msg->height = depth_msg->height;
-  cloud_msg->width = depth_msg->width;
-  cloud_msg->is_dense = false;
-  cloud_msg->is_bigendian = false;
+  if (!latest_only_->admit(depth_msg->header.stamp, *processing_)) {
+    return;
+  }
 
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*cloud_msg);
-  pcd_modifier.setPointCloud2FieldsByString(1, "xyz");
+  // Convert only the requested window, as an image with a calibration of its own
+  Image::ConstSharedPtr depth = depth_msg;
+  CameraInfo::ConstSharedPtr info = info_msg;
+  if (roi_->crop(depth, info).empty()) {
+    processing_->skipped();
+    return;
+  }
 
-  // Update camera model
-  model_.fromCameraInfo(info_msg);
+  // Looked up in the order the frames came in, before dispatching
+  std::shared_ptr<const cv::Matx34f> transform;
+  if (!lookupTargetTransform(depth->header, transform)) {
+    processing_->skipped();
+    return;
+  }
 
-  // Convert Depth Image to Pointcloud
-  if (depth_msg->encoding == enc::TYPE_16UC1 || depth_msg->encoding == enc::MONO16) {
-    convertDepth<uint16_t>(depth_msg, cloud_msg, model_, invalid_depth_);
-  } else if (depth_msg->encoding == enc::TYPE_32FC1) {
-    convertDepth<float>(depth_msg, cloud_msg, model_, invalid_depth_);
-  } else {
+  // Also in the order the frames came in. The cloud depends on the
+  // calibration and the transform as well
+  bool unchanged = false;
+  if (change_->enabled()) {
+    const uint64_t inputs = image_proc::CameraCache::combineKeys(
+      image_proc::CameraCache::hashCameraInfo(*info), hashTransform(transform.get()));
+    unchanged = change_->unchanged(*depth, inputs);
+  }
+  if (unchanged && change_->mode() == image_proc::ChangeDetection::Mode::SKIP) {
+    processing_->skipped();
+    return;
+  }
+
+  auto process =
+    [this, depth, info, transform, unchanged](image_proc::OrderedOutput::Ticket & ticket) {
+      if (unchanged) {
+        republish(depth->header.stamp, ticket);
+      } else if (!convert(depth, info, transform, ticket)) {
+        // Nothing was kept for the change, so the next frame is processed again
+        change_->reset();
+      }
+    };
+
+  if (!ordered_) {
+    image_proc::OrderedOutput::Ticket ticket;
+    process(ticket);
+    return;
+  }
+
+  // Convert up to concurrency frames at once, publishing them in order
+  const bool dispatched = ordered_->dispatch(process);
+  if (!dispatched) {
+    processing_->dropped();
+    change_->reset();
+  }
+}
+
+void PointCloudXyzNode::rvlCb(
+  const CompressedImage::ConstSharedPtr & rvl_msg,
+  const CameraInfo::ConstSharedPtr & info_msg)
+{
+  // Decoded before anything else, on the thread of the subscription
+  auto depth_msg = std::make_shared<Image>();
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "decode", rvl_msg.get());
+    if (!decodeRvl(*rvl_msg, *depth_msg)) {
+      RCLCPP_ERROR(
+        get_logger(), "Compressed depth is not valid RVL [%s]", rvl_msg->format.c_str());
+      return;
+    }
+  }
+  depthCb(depth_msg, info_msg);
+}
+
+bool PointCloudXyzNode::lookupTargetTransform(
+  const std_msgs::msg::Header & header, std::shared_ptr<const cv::Matx34f> & transform)
+{
+  if (!target_transform_) {
+    transform.reset();
+    return true;
+  }
+  auto to_target = std::make_shared<cv::Matx34f>();
+  if (!target_transform_->lookup(header, target_frame_, *to_target)) {
+    return false;
+  }
+  transform = to_target;
+  return true;
+}
+
+bool PointCloudXyzNode::convert(
+  const Image::ConstSharedPtr & depth_msg,
+  const CameraInfo::ConstSharedPtr & info_msg,
+  const std::shared_ptr<const cv::Matx34f> & transform,
+  image_proc::OrderedOutput::Ticket & ticket)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyz", depth_msg.get(), depth_msg->width, depth_msg->height,
+    depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  const bool is_float = depth_msg->encoding == enc::TYPE_32FC1;
+  if (!is_float && depth_msg->encoding != enc::TYPE_16UC1 && depth_msg->encoding != enc::MONO16) {
     RCLCPP_ERROR(
       get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
-    return;
+    return false;
+  }
+
+  // Update camera model, shared with the other nodes of the process
+  const auto model = image_proc::CameraCache::instance().pinholeModel(*info_msg);
+  std::shared_ptr<const DepthRayLut> ray_lut;
+
+  // Voxels are filled straight from the depth image
+  if (downsampling_.mode == DownsampleMode::VOXEL) {
+    const PointCloud2::SharedPtr cloud_msg = std::make_shared<PointCloud2>();
+    ray_lut = DepthRayLut::get(*model, depth_msg->width, depth_msg->height);
+    keepCameraState(model, ray_lut);
+    if (is_float) {
+      voxelizeDepth<float>(*depth_msg, *ray_lut, downsampling_.voxel_size, *cloud_msg);
+    } else {
+      voxelizeDepth<uint16_t>(*depth_msg, *ray_lut, downsampling_.voxel_size, *cloud_msg);
+    }
+    // Only the centroids are moved, after voxelizing in the camera frame
+    if (transform) {
+      transformPoints(*cloud_msg, *transform);
+      cloud_msg->header.frame_id = target_frame_;
+    }
+    ticket.wait();
+    publish(finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+    return true;
+  }
+
+  // Reduce the depth image first, so only the small cloud is ever built
+  Image::ConstSharedPtr depth = depth_msg;
+  if (downsampling_.mode != DownsampleMode::NONE) {
+    auto reduced_msg = std::make_shared<Image>();
+    downsampleDepth(*depth_msg, downsampling_, *reduced_msg);
+    depth = reduced_msg;
+    ray_lut = DepthRayLut::get(
+      *model, depth->width, depth->height, downsampling_.factor, downsampling_.rayOffset());
+  } else {
+    ray_lut = DepthRayLut::get(*model, depth->width, depth->height);
   }
+  keepCameraState(model, ray_lut);
 
-  pub_point_cloud_->publish(*cloud_msg);
+  const PointCloud2::SharedPtr cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth->height, depth->width);
+  cloud_msg->header = depth->header;
+  if (transform) {
+    cloud_msg->header.frame_id = target_frame_;
+  }
+  cloud_msg->is_dense = false;
+
+  // Convert Depth Image to Pointcloud
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", depth_msg.get());
+    if (is_float) {
+      convertDepth<float>(depth, cloud_msg, *ray_lut, invalid_depth_, transform.get());
+    } else {
+      convertDepth<uint16_t>(depth, cloud_msg, *ray_lut, invalid_depth_, transform.get());
+    }
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    ticket.wait();
+    publish(finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+  }
+  return true;
+}
+
+void PointCloudXyzNode::publish(const PointCloud2::SharedPtr & cloud)
+{
+  if (change_->mode() == image_proc::ChangeDetection::Mode::REPUBLISH) {
+    last_cloud_.keep(cloud);
+  }
+  pub_point_cloud_->publish(*cloud);
+}
+
+void PointCloudXyzNode::republish(
+  const builtin_interfaces::msg::Time & stamp, image_proc::OrderedOutput::Ticket & ticket)
+{
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  // Only once the frames before are out, the last of them having kept its cloud
+  ticket.wait();
+  auto cloud = last_cloud_.restamped(stamp);
+  if (cloud) {
+    pub_point_cloud_->publish(std::move(cloud));
+    frame.published(stamp);
+  }
 }
 
 }  // namespace depth_image_proc
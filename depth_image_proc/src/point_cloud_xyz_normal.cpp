@@ -0,0 +1,216 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "depth_image_proc/visibility.h"
+#include "image_geometry/pinhole_camera_model.hpp"
+
+#include <depth_image_proc/point_cloud_xyz_normal.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <image_transport/image_transport.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <depth_image_proc/conversions.hpp>
+#include <depth_image_proc/normals.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
+
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+namespace enc = sensor_msgs::image_encodings;
+
+PointCloudXyzNormalNode::PointCloudXyzNormalNode(const rclcpp::NodeOptions & options)
+: Node("PointCloudXyzNormalNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("depth_image_transport", "raw");
+
+  // Read parameters
+  queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  estimation_.radius = this->declare_parameter<int>("normal_radius", estimation_.radius);
+  estimation_.max_depth_change = static_cast<float>(
+    this->declare_parameter<double>("max_depth_change", estimation_.max_depth_change));
+
+  // Layout of the published points, the normals right after the coordinates
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2Fields(
+    6,
+    "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "z", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "normal_x", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "normal_y", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "normal_z", 1, sensor_msgs::msg::PointField::FLOAT32);
+  ordered_ = image_proc::declareConcurrencyParameter(this, 1);
+
+  // Create publisher with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this](rclcpp::MatchedInfo & s)
+    {
+      std::lock_guard<std::mutex> lock(connect_mutex_);
+      if (s.current_count == 0) {
+        sub_depth_.shutdown();
+      } else if (!sub_depth_) {
+        // For compressed topics to remap appropriately, we need to pass a
+        // fully expanded and remapped topic name to image_transport
+        auto node_base = this->get_node_base_interface();
+        std::string topic = node_base->resolve_topic_or_service_name("image_rect", false);
+
+        // Get transport and QoS
+        image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
+        auto custom_qos = rmw_qos_profile_system_default;
+        custom_qos.depth = latest_only_->queueSize(queue_size_);
+
+        sub_depth_ = image_transport::create_camera_subscription(
+          this,
+          topic,
+          std::bind(
+            &PointCloudXyzNormalNode::depthCb, this, std::placeholders::_1,
+            std::placeholders::_2),
+          depth_hints.getTransport(),
+          custom_qos);
+      }
+    };
+  pub_point_cloud_ = create_publisher<PointCloud2>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void PointCloudXyzNormalNode::keepCameraState(
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model,
+  std::shared_ptr<const DepthRayLut> ray_lut)
+{
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  model_ = std::move(model);
+  ray_lut_ = std::move(ray_lut);
+}
+
+void PointCloudXyzNormalNode::depthCb(
+  const Image::ConstSharedPtr & depth_msg,
+  const CameraInfo::ConstSharedPtr & info_msg)
+{
+  if (!latest_only_->admit(depth_msg->header.stamp, *processing_)) {
+    return;
+  }
+
+  // Convert only the requested window, as an image with a calibration of its own
+  Image::ConstSharedPtr depth = depth_msg;
+  CameraInfo::ConstSharedPtr info = info_msg;
+  if (roi_->crop(depth, info).empty()) {
+    processing_->skipped();
+    return;
+  }
+
+  if (!ordered_) {
+    image_proc::OrderedOutput::Ticket ticket;
+    convert(depth, info, ticket);
+    return;
+  }
+
+  // Convert up to concurrency frames at once, publishing them in order
+  const bool dispatched = ordered_->dispatch(
+    [this, depth, info](image_proc::OrderedOutput::Ticket & ticket) {
+      convert(depth, info, ticket);
+    });
+  if (!dispatched) {
+    processing_->dropped();
+  }
+}
+
+void PointCloudXyzNormalNode::convert(
+  const Image::ConstSharedPtr & depth_msg,
+  const CameraInfo::ConstSharedPtr & info_msg,
+  image_proc::OrderedOutput::Ticket & ticket)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyz_normal", depth_msg.get(), depth_msg->width,
+    depth_msg->height, depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  const bool is_float = depth_msg->encoding == enc::TYPE_32FC1;
+  if (!is_float && depth_msg->encoding != enc::TYPE_16UC1 && depth_msg->encoding != enc::MONO16) {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
+    return;
+  }
+
+  // Update camera model, shared with the other nodes of the process
+  const auto model = image_proc::CameraCache::instance().pinholeModel(*info_msg);
+  const auto ray_lut = DepthRayLut::get(*model, depth_msg->width, depth_msg->height);
+  keepCameraState(model, ray_lut);
+
+  const PointCloud2::SharedPtr cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth_msg->height, depth_msg->width);
+  cloud_msg->header = depth_msg->header;
+  cloud_msg->is_dense = false;
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", depth_msg.get());
+    if (is_float) {
+      convertDepth<float>(depth_msg, cloud_msg, *ray_lut);
+    } else {
+      convertDepth<uint16_t>(depth_msg, cloud_msg, *ray_lut);
+    }
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "normals", depth_msg.get());
+    computeNormals(estimation_, *cloud_msg);
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    ticket.wait();
+    pub_point_cloud_->publish(*finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+  }
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::PointCloudXyzNormalNode)
@@ -43,6 +43,9 @@
 #include <sensor_msgs/image_encodings.hpp>
 #include <depth_image_proc/depth_traits.hpp>
 #include <depth_image_proc/conversions.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
@@ -55,6 +58,12 @@ PointCloudXyzRadialNode::PointCloudXyzRadialNode(const rclcpp::NodeOptions & opt
 
   // Read parameters
   queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2FieldsByString(1, "xyz");
 
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
@@ -72,7 +81,7 @@ PointCloudXyzRadialNode::PointCloudXyzRadialNode(const rclcpp::NodeOptions & opt
         // Get transport and QoS
         image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
         auto custom_qos = rmw_qos_profile_system_default;
-        custom_qos.depth = queue_size_;
+        custom_qos.depth = latest_only_->queueSize(queue_size_);
         // Create subscriber
         sub_depth_ = image_transport::create_camera_subscription(
           this,
@@ -86,44 +95,55 @@ PointCloudXyzRadialNode::PointCloudXyzRadialNode(const rclcpp::NodeOptions & opt
     };
   pub_point_cloud_ = create_publisher<sensor_msgs::msg::PointCloud2>(
     "points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void PointCloudXyzRadialNode::depthCb(
-  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
-  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
+  const sensor_msgs::msg::Image::ConstSharedPtr & full_depth_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & full_info_msg)
 {
-  auto cloud_msg = std::make_shared<PointCloud>();
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyz_radial", full_depth_msg.get(),
+    full_depth_msg->width, full_depth_msg->height, full_depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(full_depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Convert only the requested window, as an image with a calibration of its own
+  sensor_msgs::msg::Image::ConstSharedPtr depth_msg = full_depth_msg;
+  sensor_msgs::msg::CameraInfo::ConstSharedPtr info_msg = full_info_msg;
+  if (roi_->crop(depth_msg, info_msg).empty()) {
+    return;
+  }
+
+  auto cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth_msg->height, depth_msg->width);
   cloud_msg->header = depth_msg->header;
-  cloud_msg->height = depth_msg->height;
-  cloud_msg->width = depth_msg->width;
   cloud_msg->is_dense = false;
-  cloud_msg->is_bigendian = false;
-
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*cloud_msg);
-  pcd_modifier.setPointCloud2FieldsByString(1, "xyz");
 
-  if (info_msg->d != D_ || info_msg->k != K_ || width_ != info_msg->width ||
-    height_ != info_msg->height)
-  {
-    D_ = info_msg->d;
-    K_ = info_msg->k;
-    width_ = info_msg->width;
-    height_ = info_msg->height;
-    transform_ = initMatrix(cv::Mat_<double>(3, 3, &K_[0]), cv::Mat(D_), width_, height_, true);
+  if (!radial_table_ || !radial_table_->matches(*info_msg)) {
+    radial_table_ = RadialTable::get(*info_msg);
   }
 
   // Convert Depth Image to Pointcloud
   if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
-    convertDepthRadial<uint16_t>(depth_msg, cloud_msg, transform_);
+    convertDepthRadial<uint16_t>(depth_msg, cloud_msg, *radial_table_);
   } else if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
-    convertDepthRadial<float>(depth_msg, cloud_msg, transform_);
+    convertDepthRadial<float>(depth_msg, cloud_msg, *radial_table_);
   } else {
     RCLCPP_ERROR(
       get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
     return;
   }
 
-  pub_point_cloud_->publish(*cloud_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    pub_point_cloud_->publish(*finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+  }
 }
 
 }  // namespace depth_image_proc
@@ -46,11 +46,37 @@
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <depth_image_proc/conversions.hpp>
 #include <depth_image_proc/point_cloud_xyzi.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
 namespace depth_image_proc
 {
 
+namespace
+{
+
+// Picks the kernel of the intensity type, one of those accepted by imageCb
+template<typename T>
+void convertXyzi(
+  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg,
+  const sensor_msgs::msg::PointCloud2::SharedPtr & cloud_msg,
+  const DepthRayLut & lut, double invalid_depth)
+{
+  if (intensity_msg->encoding == enc::MONO8) {
+    convertDepthIntensity<T, uint8_t>(depth_msg, intensity_msg, cloud_msg, lut, invalid_depth);
+  } else if (intensity_msg->encoding == enc::TYPE_32FC1) {
+    convertDepthIntensity<T, float>(depth_msg, intensity_msg, cloud_msg, lut, invalid_depth);
+  } else {
+    convertDepthIntensity<T, uint16_t>(depth_msg, intensity_msg, cloud_msg, lut, invalid_depth);
+  }
+}
+
+}  // namespace
+
 PointCloudXyziNode::PointCloudXyziNode(const rclcpp::NodeOptions & options)
 : rclcpp::Node("PointCloudXyziNode", options)
 {
@@ -63,10 +89,12 @@ PointCloudXyziNode::PointCloudXyziNode(const rclcpp::NodeOptions & options)
 
   // Read parameters
   int queue_size = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
 
   // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
   sync_ = std::make_shared<Synchronizer>(
-    SyncPolicy(queue_size),
+    SyncPolicy(latest_only_->queueSize(queue_size)),
     sub_depth_,
     sub_intensity_,
     sub_info_);
@@ -78,6 +106,15 @@ PointCloudXyziNode::PointCloudXyziNode(const rclcpp::NodeOptions & options)
       std::placeholders::_2,
       std::placeholders::_3));
 
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2Fields(
+    4,
+    "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "z", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "intensity", 1, sensor_msgs::msg::PointField::FLOAT32);
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -103,22 +140,46 @@ PointCloudXyziNode::PointCloudXyziNode(const rclcpp::NodeOptions & options)
 
         // depth image can use different transport.(e.g. compressedDepth)
         image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
-        sub_depth_.subscribe(this, depth_topic, depth_hints.getTransport());
+        sub_depth_.subscribe(
+          this, depth_topic, depth_hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
 
         // intensity uses normal ros transport hints.
         image_transport::TransportHints hints(this, "raw");
-        sub_intensity_.subscribe(this, intensity_topic, hints.getTransport());
-        sub_info_.subscribe(this, intensity_info_topic, rclcpp::QoS(10));
+        sub_intensity_.subscribe(
+          this, intensity_topic, hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_info_.subscribe(this, intensity_info_topic, latest_only_->qos(rclcpp::QoS(10)));
       }
     };
   pub_point_cloud_ = create_publisher<PointCloud>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void PointCloudXyziNode::imageCb(
-  const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg,
-  const sensor_msgs::msg::Image::ConstSharedPtr & intensity_msg_in,
-  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
+  const sensor_msgs::msg::Image::ConstSharedPtr & full_depth_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & full_intensity_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & full_info_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyzi", full_depth_msg.get(),
+    full_depth_msg->width, full_depth_msg->height, full_depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(full_depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Convert only the requested window, as images with a calibration of their
+  // own. The intensity image is cropped to the same part of the view.
+  sensor_msgs::msg::Image::ConstSharedPtr depth_msg = full_depth_msg;
+  sensor_msgs::msg::Image::ConstSharedPtr intensity_msg_in = full_intensity_msg;
+  sensor_msgs::msg::CameraInfo::ConstSharedPtr info_msg = full_info_msg;
+  if (roi_->crop(depth_msg, intensity_msg_in, info_msg).empty()) {
+    return;
+  }
+
   // Check for bad inputs
   if (depth_msg->header.frame_id != intensity_msg_in->header.frame_id) {
     RCLCPP_WARN_THROTTLE(
@@ -129,12 +190,17 @@ void PointCloudXyziNode::imageCb(
       depth_msg->header.frame_id.c_str(), intensity_msg_in->header.frame_id.c_str());
   }
 
-  // Update camera model
-  model_.fromCameraInfo(info_msg);
+  // Update camera model, shared with the other nodes of the process. The
+  // calibration is scaled first if the images differ in resolution
+  const bool scaled =
+    depth_msg->width != intensity_msg_in->width || depth_msg->height != intensity_msg_in->height;
+  if (!scaled) {
+    model_ = image_proc::CameraCache::instance().pinholeModel(*info_msg);
+  }
 
   // Check if the input image has to be resized
   sensor_msgs::msg::Image::ConstSharedPtr intensity_msg = intensity_msg_in;
-  if (depth_msg->width != intensity_msg->width || depth_msg->height != intensity_msg->height) {
+  if (scaled) {
     sensor_msgs::msg::CameraInfo info_msg_tmp = *info_msg;
     info_msg_tmp.width = depth_msg->width;
     info_msg_tmp.height = depth_msg->height;
@@ -147,7 +213,7 @@ void PointCloudXyziNode::imageCb(
     info_msg_tmp.p[2] *= ratio;
     info_msg_tmp.p[5] *= ratio;
     info_msg_tmp.p[6] *= ratio;
-    model_.fromCameraInfo(info_msg_tmp);
+    model_ = image_proc::CameraCache::instance().pinholeModel(info_msg_tmp);
 
     cv_bridge::CvImageConstPtr cv_ptr;
     try {
@@ -162,7 +228,9 @@ void PointCloudXyziNode::imageCb(
     cv::resize(
       cv_ptr->image.rowRange(0, depth_msg->height / ratio), cv_rsz.image,
       cv::Size(depth_msg->width, depth_msg->height));
-    if ((intensity_msg->encoding == enc::MONO8) || (intensity_msg->encoding == enc::MONO16)) {
+    if ((intensity_msg->encoding == enc::MONO8) || (intensity_msg->encoding == enc::MONO16) ||
+      (intensity_msg->encoding == enc::TYPE_16UC1) || (intensity_msg->encoding == enc::TYPE_32FC1))
+    {
       intensity_msg = cv_rsz.toImageMsg();
     } else {
       intensity_msg = cv_bridge::toCvCopy(cv_rsz.toImageMsg(), enc::MONO8)->toImageMsg();
@@ -175,8 +243,17 @@ void PointCloudXyziNode::imageCb(
     intensity_msg = intensity_msg_in;
   }
 
-  // Supported color encodings: MONO8, MONO16
-  if (intensity_msg->encoding != enc::MONO8 || intensity_msg->encoding != enc::MONO16) {
+  // Depth must be float or uint16, intensity is converted to MONO8 unless it
+  // already is uint8, uint16 or float
+  const bool is_float = depth_msg->encoding == enc::TYPE_32FC1;
+  if (!is_float && depth_msg->encoding != enc::TYPE_16UC1) {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
+    return;
+  }
+  if (intensity_msg->encoding != enc::MONO8 && intensity_msg->encoding != enc::MONO16 &&
+    intensity_msg->encoding != enc::TYPE_16UC1 && intensity_msg->encoding != enc::TYPE_32FC1)
+  {
     try {
       intensity_msg = cv_bridge::toCvCopy(intensity_msg, enc::MONO8)->toImageMsg();
     } catch (const cv_bridge::Exception & e) {
@@ -187,50 +264,27 @@ void PointCloudXyziNode::imageCb(
     }
   }
 
-  auto cloud_msg = std::make_shared<PointCloud>();
+  auto cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth_msg->height, depth_msg->width);
   cloud_msg->header = depth_msg->header;  // Use depth image time stamp
-  cloud_msg->height = depth_msg->height;
-  cloud_msg->width = depth_msg->width;
   cloud_msg->is_dense = false;
-  cloud_msg->is_bigendian = false;
-
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*cloud_msg);
-  // pcd_modifier.setPointCloud2FieldsByString(2, "xyz", "i");
-  pcd_modifier.setPointCloud2Fields(
-    4,
-    "x", 1, sensor_msgs::msg::PointField::FLOAT32,
-    "y", 1, sensor_msgs::msg::PointField::FLOAT32,
-    "z", 1, sensor_msgs::msg::PointField::FLOAT32,
-    "intensity", 1, sensor_msgs::msg::PointField::FLOAT32);
 
-  // Convert Depth Image to Pointcloud
-  if (depth_msg->encoding == enc::TYPE_16UC1) {
-    convertDepth<uint16_t>(depth_msg, cloud_msg, model_, invalid_depth_);
-  } else if (depth_msg->encoding == enc::TYPE_32FC1) {
-    convertDepth<float>(depth_msg, cloud_msg, model_, invalid_depth_);
-  } else {
-    RCLCPP_ERROR(
-      get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
-    return;
+  // Convert Depth and Intensity Images to Pointcloud in one pass
+  ray_lut_ = DepthRayLut::get(*model_, depth_msg->width, depth_msg->height);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", depth_msg.get());
+    if (is_float) {
+      convertXyzi<float>(depth_msg, intensity_msg, cloud_msg, *ray_lut_, invalid_depth_);
+    } else {
+      convertXyzi<uint16_t>(depth_msg, intensity_msg, cloud_msg, *ray_lut_, invalid_depth_);
+    }
   }
 
-  // Convert Intensity Image to Pointcloud
-  if (intensity_msg->encoding == enc::MONO8) {
-    convertIntensity<uint8_t>(intensity_msg, cloud_msg);
-  } else if (intensity_msg->encoding == enc::MONO16) {
-    convertIntensity<uint16_t>(intensity_msg, cloud_msg);
-  } else if (intensity_msg->encoding == enc::TYPE_16UC1) {
-    convertIntensity<uint16_t>(intensity_msg, cloud_msg);
-  } else if (intensity_msg->encoding == enc::TYPE_32FC1) {
-    convertIntensity<float>(intensity_msg, cloud_msg);
-  } else {
-    RCLCPP_ERROR(
-      get_logger(), "Intensity image has unsupported encoding [%s]",
-      intensity_msg->encoding.c_str());
-    return;
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    pub_point_cloud_->publish(*finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
   }
-
-  pub_point_cloud_->publish(*cloud_msg);
 }
 
 
@@ -45,6 +45,9 @@
 #include <depth_image_proc/point_cloud_xyzi_radial.hpp>
 #include <depth_image_proc/depth_traits.hpp>
 #include <depth_image_proc/conversions.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
@@ -58,10 +61,12 @@ PointCloudXyziRadialNode::PointCloudXyziRadialNode(const rclcpp::NodeOptions & o
 
   // Read parameters
   queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
 
   // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
   sync_ = std::make_shared<Synchronizer>(
-    SyncPolicy(queue_size_),
+    SyncPolicy(latest_only_->queueSize(queue_size_)),
     sub_depth_,
     sub_intensity_,
     sub_info_);
@@ -73,6 +78,15 @@ PointCloudXyziRadialNode::PointCloudXyziRadialNode(const rclcpp::NodeOptions & o
       std::placeholders::_2,
       std::placeholders::_3));
 
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2Fields(
+    4,
+    "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "z", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "intensity", 1, sensor_msgs::msg::PointField::FLOAT32);
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -98,54 +112,61 @@ PointCloudXyziRadialNode::PointCloudXyziRadialNode(const rclcpp::NodeOptions & o
 
         // depth image can use different transport.(e.g. compressedDepth)
         image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
-        sub_depth_.subscribe(this, depth_topic, depth_hints.getTransport());
+        sub_depth_.subscribe(
+          this, depth_topic, depth_hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
 
         // intensity uses normal ros transport hints.
         image_transport::TransportHints hints(this);
-        sub_intensity_.subscribe(this, intensity_topic, hints.getTransport());
-        sub_info_.subscribe(this, intensity_info_topic, rclcpp::QoS(10));
+        sub_intensity_.subscribe(
+          this, intensity_topic, hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_info_.subscribe(this, intensity_info_topic, latest_only_->qos(rclcpp::QoS(10)));
       }
     };
   pub_point_cloud_ = create_publisher<sensor_msgs::msg::PointCloud2>(
     "points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void PointCloudXyziRadialNode::imageCb(
-  const Image::ConstSharedPtr & depth_msg,
-  const Image::ConstSharedPtr & intensity_msg,
-  const CameraInfo::ConstSharedPtr & info_msg)
+  const Image::ConstSharedPtr & full_depth_msg,
+  const Image::ConstSharedPtr & full_intensity_msg,
+  const CameraInfo::ConstSharedPtr & full_info_msg)
 {
-  auto cloud_msg = std::make_shared<PointCloud>();
-  cloud_msg->header = depth_msg->header;
-  cloud_msg->height = depth_msg->height;
-  cloud_msg->width = depth_msg->width;
-  cloud_msg->is_dense = false;
-  cloud_msg->is_bigendian = false;
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyzi_radial", full_depth_msg.get(),
+    full_depth_msg->width, full_depth_msg->height, full_depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
 
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*cloud_msg);
-  pcd_modifier.setPointCloud2Fields(
-    4,
-    "x", 1, sensor_msgs::msg::PointField::FLOAT32,
-    "y", 1, sensor_msgs::msg::PointField::FLOAT32,
-    "z", 1, sensor_msgs::msg::PointField::FLOAT32,
-    "intensity", 1, sensor_msgs::msg::PointField::FLOAT32);
+  if (!latest_only_->admit(full_depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Convert only the requested window, as images with a calibration of their
+  // own. The intensity image is cropped to the same part of the view.
+  Image::ConstSharedPtr depth_msg = full_depth_msg;
+  Image::ConstSharedPtr intensity_msg = full_intensity_msg;
+  CameraInfo::ConstSharedPtr info_msg = full_info_msg;
+  if (roi_->crop(depth_msg, intensity_msg, info_msg).empty()) {
+    return;
+  }
 
+  auto cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth_msg->height, depth_msg->width);
+  cloud_msg->header = depth_msg->header;
+  cloud_msg->is_dense = false;
 
-  if (info_msg->d != D_ || info_msg->k != K_ || width_ != info_msg->width ||
-    height_ != info_msg->height)
-  {
-    D_ = info_msg->d;
-    K_ = info_msg->k;
-    width_ = info_msg->width;
-    height_ = info_msg->height;
-    transform_ = initMatrix(cv::Mat_<double>(3, 3, &K_[0]), cv::Mat(D_), width_, height_, true);
+  if (!radial_table_ || !radial_table_->matches(*info_msg)) {
+    radial_table_ = RadialTable::get(*info_msg);
   }
 
   // Convert Depth Image to Pointcloud
   if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
-    convertDepthRadial<uint16_t>(depth_msg, cloud_msg, transform_);
+    convertDepthRadial<uint16_t>(depth_msg, cloud_msg, *radial_table_);
   } else if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
-    convertDepthRadial<float>(depth_msg, cloud_msg, transform_);
+    convertDepthRadial<float>(depth_msg, cloud_msg, *radial_table_);
   } else {
     RCLCPP_ERROR(
       get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
@@ -167,7 +188,11 @@ void PointCloudXyziRadialNode::imageCb(
     return;
   }
 
-  pub_point_cloud_->publish(*cloud_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    pub_point_cloud_->publish(*finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+  }
 }
 
 }  // namespace depth_image_proc
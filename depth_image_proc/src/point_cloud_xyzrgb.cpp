@@ -34,16 +34,22 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "cv_bridge/cv_bridge.hpp"
 
 #include <depth_image_proc/conversions.hpp>
 #include <depth_image_proc/point_cloud_xyzrgb.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
 #include <image_transport/camera_common.hpp>
 #include <image_transport/image_transport.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
@@ -58,14 +64,27 @@ PointCloudXyzrgbNode::PointCloudXyzrgbNode(const rclcpp::NodeOptions & options)
   // value used for invalid points for pcd conversion
   invalid_depth_ = this->declare_parameter<double>("invalid_depth", 0.0);
 
+  // Publish the clouds in target_frame, moving the points as they are made.
+  // With static_target_transform the transform is looked up once and again
+  // only when /tf_static changes.
+  target_frame_ = this->declare_parameter<std::string>("target_frame", "");
+  const bool static_target_transform =
+    this->declare_parameter<bool>("static_target_transform", false);
+  if (!target_frame_.empty()) {
+    target_transform_ = std::make_unique<StaticTransformCache>(*this, static_target_transform);
+  }
+
   // Read parameters
   int queue_size = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  change_ = std::make_unique<image_proc::ChangeDetection>(this);
   bool use_exact_sync = this->declare_parameter<bool>("exact_sync", false);
 
   // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
   if (use_exact_sync) {
     exact_sync_ = std::make_shared<ExactSynchronizer>(
-      ExactSyncPolicy(queue_size),
+      ExactSyncPolicy(latest_only_->queueSize(queue_size)),
       sub_depth_,
       sub_rgb_,
       sub_info_);
@@ -77,7 +96,8 @@ PointCloudXyzrgbNode::PointCloudXyzrgbNode(const rclcpp::NodeOptions & options)
         std::placeholders::_2,
         std::placeholders::_3));
   } else {
-    sync_ = std::make_shared<Synchronizer>(SyncPolicy(queue_size), sub_depth_, sub_rgb_, sub_info_);
+    sync_ = std::make_shared<Synchronizer>(
+      SyncPolicy(latest_only_->queueSize(queue_size)), sub_depth_, sub_rgb_, sub_info_);
     sync_->registerCallback(
       std::bind(
         &PointCloudXyzrgbNode::imageCb,
@@ -87,6 +107,12 @@ PointCloudXyzrgbNode::PointCloudXyzrgbNode(const rclcpp::NodeOptions & options)
         std::placeholders::_3));
   }
 
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2FieldsByString(2, "xyz", "rgb");
+  downsampling_ = declareDownsamplingParameters(*this);
+  ordered_ = image_proc::declareConcurrencyParameter(this, 1);
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -127,25 +153,121 @@ PointCloudXyzrgbNode::PointCloudXyzrgbNode(const rclcpp::NodeOptions & options)
         // depth image can use different transport.(e.g. compressedDepth)
         sub_depth_.subscribe(
           this, depth_topic,
-          depth_hints.getTransport(), rmw_qos_profile_default, sub_opts);
+          depth_hints.getTransport(), latest_only_->qos(rmw_qos_profile_default), sub_opts);
 
         // rgb uses normal ros transport hints.
         image_transport::TransportHints hints(this);
         sub_rgb_.subscribe(
           this, rgb_topic,
           hints.getTransport(),
-          rmw_qos_profile_default, sub_opts);
-        sub_info_.subscribe(this, rgb_info_topic, rclcpp::QoS(10));
+          latest_only_->qos(rmw_qos_profile_default), sub_opts);
+        sub_info_.subscribe(this, rgb_info_topic, latest_only_->qos(rclcpp::QoS(10)));
       }
     };
   pub_point_cloud_ = create_publisher<PointCloud2>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void PointCloudXyzrgbNode::keepCameraState(
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model,
+  std::shared_ptr<const DepthRayLut> ray_lut)
+{
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  model_ = std::move(model);
+  ray_lut_ = std::move(ray_lut);
 }
 
 void PointCloudXyzrgbNode::imageCb(
   const Image::ConstSharedPtr & depth_msg,
-  const Image::ConstSharedPtr & rgb_msg_in,
+  const Image::ConstSharedPtr & rgb_msg,
   const CameraInfo::ConstSharedPtr & info_msg)
 {
+  if (!latest_only_->admit(depth_msg->header.stamp, *processing_)) {
+    return;
+  }
+
+  // Convert only the requested window, as images with a calibration of their
+  // own. The RGB image is cropped to the same part of the view.
+  Image::ConstSharedPtr depth = depth_msg;
+  Image::ConstSharedPtr rgb = rgb_msg;
+  CameraInfo::ConstSharedPtr info = info_msg;
+  if (roi_->crop(depth, rgb, info).empty()) {
+    processing_->skipped();
+    return;
+  }
+
+  // Looked up in the order the frames came in, before dispatching
+  std::shared_ptr<const cv::Matx34f> transform;
+  if (!lookupTargetTransform(depth->header, transform)) {
+    processing_->skipped();
+    return;
+  }
+
+  // Also in the order the frames came in. The cloud depends on the
+  // calibration and the transform as well
+  bool unchanged = false;
+  if (change_->enabled()) {
+    const uint64_t inputs = image_proc::CameraCache::combineKeys(
+      image_proc::CameraCache::hashCameraInfo(*info), hashTransform(transform.get()));
+    unchanged = change_->unchanged({depth.get(), rgb.get()}, inputs);
+  }
+  if (unchanged && change_->mode() == image_proc::ChangeDetection::Mode::SKIP) {
+    processing_->skipped();
+    return;
+  }
+
+  auto process =
+    [this, depth, rgb, info, transform, unchanged](image_proc::OrderedOutput::Ticket & ticket) {
+      if (unchanged) {
+        republish(depth->header.stamp, ticket);
+      } else if (!convert(depth, rgb, info, transform, ticket)) {
+        // Nothing was kept for the change, so the next frame is processed again
+        change_->reset();
+      }
+    };
+
+  if (!ordered_) {
+    image_proc::OrderedOutput::Ticket ticket;
+    process(ticket);
+    return;
+  }
+
+  // Convert up to concurrency frames at once, publishing them in order
+  const bool dispatched = ordered_->dispatch(process);
+  if (!dispatched) {
+    processing_->dropped();
+    change_->reset();
+  }
+}
+
+bool PointCloudXyzrgbNode::lookupTargetTransform(
+  const std_msgs::msg::Header & header, std::shared_ptr<const cv::Matx34f> & transform)
+{
+  if (!target_transform_) {
+    transform.reset();
+    return true;
+  }
+  auto to_target = std::make_shared<cv::Matx34f>();
+  if (!target_transform_->lookup(header, target_frame_, *to_target)) {
+    return false;
+  }
+  transform = to_target;
+  return true;
+}
+
+bool PointCloudXyzrgbNode::convert(
+  const Image::ConstSharedPtr & depth_msg,
+  const Image::ConstSharedPtr & rgb_msg_in,
+  const CameraInfo::ConstSharedPtr & info_msg,
+  const std::shared_ptr<const cv::Matx34f> & transform,
+  image_proc::OrderedOutput::Ticket & ticket)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyzrgb", depth_msg.get(),
+    depth_msg->width, depth_msg->height, depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
   // Check for bad inputs
   if (depth_msg->header.frame_id != rgb_msg_in->header.frame_id) {
     RCLCPP_WARN_THROTTLE(
@@ -156,12 +278,19 @@ void PointCloudXyzrgbNode::imageCb(
       depth_msg->header.frame_id.c_str(), rgb_msg_in->header.frame_id.c_str());
   }
 
-  // Update camera model
-  model_.fromCameraInfo(info_msg);
+  // Update camera model, shared with the other nodes of the process. The
+  // calibration is scaled first if the images differ in resolution
+  const bool scaled =
+    depth_msg->width != rgb_msg_in->width || depth_msg->height != rgb_msg_in->height;
+  std::shared_ptr<const image_geometry::PinholeCameraModel> model;
+  if (!scaled) {
+    model = image_proc::CameraCache::instance().pinholeModel(*info_msg);
+  }
 
-  // Check if the input image has to be resized
+  // An RGB image of another resolution is sampled through the index tables of
+  // color_sampling_, with the camera model scaled to the depth image
   Image::ConstSharedPtr rgb_msg = rgb_msg_in;
-  if (depth_msg->width != rgb_msg->width || depth_msg->height != rgb_msg->height) {
+  if (scaled) {
     CameraInfo info_msg_tmp = *info_msg;
     info_msg_tmp.width = depth_msg->width;
     info_msg_tmp.height = depth_msg->height;
@@ -174,37 +303,7 @@ void PointCloudXyzrgbNode::imageCb(
     info_msg_tmp.p[2] *= ratio;
     info_msg_tmp.p[5] *= ratio;
     info_msg_tmp.p[6] *= ratio;
-    model_.fromCameraInfo(info_msg_tmp);
-
-    cv_bridge::CvImageConstPtr cv_ptr;
-    try {
-      cv_ptr = cv_bridge::toCvShare(rgb_msg, rgb_msg->encoding);
-    } catch (cv_bridge::Exception & e) {
-      RCLCPP_ERROR(get_logger(), "cv_bridge exception: %s", e.what());
-      return;
-    }
-    cv_bridge::CvImage cv_rsz;
-    cv_rsz.header = cv_ptr->header;
-    cv_rsz.encoding = cv_ptr->encoding;
-    cv::resize(
-      cv_ptr->image.rowRange(0, depth_msg->height / ratio), cv_rsz.image,
-      cv::Size(depth_msg->width, depth_msg->height));
-    if ((rgb_msg->encoding == sensor_msgs::image_encodings::RGB8) ||
-      (rgb_msg->encoding == sensor_msgs::image_encodings::BGR8) ||
-      (rgb_msg->encoding == sensor_msgs::image_encodings::MONO8))
-    {
-      rgb_msg = cv_rsz.toImageMsg();
-    } else {
-      rgb_msg =
-        cv_bridge::toCvCopy(cv_rsz.toImageMsg(), sensor_msgs::image_encodings::RGB8)->toImageMsg();
-    }
-
-    RCLCPP_ERROR(
-      get_logger(), "Depth resolution (%ux%u) does not match RGB resolution (%ux%u)",
-      depth_msg->width, depth_msg->height, rgb_msg->width, rgb_msg->height);
-    return;
-  } else {
-    rgb_msg = rgb_msg_in;
+    model = image_proc::CameraCache::instance().pinholeModel(info_msg_tmp);
   }
 
   // Supported color encodings: RGB8, BGR8, MONO8
@@ -240,7 +339,7 @@ void PointCloudXyzrgbNode::imageCb(
     } catch (cv_bridge::Exception & e) {
       RCLCPP_ERROR(
         get_logger(), "Unsupported encoding [%s]: %s", rgb_msg->encoding.c_str(), e.what());
-      return;
+      return false;
     }
     red_offset = 0;
     green_offset = 1;
@@ -248,45 +347,132 @@ void PointCloudXyzrgbNode::imageCb(
     color_step = 3;
   }
 
-  auto cloud_msg = std::make_shared<PointCloud2>();
-  cloud_msg->header = depth_msg->header;  // Use depth image time stamp
-  cloud_msg->height = depth_msg->height;
-  cloud_msg->width = depth_msg->width;
-  cloud_msg->is_dense = false;
-  cloud_msg->is_bigendian = false;
-
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*cloud_msg);
-  pcd_modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
-
-  // Convert Depth Image to Pointcloud
-  if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
-    convertDepth<uint16_t>(depth_msg, cloud_msg, model_, invalid_depth_);
-  } else if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
-    convertDepth<float>(depth_msg, cloud_msg, model_, invalid_depth_);
-  } else {
+  const bool is_float = depth_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1;
+  if (!is_float && depth_msg->encoding != sensor_msgs::image_encodings::TYPE_16UC1) {
     RCLCPP_ERROR(
       get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
-    return;
+    return false;
   }
 
-  // Convert RGB
-  if (rgb_msg->encoding == sensor_msgs::image_encodings::RGB8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::BGR8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::BGRA8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::RGBA8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::MONO8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
+  // Voxels are filled straight from the depth and RGB images
+  if (downsampling_.mode == DownsampleMode::VOXEL) {
+    if (depth_msg->width != rgb_msg->width || depth_msg->height != rgb_msg->height) {
+      RCLCPP_ERROR(
+        get_logger(), "Voxel downsampling needs the depth resolution (%ux%u) to match the RGB "
+        "resolution (%ux%u)", depth_msg->width, depth_msg->height, rgb_msg->width,
+        rgb_msg->height);
+      return false;
+    }
+    auto cloud_msg = std::make_shared<PointCloud2>();
+    const auto ray_lut = DepthRayLut::get(*model, depth_msg->width, depth_msg->height);
+    keepCameraState(model, ray_lut);
+    if (is_float) {
+      voxelizeDepth<float>(
+        *depth_msg, *ray_lut, downsampling_.voxel_size, *rgb_msg,
+        red_offset, green_offset, blue_offset, color_step, *cloud_msg);
+    } else {
+      voxelizeDepth<uint16_t>(
+        *depth_msg, *ray_lut, downsampling_.voxel_size, *rgb_msg,
+        red_offset, green_offset, blue_offset, color_step, *cloud_msg);
+    }
+    // Only the centroids are moved, after voxelizing in the camera frame
+    if (transform) {
+      transformPoints(*cloud_msg, *transform);
+      cloud_msg->header.frame_id = target_frame_;
+    }
+    ticket.wait();
+    publish(finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+    return true;
+  }
+
+  // Reduce both images first, so only the small cloud is ever built
+  Image::ConstSharedPtr depth = depth_msg;
+  std::shared_ptr<const DepthRayLut> ray_lut;
+  if (downsampling_.mode != DownsampleMode::NONE) {
+    auto reduced_depth_msg = std::make_shared<Image>();
+    downsampleDepth(*depth_msg, downsampling_, *reduced_depth_msg);
+    depth = reduced_depth_msg;
+    auto reduced_rgb_msg = std::make_shared<Image>();
+    downsampleImage(*rgb_msg, downsampling_, *reduced_rgb_msg);
+    rgb_msg = reduced_rgb_msg;
+    ray_lut = DepthRayLut::get(
+      *model, depth->width, depth->height, downsampling_.factor, downsampling_.rayOffset());
   } else {
+    ray_lut = DepthRayLut::get(*model, depth->width, depth->height);
+  }
+  keepCameraState(model, ray_lut);
+
+  // The tables are only rebuilt when a resolution changes. Frames converted
+  // at once sample through a copy of them
+  bool covered;
+  ColorSampling sampling_copy;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    covered = color_sampling_.update(depth->width, depth->height, *rgb_msg, color_step);
+    if (ordered_) {
+      sampling_copy = color_sampling_;
+    }
+  }
+  const ColorSampling & sampling = ordered_ ? sampling_copy : color_sampling_;
+  if (!covered) {
     RCLCPP_ERROR(
-      get_logger(), "RGB image has unsupported encoding [%s]", rgb_msg->encoding.c_str());
-    return;
+      get_logger(), "RGB resolution (%ux%u) does not cover depth resolution (%ux%u)",
+      rgb_msg->width, rgb_msg->height, depth->width, depth->height);
+    return false;
+  }
+
+  auto cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth->height, depth->width);
+  cloud_msg->header = depth->header;  // Use depth image time stamp
+  if (transform) {
+    cloud_msg->header.frame_id = target_frame_;
+  }
+  cloud_msg->is_dense = false;
+
+  // Convert Depth Image and RGB to Pointcloud
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", depth_msg.get());
+    if (is_float) {
+      convertDepthRgb<float>(
+        depth, rgb_msg, cloud_msg, *ray_lut, sampling,
+        red_offset, green_offset, blue_offset, invalid_depth_, transform.get());
+    } else {
+      convertDepthRgb<uint16_t>(
+        depth, rgb_msg, cloud_msg, *ray_lut, sampling,
+        red_offset, green_offset, blue_offset, invalid_depth_, transform.get());
+    }
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    ticket.wait();
+    publish(finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
   }
+  return true;
+}
 
-  pub_point_cloud_->publish(*cloud_msg);
+void PointCloudXyzrgbNode::publish(const PointCloud2::SharedPtr & cloud)
+{
+  if (change_->mode() == image_proc::ChangeDetection::Mode::REPUBLISH) {
+    last_cloud_.keep(cloud);
+  }
+  pub_point_cloud_->publish(*cloud);
+}
+
+void PointCloudXyzrgbNode::republish(
+  const builtin_interfaces::msg::Time & stamp, image_proc::OrderedOutput::Ticket & ticket)
+{
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  // Only once the frames before are out, the last of them having kept its cloud
+  ticket.wait();
+  auto cloud = last_cloud_.restamped(stamp);
+  if (cloud) {
+    pub_point_cloud_->publish(std::move(cloud));
+    frame.published(stamp);
+  }
 }
 
 }  // namespace depth_image_proc
@@ -42,11 +42,14 @@
 #include <image_transport/camera_common.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber_filter.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
@@ -60,12 +63,14 @@ PointCloudXyzrgbRadialNode::PointCloudXyzrgbRadialNode(const rclcpp::NodeOptions
 
   // Read parameters
   int queue_size = this->declare_parameter<int>("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
   bool use_exact_sync = this->declare_parameter<bool>("exact_sync", false);
 
   // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
   if (use_exact_sync) {
     exact_sync_ = std::make_unique<ExactSynchronizer>(
-      ExactSyncPolicy(queue_size),
+      ExactSyncPolicy(latest_only_->queueSize(queue_size)),
       sub_depth_,
       sub_rgb_,
       sub_info_);
@@ -77,8 +82,8 @@ PointCloudXyzrgbRadialNode::PointCloudXyzrgbRadialNode(const rclcpp::NodeOptions
         std::placeholders::_2,
         std::placeholders::_3));
   } else {
-    sync_ =
-      std::make_unique<Synchronizer>(SyncPolicy(queue_size), sub_depth_, sub_rgb_, sub_info_);
+    sync_ = std::make_unique<Synchronizer>(
+      SyncPolicy(latest_only_->queueSize(queue_size)), sub_depth_, sub_rgb_, sub_info_);
     sync_->registerCallback(
       std::bind(
         &PointCloudXyzrgbRadialNode::imageCb,
@@ -88,6 +93,10 @@ PointCloudXyzrgbRadialNode::PointCloudXyzrgbRadialNode(const rclcpp::NodeOptions
         std::placeholders::_3));
   }
 
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2FieldsByString(2, "xyz", "rgb");
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -113,22 +122,46 @@ PointCloudXyzrgbRadialNode::PointCloudXyzrgbRadialNode(const rclcpp::NodeOptions
 
         // depth image can use different transport.(e.g. compressedDepth)
         image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
-        sub_depth_.subscribe(this, depth_topic, depth_hints.getTransport());
+        sub_depth_.subscribe(
+          this, depth_topic, depth_hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
 
         // rgb uses normal ros transport hints.
         image_transport::TransportHints hints(this, "raw");
-        sub_rgb_.subscribe(this, rgb_topic, hints.getTransport());
-        sub_info_.subscribe(this, rgb_info_topic, rclcpp::QoS(10));
+        sub_rgb_.subscribe(
+          this, rgb_topic, hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_info_.subscribe(this, rgb_info_topic, latest_only_->qos(rclcpp::QoS(10)));
       }
     };
   pub_point_cloud_ = create_publisher<PointCloud2>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
 }
 
 void PointCloudXyzrgbRadialNode::imageCb(
-  const Image::ConstSharedPtr & depth_msg,
-  const Image::ConstSharedPtr & rgb_msg_in,
-  const CameraInfo::ConstSharedPtr & info_msg)
+  const Image::ConstSharedPtr & full_depth_msg,
+  const Image::ConstSharedPtr & full_rgb_msg,
+  const CameraInfo::ConstSharedPtr & full_info_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyzrgb_radial", full_depth_msg.get(),
+    full_depth_msg->width, full_depth_msg->height, full_depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(full_depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Convert only the requested window, as images with a calibration of their
+  // own. The RGB image is cropped to the same part of the view.
+  Image::ConstSharedPtr depth_msg = full_depth_msg;
+  Image::ConstSharedPtr rgb_msg_in = full_rgb_msg;
+  CameraInfo::ConstSharedPtr info_msg = full_info_msg;
+  if (roi_->crop(depth_msg, rgb_msg_in, info_msg).empty()) {
+    return;
+  }
+
   // Check for bad inputs
   if (depth_msg->header.frame_id != rgb_msg_in->header.frame_id) {
     RCLCPP_WARN(
@@ -137,65 +170,37 @@ void PointCloudXyzrgbRadialNode::imageCb(
     return;
   }
 
-  // Update camera model
-  model_.fromCameraInfo(info_msg);
+  // Update camera model, shared with the other nodes of the process. The
+  // calibration is scaled first if the images differ in resolution
+  const bool scaled =
+    depth_msg->width != rgb_msg_in->width || depth_msg->height != rgb_msg_in->height;
+  if (!scaled) {
+    model_ = image_proc::CameraCache::instance().pinholeModel(*info_msg);
+  }
 
-  // Check if the input image has to be resized
+  // An RGB image of another resolution is sampled through the index tables of
+  // color_sampling_, with the calibration scaled to the depth image
   Image::ConstSharedPtr rgb_msg = rgb_msg_in;
-  if (depth_msg->width != rgb_msg->width || depth_msg->height != rgb_msg->height) {
-    CameraInfo info_msg_tmp = *info_msg;
-    info_msg_tmp.width = depth_msg->width;
-    info_msg_tmp.height = depth_msg->height;
+  CameraInfo::ConstSharedPtr depth_info_msg = info_msg;
+  if (scaled) {
+    auto info_msg_tmp = std::make_shared<CameraInfo>(*info_msg);
+    info_msg_tmp->width = depth_msg->width;
+    info_msg_tmp->height = depth_msg->height;
     float ratio = static_cast<float>(depth_msg->width) / static_cast<float>(rgb_msg->width);
-    info_msg_tmp.k[0] *= ratio;
-    info_msg_tmp.k[2] *= ratio;
-    info_msg_tmp.k[4] *= ratio;
-    info_msg_tmp.k[5] *= ratio;
-    info_msg_tmp.p[0] *= ratio;
-    info_msg_tmp.p[2] *= ratio;
-    info_msg_tmp.p[5] *= ratio;
-    info_msg_tmp.p[6] *= ratio;
-    model_.fromCameraInfo(info_msg_tmp);
-
-    cv_bridge::CvImageConstPtr cv_ptr;
-    try {
-      cv_ptr = cv_bridge::toCvShare(rgb_msg, rgb_msg->encoding);
-    } catch (cv_bridge::Exception & e) {
-      RCLCPP_ERROR(get_logger(), "cv_bridge exception: %s", e.what());
-      return;
-    }
-    cv_bridge::CvImage cv_rsz;
-    cv_rsz.header = cv_ptr->header;
-    cv_rsz.encoding = cv_ptr->encoding;
-    cv::resize(
-      cv_ptr->image.rowRange(0, depth_msg->height / ratio), cv_rsz.image,
-      cv::Size(depth_msg->width, depth_msg->height));
-    if ((rgb_msg->encoding == sensor_msgs::image_encodings::RGB8) ||
-      (rgb_msg->encoding == sensor_msgs::image_encodings::BGR8) ||
-      (rgb_msg->encoding == sensor_msgs::image_encodings::MONO8))
-    {
-      rgb_msg = cv_rsz.toImageMsg();
-    } else {
-      rgb_msg =
-        cv_bridge::toCvCopy(cv_rsz.toImageMsg(), sensor_msgs::image_encodings::RGB8)->toImageMsg();
-    }
-
-    RCLCPP_ERROR(
-      get_logger(), "Depth resolution (%ux%u) does not match RGB resolution (%ux%u)",
-      depth_msg->width, depth_msg->height, rgb_msg->width, rgb_msg->height);
-    return;
-  } else {
-    rgb_msg = rgb_msg_in;
+    info_msg_tmp->k[0] *= ratio;
+    info_msg_tmp->k[2] *= ratio;
+    info_msg_tmp->k[4] *= ratio;
+    info_msg_tmp->k[5] *= ratio;
+    info_msg_tmp->p[0] *= ratio;
+    info_msg_tmp->p[2] *= ratio;
+    info_msg_tmp->p[5] *= ratio;
+    info_msg_tmp->p[6] *= ratio;
+    model_ = image_proc::CameraCache::instance().pinholeModel(*info_msg_tmp);
+    depth_info_msg = info_msg_tmp;
   }
 
-  if (info_msg->d != D_ || info_msg->k != K_ || width_ != info_msg->width ||
-    height_ != info_msg->height)
-  {
-    D_ = info_msg->d;
-    K_ = info_msg->k;
-    width_ = info_msg->width;
-    height_ = info_msg->height;
-    transform_ = initMatrix(cv::Mat_<double>(3, 3, &K_[0]), cv::Mat(D_), width_, height_, true);
+  if (!radial_table_ || !radial_table_->matches(*depth_info_msg)) {
+    radial_table_ = RadialTable::get(*depth_info_msg);
   }
 
   // Supported color encodings: RGB8, BGR8, MONO8
@@ -239,21 +244,23 @@ void PointCloudXyzrgbRadialNode::imageCb(
     color_step = 3;
   }
 
-  auto cloud_msg = std::make_shared<PointCloud2>();
+  if (!color_sampling_.update(depth_msg->width, depth_msg->height, *rgb_msg, color_step)) {
+    RCLCPP_ERROR(
+      get_logger(), "RGB resolution (%ux%u) does not cover depth resolution (%ux%u)",
+      rgb_msg->width, rgb_msg->height, depth_msg->width, depth_msg->height);
+    return;
+  }
+
+  auto cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, depth_msg->height, depth_msg->width);
   cloud_msg->header = depth_msg->header;  // Use depth image time stamp
-  cloud_msg->height = depth_msg->height;
-  cloud_msg->width = depth_msg->width;
   cloud_msg->is_dense = false;
-  cloud_msg->is_bigendian = false;
-
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*cloud_msg);
-  pcd_modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
 
   // Convert Depth Image to Pointcloud
   if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
-    convertDepthRadial<uint16_t>(depth_msg, cloud_msg, transform_);
+    convertDepthRadial<uint16_t>(depth_msg, cloud_msg, *radial_table_);
   } else if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
-    convertDepthRadial<float>(depth_msg, cloud_msg, transform_);
+    convertDepthRadial<float>(depth_msg, cloud_msg, *radial_table_);
   } else {
     RCLCPP_ERROR(
       get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
@@ -261,23 +268,13 @@ void PointCloudXyzrgbRadialNode::imageCb(
   }
 
   // Convert RGB
-  if (rgb_msg->encoding == sensor_msgs::image_encodings::RGB8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::BGR8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::BGRA8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::RGBA8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::MONO8) {
-    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
-  } else {
-    RCLCPP_ERROR(
-      get_logger(), "RGB image has unsupported encoding [%s]", rgb_msg->encoding.c_str());
-    return;
-  }
+  convertRgb(rgb_msg, cloud_msg, color_sampling_, red_offset, green_offset, blue_offset);
 
-  pub_point_cloud_->publish(*cloud_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    pub_point_cloud_->publish(*finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+  }
 }
 
 }  // namespace depth_image_proc
@@ -0,0 +1,317 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "cv_bridge/cv_bridge.hpp"
+#include "image_geometry/pinhole_camera_model.hpp"
+
+#include <depth_image_proc/point_cloud_xyzrgb_register.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <image_transport/camera_common.hpp>
+#include <opencv2/core/utility.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+PointCloudXyzrgbRegisterNode::PointCloudXyzrgbRegisterNode(const rclcpp::NodeOptions & options)
+: rclcpp::Node("PointCloudXyzrgbRegisterNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("image_transport", "raw");
+  this->declare_parameter<std::string>("depth_image_transport", "raw");
+
+  // Read parameters
+  int queue_size = this->declare_parameter<int>("queue_size", 5);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  bool use_exact_sync = this->declare_parameter<bool>("exact_sync", false);
+  rasterize_triangles_ = this->declare_parameter<bool>("rasterize_triangles", false);
+  max_depth_discontinuity_ = this->declare_parameter<double>("max_depth_discontinuity", 0.05);
+  // Resolve the depth to RGB transform only once when static
+  bool static_extrinsic = this->declare_parameter<bool>("static_extrinsic", false);
+  depth_to_rgb_ = std::make_unique<StaticTransformCache>(*this, static_extrinsic);
+
+  // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
+  if (use_exact_sync) {
+    exact_sync_ = std::make_shared<ExactSynchronizer>(
+      ExactSyncPolicy(latest_only_->queueSize(queue_size)),
+      sub_depth_,
+      sub_depth_info_,
+      sub_rgb_,
+      sub_rgb_info_);
+    exact_sync_->registerCallback(
+      std::bind(
+        &PointCloudXyzrgbRegisterNode::imageCb,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2,
+        std::placeholders::_3,
+        std::placeholders::_4));
+  } else {
+    sync_ = std::make_shared<Synchronizer>(
+      SyncPolicy(latest_only_->queueSize(queue_size)),
+      sub_depth_,
+      sub_depth_info_,
+      sub_rgb_,
+      sub_rgb_info_);
+    sync_->registerCallback(
+      std::bind(
+        &PointCloudXyzrgbRegisterNode::imageCb,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2,
+        std::placeholders::_3,
+        std::placeholders::_4));
+  }
+
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2FieldsByString(2, "xyz", "rgb");
+
+  // Create publisher with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this](rclcpp::MatchedInfo & s)
+    {
+      std::lock_guard<std::mutex> lock(connect_mutex_);
+      if (s.current_count == 0) {
+        sub_depth_.unsubscribe();
+        sub_depth_info_.unsubscribe();
+        sub_rgb_.unsubscribe();
+        sub_rgb_info_.unsubscribe();
+      } else if (!sub_depth_.getSubscriber()) {
+        // For compressed topics to remap appropriately, we need to pass a
+        // fully expanded and remapped topic name to image_transport
+        auto node_base = this->get_node_base_interface();
+        std::string depth_topic =
+          node_base->resolve_topic_or_service_name("depth/image_rect", false);
+        std::string rgb_topic =
+          node_base->resolve_topic_or_service_name("rgb/image_rect_color", false);
+        // Allow also remapping camera_info to something different than default
+        std::string rgb_info_topic =
+          node_base->resolve_topic_or_service_name(
+          image_transport::getCameraInfoTopic(rgb_topic), false);
+
+        // depth image can use different transport.(e.g. compressedDepth)
+        image_transport::TransportHints depth_hints(this, "raw", "depth_image_transport");
+        sub_depth_.subscribe(
+          this, depth_topic, depth_hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_depth_info_.subscribe(this, "depth/camera_info", latest_only_->qos(rclcpp::QoS(10)));
+
+        // rgb uses normal ros transport hints.
+        image_transport::TransportHints hints(this);
+        sub_rgb_.subscribe(
+          this, rgb_topic, hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_rgb_info_.subscribe(this, rgb_info_topic, latest_only_->qos(rclcpp::QoS(10)));
+      }
+    };
+  pub_point_cloud_ = create_publisher<PointCloud2>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void PointCloudXyzrgbRegisterNode::imageCb(
+  const Image::ConstSharedPtr & depth_msg,
+  const CameraInfo::ConstSharedPtr & depth_info_msg,
+  const Image::ConstSharedPtr & rgb_msg_in,
+  const CameraInfo::ConstSharedPtr & rgb_info_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/point_cloud_xyzrgb_register", depth_msg.get(),
+    depth_msg->width, depth_msg->height, depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Query tf2 for transform from (X,Y,Z) in depth camera frame to RGB camera frame
+  Eigen::Affine3d depth_to_rgb;
+  if (!depth_to_rgb_->lookup(*depth_info_msg, *rgb_info_msg, depth_to_rgb)) {
+    return;
+  }
+
+  if (registration_.update(*depth_info_msg, *rgb_info_msg, depth_to_rgb)) {
+    // The registered depths lie on the RGB pixel grid
+    auto rgb_model = image_proc::CameraCache::instance().pinholeModel(*rgb_info_msg);
+    rgb_ray_lut_ = DepthRayLut::get(*rgb_model, registration_.width(), registration_.height());
+    RCLCPP_DEBUG(get_logger(), "Rebuilt depth to RGB projection");
+  }
+  if (registration_.depthWidth() != static_cast<int>(depth_msg->width) ||
+    registration_.depthHeight() != static_cast<int>(depth_msg->height))
+  {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image size (%ux%u) does not match its camera info",
+      depth_msg->width, depth_msg->height);
+    return;
+  }
+  if (registration_.width() != static_cast<int>(rgb_msg_in->width) ||
+    registration_.height() != static_cast<int>(rgb_msg_in->height))
+  {
+    RCLCPP_ERROR(
+      get_logger(), "RGB image size (%ux%u) does not match its camera info",
+      rgb_msg_in->width, rgb_msg_in->height);
+    return;
+  }
+
+  // Supported color encodings: RGB8, BGR8, MONO8
+  Image::ConstSharedPtr rgb_msg = rgb_msg_in;
+  int red_offset, green_offset, blue_offset, color_step;
+  if (rgb_msg->encoding == sensor_msgs::image_encodings::RGB8) {
+    red_offset = 0;
+    green_offset = 1;
+    blue_offset = 2;
+    color_step = 3;
+  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::RGBA8) {
+    red_offset = 0;
+    green_offset = 1;
+    blue_offset = 2;
+    color_step = 4;
+  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::BGR8) {
+    red_offset = 2;
+    green_offset = 1;
+    blue_offset = 0;
+    color_step = 3;
+  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::BGRA8) {
+    red_offset = 2;
+    green_offset = 1;
+    blue_offset = 0;
+    color_step = 4;
+  } else if (rgb_msg->encoding == sensor_msgs::image_encodings::MONO8) {
+    red_offset = 0;
+    green_offset = 0;
+    blue_offset = 0;
+    color_step = 1;
+  } else {
+    try {
+      rgb_msg = cv_bridge::toCvCopy(rgb_msg, sensor_msgs::image_encodings::RGB8)->toImageMsg();
+    } catch (cv_bridge::Exception & e) {
+      RCLCPP_ERROR(
+        get_logger(), "Unsupported encoding [%s]: %s", rgb_msg->encoding.c_str(), e.what());
+      return;
+    }
+    red_offset = 0;
+    green_offset = 1;
+    blue_offset = 2;
+    color_step = 3;
+  }
+
+  // Register the depths straight into the z-buffer of the RGB image
+  RegisteredDepth registered;
+  if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_16UC1) {
+    if (rasterize_triangles_) {
+      registration_.registerTriangles<uint16_t>(
+        *depth_msg, max_depth_discontinuity_, registered);
+    } else {
+      registration_.registerPoints<uint16_t>(*depth_msg, registered);
+    }
+  } else if (depth_msg->encoding == sensor_msgs::image_encodings::TYPE_32FC1) {
+    if (rasterize_triangles_) {
+      registration_.registerTriangles<float>(*depth_msg, max_depth_discontinuity_, registered);
+    } else {
+      registration_.registerPoints<float>(*depth_msg, registered);
+    }
+  } else {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
+    return;
+  }
+
+  auto cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+    cloud_layout_, registration_.height(), registration_.width());
+  cloud_msg->header.stamp = depth_msg->header.stamp;  // Use depth image time stamp
+  cloud_msg->header.frame_id = rgb_info_msg->header.frame_id;
+  cloud_msg->is_dense = false;
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", depth_msg.get());
+    convertRegistered(registered, cloud_msg);
+    convertRgb(rgb_msg, cloud_msg, red_offset, green_offset, blue_offset, color_step);
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_msg.get());
+    pub_point_cloud_->publish(*finishPointCloud(cloud_msg, output_));
+    frame.published(depth_msg->header.stamp);
+  }
+}
+
+void PointCloudXyzrgbRegisterNode::convertRegistered(
+  const RegisteredDepth & registered, const PointCloud2::SharedPtr & cloud_msg)
+{
+  const int width = static_cast<int>(cloud_msg->width);
+  const float bad_point = std::numeric_limits<float>::quiet_NaN();
+  const float * ray_x = rgb_ray_lut_->x();
+  const float * ray_y = rgb_ray_lut_->y();
+
+  // x, y and z are the leading floats of every point
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(cloud_msg->height)), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        uint8_t * point = &cloud_msg->data[v * cloud_msg->row_step];
+        const size_t row_begin = static_cast<size_t>(v) * width;
+        for (int u = 0; u < width; ++u, point += cloud_msg->point_step) {
+          float * xyz = reinterpret_cast<float *>(point);
+          const float z = registered.depth(row_begin + u);
+          if (std::isnan(z)) {
+            xyz[0] = xyz[1] = xyz[2] = bad_point;
+            continue;
+          }
+          xyz[0] = ray_x[u] * z;
+          xyz[1] = ray_y[v] * z;
+          xyz[2] = z;
+        }
+      }
+    });
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::PointCloudXyzrgbRegisterNode)
@@ -0,0 +1,132 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <depth_image_proc/radial_table.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/mapped_tables.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace depth_image_proc
+{
+
+RadialTable::RadialTable(
+  const std::array<double, 9> & k, const std::vector<double> & d,
+  uint32_t width, uint32_t height)
+: k_(k), d_(d), width_(width), height_(height)
+{
+  build();
+}
+
+RadialTable::RadialTable(
+  const std::array<double, 9> & k, const std::vector<double> & d,
+  uint32_t width, uint32_t height, Empty)
+: k_(k), d_(d), width_(width), height_(height)
+{
+}
+
+void RadialTable::build()
+{
+  const int rows = static_cast<int>(height);
+  const int cols = static_cast<int>(width);
+
+  cv::Mat sensor_points(1, rows * cols, CV_32FC2);
+  cv::Vec2f * p = sensor_points.ptr<cv::Vec2f>();
+  for (int v = 0; v < rows; ++v) {
+    for (int u = 0; u < cols; ++u, ++p) {
+      (*p)[0] = static_cast<float>(u);
+      (*p)[1] = static_cast<float>(v);
+    }
+  }
+
+  cv::Mat undistorted;
+  cv::Mat camera_matrix(3, 3, CV_64FC1, const_cast<double *>(k_.data()));
+  cv::undistortPoints(sensor_points, undistorted, camera_matrix, cv::Mat(d_));
+
+  x_.create(rows, cols, CV_32FC1);
+  y_.create(rows, cols, CV_32FC1);
+  z_.create(rows, cols, CV_32FC1);
+
+  const cv::Vec2f * ray = undistorted.ptr<cv::Vec2f>();
+  for (int v = 0; v < rows; ++v) {
+    float * x = x_.ptr<float>(v);
+    float * y = y_.ptr<float>(v);
+    float * z = z_.ptr<float>(v);
+    for (int u = 0; u < cols; ++u, ++ray) {
+      // Normalize (x, y, 1) so that scaling by depth gives the radial distance
+      const float norm = 1.0f / std::sqrt((*ray)[0] * (*ray)[0] + (*ray)[1] * (*ray)[1] + 1.0f);
+      x[u] = (*ray)[0] * norm;
+      y[u] = (*ray)[1] * norm;
+      z[u] = norm;
+    }
+  }
+}
+
+bool RadialTable::matches(const sensor_msgs::msg::CameraInfo & info) const
+{
+  return info.width == width_ && info.height == height_ && info.k == k_ && info.d == d_;
+}
+
+std::shared_ptr<const RadialTable> RadialTable::get(const sensor_msgs::msg::CameraInfo & info)
+{
+  using image_proc::CameraCache;
+  return CameraCache::instance().get<RadialTable>(
+    CameraCache::hashCameraInfo(info), [&info]() {
+      std::shared_ptr<RadialTable> table(
+        new RadialTable(info.k, info.d, info.width, info.height, Empty()));
+      const uint64_t key = CameraCache::hashCameraInfo(info);
+      const cv::Size size(static_cast<int>(info.width), static_cast<int>(info.height));
+      auto mapped = image_proc::MappedTables::load("radial", key);
+      if (mapped && mapped->tables().size() == 3 &&
+        std::all_of(
+          mapped->tables().begin(), mapped->tables().end(), [&size](const cv::Mat & plane) {
+            return plane.type() == CV_32FC1 && plane.size() == size;
+          }))
+      {
+        table->x_ = mapped->tables()[0];
+        table->y_ = mapped->tables()[1];
+        table->z_ = mapped->tables()[2];
+        table->mapped_ = mapped;
+      } else {
+        table->build();
+        image_proc::MappedTables::store("radial", key, {table->x_, table->y_, table->z_});
+      }
+      return table;
+    });
+}
+
+}  // namespace depth_image_proc
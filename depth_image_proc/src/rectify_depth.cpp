@@ -0,0 +1,274 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "depth_image_proc/visibility.h"
+
+#include <depth_image_proc/conversions.hpp>
+#include <depth_image_proc/point_cloud_output.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/rectification_maps.hpp>
+#include <image_transport/image_transport.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+namespace enc = sensor_msgs::image_encodings;
+
+namespace
+{
+
+// Calibration of the rectified images of info, the binning and ROI that the
+// rectification maps apply folded into the projection
+sensor_msgs::msg::CameraInfo rectifiedCameraInfo(
+  const sensor_msgs::msg::CameraInfo & info, const cv::Size & size)
+{
+  sensor_msgs::msg::CameraInfo rectified = info;
+  const double binning_x = std::max<uint32_t>(info.binning_x, 1);
+  const double binning_y = std::max<uint32_t>(info.binning_y, 1);
+  const bool full = info.roi.width == 0 || info.roi.height == 0;
+  const double offset_x = full ? 0.0 : info.roi.x_offset / static_cast<uint32_t>(binning_x);
+  const double offset_y = full ? 0.0 : info.roi.y_offset / static_cast<uint32_t>(binning_y);
+  rectified.p[0] /= binning_x;
+  rectified.p[2] = rectified.p[2] / binning_x - offset_x;
+  rectified.p[3] /= binning_x;
+  rectified.p[5] /= binning_y;
+  rectified.p[6] = rectified.p[6] / binning_y - offset_y;
+  rectified.p[7] /= binning_y;
+  rectified.width = size.width;
+  rectified.height = size.height;
+  rectified.binning_x = 0;
+  rectified.binning_y = 0;
+  rectified.roi = sensor_msgs::msg::RegionOfInterest();
+  return rectified;
+}
+
+}  // namespace
+
+class RectifyDepthNode : public rclcpp::Node
+{
+public:
+  DEPTH_IMAGE_PROC_PUBLIC RectifyDepthNode(const rclcpp::NodeOptions & options);
+
+private:
+  using Image = sensor_msgs::msg::Image;
+  using CameraInfo = sensor_msgs::msg::CameraInfo;
+  using PointCloud2 = sensor_msgs::msg::PointCloud2;
+
+  // Subscriptions
+  image_transport::CameraSubscriber sub_raw_;
+  int queue_size_;
+
+  // Parameters
+  bool min_filter_;
+
+  // Publications
+  std::mutex connect_mutex_;
+  image_transport::Publisher pub_rect_;
+  rclcpp::Publisher<PointCloud2>::SharedPtr pub_points_;
+  PointCloudOutput output_;
+  PointCloud2 cloud_layout_;
+
+  // Latest maps and lookup table, held so that they stay in the caches
+  std::shared_ptr<const image_proc::RectificationMaps> maps_;
+  std::shared_ptr<const DepthRayLut> ray_lut_;
+
+  void connectCb();
+
+  void depthCb(
+    const Image::ConstSharedPtr & raw_msg,
+    const CameraInfo::ConstSharedPtr & info_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+};
+
+RectifyDepthNode::RectifyDepthNode(const rclcpp::NodeOptions & options)
+: Node("RectifyDepthNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("image_transport", "raw");
+
+  // Read parameters
+  queue_size_ = this->declare_parameter<int>("queue_size", 5);
+  min_filter_ = this->declare_parameter<bool>("min_filter", false);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
+  // Layout of the published points
+  output_ = declarePointCloudOutputParameters(*this);
+  sensor_msgs::PointCloud2Modifier(cloud_layout_).setPointCloud2FieldsByString(1, "xyz");
+
+  // Create publishers with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this](rclcpp::MatchedInfo &) {connectCb();};
+  // For compressed topics to remap appropriately, we need to pass a
+  // fully expanded and remapped topic name to image_transport
+  auto node_base = this->get_node_base_interface();
+  std::string topic = node_base->resolve_topic_or_service_name("image_rect", false);
+  pub_rect_ = image_transport::create_publisher(this, topic, rmw_qos_profile_default, pub_options);
+  pub_points_ = create_publisher<PointCloud2>("points", rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void RectifyDepthNode::connectCb()
+{
+  std::lock_guard<std::mutex> lock(connect_mutex_);
+  // Called for both publishers, possibly before the second one is created
+  if (pub_rect_.getNumSubscribers() == 0 &&
+    (!pub_points_ || pub_points_->get_subscription_count() == 0))
+  {
+    sub_raw_.shutdown();
+  } else if (!sub_raw_) {
+    // For compressed topics to remap appropriately, we need to pass a
+    // fully expanded and remapped topic name to image_transport
+    auto node_base = this->get_node_base_interface();
+    std::string topic = node_base->resolve_topic_or_service_name("image_raw", false);
+
+    // Get transport and QoS
+    image_transport::TransportHints hints(this);
+    auto custom_qos = rmw_qos_profile_system_default;
+    custom_qos.depth = latest_only_->queueSize(queue_size_);
+
+    sub_raw_ = image_transport::create_camera_subscription(
+      this, topic,
+      std::bind(
+        &RectifyDepthNode::depthCb, this, std::placeholders::_1, std::placeholders::_2),
+      hints.getTransport(), custom_qos);
+  }
+}
+
+void RectifyDepthNode::depthCb(
+  const Image::ConstSharedPtr & raw_msg,
+  const CameraInfo::ConstSharedPtr & info_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/rectify_depth", raw_msg.get(), raw_msg->width, raw_msg->height,
+    raw_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(raw_msg->header.stamp, frame)) {
+    return;
+  }
+
+  const bool is_float = raw_msg->encoding == enc::TYPE_32FC1;
+  if (!is_float && raw_msg->encoding != enc::TYPE_16UC1 && raw_msg->encoding != enc::MONO16) {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image has unsupported encoding [%s]", raw_msg->encoding.c_str());
+    return;
+  }
+
+  // Verify camera is actually calibrated
+  if (info_msg->k[0] == 0.0) {
+    RCLCPP_ERROR_THROTTLE(
+      get_logger(), *get_clock(), 30000,
+      "Rectified topic '%s' requested but camera publishing '%s' is uncalibrated",
+      pub_rect_.getTopic().c_str(), sub_raw_.getInfoTopic().c_str());
+    return;
+  }
+
+  // Maps shared with RectifyNode and the other nodes of the process
+  maps_ = image_proc::CameraCache::instance().rectificationMaps(*info_msg);
+  const cv::Size size = maps_->size();
+  if (static_cast<int>(raw_msg->width) != size.width ||
+    static_cast<int>(raw_msg->height) != size.height)
+  {
+    RCLCPP_ERROR_THROTTLE(
+      get_logger(), *get_clock(), 30000,
+      "Depth image is %ux%u but its calibration is for %dx%d images",
+      raw_msg->width, raw_msg->height, size.width, size.height);
+    return;
+  }
+
+  // The cloud is filled from the rectified rows as they are made
+  PointCloud2::SharedPtr cloud_msg;
+  if (pub_points_->get_subscription_count() > 0) {
+    const auto model = image_proc::CameraCache::instance().pinholeModel(
+      rectifiedCameraInfo(*info_msg, size));
+    ray_lut_ = DepthRayLut::get(*model, size.width, size.height);
+    cloud_msg = image_proc::PointCloudBufferPool::instance().acquire(
+      cloud_layout_, size.height, size.width);
+    cloud_msg->header = raw_msg->header;
+    cloud_msg->is_dense = false;
+  }
+
+  auto rect_msg = std::make_unique<Image>();
+  rect_msg->header = raw_msg->header;
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", raw_msg.get());
+    if (is_float) {
+      rectifyDepth<float>(
+        *raw_msg, maps_->map1(), maps_->map2(), min_filter_, *rect_msg,
+        ray_lut_.get(), cloud_msg.get());
+    } else {
+      rectifyDepth<uint16_t>(
+        *raw_msg, maps_->map1(), maps_->map2(), min_filter_, *rect_msg,
+        ray_lut_.get(), cloud_msg.get());
+    }
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", raw_msg.get());
+    if (cloud_msg) {
+      pub_points_->publish(*finishPointCloud(cloud_msg, output_));
+    }
+    if (pub_rect_.getNumSubscribers() > 0) {
+      pub_rect_.publish(std::move(rect_msg));
+    }
+    frame.published(raw_msg->header.stamp);
+  }
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::RectifyDepthNode)
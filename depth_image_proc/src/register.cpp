@@ -30,26 +30,29 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 
 #include "Eigen/Geometry"
+#include "depth_image_proc/depth_registration.hpp"
 #include "depth_image_proc/visibility.h"
 #include "image_geometry/pinhole_camera_model.hpp"
 #include "message_filters/subscriber.hpp"
 #include "message_filters/synchronizer.hpp"
 #include "message_filters/sync_policies/approximate_time.hpp"
-#include "tf2_ros/buffer.h"
-#include "tf2_ros/transform_listener.h"
 
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/stamp_synchronizer.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <sensor_msgs/image_encodings.hpp>
-#include <tf2_eigen/tf2_eigen.hpp>
 #include <depth_image_proc/depth_traits.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace depth_image_proc
 {
@@ -66,22 +69,29 @@ private:
   // Subscriptions
   image_transport::SubscriberFilter sub_depth_image_;
   message_filters::Subscriber<CameraInfo> sub_depth_info_, sub_rgb_info_;
-  std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
-  std::shared_ptr<tf2_ros::TransformListener> tf_;
+  std::unique_ptr<StaticTransformCache> depth_to_rgb_;
   using SyncPolicy = message_filters::sync_policies::ApproximateTime<
     Image, CameraInfo,
     CameraInfo>;
   using Synchronizer = message_filters::Synchronizer<SyncPolicy>;
   std::shared_ptr<Synchronizer> sync_;
+  using StampSync = image_proc::StampSynchronizer<Image, CameraInfo, CameraInfo>;
+  std::unique_ptr<StampSync> stamp_sync_;
 
   // Publications
   std::mutex connect_mutex_;
   image_transport::CameraPublisher pub_registered_;
 
-  image_geometry::PinholeCameraModel depth_model_, rgb_model_;
+  // Shared with the other nodes of the process
+  std::shared_ptr<const image_geometry::PinholeCameraModel> depth_model_, rgb_model_;
 
   // Parameters
   bool fill_upsampling_holes_;
+  bool rasterize_triangles_;
+  double max_depth_discontinuity_;
+
+  // Projection of the depth pixels into the RGB image
+  DepthRegistration registration_;
   bool use_rgb_timestamp_;  // use source time stamp from RGB camera
 
   void imageCb(
@@ -94,6 +104,17 @@ private:
     const Image::ConstSharedPtr & depth_msg,
     const Image::SharedPtr & registered_msg,
     const Eigen::Affine3d & depth_to_rgb);
+
+  template<typename T>
+  void registerQuads(
+    const Image::ConstSharedPtr & depth_msg,
+    const Image::SharedPtr & registered_msg,
+    const Eigen::Affine3d & depth_to_rgb);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+  // Publishes processing_ and the synchronization statistics, destroyed first
+  std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
 };
 
 RegisterNode::RegisterNode(const rclcpp::NodeOptions & options)
@@ -102,25 +123,37 @@ RegisterNode::RegisterNode(const rclcpp::NodeOptions & options)
   // TransportHints does not actually declare the parameter
   this->declare_parameter<std::string>("depth_image_transport", "raw");
 
-  rclcpp::Clock::SharedPtr clock = this->get_clock();
-  tf_buffer_ = std::make_shared<tf2_ros::Buffer>(clock);
-  tf_ = std::make_shared<tf2_ros::TransformListener>(*tf_buffer_);
-
   // Read parameters
   int queue_size = this->declare_parameter<int>("queue_size", 5);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
   fill_upsampling_holes_ = this->declare_parameter<bool>("fill_upsampling_holes", false);
+  rasterize_triangles_ = this->declare_parameter<bool>("rasterize_triangles", false);
+  max_depth_discontinuity_ = this->declare_parameter<double>("max_depth_discontinuity", 0.05);
+  // Resolve the depth to RGB transform only once when static
+  bool static_extrinsic = this->declare_parameter<bool>("static_extrinsic", false);
+  depth_to_rgb_ = std::make_unique<StaticTransformCache>(*this, static_extrinsic);
   use_rgb_timestamp_ = this->declare_parameter<bool>("use_rgb_timestamp", false);
+  bool hardware_sync = this->declare_parameter<bool>("hardware_sync", false);
 
   // Synchronize inputs. Topic subscriptions happen on demand in the connection callback.
-  sync_ = std::make_shared<Synchronizer>(
-    SyncPolicy(queue_size),
-    sub_depth_image_,
-    sub_depth_info_,
-    sub_rgb_info_);
-  sync_->registerCallback(
-    std::bind(
-      &RegisterNode::imageCb, this, std::placeholders::_1,
-      std::placeholders::_2, std::placeholders::_3));
+  if (hardware_sync) {
+    stamp_sync_ = std::make_unique<StampSync>(latest_only_->queueSize(queue_size));
+    stamp_sync_->connectInput(sub_depth_image_, sub_depth_info_, sub_rgb_info_);
+    stamp_sync_->registerCallback(
+      std::bind(
+        &RegisterNode::imageCb, this, std::placeholders::_1,
+        std::placeholders::_2, std::placeholders::_3));
+  } else {
+    sync_ = std::make_shared<Synchronizer>(
+      SyncPolicy(latest_only_->queueSize(queue_size)),
+      sub_depth_image_,
+      sub_depth_info_,
+      sub_rgb_info_);
+    sync_->registerCallback(
+      std::bind(
+        &RegisterNode::imageCb, this, std::placeholders::_1,
+        std::placeholders::_2, std::placeholders::_3));
+  }
 
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
@@ -138,9 +171,11 @@ RegisterNode::RegisterNode(const rclcpp::NodeOptions & options)
         auto node_base = this->get_node_base_interface();
         std::string topic = node_base->resolve_topic_or_service_name("depth/image_rect", false);
         image_transport::TransportHints hints(this, "raw", "depth_image_transport");
-        sub_depth_image_.subscribe(this, topic, hints.getTransport());
-        sub_depth_info_.subscribe(this, "depth/camera_info", rclcpp::QoS(10));
-        sub_rgb_info_.subscribe(this, "rgb/camera_info", rclcpp::QoS(10));
+        sub_depth_image_.subscribe(
+          this, topic, hints.getTransport(),
+          latest_only_->qos(rmw_qos_profile_default));
+        sub_depth_info_.subscribe(this, "depth/camera_info", latest_only_->qos(rclcpp::QoS(10)));
+        sub_rgb_info_.subscribe(this, "rgb/camera_info", latest_only_->qos(rclcpp::QoS(10)));
       }
     };
   // For compressed topics to remap appropriately, we need to pass a
@@ -153,6 +188,13 @@ RegisterNode::RegisterNode(const rclcpp::NodeOptions & options)
     image_transport::create_camera_publisher(
     this, topic,
     rmw_qos_profile_default, pub_options);
+
+  diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+  diagnostics_->setHardwareID("none");
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this, *diagnostics_);
+  if (stamp_sync_) {
+    stamp_sync_->publishDiagnostics(*diagnostics_);
+  }
 }
 
 void RegisterNode::imageCb(
@@ -160,36 +202,48 @@ void RegisterNode::imageCb(
   const CameraInfo::ConstSharedPtr & depth_info_msg,
   const CameraInfo::ConstSharedPtr & rgb_info_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/register", depth_image_msg.get(),
+    depth_image_msg->width, depth_image_msg->height, depth_image_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(depth_image_msg->header.stamp, frame)) {
+    return;
+  }
+
   // Update camera models - these take binning & ROI into account
-  depth_model_.fromCameraInfo(depth_info_msg);
-  rgb_model_.fromCameraInfo(rgb_info_msg);
+  depth_model_ = image_proc::CameraCache::instance().pinholeModel(*depth_info_msg);
+  rgb_model_ = image_proc::CameraCache::instance().pinholeModel(*rgb_info_msg);
 
   // Query tf2 for transform from (X,Y,Z) in depth camera frame to RGB camera frame
   Eigen::Affine3d depth_to_rgb;
-  try {
-    tf2::TimePoint tf2_time(std::chrono::nanoseconds(depth_info_msg->header.stamp.nanosec) +
-      std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::seconds(
-          depth_info_msg->header.stamp.sec)));
-    geometry_msgs::msg::TransformStamped transform = tf_buffer_->lookupTransform(
-      rgb_info_msg->header.frame_id, depth_info_msg->header.frame_id,
-      tf2_time);
-
-    depth_to_rgb = tf2::transformToEigen(transform);
-  } catch (tf2::TransformException & ex) {
-    RCLCPP_ERROR(get_logger(), "TF2 exception:\n%s", ex.what());
+  if (!depth_to_rgb_->lookup(*depth_info_msg, *rgb_info_msg, depth_to_rgb)) {
     return;
     /// @todo Can take on order of a minute to register a disconnect callback when we
     /// don't call publish() in this cb. What's going on roscpp?
   }
 
+  if (rasterize_triangles_ || !fill_upsampling_holes_) {
+    if (registration_.update(*depth_info_msg, *rgb_info_msg, depth_to_rgb)) {
+      RCLCPP_DEBUG(get_logger(), "Rebuilt depth to RGB projection");
+    }
+    if (registration_.depthWidth() != static_cast<int>(depth_image_msg->width) ||
+      registration_.depthHeight() != static_cast<int>(depth_image_msg->height))
+    {
+      RCLCPP_ERROR(
+        get_logger(), "Depth image size (%ux%u) does not match its camera info",
+        depth_image_msg->width, depth_image_msg->height);
+      return;
+    }
+  }
+
   auto registered_msg = std::make_shared<Image>();
   registered_msg->header.stamp =
     use_rgb_timestamp_ ? rgb_info_msg->header.stamp : depth_image_msg->header.stamp;
   registered_msg->header.frame_id = rgb_info_msg->header.frame_id;
   registered_msg->encoding = depth_image_msg->encoding;
 
-  cv::Size resolution = rgb_model_.reducedResolution();
+  cv::Size resolution = rgb_model_->reducedResolution();
   registered_msg->height = resolution.height;
   registered_msg->width = resolution.width;
   // step and data set in convert(), depend on depth data type
@@ -209,7 +263,11 @@ void RegisterNode::imageCb(
   auto registered_info_msg = std::make_shared<CameraInfo>(*rgb_info_msg);
   registered_info_msg->header.stamp = registered_msg->header.stamp;
 
-  pub_registered_.publish(registered_msg, registered_info_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", depth_image_msg.get());
+    pub_registered_.publish(registered_msg, registered_info_msg);
+    frame.published(depth_image_msg->header.stamp);
+  }
 }
 
 template<typename T>
@@ -225,18 +283,34 @@ void RegisterNode::convert(
   //   but for floats we want to initialize everything to NaN.
   DepthTraits<T>::initializeBuffer(registered_msg->data);
 
+  RegisteredDepth registered;
+  if (rasterize_triangles_) {
+    registration_.registerTriangles<T>(*depth_msg, max_depth_discontinuity_, registered);
+    registered.write<T>(*registered_msg);
+  } else if (fill_upsampling_holes_) {
+    registerQuads<T>(depth_msg, registered_msg, depth_to_rgb);
+  } else {
+    registration_.registerPoints<T>(*depth_msg, registered);
+    registered.write<T>(*registered_msg);
+  }
+}
+
+template<typename T>
+void RegisterNode::registerQuads(
+  const Image::ConstSharedPtr & depth_msg,
+  const Image::SharedPtr & registered_msg,
+  const Eigen::Affine3d & depth_to_rgb)
+{
   // Extract all the parameters we need
-  double inv_depth_fx = 1.0 / depth_model_.fx();
-  double inv_depth_fy = 1.0 / depth_model_.fy();
-  double depth_cx = depth_model_.cx(), depth_cy = depth_model_.cy();
-  double depth_Tx = depth_model_.Tx(), depth_Ty = depth_model_.Ty();
-  double rgb_fx = rgb_model_.fx(), rgb_fy = rgb_model_.fy();
-  double rgb_cx = rgb_model_.cx(), rgb_cy = rgb_model_.cy();
-  double rgb_Tx = rgb_model_.Tx(), rgb_Ty = rgb_model_.Ty();
+  double inv_depth_fx = 1.0 / depth_model_->fx();
+  double inv_depth_fy = 1.0 / depth_model_->fy();
+  double depth_cx = depth_model_->cx(), depth_cy = depth_model_->cy();
+  double depth_Tx = depth_model_->Tx(), depth_Ty = depth_model_->Ty();
+  double rgb_fx = rgb_model_->fx(), rgb_fy = rgb_model_->fy();
+  double rgb_cx = rgb_model_->cx(), rgb_cy = rgb_model_->cy();
+  double rgb_Tx = rgb_model_->Tx(), rgb_Ty = rgb_model_->Ty();
 
   // Transform the depth values into the RGB frame
-  /// @todo When RGB is higher res, interpolate by rasterizing depth triangles onto the
-  //   registered image
   const T * depth_row = reinterpret_cast<const T *>(&depth_msg->data[0]);
   int row_step = depth_msg->step / sizeof(T);
   T * registered_data = reinterpret_cast<T *>(&registered_msg->data[0]);
@@ -250,73 +324,42 @@ void RegisterNode::convert(
 
       double depth = DepthTraits<T>::toMeters(raw_depth);
 
-      if (fill_upsampling_holes_ == false) {
-        /// @todo Combine all operations into one matrix multiply on (u,v,d)
-        // Reproject (u,v,Z) to (X,Y,Z,1) in depth camera frame
-        Eigen::Vector4d xyz_depth;
-        xyz_depth << ((u - depth_cx) * depth - depth_Tx) * inv_depth_fx,
-          ((v - depth_cy) * depth - depth_Ty) * inv_depth_fy,
-          depth,
-          1;
-
-        // Transform to RGB camera frame
-        Eigen::Vector4d xyz_rgb = depth_to_rgb * xyz_depth;
-
-        // Project to (u,v) in RGB image
-        double inv_Z = 1.0 / xyz_rgb.z();
-        int u_rgb = (rgb_fx * xyz_rgb.x() + rgb_Tx) * inv_Z + rgb_cx + 0.5;
-        int v_rgb = (rgb_fy * xyz_rgb.y() + rgb_Ty) * inv_Z + rgb_cy + 0.5;
-
-        if (u_rgb < 0 || u_rgb >= static_cast<int>(registered_msg->width) ||
-          v_rgb < 0 || v_rgb >= static_cast<int>(registered_msg->height))
-        {
-          continue;
-        }
-
-        T & reg_depth = registered_data[v_rgb * registered_msg->width + u_rgb];
-        T new_depth = DepthTraits<T>::fromMeters(xyz_rgb.z());
-        // Validity and Z-buffer checks
-        if (!DepthTraits<T>::valid(reg_depth) || reg_depth > new_depth) {
-          reg_depth = new_depth;
-        }
-      } else {
-        // Reproject (u,v,Z) to (X,Y,Z,1) in depth camera frame
-        Eigen::Vector4d xyz_depth_1, xyz_depth_2;
-        xyz_depth_1 << ((u - 0.5f - depth_cx) * depth - depth_Tx) * inv_depth_fx,
-          ((v - 0.5f - depth_cy) * depth - depth_Ty) * inv_depth_fy,
-          depth,
-          1;
-        xyz_depth_2 << ((u + 0.5f - depth_cx) * depth - depth_Tx) * inv_depth_fx,
-          ((v + 0.5f - depth_cy) * depth - depth_Ty) * inv_depth_fy,
-          depth,
-          1;
-
-        // Transform to RGB camera frame
-        Eigen::Vector4d xyz_rgb_1 = depth_to_rgb * xyz_depth_1;
-        Eigen::Vector4d xyz_rgb_2 = depth_to_rgb * xyz_depth_2;
-
-        // Project to (u,v) in RGB image
-        double inv_Z = 1.0 / xyz_rgb_1.z();
-        int u_rgb_1 = (rgb_fx * xyz_rgb_1.x() + rgb_Tx) * inv_Z + rgb_cx + 0.5;
-        int v_rgb_1 = (rgb_fy * xyz_rgb_1.y() + rgb_Ty) * inv_Z + rgb_cy + 0.5;
-        inv_Z = 1.0 / xyz_rgb_2.z();
-        int u_rgb_2 = (rgb_fx * xyz_rgb_2.x() + rgb_Tx) * inv_Z + rgb_cx + 0.5;
-        int v_rgb_2 = (rgb_fy * xyz_rgb_2.y() + rgb_Ty) * inv_Z + rgb_cy + 0.5;
-
-        if (u_rgb_1 < 0 || u_rgb_2 >= static_cast<int>(registered_msg->width) ||
-          v_rgb_1 < 0 || v_rgb_2 >= static_cast<int>(registered_msg->height))
-        {
-          continue;
-        }
+      // Reproject (u,v,Z) to (X,Y,Z,1) in depth camera frame
+      Eigen::Vector4d xyz_depth_1, xyz_depth_2;
+      xyz_depth_1 << ((u - 0.5f - depth_cx) * depth - depth_Tx) * inv_depth_fx,
+        ((v - 0.5f - depth_cy) * depth - depth_Ty) * inv_depth_fy,
+        depth,
+        1;
+      xyz_depth_2 << ((u + 0.5f - depth_cx) * depth - depth_Tx) * inv_depth_fx,
+        ((v + 0.5f - depth_cy) * depth - depth_Ty) * inv_depth_fy,
+        depth,
+        1;
+
+      // Transform to RGB camera frame
+      Eigen::Vector4d xyz_rgb_1 = depth_to_rgb * xyz_depth_1;
+      Eigen::Vector4d xyz_rgb_2 = depth_to_rgb * xyz_depth_2;
+
+      // Project to (u,v) in RGB image
+      double inv_Z = 1.0 / xyz_rgb_1.z();
+      int u_rgb_1 = (rgb_fx * xyz_rgb_1.x() + rgb_Tx) * inv_Z + rgb_cx + 0.5;
+      int v_rgb_1 = (rgb_fy * xyz_rgb_1.y() + rgb_Ty) * inv_Z + rgb_cy + 0.5;
+      inv_Z = 1.0 / xyz_rgb_2.z();
+      int u_rgb_2 = (rgb_fx * xyz_rgb_2.x() + rgb_Tx) * inv_Z + rgb_cx + 0.5;
+      int v_rgb_2 = (rgb_fy * xyz_rgb_2.y() + rgb_Ty) * inv_Z + rgb_cy + 0.5;
+
+      if (u_rgb_1 < 0 || u_rgb_2 >= static_cast<int>(registered_msg->width) ||
+        v_rgb_1 < 0 || v_rgb_2 >= static_cast<int>(registered_msg->height))
+      {
+        continue;
+      }
 
-        for (int nv = v_rgb_1; nv <= v_rgb_2; ++nv) {
-          for (int nu = u_rgb_1; nu <= u_rgb_2; ++nu) {
-            T & reg_depth = registered_data[nv * registered_msg->width + nu];
-            T new_depth = DepthTraits<T>::fromMeters(0.5 * (xyz_rgb_1.z() + xyz_rgb_2.z()));
-            // Validity and Z-buffer checks
-            if (!DepthTraits<T>::valid(reg_depth) || reg_depth > new_depth) {
-              reg_depth = new_depth;
-            }
+      for (int nv = v_rgb_1; nv <= v_rgb_2; ++nv) {
+        for (int nu = u_rgb_1; nu <= u_rgb_2; ++nu) {
+          T & reg_depth = registered_data[nv * registered_msg->width + nu];
+          T new_depth = DepthTraits<T>::fromMeters(0.5 * (xyz_rgb_1.z() + xyz_rgb_2.z()));
+          // Validity and Z-buffer checks
+          if (!DepthTraits<T>::valid(reg_depth) || reg_depth > new_depth) {
+            reg_depth = new_depth;
           }
         }
       }
@@ -0,0 +1,337 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "depth_image_proc/rvl.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace depth_image_proc
+{
+
+const char RVL_FORMAT[] = "16UC1; rvl";
+
+namespace
+{
+
+// Magic, width, height and band count, before the band sizes
+const uint32_t RVL_MAGIC = 0x314c5652;  // "RVL1" in little endian
+const size_t HEADER_WORDS = 4;
+
+// Largest width and height decoded. With the rows bounded by the size of the
+// data, a corrupt header makes the decoder allocate at most 128 KiB per byte.
+const uint32_t MAX_DIMENSION = 1 << 16;
+
+// Appends nibbles to words, eight to a word, the first one in the top bits
+class NibbleWriter
+{
+public:
+  explicit NibbleWriter(std::vector<uint32_t> & words)
+  : words_(words) {}
+
+  void write(uint32_t value)
+  {
+    do {
+      uint32_t nibble = value & 0x7;
+      value >>= 3;
+      if (value) {
+        nibble |= 0x8;
+      }
+      word_ = (word_ << 4) | nibble;
+      if (++nibbles_ == 8) {
+        words_.push_back(word_);
+        word_ = 0;
+        nibbles_ = 0;
+      }
+    } while (value);
+  }
+
+  void flush()
+  {
+    if (nibbles_) {
+      words_.push_back(word_ << (4 * (8 - nibbles_)));
+      word_ = 0;
+      nibbles_ = 0;
+    }
+  }
+
+private:
+  std::vector<uint32_t> & words_;
+  uint32_t word_ = 0;
+  int nibbles_ = 0;
+};
+
+// Reads back the values of a NibbleWriter, failing past the end of the words
+class NibbleReader
+{
+public:
+  NibbleReader(const uint8_t * data, size_t words)
+  : next_(data), end_(data + 4 * words) {}
+
+  bool read(uint32_t & value)
+  {
+    value = 0;
+    uint32_t nibble;
+    int shift = 0;
+    do {
+      if (nibbles_ == 0) {
+        if (next_ == end_) {
+          return false;
+        }
+        memcpy(&word_, next_, sizeof(word_));
+        next_ += sizeof(word_);
+        nibbles_ = 8;
+      }
+      nibble = word_ >> 28;
+      word_ <<= 4;
+      --nibbles_;
+      // No valid value is longer than 11 nibbles
+      if (shift > 30) {
+        return false;
+      }
+      value |= (nibble & 0x7) << shift;
+      shift += 3;
+    } while (nibble & 0x8);
+    return true;
+  }
+
+private:
+  const uint8_t * next_;
+  const uint8_t * end_;
+  uint32_t word_ = 0;
+  int nibbles_ = 0;
+};
+
+// Length of the run of zeros, or of non-zeros, from begin on
+int runLength(const uint16_t * begin, const uint16_t * end, bool zeros)
+{
+  const uint16_t * p = begin;
+#if CV_SIMD128
+  // Whole blocks of 8 depths first
+  const cv::v_uint16x8 zero = cv::v_setzero_u16();
+  for (; end - p >= 8; p += 8) {
+    const cv::v_uint16x8 is_zero = cv::v_load(p) == zero;
+    if (zeros ? !cv::v_check_all(is_zero) : cv::v_check_any(is_zero)) {
+      break;
+    }
+  }
+#endif
+  while (p != end && (*p == 0) == zeros) {
+    ++p;
+  }
+  return static_cast<int>(p - begin);
+}
+
+// Rows of band b of count bands
+cv::Range bandRows(int b, int count, int height)
+{
+  return cv::Range(b * height / count, (b + 1) * height / count);
+}
+
+void encodeBand(
+  const sensor_msgs::msg::Image & depth, const cv::Range & rows, std::vector<uint32_t> & words)
+{
+  words.clear();
+  words.reserve(static_cast<size_t>(rows.size()) * depth.width / 2 + 1);
+  NibbleWriter writer(words);
+
+  int previous = 0;
+  for (int v = rows.start; v < rows.end; ++v) {
+    const uint16_t * row =
+      reinterpret_cast<const uint16_t *>(&depth.data[static_cast<size_t>(v) * depth.step]);
+    const uint16_t * end = row + depth.width;
+
+    // Every row is a sequence of zeros then non-zeros runs, either maybe empty
+    for (const uint16_t * p = row; p != end; ) {
+      const int zeros = runLength(p, end, true);
+      p += zeros;
+      const int valid = runLength(p, end, false);
+      writer.write(zeros);
+      writer.write(valid);
+      for (const uint16_t * q = p; q != p + valid; ++q) {
+        const int32_t delta = *q - previous;
+        writer.write((static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));
+        previous = *q;
+      }
+      p += valid;
+    }
+  }
+  writer.flush();
+}
+
+bool decodeBand(
+  const uint8_t * data, size_t words, const cv::Range & rows, sensor_msgs::msg::Image & depth)
+{
+  NibbleReader reader(data, words);
+
+  int previous = 0;
+  for (int v = rows.start; v < rows.end; ++v) {
+    uint16_t * row = reinterpret_cast<uint16_t *>(&depth.data[static_cast<size_t>(v) * depth.step]);
+    const uint32_t width = depth.width;
+
+    for (uint32_t u = 0; u < width; ) {
+      uint32_t zeros, valid;
+      if (!reader.read(zeros) || !reader.read(valid) || zeros > width - u ||
+        valid > width - u - zeros)
+      {
+        return false;
+      }
+      std::fill_n(row + u, zeros, 0);
+      u += zeros;
+      for (const uint32_t end = u + valid; u != end; ++u) {
+        uint32_t zigzag;
+        if (!reader.read(zigzag)) {
+          return false;
+        }
+        previous += static_cast<int32_t>(zigzag >> 1) ^ -static_cast<int32_t>(zigzag & 1);
+        row[u] = static_cast<uint16_t>(previous);
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool encodeRvl(
+  const sensor_msgs::msg::Image & depth, int bands,
+  sensor_msgs::msg::CompressedImage & compressed)
+{
+  namespace enc = sensor_msgs::image_encodings;
+  if ((depth.encoding != enc::TYPE_16UC1 && depth.encoding != enc::MONO16) ||
+    depth.step < depth.width * sizeof(uint16_t) ||
+    depth.data.size() < static_cast<size_t>(depth.step) * depth.height)
+  {
+    return false;
+  }
+
+  const int height = static_cast<int>(depth.height);
+  const int count = std::max(1, std::min(bands > 0 ? bands : cv::getNumThreads(), height));
+  std::vector<std::vector<uint32_t>> band_words(count);
+  // Images without pixels have empty bands
+  if (depth.width > 0 && height > 0) {
+    cv::parallel_for_(
+      cv::Range(0, count), [&](const cv::Range & range) {
+        for (int b = range.start; b < range.end; ++b) {
+          encodeBand(depth, bandRows(b, count, height), band_words[b]);
+        }
+      });
+  }
+
+  // Header, band sizes in bytes, then the bands back to back
+  std::vector<uint32_t> header = {RVL_MAGIC, depth.width, depth.height,
+    static_cast<uint32_t>(count)};
+  size_t size = (HEADER_WORDS + count) * sizeof(uint32_t);
+  for (const auto & words : band_words) {
+    header.push_back(static_cast<uint32_t>(words.size() * sizeof(uint32_t)));
+    size += words.size() * sizeof(uint32_t);
+  }
+
+  compressed.header = depth.header;
+  compressed.format = RVL_FORMAT;
+  compressed.data.resize(size);
+  uint8_t * out = compressed.data.data();
+  memcpy(out, header.data(), header.size() * sizeof(uint32_t));
+  out += header.size() * sizeof(uint32_t);
+  for (const auto & words : band_words) {
+    memcpy(out, words.data(), words.size() * sizeof(uint32_t));
+    out += words.size() * sizeof(uint32_t);
+  }
+  return true;
+}
+
+bool decodeRvl(
+  const sensor_msgs::msg::CompressedImage & compressed, sensor_msgs::msg::Image & depth)
+{
+  const std::vector<uint8_t> & data = compressed.data;
+  uint32_t header[HEADER_WORDS];
+  if (compressed.format != RVL_FORMAT || data.size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(header, data.data(), sizeof(header));
+  const uint32_t width = header[1], height = header[2], count = header[3];
+  const size_t sizes_end = (HEADER_WORDS + static_cast<size_t>(count)) * sizeof(uint32_t);
+  if (header[0] != RVL_MAGIC || width > MAX_DIMENSION || height > MAX_DIMENSION ||
+    count == 0 || count > std::max<uint32_t>(height, 1) || data.size() < sizes_end)
+  {
+    return false;
+  }
+
+  // Where every band starts, and its size in words
+  std::vector<size_t> offsets(count), words(count);
+  size_t offset = sizes_end;
+  for (uint32_t b = 0; b < count; ++b) {
+    uint32_t bytes;
+    memcpy(&bytes, &data[(HEADER_WORDS + b) * sizeof(uint32_t)], sizeof(bytes));
+    offsets[b] = offset;
+    words[b] = bytes / sizeof(uint32_t);
+    offset += bytes;
+  }
+  // Every row of a non-empty width takes at least the two nibbles of a run,
+  // which bounds the size of the image by that of the compressed data
+  if (offset > data.size() || (width > 0 && height > offset - sizes_end)) {
+    return false;
+  }
+
+  depth.header = compressed.header;
+  depth.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+  depth.width = width;
+  depth.height = height;
+  depth.is_bigendian = false;
+  depth.step = static_cast<uint32_t>(width * sizeof(uint16_t));
+  depth.data.resize(static_cast<size_t>(depth.step) * height);
+  if (depth.data.empty()) {
+    return true;
+  }
+
+  std::vector<uint8_t> band_ok(count, 0);
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(count)), [&](const cv::Range & range) {
+      for (int b = range.start; b < range.end; ++b) {
+        band_ok[b] = decodeBand(
+          &data[offsets[b]], words[b],
+          bandRows(b, static_cast<int>(count), static_cast<int>(height)), depth);
+      }
+    });
+  return std::all_of(band_ok.begin(), band_ok.end(), [](uint8_t band) {return band != 0;});
+}
+
+}  // namespace depth_image_proc
@@ -0,0 +1,128 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "depth_image_proc/rvl.hpp"
+#include "depth_image_proc/visibility.h"
+
+#include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_transport/image_transport.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+class RvlDecodeNode : public rclcpp::Node
+{
+public:
+  DEPTH_IMAGE_PROC_PUBLIC RvlDecodeNode(const rclcpp::NodeOptions & options);
+
+private:
+  using CompressedImage = sensor_msgs::msg::CompressedImage;
+
+  // Subscriptions
+  rclcpp::Subscription<CompressedImage>::SharedPtr sub_rvl_;
+
+  // Publications
+  std::mutex connect_mutex_;
+  image_transport::Publisher pub_depth_;
+
+  void rvlCb(const CompressedImage::ConstSharedPtr & rvl_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+};
+
+RvlDecodeNode::RvlDecodeNode(const rclcpp::NodeOptions & options)
+: Node("RvlDecodeNode", options)
+{
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
+  // For compressed topics to remap appropriately, we need to pass a
+  // fully expanded and remapped topic name to image_transport
+  auto node_base = this->get_node_base_interface();
+  const std::string topic = node_base->resolve_topic_or_service_name("image", false);
+
+  // Create publisher with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this, topic](rclcpp::MatchedInfo &)
+    {
+      std::lock_guard<std::mutex> lock(connect_mutex_);
+      if (pub_depth_.getNumSubscribers() == 0) {
+        sub_rvl_.reset();
+      } else if (!sub_rvl_) {
+        sub_rvl_ = this->create_subscription<CompressedImage>(
+          topic + "/rvl", latest_only_->qos(rclcpp::SensorDataQoS()),
+          std::bind(&RvlDecodeNode::rvlCb, this, std::placeholders::_1));
+      }
+    };
+  pub_depth_ =
+    image_transport::create_publisher(this, topic, rmw_qos_profile_default, pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void RvlDecodeNode::rvlCb(const CompressedImage::ConstSharedPtr & rvl_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/rvl_decode", rvl_msg.get(), 0, 0, rvl_msg->format.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(rvl_msg->header.stamp, frame)) {
+    return;
+  }
+
+  auto depth_msg = std::make_unique<sensor_msgs::msg::Image>();
+  if (!decodeRvl(*rvl_msg, *depth_msg)) {
+    RCLCPP_ERROR(
+      get_logger(), "Compressed image is not valid RVL [%s]", rvl_msg->format.c_str());
+    return;
+  }
+  pub_depth_.publish(std::move(depth_msg));
+  frame.published(rvl_msg->header.stamp);
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::RvlDecodeNode)
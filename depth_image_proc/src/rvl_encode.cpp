@@ -0,0 +1,142 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "depth_image_proc/rvl.hpp"
+#include "depth_image_proc/visibility.h"
+
+#include <rclcpp/rclcpp.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_transport/image_transport.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace depth_image_proc
+{
+
+class RvlEncodeNode : public rclcpp::Node
+{
+public:
+  DEPTH_IMAGE_PROC_PUBLIC RvlEncodeNode(const rclcpp::NodeOptions & options);
+
+private:
+  using CompressedImage = sensor_msgs::msg::CompressedImage;
+
+  // Subscriptions
+  image_transport::Subscriber sub_depth_;
+
+  // Parameters
+  int bands_;
+
+  // Publications
+  std::mutex connect_mutex_;
+  rclcpp::Publisher<CompressedImage>::SharedPtr pub_rvl_;
+
+  void depthCb(const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg);
+
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+};
+
+RvlEncodeNode::RvlEncodeNode(const rclcpp::NodeOptions & options)
+: Node("RvlEncodeNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("image_transport", "raw");
+
+  // Row bands coded concurrently, 0 for one per OpenCV thread
+  bands_ = this->declare_parameter<int>("bands", 0);
+
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
+  // Create publisher with connect callback
+  rclcpp::PublisherOptions pub_options;
+  pub_options.event_callbacks.matched_callback =
+    [this](rclcpp::MatchedInfo & s)
+    {
+      std::lock_guard<std::mutex> lock(connect_mutex_);
+      if (s.current_count == 0) {
+        sub_depth_.shutdown();
+      } else if (!sub_depth_) {
+        // For compressed topics to remap appropriately, we need to pass a
+        // fully expanded and remapped topic name to image_transport
+        auto node_base = this->get_node_base_interface();
+        std::string topic = node_base->resolve_topic_or_service_name("image", false);
+        // Get transport hints
+        image_transport::TransportHints hints(this);
+        sub_depth_ = image_transport::create_subscription(
+          this, topic,
+          std::bind(&RvlEncodeNode::depthCb, this, std::placeholders::_1),
+          hints.getTransport(), latest_only_->qos(rmw_qos_profile_default));
+      }
+    };
+  // Next to the raw images, as an image_transport transport would be
+  auto node_base = this->get_node_base_interface();
+  std::string topic = node_base->resolve_topic_or_service_name("image", false) + "/rvl";
+  pub_rvl_ = create_publisher<CompressedImage>(topic, rclcpp::SensorDataQoS(), pub_options);
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+}
+
+void RvlEncodeNode::depthCb(const sensor_msgs::msg::Image::ConstSharedPtr & depth_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "depth_image_proc/rvl_encode", depth_msg.get(), depth_msg->width, depth_msg->height,
+    depth_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(depth_msg->header.stamp, frame)) {
+    return;
+  }
+
+  auto rvl_msg = std::make_unique<CompressedImage>();
+  if (!encodeRvl(*depth_msg, bands_, *rvl_msg)) {
+    RCLCPP_ERROR(
+      get_logger(), "Depth image has unsupported encoding [%s]", depth_msg->encoding.c_str());
+    return;
+  }
+  pub_rvl_->publish(std::move(rvl_msg));
+  frame.published(depth_msg->header.stamp);
+}
+
+}  // namespace depth_image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(depth_image_proc::RvlEncodeNode)
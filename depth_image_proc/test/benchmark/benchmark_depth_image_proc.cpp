@@ -0,0 +1,563 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <benchmark/benchmark.h>
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cv_bridge/cv_bridge.hpp"
+#include "image_geometry/pinhole_camera_model.hpp"
+
+#include <depth_image_proc/conversions.hpp>
+#include <depth_image_proc/depth_registration.hpp>
+#include <depth_image_proc/depth_to_scan.hpp>
+#include <depth_image_proc/depth_traits.hpp>
+#include <depth_image_proc/normals.hpp>
+#include <depth_image_proc/radial_table.hpp>
+#include <depth_image_proc/rvl.hpp>
+#include <image_proc/rectification_maps.hpp>
+
+#include <Eigen/Geometry>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <std_msgs/msg/header.hpp>
+
+namespace enc = sensor_msgs::image_encodings;
+
+using sensor_msgs::msg::CameraInfo;
+using sensor_msgs::msg::Image;
+using sensor_msgs::msg::PointCloud2;
+
+namespace
+{
+
+// Resolutions to run every benchmark at
+const std::vector<std::pair<int, int>> kResolutions = {{640, 480}, {1280, 720}, {1920, 1080}};
+
+// The logo of the test resources at the given resolution, BGR8
+const cv::Mat & colorImage(int width, int height)
+{
+  static std::map<std::pair<int, int>, cv::Mat> images;
+  cv::Mat & image = images[{width, height}];
+  if (image.empty()) {
+    cv::Mat logo = cv::imread(
+      std::string(_SRC_RESOURCES_DIR_PATH) + "/logo.png", cv::IMREAD_COLOR);
+    if (logo.empty()) {
+      // Gradient so the kernels still see varying input
+      logo.create(256, 256, CV_8UC3);
+      for (int y = 0; y < logo.rows; ++y) {
+        for (int x = 0; x < logo.cols; ++x) {
+          logo.at<cv::Vec3b>(y, x) = cv::Vec3b(x, y, (x + y) / 2);
+        }
+      }
+    }
+    cv::resize(logo, image, cv::Size(width, height), 0.0, 0.0, cv::INTER_LINEAR);
+  }
+  return image;
+}
+
+// Depth image made from the brightness of colorImage, 0.5 to 4.5 m, with the
+// darkest pixels missing
+Image::ConstSharedPtr depthImage(int width, int height, const std::string & encoding)
+{
+  cv::Mat gray;
+  cv::cvtColor(colorImage(width, height), gray, cv::COLOR_BGR2GRAY);
+  cv::Mat depth;
+  if (encoding == enc::TYPE_32FC1) {
+    gray.convertTo(depth, CV_32F, 4.0 / 255.0, 0.5);
+    depth.setTo(std::numeric_limits<float>::quiet_NaN(), gray < 8);
+  } else {
+    gray.convertTo(depth, CV_16U, 4000.0 / 255.0, 500.0);
+    depth.setTo(0, gray < 8);
+  }
+  return cv_bridge::CvImage(std_msgs::msg::Header(), encoding, depth).toImageMsg();
+}
+
+// colorImage in an 8-bit color or mono encoding
+Image::ConstSharedPtr rgbImage(int width, int height, const std::string & encoding)
+{
+  cv::Mat image = colorImage(width, height);
+  if (encoding == enc::RGB8) {
+    cv::cvtColor(image, image, cv::COLOR_BGR2RGB);
+  } else if (encoding == enc::MONO8) {
+    cv::cvtColor(image, image, cv::COLOR_BGR2GRAY);
+  }
+  return cv_bridge::CvImage(std_msgs::msg::Header(), encoding, image).toImageMsg();
+}
+
+// Calibration of a camera with a 70 degree horizontal field of view, and some
+// barrel distortion for the radial clouds
+CameraInfo cameraInfo(int width, int height)
+{
+  CameraInfo info;
+  info.width = width;
+  info.height = height;
+  const double f = 0.7 * width;
+  info.k = {f, 0.0, width / 2.0, 0.0, f, height / 2.0, 0.0, 0.0, 1.0};
+  info.p = {f, 0.0, width / 2.0, 0.0, 0.0, f, height / 2.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  info.r = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+  info.distortion_model = "plumb_bob";
+  info.d = {-0.2, 0.05, 0.0, 0.0, 0.0};
+  return info;
+}
+
+// Empty cloud with the given fields, the size of the image, as the point
+// cloud nodes lay it out
+PointCloud2::SharedPtr cloud(int width, int height, bool rgb)
+{
+  auto cloud_msg = std::make_shared<PointCloud2>();
+  sensor_msgs::PointCloud2Modifier modifier(*cloud_msg);
+  if (rgb) {
+    modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+  } else {
+    modifier.setPointCloud2FieldsByString(1, "xyz");
+  }
+  modifier.resize(width * height);
+  cloud_msg->width = width;
+  cloud_msg->height = height;
+  cloud_msg->row_step = width * cloud_msg->point_step;
+  return cloud_msg;
+}
+
+const std::vector<std::string> kDepthEncodings = {enc::TYPE_16UC1, enc::TYPE_32FC1};
+
+// Arguments: width, height, index in kDepthEncodings
+void depthArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kDepthEncodings.size(); ++i) {
+      benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(i)});
+    }
+  }
+}
+
+void setPointsProcessed(benchmark::State & state)
+{
+  state.SetItemsProcessed(
+    static_cast<int64_t>(state.iterations()) * state.range(0) * state.range(1));
+}
+
+// Ray table fast path of PointCloudXyzNode
+void BM_ConvertDepth(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(cameraInfo(width, height));
+  depth_image_proc::DepthRayLut lut;
+  lut.update(model, width, height);
+  const auto cloud_msg = cloud(width, height, false);
+  for (auto _ : state) {
+    if (encoding == enc::TYPE_32FC1) {
+      depth_image_proc::convertDepth<float>(depth_msg, cloud_msg, lut);
+    } else {
+      depth_image_proc::convertDepth<uint16_t>(depth_msg, cloud_msg, lut);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ConvertDepth)->Apply(depthArguments)->UseRealTime();
+
+// Same, with the points moved into another frame as they are made
+void BM_ConvertDepthTransformed(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(cameraInfo(width, height));
+  depth_image_proc::DepthRayLut lut;
+  lut.update(model, width, height);
+  const auto cloud_msg = cloud(width, height, false);
+  // Optical frame to a body frame 1 m up
+  const cv::Matx34f transform(
+    0.0f, 0.0f, 1.0f, 0.0f,
+    -1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, -1.0f, 0.0f, 1.0f);
+  for (auto _ : state) {
+    if (encoding == enc::TYPE_32FC1) {
+      depth_image_proc::convertDepth<float>(depth_msg, cloud_msg, lut, 0.0, &transform);
+    } else {
+      depth_image_proc::convertDepth<uint16_t>(depth_msg, cloud_msg, lut, 0.0, &transform);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ConvertDepthTransformed)->Apply(depthArguments)->UseRealTime();
+
+// Generic path through the point cloud iterators, the reference for the one
+// above
+void BM_ConvertDepthIterators(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(cameraInfo(width, height));
+  const auto cloud_msg = cloud(width, height, false);
+  for (auto _ : state) {
+    if (encoding == enc::TYPE_32FC1) {
+      depth_image_proc::convertDepth<float>(depth_msg, cloud_msg, model);
+    } else {
+      depth_image_proc::convertDepth<uint16_t>(depth_msg, cloud_msg, model);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ConvertDepthIterators)->Apply(depthArguments)->UseRealTime();
+
+void BM_ConvertDepthRadial(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  const auto table = depth_image_proc::RadialTable::get(cameraInfo(width, height));
+  const auto cloud_msg = cloud(width, height, false);
+  for (auto _ : state) {
+    if (encoding == enc::TYPE_32FC1) {
+      depth_image_proc::convertDepthRadial<float>(depth_msg, cloud_msg, *table);
+    } else {
+      depth_image_proc::convertDepthRadial<uint16_t>(depth_msg, cloud_msg, *table);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ConvertDepthRadial)->Apply(depthArguments)->UseRealTime();
+
+// RectifyDepthNode: raw depth rectified to meters and made into a cloud in one pass
+void BM_RectifyDepth(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  const CameraInfo info = cameraInfo(width, height);
+  image_proc::RectificationMaps maps;
+  maps.update(info);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(info);
+  depth_image_proc::DepthRayLut lut;
+  lut.update(model, width, height);
+  Image rect_msg;
+  const auto cloud_msg = cloud(width, height, false);
+  for (auto _ : state) {
+    if (encoding == enc::TYPE_32FC1) {
+      depth_image_proc::rectifyDepth<float>(
+        *depth_msg, maps.map1(), maps.map2(), false, rect_msg, &lut, cloud_msg.get());
+    } else {
+      depth_image_proc::rectifyDepth<uint16_t>(
+        *depth_msg, maps.map1(), maps.map2(), false, rect_msg, &lut, cloud_msg.get());
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_RectifyDepth)->Apply(depthArguments)->UseRealTime();
+
+// Normals of PointCloudXyzNormalNode, on a cloud already converted
+void BM_ComputeNormals(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(cameraInfo(width, height));
+  depth_image_proc::DepthRayLut lut;
+  lut.update(model, width, height);
+  auto cloud_msg = std::make_shared<PointCloud2>();
+  sensor_msgs::PointCloud2Modifier modifier(*cloud_msg);
+  modifier.setPointCloud2Fields(
+    6,
+    "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "z", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "normal_x", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "normal_y", 1, sensor_msgs::msg::PointField::FLOAT32,
+    "normal_z", 1, sensor_msgs::msg::PointField::FLOAT32);
+  modifier.resize(width * height);
+  cloud_msg->width = width;
+  cloud_msg->height = height;
+  cloud_msg->row_step = width * cloud_msg->point_step;
+  if (encoding == enc::TYPE_32FC1) {
+    depth_image_proc::convertDepth<float>(depth_msg, cloud_msg, lut);
+  } else {
+    depth_image_proc::convertDepth<uint16_t>(depth_msg, cloud_msg, lut);
+  }
+  const depth_image_proc::NormalEstimation estimation;
+  for (auto _ : state) {
+    depth_image_proc::computeNormals(estimation, *cloud_msg);
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ComputeNormals)->Apply(depthArguments)->UseRealTime();
+
+// Scan of DepthToScanNode, from a band of 16 rows around the optical center
+void BM_DepthToScan(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const auto depth_msg = depthImage(width, height, encoding);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(cameraInfo(width, height));
+  depth_image_proc::DepthRayLut lut;
+  lut.update(model, width, height);
+  depth_image_proc::ScanLayout layout;
+  layout.update(lut);
+  const int rows = 16;
+  std::vector<float> ranges;
+  for (auto _ : state) {
+    depth_image_proc::depthToScan(
+      *depth_msg, height / 2 - rows / 2, rows, layout, 0.45f, 10.0f, ranges);
+    benchmark::DoNotOptimize(ranges.data());
+  }
+  state.SetLabel(encoding);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * width * rows);
+}
+BENCHMARK(BM_DepthToScan)->Apply(depthArguments)->UseRealTime();
+
+const std::vector<std::string> kColorEncodings = {enc::RGB8, enc::BGR8, enc::MONO8};
+
+// Arguments: width, height, index in kColorEncodings, RGB image scale: 1 for
+// the size of the depth image, 2 for twice that
+void colorArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding", "scale"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kColorEncodings.size(); ++i) {
+      for (int scale : {1, 2}) {
+        benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(i), scale});
+      }
+    }
+  }
+}
+
+// Channel offsets of an encoding of kColorEncodings, as PointCloudXyzrgbNode
+// picks them
+void colorOffsets(const std::string & encoding, int & red, int & green, int & blue, int & step)
+{
+  if (encoding == enc::MONO8) {
+    red = green = blue = 0;
+    step = 1;
+  } else {
+    red = encoding == enc::RGB8 ? 0 : 2;
+    green = 1;
+    blue = encoding == enc::RGB8 ? 2 : 0;
+    step = 3;
+  }
+}
+
+void BM_ConvertRgb(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kColorEncodings[state.range(2)];
+  const int scale = state.range(3);
+  const auto rgb_msg = rgbImage(width * scale, height * scale, encoding);
+  int red, green, blue, step;
+  colorOffsets(encoding, red, green, blue, step);
+  const auto cloud_msg = cloud(width, height, true);
+  depth_image_proc::ColorSampling sampling;
+  sampling.update(width, height, *rgb_msg, step);
+  for (auto _ : state) {
+    if (scale == 1) {
+      depth_image_proc::convertRgb(rgb_msg, cloud_msg, red, green, blue, step);
+    } else {
+      depth_image_proc::convertRgb(rgb_msg, cloud_msg, sampling, red, green, blue);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ConvertRgb)->Apply(colorArguments)->UseRealTime();
+
+// Single pass of PointCloudXyzrgbNode, to compare with BM_ConvertDepth plus
+// BM_ConvertRgb
+void BM_ConvertDepthRgb(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kColorEncodings[state.range(2)];
+  const int scale = state.range(3);
+  const auto depth_msg = depthImage(width, height, enc::TYPE_16UC1);
+  const auto rgb_msg = rgbImage(width * scale, height * scale, encoding);
+  int red, green, blue, step;
+  colorOffsets(encoding, red, green, blue, step);
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(cameraInfo(width, height));
+  depth_image_proc::DepthRayLut lut;
+  lut.update(model, width, height);
+  depth_image_proc::ColorSampling sampling;
+  sampling.update(width, height, *rgb_msg, step);
+  const auto cloud_msg = cloud(width, height, true);
+  for (auto _ : state) {
+    depth_image_proc::convertDepthRgb<uint16_t>(
+      depth_msg, rgb_msg, cloud_msg, lut, sampling, red, green, blue);
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_ConvertDepthRgb)->Apply(colorArguments)->UseRealTime();
+
+// Arguments: width, height, index in kDepthEncodings, rasterize_triangles
+void registerArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding", "triangles"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kDepthEncodings.size(); ++i) {
+      for (int triangles : {0, 1}) {
+        benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(i), triangles});
+      }
+    }
+  }
+}
+
+template<typename T>
+void registerDepth(
+  depth_image_proc::DepthRegistration & registration, const Image & depth_msg,
+  bool triangles, Image & registered_msg)
+{
+  registered_msg.step = registered_msg.width * sizeof(T);
+  registered_msg.data.resize(registered_msg.height * registered_msg.step);
+  depth_image_proc::DepthTraits<T>::initializeBuffer(registered_msg.data);
+  depth_image_proc::RegisteredDepth registered;
+  if (triangles) {
+    registration.registerTriangles<T>(depth_msg, 0.05, registered);
+  } else {
+    registration.registerPoints<T>(depth_msg, registered);
+  }
+  registered.write<T>(registered_msg);
+}
+
+// The registration of RegisterNode::convert into an RGB camera of the same
+// resolution, 2.5 cm to the side
+void BM_Register(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(2)];
+  const bool triangles = state.range(3) != 0;
+  const auto depth_msg = depthImage(width, height, encoding);
+  CameraInfo info = cameraInfo(width, height);
+  info.d.assign(5, 0.0);
+  const Eigen::Affine3d depth_to_rgb(Eigen::Translation3d(0.025, 0.0, 0.0));
+  depth_image_proc::DepthRegistration registration;
+  registration.update(info, info, depth_to_rgb);
+
+  Image registered_msg;
+  registered_msg.width = width;
+  registered_msg.height = height;
+  registered_msg.encoding = encoding;
+  for (auto _ : state) {
+    if (encoding == enc::TYPE_32FC1) {
+      registerDepth<float>(registration, *depth_msg, triangles, registered_msg);
+    } else {
+      registerDepth<uint16_t>(registration, *depth_msg, triangles, registered_msg);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetLabel(encoding);
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_Register)->Apply(registerArguments)->UseRealTime();
+
+// Arguments: width, height, row bands (0 for one per thread)
+void rvlArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "bands"});
+  for (const auto & resolution : kResolutions) {
+    for (int bands : {1, 0}) {
+      benchmark->Args({resolution.first, resolution.second, bands});
+    }
+  }
+}
+
+void BM_RvlEncode(benchmark::State & state)
+{
+  const auto depth_msg = depthImage(state.range(0), state.range(1), enc::TYPE_16UC1);
+  sensor_msgs::msg::CompressedImage rvl_msg;
+  for (auto _ : state) {
+    depth_image_proc::encodeRvl(*depth_msg, state.range(2), rvl_msg);
+    benchmark::ClobberMemory();
+  }
+  state.counters["ratio"] = static_cast<double>(depth_msg->data.size()) / rvl_msg.data.size();
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_RvlEncode)->Apply(rvlArguments)->UseRealTime();
+
+void BM_RvlDecode(benchmark::State & state)
+{
+  const auto depth_msg = depthImage(state.range(0), state.range(1), enc::TYPE_16UC1);
+  sensor_msgs::msg::CompressedImage rvl_msg;
+  depth_image_proc::encodeRvl(*depth_msg, state.range(2), rvl_msg);
+  Image decoded_msg;
+  for (auto _ : state) {
+    depth_image_proc::decodeRvl(rvl_msg, decoded_msg);
+    benchmark::ClobberMemory();
+  }
+  setPointsProcessed(state);
+}
+BENCHMARK(BM_RvlDecode)->Apply(rvlArguments)->UseRealTime();
+
+}  // namespace
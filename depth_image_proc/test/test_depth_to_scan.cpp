@@ -0,0 +1,144 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "depth_image_proc/conversions.hpp"
+#include "depth_image_proc/depth_to_scan.hpp"
+#include "image_geometry/pinhole_camera_model.hpp"
+
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+// Camera with a horizontal field of view of about 120 degrees, wide enough for
+// the central columns to span more than the mean angle between columns
+image_geometry::PinholeCameraModel wideModel(int width, int height)
+{
+  sensor_msgs::msg::CameraInfo info;
+  info.width = width;
+  info.height = height;
+  const double f = 0.29 * width;
+  info.k = {f, 0.0, width / 2.0, 0.0, f, height / 2.0, 0.0, 0.0, 1.0};
+  info.r = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+  info.p = {f, 0.0, width / 2.0, 0.0, 0.0, f, height / 2.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  info.distortion_model = "plumb_bob";
+  info.d.assign(5, 0.0);
+
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(info);
+  return model;
+}
+
+// 16UC1 image of a wall facing the camera at depth millimeters
+sensor_msgs::msg::Image wall(int width, int height, uint16_t depth)
+{
+  sensor_msgs::msg::Image image;
+  image.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+  image.width = width;
+  image.height = height;
+  image.step = width * sizeof(uint16_t);
+  image.data.resize(static_cast<size_t>(image.step) * height);
+  auto * data = reinterpret_cast<uint16_t *>(image.data.data());
+  std::fill(data, data + static_cast<size_t>(width) * height, depth);
+  return image;
+}
+
+}  // namespace
+
+TEST(DepthToScan, everyBinHasARange)
+{
+  const int width = 640, height = 8;
+  depth_image_proc::DepthRayLut lut;
+  lut.update(wideModel(width, height), width, height);
+  depth_image_proc::ScanLayout layout;
+  layout.update(lut);
+
+  const auto image = wall(width, height, 2000);
+  std::vector<float> ranges;
+  ASSERT_TRUE(depth_image_proc::depthToScan(image, 0, height, layout, 0.1f, 20.0f, ranges));
+  ASSERT_EQ(ranges.size(), static_cast<size_t>(width));
+  for (size_t b = 0; b < ranges.size(); ++b) {
+    const float angle = layout.angleMin() + b * layout.angleIncrement();
+    ASSERT_TRUE(std::isfinite(ranges[b])) << "bin " << b;
+    // A bin takes the range of a column at most one column away in angle
+    EXPECT_NEAR(ranges[b], 2.0f / std::cos(angle), 0.05f) << "bin " << b;
+  }
+}
+
+TEST(DepthToScan, outOfRangeIsInfinite)
+{
+  const int width = 64, height = 4;
+  depth_image_proc::DepthRayLut lut;
+  lut.update(wideModel(width, height), width, height);
+  depth_image_proc::ScanLayout layout;
+  layout.update(lut);
+
+  std::vector<float> ranges;
+  const auto scan = [&](const sensor_msgs::msg::Image & image)
+    {
+      return depth_image_proc::depthToScan(image, 0, height, layout, 1.0f, 5.0f, ranges);
+    };
+
+  // Closer than range_min everywhere: -inf
+  ASSERT_TRUE(scan(wall(width, height, 200)));
+  for (float range : ranges) {
+    EXPECT_TRUE(std::isinf(range) && range < 0.0f);
+  }
+
+  // Beyond range_max, or invalid: +inf
+  ASSERT_TRUE(scan(wall(width, height, 9000)));
+  for (float range : ranges) {
+    EXPECT_TRUE(std::isinf(range) && range > 0.0f);
+  }
+  ASSERT_TRUE(scan(wall(width, height, 0)));
+  for (float range : ranges) {
+    EXPECT_TRUE(std::isinf(range) && range > 0.0f);
+  }
+
+  // A range within the limits wins over a closer one in the same column
+  auto image = wall(width, height, 200);
+  auto * data = reinterpret_cast<uint16_t *>(image.data.data());
+  std::fill(data, data + width, 3000);
+  ASSERT_TRUE(scan(image));
+  for (float range : ranges) {
+    EXPECT_TRUE(std::isfinite(range));
+  }
+}
@@ -0,0 +1,112 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "depth_image_proc/point_cloud_output.hpp"
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <sensor_msgs/point_cloud2_iterator.hpp>
+
+namespace
+{
+
+// Organized 4x2 xyz cloud, the last point invalid
+sensor_msgs::msg::PointCloud2 makeCloud()
+{
+  sensor_msgs::msg::PointCloud2 cloud;
+  cloud.width = 4;
+  cloud.height = 2;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2FieldsByString(1, "xyz");
+  sensor_msgs::PointCloud2Iterator<float> x(cloud, "x");
+  for (int i = 0; i < 8; ++i, ++x) {
+    x[0] = 0.25f * i;
+    x[1] = -0.5f * i;
+    x[2] = i < 7 ? 1.0f + i : std::numeric_limits<float>::quiet_NaN();
+  }
+  return cloud;
+}
+
+}  // namespace
+
+TEST(PointCloudOutput, quantizedFieldsCarryTheirScale)
+{
+  const auto cloud = makeCloud();
+  sensor_msgs::msg::PointCloud2 quantized;
+  depth_image_proc::quantizePointCloud(cloud, 0.002, quantized);
+
+  ASSERT_EQ(quantized.fields.size(), 3u);
+  EXPECT_EQ(quantized.point_step, 3 * sizeof(int16_t));
+  const char * axes[] = {"x", "y", "z"};
+  for (size_t i = 0; i < 3; ++i) {
+    const auto & field = quantized.fields[i];
+    EXPECT_EQ(field.datatype, sensor_msgs::msg::PointField::INT16);
+    std::string axis;
+    double scale = 0.0;
+    ASSERT_TRUE(depth_image_proc::parseQuantizedField(field.name, axis, scale)) << field.name;
+    EXPECT_EQ(axis, axes[i]);
+    EXPECT_DOUBLE_EQ(scale, 0.002);
+  }
+
+  // Counts of 2 mm, the invalid point at the smallest count
+  for (int i = 0; i < 8; ++i) {
+    int16_t xyz[3];
+    std::memcpy(xyz, &quantized.data[i * quantized.point_step], sizeof(xyz));
+    EXPECT_EQ(xyz[0], std::lround(0.25 * i / 0.002));
+    EXPECT_EQ(xyz[1], std::lround(-0.5 * i / 0.002));
+    EXPECT_EQ(xyz[2], i < 7 ? std::lround((1.0 + i) / 0.002) : -32768);
+  }
+}
+
+TEST(PointCloudOutput, parsesOnlyQuantizedNames)
+{
+  std::string axis;
+  double scale = 0.0;
+  EXPECT_TRUE(
+    depth_image_proc::parseQuantizedField(
+      depth_image_proc::quantizedFieldName("z", 0.001), axis, scale));
+  EXPECT_EQ(axis, "z");
+  EXPECT_DOUBLE_EQ(scale, 0.001);
+
+  EXPECT_FALSE(depth_image_proc::parseQuantizedField("x", axis, scale));
+  EXPECT_FALSE(depth_image_proc::parseQuantizedField("*0.001", axis, scale));
+  EXPECT_FALSE(depth_image_proc::parseQuantizedField("x*", axis, scale));
+  EXPECT_FALSE(depth_image_proc::parseQuantizedField("x*0.001m", axis, scale));
+  EXPECT_FALSE(depth_image_proc::parseQuantizedField("x*-1", axis, scale));
+}
@@ -0,0 +1,178 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "depth_image_proc/rvl.hpp"
+
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+// 16UC1 depths with runs of invalid zeros between random valid ones
+sensor_msgs::msg::Image makeDepth(uint32_t width, uint32_t height)
+{
+  sensor_msgs::msg::Image depth;
+  depth.header.frame_id = "depth";
+  depth.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+  depth.width = width;
+  depth.height = height;
+  depth.step = width * sizeof(uint16_t);
+  depth.data.resize(static_cast<size_t>(depth.step) * height);
+  if (depth.data.empty()) {
+    return depth;
+  }
+  cv::Mat mat(height, width, CV_16UC1, depth.data.data(), depth.step);
+  cv::RNG rng(7);
+  rng.fill(mat, cv::RNG::UNIFORM, 0, 10000);
+  for (uint32_t v = 0; v < height; ++v) {
+    mat.row(v).colRange(0, std::min<int>(width, v % 17)).setTo(0);
+  }
+  return depth;
+}
+
+void setWord(sensor_msgs::msg::CompressedImage & compressed, size_t index, uint32_t value)
+{
+  std::memcpy(&compressed.data[index * sizeof(uint32_t)], &value, sizeof(value));
+}
+
+}  // namespace
+
+TEST(Rvl, roundTrip)
+{
+  const auto depth = makeDepth(160, 120);
+  for (int bands : {1, 4, 0}) {
+    sensor_msgs::msg::CompressedImage compressed;
+    ASSERT_TRUE(depth_image_proc::encodeRvl(depth, bands, compressed));
+    EXPECT_EQ(compressed.format, depth_image_proc::RVL_FORMAT);
+
+    sensor_msgs::msg::Image decoded;
+    ASSERT_TRUE(depth_image_proc::decodeRvl(compressed, decoded));
+    EXPECT_EQ(decoded.width, depth.width);
+    EXPECT_EQ(decoded.height, depth.height);
+    EXPECT_EQ(decoded.header.frame_id, "depth");
+    EXPECT_EQ(decoded.data, depth.data);
+  }
+}
+
+TEST(Rvl, emptyImagesRoundTrip)
+{
+  for (const auto & size : {cv::Size(0, 0), cv::Size(64, 0), cv::Size(0, 8)}) {
+    const auto depth = makeDepth(size.width, size.height);
+    sensor_msgs::msg::CompressedImage compressed;
+    ASSERT_TRUE(depth_image_proc::encodeRvl(depth, 0, compressed));
+    sensor_msgs::msg::Image decoded;
+    ASSERT_TRUE(depth_image_proc::decodeRvl(compressed, decoded));
+    EXPECT_EQ(decoded.width, depth.width);
+    EXPECT_EQ(decoded.height, depth.height);
+    EXPECT_TRUE(decoded.data.empty());
+  }
+}
+
+TEST(Rvl, rejectsOtherEncodings)
+{
+  auto depth = makeDepth(16, 16);
+  depth.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+  sensor_msgs::msg::CompressedImage compressed;
+  EXPECT_FALSE(depth_image_proc::encodeRvl(depth, 1, compressed));
+}
+
+TEST(Rvl, rejectsMalformedInput)
+{
+  sensor_msgs::msg::CompressedImage valid;
+  ASSERT_TRUE(depth_image_proc::encodeRvl(makeDepth(64, 48), 2, valid));
+  sensor_msgs::msg::Image decoded;
+
+  auto format = valid;
+  format.format = "16UC1; compressedDepth";
+  EXPECT_FALSE(depth_image_proc::decodeRvl(format, decoded));
+
+  auto magic = valid;
+  setWord(magic, 0, 0);
+  EXPECT_FALSE(depth_image_proc::decodeRvl(magic, decoded));
+
+  auto header_only = valid;
+  header_only.data.resize(3 * sizeof(uint32_t));
+  EXPECT_FALSE(depth_image_proc::decodeRvl(header_only, decoded));
+
+  auto truncated = valid;
+  truncated.data.resize(truncated.data.size() - sizeof(uint32_t));
+  EXPECT_FALSE(depth_image_proc::decodeRvl(truncated, decoded));
+
+  auto no_bands = valid;
+  setWord(no_bands, 3, 0);
+  EXPECT_FALSE(depth_image_proc::decodeRvl(no_bands, decoded));
+
+  // Runs longer than the rows
+  auto narrow = valid;
+  setWord(narrow, 1, 8);
+  EXPECT_FALSE(depth_image_proc::decodeRvl(narrow, decoded));
+}
+
+TEST(Rvl, rejectsDimensionsTheDataCannotHold)
+{
+  sensor_msgs::msg::CompressedImage valid;
+  ASSERT_TRUE(depth_image_proc::encodeRvl(makeDepth(64, 48), 1, valid));
+  sensor_msgs::msg::Image decoded;
+
+  // A width whose step overflows, and one above the largest decoded
+  for (uint32_t width : {0xffffffffu, 0x80000000u, (1u << 16) + 1}) {
+    auto wide = valid;
+    setWord(wide, 1, width);
+    EXPECT_FALSE(depth_image_proc::decodeRvl(wide, decoded));
+  }
+
+  // More rows than bytes of data, which would allocate far more than the
+  // few bytes of input
+  auto tall = valid;
+  setWord(tall, 2, 1u << 16);
+  EXPECT_FALSE(depth_image_proc::decodeRvl(tall, decoded));
+
+  sensor_msgs::msg::CompressedImage tiny;
+  tiny.format = depth_image_proc::RVL_FORMAT;
+  tiny.data.resize(6 * sizeof(uint32_t), 0);
+  setWord(tiny, 0, 0x314c5652);
+  setWord(tiny, 1, 1u << 16);
+  setWord(tiny, 2, 1u << 16);
+  setWord(tiny, 3, 1);
+  setWord(tiny, 4, sizeof(uint32_t));
+  EXPECT_FALSE(depth_image_proc::decodeRvl(tiny, decoded));
+}
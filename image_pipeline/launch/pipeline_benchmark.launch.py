@@ -0,0 +1,216 @@
+# Copyright 2026, image_pipeline contributors
+# All rights reserved.
+#
+# Software License Agreement (BSD License 2.0)
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# * Redistributions of source code must retain the above copyright
+#   notice, this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above
+#   copyright notice, this list of conditions and the following
+#   disclaimer in the documentation and/or other materials provided
+#   with the distribution.
+# * Neither the name of {copyright_holder} nor the names of its
+#   contributors may be used to endorse or promote products derived
+#   from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+# Replays synthetic frames through a whole camera-to-cloud pipeline composed in
+# one multi-threaded container with intra-process communication, and reports
+# the end-to-end and per-stage latency at a sweep of rates. To sweep the thread
+# count too, run it once per count, appending to the same report:
+#
+#   for threads in 1 2 4 8; do
+#     ros2 launch image_pipeline pipeline_benchmark.launch.py threads:=$threads \
+#       report_file:=/tmp/pipeline_benchmark.csv
+#   done
+
+from launch import LaunchDescription
+from launch.actions import DeclareLaunchArgument
+from launch.actions import EmitEvent
+from launch.actions import RegisterEventHandler
+from launch.conditions import IfCondition
+from launch.conditions import LaunchConfigurationEquals
+from launch.event_handlers import OnProcessExit
+from launch.events import Shutdown
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import ComposableNodeContainer
+from launch_ros.actions import Node
+from launch_ros.descriptions import ComposableNode
+from launch_ros.parameter_descriptions import ParameterValue
+from tracetools_launch.action import Trace
+
+
+def generate_launch_description():
+    intra_process = [{'use_intra_process_comms': True}]
+
+    benchmark_parameters = {
+        'width': LaunchConfiguration('width'),
+        'height': LaunchConfiguration('height'),
+        'rates': LaunchConfiguration('rates'),
+        'step_duration': LaunchConfiguration('step_duration'),
+        'label': ParameterValue(['threads=', LaunchConfiguration('threads')], value_type=str),
+        'report_file': ParameterValue(LaunchConfiguration('report_file'), value_type=str),
+    }
+
+    # debayer -> rectify -> disparity -> point cloud, for both cameras
+    stereo_nodes = []
+    for camera in ['left', 'right']:
+        stereo_nodes += [
+            ComposableNode(
+                package='image_proc',
+                plugin='image_proc::DebayerNode',
+                name='debayer_node',
+                namespace=camera,
+                extra_arguments=intra_process,
+            ),
+            ComposableNode(
+                package='image_proc',
+                plugin='image_proc::RectifyNode',
+                name='rectify_mono_node',
+                namespace=camera,
+                remappings=[('image', 'image_mono'), ('image_rect', 'image_rect')],
+                extra_arguments=intra_process,
+            ),
+            ComposableNode(
+                package='image_proc',
+                plugin='image_proc::RectifyNode',
+                name='rectify_color_node',
+                namespace=camera,
+                remappings=[('image', 'image_color'), ('image_rect', 'image_rect_color')],
+                extra_arguments=intra_process,
+            ),
+        ]
+    stereo_nodes += [
+        ComposableNode(
+            package='stereo_image_proc',
+            plugin='stereo_image_proc::DisparityNode',
+            name='disparity_node',
+            extra_arguments=intra_process,
+        ),
+        ComposableNode(
+            package='stereo_image_proc',
+            plugin='stereo_image_proc::PointCloudNode',
+            name='point_cloud_node',
+            extra_arguments=intra_process,
+        ),
+        ComposableNode(
+            package='image_proc',
+            plugin='image_proc::PipelineBenchmarkNode',
+            name='pipeline_benchmark_node',
+            parameters=[dict(benchmark_parameters, mode='stereo')],
+            remappings=[('points', 'points2')],
+            extra_arguments=intra_process,
+        ),
+    ]
+
+    # depth -> register -> xyzrgb point cloud
+    depth_nodes = [
+        ComposableNode(
+            package='depth_image_proc',
+            plugin='depth_image_proc::RegisterNode',
+            name='register_node',
+            parameters=[{'static_extrinsic': True}],
+            extra_arguments=intra_process,
+        ),
+        ComposableNode(
+            package='depth_image_proc',
+            plugin='depth_image_proc::PointCloudXyzrgbNode',
+            name='point_cloud_xyzrgb_node',
+            parameters=[{'exact_sync': True}],
+            extra_arguments=intra_process,
+        ),
+        ComposableNode(
+            package='image_proc',
+            plugin='image_proc::PipelineBenchmarkNode',
+            name='pipeline_benchmark_node',
+            parameters=[dict(benchmark_parameters, mode='depth')],
+            extra_arguments=intra_process,
+        ),
+    ]
+
+    containers = [
+        ComposableNodeContainer(
+            condition=LaunchConfigurationEquals('mode', mode),
+            name='pipeline_benchmark_container',
+            namespace='',
+            package='rclcpp_components',
+            executable='component_container_mt',
+            parameters=[{'thread_num': LaunchConfiguration('threads')}],
+            composable_node_descriptions=nodes,
+            output='screen',
+        )
+        for mode, nodes in [('stereo', stereo_nodes), ('depth', depth_nodes)]
+    ]
+
+    return LaunchDescription([
+        DeclareLaunchArgument(
+            name='mode', default_value='stereo',
+            description='Pipeline to measure: stereo (debayer, rectify, disparity, point '
+                        'cloud) or depth (register, xyzrgb point cloud)'
+        ),
+        DeclareLaunchArgument(
+            name='threads', default_value='0',
+            description='Threads of the container, 0 for one per core'
+        ),
+        DeclareLaunchArgument(
+            name='width', default_value='1280', description='Width of the frames'
+        ),
+        DeclareLaunchArgument(
+            name='height', default_value='720', description='Height of the frames'
+        ),
+        DeclareLaunchArgument(
+            name='rates', default_value='[5.0, 10.0, 15.0, 20.0, 30.0, 45.0, 60.0, 90.0]',
+            description='Frame rates to replay at, in Hz'
+        ),
+        DeclareLaunchArgument(
+            name='step_duration', default_value='10.0',
+            description='Seconds measured at every rate'
+        ),
+        DeclareLaunchArgument(
+            name='report_file', default_value='',
+            description='CSV file to append the results to'
+        ),
+        DeclareLaunchArgument(
+            name='trace', default_value='False',
+            description='Record the image_pipeline tracepoints of every stage with LTTng'
+        ),
+        Trace(
+            condition=IfCondition(LaunchConfiguration('trace')),
+            session_name='image_pipeline_benchmark',
+            events_ust=['ros2_image_pipeline:*', 'ros2:*'],
+        ),
+        # Registration needs the depth to color extrinsics
+        Node(
+            condition=LaunchConfigurationEquals('mode', 'depth'),
+            package='tf2_ros',
+            executable='static_transform_publisher',
+            arguments=[
+                '--x', '0.025', '--frame-id', 'benchmark_rgb', '--child-frame-id',
+                'benchmark_depth'
+            ],
+        ),
+        *containers,
+        # The benchmark shuts its container down once the sweep is over
+        *[
+            RegisterEventHandler(
+                OnProcessExit(target_action=container, on_exit=[EmitEvent(event=Shutdown())])
+            )
+            for container in containers
+        ],
+    ])
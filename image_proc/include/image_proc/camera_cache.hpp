@@ -0,0 +1,134 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__CAMERA_CACHE_HPP_
+#define IMAGE_PROC__CAMERA_CACHE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+
+#include <image_geometry/pinhole_camera_model.hpp>
+#include <image_geometry/stereo_camera_model.hpp>
+#include <image_proc/rectification_maps.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Process-wide cache of the data nodes derive from a calibration: camera
+ * models, rectification maps and any other table, shared by all nodes of the
+ * process that process the same camera.
+ *
+ * Entries are keyed by the content of the CameraInfo (see
+ * RectificationMaps::hashCameraInfo), built by the first node asking for
+ * them and only held by their users, so they are freed once no node uses that
+ * calibration anymore. Everything handed out is const and must not be
+ * modified. Thread-safe.
+ */
+class CameraCache
+{
+public:
+  struct Statistics
+  {
+    // Lookups served from / not served from the cache
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Entries currently in use
+    size_t entries = 0;
+  };
+
+  static CameraCache & instance();
+
+  /**
+   * Camera model of info. Only for its geometry: rectify with
+   * rectificationMaps(), the rectification cache of the model itself is not
+   * thread-safe.
+   */
+  std::shared_ptr<const image_geometry::PinholeCameraModel> pinholeModel(
+    const sensor_msgs::msg::CameraInfo & info);
+
+  // Stereo camera model of a left and right calibration, same restriction
+  std::shared_ptr<const image_geometry::StereoCameraModel> stereoModel(
+    const sensor_msgs::msg::CameraInfo & left, const sensor_msgs::msg::CameraInfo & right);
+
+  std::shared_ptr<const RectificationMaps> rectificationMaps(
+    const sensor_msgs::msg::CameraInfo & info);
+
+  /**
+   * Data of type T derived from a calibration, keyed by key (usually
+   * hashCameraInfo() combined with the other inputs of the data, see
+   * combineKeys()). If no node holds it, it is built by build(), which
+   * returns a std::shared_ptr<T>, outside of the lock, so that two nodes
+   * asking at once may both build it but then share the first one stored.
+   */
+  template<typename T, typename Build>
+  std::shared_ptr<const T> get(uint64_t key, Build && build)
+  {
+    std::shared_ptr<const void> data = find(typeid(T), key);
+    if (!data) {
+      data = store(typeid(T), key, std::shared_ptr<const T>(build()));
+    }
+    return std::static_pointer_cast<const T>(data);
+  }
+
+  static uint64_t hashCameraInfo(const sensor_msgs::msg::CameraInfo & info)
+  {
+    return RectificationMaps::hashCameraInfo(info);
+  }
+
+  static uint64_t combineKeys(uint64_t key, uint64_t other)
+  {
+    return key ^ (other + 0x9e3779b97f4a7c15ull + (key << 6) + (key >> 2));
+  }
+
+  Statistics statistics() const;
+
+private:
+  CameraCache();
+
+  std::shared_ptr<const void> find(std::type_index type, uint64_t key);
+
+  // Returns the entry already stored for type and key if there is one
+  std::shared_ptr<const void> store(
+    std::type_index type, uint64_t key, std::shared_ptr<const void> data);
+
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__CAMERA_CACHE_HPP_
@@ -0,0 +1,172 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__CHANGE_DETECTION_HPP_
+#define IMAGE_PROC__CHANGE_DETECTION_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <builtin_interfaces/msg/time.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Change detection of a node processing static scenes, e.g. of inspection
+ * cameras, so that frames which did not change are not processed again.
+ *
+ * Each frame is summarized by the sums of its bytes in a BLOCKS x BLOCKS grid,
+ * over every step-th row. A frame is unchanged if it has the size and
+ * encoding of the last frame that changed, the same other inputs (e.g. its
+ * calibration, see unchanged()), and block sums that differ from those of
+ * that frame by at most threshold per sampled byte on average. Comparing with
+ * the last changed frame rather than the previous one makes slow drifts show
+ * up eventually. Changes confined to the rows that are not sampled go
+ * unnoticed, so step trades accuracy for speed.
+ *
+ * With mode SKIP, unchanged frames are not processed nor published. With mode
+ * REPUBLISH, the node publishes its last output again, with the stamp of the
+ * unchanged frame (see LastOutput).
+ *
+ * A frame that changed becomes the reference as soon as unchanged() returns.
+ * A node that then drops it, or fails to publish and keep its output, calls
+ * reset(), so that the next frame is processed rather than found unchanged
+ * against a frame that has no output.
+ */
+class ChangeDetection
+{
+public:
+  enum class Mode { OFF, SKIP, REPUBLISH };
+
+  static constexpr int BLOCKS = 16;
+
+  // Declares the change_detection, change_threshold and change_detection_step
+  // parameters on node
+  explicit ChangeDetection(rclcpp::Node * node);
+
+  ChangeDetection(Mode mode, double threshold, int step);
+
+  Mode mode() const {return mode_;}
+  bool enabled() const {return mode_ != Mode::OFF;}
+
+  /**
+   * Whether the frames of images did not change since the last frame that
+   * did, with inputs a hash of the other inputs the output depends on. Always
+   * false if disabled. Call in the order the frames came in. Thread-safe.
+   */
+  bool unchanged(const sensor_msgs::msg::Image & image, uint64_t inputs = 0);
+  bool unchanged(
+    const std::vector<const sensor_msgs::msg::Image *> & images, uint64_t inputs = 0);
+
+  // Forget the last frame that changed, so the next frame is processed
+  void reset();
+
+  // Block sums of image, over every step-th row, starting at the first
+  static void blockSums(
+    const sensor_msgs::msg::Image & image, int step, std::vector<uint32_t> & sums);
+
+private:
+  struct Signature
+  {
+    std::vector<uint32_t> width;
+    std::vector<uint32_t> height;
+    std::vector<std::string> encoding;
+    uint64_t inputs = 0;
+    std::vector<uint32_t> sums;
+    // Bytes added up into sums
+    double samples = 0.0;
+  };
+
+  void sign(
+    const std::vector<const sensor_msgs::msg::Image *> & images, uint64_t inputs,
+    Signature & signature) const;
+
+  Mode mode_;
+  double threshold_;
+  int step_;
+
+  std::mutex mutex_;
+  bool has_reference_;
+  Signature reference_;
+};
+
+/**
+ * Last output of a node on one of its publishers, kept to be published again
+ * for unchanged frames. Thread-safe.
+ */
+template<typename Msg>
+class LastOutput
+{
+public:
+  void keep(std::shared_ptr<const Msg> msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    msg_ = std::move(msg);
+  }
+
+  void clear()
+  {
+    keep(nullptr);
+  }
+
+  // Copy of the kept message stamped stamp, null if there is none
+  std::unique_ptr<Msg> restamped(const builtin_interfaces::msg::Time & stamp) const
+  {
+    std::shared_ptr<const Msg> msg;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      msg = msg_;
+    }
+    if (!msg) {
+      return nullptr;
+    }
+    auto copy = std::make_unique<Msg>(*msg);
+    copy->header.stamp = stamp;
+    return copy;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::shared_ptr<const Msg> msg_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__CHANGE_DETECTION_HPP_
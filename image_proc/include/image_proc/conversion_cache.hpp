@@ -0,0 +1,95 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__CONVERSION_CACHE_HPP_
+#define IMAGE_PROC__CONVERSION_CACHE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <cv_bridge/cv_bridge.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Process-wide cache of the conversions of images to other encodings, so that
+ * the nodes of a process that take the same message and need it in the same
+ * encoding convert it once, not once per node.
+ *
+ * Entries are keyed by the identity of the message, which the subscriptions
+ * of a process share through intra-process communication, and the target
+ * encoding. They only hold a weak reference to the message and last as long
+ * as it: an entry whose message was freed is dropped at the next conversion
+ * stored. Everything handed out is const and must not be modified.
+ * Thread-safe.
+ */
+class ConversionCache
+{
+public:
+  struct Statistics
+  {
+    // Conversions served from / not served from the cache
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Entries whose message is still alive
+    size_t entries = 0;
+  };
+
+  static ConversionCache & instance();
+
+  /**
+   * msg in encoding, as cv_bridge::toCvShare(msg, encoding) returns it. An
+   * empty encoding or the encoding of msg shares the data of msg and is not
+   * cached. Otherwise the image is converted by the first node asking for it,
+   * outside of the lock, so that two nodes asking at once may both convert it
+   * but then share the first one stored. Throws cv_bridge::Exception if the
+   * conversion is not possible.
+   */
+  cv_bridge::CvImageConstPtr toCvShare(
+    const sensor_msgs::msg::Image::ConstSharedPtr & msg,
+    const std::string & encoding = std::string());
+
+  Statistics statistics() const;
+
+private:
+  ConversionCache();
+
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__CONVERSION_CACHE_HPP_
@@ -33,10 +33,14 @@
 #ifndef IMAGE_PROC__CROP_DECIMATE_HPP_
 #define IMAGE_PROC__CROP_DECIMATE_HPP_
 
+#include <memory>
 #include <string>
 
 #include "cv_bridge/cv_bridge.hpp"
 
+#include <image_proc/backend.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
@@ -71,10 +75,17 @@ private:
   int decimation_x_, decimation_y_, offset_x_, offset_y_, width_, height_;
   std::string image_topic_;
   CropDecimateModes interpolation_;
+  Backend backend_;
+  bool use_buffer_pool_;
+  // CV_8U or CV_16U, the depth packed 10-bit and 12-bit images are unpacked to
+  int unpack_depth_;
 
   void imageCb(
     const sensor_msgs::msg::Image::ConstSharedPtr image_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr info_msg);
+
+  std::unique_ptr<LatestOnly> latest_only_;
+  std::unique_ptr<ProcessingDiagnostics> processing_;
 };
 
 }  // namespace image_proc
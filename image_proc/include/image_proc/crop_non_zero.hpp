@@ -33,10 +33,15 @@
 #ifndef IMAGE_PROC__CROP_NON_ZERO_HPP_
 #define IMAGE_PROC__CROP_NON_ZERO_HPP_
 
+#include <memory>
 #include <mutex>
 #include <string>
 
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
+#include <opencv2/core/core.hpp>
+
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/image.hpp>
 
@@ -51,6 +56,9 @@ public:
 private:
   std::string image_topic_;
 
+  // Crop to the bounding box of all non zero pixels instead of the largest contour
+  bool use_projection_;
+
   // Subscriptions
   image_transport::Subscriber sub_raw_;
 
@@ -60,6 +68,16 @@ private:
   image_transport::Publisher pub_;
 
   void imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg);
+
+  // Both return whether a cropped image was published
+  bool cropContour(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg);
+
+  bool cropProjection(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg);
+
+  void publishCrop(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg, const cv::Mat & crop);
+
+  std::unique_ptr<LatestOnly> latest_only_;
+  std::unique_ptr<ProcessingDiagnostics> processing_;
 };
 }  // namespace image_proc
 #endif  // IMAGE_PROC__CROP_NON_ZERO_HPP_
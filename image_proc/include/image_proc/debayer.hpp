@@ -33,7 +33,13 @@
 #ifndef IMAGE_PROC__DEBAYER_HPP_
 #define IMAGE_PROC__DEBAYER_HPP_
 
+#include <memory>
 #include <string>
+#include <image_proc/backend.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/thread_placement.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/image.hpp>
@@ -51,6 +57,10 @@ private:
   image_transport::Subscriber sub_raw_;
 
   int debayer_;
+  Backend backend_;
+  bool use_buffer_pool_;
+  // CV_8U or CV_16U, the depth packed 10-bit and 12-bit images are unpacked to
+  int unpack_depth_;
   std::string image_topic_;
 
   int debayer_bilinear_ = 0;
@@ -63,6 +73,17 @@ private:
 
   void connectCb();
   void imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg);
+  void debayerImage(
+    const sensor_msgs::msg::Image::ConstSharedPtr & msg, OrderedOutput::Ticket & ticket);
+
+  std::unique_ptr<LatestOnly> latest_only_;
+  std::unique_ptr<ProcessingDiagnostics> processing_;
+  std::unique_ptr<ThreadPlacement> placement_;
+
+  // Frames processed at once if concurrency > 1, with image_mono as output 0
+  // and image_color as output 1. Destroyed first, so no frame is left using
+  // the rest of the node
+  std::unique_ptr<OrderedOutput> ordered_;
 };
 
 }  // namespace image_proc
@@ -0,0 +1,61 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__DECIMATE_HPP_
+#define IMAGE_PROC__DECIMATE_HPP_
+
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+// Decimation kernels of CropDecimateNode.
+
+namespace image_proc
+{
+
+// Nearest neighbor decimation, keeping the top-left pixel of every
+// decimation_x by decimation_y block. Returns false if the pixel size of src
+// is not 1, 2, 3, 4, 6, 8, 12 or 16 bytes.
+bool decimate(const cv::Mat & src, cv::Mat & dst, int decimation_x, int decimation_y);
+
+// Decimate and debayer an 8-bit or 16-bit Bayer image to BGR in one pass,
+// with even decimation factors. Each output pixel comes from the 2x2 cells of
+// its block: the top-left cell only, or with bin all cells averaged. Returns
+// false if encoding is not a Bayer encoding.
+bool decimateBayer(
+  const cv::Mat & bayer, const std::string & encoding, cv::Mat & bgr,
+  int decimation_x, int decimation_y, bool bin);
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__DECIMATE_HPP_
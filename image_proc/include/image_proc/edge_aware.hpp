@@ -36,12 +36,29 @@
 #include <opencv2/core/core.hpp>
 
 // Edge-aware debayering algorithms, intended for eventual inclusion in OpenCV.
+//
+// Both accept 8-bit or 16-bit single channel Bayer images of at least 2x2
+// pixels and write a BGR image of the same depth. Rows are processed in
+// parallel using the OpenCV thread pool.
 
 namespace image_proc
 {
 
-void debayerEdgeAware(const cv::Mat & bayer, cv::Mat & color);
-void debayerEdgeAwareWeighted(const cv::Mat & bayer, cv::Mat & color);
+// Layout of the top-left 2x2 block of the Bayer mosaic
+enum class BayerPattern
+{
+  RGGB,
+  BGGR,
+  GBRG,
+  GRBG
+};
+
+void debayerEdgeAware(
+  const cv::Mat & bayer, cv::Mat & color,
+  BayerPattern pattern = BayerPattern::GRBG);
+void debayerEdgeAwareWeighted(
+  const cv::Mat & bayer, cv::Mat & color,
+  BayerPattern pattern = BayerPattern::GRBG);
 
 }  // namespace image_proc
 
@@ -0,0 +1,113 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__FRAME_SCHEDULER_HPP_
+#define IMAGE_PROC__FRAME_SCHEDULER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace image_proc
+{
+
+/**
+ * Runs the frames of several streams, e.g. the cameras of a robot, on one
+ * bounded pool of worker threads.
+ *
+ * A stream holds at most queue_depth pending frames, a new frame displacing
+ * its oldest pending one, and runs at most one frame at a time, so its frames
+ * are processed in order. A free worker takes the pending frame due first,
+ * by arrival plus the deadline of the scheduler, across all streams: a busy
+ * stream cannot starve the others, and streams of the same rate take turns.
+ * A frame still pending at its deadline is dropped rather than processed
+ * late.
+ */
+class FrameScheduler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Called with true to process the frame, or with false if it was dropped
+  using Work = std::function<void (bool process)>;
+
+  // A zero deadline never drops pending frames
+  FrameScheduler(
+    size_t streams, size_t threads, size_t queue_depth, Clock::duration deadline);
+
+  // Discards the pending frames and waits for the running ones
+  ~FrameScheduler();
+
+  /**
+   * Queue work as the next frame of stream. Returns false if it displaced the
+   * oldest pending frame of the stream, which is then called as dropped.
+   */
+  bool submit(size_t stream, Work work);
+
+  size_t threads() const {return workers_.size();}
+
+private:
+  struct Frame
+  {
+    Clock::time_point due;
+    Work work;
+  };
+
+  struct Stream
+  {
+    std::deque<Frame> pending;
+    bool running = false;
+  };
+
+  void run();
+  // Stream whose next frame is due first among those not running, or
+  // streams_.size() if there is none. Called with mutex_ held
+  size_t next() const;
+
+  const size_t queue_depth_;
+  const Clock::duration deadline_;
+
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool stopping_ = false;
+  std::vector<Stream> streams_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__FRAME_SCHEDULER_HPP_
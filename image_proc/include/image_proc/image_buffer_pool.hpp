@@ -0,0 +1,91 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__IMAGE_BUFFER_POOL_HPP_
+#define IMAGE_PROC__IMAGE_BUFFER_POOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Process-wide pool of image messages, bucketed by buffer size.
+ *
+ * Messages handed out by acquire() go back to the pool once the last
+ * reference to them is released, so nodes publishing at a fixed resolution
+ * stop allocating (and page faulting) a new buffer for every frame.
+ * Thread-safe.
+ */
+class ImageBufferPool
+{
+public:
+  struct Statistics
+  {
+    // Requests served from / not served from the pool
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // Buffers handed back, and those freed instead because the pool was full
+    uint64_t returns = 0;
+    uint64_t evictions = 0;
+    // Bytes currently held by idle buffers
+    size_t pooled_bytes = 0;
+  };
+
+  static ImageBufferPool & instance();
+
+  /**
+   * Borrow a message with data resized to size bytes. All other fields are
+   * left for the caller to fill in.
+   */
+  sensor_msgs::msg::Image::SharedPtr acquire(size_t size);
+
+  Statistics statistics() const;
+
+  // Upper bound on the memory kept by idle buffers. Defaults to 256 MiB.
+  void setMaxPooledBytes(size_t bytes);
+  size_t maxPooledBytes() const;
+
+private:
+  ImageBufferPool();
+
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__IMAGE_BUFFER_POOL_HPP_
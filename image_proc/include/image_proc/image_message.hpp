@@ -0,0 +1,108 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__IMAGE_MESSAGE_HPP_
+#define IMAGE_PROC__IMAGE_MESSAGE_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include <image_transport/camera_publisher.hpp>
+#include <image_transport/publisher.hpp>
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Allocate an output image message with its data already sized for a
+ * rows x cols image of the given OpenCV type, and point view at that data.
+ *
+ * OpenCV functions given view as their destination render straight into the
+ * message, which can then be published as a unique_ptr without a further
+ * copy. Call finishImageMessage() afterwards in case the function
+ * reallocated view anyway.
+ */
+sensor_msgs::msg::Image::UniquePtr createImageMessage(
+  const std_msgs::msg::Header & header, const std::string & encoding,
+  int rows, int cols, int type, cv::Mat & view);
+
+/**
+ * Make sure msg holds the pixels of view, copying and resizing only if view was
+ * reallocated after createImageMessage(). The height of a message whose data
+ * is still exactly view is left as is, as planar encodings set it.
+ */
+void finishImageMessage(const cv::Mat & view, sensor_msgs::msg::Image & msg);
+
+/**
+ * An output image being rendered in place, either in a uniquely owned message
+ * (best for intra-process subscribers) or in one borrowed from the
+ * ImageBufferPool (no per-frame allocation).
+ */
+class OutputImage
+{
+public:
+  OutputImage(
+    bool pooled, const std_msgs::msg::Header & header, const std::string & encoding,
+    int rows, int cols, int type);
+
+  // Destination for OpenCV, backed by the message data
+  cv::Mat & mat() {return view_;}
+
+  std_msgs::msg::Header & header() {return msg().header;}
+
+  // Height of the image in pixels, for planar encodings such as NV12 whose
+  // mat() has more rows than that
+  void setHeight(uint32_t height) {msg().height = height;}
+
+  // Copy of the message as it would be published, e.g. to publish it again
+  sensor_msgs::msg::Image::SharedPtr copy();
+
+  // Both publish without copying the pixels and leave this object empty
+  void publish(const image_transport::Publisher & pub);
+  void publish(
+    const image_transport::CameraPublisher & pub,
+    sensor_msgs::msg::CameraInfo::UniquePtr info);
+
+private:
+  sensor_msgs::msg::Image & msg() {return unique_ ? *unique_ : *shared_;}
+
+  cv::Mat view_;
+  sensor_msgs::msg::Image::UniquePtr unique_;
+  sensor_msgs::msg::Image::SharedPtr shared_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__IMAGE_MESSAGE_HPP_
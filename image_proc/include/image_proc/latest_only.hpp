@@ -0,0 +1,98 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__LATEST_ONLY_HPP_
+#define IMAGE_PROC__LATEST_ONLY_HPP_
+
+#include <atomic>
+#include <cstdint>
+
+#include <builtin_interfaces/msg/time.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Backpressure policy of a node that cares about latency rather than
+ * completeness, e.g. in a closed control loop.
+ *
+ * With latest_only set, the subscriptions and synchronizers of the node keep
+ * only the newest message of every input, so a node that falls behind skips
+ * to the freshest set instead of working through a backlog, and stale()
+ * rejects inputs older than the newest one already taken. With max_input_age
+ * set, stale() also rejects inputs older than that.
+ *
+ * Nodes pass every input through admit() at the start of their callback,
+ * which counts the rejected ones as dropped frames. Nodes that hand frames to
+ * worker threads admit them before dispatching, so that they are taken in the
+ * order they came in rather than the order the workers get to them.
+ */
+class LatestOnly
+{
+public:
+  // Declares the latest_only and max_input_age parameters on node
+  explicit LatestOnly(rclcpp::Node * node);
+
+  bool enabled() const {return enabled_;}
+
+  // Depth of the subscriptions and synchronizers that would use queue_size
+  int queueSize(int queue_size) const {return enabled_ ? 1 : queue_size;}
+
+  // profile, keeping only the newest message if enabled
+  rmw_qos_profile_t qos(rmw_qos_profile_t profile) const;
+  rclcpp::QoS qos(rclcpp::QoS qos) const;
+
+  /**
+   * Whether the input stamped stamp should be dropped rather than processed.
+   * Inputs that are not dropped become the newest input taken. Thread-safe.
+   */
+  bool stale(const builtin_interfaces::msg::Time & stamp);
+
+  // Whether the input stamped stamp is to be processed, as !stale(stamp).
+  // Otherwise it is counted as dropped, on frame or on processing.
+  bool admit(const builtin_interfaces::msg::Time & stamp, ProcessingDiagnostics::Frame & frame);
+  bool admit(const builtin_interfaces::msg::Time & stamp, ProcessingDiagnostics & processing);
+
+private:
+  rclcpp::Clock::SharedPtr clock_;
+  bool enabled_;
+  // 0 if unlimited
+  rcl_duration_value_t max_age_;
+  std::atomic<rcl_time_point_value_t> newest_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__LATEST_ONLY_HPP_
@@ -0,0 +1,97 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__MAPPED_TABLES_HPP_
+#define IMAGE_PROC__MAPPED_TABLES_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Tables derived from a calibration (rectification maps, ray tables) saved in
+ * a cache directory and memory-mapped back read-only by later runs, so that
+ * nodes start without rebuilding them and the processes mapping the same
+ * file share its pages.
+ *
+ * The cache is off unless a directory is set, by setDirectory() or the
+ * IMAGE_PROC_TABLE_CACHE environment variable. Files are named after the
+ * kind of table and its key (usually CameraCache::hashCameraInfo()) and
+ * written to a temporary file renamed into place, so a reader never maps a
+ * partial file. Failing to read or write the cache only means building the
+ * tables. Thread-safe.
+ */
+class MappedTables
+{
+public:
+  ~MappedTables();
+
+  MappedTables(const MappedTables &) = delete;
+  MappedTables & operator=(const MappedTables &) = delete;
+
+  // Cache directory, empty if the cache is off
+  static std::string directory();
+  static void setDirectory(const std::string & directory);
+
+  /**
+   * Tables of kind stored under key, mapped from the cache, or nullptr if
+   * the cache is off or does not have them. They must not be modified.
+   */
+  static std::shared_ptr<const MappedTables> load(const std::string & kind, uint64_t key);
+
+  /**
+   * Store tables of kind under key in the cache, if it is on.
+   * @returns whether they were written
+   */
+  static bool store(const std::string & kind, uint64_t key, const std::vector<cv::Mat> & tables);
+
+  // Valid as long as this object lives
+  const std::vector<cv::Mat> & tables() const {return tables_;}
+
+private:
+  MappedTables(void * data, size_t size);
+
+  void * data_;
+  size_t size_;
+  std::vector<cv::Mat> tables_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__MAPPED_TABLES_HPP_
@@ -0,0 +1,106 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__MULTI_CAMERA_HPP_
+#define IMAGE_PROC__MULTI_CAMERA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <image_proc/frame_scheduler.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/processor.hpp>
+#include <image_transport/image_transport.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Debayers and rectifies the images of several cameras, as a DebayerNode and
+ * a RectifyNode per camera would, on one shared pool of threads.
+ */
+class MultiCameraNode
+  : public rclcpp::Node
+{
+public:
+  explicit MultiCameraNode(const rclcpp::NodeOptions &);
+
+private:
+  struct Camera
+  {
+    std::string image_topic;
+    image_transport::CameraSubscriber sub;
+    image_transport::Publisher pub_mono;
+    image_transport::Publisher pub_color;
+    image_transport::Publisher pub_rect;
+    image_transport::Publisher pub_rect_color;
+
+    // Used by one frame at a time, as the scheduler runs one per camera
+    Processor processor;
+    FrameArena arena;
+  };
+
+  bool use_buffer_pool_;
+
+  std::mutex connect_mutex_;
+  std::vector<std::unique_ptr<Camera>> cameras_;
+
+  void connectCb(size_t index);
+  void imageCb(
+    size_t index,
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg);
+  void processImage(
+    Camera & camera,
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg);
+  void publishImage(
+    const image_transport::Publisher & pub,
+    const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg,
+    const std::string & encoding, const cv::Mat & image);
+
+  std::unique_ptr<ProcessingDiagnostics> processing_;
+
+  // Frames of all cameras. Destroyed first, so no frame is left using the
+  // rest of the node
+  std::unique_ptr<FrameScheduler> scheduler_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__MULTI_CAMERA_HPP_
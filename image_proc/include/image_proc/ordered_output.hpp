@@ -0,0 +1,147 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__ORDERED_OUTPUT_HPP_
+#define IMAGE_PROC__ORDERED_OUTPUT_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Processes up to max_in_flight frames at once, each on a worker thread of
+ * its own, and keeps their outputs in the order the frames were received.
+ *
+ * Every frame gets a Ticket, numbered in sequence. Before publishing on one
+ * of the outputs of the node the work waits for its turn on that output, i.e.
+ * for every earlier frame to have published on it or to have given up on it.
+ * A Ticket gives up on every output it has not released when it is
+ * destroyed, so frames that return early never hold the later ones.
+ *
+ * The frames run on workers of their own, rather than in the callbacks of a
+ * reentrant callback group, because the synchronizers of camera
+ * subscriptions call back one set of messages at a time.
+ */
+class OrderedOutput
+{
+public:
+  class Ticket
+  {
+public:
+    // A ticket always in turn, for frames processed one at a time
+    Ticket() = default;
+    ~Ticket();
+
+    Ticket(Ticket && other);
+    Ticket & operator=(Ticket && other);
+    Ticket(const Ticket &) = delete;
+    Ticket & operator=(const Ticket &) = delete;
+
+    // Block until every earlier frame is done with output
+    void wait(size_t output = 0);
+
+    // Done with output: later frames may publish on it
+    void release(size_t output = 0);
+
+private:
+    friend class OrderedOutput;
+    Ticket(OrderedOutput * owner, uint64_t sequence);
+
+    OrderedOutput * owner_ = nullptr;
+    uint64_t sequence_ = 0;
+  };
+
+  using Work = std::function<void (Ticket &)>;
+
+  OrderedOutput(size_t outputs, size_t max_in_flight);
+
+  // Waits for the frames in flight
+  ~OrderedOutput();
+
+  /**
+   * Run work on a worker with the ticket of the next frame. Returns false,
+   * without running it, if max_in_flight frames are in flight already.
+   */
+  bool dispatch(Work work);
+
+  size_t maxInFlight() const {return workers_.size();}
+
+private:
+  struct Job
+  {
+    Ticket ticket;
+    Work work;
+  };
+
+  void run();
+  void wait(uint64_t sequence, size_t output);
+  void release(uint64_t sequence, size_t output);
+  void releaseAll(uint64_t sequence);
+  // Move the turn of output past every released frame. Called with mutex_ held
+  void advance(size_t output);
+
+  std::mutex mutex_;
+  std::condition_variable turn_;
+  std::condition_variable queued_;
+  bool stopping_ = false;
+  std::deque<Job> jobs_;
+  uint64_t next_sequence_ = 0;
+  // Frames in flight and the outputs each of them released
+  std::map<uint64_t, std::vector<bool>> in_flight_;
+  // First frame not done with every output
+  std::vector<uint64_t> turn_of_;
+  std::vector<std::thread> workers_;
+};
+
+/**
+ * Declare the "concurrency" parameter on node: the number of frames it may
+ * process at once. Returns the OrderedOutput for its outputs if above 1 (the
+ * default is 1), null otherwise.
+ */
+std::unique_ptr<OrderedOutput> declareConcurrencyParameter(rclcpp::Node * node, size_t outputs);
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__ORDERED_OUTPUT_HPP_
@@ -0,0 +1,96 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__PACKED_HPP_
+#define IMAGE_PROC__PACKED_HPP_
+
+#include <cstdint>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+// Packed 10-bit and 12-bit encodings, as sent by machine vision cameras in
+// the GenICam Mono10p, Mono12p, BayerRG12p, ... pixel formats. The samples of
+// a row follow each other with no padding, least significant bit first: 4
+// samples in 5 bytes at 10 bits, 2 samples in 3 bytes at 12 bits. They are
+// named after the sensor_msgs encoding of the same layout, with the bit depth
+// and a "p" suffix.
+
+namespace image_proc
+{
+
+namespace packed_encodings
+{
+const char MONO10P[] = "mono10p";
+const char MONO12P[] = "mono12p";
+const char BAYER_RGGB10P[] = "bayer_rggb10p";
+const char BAYER_BGGR10P[] = "bayer_bggr10p";
+const char BAYER_GBRG10P[] = "bayer_gbrg10p";
+const char BAYER_GRBG10P[] = "bayer_grbg10p";
+const char BAYER_RGGB12P[] = "bayer_rggb12p";
+const char BAYER_BGGR12P[] = "bayer_bggr12p";
+const char BAYER_GBRG12P[] = "bayer_gbrg12p";
+const char BAYER_GRBG12P[] = "bayer_grbg12p";
+}  // namespace packed_encodings
+
+// Bits per sample of a packed encoding, 0 if encoding is not packed
+int packedBitDepth(const std::string & encoding);
+
+// The sensor_msgs encoding a packed encoding unpacks to at depth, CV_8U
+// (mono8, bayer_rggb8, ...) or CV_16U (mono16, bayer_rggb16, ...)
+std::string unpackedEncoding(const std::string & encoding, int depth);
+
+// Unpack count samples of a packed row, starting at sample first. Samples
+// unpacked to 16 bits are scaled to the full range, samples unpacked to 8 bits
+// keep their 8 most significant bits.
+void unpackRow(const uint8_t * row, int bits, int first, int count, uint8_t * dst);
+void unpackRow(const uint8_t * row, int bits, int first, int count, uint16_t * dst);
+
+// Unpack the window of a packed image into dst, created CV_8UC1 or CV_16UC1
+// after depth. With pair_step > 0, only the first two rows of every pair_step
+// rows of the window are unpacked, which is all nearest neighbor decimation of
+// a Bayer image by pair_step reads. Returns false if the encoding of packed is
+// not packed or its data is too short.
+bool unpackImage(
+  const sensor_msgs::msg::Image & packed, const cv::Rect & window, int depth,
+  cv::Mat & dst, int pair_step = 0);
+
+// Unpack a whole packed image into a message of the unpacked encoding at depth,
+// borrowed from the ImageBufferPool if pooled. Returns null if the encoding of
+// packed is not packed or its data is too short.
+sensor_msgs::msg::Image::SharedPtr unpackImageMessage(
+  const sensor_msgs::msg::Image & packed, int depth, bool pooled);
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__PACKED_HPP_
@@ -0,0 +1,91 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__PARAMETER_SNAPSHOT_HPP_
+#define IMAGE_PROC__PARAMETER_SNAPSHOT_HPP_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace image_proc
+{
+
+/**
+ * Immutable copy of the parameters a node reads on its hot path, replaced as
+ * a whole by its parameter callbacks, so that callbacks read plain fields
+ * instead of calling get_parameter or sharing a lock with the parameter
+ * service.
+ *
+ * A snapshot taken with get() stays valid and unchanged for as long as it is
+ * held, and every frame sees one consistent set of values. Comparing it to
+ * the one a previous frame used tells whether anything changed, e.g. to
+ * reconfigure a matcher only then. Readers are thread-safe; writers must be
+ * serialized, as the parameter callbacks of a node are.
+ */
+template<typename Config>
+class ParameterSnapshot
+{
+public:
+  explicit ParameterSnapshot(Config config = Config())
+  : config_(std::make_shared<const Config>(std::move(config)))
+  {
+  }
+
+  std::shared_ptr<const Config> get() const
+  {
+    return std::atomic_load(&config_);
+  }
+
+  // Replaces the snapshot, frames already holding the previous one keep it
+  void set(Config config)
+  {
+    std::atomic_store(&config_, std::shared_ptr<const Config>(
+        std::make_shared<const Config>(std::move(config))));
+  }
+
+  // Replaces the snapshot by a copy of it changed by update(Config &)
+  template<typename Update>
+  void update(Update update)
+  {
+    Config config = *get();
+    update(config);
+    set(std::move(config));
+  }
+
+private:
+  std::shared_ptr<const Config> config_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__PARAMETER_SNAPSHOT_HPP_
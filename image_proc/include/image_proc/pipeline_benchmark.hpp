@@ -0,0 +1,128 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__PIPELINE_BENCHMARK_HPP_
+#define IMAGE_PROC__PIPELINE_BENCHMARK_HPP_
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <tracetools_image_pipeline/processing_statistics.hpp>
+
+namespace image_proc
+{
+
+// Replays synthetic camera frames into a processing pipeline at a sweep of
+// rates and measures the latency of the point clouds coming out of it, from
+// their header stamps, along with the statistics every stage publishes on
+// /diagnostics. Meant to be composed with the pipeline in one container.
+class PipelineBenchmarkNode : public rclcpp::Node
+{
+public:
+  explicit PipelineBenchmarkNode(const rclcpp::NodeOptions &);
+
+private:
+  using CameraInfo = sensor_msgs::msg::CameraInfo;
+  using DiagnosticArray = diagnostic_msgs::msg::DiagnosticArray;
+  using Image = sensor_msgs::msg::Image;
+  using PointCloud2 = sensor_msgs::msg::PointCloud2;
+
+  // Statistics of one stage over a step, summed from its Processing statuses
+  struct Stage
+  {
+    size_t published = 0;
+    size_t dropped = 0;
+    double latency_p50 = 0.0;  // Weighted by published frames, ms
+    double latency_p99 = 0.0;  // Largest reported, ms
+  };
+
+  void startStep();
+  void finishStep();
+  void publishFrame();
+  void stepTimerCb();
+
+  void pointsCb(const PointCloud2::ConstSharedPtr & msg);
+  void diagnosticsCb(const DiagnosticArray::ConstSharedPtr & msg);
+
+  // Frames replayed: a stereo pair of raw images, or depth and color images
+  bool stereo_;
+  Image first_image_, second_image_;
+  CameraInfo first_info_, second_info_;
+
+  // Parameters
+  std::vector<double> rates_;
+  std::chrono::duration<double> warmup_;
+  std::chrono::duration<double> step_duration_;
+  std::string label_;
+  double saturation_delivery_;
+  bool shutdown_when_done_;
+
+  rclcpp::Publisher<Image>::SharedPtr pub_first_image_, pub_second_image_;
+  rclcpp::Publisher<CameraInfo>::SharedPtr pub_first_info_, pub_second_info_;
+  rclcpp::Subscription<PointCloud2>::SharedPtr sub_points_;
+  rclcpp::Subscription<DiagnosticArray>::SharedPtr sub_diagnostics_;
+  rclcpp::TimerBase::SharedPtr frame_timer_;
+  rclcpp::TimerBase::SharedPtr step_timer_;
+  std::ofstream report_;
+
+  // Sweep state, on the step timer
+  size_t step_ = 0;
+  bool started_ = false;
+  std::chrono::steady_clock::time_point step_start_;
+  std::chrono::steady_clock::time_point measure_start_;
+  double baseline_p99_ = 0.0;
+  double saturation_rate_ = 0.0;
+
+  // Measurements of the step, from the callbacks. Clouds stamped before
+  // measure_stamp_ belong to the warm up.
+  std::mutex mutex_;
+  bool measuring_ = false;
+  rclcpp::Time measure_stamp_;
+  size_t sent_ = 0;
+  size_t received_ = 0;
+  tracetools_image_pipeline::DurationHistogram latency_;
+  std::map<std::string, Stage> stages_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__PIPELINE_BENCHMARK_HPP_
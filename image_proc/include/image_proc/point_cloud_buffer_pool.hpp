@@ -0,0 +1,99 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__POINT_CLOUD_BUFFER_POOL_HPP_
+#define IMAGE_PROC__POINT_CLOUD_BUFFER_POOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <image_proc/image_buffer_pool.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Process-wide pool of point cloud messages, shared by the point cloud nodes
+ * of depth_image_proc and stereo_image_proc.
+ *
+ * Like ImageBufferPool, messages go back to the pool once the last reference
+ * to them is released. Clouds are handed out best fit, from any idle buffer
+ * holding at least the requested size but not more than twice as much, so
+ * dense clouds whose point count varies from frame to frame are recycled as
+ * well. Thread-safe.
+ *
+ * Nodes describe the fields of the clouds they publish once, in a layout
+ * message kept as a member, and borrow every cloud through
+ * acquire(layout, height, width).
+ */
+class PointCloudBufferPool
+{
+public:
+  using Statistics = ImageBufferPool::Statistics;
+
+  static PointCloudBufferPool & instance();
+
+  /**
+   * Borrow a message with data resized to size bytes and whatever contents a
+   * previous user left in it. All other fields are left for the caller.
+   */
+  sensor_msgs::msg::PointCloud2::SharedPtr acquire(size_t size);
+
+  /**
+   * Borrow an organized height x width cloud with the fields, point_step and
+   * is_bigendian of layout, and row_step and data sized to match. The fields
+   * are only copied when a recycled message does not have them already.
+   * header and is_dense are left for the caller, and the previous points are
+   * not cleared, so every point has to be written.
+   */
+  sensor_msgs::msg::PointCloud2::SharedPtr acquire(
+    const sensor_msgs::msg::PointCloud2 & layout, uint32_t height, uint32_t width);
+
+  Statistics statistics() const;
+
+  // Upper bound on the memory kept by idle buffers. Defaults to 256 MiB.
+  void setMaxPooledBytes(size_t bytes);
+  size_t maxPooledBytes() const;
+
+private:
+  PointCloudBufferPool();
+
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__POINT_CLOUD_BUFFER_POOL_HPP_
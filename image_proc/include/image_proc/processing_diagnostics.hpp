@@ -0,0 +1,109 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__PROCESSING_DIAGNOSTICS_HPP_
+#define IMAGE_PROC__PROCESSING_DIAGNOSTICS_HPP_
+
+#include <chrono>
+#include <memory>
+
+#include <builtin_interfaces/msg/time.hpp>
+#include <diagnostic_updater/diagnostic_updater.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <tracetools_image_pipeline/processing_statistics.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Callback latency, input-to-publish age, dropped and skipped frames and
+ * achieved rate of a node, published on /diagnostics every period of its
+ * updater (diagnostic_updater.period, 1 s by default).
+ *
+ * Construct a Frame at the start of every callback and call published() on
+ * it once the output is out: the frame is recorded when the Frame goes out of
+ * scope, so the latency covers the whole callback and every output of it. A
+ * Frame destroyed without published() or dropped() counts as skipped.
+ * Recording is lock-free.
+ */
+class ProcessingDiagnostics
+{
+public:
+  class Frame
+  {
+public:
+    explicit Frame(ProcessingDiagnostics & diagnostics);
+    ~Frame();
+
+    Frame(const Frame &) = delete;
+    Frame & operator=(const Frame &) = delete;
+
+    // The output of the input stamped stamp was published
+    void published(const builtin_interfaces::msg::Time & stamp);
+
+    // The frame was dropped because the node is behind
+    void dropped();
+
+private:
+    enum class Outcome { PUBLISHED, DROPPED, SKIPPED };
+
+    ProcessingDiagnostics & diagnostics_;
+    std::chrono::steady_clock::time_point start_;
+    Outcome outcome_;
+    builtin_interfaces::msg::Time stamp_;
+  };
+
+  // Publishes through an updater of its own
+  explicit ProcessingDiagnostics(rclcpp::Node * node);
+
+  // Publishes through an updater of the node, which must be destroyed first
+  ProcessingDiagnostics(rclcpp::Node * node, diagnostic_updater::Updater & updater);
+
+  // For frames finished away from their callback, e.g. by a pipeline thread
+  void published(
+    std::chrono::steady_clock::time_point start, const builtin_interfaces::msg::Time & stamp);
+  void dropped();
+  void skipped();
+
+private:
+  void status(diagnostic_updater::DiagnosticStatusWrapper & status);
+
+  rclcpp::Clock::SharedPtr clock_;
+  tracetools_image_pipeline::ProcessingStatistics statistics_;
+  // Destroyed first, so status() is never called on a partly destroyed object
+  std::unique_ptr<diagnostic_updater::Updater> updater_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__PROCESSING_DIAGNOSTICS_HPP_
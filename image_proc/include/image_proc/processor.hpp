@@ -33,6 +33,7 @@
 #ifndef IMAGE_PROC__PROCESSOR_HPP_
 #define IMAGE_PROC__PROCESSOR_HPP_
 
+#include <memory>
 #include <string>
 
 #include "image_geometry/pinhole_camera_model.hpp"
@@ -52,16 +53,44 @@ struct ImageSet
   cv::Mat rect_color;
 };
 
+/**
+ * Buffers of the images Processor::process computes, kept from frame to frame.
+ *
+ * Given an arena, process() writes into its buffers and points the output at
+ * them, so that once the size and encoding of a stream settled, processing a
+ * frame allocates nothing, whatever ImageSet it is handed. The output only
+ * borrows the buffers: the next frame processed with the same arena
+ * overwrites them, so clone the images to keep them longer. An arena is used
+ * by one thread at a time.
+ */
+struct FrameArena
+{
+  cv::Mat mono;
+  cv::Mat rect;
+  cv::Mat color;
+  cv::Mat rect_color;
+};
+
 class Processor
 {
 public:
-  Processor()
-  : interpolation_(cv::INTER_LINEAR)
-  {
-  }
+  Processor();
 
   int interpolation_;
 
+  // When only RECT_COLOR is requested from a Bayer image, sample the mosaic
+  // directly through the rectification map instead of writing and reading
+  // back a full-resolution color image. Only used for 8-bit mosaics with
+  // nearest or linear interpolation and unbinned, full-frame calibrations,
+  // the others go through cv::cvtColor and the remap as without it.
+  bool fused_debayer_rectify_;
+
+  // When both RECT and RECT_COLOR are requested, rectify only the color
+  // image and take RECT from the luma of RECT_COLOR, instead of converting
+  // the color image to mono and rectifying both. The fused debayer path
+  // then produces both from the mosaic.
+  bool rect_from_rect_color_;
+
   enum
   {
     MONO       = 1 << 0,
@@ -75,6 +104,22 @@ public:
     const sensor_msgs::msg::Image::ConstSharedPtr & raw_image,
     const image_geometry::PinholeCameraModel & model,
     ImageSet & output, int flags = ALL) const;
+
+  // Same, computing the images into the buffers of arena, which output points to
+  bool process(
+    const sensor_msgs::msg::Image::ConstSharedPtr & raw_image,
+    const image_geometry::PinholeCameraModel & model,
+    ImageSet & output, FrameArena & arena, int flags = ALL) const;
+
+private:
+  struct RectifyMapCache;
+
+  bool processFused(
+    const cv::Mat & raw, const std::string & raw_encoding,
+    const image_geometry::PinholeCameraModel & model, cv::Mat & rect_color) const;
+
+  // Shared between copies, guarded internally
+  std::shared_ptr<RectifyMapCache> rectify_map_cache_;
 };
 
 }  // namespace image_proc
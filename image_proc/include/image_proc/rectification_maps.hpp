@@ -0,0 +1,115 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__RECTIFICATION_MAPS_HPP_
+#define IMAGE_PROC__RECTIFICATION_MAPS_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <image_proc/mapped_tables.hpp>
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Fixed-point (CV_16SC2) undistortion and rectification maps for one camera.
+ *
+ * The maps are keyed on a hash of the calibration (K, D, R, P, binning, ROI
+ * and resolution) and are only rebuilt when it changes, so steady-state
+ * frames cost a single remap. With the MappedTables cache on, maps built
+ * once are memory-mapped by later runs instead of being built again.
+ */
+class RectificationMaps
+{
+public:
+  /**
+   * Make sure the maps match the given calibration.
+   * @returns true if the maps had to be rebuilt
+   */
+  bool update(const sensor_msgs::msg::CameraInfo & info);
+
+  /**
+   * Rectify src into dst using the current maps. The remap is split into row
+   * tiles processed in parallel. src must not alias dst.
+   */
+  void remap(const cv::Mat & src, cv::Mat & dst, int interpolation) const;
+
+  /**
+   * Rectify only the pixels of dst in window, dst already having the size of
+   * the maps. The rest of dst is left as is.
+   */
+  void remap(
+    const cv::Mat & src, cv::Mat & dst, int interpolation, const cv::Rect & window) const;
+
+  /**
+   * Rectify on the OpenCL device. The maps are uploaded once per rebuild.
+   * Safe to call from several threads, as for maps shared by CameraCache.
+   */
+  void remap(const cv::UMat & src, cv::UMat & dst, int interpolation) const;
+
+  bool initialized() const {return !map1_.empty();}
+
+  // Size of the (binned, cropped) images the maps apply to
+  cv::Size size() const {return map1_.size();}
+
+  // CV_16SC2 integer source positions and CV_16UC1 subpixel fractions, as
+  // cv::remap takes them, for remaps of their own such as depth
+  const cv::Mat & map1() const {return map1_;}
+  const cv::Mat & map2() const {return map2_;}
+
+  uint64_t rebuildCount() const {return rebuild_count_;}
+  uint64_t hitCount() const {return hit_count_;}
+
+  static uint64_t hashCameraInfo(const sensor_msgs::msg::CameraInfo & info);
+
+private:
+  void build(const sensor_msgs::msg::CameraInfo & info);
+
+  uint64_t hash_ = 0;
+  uint64_t rebuild_count_ = 0;
+  uint64_t hit_count_ = 0;
+  cv::Mat map1_;
+  cv::Mat map2_;
+  // Holds the file map1_ and map2_ point into, if they were loaded
+  std::shared_ptr<const MappedTables> mapped_;
+  mutable std::mutex device_mutex_;
+  mutable cv::UMat device_map1_;
+  mutable cv::UMat device_map2_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__RECTIFICATION_MAPS_HPP_
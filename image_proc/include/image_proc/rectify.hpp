@@ -33,11 +33,18 @@
 #ifndef IMAGE_PROC__RECTIFY_HPP_
 #define IMAGE_PROC__RECTIFY_HPP_
 
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
 
-#include "image_geometry/pinhole_camera_model.hpp"
-
+#include <image_proc/backend.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/rectification_maps.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
@@ -52,20 +59,50 @@ class RectifyNode
 public:
   explicit RectifyNode(const rclcpp::NodeOptions &);
 
+  // Number of times the rectification maps changed and were reused
+  uint64_t mapRebuildCount() const;
+  uint64_t mapHitCount() const;
+
 private:
   image_transport::CameraSubscriber sub_camera_;
 
   int queue_size_;
   int interpolation_;
+  Backend backend_;
+  bool use_buffer_pool_;
   std::string image_topic_;
   image_transport::Publisher pub_rect_;
 
-  // Processing state (note: only safe because we're using single-threaded NodeHandle!)
-  image_geometry::PinholeCameraModel model_;
+  // Processing state, guarded by maps_mutex_ as frames may be processed at once.
+  // Maps of the current calibration, shared through CameraCache with the
+  // other nodes of the process rectifying the same camera
+  mutable std::mutex maps_mutex_;
+  std::shared_ptr<const RectificationMaps> maps_;
+  uint64_t map_rebuilds_ = 0;
+  uint64_t map_hits_ = 0;
 
   void imageCb(
     const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg);
+
+  // Returns whether the rectified image was published and kept
+  bool rectifyImage(
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg,
+    OrderedOutput::Ticket & ticket);
+
+  // Publish the last rectified image again, for an unchanged frame
+  void republish(const builtin_interfaces::msg::Time & stamp, OrderedOutput::Ticket & ticket);
+
+  std::unique_ptr<RegionOfInterest> roi_;
+  std::unique_ptr<ChangeDetection> change_;
+  LastOutput<sensor_msgs::msg::Image> last_rect_;
+  std::unique_ptr<LatestOnly> latest_only_;
+  std::unique_ptr<ProcessingDiagnostics> processing_;
+
+  // Frames processed at once if concurrency > 1. Destroyed first, so no frame
+  // is left using the rest of the node
+  std::unique_ptr<OrderedOutput> ordered_;
 };
 
 }  // namespace image_proc
@@ -0,0 +1,109 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#ifndef IMAGE_PROC__REGION_OF_INTEREST_HPP_
+#define IMAGE_PROC__REGION_OF_INTEREST_HPP_
+
+#include <vector>
+
+#include <image_proc/parameter_snapshot.hpp>
+#include <opencv2/core/core.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Sub-window of the images a node restricts its work to, so that consumers
+ * looking at a small part of the image only pay for that part.
+ *
+ * Declares the roi.x_offset, roi.y_offset, roi.width and roi.height
+ * parameters, in pixels of the images the node receives. They can be changed
+ * at runtime, e.g. by the consumer of the node. A zero width or height means
+ * the whole image.
+ */
+class RegionOfInterest
+{
+public:
+  explicit RegionOfInterest(rclcpp::Node * node);
+
+  bool enabled() const;
+
+  // The requested window clipped to an image of size, the whole image if disabled
+  cv::Rect window(const cv::Size & size) const;
+
+  /**
+   * Replaces image and info by the requested window of image and its
+   * calibration, unless the window is the whole image. Returns the window,
+   * in pixels of the original image, which is empty if it lies outside of it.
+   */
+  cv::Rect crop(
+    sensor_msgs::msg::Image::ConstSharedPtr & image,
+    sensor_msgs::msg::CameraInfo::ConstSharedPtr & info) const;
+
+  /**
+   * Same for an image and a second image of the same view, possibly of another
+   * resolution, that info calibrates, e.g. depth and color. The second image
+   * and info are cropped to the same part of the view as the first image.
+   */
+  cv::Rect crop(
+    sensor_msgs::msg::Image::ConstSharedPtr & image,
+    sensor_msgs::msg::Image::ConstSharedPtr & second_image,
+    sensor_msgs::msg::CameraInfo::ConstSharedPtr & info) const;
+
+private:
+  rcl_interfaces::msg::SetParametersResult parameterSetCb(
+    const std::vector<rclcpp::Parameter> & parameters);
+
+  ParameterSnapshot<cv::Rect> requested_;
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_handle_;
+};
+
+// The pixels of image in window, which must lie inside it, as an image of their own
+sensor_msgs::msg::Image::SharedPtr cropImage(
+  const sensor_msgs::msg::Image & image, const cv::Rect & window);
+
+// The same part as window of an image of size from, in an image of size to
+cv::Rect scaleWindow(const cv::Rect & window, const cv::Size & from, const cv::Size & to);
+
+// Calibration of the same window of the images of info: the principal points
+// of K and P are moved by its offset, and the resolution is that of the window
+sensor_msgs::msg::CameraInfo::SharedPtr cropCameraInfo(
+  const sensor_msgs::msg::CameraInfo & info, const cv::Rect & window);
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__REGION_OF_INTEREST_HPP_
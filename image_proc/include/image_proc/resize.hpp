@@ -33,9 +33,17 @@
 #ifndef IMAGE_PROC__RESIZE_HPP_
 #define IMAGE_PROC__RESIZE_HPP_
 
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
+#include <image_proc/backend.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/ordered_output.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
@@ -53,8 +61,11 @@ public:
 protected:
   image_transport::CameraPublisher pub_image_;
   image_transport::CameraSubscriber sub_image_;
+  std::vector<image_transport::CameraPublisher> pyramid_pubs_;
 
   int interpolation_;
+  Backend backend_;
+  bool use_buffer_pool_;
   bool use_scale_;
   double scale_height_;
   double scale_width_;
@@ -62,15 +73,53 @@ protected:
   int width_;
   std::string image_topic_;
 
-  cv_bridge::CvImage scaled_cv_;
-
   std::mutex connect_mutex_;
 
   void connectCb();
 
+  bool hasSubscribers() const;
+
   void imageCb(
     sensor_msgs::msg::Image::ConstSharedPtr image_msg,
     sensor_msgs::msg::CameraInfo::ConstSharedPtr info_msg);
+
+  // Returns false if the image could not be resized, nothing being kept for it
+  bool resizeImage(
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg,
+    OrderedOutput::Ticket & ticket);
+
+  void publishPyramid(
+    const cv::Mat & image,
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+    const sensor_msgs::msg::CameraInfo & info_msg,
+    OrderedOutput::Ticket & ticket);
+
+  void publishPyramidLevel(
+    OutputImage & level_image, size_t level, const cv::Size & level_size,
+    const cv::Size & image_size, const sensor_msgs::msg::CameraInfo & info_msg,
+    OrderedOutput::Ticket & ticket);
+
+  // Publish the last outputs again, for an unchanged frame
+  void republish(const builtin_interfaces::msg::Time & stamp, OrderedOutput::Ticket & ticket);
+
+  std::unique_ptr<LatestOnly> latest_only_;
+  std::unique_ptr<ChangeDetection> change_;
+
+  // Last outputs of resize/image_raw and of every pyramid level
+  struct KeptOutput
+  {
+    LastOutput<sensor_msgs::msg::Image> image;
+    LastOutput<sensor_msgs::msg::CameraInfo> info;
+  };
+  KeptOutput last_scaled_;
+  std::vector<KeptOutput> last_levels_;
+  std::unique_ptr<ProcessingDiagnostics> processing_;
+
+  // Frames processed at once if concurrency > 1, with the pyramid levels as
+  // output 0 and resize/image_raw as output 1. Destroyed first, so no frame is
+  // left using the rest of the node
+  std::unique_ptr<OrderedOutput> ordered_;
 };
 
 }  // namespace image_proc
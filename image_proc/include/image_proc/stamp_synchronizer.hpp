@@ -0,0 +1,223 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__STAMP_SYNCHRONIZER_HPP_
+#define IMAGE_PROC__STAMP_SYNCHRONIZER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <builtin_interfaces/msg/time.hpp>
+#include <diagnostic_updater/diagnostic_updater.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Bookkeeping of StampSynchronizer, independent of the message types: the
+ * slot of every incomplete set, found by stamp in O(1), which inputs it has,
+ * and the match statistics.
+ */
+class StampSynchronizerBase
+{
+public:
+  struct Statistics
+  {
+    // Complete sets emitted
+    uint64_t matched = 0;
+    // Incomplete sets dropped to make room, or messages older than all of them
+    uint64_t missed = 0;
+    // Messages replacing one of the same input and stamp
+    uint64_t duplicates = 0;
+    // Incomplete sets waiting
+    size_t pending = 0;
+  };
+
+  virtual ~StampSynchronizerBase();
+
+  // Since construction
+  Statistics statistics() const;
+
+  // Publishes the statistics of every period on /diagnostics, as a task of the
+  // updater of the node, which must be destroyed first
+  void publishDiagnostics(diagnostic_updater::Updater & updater);
+
+protected:
+  static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
+  StampSynchronizerBase(size_t queue_size, size_t inputs);
+
+  size_t slots() const {return keys_.size();}
+
+  /**
+   * Slot of the set stamped stamp, taking a free one for a new stamp. When
+   * all are taken, the set with the oldest stamp is a miss and its slot is
+   * reused, reset is then set. Returns NO_SLOT for a new stamp older than all
+   * sets waiting, also a miss. Must be called with mutex_ held.
+   */
+  size_t insert(const builtin_interfaces::msg::Time & stamp, size_t input, bool & reset);
+
+  // Whether the set in slot has every input, in which case the slot is freed
+  bool complete(size_t slot);
+
+  mutable std::mutex mutex_;
+
+private:
+  void status(diagnostic_updater::DiagnosticStatusWrapper & status);
+
+  const uint32_t full_;
+  std::unordered_map<int64_t, size_t> index_;
+  // Stamp in nanoseconds and inputs present of every slot, 0 if free
+  std::vector<int64_t> keys_;
+  std::vector<uint32_t> inputs_;
+  std::vector<size_t> free_;
+  Statistics statistics_;
+  Statistics reported_;
+};
+
+/**
+ * Synchronizer for hardware-triggered inputs, whose messages of one capture
+ * carry the same stamp. ROS 2 headers have no sequence number, so the stamp
+ * is the key: every message lands in the set of its stamp through one hash
+ * lookup, and a set is emitted as soon as it has every input, without
+ * waiting for later candidates as the approximate policies do, or scanning
+ * queues as the exact one does.
+ *
+ * At most queue_size incomplete sets wait for their missing inputs. Inputs
+ * that never arrive surface as missed sets in statistics(). Thread-safe, the
+ * callback runs outside of the lock.
+ */
+template<typename ... Ms>
+class StampSynchronizer : public StampSynchronizerBase
+{
+  static_assert(sizeof...(Ms) >= 2 && sizeof...(Ms) <= 32, "Synchronizes 2 to 32 inputs");
+
+public:
+  template<size_t I>
+  using Message = typename std::tuple_element<I, std::tuple<Ms...>>::type;
+  using Callback = std::function<void (const std::shared_ptr<const Ms> & ...)>;
+
+  explicit StampSynchronizer(size_t queue_size)
+  : StampSynchronizerBase(queue_size, sizeof...(Ms)), sets_(slots())
+  {
+  }
+
+  ~StampSynchronizer() override
+  {
+    for (auto & disconnect : disconnects_) {
+      disconnect();
+    }
+  }
+
+  // Feeds the synchronizer from message_filters filters, one per input in the order of Ms
+  template<typename ... Fs>
+  void connectInput(Fs & ... filters)
+  {
+    static_assert(sizeof...(Fs) == sizeof...(Ms), "One filter per input");
+    connectInputs(std::index_sequence_for<Ms...>(), filters...);
+  }
+
+  void registerCallback(Callback callback)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+  }
+
+  template<size_t I>
+  void add(const std::shared_ptr<const Message<I>> & msg)
+  {
+    Set set;
+    Callback callback;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      bool reset = false;
+      const size_t slot = insert(msg->header.stamp, I, reset);
+      if (slot == NO_SLOT) {
+        return;
+      }
+      if (reset) {
+        sets_[slot] = Set();
+      }
+      std::get<I>(sets_[slot]) = msg;
+      if (!complete(slot)) {
+        return;
+      }
+      set = std::move(sets_[slot]);
+      sets_[slot] = Set();
+      callback = callback_;
+    }
+    if (callback) {
+      call(callback, set, std::index_sequence_for<Ms...>());
+    }
+  }
+
+private:
+  using Set = std::tuple<std::shared_ptr<const Ms>...>;
+
+  template<size_t ... Is, typename ... Fs>
+  void connectInputs(std::index_sequence<Is...>, Fs & ... filters)
+  {
+    int expand[] = {(connectOne<Is>(filters), 0)...};
+    (void) expand;
+  }
+
+  template<size_t I, typename F>
+  void connectOne(F & filter)
+  {
+    auto connection = filter.registerCallback(
+      std::function<void(const std::shared_ptr<const Message<I>> &)>(
+        [this](const std::shared_ptr<const Message<I>> & msg) {add<I>(msg);}));
+    disconnects_.push_back([connection]() mutable {connection.disconnect();});
+  }
+
+  template<size_t ... Is>
+  static void call(const Callback & callback, const Set & set, std::index_sequence<Is...>)
+  {
+    callback(std::get<Is>(set)...);
+  }
+
+  std::vector<Set> sets_;
+  Callback callback_;
+  std::vector<std::function<void()>> disconnects_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__STAMP_SYNCHRONIZER_HPP_
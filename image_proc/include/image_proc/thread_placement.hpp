@@ -0,0 +1,94 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IMAGE_PROC__THREAD_PLACEMENT_HPP_
+#define IMAGE_PROC__THREAD_PLACEMENT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+/**
+ * Placement of the threads processing the frames of a node, for latency that
+ * does not depend on where the scheduler moves them: a CPU set, a SCHED_FIFO
+ * priority and a NUMA node whose CPUs and memory they use.
+ *
+ * Only threads the node owns are placed, e.g. its concurrency workers or
+ * pipeline threads: they call placeCurrentThread() where they process frames,
+ * are placed the first time each runs one, and the actual placement of the
+ * thread is logged then. Executor threads are never placed, since they run the
+ * callbacks of every other node of the process too. The worker threads of
+ * cv::parallel_for_ are left to OpenCV. Only supported on Linux.
+ */
+class ThreadPlacement
+{
+public:
+  // Declares the cpu_affinity, realtime_priority and numa_node parameters on
+  // node and logs the placement requested. Without owned_threads, e.g. with a
+  // concurrency of 1, a requested placement is ignored with a warning.
+  ThreadPlacement(rclcpp::Node * node, bool owned_threads);
+
+  bool enabled() const {return !cpus_.empty() || priority_ > 0 || numa_node_ >= 0;}
+
+  // Place the calling thread, one the node owns, if it wasn't placed by this
+  // object yet. name identifies the thread in the log. Cheap once the thread
+  // is placed.
+  void placeCurrentThread(const char * name = "callback");
+
+  // CPUs of a list such as "0-3,8,10-11", as in /sys/devices/system/node
+  static std::vector<int> parseCpuList(const std::string & list);
+
+  // The list of cpus, as parseCpuList() reads it
+  static std::string formatCpuList(std::vector<int> cpus);
+
+private:
+  void place(const char * name);
+
+  rclcpp::Logger logger_;
+  uint64_t id_;
+  // CPUs the threads may run on, within numa_node_ if set. Empty for any
+  std::vector<int> cpus_;
+  // SCHED_FIFO priority, 0 to keep the policy of the thread
+  int priority_;
+  // -1 for no NUMA node
+  int numa_node_;
+};
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__THREAD_PLACEMENT_HPP_
@@ -33,11 +33,19 @@
 #ifndef IMAGE_PROC__TRACK_MARKER_HPP_
 #define IMAGE_PROC__TRACK_MARKER_HPP_
 
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
+#include <diagnostic_updater/diagnostic_updater.hpp>
+#include <geometry_msgs/msg/pose_array.hpp>
 #include <geometry_msgs/msg/pose_stamped.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
 #include <opencv2/aruco.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
@@ -61,12 +69,73 @@ private:
   std::string image_topic_;
   rclcpp::Publisher<geometry_msgs::msg::PoseStamped>::SharedPtr pub_;
 
+  // Multi-marker mode: poses of all of marker_ids_ from one detection
+  std::vector<int64_t> marker_ids_;
+  rclcpp::Publisher<geometry_msgs::msg::PoseArray>::SharedPtr pub_array_;
+
   cv::Ptr<cv::aruco::DetectorParameters> detector_params_;
   cv::Ptr<cv::aruco::Dictionary> dictionary_;
 
+  // Tracking mode: search around the predicted marker location first
+  bool tracking_;
+  double roi_margin_;
+  int lost_decimation_;
+
+  // Last estimated pose, and the one before it for velocity prediction
+  bool has_track_{false};
+  bool has_velocity_{false};
+  cv::Vec3d rvec_;
+  cv::Vec3d tvec_;
+  cv::Vec3d prev_tvec_;
+
   void imageCb(
     const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg);
+
+  // Publishes the poses of all of marker_ids_ found in image as one array
+  void trackAll(
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg, const cv::Mat & image,
+    const cv::Mat & intrinsics, const cv::Mat & dist_coeffs, ProcessingDiagnostics::Frame & frame);
+
+  // Appends the corners of every marker with marker_id_ found in roi of image.
+  // The image may be decimated by scale, corners are in full image coordinates.
+  bool detect(
+    const cv::Mat & image, const cv::Rect & roi, double scale,
+    std::vector<std::vector<cv::Point2f>> & corners) const;
+
+  // Marker corners in the marker frame, as used by estimatePoseSingleMarkers
+  std::vector<cv::Point3f> objectPoints() const;
+
+  // Region of the image the marker is expected in, empty if unknown
+  cv::Rect predictRoi(
+    const cv::Mat & intrinsics, const cv::Mat & dist_coeffs, const cv::Size & size) const;
+
+  // Expands the bounding box of points by roi_margin_ and clips it to the image
+  cv::Rect expandRoi(const std::vector<cv::Point2f> & points, const cv::Size & size) const;
+
+  // Detection time and success of each search mode since the last diagnostics report
+  struct SearchStatistics
+  {
+    size_t frames{0};
+    size_t found{0};
+    double milliseconds{0.0};
+    double max_milliseconds{0.0};
+  };
+
+  // Records a detection of the given search mode started at start
+  void recordSearch(
+    const std::string & search, std::chrono::steady_clock::time_point start, bool found);
+
+  void searchDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status);
+
+  std::mutex searches_mutex_;
+  std::map<std::string, SearchStatistics> searches_;
+
+  std::unique_ptr<LatestOnly> latest_only_;
+  std::unique_ptr<ProcessingDiagnostics> processing_;
+
+  // Reports the detection statistics, destroyed first so that it never reads them afterwards
+  std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
 };
 
 }  // namespace image_proc
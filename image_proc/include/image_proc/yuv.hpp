@@ -0,0 +1,90 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PROC__YUV_HPP_
+#define IMAGE_PROC__YUV_HPP_
+
+#include <string>
+
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+// YUV images of USB and CSI cameras, handled without going through cv_bridge:
+// the packed 4:2:2 encodings yuv422 (UYVY) and yuv422_yuy2 (YUYV), and the
+// semi-planar 4:2:0 NV12. An NV12 message is height rows of luma followed by
+// height / 2 rows of interleaved U and V, step bytes each.
+
+namespace image_proc
+{
+
+namespace yuv_encodings
+{
+const char NV12[] = "nv12";
+}  // namespace yuv_encodings
+
+// Whether encoding is one of the YUV encodings above
+bool isYuv(const std::string & encoding);
+
+// View of the pixels of a YUV image: CV_8UC2 with one column per pixel for the
+// 4:2:2 encodings, CV_8UC1 with the chroma rows below the luma ones for NV12.
+// Empty if the encoding is not YUV or the data is too short.
+cv::Mat yuvView(const sensor_msgs::msg::Image & image);
+
+// Rows of the view of a YUV image height pixels high
+int yuvRows(const std::string & encoding, int height);
+
+// The size of a YUV image in pixels, given its view
+cv::Size yuvSize(const std::string & encoding, const cv::Mat & view);
+
+// Round a size down to one a YUV encoding can hold: an even width, and for
+// NV12 an even height too
+cv::Size yuvAlignedSize(const std::string & encoding, const cv::Size & size);
+
+// Copy the luma of a YUV image into mono, created CV_8UC1. Returns false if
+// the encoding is not YUV or the data is too short.
+bool yuvToMono(const sensor_msgs::msg::Image & image, cv::Mat & mono);
+
+// Convert a YUV image into bgr, created CV_8UC3, with the vectorized OpenCV
+// kernels. Returns false if the encoding is not YUV or the data is too short.
+bool yuvToBgr(const sensor_msgs::msg::Image & image, cv::Mat & bgr);
+
+// Resize the view of a YUV image to size, which yuvAlignedSize() must have
+// rounded, into dst, a view of the same encoding. The luma and chroma planes
+// are resized on their own, so that the chroma samples are never mixed with
+// luma or with each other.
+void resizeYuv(
+  const cv::Mat & src, const std::string & encoding, const cv::Size & size,
+  int interpolation, cv::Mat & dst);
+
+}  // namespace image_proc
+
+#endif  // IMAGE_PROC__YUV_HPP_
@@ -47,18 +47,24 @@ def generate_launch_description():
         description=('namespace for all components loaded')
     )
 
+    # Pass messages between the components as pointers rather than through the
+    # middleware, see the Zero-Copy Intra-Process Communication tutorial
+    intra_process = [{'use_intra_process_comms': True}]
+
     composable_nodes = [
         ComposableNode(
             package='image_proc',
             plugin='image_proc::DebayerNode',
             name='debayer_node',
             namespace=LaunchConfiguration('namespace'),
+            extra_arguments=intra_process,
         ),
         ComposableNode(
             package='image_proc',
             plugin='image_proc::RectifyNode',
             name='rectify_mono_node',
             namespace=LaunchConfiguration('namespace'),
+            extra_arguments=intra_process,
             # Remap subscribers and publishers
             remappings=[
                 ('image', 'image_mono'),
@@ -70,6 +76,7 @@ def generate_launch_description():
             plugin='image_proc::RectifyNode',
             name='rectify_color_node',
             namespace=LaunchConfiguration('namespace'),
+            extra_arguments=intra_process,
             # Remap subscribers and publishers
             remappings=[
                 ('image', 'image_color'),
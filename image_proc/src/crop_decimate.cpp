@@ -36,6 +36,10 @@
 #include <string>
 
 #include <image_proc/crop_decimate.hpp>
+#include <image_proc/decimate.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/packed.hpp>
 #include <image_proc/utils.hpp>
 
 #include <opencv2/imgproc.hpp>
@@ -43,68 +47,11 @@
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
 #include <sensor_msgs/msg/image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace image_proc
 {
 
-template<typename T>
-void debayer2x2toBGR(
-  const cv::Mat & src, cv::Mat & dst,
-  int R, int G1, int G2, int B)
-{
-  typedef cv::Vec<T, 3> DstPixel;  // 8- or 16-bit BGR
-#if CV_VERSION_MAJOR >= 4 || (CV_MAJOR_VERSION == 3 && CV_MINOR_VERSION > 2)
-  dst.create(src.rows / 2, src.cols / 2, cv::traits::Type<DstPixel>::value);
-#else
-  dst.create(src.rows / 2, src.cols / 2, cv::DataType<DstPixel>::type);
-#endif
-
-  int src_row_step = src.step1();
-  int dst_row_step = dst.step1();
-  const T * src_row = src.ptr<T>();
-  T * dst_row = dst.ptr<T>();
-
-  // 2x2 downsample and debayer at once
-  for (int y = 0; y < dst.rows; ++y) {
-    for (int x = 0; x < dst.cols; ++x) {
-      dst_row[x * 3 + 0] = src_row[x * 2 + B];
-      dst_row[x * 3 + 1] = (src_row[x * 2 + G1] + src_row[x * 2 + G2]) / 2;
-      dst_row[x * 3 + 2] = src_row[x * 2 + R];
-    }
-
-    src_row += src_row_step * 2;
-    dst_row += dst_row_step;
-  }
-}
-
-// Templated on pixel size, in bytes (MONO8 = 1, BGR8 = 3, RGBA16 = 8, ...)
-template<int N>
-void decimate(const cv::Mat & src, cv::Mat & dst, int decimation_x, int decimation_y)
-{
-  dst.create(src.rows / decimation_y, src.cols / decimation_x, src.type());
-
-  int src_row_step = src.step[0] * decimation_y;
-  int src_pixel_step = N * decimation_x;
-  int dst_row_step = dst.step[0];
-
-  const uint8_t * src_row = src.ptr();
-  uint8_t * dst_row = dst.ptr();
-
-  for (int y = 0; y < dst.rows; ++y) {
-    const uint8_t * src_pixel = src_row;
-    uint8_t * dst_pixel = dst_row;
-
-    for (int x = 0; x < dst.cols; ++x) {
-      memcpy(dst_pixel, src_pixel, N);  // Should inline with small, fixed N
-      src_pixel += src_pixel_step;
-      dst_pixel += N;
-    }
-
-    src_row += src_row_step;
-    dst_row += dst_row_step;
-  }
-}
-
 CropDecimateNode::CropDecimateNode(const rclcpp::NodeOptions & options)
 : Node("CropNonZeroNode", options)
 {
@@ -133,6 +80,11 @@ CropDecimateNode::CropDecimateNode(const rclcpp::NodeOptions & options)
   // default: CropDecimate_NN
   int interpolation = this->declare_parameter("interpolation", 0);
   interpolation_ = static_cast<CropDecimateModes>(interpolation);
+  backend_ = declareBackendParameter(this);
+  use_buffer_pool_ = this->declare_parameter("use_buffer_pool", false);
+  unpack_depth_ = this->declare_parameter("unpack_bit_depth", 16) == 8 ? CV_8U : CV_16U;
+
+  latest_only_ = std::make_unique<LatestOnly>(this);
 
   // Setup lazy subscriber using publisher connection callback
   rclcpp::PublisherOptions pub_options;
@@ -143,7 +95,7 @@ CropDecimateNode::CropDecimateNode(const rclcpp::NodeOptions & options)
         sub_.shutdown();
       } else if (!sub_) {
         // Create subscriber with QoS matched to subscribed topic publisher
-        auto qos_profile = getTopicQosProfile(this, image_topic_);
+        auto qos_profile = latest_only_->qos(getTopicQosProfile(this, image_topic_));
         image_transport::TransportHints hints(this);
         sub_ = image_transport::create_camera_subscription(
           this, image_topic_, std::bind(
@@ -158,12 +110,23 @@ CropDecimateNode::CropDecimateNode(const rclcpp::NodeOptions & options)
   // Create publisher with QoS matched to subscribed topic publisher
   auto qos_profile = getTopicQosProfile(this, image_topic_);
   pub_ = image_transport::create_camera_publisher(this, pub_topic, qos_profile, pub_options);
+
+  processing_ = std::make_unique<ProcessingDiagnostics>(this);
 }
 
 void CropDecimateNode::imageCb(
   const sensor_msgs::msg::Image::ConstSharedPtr image_msg,
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr info_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/crop_decimate", image_msg.get(), image_msg->width, image_msg->height,
+    image_msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(image_msg->header.stamp, frame)) {
+    return;
+  }
+
   /// @todo Check image dimensions match info_msg
 
   if (pub_.getNumSubscribers() < 1) {
@@ -173,8 +136,14 @@ void CropDecimateNode::imageCb(
   int decimation_x = decimation_x_;
   int decimation_y = decimation_y_;
 
+  // Packed 10-bit and 12-bit images are unpacked to the matching 8-bit or
+  // 16-bit encoding along the way
+  const bool is_packed = packedBitDepth(image_msg->encoding) != 0;
+  const std::string encoding = is_packed ?
+    unpackedEncoding(image_msg->encoding, unpack_depth_) : image_msg->encoding;
+
   // Compute the ROI we'll actually use
-  bool is_bayer = sensor_msgs::image_encodings::isBayer(image_msg->encoding);
+  bool is_bayer = sensor_msgs::image_encodings::isBayer(encoding);
 
   if (is_bayer) {
     // Odd offsets for Bayer images basically change the Bayer pattern, but that's
@@ -224,18 +193,39 @@ void CropDecimateNode::imageCb(
     height == static_cast<int>(image_msg->height))
   {
     pub_.publish(image_msg, info_msg);
+    frame.published(image_msg->header.stamp);
     return;
   }
 
-  // Get a cv::Mat view of the source data
-  CvImageConstPtr source = toCvShare(image_msg);
-
   // Except in Bayer downsampling case, output has same encoding as the input
-  CvImage output(source->header, source->encoding);
-  // Apply ROI (no copy, still a view of the image_msg data)
-  output.image = source->image(cv::Rect(offset_x_, offset_y_, width, height));
+  CvImage output(image_msg->header, encoding);
+  const cv::Rect roi(offset_x_, offset_y_, width, height);
+  CvImageConstPtr source;
+
+  if (is_packed) {
+    // Unpack only the ROI. Nearest neighbor decimation of a Bayer image only
+    // reads the first row pair of every block, so only those are unpacked.
+    const bool row_pairs = is_bayer &&
+      interpolation_ == image_proc::CropDecimateModes::CropDecimate_NN &&
+      decimation_x % 2 == 0 && decimation_y % 2 == 0 && decimation_y > 2;
+    const int pair_step = row_pairs ? decimation_y : 0;
+    if (!unpackImage(*image_msg, roi, unpack_depth_, output.image, pair_step)) {
+      RCLCPP_ERROR(get_logger(), "Packed image holds less data than its size takes");
+      return;
+    }
+    if (row_pairs) {
+      decimation_y = 2;
+    }
+  } else {
+    // Get a cv::Mat view of the source data
+    source = toCvShare(image_msg);
+    // Apply ROI (no copy, still a view of the image_msg data)
+    output.image = source->image(roi);
+  }
+
+  std::unique_ptr<OutputImage> out_image;
 
-  // Special case: when decimating Bayer images, we first do a 2x2 decimation to BGR
+  // Special case: when decimating Bayer images, we debayer in the same pass
   if (is_bayer && (decimation_x > 1 || decimation_y > 1)) {
     if (decimation_x % 2 != 0 || decimation_y % 2 != 0) {
       RCLCPP_ERROR(
@@ -244,94 +234,82 @@ void CropDecimateNode::imageCb(
       return;
     }
 
+    const bool is_16bit = output.image.depth() == CV_16U;
+    output.encoding = is_16bit ? sensor_msgs::image_encodings::BGR16 :
+      sensor_msgs::image_encodings::BGR8;
+
+    // Nearest neighbor and area decimation come straight out of the kernel.
+    // Other interpolations resize the 2x2 debayered image below.
+    const bool bin = interpolation_ == image_proc::CropDecimateModes::CropDecimate_Area;
+    const bool fused = bin ||
+      interpolation_ == image_proc::CropDecimateModes::CropDecimate_NN ||
+      (decimation_x == 2 && decimation_y == 2);
+    const int kernel_x = fused ? decimation_x : 2;
+    const int kernel_y = fused ? decimation_y : 2;
+
     cv::Mat bgr;
-    int step = output.image.step1();
-    if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB8) {
-      debayer2x2toBGR<uint8_t>(output.image, bgr, 0, 1, step, step + 1);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR8) {
-      debayer2x2toBGR<uint8_t>(output.image, bgr, step + 1, 1, step, 0);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG8) {
-      debayer2x2toBGR<uint8_t>(output.image, bgr, step, 0, step + 1, 1);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_GRBG8) {
-      debayer2x2toBGR<uint8_t>(output.image, bgr, 1, 0, step + 1, step);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB16) {
-      debayer2x2toBGR<uint16_t>(output.image, bgr, 0, 1, step, step + 1);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR16) {
-      debayer2x2toBGR<uint16_t>(output.image, bgr, step + 1, 1, step, 0);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG16) {
-      debayer2x2toBGR<uint16_t>(output.image, bgr, step, 0, step + 1, 1);
-    } else if (image_msg->encoding == sensor_msgs::image_encodings::BAYER_GRBG16) {
-      debayer2x2toBGR<uint16_t>(output.image, bgr, 1, 0, step + 1, step);
-    } else {
+    if (fused) {
+      out_image = std::make_unique<OutputImage>(
+        use_buffer_pool_, output.header, output.encoding,
+        output.image.rows / kernel_y, output.image.cols / kernel_x,
+        CV_MAKETYPE(output.image.depth(), 3));
+      bgr = out_image->mat();
+    }
+
+    if (!decimateBayer(output.image, encoding, bgr, kernel_x, kernel_y, bin)) {
       RCLCPP_ERROR(
         get_logger(), "Unrecognized Bayer encoding '%s'",
-        image_msg->encoding.c_str());
+        encoding.c_str());
       return;
     }
 
     output.image = bgr;
-    output.encoding = (bgr.depth() == CV_8U) ? sensor_msgs::image_encodings::BGR8 :
-      sensor_msgs::image_encodings::BGR16;
-    decimation_x /= 2;
-    decimation_y /= 2;
+    decimation_x /= kernel_x;
+    decimation_y /= kernel_y;
   }
 
   // Apply further downsampling, if necessary
   if (decimation_x > 1 || decimation_y > 1) {
-    cv::Mat decimated;
+    const cv::Size size(output.image.cols / decimation_x, output.image.rows / decimation_y);
+    out_image = std::make_unique<OutputImage>(
+      use_buffer_pool_, output.header, output.encoding,
+      size.height, size.width, output.image.type());
+    cv::Mat decimated = out_image->mat();
 
     if (interpolation_ == image_proc::CropDecimateModes::CropDecimate_NN) {
       // Use optimized method instead of OpenCV's more general NN resize
-      int pixel_size = output.image.elemSize();
-
-      switch (pixel_size) {
-        // Currently support up through 4-channel float
-        case 1:
-          decimate<1>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 2:
-          decimate<2>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 3:
-          decimate<3>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 4:
-          decimate<4>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 6:
-          decimate<6>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 8:
-          decimate<8>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 12:
-          decimate<12>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        case 16:
-          decimate<16>(output.image, decimated, decimation_x, decimation_y);
-          break;
-        default:
-          RCLCPP_ERROR(
-            get_logger(),
-            "Unsupported pixel size, %d bytes", pixel_size);
-          return;
+      if (!decimate(output.image, decimated, decimation_x, decimation_y)) {
+        RCLCPP_ERROR(
+          get_logger(),
+          "Unsupported pixel size, %d bytes", static_cast<int>(output.image.elemSize()));
+        return;
       }
     } else {
       // Linear, cubic, area, ...
-      cv::Size size(output.image.cols / decimation_x, output.image.rows / decimation_y);
-      cv::resize(output.image, decimated, size, 0.0, 0.0, static_cast<int>(interpolation_));
+      if (backend_ == Backend::OPENCL) {
+        cv::UMat device_decimated;
+        cv::resize(
+          output.image.getUMat(cv::ACCESS_READ), device_decimated, size, 0.0, 0.0,
+          static_cast<int>(interpolation_));
+        device_decimated.copyTo(decimated);
+      } else {
+        cv::resize(output.image, decimated, size, 0.0, 0.0, static_cast<int>(interpolation_));
+      }
     }
 
     output.image = decimated;
   }
 
-  // Create output Image message
-  /// @todo Could save copies by allocating this above and having output.image alias it
-  sensor_msgs::msg::Image::SharedPtr out_image = output.toImageMsg();
+  // Crop only: copy the ROI into the output message
+  if (!out_image) {
+    out_image = std::make_unique<OutputImage>(
+      use_buffer_pool_, output.header, output.encoding,
+      output.image.rows, output.image.cols, output.image.type());
+    output.image.copyTo(out_image->mat());
+  }
 
   // Create updated CameraInfo message
-  sensor_msgs::msg::CameraInfo::SharedPtr out_info =
-    std::make_shared<sensor_msgs::msg::CameraInfo>(*info_msg);
+  auto out_info = std::make_unique<sensor_msgs::msg::CameraInfo>(*info_msg);
   int binning_x = std::max(static_cast<int>(info_msg->binning_x), 1);
   int binning_y = std::max(static_cast<int>(info_msg->binning_y), 1);
   out_info->binning_x = binning_x * decimation_x_;
@@ -349,11 +327,12 @@ void CropDecimateNode::imageCb(
   }
 
   if (!target_frame_id_.empty()) {
-    out_image->header.frame_id = target_frame_id_;
+    out_image->header().frame_id = target_frame_id_;
     out_info->header.frame_id = target_frame_id_;
   }
 
-  pub_.publish(out_image, out_info);
+  out_image->publish(pub_, std::move(out_info));
+  frame.published(image_msg->header.stamp);
 }
 
 }  // namespace image_proc
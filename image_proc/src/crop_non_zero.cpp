@@ -31,6 +31,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <string>
@@ -39,6 +40,8 @@
 #include "cv_bridge/cv_bridge.hpp"
 
 #include <image_proc/crop_non_zero.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/latest_only.hpp>
 #include <image_proc/utils.hpp>
 
 #include <image_transport/image_transport.hpp>
@@ -46,10 +49,75 @@
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace image_proc
 {
 
+namespace
+{
+
+// Bounding box of the non zero pixels of a single channel image, found from
+// the occupancy of its rows and columns. Rows are tested with the vectorized
+// cv::countNonZero, and within the occupied rows only the columns outside the
+// box found so far are visited, so no buffers are needed.
+template<typename T>
+cv::Rect nonZeroBoundingBox(const cv::Mat & image)
+{
+  int top = 0;
+  while (top < image.rows && cv::countNonZero(image.row(top)) == 0) {
+    ++top;
+  }
+  if (top == image.rows) {
+    return cv::Rect();
+  }
+
+  int bottom = image.rows - 1;
+  while (cv::countNonZero(image.row(bottom)) == 0) {
+    --bottom;
+  }
+
+  int left = image.cols;
+  int right = -1;
+  for (int y = top; y <= bottom; ++y) {
+    const T * row = image.ptr<T>(y);
+    int x = 0;
+    while (x < left && row[x] == 0) {
+      ++x;
+    }
+    left = std::min(left, x);
+    x = image.cols - 1;
+    while (x > right && row[x] == 0) {
+      --x;
+    }
+    right = std::max(right, x);
+  }
+
+  return cv::Rect(left, top, right - left + 1, bottom - top + 1);
+}
+
+cv::Rect nonZeroBoundingBox(const cv::Mat & image)
+{
+  switch (image.depth()) {
+    case CV_8U:
+      return nonZeroBoundingBox<uint8_t>(image);
+    case CV_8S:
+      return nonZeroBoundingBox<int8_t>(image);
+    case CV_16U:
+      return nonZeroBoundingBox<uint16_t>(image);
+    case CV_16S:
+      return nonZeroBoundingBox<int16_t>(image);
+    case CV_32S:
+      return nonZeroBoundingBox<int32_t>(image);
+    case CV_32F:
+      return nonZeroBoundingBox<float>(image);
+    default:
+      return nonZeroBoundingBox<double>(image);
+  }
+}
+
+}  // namespace
+
 CropNonZeroNode::CropNonZeroNode(const rclcpp::NodeOptions & options)
 : Node("CropNonZeroNode", options)
 {
@@ -62,6 +130,16 @@ CropNonZeroNode::CropNonZeroNode(const rclcpp::NodeOptions & options)
   image_topic_ = node_base->resolve_topic_or_service_name("image_raw", false);
   std::string pub_topic = node_base->resolve_topic_or_service_name("image", false);
 
+  // Declare parameters before we setup any publishers or subscribers
+  std::string method = this->declare_parameter<std::string>("method", "contour");
+  use_projection_ = method == "projection";
+  if (!use_projection_ && method != "contour") {
+    RCLCPP_WARN(
+      this->get_logger(), "Unknown crop method [%s], using contour instead", method.c_str());
+  }
+
+  latest_only_ = std::make_unique<LatestOnly>(this);
+
   // Setup lazy subscriber using publisher connection callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -71,7 +149,7 @@ CropNonZeroNode::CropNonZeroNode(const rclcpp::NodeOptions & options)
         sub_raw_.shutdown();
       } else if (!sub_raw_) {
         // Create subscriber with QoS matched to subscribed topic publisher
-        auto qos_profile = getTopicQosProfile(this, image_topic_);
+        auto qos_profile = latest_only_->qos(getTopicQosProfile(this, image_topic_));
         image_transport::TransportHints hints(this);
         sub_raw_ = image_transport::create_subscription(
           this, image_topic_, std::bind(
@@ -86,15 +164,18 @@ CropNonZeroNode::CropNonZeroNode(const rclcpp::NodeOptions & options)
   // Create publisher with QoS matched to subscribed topic publisher
   auto qos_profile = getTopicQosProfile(this, image_topic_);
   pub_ = image_transport::create_publisher(this, pub_topic, qos_profile, pub_options);
+
+  processing_ = std::make_unique<ProcessingDiagnostics>(this);
 }
 
 void CropNonZeroNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg)
 {
-  cv_bridge::CvImagePtr cv_ptr;
-  try {
-    cv_ptr = cv_bridge::toCvCopy(raw_msg);
-  } catch (cv_bridge::Exception & e) {
-    RCLCPP_ERROR(this->get_logger(), "cv_bridge exception: %s", e.what());
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/crop_non_zero", raw_msg.get(), raw_msg->width, raw_msg->height,
+    raw_msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(raw_msg->header.stamp, frame)) {
     return;
   }
 
@@ -105,6 +186,54 @@ void CropNonZeroNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & ra
       raw_msg->encoding.c_str());
     return;
   }
+
+  const bool published = use_projection_ ? cropProjection(raw_msg) : cropContour(raw_msg);
+  if (published) {
+    frame.published(raw_msg->header.stamp);
+  }
+}
+
+bool CropNonZeroNode::cropProjection(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg)
+{
+  // The input is only read, so share it rather than copying the whole frame
+  cv_bridge::CvImageConstPtr cv_ptr;
+  try {
+    cv_ptr = cv_bridge::toCvShare(raw_msg);
+  } catch (cv_bridge::Exception & e) {
+    RCLCPP_ERROR(this->get_logger(), "cv_bridge exception: %s", e.what());
+    return false;
+  }
+
+  cv::Rect r = nonZeroBoundingBox(cv_ptr->image);
+  if (r.empty()) {
+    RCLCPP_DEBUG(this->get_logger(), "Image has no non zero pixels, nothing to crop");
+    return false;
+  }
+
+  publishCrop(raw_msg, cv_ptr->image(r));
+  return true;
+}
+
+void CropNonZeroNode::publishCrop(
+  const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg, const cv::Mat & crop)
+{
+  // Copy the crop straight into a uniquely owned message, which intra-process
+  // subscribers take without a further copy
+  OutputImage out(false, raw_msg->header, raw_msg->encoding, crop.rows, crop.cols, crop.type());
+  crop.copyTo(out.mat());
+  out.publish(pub_);
+}
+
+bool CropNonZeroNode::cropContour(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg)
+{
+  cv_bridge::CvImagePtr cv_ptr;
+  try {
+    cv_ptr = cv_bridge::toCvCopy(raw_msg);
+  } catch (cv_bridge::Exception & e) {
+    RCLCPP_ERROR(this->get_logger(), "cv_bridge exception: %s", e.what());
+    return false;
+  }
+
   std::vector<std::vector<cv::Point>> cnt;
   cv::Mat1b m(raw_msg->width, raw_msg->height);
 
@@ -119,6 +248,10 @@ void CropNonZeroNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & ra
   }
 
   cv::findContours(m, cnt, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
+  if (cnt.empty()) {
+    RCLCPP_DEBUG(this->get_logger(), "Image has no non zero pixels, nothing to crop");
+    return false;
+  }
 
   // search the largest area
   std::vector<std::vector<cv::Point>>::iterator it =
@@ -130,12 +263,8 @@ void CropNonZeroNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & ra
 
   cv::Rect r = cv::boundingRect(cnt[std::distance(cnt.begin(), it)]);
 
-  cv_bridge::CvImage out_msg;
-  out_msg.header = raw_msg->header;
-  out_msg.encoding = raw_msg->encoding;
-  out_msg.image = cv_ptr->image(r);
-
-  pub_.publish(out_msg.toImageMsg());
+  publishCrop(raw_msg, cv_ptr->image(r));
+  return true;
 }
 
 }  // namespace image_proc
@@ -33,23 +33,50 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include "cv_bridge/cv_bridge.hpp"
 
 #include <image_proc/debayer.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/packed.hpp>
 #include <image_proc/utils.hpp>
+#include <image_proc/yuv.hpp>
 // Until merged into OpenCV
 #include <image_proc/edge_aware.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace image_proc
 {
 
+namespace
+{
+
+// OpenCV code converting the Bayer encoding straight to luma, -1 if unknown
+int bayerToGrayCode(const std::string & encoding)
+{
+  namespace enc = sensor_msgs::image_encodings;
+  if (encoding == enc::BAYER_RGGB8 || encoding == enc::BAYER_RGGB16) {
+    return cv::COLOR_BayerBG2GRAY;
+  } else if (encoding == enc::BAYER_BGGR8 || encoding == enc::BAYER_BGGR16) {
+    return cv::COLOR_BayerRG2GRAY;
+  } else if (encoding == enc::BAYER_GBRG8 || encoding == enc::BAYER_GBRG16) {
+    return cv::COLOR_BayerGR2GRAY;
+  } else if (encoding == enc::BAYER_GRBG8 || encoding == enc::BAYER_GRBG16) {
+    return cv::COLOR_BayerGB2GRAY;
+  }
+  return -1;
+}
+
+}  // namespace
+
 DebayerNode::DebayerNode(const rclcpp::NodeOptions & options)
 : Node("DebayerNode", options)
 {
@@ -57,6 +84,10 @@ DebayerNode::DebayerNode(const rclcpp::NodeOptions & options)
   this->declare_parameter<std::string>("image_transport", "raw");
 
   debayer_ = this->declare_parameter("debayer", 3);
+  backend_ = declareBackendParameter(this);
+  use_buffer_pool_ = this->declare_parameter("use_buffer_pool", false);
+  unpack_depth_ = this->declare_parameter("unpack_bit_depth", 16) == 8 ? CV_8U : CV_16U;
+  ordered_ = declareConcurrencyParameter(this, 2);
 
   // For compressed topics to remap appropriately, we need to pass a
   // fully expanded and remapped topic name to image_transport
@@ -65,6 +96,8 @@ DebayerNode::DebayerNode(const rclcpp::NodeOptions & options)
   std::string mono_topic = node_base->resolve_topic_or_service_name("image_mono", false);
   std::string color_topic = node_base->resolve_topic_or_service_name("image_color", false);
 
+  latest_only_ = std::make_unique<LatestOnly>(this);
+
   // Setup lazy subscriber using publisher connection callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -74,7 +107,7 @@ DebayerNode::DebayerNode(const rclcpp::NodeOptions & options)
         sub_raw_.shutdown();
       } else if (!sub_raw_) {
         // Create subscriber with QoS matched to subscribed topic publisher
-        auto qos_profile = getTopicQosProfile(this, image_topic_);
+        auto qos_profile = latest_only_->qos(getTopicQosProfile(this, image_topic_));
         image_transport::TransportHints hints(this);
         sub_raw_ = image_transport::create_subscription(
           this, image_topic_,
@@ -91,41 +124,120 @@ DebayerNode::DebayerNode(const rclcpp::NodeOptions & options)
   auto qos_profile = getTopicQosProfile(this, image_topic_);
   pub_mono_ = image_transport::create_publisher(this, mono_topic, qos_profile, pub_options);
   pub_color_ = image_transport::create_publisher(this, color_topic, qos_profile, pub_options);
+
+  processing_ = std::make_unique<ProcessingDiagnostics>(this);
+  placement_ = std::make_unique<ThreadPlacement>(this, ordered_ != nullptr);
 }
 
 void DebayerNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg)
 {
-  int bit_depth = sensor_msgs::image_encodings::bitDepth(raw_msg->encoding);
-  // TODO(someone): Fix as soon as bitDepth fixes it
-  if (raw_msg->encoding == sensor_msgs::image_encodings::YUV422) {
-    bit_depth = 8;
+  if (!latest_only_->admit(raw_msg->header.stamp, *processing_)) {
+    return;
   }
 
+  if (!ordered_) {
+    OrderedOutput::Ticket ticket;
+    debayerImage(raw_msg, ticket);
+    return;
+  }
+
+  // Debayer up to concurrency frames at once, publishing them in order
+  const bool dispatched = ordered_->dispatch(
+    [this, raw_msg](OrderedOutput::Ticket & ticket) {debayerImage(raw_msg, ticket);});
+  if (!dispatched) {
+    processing_->dropped();
+  }
+}
+
+void DebayerNode::debayerImage(
+  const sensor_msgs::msg::Image::ConstSharedPtr & msg, OrderedOutput::Ticket & ticket)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/debayer", msg.get(), msg->width, msg->height, msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+  if (ordered_) {
+    placement_->placeCurrentThread("worker");
+  }
+
+  // Packed 10-bit and 12-bit images are unpacked once, into a message of the
+  // 8-bit or 16-bit encoding, then handled like it. The mono image of a packed
+  // mono stream is that message itself.
+  sensor_msgs::msg::Image::ConstSharedPtr raw_msg = msg;
+  if (packedBitDepth(msg->encoding)) {
+    tracetools_image_pipeline::StageTrace stage(this, "unpack", msg.get());
+    raw_msg = unpackImageMessage(*msg, unpack_depth_, use_buffer_pool_);
+    if (!raw_msg) {
+      RCLCPP_WARN(
+        this->get_logger(), "Packed image from topic '%s' holds less data than its size takes",
+        sub_raw_.getTopic().c_str());
+      return;
+    }
+  }
+
+  // bitDepth() does not know NV12, nor that yuv422 is 8-bit
+  const bool is_yuv = isYuv(raw_msg->encoding);
+  const int bit_depth = is_yuv ? 8 : sensor_msgs::image_encodings::bitDepth(raw_msg->encoding);
+
   // First publish to mono if needed
   if (pub_mono_.getNumSubscribers()) {
     if (sensor_msgs::image_encodings::isMono(raw_msg->encoding)) {
+      ticket.wait(0);
       pub_mono_.publish(raw_msg);
+      frame.published(raw_msg->header.stamp);
     } else {
       if ((bit_depth != 8) && (bit_depth != 16)) {
         RCLCPP_WARN(
           this->get_logger(),
           "Raw image data from topic '%s' has unsupported depth: %d",
           sub_raw_.getTopic().c_str(), bit_depth);
+      } else if (sensor_msgs::image_encodings::isBayer(raw_msg->encoding)) {
+        // Interpolate luma straight from the mosaic, without demosaicing the
+        // color image, into the outgoing message
+        int type = bit_depth == 8 ? CV_8U : CV_16U;
+        const cv::Mat bayer(
+          raw_msg->height, raw_msg->width, CV_MAKETYPE(type, 1),
+          const_cast<uint8_t *>(&raw_msg->data[0]), raw_msg->step);
+        OutputImage gray_out(
+          use_buffer_pool_, raw_msg->header,
+          bit_depth == 8 ? sensor_msgs::image_encodings::MONO8 :
+          sensor_msgs::image_encodings::MONO16,
+          raw_msg->height, raw_msg->width, CV_MAKETYPE(type, 1));
+        {
+          tracetools_image_pipeline::StageTrace stage(this, "compute", msg.get());
+          cv::cvtColor(bayer, gray_out.mat(), bayerToGrayCode(raw_msg->encoding));
+        }
+
+        ticket.wait(0);
+        gray_out.publish(pub_mono_);
+        frame.published(raw_msg->header.stamp);
+      } else if (is_yuv) {
+        // The luma plane is the mono image, copied straight into the message
+        OutputImage gray_out(
+          use_buffer_pool_, raw_msg->header, sensor_msgs::image_encodings::MONO8,
+          raw_msg->height, raw_msg->width, CV_8UC1);
+        if (yuvToMono(*raw_msg, gray_out.mat())) {
+          ticket.wait(0);
+          gray_out.publish(pub_mono_);
+          frame.published(raw_msg->header.stamp);
+        } else {
+          RCLCPP_WARN(
+            this->get_logger(), "YUV image from topic '%s' has an odd size or too little data",
+            sub_raw_.getTopic().c_str());
+        }
       } else {
         // Use cv_bridge to convert to Mono. If a type is not supported,
-        // it will error out there
-        sensor_msgs::msg::Image::SharedPtr gray_msg;
+        // it will error out there. The message is uniquely owned, so that
+        // intra-process subscribers take it without a copy
+        auto gray_msg = std::make_unique<sensor_msgs::msg::Image>();
 
         try {
-          if (bit_depth == 8) {
-            gray_msg =
-              cv_bridge::toCvCopy(raw_msg, sensor_msgs::image_encodings::MONO8)->toImageMsg();
-          } else {
-            gray_msg =
-              cv_bridge::toCvCopy(raw_msg, sensor_msgs::image_encodings::MONO16)->toImageMsg();
-          }
-
-          pub_mono_.publish(gray_msg);
+          cv_bridge::toCvShare(
+            raw_msg, bit_depth == 8 ? sensor_msgs::image_encodings::MONO8 :
+            sensor_msgs::image_encodings::MONO16)->toImageMsg(*gray_msg);
+
+          ticket.wait(0);
+          pub_mono_.publish(std::move(gray_msg));
+          frame.published(raw_msg->header.stamp);
         } catch (cv_bridge::Exception & e) {
           RCLCPP_WARN(this->get_logger(), "cv_bridge conversion error: '%s'", e.what());
         }
@@ -133,6 +245,9 @@ void DebayerNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_ms
     }
   }
 
+  // Later frames may publish to mono while this one is debayered
+  ticket.release(0);
+
   // Next, publish to color
   if (!pub_color_.getNumSubscribers()) {
     return;
@@ -140,7 +255,9 @@ void DebayerNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_ms
 
   if (sensor_msgs::image_encodings::isMono(raw_msg->encoding)) {
     // For monochrome, no processing needed!
+    ticket.wait(1);
     pub_color_.publish(raw_msg);
+    frame.published(raw_msg->header.stamp);
 
     // Warn if the user asked for color
     RCLCPP_WARN(
@@ -148,89 +265,116 @@ void DebayerNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & raw_ms
       "Color topic '%s' requested, but raw image data from topic '%s' is grayscale",
       pub_color_.getTopic().c_str(), sub_raw_.getTopic().c_str());
   } else if (sensor_msgs::image_encodings::isColor(raw_msg->encoding)) {
+    ticket.wait(1);
     pub_color_.publish(raw_msg);
+    frame.published(raw_msg->header.stamp);
   } else if (sensor_msgs::image_encodings::isBayer(raw_msg->encoding)) {
     int type = bit_depth == 8 ? CV_8U : CV_16U;
     const cv::Mat bayer(
       raw_msg->height, raw_msg->width, CV_MAKETYPE(type, 1),
       const_cast<uint8_t *>(&raw_msg->data[0]), raw_msg->step);
 
-    sensor_msgs::msg::Image::SharedPtr color_msg =
-      std::make_shared<sensor_msgs::msg::Image>();
-    color_msg->header = raw_msg->header;
-    color_msg->height = raw_msg->height;
-    color_msg->width = raw_msg->width;
-    color_msg->encoding =
-      bit_depth == 8 ? sensor_msgs::image_encodings::BGR8 : sensor_msgs::image_encodings::BGR16;
-    color_msg->step = color_msg->width * 3 * (bit_depth / 8);
-    color_msg->data.resize(color_msg->height * color_msg->step);
-
-    cv::Mat color(
-      color_msg->height, color_msg->width, CV_MAKETYPE(type, 3),
-      &color_msg->data[0], color_msg->step);
-
-    int algorithm;
-    // std::loc_guard<std::recursive_mutex> loc(config_mutex_)
-    algorithm = debayer_;
-
-    if (algorithm == debayer_edgeaware_ ||
-      algorithm == debayer_edgeaware_weighted_)
+    // Debayer straight into the outgoing message
+    OutputImage color_out(
+      use_buffer_pool_, raw_msg->header,
+      bit_depth == 8 ? sensor_msgs::image_encodings::BGR8 : sensor_msgs::image_encodings::BGR16,
+      raw_msg->height, raw_msg->width, CV_MAKETYPE(type, 3));
+    cv::Mat & color = color_out.mat();
+
     {
-      // These algorithms are not in OpenCV yet
-      if (raw_msg->encoding != sensor_msgs::image_encodings::BAYER_GRBG8) {
-        RCLCPP_WARN(
-          this->get_logger(), "Edge aware algorithms currently only support GRBG8 Bayer. "
-          "Falling back to bilinear interpolation.");
-        algorithm = debayer_bilinear_;
-      } else {
+      tracetools_image_pipeline::StageTrace stage(this, "compute", msg.get());
+      int algorithm;
+      // std::loc_guard<std::recursive_mutex> loc(config_mutex_)
+      algorithm = debayer_;
+
+      if (algorithm == debayer_edgeaware_ ||
+        algorithm == debayer_edgeaware_weighted_)
+      {
+        // These algorithms are not in OpenCV yet
+        BayerPattern pattern;
+        if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB8 ||
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB16)
+        {
+          pattern = BayerPattern::RGGB;
+        } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR8 ||  // NOLINT
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR16)
+        {
+          pattern = BayerPattern::BGGR;
+        } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG8 ||  // NOLINT
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG16)
+        {
+          pattern = BayerPattern::GBRG;
+        } else {
+          pattern = BayerPattern::GRBG;
+        }
+
         if (algorithm == debayer_edgeaware_) {
-          debayerEdgeAware(bayer, color);
+          debayerEdgeAware(bayer, color, pattern);
         } else {
-          debayerEdgeAwareWeighted(bayer, color);
+          debayerEdgeAwareWeighted(bayer, color, pattern);
         }
       }
-    }
 
-    if (algorithm == debayer_bilinear_ || algorithm == debayer_vng_) {
-      int code = -1;
+      if (algorithm == debayer_bilinear_ || algorithm == debayer_vng_) {
+        int code = -1;
 
-      if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB8 ||
-        raw_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB16)
-      {
-        code = cv::COLOR_BayerBG2BGR;
-      } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR8 ||  // NOLINT
-        raw_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR16)
-      {
-        code = cv::COLOR_BayerRG2BGR;
-      } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG8 ||  // NOLINT
-        raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG16)
-      {
-        code = cv::COLOR_BayerGR2BGR;
-      } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GRBG8 ||  // NOLINT
-        raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GRBG16)
-      {
-        code = cv::COLOR_BayerGB2BGR;
-      }
+        if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB8 ||
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_RGGB16)
+        {
+          code = cv::COLOR_BayerBG2BGR;
+        } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR8 ||  // NOLINT
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_BGGR16)
+        {
+          code = cv::COLOR_BayerRG2BGR;
+        } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG8 ||  // NOLINT
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GBRG16)
+        {
+          code = cv::COLOR_BayerGR2BGR;
+        } else if (raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GRBG8 ||  // NOLINT
+          raw_msg->encoding == sensor_msgs::image_encodings::BAYER_GRBG16)
+        {
+          code = cv::COLOR_BayerGB2BGR;
+        }
 
-      if (algorithm == debayer_vng_) {
-        code += cv::COLOR_BayerBG2BGR_VNG - cv::COLOR_BayerBG2BGR;
-      }
+        if (algorithm == debayer_vng_) {
+          code += cv::COLOR_BayerBG2BGR_VNG - cv::COLOR_BayerBG2BGR;
+        }
 
-      cv::cvtColor(bayer, color, code);
+        if (backend_ == Backend::OPENCL) {
+          // Download straight into the message buffer
+          cv::UMat device_color;
+          cv::cvtColor(bayer.getUMat(cv::ACCESS_READ), device_color, code);
+          device_color.copyTo(color);
+        } else {
+          cv::cvtColor(bayer, color, code);
+        }
+      }
     }
 
-    pub_color_.publish(color_msg);
-  } else if (raw_msg->encoding == sensor_msgs::image_encodings::YUV422 ||  // NOLINT
-    raw_msg->encoding == sensor_msgs::image_encodings::YUV422_YUY2)
-  {
-    // Use cv_bridge to convert to BGR8
-    sensor_msgs::msg::Image::SharedPtr color_msg;
-
-    try {
-      color_msg = cv_bridge::toCvCopy(raw_msg, sensor_msgs::image_encodings::BGR8)->toImageMsg();
-      pub_color_.publish(color_msg);
-    } catch (const cv_bridge::Exception & e) {
-      RCLCPP_WARN(this->get_logger(), "cv_bridge conversion error: '%s'", e.what());
+    {
+      tracetools_image_pipeline::StageTrace stage(this, "publish", msg.get());
+      ticket.wait(1);
+      color_out.publish(pub_color_);
+      frame.published(raw_msg->header.stamp);
+    }
+  } else if (is_yuv) {
+    // Convert straight into the outgoing message
+    OutputImage color_out(
+      use_buffer_pool_, raw_msg->header, sensor_msgs::image_encodings::BGR8,
+      raw_msg->height, raw_msg->width, CV_8UC3);
+    bool converted;
+    {
+      tracetools_image_pipeline::StageTrace stage(this, "compute", msg.get());
+      converted = yuvToBgr(*raw_msg, color_out.mat());
+    }
+    if (converted) {
+      ticket.wait(1);
+      color_out.publish(pub_color_);
+      frame.published(raw_msg->header.stamp);
+    } else {
+      RCLCPP_WARN(
+        this->get_logger(), "YUV image from topic '%s' has an odd size or too little data",
+        sub_raw_.getTopic().c_str());
     }
   } else if (raw_msg->encoding == sensor_msgs::image_encodings::TYPE_8UC3) {
     // 8UC3 does not specify a color encoding. Is it BGR, RGB, HSV, XYZ, LUV...?
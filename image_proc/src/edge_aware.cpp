@@ -30,899 +30,180 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/core/utility.hpp>
+
 #include "image_proc/edge_aware.hpp"
 
 namespace image_proc
 {
 
-constexpr int avg(int a, int b)
+namespace
 {
-  return (a + b) >> 1;
-}
 
-constexpr int avg3(int a, int b, int c)
+// Channel indices in the interleaved BGR output
+constexpr int kBlue = 0;
+constexpr int kGreen = 1;
+constexpr int kRed = 2;
+
+template<typename W>
+constexpr W avg(W a, W b)
 {
-  return (a + b + c) / 3;
+  return (a + b) >> 1;
 }
 
-constexpr int avg4(int a, int b, int c, int d)
+template<typename W>
+constexpr W avg4(W a, W b, W c, W d)
 {
   return (a + b + c + d) >> 2;
 }
 
-constexpr int wavg4(int a, int b, int c, int d, int x, int y)
+template<typename W>
+constexpr W wavg4(W a, W b, W c, W d, W x, W y)
 {
   return ((a + b) * x + (c + d) * y) / (2 * (x + y));
 }
 
-void debayerEdgeAware(const cv::Mat & bayer, cv::Mat & color)
+// Green at a red or blue sample, interpolated along the direction of the
+// smaller gradient. The weighted variant blends both directions instead.
+template<typename W, bool Weighted>
+inline W interpolateGreen(W left, W right, W up, W down)
 {
-  unsigned width = bayer.cols;
-  unsigned height = bayer.rows;
-  unsigned rgb_line_step = color.step[0];
-  unsigned rgb_line_skip = rgb_line_step - width * 3;
-  int bayer_line_step = bayer.step[0];
-  int bayer_line_step2 = bayer_line_step * 2;
-
-  unsigned char * rgb_buffer = color.data;
-  unsigned char * bayer_pixel = bayer.data;
-  unsigned yIdx, xIdx;
-
-  int dh, dv;
-
-  // first two pixel values for first two lines
-  // Bayer         0 1 2
-  //         0     G r g
-  // line_step     b g b
-  // line_step2    g r g
-
-  rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1];  // red pixel
-  rgb_buffer[1] = bayer_pixel[0];  // green pixel
-  rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step];  // blue;
-
-  // Bayer         0 1 2
-  //         0     g R g
-  // line_step     b g b
-  // line_step2    g r g
-  // rgb_pixel[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg3(bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] =
-    avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-  // BGBG line
-  // Bayer         0 1 2
-  //         0     g r g
-  // line_step     B g b
-  // line_step2    g r g
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step] =
-    avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 1] =
-    avg3(bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-  // rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-  // pixel (1, 1)  0 1 2
-  //         0     g r g
-  // line_step     b G b
-  // line_step2    g r g
-  // rgb_pixel[rgb_line_step + 3] = avg(bayer_pixel[1] , bayer_pixel[line_step2+1] );
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  // rgb_pixel[rgb_line_step + 5] = avg(bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-
-  rgb_buffer += 6;
-  bayer_pixel += 2;
-  // rest of the first two lines
-  for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2) {
-    // GRGR line
-    // Bayer        -1 0 1 2
-    //           0   r G r g
-    //   line_step   g b g b
-    // line_step2    r g r g
-    rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
-
-    // Bayer        -1 0 1 2
-    //          0    r g R g
-    //  line_step    g b g b
-    // line_step2    r g r g
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg3(bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] =
-      avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    // BGBG line
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g B g b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step] = avg4(
-      bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-      bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = avg4(
-      bayer_pixel[0], bayer_pixel[bayer_line_step2],
-      bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g b G b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    // rgb_pixel[rgb_line_step + 5] = avg(bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-  }
-
-  // last two pixel values for first two lines
-  // GRGR line
-  // Bayer        -1 0 1
-  //           0   r G r
-  //   line_step   g b g
-  // line_step2    r g r
-  rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-  rgb_buffer[1] = bayer_pixel[0];
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] =
-    rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-
-  // Bayer        -1 0 1
-  //          0    r g R
-  //  line_step    g b g
-  // line_step2    r g r
-  rgb_buffer[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-  // rgb_pixel[5] = bayer_pixel[line_step];
-
-  // BGBG line
-  // Bayer        -1 0 1
-  //          0    r g r
-  //  line_step    g B g
-  // line_step2    r g r
-  rgb_buffer[rgb_line_step] = avg4(
-    bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-    bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-  rgb_buffer[rgb_line_step + 1] = avg4(
-    bayer_pixel[0], bayer_pixel[bayer_line_step2],
-    bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-  // rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-  // Bayer         -1 0 1
-  //         0      r g r
-  // line_step      g b G
-  // line_step2     r g r
-  rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  // rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-  bayer_pixel += bayer_line_step + 2;
-  rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
-
-  // main processing
-  for (yIdx = 2; yIdx < height - 2; yIdx += 2) {
-    // first two pixel values
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     G r g
-    // line_step     b g b
-    // line_step2    g r g
-
-    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1];  // red pixel
-    rgb_buffer[1] = bayer_pixel[0];  // green pixel
-    rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);  // blue;
-
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     g R g
-    // line_step     b g b
-    // line_step2    g r g
-    // rgb_pixel[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg4(
-      bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1],
-      bayer_pixel[1 - bayer_line_step]);
-    rgb_buffer[5] = avg4(
-      bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2],
-      bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-
-    // BGBG line
-    // Bayer         0 1 2
-    //         0     g r g
-    // line_step     B g b
-    // line_step2    g r g
-    rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step] =
-      avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 1] = avg3(
-      bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // pixel (1, 1)  0 1 2
-    //         0     g r g
-    // line_step     b G b
-    // line_step2    g r g
-    // rgb_pixel[rgb_line_step + 3] = avg(bayer_pixel[1] , bayer_pixel[line_step2+1] );
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    rgb_buffer[rgb_line_step + 5] =
-      avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    rgb_buffer += 6;
-    bayer_pixel += 2;
+  const W dh = std::abs(left - right);
+  const W dv = std::abs(up - down);
 
-    // continue with rest of the line
-    for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2) {
-      // GRGR line
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //           0   r G r g
-      //   line_step   g b g b
-      // line_step2    r g r g
-      rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-      rgb_buffer[1] = bayer_pixel[0];
-      rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //          0    r g R g
-      //  line_step    g b g b
-      // line_step2    r g r g
-
-      dh = std::abs(bayer_pixel[0] - bayer_pixel[2]);
-      dv = std::abs(bayer_pixel[-bayer_line_step + 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dh > dv) {
-        rgb_buffer[4] = avg(bayer_pixel[-bayer_line_step + 1], bayer_pixel[bayer_line_step + 1]);
-      } else if (dv > dh) {
-        rgb_buffer[4] = avg(bayer_pixel[0], bayer_pixel[2]);
-      } else {
-        rgb_buffer[4] = avg4(
-          bayer_pixel[-bayer_line_step + 1], bayer_pixel[bayer_line_step + 1],
-          bayer_pixel[0], bayer_pixel[2]);
-      }
-
-      rgb_buffer[3] = bayer_pixel[1];
-      rgb_buffer[5] = avg4(
-        bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step],
-        bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-      // BGBG line
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g B g b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step] = avg4(
-        bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-        bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-      rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-      dv = std::abs(bayer_pixel[0] - bayer_pixel[bayer_line_step2]);
-      dh = std::abs(bayer_pixel[bayer_line_step - 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dv > dh) {
-        rgb_buffer[rgb_line_step + 1] =
-          avg(bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-      } else if (dh > dv) {
-        rgb_buffer[rgb_line_step + 1] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step2]);
-      } else {
-        rgb_buffer[rgb_line_step + 1] = avg4(
-          bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1],
-          bayer_pixel[bayer_line_step + 1]);
-      }
-
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g b G b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-      rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-      rgb_buffer[rgb_line_step + 5] =
-        avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+  if (Weighted) {
+    if (dh == 0 && dv == 0) {
+      return avg4(up, down, left, right);
     }
-
-    // last two pixels of the line
-    // last two pixel values for first two lines
-    // GRGR line
-    // Bayer        -1 0 1
-    //           0   r G r
-    //   line_step   g b g
-    // line_step2    r g r
-    rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] =
-      rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-
-    // Bayer        -1 0 1
-    //          0    r g R
-    //  line_step    g b g
-    // line_step2    r g r
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-    // rgb_pixel[5] = bayer_pixel[line_step];
-
-    // BGBG line
-    // Bayer        -1 0 1
-    //          0    r g r
-    //  line_step    g B g
-    // line_step2    r g r
-    rgb_buffer[rgb_line_step] = avg4(
-      bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-      bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = avg4(
-      bayer_pixel[0], bayer_pixel[bayer_line_step2],
-      bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    // rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-    // Bayer         -1 0 1
-    //         0      r g r
-    // line_step      g b G
-    // line_step2     r g r
-    rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    // rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-    bayer_pixel += bayer_line_step + 2;
-    rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+    return wavg4(up, down, left, right, dh, dv);
   }
 
-  // last two lines
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     G r g
-  // line_step     b g b
-
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step] =
-    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1];  // red pixel
-  rgb_buffer[1] = bayer_pixel[0];  // green pixel
-  rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step];  // blue;
-
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     g R g
-  // line_step     b g b
-  // rgb_pixel[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg4(
-    bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1],
-    bayer_pixel[1 - bayer_line_step]);
-  rgb_buffer[5] = avg4(
-    bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2],
-    bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-
-  // BGBG line
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     g r g
-  // line_step     B g b
-  // rgb_pixel[rgb_line_step] = bayer_pixel[1];
-  rgb_buffer[rgb_line_step + 1] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     g r g
-  // line_step     b G b
-  // rgb_pixel[rgb_line_step + 3] = avg(bayer_pixel[1] , bayer_pixel[line_step2+1] );
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  rgb_buffer[rgb_line_step + 5] =
-    avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-  rgb_buffer += 6;
-  bayer_pixel += 2;
-
-  // rest of the last two lines
-  for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2) {
-    // GRGR line
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r G r g
-    // line_step    g b g b
-    rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r g R g
-    // line_step    g b g b
-    rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg4(
-      bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1],
-      bayer_pixel[1 - bayer_line_step]);
-    rgb_buffer[5] = avg4(
-      bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2],
-      bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
-
-    // BGBG line
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r g r g
-    // line_step    g B g b
-    rgb_buffer[rgb_line_step] = avg(bayer_pixel[-1], bayer_pixel[1]);
-    rgb_buffer[rgb_line_step + 1] = avg3(
-      bayer_pixel[0], bayer_pixel[bayer_line_step - 1],
-      bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+  // Written as selects so the compiler can vectorize the row loop
+  const W green_v = avg(up, down);
+  const W green_h = avg(left, right);
+  const W green_a = avg4(up, down, left, right);
+  return dh > dv ? green_v : (dv > dh ? green_h : green_a);
+}
 
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r g r g
-    // line_step    g b G b
-    // rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    rgb_buffer[rgb_line_step + 5] =
-      avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+// Reconstructs the BGR value at column x. xl and xr are the columns to the
+// left and right of x, already mirrored at the image border.
+template<typename T, typename W, int RowColor, bool Weighted>
+inline void debayerPixel(
+  const T * prev, const T * cur, const T * next, T * out,
+  int x, int xl, int xr, bool green)
+{
+  constexpr int kOtherColor = kRed - RowColor;
+  T * px = out + 3 * x;
+
+  if (green) {
+    px[RowColor] = static_cast<T>(avg<W>(cur[xl], cur[xr]));
+    px[kGreen] = cur[x];
+    px[kOtherColor] = static_cast<T>(avg<W>(prev[x], next[x]));
+  } else {
+    px[RowColor] = cur[x];
+    px[kGreen] = static_cast<T>(
+      interpolateGreen<W, Weighted>(cur[xl], cur[xr], prev[x], next[x]));
+    px[kOtherColor] = static_cast<T>(avg4<W>(prev[xl], prev[xr], next[xl], next[xr]));
   }
-
-  // last two pixel values for first two lines
-  // GRGR line
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r G r
-  // line_step    g b g
-  rgb_buffer[rgb_line_step] = rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-  rgb_buffer[1] = bayer_pixel[0];
-  rgb_buffer[5] = rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r g R
-  // line_step    g b g
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg3(
-    bayer_pixel[0], bayer_pixel[bayer_line_step + 1],
-    bayer_pixel[-bayer_line_step + 1]);
-  // rgb_pixel[5] = avg(bayer_pixel[line_step], bayer_pixel[-line_step] );
-
-  // BGBG line
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r g r
-  // line_step    g B g
-  // rgb_pixel[rgb_line_step] = avg2(bayer_pixel[-1], bayer_pixel[1] );
-  rgb_buffer[rgb_line_step + 1] = avg3(
-    bayer_pixel[0], bayer_pixel[bayer_line_step - 1],
-    bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r g r
-  // line_step    g b G
-  // rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  // rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 }
 
-void debayerEdgeAwareWeighted(const cv::Mat & bayer, cv::Mat & color)
+// Debayers a single row. RowColor is the channel of the non-green samples on
+// this row and green_phase the column parity of its green samples.
+template<typename T, typename W, int RowColor, bool Weighted>
+void debayerRow(
+  const T * prev, const T * cur, const T * next, T * out,
+  int width, int green_phase)
 {
-  unsigned width = bayer.cols;
-  unsigned height = bayer.rows;
-  unsigned rgb_line_step = color.step[0];
-  unsigned rgb_line_skip = rgb_line_step - width * 3;
-  int bayer_line_step = bayer.step[0];
-  int bayer_line_step2 = bayer_line_step * 2;
-
-  unsigned char * rgb_buffer = color.data;
-  unsigned char * bayer_pixel = bayer.data;
-  unsigned yIdx, xIdx;
-
-  int dh, dv;
-
-  // first two pixel values for first two lines
-  // Bayer         0 1 2
-  //         0     G r g
-  // line_step     b g b
-  // line_step2    g r g
-
-  rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1];  // red pixel
-  rgb_buffer[1] = bayer_pixel[0];  // green pixel
-  rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step];  // blue;
-
-  // Bayer         0 1 2
-  //         0     g R g
-  // line_step     b g b
-  // line_step2    g r g
-  // rgb_pixel[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg3(bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] =
-    avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-  // BGBG line
-  // Bayer         0 1 2
-  //         0     g r g
-  // line_step     B g b
-  // line_step2    g r g
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step] =
-    avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 1] = avg3(
-    bayer_pixel[0], bayer_pixel[bayer_line_step + 1],
-    bayer_pixel[bayer_line_step2]);
-  // rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-  // pixel (1, 1)  0 1 2
-  //         0     g r g
-  // line_step     b G b
-  // line_step2    g r g
-  // rgb_pixel[rgb_line_step + 3] = avg(bayer_pixel[1] , bayer_pixel[line_step2+1] );
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  // rgb_pixel[rgb_line_step + 5] = avg(bayer_pixel[line_step] , bayer_pixel[line_step+2]);
-
-  rgb_buffer += 6;
-  bayer_pixel += 2;
-
-  // rest of the first two lines
-  for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2) {
-    // GRGR line
-    // Bayer        -1 0 1 2
-    //           0   r G r g
-    //   line_step   g b g b
-    // line_step2    r g r g
-    rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
-
-    // Bayer        -1 0 1 2
-    //          0    r g R g
-    //  line_step    g b g b
-    // line_step2    r g r g
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg3(bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] =
-      avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    // BGBG line
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g B g b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step] = avg4(
-      bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-      bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = avg4(
-      bayer_pixel[0], bayer_pixel[bayer_line_step2],
-      bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g b G b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    // rgb_pixel[rgb_line_step + 5] = avg(bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+  auto mirror = [width](int x) {
+      return x < 0 ? -x : (x >= width ? 2 * width - 2 - x : x);
+    };
+  auto border = [&](int x) {
+      debayerPixel<T, W, RowColor, Weighted>(
+        prev, cur, next, out, x, mirror(x - 1), mirror(x + 1), (x & 1) == green_phase);
+    };
+
+  // Leading border columns, up to the first green sample with a left neighbour
+  int x = 0;
+  const int first = green_phase == 1 ? 1 : 2;
+  for (; x < first; ++x) {
+    border(x);
   }
 
-  // last two pixel values for first two lines
-  // GRGR line
-  // Bayer        -1 0 1
-  //           0   r G r
-  //   line_step   g b g
-  // line_step2    r g r
-  rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-  rgb_buffer[1] = bayer_pixel[0];
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] =
-    rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-
-  // Bayer        -1 0 1
-  //          0    r g R
-  //  line_step    g b g
-  // line_step2    r g r
-  rgb_buffer[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-  // rgb_pixel[5] = bayer_pixel[line_step];
-
-  // BGBG line
-  // Bayer        -1 0 1
-  //          0    r g r
-  //  line_step    g B g
-  // line_step2    r g r
-  rgb_buffer[rgb_line_step] = avg4(
-    bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-    bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-  rgb_buffer[rgb_line_step + 1] = avg4(
-    bayer_pixel[0], bayer_pixel[bayer_line_step2],
-    bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-  // rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-  // Bayer         -1 0 1
-  //         0      r g r
-  // line_step      g b G
-  // line_step2     r g r
-  rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  // rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-  bayer_pixel += bayer_line_step + 2;
-  rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
-
-  // main processing
-  for (yIdx = 2; yIdx < height - 2; yIdx += 2) {
-    // first two pixel values
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     G r g
-    // line_step     b g b
-    // line_step2    g r g
-
-    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1];  // red pixel
-    rgb_buffer[1] = bayer_pixel[0];  // green pixel
-    rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);  // blue;
-
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     g R g
-    // line_step     b g b
-    // line_step2    g r g
-    // rgb_pixel[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg4(
-      bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1],
-      bayer_pixel[1 - bayer_line_step]);
-    rgb_buffer[5] = avg4(
-      bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2],
-      bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-
-    // BGBG line
-    // Bayer         0 1 2
-    //         0     g r g
-    // line_step     B g b
-    // line_step2    g r g
-    rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step] =
-      avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 1] = avg3(
-      bayer_pixel[0], bayer_pixel[bayer_line_step + 1],
-      bayer_pixel[bayer_line_step2]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // pixel (1, 1)  0 1 2
-    //         0     g r g
-    // line_step     b G b
-    // line_step2    g r g
-    // rgb_pixel[rgb_line_step + 3] = avg(bayer_pixel[1] , bayer_pixel[line_step2+1] );
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    rgb_buffer[rgb_line_step + 5] =
-      avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    rgb_buffer += 6;
-    bayer_pixel += 2;
-
-    // continue with rest of the line
-    for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2) {
-      // GRGR line
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //           0   r G r g
-      //   line_step   g b g b
-      // line_step2    r g r g
-      rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-      rgb_buffer[1] = bayer_pixel[0];
-      rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //          0    r g R g
-      //  line_step    g b g b
-      // line_step2    r g r g
-
-      dh = std::abs(bayer_pixel[0] - bayer_pixel[2]);
-      dv = std::abs(bayer_pixel[-bayer_line_step + 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dv == 0 && dh == 0) {
-        rgb_buffer[4] = avg4(
-          bayer_pixel[1 - bayer_line_step], bayer_pixel[1 + bayer_line_step],
-          bayer_pixel[0], bayer_pixel[2]);
-      } else {
-        rgb_buffer[4] = wavg4(
-          bayer_pixel[1 - bayer_line_step], bayer_pixel[1 + bayer_line_step],
-          bayer_pixel[0], bayer_pixel[2], dh, dv);
-      }
-
-      rgb_buffer[3] = bayer_pixel[1];
-      rgb_buffer[5] = avg4(
-        bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step],
-        bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-      // BGBG line
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g B g b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step] = avg4(
-        bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-        bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-      rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-      dv = std::abs(bayer_pixel[0] - bayer_pixel[bayer_line_step2]);
-      dh = std::abs(bayer_pixel[bayer_line_step - 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dv == 0 && dh == 0) {
-        rgb_buffer[rgb_line_step + 1] = avg4(
-          bayer_pixel[0], bayer_pixel[bayer_line_step2],
-          bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-      } else {
-        rgb_buffer[rgb_line_step + 1] = wavg4(
-          bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1],
-          bayer_pixel[bayer_line_step + 1], dh, dv);
-      }
-
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g b G b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step + 3] =
-        avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-      rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-      rgb_buffer[rgb_line_step + 5] =
-        avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-    }
-
-    // last two pixels of the line
-    // last two pixel values for first two lines
-    // GRGR line
-    // Bayer        -1 0 1
-    //           0   r G r
-    //   line_step   g b g
-    // line_step2    r g r
-    rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] =
-      rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-
-    // Bayer        -1 0 1
-    //          0    r g R
-    //  line_step    g b g
-    // line_step2    r g r
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-    // rgb_pixel[5] = bayer_pixel[line_step];
-
-    // BGBG line
-    // Bayer        -1 0 1
-    //          0    r g r
-    //  line_step    g B g
-    // line_step2    r g r
-    rgb_buffer[rgb_line_step] = avg4(
-      bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1],
-      bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = avg4(
-      bayer_pixel[0], bayer_pixel[bayer_line_step2],
-      bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    // rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-    // Bayer         -1 0 1
-    //         0      r g r
-    // line_step      g b G
-    // line_step2     r g r
-    rgb_buffer[rgb_line_step + 3] = avg(bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    // rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-    bayer_pixel += bayer_line_step + 2;
-    rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+  // Interior: a green sample at x followed by a red or blue sample at x + 1
+  for (; x + 2 < width; x += 2) {
+    debayerPixel<T, W, RowColor, Weighted>(prev, cur, next, out, x, x - 1, x + 1, true);
+    debayerPixel<T, W, RowColor, Weighted>(prev, cur, next, out, x + 1, x, x + 2, false);
   }
 
-  // last two lines
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     G r g
-  // line_step     b g b
-
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step] =
-    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1];  // red pixel
-  rgb_buffer[1] = bayer_pixel[0];  // green pixel
-  rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step];  // blue;
-
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     g R g
-  // line_step     b g b
-  // rgb_pixel[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg4(
-    bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1],
-    bayer_pixel[1 - bayer_line_step]);
-  rgb_buffer[5] = avg4(
-    bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2],
-    bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-
-  // BGBG line
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     g r g
-  // line_step     B g b
-  // rgb_pixel[rgb_line_step] = bayer_pixel[1];
-  rgb_buffer[rgb_line_step + 1] = avg(bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-  // Bayer         0 1 2
-  //        -1     b g b
-  //         0     g r g
-  // line_step     b G b
-  // rgb_pixel[rgb_line_step + 3] = avg(bayer_pixel[1] , bayer_pixel[line_step2+1] );
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  rgb_buffer[rgb_line_step + 5] =
-    avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-  rgb_buffer += 6;
-  bayer_pixel += 2;
+  for (; x < width; ++x) {
+    border(x);
+  }
+}
 
-  // rest of the last two lines
-  for (xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2) {
-    // GRGR line
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r G r g
-    // line_step    g b g b
-    rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+template<typename T, bool Weighted>
+void debayerImage(const cv::Mat & bayer, cv::Mat & color, BayerPattern pattern)
+{
+  // The weighted average of 16-bit samples overflows 32 bits
+  using W = typename std::conditional<Weighted && sizeof(T) == 2, int64_t, int>::type;
+
+  const bool red_first =
+    pattern == BayerPattern::RGGB || pattern == BayerPattern::GRBG;
+  const int green_phase_first =
+    (pattern == BayerPattern::GRBG || pattern == BayerPattern::GBRG) ? 0 : 1;
+  const int rows = bayer.rows;
+  const int width = bayer.cols;
+
+  cv::parallel_for_(
+    cv::Range(0, rows), [&](const cv::Range & range) {
+      for (int y = range.start; y < range.end; ++y) {
+        // Mirroring keeps the Bayer phase of the neighbouring rows intact
+        const T * prev = bayer.ptr<T>(y == 0 ? 1 : y - 1);
+        const T * cur = bayer.ptr<T>(y);
+        const T * next = bayer.ptr<T>(y == rows - 1 ? rows - 2 : y + 1);
+        T * out = color.ptr<T>(y);
+
+        const int odd = y & 1;
+        const int green_phase = green_phase_first ^ odd;
+        if (red_first != (odd == 1)) {
+          debayerRow<T, W, kRed, Weighted>(prev, cur, next, out, width, green_phase);
+        } else {
+          debayerRow<T, W, kBlue, Weighted>(prev, cur, next, out, width, green_phase);
+        }
+      }
+    });
+}
 
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r g R g
-    // line_step    g b g b
-    rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = avg4(
-      bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1],
-      bayer_pixel[1 - bayer_line_step]);
-    rgb_buffer[5] = avg4(
-      bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2],
-      bayer_pixel[-bayer_line_step], bayer_pixel[-bayer_line_step + 2]);
+template<bool Weighted>
+void debayer(const cv::Mat & bayer, cv::Mat & color, BayerPattern pattern)
+{
+  CV_Assert(bayer.channels() == 1);
+  CV_Assert(bayer.depth() == CV_8U || bayer.depth() == CV_16U);
+  CV_Assert(bayer.rows >= 2 && bayer.cols >= 2);
 
-    // BGBG line
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r g r g
-    // line_step    g B g b
-    rgb_buffer[rgb_line_step] = avg(bayer_pixel[-1], bayer_pixel[1]);
-    rgb_buffer[rgb_line_step + 1] =
-      avg3(bayer_pixel[0], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+  color.create(bayer.size(), CV_MAKETYPE(bayer.depth(), 3));
 
-    // Bayer       -1 0 1 2
-    //        -1    g b g b
-    //         0    r g r g
-    // line_step    g b G b
-    // rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    rgb_buffer[rgb_line_step + 5] =
-      avg(bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+  if (bayer.depth() == CV_8U) {
+    debayerImage<uint8_t, Weighted>(bayer, color, pattern);
+  } else {
+    debayerImage<uint16_t, Weighted>(bayer, color, pattern);
   }
+}
 
-  // last two pixel values for first two lines
-  // GRGR line
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r G r
-  // line_step    g b g
-  rgb_buffer[rgb_line_step] = rgb_buffer[0] = avg(bayer_pixel[1], bayer_pixel[-1]);
-  rgb_buffer[1] = bayer_pixel[0];
-  rgb_buffer[5] = rgb_buffer[2] = avg(bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r g R
-  // line_step    g b g
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[3] = bayer_pixel[1];
-  rgb_buffer[4] = avg3(
-    bayer_pixel[0], bayer_pixel[bayer_line_step + 1],
-    bayer_pixel[-bayer_line_step + 1]);
-  // rgb_pixel[5] = avg(bayer_pixel[line_step], bayer_pixel[-line_step] );
+}  // namespace
 
-  // BGBG line
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r g r
-  // line_step    g B g
-  // rgb_pixel[rgb_line_step] = avg2(bayer_pixel[-1], bayer_pixel[1] );
-  rgb_buffer[rgb_line_step + 1] = avg3(
-    bayer_pixel[0], bayer_pixel[bayer_line_step - 1],
-    bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+void debayerEdgeAware(const cv::Mat & bayer, cv::Mat & color, BayerPattern pattern)
+{
+  debayer<false>(bayer, color, pattern);
+}
 
-  // Bayer       -1 0 1
-  //        -1    g b g
-  //         0    r g r
-  // line_step    g b G
-  // rgb_pixel[rgb_line_step + 3] = bayer_pixel[1];
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  // rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+void debayerEdgeAwareWeighted(const cv::Mat & bayer, cv::Mat & color, BayerPattern pattern)
+{
+  debayer<true>(bayer, color, pattern);
 }
 
 }  // namespace image_proc
@@ -0,0 +1,70 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+
+#include <image_proc/backend.hpp>
+#include <opencv2/core/ocl.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+Backend declareBackendParameter(rclcpp::Node * node)
+{
+  const std::string backend = node->declare_parameter<std::string>("backend", "cpu");
+
+  if (backend == "cpu") {
+    return Backend::CPU;
+  }
+
+  if (backend == "opencl") {
+    if (!cv::ocl::haveOpenCL()) {
+      RCLCPP_WARN(
+        node->get_logger(), "OpenCL backend requested, but no OpenCL device is available. "
+        "Falling back to the CPU.");
+      return Backend::CPU;
+    }
+    cv::ocl::setUseOpenCL(true);
+    RCLCPP_INFO(
+      node->get_logger(), "Using OpenCL device '%s'",
+      cv::ocl::Device::getDefault().name().c_str());
+    return Backend::OPENCL;
+  }
+
+  RCLCPP_WARN(
+    node->get_logger(), "Unknown backend '%s', valid values are 'cpu' and 'opencl'. "
+    "Falling back to the CPU.", backend.c_str());
+  return Backend::CPU;
+}
+
+}  // namespace image_proc
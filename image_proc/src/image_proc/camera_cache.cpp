@@ -0,0 +1,154 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <utility>
+
+#include <image_geometry/pinhole_camera_model.hpp>
+#include <image_geometry/stereo_camera_model.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/rectification_maps.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace image_proc
+{
+
+struct CameraCache::Impl
+{
+  mutable std::mutex mutex;
+  std::map<std::pair<std::type_index, uint64_t>, std::weak_ptr<const void>> entries;
+  Statistics statistics;
+
+  // Forget the entries nobody uses anymore
+  void prune()
+  {
+    for (auto it = entries.begin(); it != entries.end(); ) {
+      if (it->second.expired()) {
+        it = entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+};
+
+CameraCache::CameraCache()
+: impl_(std::make_shared<Impl>())
+{
+}
+
+CameraCache & CameraCache::instance()
+{
+  static CameraCache cache;
+  return cache;
+}
+
+std::shared_ptr<const image_geometry::PinholeCameraModel> CameraCache::pinholeModel(
+  const sensor_msgs::msg::CameraInfo & info)
+{
+  return get<image_geometry::PinholeCameraModel>(
+    hashCameraInfo(info), [&info]() {
+      auto model = std::make_shared<image_geometry::PinholeCameraModel>();
+      model->fromCameraInfo(info);
+      return model;
+    });
+}
+
+std::shared_ptr<const image_geometry::StereoCameraModel> CameraCache::stereoModel(
+  const sensor_msgs::msg::CameraInfo & left, const sensor_msgs::msg::CameraInfo & right)
+{
+  return get<image_geometry::StereoCameraModel>(
+    combineKeys(hashCameraInfo(left), hashCameraInfo(right)), [&left, &right]() {
+      auto model = std::make_shared<image_geometry::StereoCameraModel>();
+      model->fromCameraInfo(left, right);
+      return model;
+    });
+}
+
+std::shared_ptr<const RectificationMaps> CameraCache::rectificationMaps(
+  const sensor_msgs::msg::CameraInfo & info)
+{
+  return get<RectificationMaps>(
+    hashCameraInfo(info), [&info]() {
+      auto maps = std::make_shared<RectificationMaps>();
+      maps->update(info);
+      return maps;
+    });
+}
+
+CameraCache::Statistics CameraCache::statistics() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  Statistics statistics = impl_->statistics;
+  statistics.entries = 0;
+  for (const auto & entry : impl_->entries) {
+    statistics.entries += entry.second.expired() ? 0 : 1;
+  }
+  return statistics;
+}
+
+std::shared_ptr<const void> CameraCache::find(std::type_index type, uint64_t key)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  auto it = impl_->entries.find({type, key});
+  std::shared_ptr<const void> data;
+  if (it != impl_->entries.end()) {
+    data = it->second.lock();
+  }
+  if (data) {
+    ++impl_->statistics.hits;
+  } else {
+    ++impl_->statistics.misses;
+  }
+  return data;
+}
+
+std::shared_ptr<const void> CameraCache::store(
+  std::type_index type, uint64_t key, std::shared_ptr<const void> data)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->prune();
+  auto & entry = impl_->entries[{type, key}];
+  if (auto stored = entry.lock()) {
+    // Another node built it meanwhile
+    return stored;
+  }
+  entry = data;
+  return data;
+}
+
+}  // namespace image_proc
@@ -0,0 +1,183 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <image_proc/change_detection.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+uint32_t sumBytes(const uint8_t * data, size_t size)
+{
+  size_t i = 0;
+  uint32_t sum = 0;
+#if CV_SIMD128
+  cv::v_uint32x4 v_sum = cv::v_setzero_u32();
+  for (; i + 16 <= size; i += 16) {
+    cv::v_uint16x8 lo, hi;
+    cv::v_expand(cv::v_load(data + i), lo, hi);
+    cv::v_uint32x4 a, b;
+    cv::v_expand(lo + hi, a, b);
+    v_sum = v_sum + a + b;
+  }
+  sum = cv::v_reduce_sum(v_sum);
+#endif
+  for (; i < size; ++i) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+}  // namespace
+
+ChangeDetection::ChangeDetection(rclcpp::Node * node)
+: ChangeDetection(Mode::OFF, 0.0, 1)
+{
+  const std::string mode = node->declare_parameter<std::string>("change_detection", "");
+  threshold_ = std::max(node->declare_parameter("change_threshold", 0.0), 0.0);
+  step_ = std::max(node->declare_parameter("change_detection_step", 4), 1);
+
+  if (mode == "skip") {
+    mode_ = Mode::SKIP;
+  } else if (mode == "republish") {
+    mode_ = Mode::REPUBLISH;
+  } else if (!mode.empty()) {
+    RCLCPP_WARN(
+      node->get_logger(), "Unknown change_detection '%s', valid values are '', 'skip' and "
+      "'republish'. Processing every frame.", mode.c_str());
+  }
+}
+
+ChangeDetection::ChangeDetection(Mode mode, double threshold, int step)
+: mode_(mode),
+  threshold_(std::max(threshold, 0.0)),
+  step_(std::max(step, 1)),
+  has_reference_(false)
+{
+}
+
+void ChangeDetection::blockSums(
+  const sensor_msgs::msg::Image & image, int step, std::vector<uint32_t> & sums)
+{
+  sums.assign(BLOCKS * BLOCKS, 0);
+  const size_t row_bytes = image.step;
+  if (row_bytes == 0) {
+    return;
+  }
+  const size_t rows = std::min<size_t>(image.height, image.data.size() / row_bytes);
+
+  for (size_t y = 0; y < rows; y += step) {
+    const uint8_t * row = image.data.data() + y * row_bytes;
+    uint32_t * block_row = sums.data() + (y * BLOCKS / rows) * BLOCKS;
+    for (size_t x = 0; x < static_cast<size_t>(BLOCKS); ++x) {
+      const size_t begin = row_bytes * x / BLOCKS;
+      const size_t end = row_bytes * (x + 1) / BLOCKS;
+      block_row[x] += sumBytes(row + begin, end - begin);
+    }
+  }
+}
+
+void ChangeDetection::sign(
+  const std::vector<const sensor_msgs::msg::Image *> & images, uint64_t inputs,
+  Signature & signature) const
+{
+  signature.inputs = inputs;
+  signature.samples = 0.0;
+  signature.sums.clear();
+  std::vector<uint32_t> sums;
+  for (const sensor_msgs::msg::Image * image : images) {
+    signature.width.push_back(image->width);
+    signature.height.push_back(image->height);
+    signature.encoding.push_back(image->encoding);
+    blockSums(*image, step_, sums);
+    signature.sums.insert(signature.sums.end(), sums.begin(), sums.end());
+    if (image->step > 0) {
+      const size_t rows = std::min<size_t>(image->height, image->data.size() / image->step);
+      signature.samples += static_cast<double>((rows + step_ - 1) / step_) * image->step;
+    }
+  }
+}
+
+bool ChangeDetection::unchanged(const sensor_msgs::msg::Image & image, uint64_t inputs)
+{
+  return unchanged(std::vector<const sensor_msgs::msg::Image *>{&image}, inputs);
+}
+
+bool ChangeDetection::unchanged(
+  const std::vector<const sensor_msgs::msg::Image *> & images, uint64_t inputs)
+{
+  if (mode_ == Mode::OFF) {
+    return false;
+  }
+
+  Signature signature;
+  sign(images, inputs, signature);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (has_reference_ && signature.inputs == reference_.inputs &&
+    signature.width == reference_.width && signature.height == reference_.height &&
+    signature.encoding == reference_.encoding)
+  {
+    double difference = 0.0;
+    for (size_t i = 0; i < signature.sums.size(); ++i) {
+      difference += std::abs(
+        static_cast<double>(signature.sums[i]) - static_cast<double>(reference_.sums[i]));
+    }
+    if (difference <= threshold_ * signature.samples) {
+      return true;
+    }
+  }
+
+  reference_ = std::move(signature);
+  has_reference_ = true;
+  return false;
+}
+
+void ChangeDetection::reset()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  has_reference_ = false;
+}
+
+}  // namespace image_proc
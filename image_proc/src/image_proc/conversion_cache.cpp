@@ -0,0 +1,134 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <cv_bridge/cv_bridge.hpp>
+#include <image_proc/conversion_cache.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+struct ConversionCache::Impl
+{
+  struct Entry
+  {
+    std::weak_ptr<const sensor_msgs::msg::Image> message;
+    cv_bridge::CvImageConstPtr image;
+  };
+
+  mutable std::mutex mutex;
+  std::map<std::pair<const sensor_msgs::msg::Image *, std::string>, Entry> entries;
+  Statistics statistics;
+
+  // Forget the conversions of messages nobody uses anymore
+  void prune()
+  {
+    for (auto it = entries.begin(); it != entries.end(); ) {
+      if (it->second.message.expired()) {
+        it = entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+};
+
+ConversionCache::ConversionCache()
+: impl_(std::make_shared<Impl>())
+{
+}
+
+ConversionCache & ConversionCache::instance()
+{
+  static ConversionCache cache;
+  return cache;
+}
+
+cv_bridge::CvImageConstPtr ConversionCache::toCvShare(
+  const sensor_msgs::msg::Image::ConstSharedPtr & msg, const std::string & encoding)
+{
+  // Nothing to convert, the image is a view of the message
+  if (encoding.empty() || encoding == msg->encoding) {
+    return cv_bridge::toCvShare(msg, encoding);
+  }
+
+  // The entry of a message freed since may have a new message at its address
+  const auto key = std::make_pair(msg.get(), encoding);
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->entries.find(key);
+    if (it != impl_->entries.end() && it->second.message.lock() == msg) {
+      ++impl_->statistics.hits;
+      return it->second.image;
+    }
+    ++impl_->statistics.misses;
+  }
+
+  cv_bridge::CvImageConstPtr image = cv_bridge::toCvShare(msg, encoding);
+
+  // A view of the message would keep it alive through its entry
+  const uint8_t * data = image->image.datastart;
+  if (data >= msg->data.data() && data < msg->data.data() + msg->data.size()) {
+    return image;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->prune();
+  auto & entry = impl_->entries[key];
+  if (entry.message.lock() == msg) {
+    // Another node converted it meanwhile
+    return entry.image;
+  }
+  entry.message = msg;
+  entry.image = image;
+  return image;
+}
+
+ConversionCache::Statistics ConversionCache::statistics() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  Statistics statistics = impl_->statistics;
+  statistics.entries = 0;
+  for (const auto & entry : impl_->entries) {
+    statistics.entries += entry.second.message.expired() ? 0 : 1;
+  }
+  return statistics;
+}
+
+}  // namespace image_proc
@@ -0,0 +1,231 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <image_proc/decimate.hpp>
+
+#include <opencv2/core/utility.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Element offsets of the R, G1, G2 and B samples within a 2x2 Bayer cell
+bool getBayerOffsets(
+  const std::string & encoding, int step, int & R, int & G1, int & G2, int & B)
+{
+  namespace enc = sensor_msgs::image_encodings;
+  if (encoding == enc::BAYER_RGGB8 || encoding == enc::BAYER_RGGB16) {
+    R = 0;
+    G1 = 1;
+    G2 = step;
+    B = step + 1;
+  } else if (encoding == enc::BAYER_BGGR8 || encoding == enc::BAYER_BGGR16) {
+    R = step + 1;
+    G1 = 1;
+    G2 = step;
+    B = 0;
+  } else if (encoding == enc::BAYER_GBRG8 || encoding == enc::BAYER_GBRG16) {
+    R = step;
+    G1 = 0;
+    G2 = step + 1;
+    B = 1;
+  } else if (encoding == enc::BAYER_GRBG8 || encoding == enc::BAYER_GRBG16) {
+    R = 1;
+    G1 = 0;
+    G2 = step + 1;
+    B = step;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Decimate and debayer a (cropped) Bayer image to BGR in one pass. Each output
+// pixel comes from the 2x2 cells of its decimation_x by decimation_y block:
+// the top-left cell only, or with Bin all cells averaged. D > 0 fixes both
+// factors at compile time so the cell loops unroll.
+template<typename T, int D, bool Bin>
+void cropDecimateBayer(
+  const cv::Mat & src, cv::Mat & dst, int decimation_x, int decimation_y,
+  int R, int G1, int G2, int B)
+{
+  const int dx = D > 0 ? D : decimation_x;
+  const int dy = D > 0 ? D : decimation_y;
+  dst.create(src.rows / dy, src.cols / dx, CV_MAKETYPE(sizeof(T) == 1 ? CV_8U : CV_16U, 3));
+
+  const int cells_x = dx / 2;
+  const int cells_y = dy / 2;
+  const int cells = cells_x * cells_y;
+  const size_t src_row_step = src.step1();
+
+  cv::parallel_for_(
+    cv::Range(0, dst.rows), [&](const cv::Range & range) {
+      for (int y = range.start; y < range.end; ++y) {
+        const T * src_row = src.ptr<T>(y * dy);
+        T * dst_row = dst.ptr<T>(y);
+
+        for (int x = 0; x < dst.cols; ++x) {
+          const T * block = src_row + x * dx;
+
+          if (!Bin) {
+            dst_row[x * 3 + 0] = block[B];
+            dst_row[x * 3 + 1] = (block[G1] + block[G2]) / 2;
+            dst_row[x * 3 + 2] = block[R];
+            continue;
+          }
+
+          int sum_b = 0, sum_g = 0, sum_r = 0;
+          for (int cy = 0; cy < cells_y; ++cy) {
+            const T * cell = block + 2 * cy * src_row_step;
+            for (int cx = 0; cx < cells_x; ++cx, cell += 2) {
+              sum_b += cell[B];
+              sum_g += cell[G1] + cell[G2];
+              sum_r += cell[R];
+            }
+          }
+          dst_row[x * 3 + 0] = static_cast<T>((sum_b + cells / 2) / cells);
+          dst_row[x * 3 + 1] = static_cast<T>((sum_g + cells) / (2 * cells));
+          dst_row[x * 3 + 2] = static_cast<T>((sum_r + cells / 2) / cells);
+        }
+      }
+    });
+}
+
+template<typename T, bool Bin>
+void cropDecimateBayer(
+  const cv::Mat & src, cv::Mat & dst, int decimation_x, int decimation_y,
+  int R, int G1, int G2, int B)
+{
+  if (decimation_x == decimation_y && decimation_x == 2) {
+    cropDecimateBayer<T, 2, Bin>(src, dst, 2, 2, R, G1, G2, B);
+  } else if (decimation_x == decimation_y && decimation_x == 4) {
+    cropDecimateBayer<T, 4, Bin>(src, dst, 4, 4, R, G1, G2, B);
+  } else if (decimation_x == decimation_y && decimation_x == 8) {
+    cropDecimateBayer<T, 8, Bin>(src, dst, 8, 8, R, G1, G2, B);
+  } else {
+    cropDecimateBayer<T, 0, Bin>(src, dst, decimation_x, decimation_y, R, G1, G2, B);
+  }
+}
+
+// Templated on pixel size, in bytes (MONO8 = 1, BGR8 = 3, RGBA16 = 8, ...)
+template<int N>
+void decimatePixels(const cv::Mat & src, cv::Mat & dst, int decimation_x, int decimation_y)
+{
+  dst.create(src.rows / decimation_y, src.cols / decimation_x, src.type());
+
+  int src_row_step = src.step[0] * decimation_y;
+  int src_pixel_step = N * decimation_x;
+  int dst_row_step = dst.step[0];
+
+  const uint8_t * src_row = src.ptr();
+  uint8_t * dst_row = dst.ptr();
+
+  for (int y = 0; y < dst.rows; ++y) {
+    const uint8_t * src_pixel = src_row;
+    uint8_t * dst_pixel = dst_row;
+
+    for (int x = 0; x < dst.cols; ++x) {
+      memcpy(dst_pixel, src_pixel, N);  // Should inline with small, fixed N
+      src_pixel += src_pixel_step;
+      dst_pixel += N;
+    }
+
+    src_row += src_row_step;
+    dst_row += dst_row_step;
+  }
+}
+
+}  // namespace
+
+bool decimate(const cv::Mat & src, cv::Mat & dst, int decimation_x, int decimation_y)
+{
+  switch (src.elemSize()) {
+    // Currently support up through 4-channel float
+    case 1:
+      decimatePixels<1>(src, dst, decimation_x, decimation_y);
+      break;
+    case 2:
+      decimatePixels<2>(src, dst, decimation_x, decimation_y);
+      break;
+    case 3:
+      decimatePixels<3>(src, dst, decimation_x, decimation_y);
+      break;
+    case 4:
+      decimatePixels<4>(src, dst, decimation_x, decimation_y);
+      break;
+    case 6:
+      decimatePixels<6>(src, dst, decimation_x, decimation_y);
+      break;
+    case 8:
+      decimatePixels<8>(src, dst, decimation_x, decimation_y);
+      break;
+    case 12:
+      decimatePixels<12>(src, dst, decimation_x, decimation_y);
+      break;
+    case 16:
+      decimatePixels<16>(src, dst, decimation_x, decimation_y);
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+bool decimateBayer(
+  const cv::Mat & bayer, const std::string & encoding, cv::Mat & bgr,
+  int decimation_x, int decimation_y, bool bin)
+{
+  int R, G1, G2, B;
+  if (!getBayerOffsets(encoding, bayer.step1(), R, G1, G2, B)) {
+    return false;
+  }
+
+  if (bayer.depth() == CV_16U && bin) {
+    cropDecimateBayer<uint16_t, true>(bayer, bgr, decimation_x, decimation_y, R, G1, G2, B);
+  } else if (bayer.depth() == CV_16U) {
+    cropDecimateBayer<uint16_t, false>(bayer, bgr, decimation_x, decimation_y, R, G1, G2, B);
+  } else if (bin) {
+    cropDecimateBayer<uint8_t, true>(bayer, bgr, decimation_x, decimation_y, R, G1, G2, B);
+  } else {
+    cropDecimateBayer<uint8_t, false>(bayer, bgr, decimation_x, decimation_y, R, G1, G2, B);
+  }
+  return true;
+}
+
+}  // namespace image_proc
@@ -0,0 +1,143 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <image_proc/frame_scheduler.hpp>
+
+namespace image_proc
+{
+
+FrameScheduler::FrameScheduler(
+  size_t streams, size_t threads, size_t queue_depth, Clock::duration deadline)
+: queue_depth_(std::max<size_t>(queue_depth, 1)),
+  deadline_(deadline),
+  streams_(streams)
+{
+  // No more workers than streams, as a stream runs one frame at a time
+  const size_t workers = std::max<size_t>(std::min(threads, streams), 1);
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back(&FrameScheduler::run, this);
+  }
+}
+
+FrameScheduler::~FrameScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (Stream & stream : streams_) {
+      stream.pending.clear();
+    }
+  }
+  ready_.notify_all();
+  for (std::thread & worker : workers_) {
+    worker.join();
+  }
+}
+
+bool FrameScheduler::submit(size_t stream, Work work)
+{
+  Work displaced;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || stream >= streams_.size()) {
+      return false;
+    }
+    std::deque<Frame> & pending = streams_[stream].pending;
+    if (pending.size() >= queue_depth_) {
+      displaced = std::move(pending.front().work);
+      pending.pop_front();
+    }
+    // Without a deadline frames are still served by arrival
+    pending.push_back(Frame{Clock::now() + deadline_, std::move(work)});
+  }
+  ready_.notify_one();
+
+  if (displaced) {
+    displaced(false);
+    return false;
+  }
+  return true;
+}
+
+size_t FrameScheduler::next() const
+{
+  size_t first = streams_.size();
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    const Stream & stream = streams_[i];
+    if (stream.running || stream.pending.empty()) {
+      continue;
+    }
+    if (first == streams_.size() ||
+      stream.pending.front().due < streams_[first].pending.front().due)
+    {
+      first = i;
+    }
+  }
+  return first;
+}
+
+void FrameScheduler::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    size_t index;
+    ready_.wait(lock, [&] {return stopping_ || (index = next()) != streams_.size();});
+    if (stopping_) {
+      return;
+    }
+
+    Stream & stream = streams_[index];
+    Frame frame = std::move(stream.pending.front());
+    stream.pending.pop_front();
+    const bool late = deadline_ != Clock::duration::zero() && Clock::now() > frame.due;
+
+    // Call the work unlocked, the stream running so its next frame waits
+    stream.running = true;
+    lock.unlock();
+    frame.work(!late);
+    frame.work = nullptr;
+    lock.lock();
+    stream.running = false;
+
+    // Another worker may take the next frame of the stream
+    ready_.notify_one();
+  }
+}
+
+}  // namespace image_proc
@@ -0,0 +1,155 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <image_proc/image_buffer_pool.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Bucket granularity. Frames of one resolution and encoding share a bucket.
+constexpr size_t kBucketAlignment = 4096;
+
+size_t bucketSize(size_t size)
+{
+  return (size + kBucketAlignment - 1) / kBucketAlignment * kBucketAlignment;
+}
+
+}  // namespace
+
+struct ImageBufferPool::Impl
+{
+  mutable std::mutex mutex;
+  std::map<size_t, std::vector<std::unique_ptr<sensor_msgs::msg::Image>>> buckets;
+  Statistics statistics;
+  size_t max_pooled_bytes = 256 * 1024 * 1024;
+
+  void release(sensor_msgs::msg::Image * msg, size_t bucket)
+  {
+    std::unique_ptr<sensor_msgs::msg::Image> owned(msg);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (statistics.pooled_bytes + bucket > max_pooled_bytes) {
+      ++statistics.evictions;
+      return;
+    }
+    ++statistics.returns;
+    statistics.pooled_bytes += bucket;
+    buckets[bucket].push_back(std::move(owned));
+  }
+};
+
+ImageBufferPool::ImageBufferPool()
+: impl_(std::make_shared<Impl>())
+{
+}
+
+ImageBufferPool & ImageBufferPool::instance()
+{
+  static ImageBufferPool pool;
+  return pool;
+}
+
+sensor_msgs::msg::Image::SharedPtr ImageBufferPool::acquire(size_t size)
+{
+  const size_t bucket = bucketSize(size);
+  std::unique_ptr<sensor_msgs::msg::Image> msg;
+
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->buckets.find(bucket);
+    if (it != impl_->buckets.end() && !it->second.empty()) {
+      msg = std::move(it->second.back());
+      it->second.pop_back();
+      impl_->statistics.pooled_bytes -= bucket;
+      ++impl_->statistics.hits;
+    } else {
+      ++impl_->statistics.misses;
+    }
+  }
+
+  if (!msg) {
+    msg = std::make_unique<sensor_msgs::msg::Image>();
+    msg->data.reserve(bucket);
+  }
+  msg->data.resize(size);
+
+  // The pool may be gone by the time the last subscriber lets go
+  std::weak_ptr<Impl> weak_impl = impl_;
+  return sensor_msgs::msg::Image::SharedPtr(
+    msg.release(), [weak_impl, bucket](sensor_msgs::msg::Image * released) {
+      if (auto impl = weak_impl.lock()) {
+        impl->release(released, bucket);
+      } else {
+        delete released;
+      }
+    });
+}
+
+ImageBufferPool::Statistics ImageBufferPool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->statistics;
+}
+
+size_t ImageBufferPool::maxPooledBytes() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->max_pooled_bytes;
+}
+
+void ImageBufferPool::setMaxPooledBytes(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->max_pooled_bytes = bytes;
+  // Trim idle buffers, largest first
+  for (auto it = impl_->buckets.rbegin();
+    it != impl_->buckets.rend() && impl_->statistics.pooled_bytes > bytes; ++it)
+  {
+    while (!it->second.empty() && impl_->statistics.pooled_bytes > bytes) {
+      it->second.pop_back();
+      impl_->statistics.pooled_bytes -= it->first;
+      ++impl_->statistics.evictions;
+    }
+  }
+}
+
+}  // namespace image_proc
@@ -0,0 +1,136 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <memory>
+#include <string>
+
+#include <image_proc/image_buffer_pool.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_transport/camera_publisher.hpp>
+#include <image_transport/publisher.hpp>
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Fill in the metadata of msg, whose data must already hold the pixels
+cv::Mat initImageMessage(
+  sensor_msgs::msg::Image & msg, const std_msgs::msg::Header & header,
+  const std::string & encoding, int rows, int cols, int type)
+{
+  msg.header = header;
+  msg.encoding = encoding;
+  msg.height = rows;
+  msg.width = cols;
+  msg.is_bigendian = false;
+  msg.step = static_cast<uint32_t>(cols * CV_ELEM_SIZE(type));
+  return cv::Mat(rows, cols, type, msg.data.data(), msg.step);
+}
+
+}  // namespace
+
+sensor_msgs::msg::Image::UniquePtr createImageMessage(
+  const std_msgs::msg::Header & header, const std::string & encoding,
+  int rows, int cols, int type, cv::Mat & view)
+{
+  auto msg = std::make_unique<sensor_msgs::msg::Image>();
+  msg->data.resize(static_cast<size_t>(cols) * CV_ELEM_SIZE(type) * rows);
+  view = initImageMessage(*msg, header, encoding, rows, cols, type);
+  return msg;
+}
+
+void finishImageMessage(const cv::Mat & view, sensor_msgs::msg::Image & msg)
+{
+  if (view.data == msg.data.data() && static_cast<int>(msg.width) == view.cols &&
+    view.rows * view.step[0] == msg.data.size())
+  {
+    return;
+  }
+
+  msg.height = view.rows;
+  msg.width = view.cols;
+  msg.step = static_cast<uint32_t>(view.cols * view.elemSize());
+  msg.data.resize(static_cast<size_t>(msg.step) * view.rows);
+  view.copyTo(cv::Mat(view.rows, view.cols, view.type(), msg.data.data(), msg.step));
+}
+
+OutputImage::OutputImage(
+  bool pooled, const std_msgs::msg::Header & header, const std::string & encoding,
+  int rows, int cols, int type)
+{
+  if (pooled) {
+    shared_ = ImageBufferPool::instance().acquire(
+      static_cast<size_t>(cols) * CV_ELEM_SIZE(type) * rows);
+    view_ = initImageMessage(*shared_, header, encoding, rows, cols, type);
+  } else {
+    unique_ = createImageMessage(header, encoding, rows, cols, type, view_);
+  }
+}
+
+sensor_msgs::msg::Image::SharedPtr OutputImage::copy()
+{
+  finishImageMessage(view_, msg());
+  return std::make_shared<sensor_msgs::msg::Image>(msg());
+}
+
+void OutputImage::publish(const image_transport::Publisher & pub)
+{
+  finishImageMessage(view_, msg());
+  view_.release();
+  if (unique_) {
+    pub.publish(std::move(unique_));
+  } else {
+    pub.publish(std::move(shared_));
+  }
+}
+
+void OutputImage::publish(
+  const image_transport::CameraPublisher & pub,
+  sensor_msgs::msg::CameraInfo::UniquePtr info)
+{
+  finishImageMessage(view_, msg());
+  view_.release();
+  if (unique_) {
+    pub.publish(std::move(unique_), std::move(info));
+  } else {
+    pub.publish(
+      sensor_msgs::msg::Image::ConstSharedPtr(std::move(shared_)),
+      sensor_msgs::msg::CameraInfo::ConstSharedPtr(std::move(info)));
+  }
+}
+
+}  // namespace image_proc
@@ -0,0 +1,109 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstdint>
+#include <limits>
+
+#include <image_proc/latest_only.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+LatestOnly::LatestOnly(rclcpp::Node * node)
+: clock_(node->get_clock()),
+  newest_(std::numeric_limits<rcl_time_point_value_t>::min())
+{
+  enabled_ = node->declare_parameter("latest_only", false);
+  const double max_age = node->declare_parameter("max_input_age", 0.0);
+  max_age_ = max_age > 0.0 ? rclcpp::Duration::from_seconds(max_age).nanoseconds() : 0;
+}
+
+rmw_qos_profile_t LatestOnly::qos(rmw_qos_profile_t profile) const
+{
+  if (enabled_) {
+    profile.history = RMW_QOS_POLICY_HISTORY_KEEP_LAST;
+    profile.depth = 1;
+  }
+  return profile;
+}
+
+rclcpp::QoS LatestOnly::qos(rclcpp::QoS qos) const
+{
+  if (enabled_) {
+    qos.keep_last(1);
+  }
+  return qos;
+}
+
+bool LatestOnly::stale(const builtin_interfaces::msg::Time & stamp)
+{
+  const rcl_time_point_value_t time = rclcpp::Time(stamp).nanoseconds();
+  if (max_age_ > 0 && clock_->now().nanoseconds() - time > max_age_) {
+    return true;
+  }
+  if (!enabled_) {
+    return false;
+  }
+
+  // Take the input only if nothing newer was taken in the meantime
+  rcl_time_point_value_t newest = newest_.load();
+  while (time >= newest) {
+    if (newest_.compare_exchange_weak(newest, time)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LatestOnly::admit(
+  const builtin_interfaces::msg::Time & stamp, ProcessingDiagnostics::Frame & frame)
+{
+  if (stale(stamp)) {
+    frame.dropped();
+    return false;
+  }
+  return true;
+}
+
+bool LatestOnly::admit(
+  const builtin_interfaces::msg::Time & stamp, ProcessingDiagnostics & processing)
+{
+  if (stale(stamp)) {
+    processing.dropped();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace image_proc
@@ -0,0 +1,236 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <image_proc/mapped_tables.hpp>
+#include <opencv2/core/mat.hpp>
+#include <rcutils/get_env.h>
+
+namespace image_proc
+{
+
+namespace
+{
+
+constexpr char kMagic[8] = {'I', 'P', 'T', 'A', 'B', 'L', 'E', '1'};
+
+// Table data is aligned for vector loads
+constexpr uint64_t kAlignment = 64;
+
+struct FileHeader
+{
+  char magic[8];
+  uint64_t key;
+  uint32_t count;
+  uint32_t reserved;
+};
+
+struct TableHeader
+{
+  int32_t rows;
+  int32_t cols;
+  int32_t type;
+  int32_t reserved;
+  uint64_t offset;
+};
+
+std::mutex directory_mutex;
+bool directory_set = false;
+std::string directory_path;
+
+std::string tablePath(const std::string & directory, const std::string & kind, uint64_t key)
+{
+  char name[32];
+  std::snprintf(name, sizeof(name), "_%016" PRIx64 ".tables", key);
+  return directory + "/" + kind + name;
+}
+
+bool writeAll(int fd, const void * data, size_t size)
+{
+  const auto * bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    const ssize_t written = ::write(fd, bytes, size);
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+}  // namespace
+
+MappedTables::MappedTables(void * data, size_t size)
+: data_(data), size_(size)
+{
+}
+
+MappedTables::~MappedTables()
+{
+  ::munmap(data_, size_);
+}
+
+std::string MappedTables::directory()
+{
+  std::lock_guard<std::mutex> lock(directory_mutex);
+  if (!directory_set) {
+    const char * value = nullptr;
+    if (rcutils_get_env("IMAGE_PROC_TABLE_CACHE", &value) == nullptr && value != nullptr) {
+      directory_path = value;
+    }
+    directory_set = true;
+  }
+  return directory_path;
+}
+
+void MappedTables::setDirectory(const std::string & directory)
+{
+  std::lock_guard<std::mutex> lock(directory_mutex);
+  directory_path = directory;
+  directory_set = true;
+}
+
+std::shared_ptr<const MappedTables> MappedTables::load(const std::string & kind, uint64_t key)
+{
+  const std::string dir = directory();
+  if (dir.empty()) {
+    return nullptr;
+  }
+
+  const int fd = ::open(tablePath(dir, kind, key).c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat status;
+  void * data = MAP_FAILED;
+  if (::fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(FileHeader)) {
+    data = ::mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return nullptr;
+  }
+  std::shared_ptr<MappedTables> mapped(new MappedTables(data, status.st_size));
+
+  const auto * bytes = static_cast<const uint8_t *>(data);
+  FileHeader file;
+  std::memcpy(&file, bytes, sizeof(file));
+  if (std::memcmp(file.magic, kMagic, sizeof(kMagic)) != 0 || file.key != key ||
+    (mapped->size_ - sizeof(FileHeader)) / sizeof(TableHeader) < file.count)
+  {
+    return nullptr;
+  }
+
+  for (uint32_t i = 0; i < file.count; ++i) {
+    TableHeader table;
+    std::memcpy(&table, bytes + sizeof(FileHeader) + i * sizeof(TableHeader), sizeof(table));
+    if (table.rows < 0 || table.cols < 0 || CV_MAT_DEPTH(table.type) > CV_16F) {
+      return nullptr;
+    }
+    const uint64_t size = static_cast<uint64_t>(table.rows) * table.cols * CV_ELEM_SIZE(table.type);
+    if (table.offset > mapped->size_ || size > mapped->size_ - table.offset) {
+      return nullptr;
+    }
+    // The mapping is read-only, the tables are only handed out as const
+    mapped->tables_.emplace_back(
+      table.rows, table.cols, table.type, const_cast<uint8_t *>(bytes + table.offset));
+  }
+  return mapped;
+}
+
+bool MappedTables::store(
+  const std::string & kind, uint64_t key, const std::vector<cv::Mat> & tables)
+{
+  const std::string dir = directory();
+  if (dir.empty()) {
+    return false;
+  }
+
+  FileHeader file{};
+  std::memcpy(file.magic, kMagic, sizeof(kMagic));
+  file.key = key;
+  file.count = static_cast<uint32_t>(tables.size());
+
+  std::vector<TableHeader> headers(tables.size());
+  uint64_t offset = sizeof(FileHeader) + tables.size() * sizeof(TableHeader);
+  for (size_t i = 0; i < tables.size(); ++i) {
+    offset = (offset + kAlignment - 1) / kAlignment * kAlignment;
+    headers[i] = {tables[i].rows, tables[i].cols, tables[i].type(), 0, offset};
+    offset += tables[i].total() * tables[i].elemSize();
+  }
+
+  // Unique per process, renamed over the final name once complete
+  const std::string path = tablePath(dir, kind, key);
+  const std::string tmp_path = path + "." + std::to_string(::getpid()) + ".tmp";
+  const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  bool ok = writeAll(fd, &file, sizeof(file)) &&
+    writeAll(fd, headers.data(), headers.size() * sizeof(TableHeader));
+  uint64_t position = sizeof(FileHeader) + headers.size() * sizeof(TableHeader);
+  const uint8_t padding[kAlignment] = {};
+  for (size_t i = 0; ok && i < tables.size(); ++i) {
+    ok = writeAll(fd, padding, headers[i].offset - position);
+    position = headers[i].offset;
+    // Row by row, tables may be views of larger ones
+    const size_t row_size = tables[i].cols * tables[i].elemSize();
+    for (int row = 0; ok && row < tables[i].rows; ++row) {
+      ok = writeAll(fd, tables[i].ptr(row), row_size);
+      position += row_size;
+    }
+  }
+  ok = (::close(fd) == 0) && ok;
+
+  if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace image_proc
@@ -0,0 +1,200 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <image_proc/ordered_output.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+OrderedOutput::Ticket::Ticket(OrderedOutput * owner, uint64_t sequence)
+: owner_(owner), sequence_(sequence)
+{
+}
+
+OrderedOutput::Ticket::~Ticket()
+{
+  if (owner_) {
+    owner_->releaseAll(sequence_);
+  }
+}
+
+OrderedOutput::Ticket::Ticket(Ticket && other)
+: owner_(other.owner_), sequence_(other.sequence_)
+{
+  other.owner_ = nullptr;
+}
+
+OrderedOutput::Ticket & OrderedOutput::Ticket::operator=(Ticket && other)
+{
+  if (this != &other) {
+    if (owner_) {
+      owner_->releaseAll(sequence_);
+    }
+    owner_ = other.owner_;
+    sequence_ = other.sequence_;
+    other.owner_ = nullptr;
+  }
+  return *this;
+}
+
+void OrderedOutput::Ticket::wait(size_t output)
+{
+  if (owner_) {
+    owner_->wait(sequence_, output);
+  }
+}
+
+void OrderedOutput::Ticket::release(size_t output)
+{
+  if (owner_) {
+    owner_->release(sequence_, output);
+  }
+}
+
+OrderedOutput::OrderedOutput(size_t outputs, size_t max_in_flight)
+: turn_of_(outputs, 0)
+{
+  // As many workers as frames in flight, so a frame never waits for a worker
+  // busy waiting for its turn
+  for (size_t i = 0; i < std::max<size_t>(max_in_flight, 1); ++i) {
+    workers_.emplace_back(&OrderedOutput::run, this);
+  }
+}
+
+OrderedOutput::~OrderedOutput()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queued_.notify_all();
+  for (std::thread & worker : workers_) {
+    worker.join();
+  }
+}
+
+bool OrderedOutput::dispatch(Work work)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || in_flight_.size() >= workers_.size()) {
+      return false;
+    }
+    const uint64_t sequence = next_sequence_++;
+    in_flight_.emplace(sequence, std::vector<bool>(turn_of_.size(), false));
+    jobs_.push_back({Ticket(this, sequence), std::move(work)});
+  }
+  queued_.notify_one();
+  return true;
+}
+
+void OrderedOutput::run()
+{
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queued_.wait(lock, [this] {return stopping_ || !jobs_.empty();});
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job.work(job.ticket);
+  }
+}
+
+void OrderedOutput::wait(uint64_t sequence, size_t output)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  turn_.wait(lock, [&] {return turn_of_[output] >= sequence;});
+}
+
+void OrderedOutput::release(uint64_t sequence, size_t output)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto frame = in_flight_.find(sequence);
+  if (frame == in_flight_.end() || frame->second[output]) {
+    return;
+  }
+  frame->second[output] = true;
+  advance(output);
+  turn_.notify_all();
+}
+
+void OrderedOutput::releaseAll(uint64_t sequence)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_flight_.erase(sequence);
+  for (size_t output = 0; output < turn_of_.size(); ++output) {
+    advance(output);
+  }
+  turn_.notify_all();
+}
+
+void OrderedOutput::advance(size_t output)
+{
+  uint64_t & turn = turn_of_[output];
+  while (turn < next_sequence_) {
+    // Frames no longer in flight are done with every output
+    auto frame = in_flight_.find(turn);
+    if (frame != in_flight_.end() && !frame->second[output]) {
+      break;
+    }
+    ++turn;
+  }
+}
+
+std::unique_ptr<OrderedOutput> declareConcurrencyParameter(rclcpp::Node * node, size_t outputs)
+{
+  const int64_t concurrency = node->declare_parameter("concurrency", 1);
+  if (concurrency <= 1) {
+    return nullptr;
+  }
+
+  RCLCPP_INFO(
+    node->get_logger(), "Processing up to %" PRId64 " frames at once", concurrency);
+  return std::make_unique<OrderedOutput>(outputs, static_cast<size_t>(concurrency));
+}
+
+}  // namespace image_proc
@@ -0,0 +1,279 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <image_proc/image_buffer_pool.hpp>
+#include <image_proc/packed.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+const char * const PACKED_ENCODINGS[] = {
+  packed_encodings::MONO10P, packed_encodings::MONO12P,
+  packed_encodings::BAYER_RGGB10P, packed_encodings::BAYER_BGGR10P,
+  packed_encodings::BAYER_GBRG10P, packed_encodings::BAYER_GRBG10P,
+  packed_encodings::BAYER_RGGB12P, packed_encodings::BAYER_BGGR12P,
+  packed_encodings::BAYER_GBRG12P, packed_encodings::BAYER_GRBG12P,
+};
+
+template<typename T>
+inline T scaleSample(unsigned value, int bits)
+{
+  // 16 bits scale to the full range, 8 bits keep the most significant ones
+  return sizeof(T) == 1 ? static_cast<T>(value >> (bits - 8)) :
+         static_cast<T>(value << (16 - bits));
+}
+
+// Sample i of a packed row. It starts at most 6 bits into its first byte, so
+// it always lies within two bytes.
+inline unsigned sampleAt(const uint8_t * row, int bits, size_t i)
+{
+  const size_t bit = i * bits;
+  const unsigned bytes = row[bit / 8] | (row[bit / 8 + 1] << 8);
+  return (bytes >> (bit % 8)) & ((1u << bits) - 1);
+}
+
+// Unpacks the whole groups of 4 samples in 5 bytes of count samples. Returns
+// the number of samples unpacked.
+template<typename T>
+int unpack10(const uint8_t * src, int count, T * dst)
+{
+  int i = 0;
+  for (; i + 4 <= count; i += 4, src += 5) {
+    const uint64_t group = src[0] | (src[1] << 8) | (src[2] << 16) |
+      (static_cast<uint64_t>(src[3]) << 24) | (static_cast<uint64_t>(src[4]) << 32);
+    dst[i + 0] = scaleSample<T>(group & 0x3ff, 10);
+    dst[i + 1] = scaleSample<T>((group >> 10) & 0x3ff, 10);
+    dst[i + 2] = scaleSample<T>((group >> 20) & 0x3ff, 10);
+    dst[i + 3] = scaleSample<T>((group >> 30) & 0x3ff, 10);
+  }
+  return i;
+}
+
+// Unpacks 32 samples from 48 bytes at once, split into the first, second and
+// third byte of each pair of samples. Returns the number of samples unpacked.
+int unpack12Simd(const uint8_t * src, int count, uint16_t * dst)
+{
+  int i = 0;
+#if CV_SIMD128
+  const cv::v_uint16x8 low_nibble = cv::v_setall_u16(0x0f);
+  const cv::v_uint16x8 high_nibble = cv::v_setall_u16(0xf0);
+  for (; i + 32 <= count; i += 32, src += 48) {
+    cv::v_uint8x16 b0, b1, b2;
+    cv::v_load_deinterleave(src, b0, b1, b2);
+    cv::v_uint16x8 b0_low, b0_high, b1_low, b1_high, b2_low, b2_high;
+    cv::v_expand(b0, b0_low, b0_high);
+    cv::v_expand(b1, b1_low, b1_high);
+    cv::v_expand(b2, b2_low, b2_high);
+    // Scaled by 16, the even sample is b0 << 4 | (b1 & 0x0f) << 12 and the
+    // odd one (b1 & 0xf0) | b2 << 8
+    cv::v_store_interleave(
+      dst + i, (b0_low << 4) | ((b1_low & low_nibble) << 12),
+      (b1_low & high_nibble) | (b2_low << 8));
+    cv::v_store_interleave(
+      dst + i + 16, (b0_high << 4) | ((b1_high & low_nibble) << 12),
+      (b1_high & high_nibble) | (b2_high << 8));
+  }
+#else
+  static_cast<void>(src);
+  static_cast<void>(count);
+  static_cast<void>(dst);
+#endif
+  return i;
+}
+
+int unpack12Simd(const uint8_t * src, int count, uint8_t * dst)
+{
+  int i = 0;
+#if CV_SIMD128
+  const cv::v_uint16x8 low_byte = cv::v_setall_u16(0xff);
+  for (; i + 32 <= count; i += 32, src += 48) {
+    cv::v_uint8x16 b0, b1, b2;
+    cv::v_load_deinterleave(src, b0, b1, b2);
+    cv::v_uint16x8 b0_low, b0_high, b1_low, b1_high;
+    cv::v_expand(b0, b0_low, b0_high);
+    cv::v_expand(b1, b1_low, b1_high);
+    // The 8 most significant bits of the even sample are b0 >> 4 | b1 << 4,
+    // those of the odd one are b2
+    const cv::v_uint16x8 even_low = ((b0_low >> 4) | (b1_low << 4)) & low_byte;
+    const cv::v_uint16x8 even_high = ((b0_high >> 4) | (b1_high << 4)) & low_byte;
+    cv::v_store_interleave(dst + i, cv::v_pack(even_low, even_high), b2);
+  }
+#else
+  static_cast<void>(src);
+  static_cast<void>(count);
+  static_cast<void>(dst);
+#endif
+  return i;
+}
+
+// Unpacks the whole pairs of samples in 3 bytes of count samples. Returns the
+// number of samples unpacked.
+template<typename T>
+int unpack12(const uint8_t * src, int count, T * dst)
+{
+  int i = unpack12Simd(src, count, dst);
+  src += i / 2 * 3;
+  for (; i + 2 <= count; i += 2, src += 3) {
+    dst[i + 0] = scaleSample<T>(src[0] | ((src[1] & 0x0f) << 8), 12);
+    dst[i + 1] = scaleSample<T>((src[1] >> 4) | (src[2] << 4), 12);
+  }
+  return i;
+}
+
+template<typename T>
+void unpackRowImpl(const uint8_t * row, int bits, int first, int count, T * dst)
+{
+  // One sample at a time up to the first whole group, and after the last one
+  const int group = bits == 10 ? 4 : 2;
+  int i = 0;
+  for (; i < count && (first + i) % group != 0; ++i) {
+    dst[i] = scaleSample<T>(sampleAt(row, bits, first + i), bits);
+  }
+
+  const uint8_t * src = row + static_cast<size_t>(first + i) * bits / 8;
+  if (bits == 10) {
+    i += unpack10(src, count - i, dst + i);
+  } else if (bits == 12) {
+    i += unpack12(src, count - i, dst + i);
+  }
+
+  for (; i < count; ++i) {
+    dst[i] = scaleSample<T>(sampleAt(row, bits, first + i), bits);
+  }
+}
+
+// Whether packed holds all the rows its size and encoding take
+bool isComplete(const sensor_msgs::msg::Image & packed, int bits)
+{
+  const size_t row_size = (static_cast<size_t>(packed.width) * bits + 7) / 8;
+  return packed.step >= row_size &&
+         packed.data.size() >= static_cast<size_t>(packed.step) * packed.height;
+}
+
+}  // namespace
+
+int packedBitDepth(const std::string & encoding)
+{
+  for (const char * packed : PACKED_ENCODINGS) {
+    if (encoding == packed) {
+      return encoding[encoding.size() - 3] == '0' ? 10 : 12;
+    }
+  }
+  return 0;
+}
+
+std::string unpackedEncoding(const std::string & encoding, int depth)
+{
+  // Replace the bit depth and "p" suffix, e.g. bayer_rggb12p to bayer_rggb16
+  return encoding.substr(0, encoding.size() - 3) + (depth == CV_8U ? "8" : "16");
+}
+
+void unpackRow(const uint8_t * row, int bits, int first, int count, uint8_t * dst)
+{
+  unpackRowImpl(row, bits, first, count, dst);
+}
+
+void unpackRow(const uint8_t * row, int bits, int first, int count, uint16_t * dst)
+{
+  unpackRowImpl(row, bits, first, count, dst);
+}
+
+bool unpackImage(
+  const sensor_msgs::msg::Image & packed, const cv::Rect & window, int depth,
+  cv::Mat & dst, int pair_step)
+{
+  const int bits = packedBitDepth(packed.encoding);
+  if (!bits || !isComplete(packed, bits)) {
+    return false;
+  }
+
+  const cv::Rect rect = window & cv::Rect(0, 0, packed.width, packed.height);
+  const int rows = pair_step > 0 ? rect.height / pair_step * 2 : rect.height;
+  dst.create(rows, rect.width, CV_MAKETYPE(depth, 1));
+
+  cv::parallel_for_(
+    cv::Range(0, rows), [&](const cv::Range & range) {
+      for (int y = range.start; y < range.end; ++y) {
+        const int src_y = rect.y + (pair_step > 0 ? y / 2 * pair_step + y % 2 : y);
+        const uint8_t * row = &packed.data[static_cast<size_t>(src_y) * packed.step];
+        if (depth == CV_8U) {
+          unpackRow(row, bits, rect.x, rect.width, dst.ptr<uint8_t>(y));
+        } else {
+          unpackRow(row, bits, rect.x, rect.width, dst.ptr<uint16_t>(y));
+        }
+      }
+    });
+  return true;
+}
+
+sensor_msgs::msg::Image::SharedPtr unpackImageMessage(
+  const sensor_msgs::msg::Image & packed, int depth, bool pooled)
+{
+  const int bits = packedBitDepth(packed.encoding);
+  if (!bits || !isComplete(packed, bits)) {
+    return nullptr;
+  }
+
+  const int type = CV_MAKETYPE(depth, 1);
+  const size_t size = static_cast<size_t>(packed.width) * CV_ELEM_SIZE(type) * packed.height;
+  sensor_msgs::msg::Image::SharedPtr msg;
+  if (pooled) {
+    msg = ImageBufferPool::instance().acquire(size);
+  } else {
+    msg = std::make_shared<sensor_msgs::msg::Image>();
+    msg->data.resize(size);
+  }
+  msg->header = packed.header;
+  msg->encoding = unpackedEncoding(packed.encoding, depth);
+  msg->height = packed.height;
+  msg->width = packed.width;
+  msg->is_bigendian = false;
+  msg->step = static_cast<uint32_t>(packed.width * CV_ELEM_SIZE(type));
+
+  cv::Mat view(msg->height, msg->width, type, msg->data.data(), msg->step);
+  unpackImage(packed, cv::Rect(0, 0, packed.width, packed.height), depth, view);
+  return msg;
+}
+
+}  // namespace image_proc
@@ -0,0 +1,178 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Bucket granularity, as for images
+constexpr size_t kBucketAlignment = 4096;
+
+size_t bucketSize(size_t size)
+{
+  return (size + kBucketAlignment - 1) / kBucketAlignment * kBucketAlignment;
+}
+
+}  // namespace
+
+struct PointCloudBufferPool::Impl
+{
+  mutable std::mutex mutex;
+  // Idle messages keyed by the capacity of their data, rounded down
+  std::multimap<size_t, std::unique_ptr<sensor_msgs::msg::PointCloud2>> idle;
+  Statistics statistics;
+  size_t max_pooled_bytes = 256 * 1024 * 1024;
+
+  void release(sensor_msgs::msg::PointCloud2 * msg)
+  {
+    std::unique_ptr<sensor_msgs::msg::PointCloud2> owned(msg);
+    const size_t bucket = msg->data.capacity() / kBucketAlignment * kBucketAlignment;
+
+    if (bucket == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (statistics.pooled_bytes + bucket > max_pooled_bytes) {
+      ++statistics.evictions;
+      return;
+    }
+    ++statistics.returns;
+    statistics.pooled_bytes += bucket;
+    idle.emplace(bucket, std::move(owned));
+  }
+
+  void trim(size_t bytes)
+  {
+    // Largest first
+    while (!idle.empty() && statistics.pooled_bytes > bytes) {
+      auto largest = std::prev(idle.end());
+      statistics.pooled_bytes -= largest->first;
+      ++statistics.evictions;
+      idle.erase(largest);
+    }
+  }
+};
+
+PointCloudBufferPool::PointCloudBufferPool()
+: impl_(std::make_shared<Impl>())
+{
+}
+
+PointCloudBufferPool & PointCloudBufferPool::instance()
+{
+  static PointCloudBufferPool pool;
+  return pool;
+}
+
+sensor_msgs::msg::PointCloud2::SharedPtr PointCloudBufferPool::acquire(size_t size)
+{
+  const size_t bucket = bucketSize(size);
+  std::unique_ptr<sensor_msgs::msg::PointCloud2> msg;
+
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->idle.lower_bound(bucket);
+    if (it != impl_->idle.end() && it->first <= 2 * bucket) {
+      msg = std::move(it->second);
+      impl_->statistics.pooled_bytes -= it->first;
+      impl_->idle.erase(it);
+      ++impl_->statistics.hits;
+    } else {
+      ++impl_->statistics.misses;
+    }
+  }
+
+  if (!msg) {
+    msg = std::make_unique<sensor_msgs::msg::PointCloud2>();
+    msg->data.reserve(bucket);
+  }
+  msg->data.resize(size);
+
+  // The pool may be gone by the time the last subscriber lets go
+  std::weak_ptr<Impl> weak_impl = impl_;
+  return sensor_msgs::msg::PointCloud2::SharedPtr(
+    msg.release(), [weak_impl](sensor_msgs::msg::PointCloud2 * released) {
+      if (auto impl = weak_impl.lock()) {
+        impl->release(released);
+      } else {
+        delete released;
+      }
+    });
+}
+
+sensor_msgs::msg::PointCloud2::SharedPtr PointCloudBufferPool::acquire(
+  const sensor_msgs::msg::PointCloud2 & layout, uint32_t height, uint32_t width)
+{
+  auto msg = acquire(static_cast<size_t>(layout.point_step) * width * height);
+  if (msg->fields != layout.fields) {
+    msg->fields = layout.fields;
+  }
+  msg->height = height;
+  msg->width = width;
+  msg->is_bigendian = layout.is_bigendian;
+  msg->point_step = layout.point_step;
+  msg->row_step = layout.point_step * width;
+  return msg;
+}
+
+PointCloudBufferPool::Statistics PointCloudBufferPool::statistics() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->statistics;
+}
+
+size_t PointCloudBufferPool::maxPooledBytes() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->max_pooled_bytes;
+}
+
+void PointCloudBufferPool::setMaxPooledBytes(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->max_pooled_bytes = bytes;
+  impl_->trim(bytes);
+}
+
+}  // namespace image_proc
@@ -0,0 +1,127 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "image_proc/processing_diagnostics.hpp"
+
+#include <chrono>
+#include <memory>
+
+namespace image_proc
+{
+
+ProcessingDiagnostics::Frame::Frame(ProcessingDiagnostics & diagnostics)
+: diagnostics_(diagnostics), start_(std::chrono::steady_clock::now()), outcome_(Outcome::SKIPPED)
+{
+}
+
+ProcessingDiagnostics::Frame::~Frame()
+{
+  switch (outcome_) {
+    case Outcome::PUBLISHED:
+      diagnostics_.published(start_, stamp_);
+      break;
+    case Outcome::DROPPED:
+      diagnostics_.dropped();
+      break;
+    case Outcome::SKIPPED:
+      diagnostics_.skipped();
+      break;
+  }
+}
+
+void ProcessingDiagnostics::Frame::published(const builtin_interfaces::msg::Time & stamp)
+{
+  outcome_ = Outcome::PUBLISHED;
+  stamp_ = stamp;
+}
+
+void ProcessingDiagnostics::Frame::dropped()
+{
+  outcome_ = Outcome::DROPPED;
+}
+
+ProcessingDiagnostics::ProcessingDiagnostics(rclcpp::Node * node)
+: clock_(node->get_clock()),
+  updater_(std::make_unique<diagnostic_updater::Updater>(node))
+{
+  updater_->setHardwareID("none");
+  updater_->add("Processing", this, &ProcessingDiagnostics::status);
+}
+
+ProcessingDiagnostics::ProcessingDiagnostics(
+  rclcpp::Node * node, diagnostic_updater::Updater & updater)
+: clock_(node->get_clock())
+{
+  updater.add("Processing", this, &ProcessingDiagnostics::status);
+}
+
+void ProcessingDiagnostics::published(
+  std::chrono::steady_clock::time_point start, const builtin_interfaces::msg::Time & stamp)
+{
+  const auto latency = std::chrono::steady_clock::now() - start;
+  const rcl_time_point_value_t age = clock_->now().nanoseconds() -
+    rclcpp::Time(stamp).nanoseconds();
+  statistics_.record(latency, std::chrono::nanoseconds(age));
+}
+
+void ProcessingDiagnostics::dropped()
+{
+  statistics_.drop();
+}
+
+void ProcessingDiagnostics::skipped()
+{
+  statistics_.skip();
+}
+
+void ProcessingDiagnostics::status(diagnostic_updater::DiagnosticStatusWrapper & status)
+{
+  const auto summary = statistics_.collect();
+  if (summary.dropped > 0) {
+    status.summary(diagnostic_msgs::msg::DiagnosticStatus::WARN, "Dropping frames");
+  } else {
+    status.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "OK");
+  }
+  status.add("Published frames", summary.published);
+  status.add("Dropped frames", summary.dropped);
+  status.add("Skipped frames", summary.skipped);
+  status.add("Rate (Hz)", summary.rate);
+  status.add("Latency p50 (ms)", summary.latency.p50 * 1e3);
+  status.add("Latency p99 (ms)", summary.latency.p99 * 1e3);
+  status.add("Latency max (ms)", summary.latency.max * 1e3);
+  status.add("Age p50 (ms)", summary.age.p50 * 1e3);
+  status.add("Age p99 (ms)", summary.age.p99 * 1e3);
+  status.add("Age max (ms)", summary.age.max * 1e3);
+}
+
+}  // namespace image_proc
@@ -30,23 +30,255 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "image_geometry/pinhole_camera_model.hpp"
 #include "rcutils/logging_macros.h"
 
 #include <image_proc/processor.hpp>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core/utility.hpp>
 #include <opencv2/imgproc.hpp>
+#include <sensor_msgs/distortion_models.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/image.hpp>
 
 namespace image_proc
 {
 
+namespace
+{
+
+// Position of the color samples in an 8-bit Bayer mosaic
+struct BayerLayout
+{
+  // Even rows hold red rather than blue samples
+  bool red_first;
+  // Column parity of the green samples on even rows
+  int green_phase;
+};
+
+bool getBayerLayout(const std::string & encoding, BayerLayout & layout)
+{
+  if (encoding == sensor_msgs::image_encodings::BAYER_RGGB8) {
+    layout = {true, 1};
+  } else if (encoding == sensor_msgs::image_encodings::BAYER_BGGR8) {
+    layout = {false, 1};
+  } else if (encoding == sensor_msgs::image_encodings::BAYER_GBRG8) {
+    layout = {false, 0};
+  } else if (encoding == sensor_msgs::image_encodings::BAYER_GRBG8) {
+    layout = {true, 0};
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Bilinear demosaic of the single pixel (x, y), mirroring at the border
+inline void demosaicPixel(
+  const cv::Mat & bayer, const BayerLayout & layout, int x, int y, int bgr[3])
+{
+  const int xl = x > 0 ? x - 1 : 1;
+  const int xr = x < bayer.cols - 1 ? x + 1 : bayer.cols - 2;
+  const uint8_t * up = bayer.ptr<uint8_t>(y > 0 ? y - 1 : 1);
+  const uint8_t * cur = bayer.ptr<uint8_t>(y);
+  const uint8_t * down = bayer.ptr<uint8_t>(y < bayer.rows - 1 ? y + 1 : bayer.rows - 2);
+
+  const int odd = y & 1;
+  const int row_color = layout.red_first != (odd == 1) ? 2 : 0;
+  const int other_color = 2 - row_color;
+
+  if ((x & 1) == (layout.green_phase ^ odd)) {
+    bgr[1] = cur[x];
+    bgr[row_color] = (cur[xl] + cur[xr] + 1) >> 1;
+    bgr[other_color] = (up[x] + down[x] + 1) >> 1;
+  } else {
+    bgr[row_color] = cur[x];
+    bgr[1] = (cur[xl] + cur[xr] + up[x] + down[x] + 2) >> 2;
+    bgr[other_color] = (up[xl] + up[xr] + down[xl] + down[xr] + 2) >> 2;
+  }
+}
+
+// Remaps a Bayer mosaic into a rectified BGR image, demosaicing only the
+// source pixels that the map actually samples.
+void remapBayer(
+  const cv::Mat & bayer, const BayerLayout & layout,
+  const cv::Mat & map_x, const cv::Mat & map_y, int interpolation, cv::Mat & dst)
+{
+  dst.create(map_x.size(), CV_8UC3);
+
+  cv::parallel_for_(
+    cv::Range(0, dst.rows), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const float * mx = map_x.ptr<float>(v);
+        const float * my = map_y.ptr<float>(v);
+        uint8_t * out = dst.ptr<uint8_t>(v);
+
+        for (int u = 0; u < dst.cols; ++u, out += 3) {
+          int bgr[3] = {0, 0, 0};
+
+          if (interpolation == cv::INTER_NEAREST) {
+            const int x = cvRound(mx[u]);
+            const int y = cvRound(my[u]);
+            if (x >= 0 && y >= 0 && x < bayer.cols && y < bayer.rows) {
+              demosaicPixel(bayer, layout, x, y, bgr);
+            }
+            out[0] = static_cast<uint8_t>(bgr[0]);
+            out[1] = static_cast<uint8_t>(bgr[1]);
+            out[2] = static_cast<uint8_t>(bgr[2]);
+            continue;
+          }
+
+          // Bilinear, with pixels outside the source treated as black like cv::remap
+          const int x0 = cvFloor(mx[u]);
+          const int y0 = cvFloor(my[u]);
+          const float ax = mx[u] - x0;
+          const float ay = my[u] - y0;
+          const float weights[4] = {
+            (1.0f - ax) * (1.0f - ay), ax * (1.0f - ay), (1.0f - ax) * ay, ax * ay};
+          float acc[3] = {0.0f, 0.0f, 0.0f};
+
+          for (int k = 0; k < 4; ++k) {
+            const int x = x0 + (k & 1);
+            const int y = y0 + (k >> 1);
+            if (x < 0 || y < 0 || x >= bayer.cols || y >= bayer.rows) {
+              continue;
+            }
+            demosaicPixel(bayer, layout, x, y, bgr);
+            acc[0] += weights[k] * bgr[0];
+            acc[1] += weights[k] * bgr[1];
+            acc[2] += weights[k] * bgr[2];
+          }
+          out[0] = cv::saturate_cast<uint8_t>(acc[0]);
+          out[1] = cv::saturate_cast<uint8_t>(acc[1]);
+          out[2] = cv::saturate_cast<uint8_t>(acc[2]);
+        }
+      }
+    });
+}
+
+// 16-bit mosaics, which the fused path leaves to cv::cvtColor and the remap
+bool isBayer16(const std::string & encoding)
+{
+  return encoding == sensor_msgs::image_encodings::BAYER_RGGB16 ||
+         encoding == sensor_msgs::image_encodings::BAYER_BGGR16 ||
+         encoding == sensor_msgs::image_encodings::BAYER_GBRG16 ||
+         encoding == sensor_msgs::image_encodings::BAYER_GRBG16;
+}
+
+}  // namespace
+
+// Floating point rectification maps, one entry per calibration seen.
+// StereoProcessor shares a single Processor between both cameras.
+struct Processor::RectifyMapCache
+{
+  struct Entry
+  {
+    cv::Matx33d K;
+    cv::Mat_<double> D;
+    cv::Matx33d R;
+    cv::Matx34d P;
+    cv::Size size;
+    cv::Mat map_x;
+    cv::Mat map_y;
+  };
+
+  static constexpr size_t kMaxEntries = 4;
+
+  std::mutex mutex;
+  std::vector<std::shared_ptr<const Entry>> entries;
+
+  std::shared_ptr<const Entry> get(const image_geometry::PinholeCameraModel & model)
+  {
+    const cv::Mat_<double> & D = model.distortionCoeffs();
+    const cv::Size size = model.fullResolution();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto & entry : entries) {
+      if (entry->size == size && entry->K == model.intrinsicMatrix() &&
+        entry->R == model.rotationMatrix() && entry->P == model.projectionMatrix() &&
+        entry->D.total() == D.total() && std::equal(D.begin(), D.end(), entry->D.begin()))
+      {
+        return entry;
+      }
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->K = model.intrinsicMatrix();
+    entry->D = D.clone();
+    entry->R = model.rotationMatrix();
+    entry->P = model.projectionMatrix();
+    entry->size = size;
+    const cv::Matx33d P3 = entry->P.get_minor<3, 3>(0, 0);
+    cv::initUndistortRectifyMap(
+      entry->K, entry->D, entry->R, P3, size, CV_32FC1, entry->map_x, entry->map_y);
+
+    if (entries.size() >= kMaxEntries) {
+      entries.erase(entries.begin());
+    }
+    entries.push_back(entry);
+    return entry;
+  }
+};
+
+Processor::Processor()
+: interpolation_(cv::INTER_LINEAR),
+  fused_debayer_rectify_(false),
+  rect_from_rect_color_(false),
+  rectify_map_cache_(std::make_shared<RectifyMapCache>())
+{
+}
+
+bool Processor::processFused(
+  const cv::Mat & raw, const std::string & raw_encoding,
+  const image_geometry::PinholeCameraModel & model, cv::Mat & rect_color) const
+{
+  BayerLayout layout;
+  if (!getBayerLayout(raw_encoding, layout) || raw.rows < 2 || raw.cols < 2) {
+    return false;
+  }
+  if (interpolation_ != cv::INTER_NEAREST && interpolation_ != cv::INTER_LINEAR) {
+    return false;
+  }
+
+  // Binning and ROI change the map; leave those to the camera model
+  const std::string & distortion_model = model.cameraInfo().distortion_model;
+  if (!model.initialized() || model.binningX() > 1 || model.binningY() > 1 ||
+    model.reducedResolution() != model.fullResolution() ||
+    raw.size() != model.fullResolution() ||
+    (distortion_model != sensor_msgs::distortion_models::PLUMB_BOB &&
+    distortion_model != sensor_msgs::distortion_models::RATIONAL_POLYNOMIAL))
+  {
+    return false;
+  }
+
+  const auto maps = rectify_map_cache_->get(model);
+  remapBayer(raw, layout, maps->map_x, maps->map_y, interpolation_, rect_color);
+  return true;
+}
+
 bool Processor::process(
   const sensor_msgs::msg::Image::ConstSharedPtr & raw_image,
   const image_geometry::PinholeCameraModel & model,
   ImageSet & output, int flags) const
+{
+  // The images of output are their own buffers. Views of a previous raw
+  // image are not, they must not be written into.
+  auto owned = [](const cv::Mat & image) {return image.u ? image : cv::Mat();};
+  FrameArena arena{
+    owned(output.mono), owned(output.rect), owned(output.color), owned(output.rect_color)};
+  return process(raw_image, model, output, arena, flags);
+}
+
+bool Processor::process(
+  const sensor_msgs::msg::Image::ConstSharedPtr & raw_image,
+  const image_geometry::PinholeCameraModel & model,
+  ImageSet & output, FrameArena & arena, int flags) const
 {
   static const int MONO_EITHER = MONO | RECT;
   static const int COLOR_EITHER = COLOR | RECT_COLOR;
@@ -62,12 +294,31 @@ bool Processor::process(
   {
     raw_type = CV_8UC3;
     output.color_encoding = raw_encoding;
+  } else if (isBayer16(raw_encoding)) {
+    raw_type = CV_16UC1;
   }
   // Construct cv::Mat pointing to raw_image data
   const cv::Mat raw(
     raw_image->height, raw_image->width, raw_type,
     const_cast<uint8_t *>(&raw_image->data[0]), raw_image->step);
 
+  // Rectify once, RECT being the luma of RECT_COLOR
+  const bool rect_once = rect_from_rect_color_ && (flags & RECT) && (flags & RECT_COLOR);
+  const int mono_flags = rect_once ? MONO : MONO_EITHER;
+
+  // Single pass from the mosaic when the intermediate color image isn't needed
+  if (fused_debayer_rectify_ && (flags & ALL) == (rect_once ? RECT | RECT_COLOR : RECT_COLOR) &&
+    processFused(raw, raw_encoding, model, arena.rect_color))
+  {
+    output.rect_color = arena.rect_color;
+    output.color_encoding = sensor_msgs::image_encodings::BGR8;
+    if (rect_once) {
+      cv::cvtColor(output.rect_color, arena.rect, cv::COLOR_BGR2GRAY);
+      output.rect = arena.rect;
+    }
+    return true;
+  }
+
   ///////////////////////////////////////////////////////
   // Construct colorized (unrectified) images from raw //
   ///////////////////////////////////////////////////////
@@ -77,32 +328,36 @@ bool Processor::process(
     // Convert to color BGR
     // TODO(unknown): Faster to convert directly to mono when color is not requested,
     //                but OpenCV doesn't support
+    namespace enc = sensor_msgs::image_encodings;
     int code = 0;
-    if (raw_encoding == sensor_msgs::image_encodings::BAYER_RGGB8) {
+    if (raw_encoding == enc::BAYER_RGGB8 || raw_encoding == enc::BAYER_RGGB16) {
       code = cv::COLOR_BayerBG2BGR;
-    } else if (raw_encoding == sensor_msgs::image_encodings::BAYER_BGGR8) {
+    } else if (raw_encoding == enc::BAYER_BGGR8 || raw_encoding == enc::BAYER_BGGR16) {
       code = cv::COLOR_BayerRG2BGR;
-    } else if (raw_encoding == sensor_msgs::image_encodings::BAYER_GBRG8) {
+    } else if (raw_encoding == enc::BAYER_GBRG8 || raw_encoding == enc::BAYER_GBRG16) {
       code = cv::COLOR_BayerGR2BGR;
-    } else if (raw_encoding == sensor_msgs::image_encodings::BAYER_GRBG8) {
+    } else if (raw_encoding == enc::BAYER_GRBG8 || raw_encoding == enc::BAYER_GRBG16) {
       code = cv::COLOR_BayerGB2BGR;
     } else {
       RCUTILS_LOG_ERROR("[image_proc] Unsupported encoding '%s'", raw_encoding.c_str());
       return false;
     }
-    cv::cvtColor(raw, output.color, code);
-    output.color_encoding = sensor_msgs::image_encodings::BGR8;
+    cv::cvtColor(raw, arena.color, code);
+    output.color = arena.color;
+    output.color_encoding = raw_type == CV_16UC1 ? enc::BGR16 : enc::BGR8;
 
-    if (flags & MONO_EITHER) {
-      cv::cvtColor(output.color, output.mono, cv::COLOR_BGR2GRAY);
+    if (flags & mono_flags) {
+      cv::cvtColor(output.color, arena.mono, cv::COLOR_BGR2GRAY);
+      output.mono = arena.mono;
     }
   } else if (raw_type == CV_8UC3) {  // Color case
     output.color = raw;
-    if (flags & MONO_EITHER) {
+    if (flags & mono_flags) {
       int code =
         (raw_encoding ==
         sensor_msgs::image_encodings::BGR8) ? cv::COLOR_BGR2GRAY : cv::COLOR_RGB2GRAY;
-      cv::cvtColor(output.color, output.mono, code);
+      cv::cvtColor(output.color, arena.mono, code);
+      output.mono = arena.mono;
     }
   } else if (raw_encoding == sensor_msgs::image_encodings::MONO8) {  // Mono case
     output.mono = raw;
@@ -128,11 +383,28 @@ bool Processor::process(
 
   // TODO(unknown): If no distortion, could just point to the colorized data.
   //                But copy is already way faster than remap.
+  if (rect_once) {
+    model.rectifyImage(output.color, arena.rect_color, interpolation_);
+    output.rect_color = arena.rect_color;
+    if (output.rect_color.channels() == 1) {
+      // Rectified mono8, already the luma
+      output.rect = output.rect_color;
+    } else {
+      const int code = output.color_encoding == sensor_msgs::image_encodings::RGB8 ?
+        cv::COLOR_RGB2GRAY : cv::COLOR_BGR2GRAY;
+      cv::cvtColor(output.rect_color, arena.rect, code);
+      output.rect = arena.rect;
+    }
+    return true;
+  }
+
   if (flags & RECT) {
-    model.rectifyImage(output.mono, output.rect, interpolation_);
+    model.rectifyImage(output.mono, arena.rect, interpolation_);
+    output.rect = arena.rect;
   }
   if (flags & RECT_COLOR) {
-    model.rectifyImage(output.color, output.rect_color, interpolation_);
+    model.rectifyImage(output.color, arena.rect_color, interpolation_);
+    output.rect_color = arena.rect_color;
   }
 
   return true;
@@ -0,0 +1,241 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <image_proc/mapped_tables.hpp>
+#include <image_proc/rectification_maps.hpp>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/distortion_models.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Rows per remap tile, small enough for the source rows to stay in cache
+constexpr int kTileRows = 32;
+
+// 64-bit FNV-1a
+class Fnv1a
+{
+public:
+  void add(const void * data, size_t size)
+  {
+    const auto * bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211ull;
+    }
+  }
+
+  template<typename T>
+  void add(const T & value)
+  {
+    add(&value, sizeof(value));
+  }
+
+  uint64_t get() const {return hash_;}
+
+private:
+  uint64_t hash_ = 14695981039346656037ull;
+};
+
+}  // namespace
+
+uint64_t RectificationMaps::hashCameraInfo(const sensor_msgs::msg::CameraInfo & info)
+{
+  Fnv1a hash;
+  hash.add(info.width);
+  hash.add(info.height);
+  hash.add(info.distortion_model.data(), info.distortion_model.size());
+  hash.add(info.d.data(), info.d.size() * sizeof(double));
+  hash.add(info.k.data(), info.k.size() * sizeof(double));
+  hash.add(info.r.data(), info.r.size() * sizeof(double));
+  hash.add(info.p.data(), info.p.size() * sizeof(double));
+  hash.add(info.binning_x);
+  hash.add(info.binning_y);
+  hash.add(info.roi.x_offset);
+  hash.add(info.roi.y_offset);
+  hash.add(info.roi.width);
+  hash.add(info.roi.height);
+  return hash.get();
+}
+
+bool RectificationMaps::update(const sensor_msgs::msg::CameraInfo & info)
+{
+  const uint64_t hash = hashCameraInfo(info);
+  if (initialized() && hash == hash_) {
+    ++hit_count_;
+    return false;
+  }
+
+  // Maps an earlier run saved, if the table cache is on
+  std::shared_ptr<const MappedTables> mapped = MappedTables::load("rectify", hash);
+  if (mapped && mapped->tables().size() == 2 &&
+    mapped->tables()[0].type() == CV_16SC2 && mapped->tables()[1].type() == CV_16UC1 &&
+    mapped->tables()[0].size() == mapped->tables()[1].size())
+  {
+    map1_ = mapped->tables()[0];
+    map2_ = mapped->tables()[1];
+    mapped_ = mapped;
+  } else {
+    build(info);
+    mapped_.reset();
+    MappedTables::store("rectify", hash, {map1_, map2_});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    device_map1_.release();
+    device_map2_.release();
+  }
+
+  hash_ = hash;
+  ++rebuild_count_;
+  return true;
+}
+
+void RectificationMaps::build(const sensor_msgs::msg::CameraInfo & info)
+{
+  // Same adjustments for binning and ROI as image_geometry::PinholeCameraModel
+  const int binning_x = std::max<int>(info.binning_x, 1);
+  const int binning_y = std::max<int>(info.binning_y, 1);
+  const cv::Size binned_resolution(info.width / binning_x, info.height / binning_y);
+
+  cv::Matx33d K(info.k.data());
+  const cv::Matx33d R(info.r.data());
+  cv::Matx34d P(info.p.data());
+  cv::Mat_<double> D;
+  if (!info.d.empty()) {
+    D = cv::Mat_<double>(
+      1, static_cast<int>(info.d.size()), const_cast<double *>(info.d.data()));
+  }
+
+  if (binning_x > 1) {
+    const double scale_x = 1.0 / binning_x;
+    K(0, 0) *= scale_x;
+    K(0, 2) *= scale_x;
+    P(0, 0) *= scale_x;
+    P(0, 2) *= scale_x;
+    P(0, 3) *= scale_x;
+  }
+  if (binning_y > 1) {
+    const double scale_y = 1.0 / binning_y;
+    K(1, 1) *= scale_y;
+    K(1, 2) *= scale_y;
+    P(1, 1) *= scale_y;
+    P(1, 2) *= scale_y;
+    P(1, 3) *= scale_y;
+  }
+
+  cv::Mat full_map1, full_map2;
+  if (info.distortion_model == sensor_msgs::distortion_models::EQUIDISTANT) {
+    cv::fisheye::initUndistortRectifyMap(
+      K, D, R, P, binned_resolution, CV_16SC2, full_map1, full_map2);
+  } else {
+    cv::initUndistortRectifyMap(K, D, R, P, binned_resolution, CV_16SC2, full_map1, full_map2);
+  }
+
+  // An all-zero ROI means the full resolution
+  cv::Rect roi(info.roi.x_offset, info.roi.y_offset, info.roi.width, info.roi.height);
+  if (roi.area() == 0) {
+    roi = cv::Rect(0, 0, info.width, info.height);
+  }
+  roi.x /= binning_x;
+  roi.y /= binning_y;
+  roi.width /= binning_x;
+  roi.height /= binning_y;
+  roi &= cv::Rect(cv::Point(), binned_resolution);
+
+  if (roi.size() == binned_resolution) {
+    map1_ = full_map1;
+    map2_ = full_map2;
+  } else {
+    // map1 holds integer (x, y) source coordinates, which move with the ROI.
+    // map2 indexes the subpixel interpolation table and is unaffected.
+    map1_ = full_map1(roi) - cv::Scalar(roi.x, roi.y);
+    map2_ = full_map2(roi).clone();
+  }
+}
+
+void RectificationMaps::remap(const cv::Mat & src, cv::Mat & dst, int interpolation) const
+{
+  dst.create(map1_.size(), src.type());
+  remap(src, dst, interpolation, cv::Rect(cv::Point(), dst.size()));
+}
+
+void RectificationMaps::remap(
+  const cv::Mat & src, cv::Mat & dst, int interpolation, const cv::Rect & window) const
+{
+  const cv::Rect clipped = window & cv::Rect(cv::Point(), map1_.size());
+  const cv::Range cols(clipped.x, clipped.x + clipped.width);
+
+  const int tiles = (clipped.height + kTileRows - 1) / kTileRows;
+  cv::parallel_for_(
+    cv::Range(0, tiles), [&](const cv::Range & range) {
+      for (int tile = range.start; tile < range.end; ++tile) {
+        const cv::Range rows(
+          clipped.y + tile * kTileRows,
+          clipped.y + std::min((tile + 1) * kTileRows, clipped.height));
+        cv::Mat dst_tile = dst(rows, cols);
+        cv::remap(
+          src, dst_tile, map1_(rows, cols), map2_(rows, cols),
+          interpolation, cv::BORDER_CONSTANT);
+      }
+    });
+}
+
+void RectificationMaps::remap(const cv::UMat & src, cv::UMat & dst, int interpolation) const
+{
+  cv::UMat device_map1, device_map2;
+  {
+    std::lock_guard<std::mutex> lock(device_mutex_);
+    if (device_map1_.empty()) {
+      map1_.copyTo(device_map1_);
+      map2_.copyTo(device_map2_);
+    }
+    device_map1 = device_map1_;
+    device_map2 = device_map2_;
+  }
+  cv::remap(src, dst, device_map1, device_map2, interpolation, cv::BORDER_CONSTANT);
+}
+
+}  // namespace image_proc
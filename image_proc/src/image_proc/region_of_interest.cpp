@@ -0,0 +1,189 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <image_proc/region_of_interest.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
+namespace image_proc
+{
+
+RegionOfInterest::RegionOfInterest(rclcpp::Node * node)
+{
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  rcl_interfaces::msg::IntegerRange range;
+  range.from_value = 0;
+  range.to_value = 1 << 16;
+  descriptor.integer_range.push_back(range);
+
+  cv::Rect requested;
+  requested.x = node->declare_parameter("roi.x_offset", 0, descriptor);
+  requested.y = node->declare_parameter("roi.y_offset", 0, descriptor);
+  requested.width = node->declare_parameter("roi.width", 0, descriptor);
+  requested.height = node->declare_parameter("roi.height", 0, descriptor);
+  requested_.set(requested);
+
+  on_set_parameters_handle_ = node->add_on_set_parameters_callback(
+    std::bind(&RegionOfInterest::parameterSetCb, this, std::placeholders::_1));
+}
+
+bool RegionOfInterest::enabled() const
+{
+  return requested_.get()->area() > 0;
+}
+
+cv::Rect RegionOfInterest::window(const cv::Size & size) const
+{
+  const cv::Rect image(cv::Point(), size);
+  const cv::Rect requested = *requested_.get();
+  if (requested.area() == 0) {
+    return image;
+  }
+  return requested & image;
+}
+
+cv::Rect RegionOfInterest::crop(
+  sensor_msgs::msg::Image::ConstSharedPtr & image,
+  sensor_msgs::msg::CameraInfo::ConstSharedPtr & info) const
+{
+  const cv::Size size(static_cast<int>(image->width), static_cast<int>(image->height));
+  const cv::Rect cropped = window(size);
+  if (cropped.size() != size && !cropped.empty()) {
+    image = cropImage(*image, cropped);
+    info = cropCameraInfo(*info, cropped);
+  }
+  return cropped;
+}
+
+cv::Rect RegionOfInterest::crop(
+  sensor_msgs::msg::Image::ConstSharedPtr & image,
+  sensor_msgs::msg::Image::ConstSharedPtr & second_image,
+  sensor_msgs::msg::CameraInfo::ConstSharedPtr & info) const
+{
+  const cv::Size size(static_cast<int>(image->width), static_cast<int>(image->height));
+  const cv::Rect cropped = window(size);
+  if (cropped.size() != size && !cropped.empty()) {
+    const cv::Rect second_cropped = scaleWindow(
+      cropped, size,
+      cv::Size(static_cast<int>(second_image->width), static_cast<int>(second_image->height)));
+    image = cropImage(*image, cropped);
+    second_image = cropImage(*second_image, second_cropped);
+    info = cropCameraInfo(*info, second_cropped);
+  }
+  return cropped;
+}
+
+rcl_interfaces::msg::SetParametersResult RegionOfInterest::parameterSetCb(
+  const std::vector<rclcpp::Parameter> & parameters)
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+  requested_.update(
+    [&parameters](cv::Rect & requested) {
+      for (const auto & param : parameters) {
+        if (param.get_name() == "roi.x_offset") {
+          requested.x = static_cast<int>(param.as_int());
+        } else if (param.get_name() == "roi.y_offset") {
+          requested.y = static_cast<int>(param.as_int());
+        } else if (param.get_name() == "roi.width") {
+          requested.width = static_cast<int>(param.as_int());
+        } else if (param.get_name() == "roi.height") {
+          requested.height = static_cast<int>(param.as_int());
+        }
+      }
+    });
+  return result;
+}
+
+sensor_msgs::msg::Image::SharedPtr cropImage(
+  const sensor_msgs::msg::Image & image, const cv::Rect & window)
+{
+  namespace enc = sensor_msgs::image_encodings;
+  const size_t bytes = enc::numChannels(image.encoding) * enc::bitDepth(image.encoding) / 8;
+
+  auto cropped = std::make_shared<sensor_msgs::msg::Image>();
+  cropped->header = image.header;
+  cropped->encoding = image.encoding;
+  cropped->is_bigendian = image.is_bigendian;
+  cropped->width = window.width;
+  cropped->height = window.height;
+  cropped->step = static_cast<uint32_t>(window.width * bytes);
+  cropped->data.resize(static_cast<size_t>(cropped->step) * window.height);
+  for (int v = 0; v < window.height; ++v) {
+    std::memcpy(
+      &cropped->data[v * cropped->step],
+      &image.data[(window.y + v) * image.step + window.x * bytes], cropped->step);
+  }
+  return cropped;
+}
+
+cv::Rect scaleWindow(const cv::Rect & window, const cv::Size & from, const cv::Size & to)
+{
+  if (from == to) {
+    return window;
+  }
+  const double scale_x = static_cast<double>(to.width) / from.width;
+  const double scale_y = static_cast<double>(to.height) / from.height;
+  const cv::Point tl(cvFloor(window.x * scale_x), cvFloor(window.y * scale_y));
+  const cv::Point br(cvCeil(window.br().x * scale_x), cvCeil(window.br().y * scale_y));
+  return cv::Rect(tl, br) & cv::Rect(cv::Point(), to);
+}
+
+sensor_msgs::msg::CameraInfo::SharedPtr cropCameraInfo(
+  const sensor_msgs::msg::CameraInfo & info, const cv::Rect & window)
+{
+  // K and P are in full resolution pixels, the window in binned ones
+  const int binning_x = std::max<int>(info.binning_x, 1);
+  const int binning_y = std::max<int>(info.binning_y, 1);
+  const double x_offset = window.x * binning_x;
+  const double y_offset = window.y * binning_y;
+
+  auto cropped = std::make_shared<sensor_msgs::msg::CameraInfo>(info);
+  cropped->width = window.width * binning_x;
+  cropped->height = window.height * binning_y;
+  cropped->k[2] -= x_offset;
+  cropped->k[5] -= y_offset;
+  cropped->p[2] -= x_offset;
+  cropped->p[6] -= y_offset;
+  return cropped;
+}
+
+}  // namespace image_proc
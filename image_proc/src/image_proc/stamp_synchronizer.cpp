@@ -0,0 +1,139 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "image_proc/stamp_synchronizer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace image_proc
+{
+
+StampSynchronizerBase::StampSynchronizerBase(size_t queue_size, size_t inputs)
+: full_(inputs >= 32 ? ~0u : (1u << inputs) - 1u),
+  keys_(std::max<size_t>(queue_size, 1), 0),
+  inputs_(keys_.size(), 0)
+{
+  index_.reserve(keys_.size());
+  free_.reserve(keys_.size());
+  for (size_t slot = keys_.size(); slot-- > 0; ) {
+    free_.push_back(slot);
+  }
+}
+
+StampSynchronizerBase::~StampSynchronizerBase() = default;
+
+StampSynchronizerBase::Statistics StampSynchronizerBase::statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics statistics = statistics_;
+  statistics.pending = index_.size();
+  return statistics;
+}
+
+void StampSynchronizerBase::publishDiagnostics(diagnostic_updater::Updater & updater)
+{
+  updater.add("Synchronization", this, &StampSynchronizerBase::status);
+}
+
+size_t StampSynchronizerBase::insert(
+  const builtin_interfaces::msg::Time & stamp, size_t input, bool & reset)
+{
+  const int64_t key = static_cast<int64_t>(stamp.sec) * 1000000000LL + stamp.nanosec;
+  reset = false;
+  size_t slot;
+  const auto found = index_.find(key);
+  if (found != index_.end()) {
+    slot = found->second;
+  } else {
+    if (free_.empty()) {
+      // Every slot waits for inputs. The oldest set is the least likely to
+      // complete, unless the new message is older still.
+      slot = static_cast<size_t>(std::min_element(keys_.begin(), keys_.end()) - keys_.begin());
+      ++statistics_.missed;
+      if (key < keys_[slot]) {
+        return NO_SLOT;
+      }
+      index_.erase(keys_[slot]);
+      reset = true;
+    } else {
+      slot = free_.back();
+      free_.pop_back();
+    }
+    keys_[slot] = key;
+    inputs_[slot] = 0;
+    index_.emplace(key, slot);
+  }
+
+  const uint32_t bit = 1u << input;
+  if (inputs_[slot] & bit) {
+    ++statistics_.duplicates;
+  }
+  inputs_[slot] |= bit;
+  return slot;
+}
+
+bool StampSynchronizerBase::complete(size_t slot)
+{
+  if (inputs_[slot] != full_) {
+    return false;
+  }
+  index_.erase(keys_[slot]);
+  inputs_[slot] = 0;
+  free_.push_back(slot);
+  ++statistics_.matched;
+  return true;
+}
+
+void StampSynchronizerBase::status(diagnostic_updater::DiagnosticStatusWrapper & status)
+{
+  // Counts of the last period
+  const Statistics total = statistics();
+  Statistics period;
+  period.matched = total.matched - reported_.matched;
+  period.missed = total.missed - reported_.missed;
+  period.duplicates = total.duplicates - reported_.duplicates;
+  reported_ = total;
+
+  if (period.missed > 0) {
+    status.summary(diagnostic_msgs::msg::DiagnosticStatus::WARN, "Missing inputs");
+  } else {
+    status.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "OK");
+  }
+  status.add("Matched sets", period.matched);
+  status.add("Missed sets", period.missed);
+  status.add("Duplicate messages", period.duplicates);
+  status.add("Pending sets", total.pending);
+}
+
+}  // namespace image_proc
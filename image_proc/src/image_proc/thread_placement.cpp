@@ -0,0 +1,288 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <image_proc/thread_placement.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+std::atomic<uint64_t> next_id{1};
+
+// ThreadPlacements that placed the calling thread
+thread_local std::vector<uint64_t> placed_by;
+
+#ifdef __linux__
+// MPOL_PREFERRED of <numaif.h>, so that libnuma is not needed
+constexpr int MPOL_PREFERRED_POLICY = 1;
+
+std::string policyName(int policy)
+{
+  switch (policy) {
+    case SCHED_FIFO:
+      return "SCHED_FIFO";
+    case SCHED_RR:
+      return "SCHED_RR";
+    case SCHED_OTHER:
+      return "SCHED_OTHER";
+    default:
+      return "policy " + std::to_string(policy);
+  }
+}
+#endif
+
+}  // namespace
+
+ThreadPlacement::ThreadPlacement(rclcpp::Node * node, bool owned_threads)
+: logger_(node->get_logger()),
+  id_(next_id++)
+{
+  const std::vector<int64_t> cpus =
+    node->declare_parameter<std::vector<int64_t>>("cpu_affinity", std::vector<int64_t>());
+  priority_ = std::max(node->declare_parameter("realtime_priority", 0), 0);
+  numa_node_ = std::max(node->declare_parameter("numa_node", -1), -1);
+
+  for (int64_t cpu : cpus) {
+    if (cpu >= 0) {
+      cpus_.push_back(static_cast<int>(cpu));
+    }
+  }
+  std::sort(cpus_.begin(), cpus_.end());
+  cpus_.erase(std::unique(cpus_.begin(), cpus_.end()), cpus_.end());
+
+  if (numa_node_ >= 0) {
+    std::ifstream file(
+      "/sys/devices/system/node/node" + std::to_string(numa_node_) + "/cpulist");
+    std::string list;
+    std::getline(file, list);
+    const std::vector<int> node_cpus = parseCpuList(list);
+    std::vector<int> common;
+    std::set_intersection(
+      cpus_.begin(), cpus_.end(), node_cpus.begin(), node_cpus.end(),
+      std::back_inserter(common));
+
+    if (node_cpus.empty()) {
+      RCLCPP_WARN(logger_, "NUMA node %d not found, ignoring numa_node", numa_node_);
+      numa_node_ = -1;
+    } else if (cpus_.empty()) {
+      cpus_ = node_cpus;
+    } else if (common.empty()) {
+      RCLCPP_WARN(
+        logger_, "None of the CPUs of cpu_affinity is on NUMA node %d, using all of its CPUs",
+        numa_node_);
+      cpus_ = node_cpus;
+    } else {
+      cpus_ = common;
+    }
+  }
+
+#ifdef __linux__
+  priority_ = std::min(priority_, sched_get_priority_max(SCHED_FIFO));
+#else
+  if (enabled()) {
+    RCLCPP_WARN(logger_, "Thread placement is only supported on Linux, ignoring it");
+    cpus_.clear();
+    priority_ = 0;
+    numa_node_ = -1;
+  }
+#endif
+
+  if (enabled() && !owned_threads) {
+    RCLCPP_WARN(
+      logger_, "cpu_affinity, realtime_priority and numa_node need threads of the node's own, "
+      "e.g. a concurrency above 1. Not placing the executor threads shared with other nodes");
+    cpus_.clear();
+    priority_ = 0;
+    numa_node_ = -1;
+  }
+
+  if (enabled()) {
+    RCLCPP_INFO(
+      logger_, "Placing processing threads on CPUs %s, %s, NUMA node %s",
+      cpus_.empty() ? "any" : formatCpuList(cpus_).c_str(),
+      priority_ > 0 ? ("SCHED_FIFO priority " + std::to_string(priority_)).c_str() :
+      "default scheduling",
+      numa_node_ >= 0 ? std::to_string(numa_node_).c_str() : "any");
+  }
+}
+
+void ThreadPlacement::placeCurrentThread(const char * name)
+{
+  if (!enabled() || std::find(placed_by.begin(), placed_by.end(), id_) != placed_by.end()) {
+    return;
+  }
+  placed_by.push_back(id_);
+  place(name);
+}
+
+void ThreadPlacement::place(const char * name)
+{
+#ifdef __linux__
+  if (!cpus_.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus_) {
+      if (cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0) {
+      RCLCPP_WARN(
+        logger_, "Could not pin thread '%s' to CPUs %s: %s", name,
+        formatCpuList(cpus_).c_str(), std::strerror(error));
+    }
+  }
+
+  if (numa_node_ >= 0) {
+    // Memory of the thread is allocated on the node first, then elsewhere
+    const size_t bits = 8 * sizeof(unsigned long);  // NOLINT
+    std::vector<unsigned long> mask(numa_node_ / bits + 1, 0);  // NOLINT
+    mask[numa_node_ / bits] |= 1ul << (numa_node_ % bits);
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_POLICY, mask.data(), mask.size() * bits + 1)) {
+      RCLCPP_WARN(
+        logger_, "Could not prefer the memory of NUMA node %d for thread '%s': %s",
+        numa_node_, name, std::strerror(errno));
+    }
+  }
+
+  if (priority_ > 0) {
+    sched_param param{};
+    param.sched_priority = priority_;
+    const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error != 0) {
+      RCLCPP_WARN(
+        logger_, "Could not set SCHED_FIFO priority %d for thread '%s': %s. It needs "
+        "CAP_SYS_NICE or a high enough rtprio limit", priority_, name, std::strerror(error));
+    }
+  }
+
+  // Report what the thread actually got
+  std::vector<int> actual_cpus;
+  cpu_set_t actual;
+  CPU_ZERO(&actual);
+  if (pthread_getaffinity_np(pthread_self(), sizeof(actual), &actual) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &actual)) {
+        actual_cpus.push_back(cpu);
+      }
+    }
+  }
+  int policy = SCHED_OTHER;
+  sched_param param{};
+  pthread_getschedparam(pthread_self(), &policy, &param);
+  unsigned int cpu = 0;
+  unsigned int node = 0;
+  syscall(SYS_getcpu, &cpu, &node, nullptr);
+
+  RCLCPP_INFO(
+    logger_, "Thread '%s' (tid %ld) may run on CPUs %s with %s priority %d, "
+    "now on CPU %u of NUMA node %u", name, static_cast<long>(syscall(SYS_gettid)),  // NOLINT
+    formatCpuList(actual_cpus).c_str(), policyName(policy).c_str(), param.sched_priority,
+    cpu, node);
+#else
+  (void)name;
+#endif
+}
+
+std::vector<int> ThreadPlacement::parseCpuList(const std::string & list)
+{
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    int first;
+    int last;
+    char dash;
+    std::stringstream range_stream(range);
+    if (!(range_stream >> first)) {
+      continue;
+    }
+    last = first;
+    if (range_stream >> dash && dash == '-' && !(range_stream >> last)) {
+      continue;
+    }
+    for (int cpu = std::max(first, 0); cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+std::string ThreadPlacement::formatCpuList(std::vector<int> cpus)
+{
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+  std::string list;
+  for (size_t i = 0; i < cpus.size(); ) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    if (!list.empty()) {
+      list += ",";
+    }
+    list += std::to_string(cpus[i]);
+    if (j > i) {
+      list += "-" + std::to_string(cpus[j]);
+    }
+    i = j + 1;
+  }
+  return list;
+}
+
+}  // namespace image_proc
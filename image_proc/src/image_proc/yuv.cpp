@@ -0,0 +1,166 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+
+#include <image_proc/yuv.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Channel of the luma samples in the view of a 4:2:2 image
+int lumaChannel(const std::string & encoding)
+{
+  return encoding == sensor_msgs::image_encodings::YUV422 ? 1 : 0;
+}
+
+}  // namespace
+
+bool isYuv(const std::string & encoding)
+{
+  return encoding == sensor_msgs::image_encodings::YUV422 ||
+         encoding == sensor_msgs::image_encodings::YUV422_YUY2 ||
+         encoding == yuv_encodings::NV12;
+}
+
+cv::Mat yuvView(const sensor_msgs::msg::Image & image)
+{
+  if (!isYuv(image.encoding)) {
+    return cv::Mat();
+  }
+
+  // Chroma is subsampled by two horizontally, and for NV12 vertically too
+  const bool nv12 = image.encoding == yuv_encodings::NV12;
+  const int rows = yuvRows(image.encoding, image.height);
+  const size_t row_size = static_cast<size_t>(image.width) * (nv12 ? 1 : 2);
+  if (image.width % 2 != 0 || (nv12 && image.height % 2 != 0) || image.step < row_size ||
+    image.data.size() < static_cast<size_t>(image.step) * rows)
+  {
+    return cv::Mat();
+  }
+
+  return cv::Mat(
+    rows, image.width, nv12 ? CV_8UC1 : CV_8UC2,
+    const_cast<uint8_t *>(image.data.data()), image.step);
+}
+
+int yuvRows(const std::string & encoding, int height)
+{
+  return encoding == yuv_encodings::NV12 ? height * 3 / 2 : height;
+}
+
+cv::Size yuvSize(const std::string & encoding, const cv::Mat & view)
+{
+  return cv::Size(view.cols, encoding == yuv_encodings::NV12 ? view.rows * 2 / 3 : view.rows);
+}
+
+cv::Size yuvAlignedSize(const std::string & encoding, const cv::Size & size)
+{
+  return cv::Size(
+    size.width & ~1, encoding == yuv_encodings::NV12 ? size.height & ~1 : size.height);
+}
+
+bool yuvToMono(const sensor_msgs::msg::Image & image, cv::Mat & mono)
+{
+  const cv::Mat view = yuvView(image);
+  if (view.empty()) {
+    return false;
+  }
+
+  if (image.encoding == yuv_encodings::NV12) {
+    // The luma plane is the image already
+    view.rowRange(0, image.height).copyTo(mono);
+  } else {
+    cv::extractChannel(view, mono, lumaChannel(image.encoding));
+  }
+  return true;
+}
+
+bool yuvToBgr(const sensor_msgs::msg::Image & image, cv::Mat & bgr)
+{
+  const cv::Mat view = yuvView(image);
+  if (view.empty()) {
+    return false;
+  }
+
+  int code = cv::COLOR_YUV2BGR_NV12;
+  if (image.encoding == sensor_msgs::image_encodings::YUV422) {
+    code = cv::COLOR_YUV2BGR_UYVY;
+  } else if (image.encoding == sensor_msgs::image_encodings::YUV422_YUY2) {
+    code = cv::COLOR_YUV2BGR_YUY2;
+  }
+  cv::cvtColor(view, bgr, code);
+  return true;
+}
+
+void resizeYuv(
+  const cv::Mat & src, const std::string & encoding, const cv::Size & size,
+  int interpolation, cv::Mat & dst)
+{
+  const bool nv12 = encoding == yuv_encodings::NV12;
+  const cv::Size chroma_size(size.width / 2, nv12 ? size.height / 2 : size.height);
+
+  if (nv12) {
+    // Both planes straight into dst, the chroma one as one U and V pair per column
+    const int src_rows = src.rows * 2 / 3;
+    dst.create(yuvRows(encoding, size.height), size.width, CV_8UC1);
+    cv::Mat dst_luma = dst.rowRange(0, size.height);
+    cv::Mat dst_chroma = dst.rowRange(size.height, dst.rows).reshape(2);
+    cv::resize(src.rowRange(0, src_rows), dst_luma, size, 0.0, 0.0, interpolation);
+    cv::resize(
+      src.rowRange(src_rows, src.rows).reshape(2), dst_chroma, chroma_size, 0.0, 0.0,
+      interpolation);
+    return;
+  }
+
+  // Split the luma and the alternating U and V samples, one pair per column
+  const int luma = lumaChannel(encoding);
+  cv::Mat src_luma, src_chroma, dst_luma, dst_chroma;
+  cv::extractChannel(src, src_luma, luma);
+  cv::extractChannel(src, src_chroma, 1 - luma);
+  cv::resize(src_luma, dst_luma, size, 0.0, 0.0, interpolation);
+  cv::resize(src_chroma.reshape(2), dst_chroma, chroma_size, 0.0, 0.0, interpolation);
+
+  dst.create(size, CV_8UC2);
+  cv::insertChannel(dst_luma, dst, luma);
+  cv::insertChannel(dst_chroma.reshape(1), dst, 1 - luma);
+}
+
+}  // namespace image_proc
@@ -0,0 +1,262 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/frame_scheduler.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/multi_camera.hpp>
+#include <image_proc/processor.hpp>
+#include <image_proc/utils.hpp>
+#include <image_transport/image_transport.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace image_proc
+{
+
+MultiCameraNode::MultiCameraNode(const rclcpp::NodeOptions & options)
+: rclcpp::Node("MultiCameraNode", options)
+{
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("image_transport", "raw");
+
+  // Namespaces of the cameras, each with image_raw and camera_info
+  const std::vector<std::string> names =
+    this->declare_parameter<std::vector<std::string>>("cameras", std::vector<std::string>());
+  const int interpolation = this->declare_parameter("interpolation", 1);
+  const bool fused_debayer_rectify = this->declare_parameter("fused_debayer_rectify", false);
+  const bool rect_from_rect_color = this->declare_parameter("rect_from_rect_color", false);
+  use_buffer_pool_ = this->declare_parameter("use_buffer_pool", false);
+
+  // Shared pool, at most queue_depth frames waiting per camera, dropped if
+  // still waiting deadline seconds after they came in
+  const int threads = this->declare_parameter(
+    "threads", static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+  const int queue_depth = this->declare_parameter("queue_depth", 1);
+  const double deadline = this->declare_parameter("deadline", 0.1);
+  scheduler_ = std::make_unique<FrameScheduler>(
+    names.size(), static_cast<size_t>(std::max(threads, 1)),
+    static_cast<size_t>(std::max(queue_depth, 1)),
+    std::chrono::duration_cast<FrameScheduler::Clock::duration>(
+      std::chrono::duration<double>(std::max(deadline, 0.0))));
+
+  if (names.empty()) {
+    RCLCPP_WARN(this->get_logger(), "No cameras given in the 'cameras' parameter");
+  }
+
+  auto node_base = this->get_node_base_interface();
+  for (size_t index = 0; index < names.size(); ++index) {
+    auto camera = std::make_unique<Camera>();
+    camera->processor.interpolation_ = interpolation;
+    camera->processor.fused_debayer_rectify_ = fused_debayer_rectify;
+    camera->processor.rect_from_rect_color_ = rect_from_rect_color;
+    // For compressed topics to remap appropriately, we need to pass a
+    // fully expanded and remapped topic name to image_transport
+    camera->image_topic =
+      node_base->resolve_topic_or_service_name(names[index] + "/image_raw", false);
+    cameras_.push_back(std::move(camera));
+  }
+
+  // Every camera subscribes lazily, on the subscribers of its own outputs
+  for (size_t index = 0; index < cameras_.size(); ++index) {
+    Camera & camera = *cameras_[index];
+    rclcpp::PublisherOptions pub_options;
+    pub_options.event_callbacks.matched_callback =
+      [this, index](rclcpp::MatchedInfo &) {connectCb(index);};
+
+    // Allow overriding QoS settings (history, depth, reliability)
+    pub_options.qos_overriding_options = rclcpp::QosOverridingOptions::with_default_policies();
+
+    // Create publishers with QoS matched to subscribed topic publisher
+    auto qos_profile = getTopicQosProfile(this, camera.image_topic);
+    auto topic = [&](const char * name) {
+        return node_base->resolve_topic_or_service_name(names[index] + "/" + name, false);
+      };
+    camera.pub_mono =
+      image_transport::create_publisher(this, topic("image_mono"), qos_profile, pub_options);
+    camera.pub_color =
+      image_transport::create_publisher(this, topic("image_color"), qos_profile, pub_options);
+    camera.pub_rect =
+      image_transport::create_publisher(this, topic("image_rect"), qos_profile, pub_options);
+    camera.pub_rect_color = image_transport::create_publisher(
+      this, topic("image_rect_color"), qos_profile, pub_options);
+  }
+
+  processing_ = std::make_unique<ProcessingDiagnostics>(this);
+}
+
+void MultiCameraNode::connectCb(size_t index)
+{
+  std::lock_guard<std::mutex> lock(connect_mutex_);
+  if (index >= cameras_.size()) {
+    return;
+  }
+  Camera & camera = *cameras_[index];
+  if (camera.pub_mono.getNumSubscribers() == 0 && camera.pub_color.getNumSubscribers() == 0 &&
+    camera.pub_rect.getNumSubscribers() == 0 && camera.pub_rect_color.getNumSubscribers() == 0)
+  {
+    camera.sub.shutdown();
+  } else if (!camera.sub) {
+    // Create subscriber with QoS matched to subscribed topic publisher
+    auto qos_profile = getTopicQosProfile(this, camera.image_topic);
+    image_transport::TransportHints hints(this);
+    camera.sub = image_transport::create_camera_subscription(
+      this, camera.image_topic, std::bind(
+        &MultiCameraNode::imageCb, this, index,
+        std::placeholders::_1, std::placeholders::_2), hints.getTransport(), qos_profile);
+  }
+}
+
+void MultiCameraNode::imageCb(
+  size_t index,
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
+{
+  // Queued for the shared workers, which also tell about frames dropped
+  // behind newer ones of the camera or past their deadline
+  Camera * camera = cameras_[index].get();
+  scheduler_->submit(
+    index, [this, camera, image_msg, info_msg](bool process) {
+      if (process) {
+        processImage(*camera, image_msg, info_msg);
+      } else {
+        processing_->dropped();
+      }
+    });
+}
+
+void MultiCameraNode::processImage(
+  Camera & camera,
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/multi_camera", image_msg.get(), image_msg->width, image_msg->height,
+    image_msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+
+  int flags = 0;
+  if (camera.pub_mono.getNumSubscribers()) {
+    flags |= Processor::MONO;
+  }
+  if (camera.pub_color.getNumSubscribers()) {
+    flags |= Processor::COLOR;
+  }
+  if (camera.pub_rect.getNumSubscribers()) {
+    flags |= Processor::RECT;
+  }
+  if (camera.pub_rect_color.getNumSubscribers()) {
+    flags |= Processor::RECT_COLOR;
+  }
+
+  // Verify camera is actually calibrated
+  if ((flags & (Processor::RECT | Processor::RECT_COLOR)) && info_msg->k[0] == 0.0) {
+    RCLCPP_ERROR_THROTTLE(
+      this->get_logger(), *this->get_clock(), 10000,
+      "Rectified topics of '%s' requested but the camera is uncalibrated",
+      camera.image_topic.c_str());
+    flags &= ~(Processor::RECT | Processor::RECT_COLOR);
+  }
+  if (!flags) {
+    return;
+  }
+
+  // The model and its rectification maps are shared with the other nodes of
+  // the process handling the same camera
+  const auto model = CameraCache::instance().pinholeModel(*info_msg);
+  ImageSet output;
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", image_msg.get());
+    if (!camera.processor.process(image_msg, *model, output, camera.arena, flags)) {
+      return;
+    }
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", image_msg.get());
+    // 16-bit mosaics give 16-bit images
+    const bool wide = output.color_encoding == sensor_msgs::image_encodings::BGR16;
+    const std::string & mono_encoding =
+      wide ? sensor_msgs::image_encodings::MONO16 : sensor_msgs::image_encodings::MONO8;
+    if (flags & Processor::MONO) {
+      publishImage(camera.pub_mono, image_msg, mono_encoding, output.mono);
+    }
+    if (flags & Processor::COLOR) {
+      publishImage(camera.pub_color, image_msg, output.color_encoding, output.color);
+    }
+    if (flags & Processor::RECT) {
+      publishImage(camera.pub_rect, image_msg, mono_encoding, output.rect);
+    }
+    if (flags & Processor::RECT_COLOR) {
+      publishImage(camera.pub_rect_color, image_msg, output.color_encoding, output.rect_color);
+    }
+    frame.published(image_msg->header.stamp);
+  }
+}
+
+void MultiCameraNode::publishImage(
+  const image_transport::Publisher & pub,
+  const sensor_msgs::msg::Image::ConstSharedPtr & raw_msg,
+  const std::string & encoding, const cv::Mat & image)
+{
+  // An image that is the raw image itself goes out as the raw message
+  if (image.data == raw_msg->data.data() && encoding == raw_msg->encoding) {
+    pub.publish(raw_msg);
+    return;
+  }
+  // The others live in the arena of the camera, which the next frame reuses
+  OutputImage out(
+    use_buffer_pool_, raw_msg->header, encoding, image.rows, image.cols, image.type());
+  image.copyTo(out.mat());
+  out.publish(pub);
+}
+
+}  // namespace image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(image_proc::MultiCameraNode)
@@ -0,0 +1,383 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <image_proc/pipeline_benchmark.hpp>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
+namespace image_proc
+{
+
+namespace
+{
+
+// Suffix of the statuses of ProcessingDiagnostics, after the node name
+const char kProcessingStatus[] = ": Processing";
+
+// Smoothed noise, textured enough for block matching
+cv::Mat texture(int width, int height)
+{
+  cv::Mat noise(height, width, CV_8UC1);
+  cv::RNG rng(42);
+  rng.fill(noise, cv::RNG::UNIFORM, 0, 256);
+  cv::GaussianBlur(noise, noise, cv::Size(5, 5), 1.5);
+  return noise;
+}
+
+void toMessage(
+  const cv::Mat & image, const std::string & encoding, const std::string & frame_id,
+  sensor_msgs::msg::Image & msg)
+{
+  msg.header.frame_id = frame_id;
+  msg.height = image.rows;
+  msg.width = image.cols;
+  msg.encoding = encoding;
+  msg.is_bigendian = false;
+  msg.step = image.cols * image.elemSize();
+  msg.data.assign(image.datastart, image.dataend);
+}
+
+// Camera with a 70 degree horizontal field of view and mild barrel
+// distortion, baseline meters to the right of the first one
+sensor_msgs::msg::CameraInfo cameraInfo(
+  int width, int height, const std::string & frame_id, double baseline)
+{
+  sensor_msgs::msg::CameraInfo info;
+  info.header.frame_id = frame_id;
+  info.width = width;
+  info.height = height;
+  const double f = 0.7 * width;
+  info.distortion_model = "plumb_bob";
+  info.d = {-0.1, 0.01, 0.0, 0.0, 0.0};
+  info.k = {f, 0.0, width / 2.0, 0.0, f, height / 2.0, 0.0, 0.0, 1.0};
+  info.r = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+  info.p = {f, 0.0, width / 2.0, -f * baseline, 0.0, f, height / 2.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  return info;
+}
+
+double milliseconds(double seconds)
+{
+  return seconds * 1e3;
+}
+
+}  // namespace
+
+PipelineBenchmarkNode::PipelineBenchmarkNode(const rclcpp::NodeOptions & options)
+: Node("PipelineBenchmarkNode", options)
+{
+  const std::string mode = this->declare_parameter("mode", std::string("stereo"));
+  stereo_ = mode != "depth";
+  if (stereo_ && mode != "stereo") {
+    RCLCPP_WARN(get_logger(), "Unknown mode '%s', replaying stereo frames", mode.c_str());
+  }
+  const int width = this->declare_parameter("width", 1280);
+  const int height = this->declare_parameter("height", 720);
+  rates_ = this->declare_parameter(
+    "rates", std::vector<double>{5.0, 10.0, 15.0, 20.0, 30.0, 45.0, 60.0, 90.0});
+  rates_.erase(
+    std::remove_if(rates_.begin(), rates_.end(), [](double rate) {return rate <= 0.0;}),
+    rates_.end());
+  warmup_ = std::chrono::duration<double>(this->declare_parameter("warmup", 2.0));
+  step_duration_ = std::chrono::duration<double>(this->declare_parameter("step_duration", 10.0));
+  label_ = this->declare_parameter("label", std::string());
+  const std::string report_file = this->declare_parameter("report_file", std::string());
+  saturation_delivery_ = this->declare_parameter("saturation_delivery", 0.95);
+  shutdown_when_done_ = this->declare_parameter("shutdown_when_done", true);
+
+  // The pixels of the frames are built once and copied into every message,
+  // as a camera driver would
+  const cv::Mat left = texture(width, height);
+  std::string first_topic, second_topic;
+  if (stereo_) {
+    // Same texture 32 pixels further left in the right image
+    cv::Mat right = cv::Mat::zeros(left.size(), left.type());
+    const int shift = std::min(32, width / 4);
+    left.colRange(shift, width).copyTo(right.colRange(0, width - shift));
+    // The gray texture is a valid Bayer mosaic, so the debayer stage runs too
+    toMessage(left, sensor_msgs::image_encodings::BAYER_RGGB8, "benchmark_left", first_image_);
+    toMessage(right, sensor_msgs::image_encodings::BAYER_RGGB8, "benchmark_right", second_image_);
+    first_info_ = cameraInfo(width, height, "benchmark_left", 0.0);
+    second_info_ = cameraInfo(width, height, "benchmark_right", 0.1);
+    first_topic = "left/image_raw";
+    second_topic = "right/image_raw";
+  } else {
+    // 2 to 3 m of depth in millimeters, and the texture in color
+    cv::Mat depth;
+    left.convertTo(depth, CV_16U, 4.0, 2000.0);
+    cv::Mat color;
+    cv::cvtColor(left, color, cv::COLOR_GRAY2BGR);
+    toMessage(depth, sensor_msgs::image_encodings::TYPE_16UC1, "benchmark_depth", first_image_);
+    toMessage(color, sensor_msgs::image_encodings::BGR8, "benchmark_rgb", second_image_);
+    first_info_ = cameraInfo(width, height, "benchmark_depth", 0.0);
+    second_info_ = cameraInfo(width, height, "benchmark_rgb", 0.0);
+    first_topic = "depth/image_rect";
+    second_topic = "rgb/image_rect_color";
+  }
+
+  const rclcpp::QoS qos(10);
+  pub_first_image_ = create_publisher<Image>(first_topic, qos);
+  pub_second_image_ = create_publisher<Image>(second_topic, qos);
+  pub_first_info_ = create_publisher<CameraInfo>(
+    first_topic.substr(0, first_topic.find('/')) + "/camera_info", qos);
+  pub_second_info_ = create_publisher<CameraInfo>(
+    second_topic.substr(0, second_topic.find('/')) + "/camera_info", qos);
+
+  sub_points_ = create_subscription<PointCloud2>(
+    "points", qos,
+    std::bind(&PipelineBenchmarkNode::pointsCb, this, std::placeholders::_1));
+  sub_diagnostics_ = create_subscription<DiagnosticArray>(
+    "/diagnostics", rclcpp::QoS(100),
+    std::bind(&PipelineBenchmarkNode::diagnosticsCb, this, std::placeholders::_1));
+
+  if (!report_file.empty()) {
+    report_.open(report_file, std::ios::app);
+    if (!report_) {
+      RCLCPP_ERROR(get_logger(), "Cannot open report file '%s'", report_file.c_str());
+    } else if (report_.tellp() == 0) {
+      report_ << "label,rate,stage,sent,received,published,dropped,p50_ms,p99_ms,max_ms\n";
+    }
+  }
+
+  step_timer_ = create_wall_timer(
+    std::chrono::milliseconds(100), std::bind(&PipelineBenchmarkNode::stepTimerCb, this));
+}
+
+void PipelineBenchmarkNode::stepTimerCb()
+{
+  // The lazy stages only subscribe upstream once the clouds are subscribed
+  if (!started_) {
+    if (pub_first_image_->get_subscription_count() == 0 ||
+      pub_second_image_->get_subscription_count() == 0)
+    {
+      RCLCPP_INFO_THROTTLE(
+        get_logger(), *get_clock(), 5000, "Waiting for the pipeline to subscribe");
+      return;
+    }
+    started_ = true;
+    startStep();
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!measuring_ && now - step_start_ >= warmup_) {
+    // Frames stamped before now were sent during the warm up
+    sent_ = 0;
+    received_ = 0;
+    tracetools_image_pipeline::DurationHistogram::Distribution discarded;
+    latency_.collect(discarded);
+    stages_.clear();
+    measure_start_ = now;
+    measure_stamp_ = this->now();
+    measuring_ = true;
+  } else if (measuring_ && now - measure_start_ >= step_duration_) {
+    lock.unlock();
+    finishStep();
+  }
+}
+
+void PipelineBenchmarkNode::startStep()
+{
+  if (step_ == rates_.size() || saturation_rate_ > 0.0) {
+    step_timer_->cancel();
+    if (saturation_rate_ > 0.0) {
+      RCLCPP_INFO(get_logger(), "Pipeline saturated at %.1f Hz", saturation_rate_);
+    } else if (!rates_.empty()) {
+      RCLCPP_INFO(get_logger(), "Pipeline not saturated up to %.1f Hz", rates_.back());
+    }
+    if (shutdown_when_done_) {
+      rclcpp::shutdown();
+    }
+    return;
+  }
+
+  const double rate = rates_[step_];
+  RCLCPP_INFO(get_logger(), "Replaying frames at %.1f Hz", rate);
+  step_start_ = std::chrono::steady_clock::now();
+  frame_timer_ = create_wall_timer(
+    std::chrono::duration<double>(1.0 / rate),
+    std::bind(&PipelineBenchmarkNode::publishFrame, this));
+}
+
+void PipelineBenchmarkNode::finishStep()
+{
+  frame_timer_->cancel();
+  const double rate = rates_[step_];
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  measuring_ = false;
+  const double elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - measure_start_).count();
+  tracetools_image_pipeline::DurationHistogram::Distribution latency;
+  latency_.collect(latency);
+  const double delivery = sent_ > 0 ? static_cast<double>(received_) / sent_ : 0.0;
+
+  RCLCPP_INFO(
+    get_logger(),
+    "%.1f Hz: %zu frames in, %.1f Hz out (%.0f%% delivered), "
+    "latency p50 %.1f ms, p99 %.1f ms, max %.1f ms",
+    rate, sent_, received_ / elapsed, delivery * 100.0,
+    milliseconds(latency.p50), milliseconds(latency.p99), milliseconds(latency.max));
+  if (report_) {
+    report_ << label_ << ',' << rate << ",end_to_end," << sent_ << ',' << received_ << ','
+            << received_ << ",0," << milliseconds(latency.p50) << ',' <<
+      milliseconds(latency.p99) << ',' << milliseconds(latency.max) << '\n';
+  }
+
+  bool dropping = false;
+  for (const auto & entry : stages_) {
+    const Stage & stage = entry.second;
+    dropping = dropping || stage.dropped > 0;
+    RCLCPP_INFO(
+      get_logger(), "  %s: %.1f Hz, %zu dropped, latency p50 %.1f ms, p99 %.1f ms",
+      entry.first.c_str(), stage.published / elapsed, stage.dropped,
+      stage.latency_p50, stage.latency_p99);
+    if (report_) {
+      report_ << label_ << ',' << rate << ',' << entry.first << ",,," << stage.published << ',' <<
+        stage.dropped << ',' << stage.latency_p50 << ',' << stage.latency_p99 << ",\n";
+    }
+  }
+  report_.flush();
+
+  // Saturated once frames are lost, or queue up so that latency doubles
+  if (step_ == 0) {
+    baseline_p99_ = latency.p99;
+  }
+  if (delivery < saturation_delivery_ || dropping ||
+    (baseline_p99_ > 0.0 && latency.p99 > 2.0 * baseline_p99_))
+  {
+    saturation_rate_ = rate;
+  }
+
+  ++step_;
+  startStep();
+}
+
+void PipelineBenchmarkNode::publishFrame()
+{
+  const auto stamp = this->now();
+  auto publish_image = [&stamp](rclcpp::Publisher<Image> & pub, const Image & frame) {
+      auto msg = std::make_unique<Image>(frame);
+      msg->header.stamp = stamp;
+      pub.publish(std::move(msg));
+    };
+  auto publish_info = [&stamp](rclcpp::Publisher<CameraInfo> & pub, const CameraInfo & info) {
+      auto msg = std::make_unique<CameraInfo>(info);
+      msg->header.stamp = stamp;
+      pub.publish(std::move(msg));
+    };
+  publish_info(*pub_first_info_, first_info_);
+  publish_info(*pub_second_info_, second_info_);
+  publish_image(*pub_first_image_, first_image_);
+  publish_image(*pub_second_image_, second_image_);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (measuring_) {
+    ++sent_;
+  }
+}
+
+void PipelineBenchmarkNode::pointsCb(const PointCloud2::ConstSharedPtr & msg)
+{
+  const rclcpp::Time stamp(msg->header.stamp, get_clock()->get_clock_type());
+  const rclcpp::Duration latency = this->now() - stamp;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!measuring_ || stamp < measure_stamp_) {
+    return;
+  }
+  ++received_;
+  latency_.add(std::chrono::nanoseconds(latency.nanoseconds()));
+}
+
+void PipelineBenchmarkNode::diagnosticsCb(const DiagnosticArray::ConstSharedPtr & msg)
+{
+  const size_t suffix = sizeof(kProcessingStatus) - 1;
+  for (const auto & status : msg->status) {
+    if (status.name.size() <= suffix ||
+      status.name.compare(status.name.size() - suffix, suffix, kProcessingStatus) != 0)
+    {
+      continue;
+    }
+
+    size_t published = 0, dropped = 0;
+    double p50 = 0.0, p99 = 0.0;
+    for (const auto & value : status.values) {
+      if (value.key == "Published frames") {
+        published = std::strtoull(value.value.c_str(), nullptr, 10);
+      } else if (value.key == "Dropped frames") {
+        dropped = std::strtoull(value.value.c_str(), nullptr, 10);
+      } else if (value.key == "Latency p50 (ms)") {
+        p50 = std::strtod(value.value.c_str(), nullptr);
+      } else if (value.key == "Latency p99 (ms)") {
+        p99 = std::strtod(value.value.c_str(), nullptr);
+      }
+    }
+
+    // Stages are told apart by node name only, so the nodes of both cameras
+    // of a stereo pair add up
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!measuring_) {
+      return;
+    }
+    Stage & stage = stages_[status.name.substr(0, status.name.size() - suffix)];
+    if (stage.published + published > 0) {
+      stage.latency_p50 = (stage.latency_p50 * stage.published + p50 * published) /
+        (stage.published + published);
+    }
+    stage.published += published;
+    stage.dropped += dropped;
+    stage.latency_p99 = std::max(stage.latency_p99, p99);
+  }
+}
+
+}  // namespace image_proc
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+// This acts as a sort of entry point, allowing the component to be discoverable when its library
+// is being loaded into a running process.
+RCLCPP_COMPONENTS_REGISTER_NODE(image_proc::PipelineBenchmarkNode)
@@ -30,14 +30,23 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <cinttypes>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "cv_bridge/cv_bridge.hpp"
+#include "tracetools_image_pipeline/scoped_trace.hpp"
 #include "tracetools_image_pipeline/tracetools.h"
 
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/latest_only.hpp>
 #include <image_proc/rectify.hpp>
+#include <image_proc/region_of_interest.hpp>
 #include <image_proc/utils.hpp>
 
 #include <image_transport/image_transport.hpp>
@@ -62,6 +71,13 @@ RectifyNode::RectifyNode(const rclcpp::NodeOptions & options)
 
   queue_size_ = this->declare_parameter("queue_size", 5);
   interpolation_ = this->declare_parameter("interpolation", 1);
+  backend_ = declareBackendParameter(this);
+  use_buffer_pool_ = this->declare_parameter("use_buffer_pool", false);
+  ordered_ = declareConcurrencyParameter(this, 1);
+  roi_ = std::make_unique<RegionOfInterest>(this);
+  change_ = std::make_unique<ChangeDetection>(this);
+
+  latest_only_ = std::make_unique<LatestOnly>(this);
 
   // Setup lazy subscriber using publisher connection callback
   rclcpp::PublisherOptions pub_options;
@@ -72,7 +88,7 @@ RectifyNode::RectifyNode(const rclcpp::NodeOptions & options)
         sub_camera_.shutdown();
       } else if (!sub_camera_) {
         // Create subscriber with QoS matched to subscribed topic publisher
-        auto qos_profile = getTopicQosProfile(this, image_topic_);
+        auto qos_profile = latest_only_->qos(getTopicQosProfile(this, image_topic_));
         image_transport::TransportHints hints(this);
         sub_camera_ = image_transport::create_camera_subscription(
           this, image_topic_, std::bind(
@@ -87,12 +103,79 @@ RectifyNode::RectifyNode(const rclcpp::NodeOptions & options)
   // Create publisher with QoS matched to subscribed topic publisher
   auto qos_profile = getTopicQosProfile(this, image_topic_);
   pub_rect_ = image_transport::create_publisher(this, "image_rect", qos_profile, pub_options);
+
+  processing_ = std::make_unique<ProcessingDiagnostics>(this);
+}
+
+uint64_t RectifyNode::mapRebuildCount() const
+{
+  std::lock_guard<std::mutex> lock(maps_mutex_);
+  return map_rebuilds_;
+}
+
+uint64_t RectifyNode::mapHitCount() const
+{
+  std::lock_guard<std::mutex> lock(maps_mutex_);
+  return map_hits_;
 }
 
 void RectifyNode::imageCb(
   const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
 {
+  if (!latest_only_->admit(image_msg->header.stamp, *processing_)) {
+    return;
+  }
+
+  // Also in the order the frames came in. The output depends on the
+  // calibration and the window as well
+  bool unchanged = false;
+  if (change_->enabled()) {
+    const cv::Rect window = roi_->window(cv::Size(image_msg->width, image_msg->height));
+    uint64_t inputs = CameraCache::hashCameraInfo(*info_msg);
+    for (int value : {window.x, window.y, window.width, window.height}) {
+      inputs = CameraCache::combineKeys(inputs, static_cast<uint64_t>(value));
+    }
+    unchanged = change_->unchanged(*image_msg, inputs);
+  }
+  if (unchanged && change_->mode() == ChangeDetection::Mode::SKIP) {
+    processing_->skipped();
+    return;
+  }
+
+  auto process = [this, image_msg, info_msg, unchanged](OrderedOutput::Ticket & ticket) {
+      if (unchanged) {
+        republish(image_msg->header.stamp, ticket);
+      } else if (!rectifyImage(image_msg, info_msg, ticket)) {
+        // Nothing was kept for the change, so the next frame is processed again
+        change_->reset();
+      }
+    };
+
+  if (!ordered_) {
+    OrderedOutput::Ticket ticket;
+    process(ticket);
+    return;
+  }
+
+  // Rectify up to concurrency frames at once, publishing them in order
+  const bool dispatched = ordered_->dispatch(process);
+  if (!dispatched) {
+    processing_->dropped();
+    change_->reset();
+  }
+}
+
+bool RectifyNode::rectifyImage(
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg,
+  OrderedOutput::Ticket & ticket)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/rectify", image_msg.get(), image_msg->width, image_msg->height,
+    image_msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+
   TRACEPOINT(
     image_proc_rectify_init,
     static_cast<const void *>(this),
@@ -106,7 +189,7 @@ void RectifyNode::imageCb(
       static_cast<const void *>(&(*image_msg)),
       static_cast<const void *>(&(*info_msg)));
 
-    return;
+    return false;
   }
 
   // Verify camera is actually calibrated
@@ -119,7 +202,7 @@ void RectifyNode::imageCb(
       static_cast<const void *>(this),
       static_cast<const void *>(&(*image_msg)),
       static_cast<const void *>(&(*info_msg)));
-    return;
+    return false;
   }
 
   // If zero distortion, just pass the message along
@@ -134,35 +217,110 @@ void RectifyNode::imageCb(
 
   // This will be true if D is empty/zero sized
   if (zero_distortion) {
+    ticket.wait();
+    if (change_->mode() == ChangeDetection::Mode::REPUBLISH) {
+      last_rect_.keep(image_msg);
+    }
     pub_rect_.publish(image_msg);
+    frame.published(image_msg->header.stamp);
     TRACEPOINT(
       image_proc_rectify_fini,
       static_cast<const void *>(this),
       static_cast<const void *>(&(*image_msg)),
       static_cast<const void *>(&(*info_msg)));
-    return;
+    return true;
   }
 
-  // Update the camera model
-  model_.fromCameraInfo(info_msg);
+  // Rebuild the rectification maps only if the calibration changed, and no
+  // other node of the process has them already
+  std::shared_ptr<const RectificationMaps> maps =
+    CameraCache::instance().rectificationMaps(*info_msg);
+  {
+    std::lock_guard<std::mutex> lock(maps_mutex_);
+    if (maps != maps_) {
+      maps_ = maps;
+      ++map_rebuilds_;
+      RCLCPP_DEBUG(
+        this->get_logger(),
+        "Rebuilt rectification maps (%" PRIu64 " rebuilds, %" PRIu64 " frames reused them)",
+        map_rebuilds_, map_hits_);
+    } else {
+      ++map_hits_;
+    }
+  }
 
   // Create cv::Mat views onto both buffers
   const cv::Mat image = cv_bridge::toCvShare(image_msg)->image;
-  cv::Mat rect;
 
-  // Rectify and publish
-  model_.rectifyImage(image, rect, interpolation_);
+  if (image.size() != maps->size()) {
+    RCLCPP_ERROR(
+      this->get_logger(), "Image size %dx%d does not match the calibration of '%s' (%dx%d)",
+      image.cols, image.rows, sub_camera_.getInfoTopic().c_str(),
+      maps->size().width, maps->size().height);
+    TRACEPOINT(
+      image_proc_rectify_fini,
+      static_cast<const void *>(this),
+      static_cast<const void *>(&(*image_msg)),
+      static_cast<const void *>(&(*info_msg)));
+    return false;
+  }
+
+  // Rectify straight into the outgoing message
+  OutputImage rect_out(
+    use_buffer_pool_, image_msg->header, image_msg->encoding,
+    image.rows, image.cols, image.type());
+  cv::Mat & rect = rect_out.mat();
 
-  // Allocate new rectified image message
-  sensor_msgs::msg::Image::SharedPtr rect_msg =
-    cv_bridge::CvImage(image_msg->header, image_msg->encoding, rect).toImageMsg();
-  pub_rect_.publish(rect_msg);
+  const cv::Rect window = roi_->window(image.size());
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", image_msg.get());
+    if (window.size() != image.size()) {
+      // Only the requested window is rectified, on the CPU, the rest is black
+      rect.setTo(cv::Scalar::all(0));
+      maps->remap(image, rect, interpolation_, window);
+    } else if (backend_ == Backend::OPENCL) {
+      cv::UMat device_rect;
+      maps->remap(image.getUMat(cv::ACCESS_READ), device_rect, interpolation_);
+      device_rect.copyTo(rect);
+    } else {
+      maps->remap(image, rect, interpolation_);
+    }
+  }
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", image_msg.get());
+    ticket.wait();
+    if (change_->mode() == ChangeDetection::Mode::REPUBLISH) {
+      last_rect_.keep(rect_out.copy());
+    }
+    rect_out.publish(pub_rect_);
+    frame.published(image_msg->header.stamp);
+  }
 
   TRACEPOINT(
     image_proc_rectify_fini,
     static_cast<const void *>(this),
     static_cast<const void *>(&(*image_msg)),
     static_cast<const void *>(&(*info_msg)));
+  return true;
+}
+
+void RectifyNode::republish(
+  const builtin_interfaces::msg::Time & stamp, OrderedOutput::Ticket & ticket)
+{
+  ProcessingDiagnostics::Frame frame(*processing_);
+  if (pub_rect_.getNumSubscribers() < 1) {
+    return;
+  }
+
+  // Only once the frames before are out, the last of them having kept its output
+  ticket.wait();
+  auto rect = last_rect_.restamped(stamp);
+  if (rect) {
+    pub_rect_.publish(std::move(rect));
+    frame.published(stamp);
+  }
 }
 
 }  // namespace image_proc
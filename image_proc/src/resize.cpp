@@ -33,12 +33,20 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "cv_bridge/cv_bridge.hpp"
+#include "tracetools_image_pipeline/scoped_trace.hpp"
 #include "tracetools_image_pipeline/tracetools.h"
 
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/change_detection.hpp>
+#include <image_proc/image_message.hpp>
+#include <image_proc/latest_only.hpp>
 #include <image_proc/resize.hpp>
 #include <image_proc/utils.hpp>
+#include <image_proc/yuv.hpp>
 
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/qos.hpp>
@@ -49,6 +57,52 @@
 namespace image_proc
 {
 
+namespace
+{
+
+// Scale the intrinsics, projection and ROI of info to a resized image
+void scaleCameraInfo(sensor_msgs::msg::CameraInfo & info, double scale_x, double scale_y)
+{
+  info.k[0] = info.k[0] * scale_x;  // fx
+  info.k[2] = info.k[2] * scale_x;  // cx
+  info.k[4] = info.k[4] * scale_y;  // fy
+  info.k[5] = info.k[5] * scale_y;  // cy
+
+  info.p[0] = info.p[0] * scale_x;  // fx
+  info.p[2] = info.p[2] * scale_x;  // cx
+  info.p[3] = info.p[3] * scale_x;  // T
+  info.p[5] = info.p[5] * scale_y;  // fy
+  info.p[6] = info.p[6] * scale_y;  // cy
+
+  info.roi.x_offset = static_cast<int>(info.roi.x_offset * scale_x);
+  info.roi.y_offset = static_cast<int>(info.roi.y_offset * scale_y);
+  info.roi.width = static_cast<int>(info.roi.width * scale_x);
+  info.roi.height = static_cast<int>(info.roi.height * scale_y);
+}
+
+// Publish the kept image and camera info on pub with stamp, if there are any.
+// Sets missing if pub has subscribers but nothing is kept for it.
+bool republishOutput(
+  const image_transport::CameraPublisher & pub,
+  const LastOutput<sensor_msgs::msg::Image> & image,
+  const LastOutput<sensor_msgs::msg::CameraInfo> & info,
+  const builtin_interfaces::msg::Time & stamp, bool & missing)
+{
+  if (pub.getNumSubscribers() < 1) {
+    return false;
+  }
+  auto image_msg = image.restamped(stamp);
+  auto info_msg = info.restamped(stamp);
+  if (!image_msg || !info_msg) {
+    missing = true;
+    return false;
+  }
+  pub.publish(std::move(image_msg), std::move(info_msg));
+  return true;
+}
+
+}  // namespace
+
 ResizeNode::ResizeNode(const rclcpp::NodeOptions & options)
 : rclcpp::Node("ResizeNode", options)
 {
@@ -68,17 +122,24 @@ ResizeNode::ResizeNode(const rclcpp::NodeOptions & options)
   scale_width_ = this->declare_parameter("scale_width", 1.0);
   height_ = this->declare_parameter("height", -1);
   width_ = this->declare_parameter("width", -1);
+  backend_ = declareBackendParameter(this);
+  use_buffer_pool_ = this->declare_parameter("use_buffer_pool", false);
+  int pyramid_levels = this->declare_parameter("pyramid_levels", 0);
+  ordered_ = declareConcurrencyParameter(this, 2);
+
+  latest_only_ = std::make_unique<LatestOnly>(this);
+  change_ = std::make_unique<ChangeDetection>(this);
 
   // Setup lazy subscriber using publisher connection callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
     [this](rclcpp::MatchedInfo &)
     {
-      if (pub_image_.getNumSubscribers() == 0) {
+      if (!hasSubscribers()) {
         sub_image_.shutdown();
       } else if (!sub_image_) {
         // Create subscriber with QoS matched to subscribed topic publisher
-        auto qos_profile = getTopicQosProfile(this, image_topic_);
+        auto qos_profile = latest_only_->qos(getTopicQosProfile(this, image_topic_));
         image_transport::TransportHints hints(this);
         sub_image_ = image_transport::create_camera_subscription(
           this, image_topic_,
@@ -96,49 +157,275 @@ ResizeNode::ResizeNode(const rclcpp::NodeOptions & options)
   auto qos_profile = getTopicQosProfile(this, image_topic_);
   pub_image_ =
     image_transport::create_camera_publisher(this, pub_topic, qos_profile, pub_options);
+
+  // Each pyramid level halves the one above it, level 1 being half the input
+  for (int level = 1; level <= pyramid_levels; ++level) {
+    std::string level_topic = node_base->resolve_topic_or_service_name(
+      "resize/level" + std::to_string(level) + "/image_raw", false);
+    pyramid_pubs_.push_back(
+      image_transport::create_camera_publisher(this, level_topic, qos_profile, pub_options));
+  }
+  last_levels_ = std::vector<KeptOutput>(pyramid_pubs_.size());
+
+  processing_ = std::make_unique<ProcessingDiagnostics>(this);
+}
+
+bool ResizeNode::hasSubscribers() const
+{
+  if (pub_image_.getNumSubscribers() > 0) {
+    return true;
+  }
+  for (const auto & pub : pyramid_pubs_) {
+    if (pub.getNumSubscribers() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ResizeNode::publishPyramid(
+  const cv::Mat & image,
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+  const sensor_msgs::msg::CameraInfo & info_msg,
+  OrderedOutput::Ticket & ticket)
+{
+  // Only levels down to the deepest one with subscribers are computed
+  size_t deepest = 0;
+  for (size_t i = 0; i < pyramid_pubs_.size(); ++i) {
+    if (pyramid_pubs_[i].getNumSubscribers() > 0) {
+      deepest = i + 1;
+    }
+  }
+
+  // YUV levels stay in the input encoding, rounded to sizes it can hold
+  const std::string & encoding = image_msg->encoding;
+  const bool is_yuv = isYuv(encoding);
+  const cv::Size image_size = is_yuv ? yuvSize(encoding, image) : image.size();
+
+  // Each level is resized from the previous one, which is kept until then
+  std::unique_ptr<OutputImage> previous;
+  cv::Mat source = image;
+  cv::Size source_size = image_size;
+
+  for (size_t level = 1; level <= deepest; ++level) {
+    cv::Size size((source_size.width + 1) / 2, (source_size.height + 1) / 2);
+    if (is_yuv) {
+      size = yuvAlignedSize(encoding, size);
+    }
+    auto current = std::make_unique<OutputImage>(
+      use_buffer_pool_, image_msg->header, encoding,
+      is_yuv ? yuvRows(encoding, size.height) : size.height, size.width, image.type());
+    if (is_yuv) {
+      current->setHeight(size.height);
+      resizeYuv(source, encoding, size, interpolation_, current->mat());
+    } else {
+      cv::resize(source, current->mat(), size, 0.0, 0.0, interpolation_);
+    }
+
+    if (previous) {
+      publishPyramidLevel(*previous, level - 1, source_size, image_size, info_msg, ticket);
+    }
+    source = current->mat();
+    source_size = size;
+    previous = std::move(current);
+  }
+
+  if (previous) {
+    publishPyramidLevel(*previous, deepest, source_size, image_size, info_msg, ticket);
+  }
+  // The levels below have no subscribers, nor anything to publish again
+  ticket.wait(0);
+  for (size_t level = deepest + 1; level <= pyramid_pubs_.size(); ++level) {
+    last_levels_[level - 1].image.clear();
+    last_levels_[level - 1].info.clear();
+  }
+}
+
+void ResizeNode::publishPyramidLevel(
+  OutputImage & level_image, size_t level, const cv::Size & level_size,
+  const cv::Size & image_size, const sensor_msgs::msg::CameraInfo & info_msg,
+  OrderedOutput::Ticket & ticket)
+{
+  const auto & pub = pyramid_pubs_[level - 1];
+  if (pub.getNumSubscribers() < 1) {
+    ticket.wait(0);
+    last_levels_[level - 1].image.clear();
+    last_levels_[level - 1].info.clear();
+    return;
+  }
+
+  auto level_info = std::make_unique<sensor_msgs::msg::CameraInfo>(info_msg);
+  level_info->height = level_size.height;
+  level_info->width = level_size.width;
+  scaleCameraInfo(
+    *level_info, static_cast<double>(level_size.width) / image_size.width,
+    static_cast<double>(level_size.height) / image_size.height);
+
+  ticket.wait(0);
+  if (change_->mode() == ChangeDetection::Mode::REPUBLISH) {
+    last_levels_[level - 1].image.keep(level_image.copy());
+    last_levels_[level - 1].info.keep(
+      std::make_shared<sensor_msgs::msg::CameraInfo>(*level_info));
+  }
+  level_image.publish(pub, std::move(level_info));
 }
 
 void ResizeNode::imageCb(
   sensor_msgs::msg::Image::ConstSharedPtr image_msg,
   sensor_msgs::msg::CameraInfo::ConstSharedPtr info_msg)
 {
+  if (!latest_only_->admit(image_msg->header.stamp, *processing_)) {
+    return;
+  }
+
+  // Also in the order the frames came in
+  const bool unchanged = change_->enabled() &&
+    change_->unchanged(*image_msg, CameraCache::hashCameraInfo(*info_msg));
+  if (unchanged && change_->mode() == ChangeDetection::Mode::SKIP) {
+    processing_->skipped();
+    return;
+  }
+
+  auto process = [this, image_msg, info_msg, unchanged](OrderedOutput::Ticket & ticket) {
+      if (unchanged) {
+        republish(image_msg->header.stamp, ticket);
+      } else if (!resizeImage(image_msg, info_msg, ticket)) {
+        // Nothing was kept for the change, so the next frame is processed again
+        change_->reset();
+      }
+    };
+
+  if (!ordered_) {
+    OrderedOutput::Ticket ticket;
+    process(ticket);
+    return;
+  }
+
+  // Resize up to concurrency frames at once, publishing them in order
+  const bool dispatched = ordered_->dispatch(process);
+  if (!dispatched) {
+    processing_->dropped();
+    change_->reset();
+  }
+}
+
+bool ResizeNode::resizeImage(
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg,
+  OrderedOutput::Ticket & ticket)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/resize", image_msg.get(), image_msg->width, image_msg->height,
+    image_msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+
   TRACEPOINT(
     image_proc_resize_init,
     static_cast<const void *>(this),
     static_cast<const void *>(&(*image_msg)),
     static_cast<const void *>(&(*info_msg)));
 
+  // YUV images are resized plane by plane in YUV, and published in the same
+  // encoding, rather than converted by cv_bridge
+  const bool is_yuv = isYuv(image_msg->encoding);
   cv_bridge::CvImageConstPtr cv_ptr;
+  cv::Mat image;
+
+  if (is_yuv) {
+    image = yuvView(*image_msg);
+    if (image.empty()) {
+      TRACEPOINT(
+        image_proc_resize_fini,
+        static_cast<const void *>(this),
+        static_cast<const void *>(&(*image_msg)),
+        static_cast<const void *>(&(*info_msg)));
+      RCLCPP_ERROR(this->get_logger(), "YUV image has an odd size or too little data");
+      return false;
+    }
+  } else {
+    try {
+      cv_ptr = cv_bridge::toCvShare(image_msg);
+    } catch (cv_bridge::Exception & e) {
+      TRACEPOINT(
+        image_proc_resize_fini,
+        static_cast<const void *>(this),
+        static_cast<const void *>(&(*image_msg)),
+        static_cast<const void *>(&(*info_msg)));
+      RCLCPP_ERROR(this->get_logger(), "cv_bridge exception: %s", e.what());
+      return false;
+    }
+    image = cv_ptr->image;
+  }
 
-  try {
-    cv_ptr = cv_bridge::toCvShare(image_msg);
-  } catch (cv_bridge::Exception & e) {
+  if (!pyramid_pubs_.empty()) {
+    publishPyramid(image, image_msg, *info_msg, ticket);
+    frame.published(image_msg->header.stamp);
+  }
+  // Later frames may publish their levels while this one is resized
+  ticket.release(0);
+
+  if (pub_image_.getNumSubscribers() < 1) {
+    // Not to be published again for later unchanged frames either
+    ticket.wait(1);
+    last_scaled_.image.clear();
+    last_scaled_.info.clear();
     TRACEPOINT(
       image_proc_resize_fini,
       static_cast<const void *>(this),
       static_cast<const void *>(&(*image_msg)),
       static_cast<const void *>(&(*info_msg)));
-    RCLCPP_ERROR(this->get_logger(), "cv_bridge exception: %s", e.what());
-    return;
+    return true;
   }
+  cv::Size size(0, 0);
+  if (!use_scale_) {
+    size.height = height_ == -1 ? image_msg->height : height_;
+    size.width = width_ == -1 ? image_msg->width : width_;
+  }
+  const double fx = use_scale_ ? scale_width_ : 0.0;
+  const double fy = use_scale_ ? scale_height_ : 0.0;
 
+  // Same rounding as cv::resize, so it renders straight into the message
+  const cv::Size image_size = is_yuv ? yuvSize(image_msg->encoding, image) : image.size();
+  cv::Size out_size = size;
   if (use_scale_) {
-    cv::resize(
-      cv_ptr->image, scaled_cv_.image, cv::Size(0, 0), scale_width_,
-      scale_height_, interpolation_);
-  } else {
-    int height = height_ == -1 ? image_msg->height : height_;
-    int width = width_ == -1 ? image_msg->width : width_;
-    cv::resize(cv_ptr->image, scaled_cv_.image, cv::Size(width, height), 0, 0, interpolation_);
+    out_size.width = cv::saturate_cast<int>(image_size.width * fx);
+    out_size.height = cv::saturate_cast<int>(image_size.height * fy);
+  }
+  if (is_yuv) {
+    out_size = yuvAlignedSize(image_msg->encoding, out_size);
+  }
+  OutputImage scaled_out(
+    use_buffer_pool_, image_msg->header, image_msg->encoding,
+    is_yuv ? yuvRows(image_msg->encoding, out_size.height) : out_size.height, out_size.width,
+    image.type());
+  cv::Mat & scaled = scaled_out.mat();
+
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", image_msg.get());
+    if (is_yuv) {
+      scaled_out.setHeight(out_size.height);
+      resizeYuv(image, image_msg->encoding, out_size, interpolation_, scaled);
+    } else if (backend_ == Backend::OPENCL) {
+      cv::UMat device_scaled;
+      cv::resize(image.getUMat(cv::ACCESS_READ), device_scaled, size, fx, fy, interpolation_);
+      device_scaled.copyTo(scaled);
+    } else {
+      cv::resize(image, scaled, size, fx, fy, interpolation_);
+    }
   }
 
-  sensor_msgs::msg::CameraInfo::SharedPtr dst_info_msg =
-    std::make_shared<sensor_msgs::msg::CameraInfo>(*info_msg);
+  auto dst_info_msg = std::make_unique<sensor_msgs::msg::CameraInfo>(*info_msg);
 
   double scale_y;
   double scale_x;
 
-  if (use_scale_) {
+  if (is_yuv) {
+    // Rounded to a size the encoding holds
+    scale_y = static_cast<double>(out_size.height) / image_size.height;
+    scale_x = static_cast<double>(out_size.width) / image_size.width;
+    dst_info_msg->height = out_size.height;
+    dst_info_msg->width = out_size.width;
+  } else if (use_scale_) {
     scale_y = scale_height_;
     scale_x = scale_width_;
     dst_info_msg->height = static_cast<int>(info_msg->height * scale_height_);
@@ -150,31 +437,53 @@ void ResizeNode::imageCb(
     dst_info_msg->width = width_;
   }
 
-  dst_info_msg->k[0] = dst_info_msg->k[0] * scale_x;  // fx
-  dst_info_msg->k[2] = dst_info_msg->k[2] * scale_x;  // cx
-  dst_info_msg->k[4] = dst_info_msg->k[4] * scale_y;  // fy
-  dst_info_msg->k[5] = dst_info_msg->k[5] * scale_y;  // cy
-
-  dst_info_msg->p[0] = dst_info_msg->p[0] * scale_x;  // fx
-  dst_info_msg->p[2] = dst_info_msg->p[2] * scale_x;  // cx
-  dst_info_msg->p[3] = dst_info_msg->p[3] * scale_x;  // T
-  dst_info_msg->p[5] = dst_info_msg->p[5] * scale_y;  // fy
-  dst_info_msg->p[6] = dst_info_msg->p[6] * scale_y;  // cy
+  scaleCameraInfo(*dst_info_msg, scale_x, scale_y);
 
-  dst_info_msg->roi.x_offset = static_cast<int>(dst_info_msg->roi.x_offset * scale_x);
-  dst_info_msg->roi.y_offset = static_cast<int>(dst_info_msg->roi.y_offset * scale_y);
-  dst_info_msg->roi.width = static_cast<int>(dst_info_msg->roi.width * scale_x);
-  dst_info_msg->roi.height = static_cast<int>(dst_info_msg->roi.height * scale_y);
-
-  scaled_cv_.header = image_msg->header;
-  scaled_cv_.encoding = image_msg->encoding;
-  pub_image_.publish(*scaled_cv_.toImageMsg(), *dst_info_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", image_msg.get());
+    ticket.wait(1);
+    if (change_->mode() == ChangeDetection::Mode::REPUBLISH) {
+      last_scaled_.image.keep(scaled_out.copy());
+      last_scaled_.info.keep(std::make_shared<sensor_msgs::msg::CameraInfo>(*dst_info_msg));
+    }
+    scaled_out.publish(pub_image_, std::move(dst_info_msg));
+    frame.published(image_msg->header.stamp);
+  }
 
   TRACEPOINT(
     image_proc_resize_fini,
     static_cast<const void *>(this),
     static_cast<const void *>(&(*image_msg)),
     static_cast<const void *>(&(*info_msg)));
+  return true;
+}
+
+void ResizeNode::republish(
+  const builtin_interfaces::msg::Time & stamp, OrderedOutput::Ticket & ticket)
+{
+  ProcessingDiagnostics::Frame frame(*processing_);
+  bool published = false;
+  bool missing = false;
+
+  // Each output only once the frames before are done with it
+  ticket.wait(0);
+  for (size_t i = 0; i < pyramid_pubs_.size(); ++i) {
+    published |= republishOutput(
+      pyramid_pubs_[i], last_levels_[i].image, last_levels_[i].info, stamp, missing);
+  }
+  ticket.release(0);
+
+  ticket.wait(1);
+  published |= republishOutput(
+    pub_image_, last_scaled_.image, last_scaled_.info, stamp, missing);
+  if (published) {
+    frame.published(stamp);
+  }
+  // An output got subscribers after the last change, so the next frame is
+  // processed to give it one
+  if (missing) {
+    change_->reset();
+  }
 }
 
 }  // namespace image_proc
@@ -30,19 +30,33 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <cv_bridge/cv_bridge.hpp>
+#include <diagnostic_msgs/msg/diagnostic_status.hpp>
+#include <diagnostic_updater/diagnostic_updater.hpp>
+#include <image_proc/conversion_cache.hpp>
+#include <image_proc/latest_only.hpp>
 #include <image_proc/track_marker.hpp>
 #include <image_proc/utils.hpp>
 #include <image_transport/image_transport.hpp>
+#include <opencv2/calib3d.hpp>
 #include <opencv2/core/quaternion.hpp>
+#include <opencv2/imgproc.hpp>
 #include <rclcpp/qos.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace image_proc
 {
@@ -60,23 +74,40 @@ TrackMarkerNode::TrackMarkerNode(const rclcpp::NodeOptions & options)
 
   // Declare parameters before we setup any publishers or subscribers
   marker_id_ = this->declare_parameter("marker_id", 0);
+  marker_ids_ = this->declare_parameter("marker_ids", std::vector<int64_t>());
   marker_size_ = this->declare_parameter("marker_size", 0.05);
   // Default dictionary is cv::aruco::DICT_6X6_250
   int dict_id = this->declare_parameter("dictionary", 10);
+  tracking_ = this->declare_parameter("tracking", false);
+  roi_margin_ = this->declare_parameter("roi_margin", 0.5);
+  lost_decimation_ = this->declare_parameter("lost_decimation", 2);
+  if (lost_decimation_ < 1) {
+    RCLCPP_WARN(
+      this->get_logger(), "Invalid lost_decimation %d, using 1 instead", lost_decimation_);
+    lost_decimation_ = 1;
+  }
+  if (!marker_ids_.empty() && tracking_) {
+    RCLCPP_WARN(this->get_logger(), "Tracking is not supported with marker_ids, disabling it");
+    tracking_ = false;
+  }
 
   detector_params_ = cv::aruco::DetectorParameters::create();
   dictionary_ = cv::aruco::getPredefinedDictionary(dict_id);
 
+  latest_only_ = std::make_unique<LatestOnly>(this);
+
   // Setup lazy subscriber using publisher connection callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
     [this](rclcpp::MatchedInfo &)
     {
-      if (pub_->get_subscription_count() == 0) {
+      const size_t subscribers = pub_ ?
+        pub_->get_subscription_count() : pub_array_->get_subscription_count();
+      if (subscribers == 0) {
         sub_camera_.shutdown();
       } else if (!sub_camera_) {
         // Create subscriber with QoS matched to subscribed topic publisher
-        auto qos_profile = getTopicQosProfile(this, image_topic_);
+        auto qos_profile = latest_only_->qos(getTopicQosProfile(this, image_topic_));
         image_transport::TransportHints hints(this);
         sub_camera_ = image_transport::create_camera_subscription(
           this, image_topic_, std::bind(
@@ -90,61 +121,306 @@ TrackMarkerNode::TrackMarkerNode(const rclcpp::NodeOptions & options)
   pub_options.qos_overriding_options = rclcpp::QosOverridingOptions::with_default_policies();
 
   // Create publisher
-  pub_ = this->create_publisher<geometry_msgs::msg::PoseStamped>(
-    "tracked_pose", 10, pub_options);
+  if (marker_ids_.empty()) {
+    pub_ = this->create_publisher<geometry_msgs::msg::PoseStamped>(
+      "tracked_pose", 10, pub_options);
+  } else {
+    pub_array_ = this->create_publisher<geometry_msgs::msg::PoseArray>(
+      "tracked_poses", 10, pub_options);
+  }
+
+  diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+  diagnostics_->setHardwareID("none");
+  diagnostics_->add("Marker detection", this, &TrackMarkerNode::searchDiagnostics);
+  processing_ = std::make_unique<ProcessingDiagnostics>(this, *diagnostics_);
 }
 
 void TrackMarkerNode::imageCb(
   const sensor_msgs::msg::Image::ConstSharedPtr & image_msg,
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_proc/track_marker", image_msg.get(), image_msg->width, image_msg->height,
+    image_msg->encoding.c_str());
+  ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(image_msg->header.stamp, frame)) {
+    return;
+  }
+
+  // Color images are converted to the gray detectMarkers works on once per
+  // frame, for all the nodes of the process
+  const std::string encoding =
+    sensor_msgs::image_encodings::isColor(image_msg->encoding) ?
+    sensor_msgs::image_encodings::MONO8 : std::string();
   cv_bridge::CvImageConstPtr cv_ptr;
   try {
-    cv_ptr = cv_bridge::toCvShare(image_msg);
+    cv_ptr = ConversionCache::instance().toCvShare(image_msg, encoding);
   } catch (cv_bridge::Exception & e) {
     RCLCPP_ERROR(this->get_logger(), "cv_bridge exception: %s", e.what());
     return;
   }
 
+  const auto start = std::chrono::steady_clock::now();
+  const cv::Mat & image = cv_ptr->image;
+  const cv::Rect full(0, 0, image.cols, image.rows);
+
+  // Copy the matrices since they are const and OpenCV functions are not
+  auto k = info_msg->k;
+  auto d = info_msg->d;
+
+  // Get the camera info
+  cv::Mat intrinsics(3, 3, CV_64FC1, reinterpret_cast<void *>(k.data()));
+  cv::Mat dist_coeffs(info_msg->d.size(), 1, CV_64FC1, reinterpret_cast<void *>(d.data()));
+
+  if (!marker_ids_.empty()) {
+    trackAll(image_msg, image, intrinsics, dist_coeffs, frame);
+    return;
+  }
+
+  std::vector<std::vector<cv::Point2f>> corners;
+  const char * search = "full";
+
+  if (!tracking_) {
+    detect(image, full, 1.0, corners);
+  } else {
+    // Search around the predicted location while we have a track
+    if (has_track_) {
+      search = "roi";
+      const cv::Rect roi = predictRoi(intrinsics, dist_coeffs, image.size());
+      if (!roi.empty()) {
+        detect(image, roi, 1.0, corners);
+      }
+    }
+
+    // Track lost, search the whole frame at reduced resolution
+    if (corners.empty() && lost_decimation_ > 1) {
+      search = "decimated";
+      cv::Mat decimated;
+      const double scale = 1.0 / lost_decimation_;
+      cv::resize(image, decimated, cv::Size(), scale, scale, cv::INTER_AREA);
+      std::vector<std::vector<cv::Point2f>> coarse;
+      detect(decimated, cv::Rect(0, 0, decimated.cols, decimated.rows), lost_decimation_, coarse);
+
+      // Refine the coarse corners at full resolution, keeping them if that fails
+      for (const auto & marker : coarse) {
+        const cv::Rect roi = expandRoi(marker, image.size());
+        if (roi.empty() || !detect(image, roi, 1.0, corners)) {
+          corners.push_back(marker);
+        }
+      }
+    }
+
+    // Small or distant markers may not survive decimation, look at full resolution
+    if (corners.empty()) {
+      search = "full";
+      detect(image, full, 1.0, corners);
+    }
+  }
+
+  std::vector<cv::Vec3d> rvecs, tvecs;
+  if (!corners.empty()) {
+    // Estimate pose
+    cv::aruco::estimatePoseSingleMarkers(
+      corners, marker_size_, intrinsics, dist_coeffs, rvecs, tvecs);
+  }
+
+  // Track the first marker found, tracking mode assumes it is unique
+  if (!tvecs.empty()) {
+    has_velocity_ = has_track_;
+    prev_tvec_ = tvec_;
+    rvec_ = rvecs[0];
+    tvec_ = tvecs[0];
+    has_track_ = true;
+  } else {
+    has_track_ = false;
+    has_velocity_ = false;
+  }
+
+  recordSearch(search, start, !corners.empty());
+
+  for (size_t i = 0; i < tvecs.size(); ++i) {
+    // Publish pose of marker
+    geometry_msgs::msg::PoseStamped pose;
+    pose.header = image_msg->header;
+    // Fill in pose
+    pose.pose.position.x = tvecs[i][0];
+    pose.pose.position.y = tvecs[i][1];
+    pose.pose.position.z = tvecs[i][2];
+    // Convert angle-axis to quaternion
+    cv::Quatd q = cv::Quatd::createFromRvec(rvecs[i]);
+    pose.pose.orientation.x = q.x;
+    pose.pose.orientation.y = q.y;
+    pose.pose.orientation.z = q.z;
+    pose.pose.orientation.w = q.w;
+    pub_->publish(pose);
+    frame.published(image_msg->header.stamp);
+  }
+}
+
+void TrackMarkerNode::trackAll(
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg, const cv::Mat & image,
+  const cv::Mat & intrinsics, const cv::Mat & dist_coeffs, ProcessingDiagnostics::Frame & frame)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  // Detect once for all requested markers
+  std::vector<int> detected_ids;
+  std::vector<std::vector<cv::Point2f>> detected_corners;
+  cv::aruco::detectMarkers(image, dictionary_, detected_corners, detected_ids);
+
+  // Corners of the first detection of each requested marker, by index in marker_ids_
+  std::vector<int> found(marker_ids_.size(), -1);
+  for (size_t i = 0; i < detected_ids.size(); ++i) {
+    for (size_t j = 0; j < marker_ids_.size(); ++j) {
+      if (marker_ids_[j] == detected_ids[i] && found[j] < 0) {
+        found[j] = static_cast<int>(i);
+      }
+    }
+  }
+
+  // Unseen markers keep a NaN pose so that poses stay aligned with marker_ids
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  geometry_msgs::msg::PoseArray poses;
+  poses.header = image_msg->header;
+  poses.poses.resize(marker_ids_.size());
+  for (auto & pose : poses.poses) {
+    pose.position.x = pose.position.y = pose.position.z = nan;
+    pose.orientation.x = pose.orientation.y = pose.orientation.z = pose.orientation.w = nan;
+  }
+
+  // Estimate the poses in parallel, each marker is solved independently
+  const std::vector<cv::Point3f> object_points = objectPoints();
+  cv::parallel_for_(
+    cv::Range(0, static_cast<int>(marker_ids_.size())), [&](const cv::Range & range) {
+      for (int j = range.start; j < range.end; ++j) {
+        if (found[j] < 0) {
+          continue;
+        }
+        cv::Vec3d rvec, tvec;
+        if (!cv::solvePnP(
+            object_points, detected_corners[found[j]], intrinsics, dist_coeffs, rvec, tvec))
+        {
+          continue;
+        }
+        auto & pose = poses.poses[j];
+        pose.position.x = tvec[0];
+        pose.position.y = tvec[1];
+        pose.position.z = tvec[2];
+        cv::Quatd q = cv::Quatd::createFromRvec(rvec);
+        pose.orientation.x = q.x;
+        pose.orientation.y = q.y;
+        pose.orientation.z = q.z;
+        pose.orientation.w = q.w;
+      }
+    });
+
+  recordSearch(
+    "full", start, std::any_of(found.begin(), found.end(), [](int i) {return i >= 0;}));
+
+  pub_array_->publish(poses);
+  frame.published(image_msg->header.stamp);
+}
+
+void TrackMarkerNode::recordSearch(
+  const std::string & search, std::chrono::steady_clock::time_point start, bool found)
+{
+  const std::chrono::duration<double, std::milli> latency =
+    std::chrono::steady_clock::now() - start;
+  std::lock_guard<std::mutex> lock(searches_mutex_);
+  SearchStatistics & statistics = searches_[search];
+  ++statistics.frames;
+  statistics.found += found ? 1 : 0;
+  statistics.milliseconds += latency.count();
+  statistics.max_milliseconds = std::max(statistics.max_milliseconds, latency.count());
+}
+
+void TrackMarkerNode::searchDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status)
+{
+  // Statistics are reset every period, so they cover the frames since the last report
+  std::map<std::string, SearchStatistics> searches;
+  {
+    std::lock_guard<std::mutex> lock(searches_mutex_);
+    searches.swap(searches_);
+  }
+
+  size_t frames = 0;
+  size_t found = 0;
+  for (const auto & entry : searches) {
+    const std::string & name = entry.first;
+    const SearchStatistics & statistics = entry.second;
+    status.addf(name + " searches", "%zu", statistics.frames);
+    status.addf(name + " found", "%zu", statistics.found);
+    status.addf(
+      name + " mean time (ms)", "%.3f", statistics.milliseconds / statistics.frames);
+    status.addf(name + " max time (ms)", "%.3f", statistics.max_milliseconds);
+    frames += statistics.frames;
+    found += statistics.found;
+  }
+  status.summaryf(
+    diagnostic_msgs::msg::DiagnosticStatus::OK, "Marker found in %zu of %zu frames",
+    found, frames);
+}
+
+bool TrackMarkerNode::detect(
+  const cv::Mat & image, const cv::Rect & roi, double scale,
+  std::vector<std::vector<cv::Point2f>> & corners) const
+{
   std::vector<int> marker_ids;
   std::vector<std::vector<cv::Point2f>> marker_corners;
-  cv::aruco::detectMarkers(cv_ptr->image, dictionary_, marker_corners, marker_ids);
+  cv::aruco::detectMarkers(image(roi), dictionary_, marker_corners, marker_ids);
 
+  bool found = false;
   for (size_t i = 0; i < marker_ids.size(); ++i) {
     if (marker_ids[i] == marker_id_) {
       // This is our desired marker
-      std::vector<std::vector<cv::Point2f>> corners;
+      for (auto & corner : marker_corners[i]) {
+        corner.x = static_cast<float>((corner.x + roi.x) * scale);
+        corner.y = static_cast<float>((corner.y + roi.y) * scale);
+      }
       corners.push_back(marker_corners[i]);
-
-      // Copy the matrices since they are const and OpenCV functions are not
-      auto k = info_msg->k;
-      auto d = info_msg->d;
-
-      // Get the camera info
-      cv::Mat intrinsics(3, 3, CV_64FC1, reinterpret_cast<void *>(k.data()));
-      cv::Mat dist_coeffs(info_msg->d.size(), 1, CV_64FC1, reinterpret_cast<void *>(d.data()));
-
-      // Estimate pose
-      std::vector<cv::Vec3d> rvecs, tvecs;
-      cv::aruco::estimatePoseSingleMarkers(
-        corners, marker_size_, intrinsics, dist_coeffs, rvecs, tvecs);
-
-      // Publish pose of marker
-      geometry_msgs::msg::PoseStamped pose;
-      pose.header = image_msg->header;
-      // Fill in pose
-      pose.pose.position.x = tvecs[0][0];
-      pose.pose.position.y = tvecs[0][1];
-      pose.pose.position.z = tvecs[0][2];
-      // Convert angle-axis to quaternion
-      cv::Quatd q = cv::Quatd::createFromRvec(rvecs[0]);
-      pose.pose.orientation.x = q.x;
-      pose.pose.orientation.y = q.y;
-      pose.pose.orientation.z = q.z;
-      pose.pose.orientation.w = q.w;
-      pub_->publish(pose);
+      found = true;
     }
   }
+  return found;
+}
+
+cv::Rect TrackMarkerNode::predictRoi(
+  const cv::Mat & intrinsics, const cv::Mat & dist_coeffs, const cv::Size & size) const
+{
+  // Constant velocity prediction from the last two poses
+  cv::Vec3d tvec = tvec_;
+  if (has_velocity_) {
+    tvec += tvec_ - prev_tvec_;
+  }
+  if (tvec[2] <= 0.0) {
+    return cv::Rect();
+  }
+
+  std::vector<cv::Point2f> image_points;
+  cv::projectPoints(objectPoints(), rvec_, tvec, intrinsics, dist_coeffs, image_points);
+  return expandRoi(image_points, size);
+}
+
+std::vector<cv::Point3f> TrackMarkerNode::objectPoints() const
+{
+  const float half = static_cast<float>(marker_size_ / 2.0);
+  return {{-half, half, 0.0f}, {half, half, 0.0f}, {half, -half, 0.0f}, {-half, -half, 0.0f}};
+}
+
+cv::Rect TrackMarkerNode::expandRoi(
+  const std::vector<cv::Point2f> & points, const cv::Size & size) const
+{
+  const cv::Rect2f box = cv::boundingRect2f(points);
+  const float margin = static_cast<float>(roi_margin_ * std::max(box.width, box.height));
+  const cv::Rect roi(
+    cv::Point(
+      static_cast<int>(std::floor(box.x - margin)),
+      static_cast<int>(std::floor(box.y - margin))),
+    cv::Point(
+      static_cast<int>(std::ceil(box.x + box.width + margin)),
+      static_cast<int>(std::ceil(box.y + box.height + margin))));
+  return roi & cv::Rect(0, 0, size.width, size.height);
 }
 
 }  // namespace image_proc
@@ -0,0 +1,258 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <image_proc/decimate.hpp>
+#include <image_proc/edge_aware.hpp>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
+namespace enc = sensor_msgs::image_encodings;
+
+namespace
+{
+
+// Resolutions to run every benchmark at
+const std::vector<std::pair<int, int>> kResolutions = {{640, 480}, {1280, 720}, {1920, 1080}};
+
+// The logo of the test resources at the given resolution, BGR8
+const cv::Mat & colorImage(int width, int height)
+{
+  static std::map<std::pair<int, int>, cv::Mat> images;
+  cv::Mat & image = images[{width, height}];
+  if (image.empty()) {
+    cv::Mat logo = cv::imread(
+      std::string(_SRC_RESOURCES_DIR_PATH) + "/logo.png", cv::IMREAD_COLOR);
+    if (logo.empty()) {
+      // Gradient so the kernels still see varying input
+      logo.create(256, 256, CV_8UC3);
+      for (int y = 0; y < logo.rows; ++y) {
+        for (int x = 0; x < logo.cols; ++x) {
+          logo.at<cv::Vec3b>(y, x) = cv::Vec3b(x, y, (x + y) / 2);
+        }
+      }
+    }
+    cv::resize(logo, image, cv::Size(width, height), 0.0, 0.0, cv::INTER_LINEAR);
+  }
+  return image;
+}
+
+// Mosaic of colorImage in the layout of a Bayer encoding, 8 or 16-bit
+cv::Mat bayerImage(int width, int height, const std::string & encoding)
+{
+  // Channel (B = 0, G = 1, R = 2) of each pixel of the top-left 2x2 cell
+  int channels[4];
+  const std::string pattern = encoding.substr(6, 4);
+  for (int i = 0; i < 4; ++i) {
+    channels[i] = pattern[i] == 'b' ? 0 : pattern[i] == 'g' ? 1 : 2;
+  }
+
+  const cv::Mat & color = colorImage(width, height);
+  cv::Mat bayer(height, width, CV_8UC1);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      bayer.at<uint8_t>(y, x) = color.at<cv::Vec3b>(y, x)[channels[(y % 2) * 2 + x % 2]];
+    }
+  }
+  if (enc::bitDepth(encoding) == 16) {
+    bayer.convertTo(bayer, CV_16U, 256.0);
+  }
+  return bayer;
+}
+
+const std::vector<std::string> kBayerEncodings = {
+  enc::BAYER_GRBG8, enc::BAYER_RGGB8, enc::BAYER_GRBG16, enc::BAYER_RGGB16};
+
+image_proc::BayerPattern bayerPattern(const std::string & encoding)
+{
+  const std::string pattern = encoding.substr(6, 4);
+  if (pattern == "rggb") {
+    return image_proc::BayerPattern::RGGB;
+  } else if (pattern == "bggr") {
+    return image_proc::BayerPattern::BGGR;
+  } else if (pattern == "gbrg") {
+    return image_proc::BayerPattern::GBRG;
+  }
+  return image_proc::BayerPattern::GRBG;
+}
+
+void setBytesProcessed(benchmark::State & state, const cv::Mat & input)
+{
+  state.SetBytesProcessed(
+    static_cast<int64_t>(state.iterations()) * input.total() * input.elemSize());
+}
+
+// Arguments: width, height, index in kBayerEncodings
+void bayerArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kBayerEncodings.size(); ++i) {
+      benchmark->Args({resolution.first, resolution.second, static_cast<int64_t>(i)});
+    }
+  }
+}
+
+template<void (*Debayer)(const cv::Mat &, cv::Mat &, image_proc::BayerPattern)>
+void debayer(benchmark::State & state)
+{
+  const std::string & encoding = kBayerEncodings[state.range(2)];
+  const cv::Mat bayer = bayerImage(state.range(0), state.range(1), encoding);
+  const image_proc::BayerPattern pattern = bayerPattern(encoding);
+  cv::Mat color;
+  for (auto _ : state) {
+    Debayer(bayer, color, pattern);
+    benchmark::DoNotOptimize(color.data);
+  }
+  state.SetLabel(encoding);
+  setBytesProcessed(state, bayer);
+}
+
+void BM_DebayerEdgeAware(benchmark::State & state)
+{
+  debayer<image_proc::debayerEdgeAware>(state);
+}
+BENCHMARK(BM_DebayerEdgeAware)->Apply(bayerArguments)->UseRealTime();
+
+void BM_DebayerEdgeAwareWeighted(benchmark::State & state)
+{
+  debayer<image_proc::debayerEdgeAwareWeighted>(state);
+}
+BENCHMARK(BM_DebayerEdgeAwareWeighted)->Apply(bayerArguments)->UseRealTime();
+
+// OpenCV bilinear debayering, the reference for the kernels above
+void BM_DebayerBilinear(benchmark::State & state)
+{
+  const std::string & encoding = kBayerEncodings[state.range(2)];
+  const cv::Mat bayer = bayerImage(state.range(0), state.range(1), encoding);
+  // OpenCV names the pattern from the second row and column
+  const int code = bayerPattern(encoding) == image_proc::BayerPattern::RGGB ?
+    cv::COLOR_BayerBG2BGR : cv::COLOR_BayerGB2BGR;
+  cv::Mat color;
+  for (auto _ : state) {
+    cv::cvtColor(bayer, color, code);
+    benchmark::DoNotOptimize(color.data);
+  }
+  state.SetLabel(encoding);
+  setBytesProcessed(state, bayer);
+}
+BENCHMARK(BM_DebayerBilinear)->Apply(bayerArguments)->UseRealTime();
+
+// Arguments: width, height, index in kBayerEncodings, decimation, bin
+void decimateBayerArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding", "decimation", "bin"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kBayerEncodings.size(); ++i) {
+      for (int decimation : {2, 4, 6}) {
+        for (int bin : {0, 1}) {
+          benchmark->Args(
+            {resolution.first, resolution.second, static_cast<int64_t>(i), decimation, bin});
+        }
+      }
+    }
+  }
+}
+
+// Fused debayering and decimation of CropDecimateNode; decimation 2 is the
+// plain 2x2 debayer to a half resolution BGR image
+void BM_DecimateBayer(benchmark::State & state)
+{
+  const std::string & encoding = kBayerEncodings[state.range(2)];
+  const cv::Mat bayer = bayerImage(state.range(0), state.range(1), encoding);
+  const int decimation = state.range(3);
+  const bool bin = state.range(4) != 0;
+  cv::Mat bgr;
+  for (auto _ : state) {
+    image_proc::decimateBayer(bayer, encoding, bgr, decimation, decimation, bin);
+    benchmark::DoNotOptimize(bgr.data);
+  }
+  state.SetLabel(encoding);
+  setBytesProcessed(state, bayer);
+}
+BENCHMARK(BM_DecimateBayer)->Apply(decimateBayerArguments)->UseRealTime();
+
+const std::vector<std::string> kEncodings = {
+  enc::MONO8, enc::BGR8, enc::MONO16, enc::TYPE_32FC1, enc::RGBA16};
+
+// Arguments: width, height, index in kEncodings, decimation
+void decimateArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding", "decimation"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kEncodings.size(); ++i) {
+      for (int decimation : {2, 4}) {
+        benchmark->Args(
+          {resolution.first, resolution.second, static_cast<int64_t>(i), decimation});
+      }
+    }
+  }
+}
+
+void BM_Decimate(benchmark::State & state)
+{
+  const std::string & encoding = kEncodings[state.range(2)];
+  const cv::Mat & color = colorImage(state.range(0), state.range(1));
+  cv::Mat input;
+  if (enc::numChannels(encoding) == 1) {
+    cv::cvtColor(color, input, cv::COLOR_BGR2GRAY);
+  } else if (enc::numChannels(encoding) == 4) {
+    cv::cvtColor(color, input, cv::COLOR_BGR2BGRA);
+  } else {
+    input = color;
+  }
+  if (enc::bitDepth(encoding) == 16) {
+    input.convertTo(input, CV_16U, 256.0);
+  } else if (enc::bitDepth(encoding) == 32) {
+    input.convertTo(input, CV_32F, 1.0 / 255.0);
+  }
+  const int decimation = state.range(3);
+  cv::Mat output;
+  for (auto _ : state) {
+    image_proc::decimate(input, output, decimation, decimation);
+    benchmark::DoNotOptimize(output.data);
+  }
+  state.SetLabel(encoding);
+  setBytesProcessed(state, input);
+}
+BENCHMARK(BM_Decimate)->Apply(decimateArguments)->UseRealTime();
+
+}  // namespace
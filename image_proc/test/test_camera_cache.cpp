@@ -0,0 +1,147 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "image_proc/camera_cache.hpp"
+
+#include <sensor_msgs/distortion_models.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace
+{
+
+sensor_msgs::msg::CameraInfo makeCameraInfo()
+{
+  // Taken from vision_opencv/image_geometry/test/utest.cpp
+  sensor_msgs::msg::CameraInfo info;
+  info.width = 640;
+  info.height = 480;
+  info.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  info.d = {-0.363528858080088, 0.16117037733986861, -8.1109585007538829e-05,
+    -0.00044776712298447841, 0.0};
+  info.k = {430.15433020105519, 0.0, 311.71339830549732,
+    0.0, 430.60920415473657, 221.06824942698509,
+    0.0, 0.0, 1.0};
+  info.r = {0.99806560714807102, 0.0068562422224214027, 0.061790256276695904,
+    -0.0067522959054715113, 0.99997541519165112, -0.0018909025066874664,
+    -0.061801701660692349, 0.0014700186639396652, 0.99808736527268516};
+  info.p = {295.53402059708782, 0.0, 285.55760765075684, 0.0,
+    0.0, 295.53402059708782, 223.29617881774902, 0.0,
+    0.0, 0.0, 1.0, 0.0};
+  return info;
+}
+
+}  // namespace
+
+TEST(CameraCache, sharesEqualCalibrations)
+{
+  auto & cache = image_proc::CameraCache::instance();
+  sensor_msgs::msg::CameraInfo info = makeCameraInfo();
+
+  auto model = cache.pinholeModel(info);
+  auto maps = cache.rectificationMaps(info);
+  EXPECT_DOUBLE_EQ(model->fx(), info.p[0]);
+  EXPECT_EQ(maps->size(), cv::Size(640, 480));
+
+  // Only the calibration counts, not the header
+  info.header.frame_id = "other_frame";
+  info.header.stamp.sec = 42;
+  EXPECT_EQ(cache.pinholeModel(info), model);
+  EXPECT_EQ(cache.rectificationMaps(info), maps);
+
+  info.k[0] += 1.0;
+  EXPECT_NE(cache.pinholeModel(info), model);
+  EXPECT_NE(cache.rectificationMaps(info), maps);
+}
+
+TEST(CameraCache, releasesUnusedEntries)
+{
+  auto & cache = image_proc::CameraCache::instance();
+  const sensor_msgs::msg::CameraInfo info = makeCameraInfo();
+
+  const size_t before = cache.statistics().entries;
+  {
+    auto maps = cache.rectificationMaps(info);
+    EXPECT_EQ(cache.statistics().entries, before + 1);
+  }
+  EXPECT_EQ(cache.statistics().entries, before);
+
+  // Rebuilt on the next use
+  const auto misses = cache.statistics().misses;
+  auto maps = cache.rectificationMaps(info);
+  EXPECT_EQ(cache.statistics().misses, misses + 1);
+}
+
+TEST(CameraCache, separatesTypesAndKeys)
+{
+  auto & cache = image_proc::CameraCache::instance();
+  const uint64_t key = image_proc::CameraCache::hashCameraInfo(makeCameraInfo());
+
+  int builds = 0;
+  auto build = [&builds]() {
+      ++builds;
+      return std::make_shared<int>(builds);
+    };
+  auto first = cache.get<int>(key, build);
+  auto again = cache.get<int>(key, build);
+  auto other = cache.get<int>(image_proc::CameraCache::combineKeys(key, 1), build);
+  auto as_double = cache.get<double>(key, []() {return std::make_shared<double>(0.5);});
+
+  EXPECT_EQ(first, again);
+  EXPECT_NE(first, other);
+  EXPECT_EQ(builds, 2);
+  EXPECT_EQ(*as_double, 0.5);
+}
+
+TEST(CameraCache, concurrentUsersShareOneEntry)
+{
+  auto & cache = image_proc::CameraCache::instance();
+  const sensor_msgs::msg::CameraInfo info = makeCameraInfo();
+
+  std::vector<std::shared_ptr<const image_geometry::PinholeCameraModel>> models(8);
+  std::vector<std::thread> threads;
+  for (auto & model : models) {
+    threads.emplace_back([&cache, &info, &model]() {model = cache.pinholeModel(info);});
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (const auto & model : models) {
+    EXPECT_EQ(model, models.front());
+  }
+}
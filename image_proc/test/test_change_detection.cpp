@@ -0,0 +1,192 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "image_proc/change_detection.hpp"
+
+namespace
+{
+
+using image_proc::ChangeDetection;
+
+sensor_msgs::msg::Image makeImage(uint32_t width, uint32_t height, uint8_t value)
+{
+  sensor_msgs::msg::Image image;
+  image.width = width;
+  image.height = height;
+  image.encoding = "mono8";
+  image.step = width;
+  image.data.assign(static_cast<size_t>(width) * height, value);
+  return image;
+}
+
+}  // namespace
+
+TEST(ChangeDetectionTest, disabledNeverReportsUnchanged)
+{
+  ChangeDetection change(ChangeDetection::Mode::OFF, 0.0, 1);
+  const auto image = makeImage(64, 48, 10);
+  EXPECT_FALSE(change.unchanged(image));
+  EXPECT_FALSE(change.unchanged(image));
+}
+
+TEST(ChangeDetectionTest, identicalFramesAreUnchanged)
+{
+  ChangeDetection change(ChangeDetection::Mode::SKIP, 0.0, 1);
+  const auto image = makeImage(64, 48, 10);
+  EXPECT_FALSE(change.unchanged(image));
+  EXPECT_TRUE(change.unchanged(image));
+  EXPECT_TRUE(change.unchanged(makeImage(64, 48, 10)));
+
+  // Any change of a sampled byte counts without a threshold
+  auto changed = image;
+  changed.data[100] = 11;
+  EXPECT_FALSE(change.unchanged(changed));
+  EXPECT_TRUE(change.unchanged(changed));
+
+  change.reset();
+  EXPECT_FALSE(change.unchanged(changed));
+}
+
+TEST(ChangeDetectionTest, droppedChangeIsProcessedAgain)
+{
+  // A node keeps the output of the first frame, then drops the changed frame
+  // after it before keeping anything, as on a full queue or an error
+  ChangeDetection change(ChangeDetection::Mode::REPUBLISH, 0.0, 1);
+  image_proc::LastOutput<sensor_msgs::msg::Image> last;
+  const auto first = makeImage(64, 48, 10);
+  ASSERT_FALSE(change.unchanged(first));
+  last.keep(std::make_shared<sensor_msgs::msg::Image>(first));
+
+  const auto changed = makeImage(64, 48, 20);
+  ASSERT_FALSE(change.unchanged(changed));
+  change.reset();
+
+  // The same frame again must be processed, not republish the first output
+  EXPECT_FALSE(change.unchanged(changed));
+  last.keep(std::make_shared<sensor_msgs::msg::Image>(changed));
+  EXPECT_TRUE(change.unchanged(changed));
+  builtin_interfaces::msg::Time stamp;
+  stamp.sec = 3;
+  EXPECT_EQ(last.restamped(stamp)->data, changed.data);
+}
+
+TEST(ChangeDetectionTest, sizeEncodingAndInputsCount)
+{
+  ChangeDetection change(ChangeDetection::Mode::REPUBLISH, 1.0, 1);
+  const auto image = makeImage(64, 48, 10);
+  EXPECT_FALSE(change.unchanged(image, 1));
+  EXPECT_FALSE(change.unchanged(image, 2));
+  EXPECT_TRUE(change.unchanged(image, 2));
+
+  auto other_encoding = image;
+  other_encoding.encoding = "8UC1";
+  EXPECT_FALSE(change.unchanged(other_encoding, 2));
+  EXPECT_FALSE(change.unchanged(makeImage(32, 48, 10), 2));
+}
+
+TEST(ChangeDetectionTest, thresholdIsPerSampledByte)
+{
+  ChangeDetection change(ChangeDetection::Mode::SKIP, 2.0, 1);
+  EXPECT_FALSE(change.unchanged(makeImage(64, 48, 10)));
+  EXPECT_TRUE(change.unchanged(makeImage(64, 48, 12)));
+  EXPECT_FALSE(change.unchanged(makeImage(64, 48, 13)));
+
+  // Slow drifts are compared with the last frame that changed
+  EXPECT_TRUE(change.unchanged(makeImage(64, 48, 14)));
+  EXPECT_TRUE(change.unchanged(makeImage(64, 48, 15)));
+  EXPECT_FALSE(change.unchanged(makeImage(64, 48, 16)));
+}
+
+TEST(ChangeDetectionTest, onlyEveryStepthRowIsSampled)
+{
+  ChangeDetection change(ChangeDetection::Mode::SKIP, 0.0, 4);
+  const auto image = makeImage(64, 48, 10);
+  EXPECT_FALSE(change.unchanged(image));
+
+  auto unsampled = image;
+  unsampled.data[1 * 64 + 5] = 200;
+  EXPECT_TRUE(change.unchanged(unsampled));
+
+  auto sampled = image;
+  sampled.data[4 * 64 + 5] = 200;
+  EXPECT_FALSE(change.unchanged(sampled));
+}
+
+TEST(ChangeDetectionTest, everyImageOfAFrameCounts)
+{
+  ChangeDetection change(ChangeDetection::Mode::SKIP, 0.0, 1);
+  const auto depth = makeImage(64, 48, 10);
+  auto rgb = makeImage(64, 48, 20);
+  EXPECT_FALSE(change.unchanged({&depth, &rgb}));
+  EXPECT_TRUE(change.unchanged({&depth, &rgb}));
+  rgb.data[0] = 0;
+  EXPECT_FALSE(change.unchanged({&depth, &rgb}));
+}
+
+TEST(ChangeDetectionTest, blockSumsCoverTheImage)
+{
+  const auto image = makeImage(64, 48, 1);
+  std::vector<uint32_t> sums;
+  ChangeDetection::blockSums(image, 1, sums);
+  ASSERT_EQ(sums.size(), static_cast<size_t>(ChangeDetection::BLOCKS * ChangeDetection::BLOCKS));
+  uint64_t total = 0;
+  for (uint32_t sum : sums) {
+    total += sum;
+  }
+  EXPECT_EQ(total, 64u * 48u);
+}
+
+TEST(LastOutputTest, restampsACopy)
+{
+  image_proc::LastOutput<sensor_msgs::msg::Image> last;
+  builtin_interfaces::msg::Time stamp;
+  stamp.sec = 5;
+  EXPECT_EQ(last.restamped(stamp), nullptr);
+
+  auto kept = std::make_shared<sensor_msgs::msg::Image>(makeImage(4, 4, 3));
+  last.keep(kept);
+  auto copy = last.restamped(stamp);
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(copy->header.stamp.sec, 5);
+  EXPECT_EQ(kept->header.stamp.sec, 0);
+  EXPECT_EQ(copy->data, kept->data);
+
+  last.clear();
+  EXPECT_EQ(last.restamped(stamp), nullptr);
+}
@@ -0,0 +1,115 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "image_proc/conversion_cache.hpp"
+
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+using image_proc::ConversionCache;
+
+sensor_msgs::msg::Image::ConstSharedPtr makeImage(uint8_t value)
+{
+  auto image = std::make_shared<sensor_msgs::msg::Image>();
+  image->width = 4;
+  image->height = 2;
+  image->encoding = sensor_msgs::image_encodings::BGR8;
+  image->step = image->width * 3;
+  image->data.assign(image->step * image->height, value);
+  return image;
+}
+
+}  // namespace
+
+TEST(ConversionCache, convertsEveryMessageOnce)
+{
+  auto & cache = ConversionCache::instance();
+  const auto msg = makeImage(100);
+  const auto before = cache.statistics();
+
+  auto mono = cache.toCvShare(msg, sensor_msgs::image_encodings::MONO8);
+  auto again = cache.toCvShare(msg, sensor_msgs::image_encodings::MONO8);
+  EXPECT_EQ(mono, again);
+  EXPECT_EQ(mono->encoding, sensor_msgs::image_encodings::MONO8);
+  EXPECT_EQ(mono->image.at<uint8_t>(1, 3), 100);
+
+  // Another encoding is another conversion
+  auto rgb = cache.toCvShare(msg, sensor_msgs::image_encodings::RGB8);
+  EXPECT_NE(rgb, mono);
+
+  const auto after = cache.statistics();
+  EXPECT_EQ(after.hits - before.hits, 1u);
+  EXPECT_EQ(after.misses - before.misses, 2u);
+}
+
+TEST(ConversionCache, sharesMessageWithoutConversion)
+{
+  auto & cache = ConversionCache::instance();
+  const auto msg = makeImage(7);
+  const auto before = cache.statistics();
+
+  auto image = cache.toCvShare(msg, sensor_msgs::image_encodings::BGR8);
+  EXPECT_EQ(image->image.data, msg->data.data());
+  image = cache.toCvShare(msg);
+  EXPECT_EQ(image->image.data, msg->data.data());
+
+  const auto after = cache.statistics();
+  EXPECT_EQ(after.hits, before.hits);
+  EXPECT_EQ(after.misses, before.misses);
+}
+
+TEST(ConversionCache, forgetsFreedMessages)
+{
+  auto & cache = ConversionCache::instance();
+  auto msg = makeImage(1);
+  cache.toCvShare(msg, sensor_msgs::image_encodings::MONO8);
+  const size_t entries = cache.statistics().entries;
+  EXPECT_GE(entries, 1u);
+
+  msg.reset();
+  EXPECT_EQ(cache.statistics().entries, entries - 1);
+
+  // Pruned when the next conversion is stored
+  auto other = makeImage(2);
+  auto mono = cache.toCvShare(other, sensor_msgs::image_encodings::MONO8);
+  EXPECT_EQ(mono->image.at<uint8_t>(0, 0), 2);
+  EXPECT_EQ(cache.statistics().entries, entries);
+}
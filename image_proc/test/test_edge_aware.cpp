@@ -0,0 +1,258 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "image_proc/edge_aware.hpp"
+
+namespace
+{
+
+const std::vector<image_proc::BayerPattern> kPatterns = {
+  image_proc::BayerPattern::RGGB,
+  image_proc::BayerPattern::BGGR,
+  image_proc::BayerPattern::GBRG,
+  image_proc::BayerPattern::GRBG,
+};
+
+// Builds a mosaic of a uniform BGR color for the given pattern
+template<typename T>
+cv::Mat makeMosaic(image_proc::BayerPattern pattern, T b, T g, T r)
+{
+  // Color of the samples at (even, even) and (odd, odd) positions
+  T first, last;
+  bool green_first = false;
+  switch (pattern) {
+    case image_proc::BayerPattern::RGGB:
+      first = r; last = b;
+      break;
+    case image_proc::BayerPattern::BGGR:
+      first = b; last = r;
+      break;
+    case image_proc::BayerPattern::GBRG:
+      first = b; last = r; green_first = true;
+      break;
+    default:
+      first = r; last = b; green_first = true;
+      break;
+  }
+
+  cv::Mat bayer(9, 14, cv::DataType<T>::type);
+  for (int y = 0; y < bayer.rows; ++y) {
+    for (int x = 0; x < bayer.cols; ++x) {
+      const bool green = ((x + y) & 1) == (green_first ? 0 : 1);
+      if (green) {
+        bayer.at<T>(y, x) = g;
+      } else {
+        bayer.at<T>(y, x) = (y & 1) == 0 ? first : last;
+      }
+    }
+  }
+  return bayer;
+}
+
+template<typename T>
+void expectUniform(const cv::Mat & color, T b, T g, T r)
+{
+  ASSERT_EQ(color.channels(), 3);
+  for (int y = 0; y < color.rows; ++y) {
+    for (int x = 0; x < color.cols; ++x) {
+      const auto & px = color.at<cv::Vec<T, 3>>(y, x);
+      EXPECT_EQ(px[0], b) << "at (" << x << ", " << y << ")";
+      EXPECT_EQ(px[1], g) << "at (" << x << ", " << y << ")";
+      EXPECT_EQ(px[2], r) << "at (" << x << ", " << y << ")";
+    }
+  }
+}
+
+// Mosaic of two flat areas, 200 above row 5 or left of column 7 and 20 past it
+cv::Mat makeEdge(bool horizontal)
+{
+  cv::Mat bayer(9, 14, CV_8UC1);
+  for (int y = 0; y < bayer.rows; ++y) {
+    for (int x = 0; x < bayer.cols; ++x) {
+      bayer.at<uint8_t>(y, x) = (horizontal ? y < 5 : x < 7) ? 200 : 20;
+    }
+  }
+  return bayer;
+}
+
+// Interpolated along the edge, green never blends the two sides
+void expectGreenFollowsEdge(const cv::Mat & bayer, const cv::Mat & color)
+{
+  for (int y = 0; y < color.rows; ++y) {
+    for (int x = 0; x < color.cols; ++x) {
+      EXPECT_EQ(color.at<cv::Vec3b>(y, x)[1], bayer.at<uint8_t>(y, x)) <<
+        "at (" << x << ", " << y << ")";
+    }
+  }
+}
+
+// Textured GRBG mosaic of 10x10 pixels
+cv::Mat makeTexture()
+{
+  cv::Mat bayer(10, 10, CV_8UC1);
+  for (int y = 0; y < bayer.rows; ++y) {
+    for (int x = 0; x < bayer.cols; ++x) {
+      bayer.at<uint8_t>(y, x) = (x * x * 29 + y * 53 + x * y * 7 + y * y * 11) % 256;
+    }
+  }
+  return bayer;
+}
+
+// Output of the original GRBG8-only kernel for makeTexture, rows and columns 2
+// to 7, in BGR. Only the interior: that kernel treated the two outer rows and
+// columns differently.
+const uint8_t kTextureInterior[6][18] = {
+  {177, 38, 195, 109, 80, 197, 41, 158, 187, 89, 60, 177, 137, 254, 155, 173, 162, 133},
+  {160, 43, 200, 99, 70, 209, 38, 67, 206, 93, 64, 203, 148, 49, 188, 191, 34, 173},
+  {187, 48, 205, 133, 104, 221, 79, 196, 225, 77, 112, 229, 75, 64, 221, 125, 114, 213},
+  {214, 115, 126, 167, 138, 149, 120, 149, 160, 61, 160, 171, 2, 159, 170, 59, 158, 169},
+  {157, 146, 47, 117, 106, 77, 77, 66, 95, 89, 124, 113, 101, 218, 119, 101, 136, 125},
+  {100, 111, 76, 67, 38, 49, 34, 45, 74, 117, 88, 99, 200, 211, 112, 143, 114, 125},
+};
+
+}  // namespace
+
+TEST(EdgeAwareDebayer, uniformColor8)
+{
+  for (const auto pattern : kPatterns) {
+    cv::Mat bayer = makeMosaic<uint8_t>(pattern, 30, 120, 210);
+    cv::Mat color, weighted;
+    image_proc::debayerEdgeAware(bayer, color, pattern);
+    image_proc::debayerEdgeAwareWeighted(bayer, weighted, pattern);
+    expectUniform<uint8_t>(color, 30, 120, 210);
+    expectUniform<uint8_t>(weighted, 30, 120, 210);
+  }
+}
+
+TEST(EdgeAwareDebayer, uniformColor16)
+{
+  for (const auto pattern : kPatterns) {
+    cv::Mat bayer = makeMosaic<uint16_t>(pattern, 1000, 40000, 65535);
+    cv::Mat color, weighted;
+    image_proc::debayerEdgeAware(bayer, color, pattern);
+    image_proc::debayerEdgeAwareWeighted(bayer, weighted, pattern);
+    expectUniform<uint16_t>(color, 1000, 40000, 65535);
+    expectUniform<uint16_t>(weighted, 1000, 40000, 65535);
+  }
+}
+
+TEST(EdgeAwareDebayer, horizontalEdge)
+{
+  const cv::Mat bayer = makeEdge(true);
+  for (const auto pattern : kPatterns) {
+    cv::Mat color, weighted;
+    image_proc::debayerEdgeAware(bayer, color, pattern);
+    image_proc::debayerEdgeAwareWeighted(bayer, weighted, pattern);
+    expectGreenFollowsEdge(bayer, color);
+    expectGreenFollowsEdge(bayer, weighted);
+  }
+}
+
+TEST(EdgeAwareDebayer, verticalEdge)
+{
+  const cv::Mat bayer = makeEdge(false);
+  for (const auto pattern : kPatterns) {
+    cv::Mat color, weighted;
+    image_proc::debayerEdgeAware(bayer, color, pattern);
+    image_proc::debayerEdgeAwareWeighted(bayer, weighted, pattern);
+    expectGreenFollowsEdge(bayer, color);
+    expectGreenFollowsEdge(bayer, weighted);
+  }
+}
+
+TEST(EdgeAwareDebayer, grbg8MatchesBaseline)
+{
+  cv::Mat color;
+  image_proc::debayerEdgeAware(makeTexture(), color, image_proc::BayerPattern::GRBG);
+  for (int y = 0; y < 6; ++y) {
+    for (int x = 0; x < 6; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_EQ(color.at<cv::Vec3b>(y + 2, x + 2)[c], kTextureInterior[y][3 * x + c]) <<
+          "channel " << c << " at (" << x + 2 << ", " << y + 2 << ")";
+      }
+    }
+  }
+}
+
+TEST(EdgeAwareDebayer, weighted16NearFullScale)
+{
+  // Red and blue samples near full scale, green ones near either end, so that
+  // the weighted sums of green exceed 32 bits
+  cv::Mat bayer(9, 14, CV_16UC1);
+  cv::RNG rng(5);
+  for (int y = 0; y < bayer.rows; ++y) {
+    for (int x = 0; x < bayer.cols; ++x) {
+      const bool green = ((x + y) & 1) == 0;
+      bayer.at<uint16_t>(y, x) = static_cast<uint16_t>(
+        green && rng.uniform(0, 2) ? rng.uniform(0, 16) : 65535 - rng.uniform(0, 16));
+    }
+  }
+  cv::Mat color;
+  image_proc::debayerEdgeAwareWeighted(bayer, color, image_proc::BayerPattern::GRBG);
+
+  int overflowing = 0;
+  for (int y = 1; y + 1 < bayer.rows; ++y) {
+    for (int x = 1; x + 1 < bayer.cols; ++x) {
+      if (((x + y) & 1) == 0) {
+        continue;
+      }
+      const int64_t left = bayer.at<uint16_t>(y, x - 1);
+      const int64_t right = bayer.at<uint16_t>(y, x + 1);
+      const int64_t up = bayer.at<uint16_t>(y - 1, x);
+      const int64_t down = bayer.at<uint16_t>(y + 1, x);
+      const int64_t dh = std::llabs(left - right);
+      const int64_t dv = std::llabs(up - down);
+      const int64_t sum = (up + down) * dh + (left + right) * dv;
+      const int64_t expected = dh == 0 && dv == 0 ?
+        (up + down + left + right) >> 2 : sum / (2 * (dh + dv));
+      overflowing += sum > std::numeric_limits<int32_t>::max();
+      EXPECT_EQ(color.at<cv::Vec<uint16_t, 3>>(y, x)[1], expected) <<
+        "at (" << x << ", " << y << ")";
+    }
+  }
+  EXPECT_GT(overflowing, 0);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,252 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "image_geometry/pinhole_camera_model.hpp"
+#include "image_proc/processor.hpp"
+
+#include <sensor_msgs/distortion_models.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+sensor_msgs::msg::CameraInfo makeCameraInfo()
+{
+  // Taken from vision_opencv/image_geometry/test/utest.cpp
+  sensor_msgs::msg::CameraInfo info;
+  info.width = 640;
+  info.height = 480;
+  info.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  info.d = {-0.363528858080088, 0.16117037733986861, -8.1109585007538829e-05,
+    -0.00044776712298447841, 0.0};
+  info.k = {430.15433020105519, 0.0, 311.71339830549732,
+    0.0, 430.60920415473657, 221.06824942698509,
+    0.0, 0.0, 1.0};
+  info.r = {0.99806560714807102, 0.0068562422224214027, 0.061790256276695904,
+    -0.0067522959054715113, 0.99997541519165112, -0.0018909025066874664,
+    -0.061801701660692349, 0.0014700186639396652, 0.99808736527268516};
+  info.p = {295.53402059708782, 0.0, 285.55760765075684, 0.0,
+    0.0, 295.53402059708782, 223.29617881774902, 0.0,
+    0.0, 0.0, 1.0, 0.0};
+  return info;
+}
+
+sensor_msgs::msg::Image::ConstSharedPtr makeImage(const std::string & encoding)
+{
+  auto image = std::make_shared<sensor_msgs::msg::Image>();
+  const int channels = sensor_msgs::image_encodings::numChannels(encoding);
+  image->width = 640;
+  image->height = 480;
+  image->encoding = encoding;
+  image->step = image->width * channels;
+  image->data.resize(image->step * image->height);
+  cv::Mat data(image->height, image->width, CV_8UC(channels), image->data.data(), image->step);
+  cv::randu(data, cv::Scalar::all(0), cv::Scalar::all(255));
+  return image;
+}
+
+// Counts the buffers cv::Mat allocates, which it all does through the default allocator
+class CountingAllocator : public cv::MatAllocator
+{
+public:
+  CountingAllocator()
+  : std_(cv::Mat::getStdAllocator()), previous_(cv::Mat::getDefaultAllocator())
+  {
+    cv::Mat::setDefaultAllocator(this);
+  }
+
+  ~CountingAllocator() override
+  {
+    cv::Mat::setDefaultAllocator(previous_);
+  }
+
+  cv::UMatData * allocate(
+    int dims, const int * sizes, int type, void * data, size_t * step,
+    cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override
+  {
+    ++count;
+    return std_->allocate(dims, sizes, type, data, step, flags, usage_flags);
+  }
+
+  bool allocate(
+    cv::UMatData * data, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override
+  {
+    return std_->allocate(data, flags, usage_flags);
+  }
+
+  void deallocate(cv::UMatData * data) const override
+  {
+    std_->deallocate(data);
+  }
+
+  mutable std::atomic<int> count{0};
+
+private:
+  cv::MatAllocator * std_;
+  cv::MatAllocator * previous_;
+};
+
+}  // namespace
+
+TEST(FrameArena, steadyStateAllocatesNothing)
+{
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(makeCameraInfo());
+  image_proc::Processor processor;
+
+  for (const char * encoding : {sensor_msgs::image_encodings::BAYER_RGGB8,
+      sensor_msgs::image_encodings::BGR8, sensor_msgs::image_encodings::MONO8})
+  {
+    const auto raw = makeImage(encoding);
+    image_proc::FrameArena arena;
+
+    // The first frame sizes the buffers and the rectification maps
+    image_proc::ImageSet first;
+    ASSERT_TRUE(processor.process(raw, model, first, arena));
+
+    CountingAllocator allocator;
+    for (int i = 0; i < 3; ++i) {
+      // A fresh output set every frame, as a node would
+      image_proc::ImageSet output;
+      ASSERT_TRUE(processor.process(raw, model, output, arena));
+      EXPECT_EQ(output.rect.data, arena.rect.data);
+      EXPECT_EQ(output.rect_color.data, arena.rect_color.data);
+    }
+    EXPECT_EQ(allocator.count, 0) << encoding;
+  }
+}
+
+TEST(FrameArena, fusedSteadyStateAllocatesNothing)
+{
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(makeCameraInfo());
+  image_proc::Processor processor;
+  processor.fused_debayer_rectify_ = true;
+
+  const auto raw = makeImage(sensor_msgs::image_encodings::BAYER_RGGB8);
+  image_proc::FrameArena arena;
+  image_proc::ImageSet output;
+  ASSERT_TRUE(processor.process(raw, model, output, arena, image_proc::Processor::RECT_COLOR));
+
+  CountingAllocator allocator;
+  for (int i = 0; i < 3; ++i) {
+    image_proc::ImageSet fresh;
+    ASSERT_TRUE(processor.process(raw, model, fresh, arena, image_proc::Processor::RECT_COLOR));
+  }
+  EXPECT_EQ(allocator.count, 0);
+}
+
+TEST(FrameArena, matchesProcessWithoutArena)
+{
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(makeCameraInfo());
+  image_proc::Processor processor;
+  const auto raw = makeImage(sensor_msgs::image_encodings::BAYER_RGGB8);
+
+  image_proc::ImageSet expected, output;
+  image_proc::FrameArena arena;
+  ASSERT_TRUE(processor.process(raw, model, expected));
+  ASSERT_TRUE(processor.process(raw, model, output, arena));
+
+  EXPECT_EQ(output.color_encoding, expected.color_encoding);
+  EXPECT_EQ(cv::norm(output.mono, expected.mono, cv::NORM_INF), 0.0);
+  EXPECT_EQ(cv::norm(output.rect, expected.rect, cv::NORM_INF), 0.0);
+  EXPECT_EQ(cv::norm(output.color, expected.color, cv::NORM_INF), 0.0);
+  EXPECT_EQ(cv::norm(output.rect_color, expected.rect_color, cv::NORM_INF), 0.0);
+}
+
+TEST(FrameArena, rectFromRectColorMatchesRectifiedMono)
+{
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(makeCameraInfo());
+  image_proc::Processor processor;
+  image_proc::Processor rect_once;
+  rect_once.rect_from_rect_color_ = true;
+  const int flags = image_proc::Processor::RECT | image_proc::Processor::RECT_COLOR;
+
+  for (const char * encoding : {sensor_msgs::image_encodings::BAYER_RGGB8,
+      sensor_msgs::image_encodings::BGR8, sensor_msgs::image_encodings::RGB8,
+      sensor_msgs::image_encodings::MONO8})
+  {
+    const auto raw = makeImage(encoding);
+    image_proc::ImageSet expected, output;
+    image_proc::FrameArena arena;
+    ASSERT_TRUE(processor.process(raw, model, expected, flags));
+    ASSERT_TRUE(rect_once.process(raw, model, output, arena, flags));
+
+    EXPECT_EQ(output.color_encoding, expected.color_encoding) << encoding;
+    EXPECT_EQ(cv::norm(output.rect_color, expected.rect_color, cv::NORM_INF), 0.0) << encoding;
+    // Luma of the interpolated color, only rounded differently
+    EXPECT_LE(cv::norm(output.rect, expected.rect, cv::NORM_INF), 2.0) << encoding;
+    if (output.color_encoding != sensor_msgs::image_encodings::MONO8) {
+      // Never converted to mono before rectification
+      EXPECT_TRUE(output.mono.empty()) << encoding;
+    }
+
+    CountingAllocator allocator;
+    image_proc::ImageSet fresh;
+    ASSERT_TRUE(rect_once.process(raw, model, fresh, arena, flags));
+    EXPECT_EQ(allocator.count, 0) << encoding;
+  }
+}
+
+TEST(FrameArena, fusedRectFromRectColor)
+{
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(makeCameraInfo());
+  image_proc::Processor processor;
+  processor.fused_debayer_rectify_ = true;
+  processor.rect_from_rect_color_ = true;
+  const int flags = image_proc::Processor::RECT | image_proc::Processor::RECT_COLOR;
+
+  const auto raw = makeImage(sensor_msgs::image_encodings::BAYER_RGGB8);
+  image_proc::ImageSet output;
+  image_proc::FrameArena arena;
+  ASSERT_TRUE(processor.process(raw, model, output, arena, flags));
+
+  // Both from the one pass over the mosaic, no intermediate color image
+  EXPECT_TRUE(output.color.empty());
+  cv::Mat luma;
+  cv::cvtColor(output.rect_color, luma, cv::COLOR_BGR2GRAY);
+  EXPECT_EQ(cv::norm(output.rect, luma, cv::NORM_INF), 0.0);
+}
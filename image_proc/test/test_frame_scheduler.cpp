@@ -0,0 +1,162 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "image_proc/frame_scheduler.hpp"
+
+namespace
+{
+
+using image_proc::FrameScheduler;
+
+// Frames processed and dropped, in the order the scheduler called them
+class Calls
+{
+public:
+  FrameScheduler::Work frame(int id)
+  {
+    return [this, id](bool process) {
+             std::lock_guard<std::mutex> lock(mutex_);
+             (process ? processed_ : dropped_).push_back(id);
+           };
+  }
+
+  std::vector<int> processed()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return processed_;
+  }
+
+  std::vector<int> dropped()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<int> processed_;
+  std::vector<int> dropped_;
+};
+
+// Work holding its worker until release is set
+FrameScheduler::Work blocking(std::shared_future<void> release, std::promise<void> & started)
+{
+  return [release, &started](bool) {
+           started.set_value();
+           release.wait();
+         };
+}
+
+}  // namespace
+
+TEST(FrameScheduler, servesEarliestFrameAcrossStreams)
+{
+  Calls calls;
+  std::promise<void> release, started;
+  {
+    FrameScheduler scheduler(3, 1, 4, FrameScheduler::Clock::duration::zero());
+    ASSERT_TRUE(scheduler.submit(0, blocking(release.get_future().share(), started)));
+    started.get_future().wait();
+
+    // Frames are served as they arrived across streams, those of the
+    // running stream once it is done
+    ASSERT_TRUE(scheduler.submit(1, calls.frame(10)));
+    ASSERT_TRUE(scheduler.submit(0, calls.frame(0)));
+    ASSERT_TRUE(scheduler.submit(0, calls.frame(1)));
+    ASSERT_TRUE(scheduler.submit(2, calls.frame(20)));
+    release.set_value();
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (calls.processed().size() < 4 && std::chrono::steady_clock::now() < until) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_EQ(calls.processed(), (std::vector<int>{10, 0, 1, 20}));
+  EXPECT_TRUE(calls.dropped().empty());
+}
+
+TEST(FrameScheduler, displacesOldestPendingFrame)
+{
+  Calls calls;
+  std::promise<void> release, started;
+  {
+    FrameScheduler scheduler(1, 1, 2, FrameScheduler::Clock::duration::zero());
+    ASSERT_TRUE(scheduler.submit(0, blocking(release.get_future().share(), started)));
+    started.get_future().wait();
+
+    EXPECT_TRUE(scheduler.submit(0, calls.frame(0)));
+    EXPECT_TRUE(scheduler.submit(0, calls.frame(1)));
+    EXPECT_FALSE(scheduler.submit(0, calls.frame(2)));
+    EXPECT_EQ(calls.dropped(), (std::vector<int>{0}));
+    release.set_value();
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (calls.processed().size() < 2 && std::chrono::steady_clock::now() < until) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_EQ(calls.processed(), (std::vector<int>{1, 2}));
+}
+
+TEST(FrameScheduler, dropsFramesPastTheirDeadline)
+{
+  Calls calls;
+  std::promise<void> release, started;
+  {
+    FrameScheduler scheduler(2, 1, 1, std::chrono::milliseconds(20));
+    ASSERT_TRUE(scheduler.submit(0, blocking(release.get_future().share(), started)));
+    started.get_future().wait();
+
+    ASSERT_TRUE(scheduler.submit(1, calls.frame(10)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release.set_value();
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (calls.dropped().empty() && std::chrono::steady_clock::now() < until) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(scheduler.submit(1, calls.frame(11)));
+    while (calls.processed().empty() && std::chrono::steady_clock::now() < until) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_EQ(calls.dropped(), (std::vector<int>{10}));
+  EXPECT_EQ(calls.processed(), (std::vector<int>{11}));
+}
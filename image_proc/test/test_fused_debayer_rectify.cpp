@@ -0,0 +1,143 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "image_geometry/pinhole_camera_model.hpp"
+#include "image_proc/processor.hpp"
+
+#include <sensor_msgs/distortion_models.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+image_geometry::PinholeCameraModel makeModel()
+{
+  // Taken from vision_opencv/image_geometry/test/utest.cpp
+  sensor_msgs::msg::CameraInfo info;
+  info.width = 640;
+  info.height = 480;
+  info.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  info.d = {-0.363528858080088, 0.16117037733986861, -8.1109585007538829e-05,
+    -0.00044776712298447841, 0.0};
+  info.k = {430.15433020105519, 0.0, 311.71339830549732,
+    0.0, 430.60920415473657, 221.06824942698509,
+    0.0, 0.0, 1.0};
+  info.r = {0.99806560714807102, 0.0068562422224214027, 0.061790256276695904,
+    -0.0067522959054715113, 0.99997541519165112, -0.0018909025066874664,
+    -0.061801701660692349, 0.0014700186639396652, 0.99808736527268516};
+  info.p = {295.53402059708782, 0.0, 285.55760765075684, 0.0,
+    0.0, 295.53402059708782, 223.29617881774902, 0.0,
+    0.0, 0.0, 1.0, 0.0};
+  image_geometry::PinholeCameraModel model;
+  model.fromCameraInfo(info);
+  return model;
+}
+
+// Random mosaic of the model's size, 8 or 16 bits per sample
+sensor_msgs::msg::Image::ConstSharedPtr makeMosaic(const std::string & encoding)
+{
+  auto image = std::make_shared<sensor_msgs::msg::Image>();
+  const int depth = sensor_msgs::image_encodings::bitDepth(encoding) == 16 ? CV_16U : CV_8U;
+  image->width = 640;
+  image->height = 480;
+  image->encoding = encoding;
+  image->step = image->width * CV_ELEM_SIZE(depth);
+  image->data.resize(image->step * image->height);
+  cv::Mat data(image->height, image->width, depth, image->data.data(), image->step);
+  cv::randu(data, cv::Scalar::all(0), cv::Scalar::all(depth == CV_16U ? 65535 : 255));
+  return image;
+}
+
+}  // namespace
+
+TEST(FusedDebayerRectify, matchesDebayerThenRectify)
+{
+  const auto model = makeModel();
+  for (const char * encoding : {sensor_msgs::image_encodings::BAYER_RGGB8,
+      sensor_msgs::image_encodings::BAYER_BGGR8, sensor_msgs::image_encodings::BAYER_GBRG8,
+      sensor_msgs::image_encodings::BAYER_GRBG8})
+  {
+    const auto raw = makeMosaic(encoding);
+    for (int interpolation : {cv::INTER_NEAREST, cv::INTER_LINEAR}) {
+      image_proc::Processor separate, fused;
+      separate.interpolation_ = interpolation;
+      fused.interpolation_ = interpolation;
+      fused.fused_debayer_rectify_ = true;
+
+      image_proc::ImageSet expected, output;
+      ASSERT_TRUE(separate.process(raw, model, expected, image_proc::Processor::RECT_COLOR));
+      ASSERT_TRUE(fused.process(raw, model, output, image_proc::Processor::RECT_COLOR));
+      // Sampled from the mosaic, not from a debayered image
+      EXPECT_TRUE(output.color.empty());
+
+      ASSERT_EQ(output.rect_color.size(), expected.rect_color.size());
+      ASSERT_EQ(output.rect_color.type(), expected.rect_color.type());
+      EXPECT_EQ(output.color_encoding, expected.color_encoding);
+
+      // Both demosaic bilinearly. They differ by rounding, and by the border
+      // handling of the demosaic on the few pixels sampled from the edges.
+      cv::Mat difference;
+      cv::absdiff(output.rect_color, expected.rect_color, difference);
+      const double mean = cv::norm(difference, cv::NORM_L1) / difference.total() / 3.0;
+      EXPECT_LT(mean, 1.0) << encoding << " interpolation " << interpolation;
+      const double large = cv::countNonZero(difference.reshape(1) > 4);
+      EXPECT_LT(large / (difference.total() * 3), 0.01) <<
+        encoding << " interpolation " << interpolation;
+    }
+  }
+}
+
+TEST(FusedDebayerRectify, sixteenBitMosaicFallsBack)
+{
+  const auto model = makeModel();
+  const auto raw = makeMosaic(sensor_msgs::image_encodings::BAYER_RGGB16);
+  image_proc::Processor separate, fused;
+  fused.fused_debayer_rectify_ = true;
+
+  image_proc::ImageSet expected, output;
+  ASSERT_TRUE(separate.process(raw, model, expected, image_proc::Processor::RECT_COLOR));
+  ASSERT_TRUE(fused.process(raw, model, output, image_proc::Processor::RECT_COLOR));
+
+  // Debayered by cv::cvtColor and remapped, keeping the 16 bits
+  EXPECT_EQ(output.color_encoding, sensor_msgs::image_encodings::BGR16);
+  EXPECT_EQ(output.rect_color.type(), CV_16UC3);
+  EXPECT_EQ(cv::norm(output.rect_color, expected.rect_color, cv::NORM_INF), 0.0);
+}
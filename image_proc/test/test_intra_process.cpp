@@ -0,0 +1,150 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+#include "image_proc/debayer.hpp"
+
+using namespace std::chrono_literals;
+
+// Checks that the outputs of DebayerNode reach several subscribers in the
+// same process without a copy, as they do in image_proc.launch.py
+class ImageProcIntraProcessTest
+  : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::NodeOptions options;
+    options.use_intra_process_comms(true);
+
+    camera_ = std::make_shared<rclcpp::Node>("test_intra_process_camera", options);
+    pub_raw_ = camera_->create_publisher<sensor_msgs::msg::Image>(
+      "image_raw", rclcpp::SensorDataQoS());
+    debayer_ = std::make_shared<image_proc::DebayerNode>(options);
+    sink_ = std::make_shared<rclcpp::Node>("test_intra_process_sink", options);
+
+    executor_.add_node(camera_);
+    executor_.add_node(debayer_);
+    executor_.add_node(sink_);
+  }
+
+  void subscribe(const std::string & topic, size_t count)
+  {
+    received_.assign(count, nullptr);
+    for (size_t i = 0; i < count; ++i) {
+      subs_.push_back(
+        sink_->create_subscription<sensor_msgs::msg::Image>(
+          topic, rclcpp::SensorDataQoS(),
+          [this, i](sensor_msgs::msg::Image::ConstSharedPtr msg) {
+            // Keep the first one, so that all subscribers compare the same frame
+            if (!received_[i]) {
+              received_[i] = std::move(msg);
+            }
+          }));
+    }
+  }
+
+  // Publish Bayer frames until every subscriber has received one, giving the
+  // lazy subscriber of DebayerNode time to connect
+  bool receive()
+  {
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (std::chrono::steady_clock::now() < deadline) {
+      auto raw = std::make_unique<sensor_msgs::msg::Image>();
+      raw->header.stamp = camera_->now();
+      raw->encoding = sensor_msgs::image_encodings::BAYER_RGGB8;
+      raw->width = 64;
+      raw->height = 48;
+      raw->step = raw->width;
+      raw->data.assign(raw->step * raw->height, 128);
+      pub_raw_->publish(std::move(raw));
+
+      executor_.spin_all(100ms);
+      bool all = true;
+      for (const auto & msg : received_) {
+        all = all && msg;
+      }
+      if (all) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  rclcpp::Node::SharedPtr camera_;
+  rclcpp::Node::SharedPtr debayer_;
+  rclcpp::Node::SharedPtr sink_;
+  rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pub_raw_;
+  std::vector<rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr> subs_;
+  std::vector<sensor_msgs::msg::Image::ConstSharedPtr> received_;
+};
+
+TEST_F(ImageProcIntraProcessTest, colorIsShared)
+{
+  subscribe("image_color", 2);
+  ASSERT_TRUE(receive());
+  EXPECT_EQ(received_[0]->encoding, sensor_msgs::image_encodings::BGR8);
+  EXPECT_EQ(received_[0], received_[1]);
+}
+
+TEST_F(ImageProcIntraProcessTest, monoIsShared)
+{
+  subscribe("image_mono", 2);
+  ASSERT_TRUE(receive());
+  EXPECT_EQ(received_[0]->encoding, sensor_msgs::image_encodings::MONO8);
+  EXPECT_EQ(received_[0], received_[1]);
+  // Luma of a uniform mosaic is uniform
+  ASSERT_EQ(received_[0]->data.size(), 64u * 48u);
+  EXPECT_EQ(received_[0]->data[64 * 24 + 32], 128);
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
@@ -0,0 +1,137 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <builtin_interfaces/msg/time.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+#include "image_proc/latest_only.hpp"
+#include "image_proc/processing_diagnostics.hpp"
+
+namespace
+{
+
+std::shared_ptr<rclcpp::Node> makeNode(const std::vector<rclcpp::Parameter> & overrides)
+{
+  rclcpp::NodeOptions options;
+  options.parameter_overrides(overrides);
+  return std::make_shared<rclcpp::Node>("test_latest_only", options);
+}
+
+builtin_interfaces::msg::Time stampAgo(rclcpp::Node & node, double seconds)
+{
+  return node.now() - rclcpp::Duration::from_seconds(seconds);
+}
+
+}  // namespace
+
+TEST(LatestOnlyTest, disabledByDefault)
+{
+  auto node = makeNode({});
+  image_proc::LatestOnly latest_only(node.get());
+
+  EXPECT_FALSE(latest_only.enabled());
+  EXPECT_EQ(latest_only.queueSize(5), 5);
+  EXPECT_EQ(latest_only.qos(rclcpp::QoS(10)).depth(), 10u);
+
+  // Out of order and old inputs are all processed
+  EXPECT_FALSE(latest_only.stale(stampAgo(*node, 1.0)));
+  EXPECT_FALSE(latest_only.stale(stampAgo(*node, 2.0)));
+  EXPECT_FALSE(latest_only.stale(stampAgo(*node, 100.0)));
+}
+
+TEST(LatestOnlyTest, keepsNewest)
+{
+  auto node = makeNode({rclcpp::Parameter("latest_only", true)});
+  image_proc::LatestOnly latest_only(node.get());
+
+  EXPECT_TRUE(latest_only.enabled());
+  EXPECT_EQ(latest_only.queueSize(5), 1);
+  EXPECT_EQ(latest_only.qos(rclcpp::SensorDataQoS()).depth(), 1u);
+  const rmw_qos_profile_t profile = latest_only.qos(rmw_qos_profile_default);
+  EXPECT_EQ(profile.history, RMW_QOS_POLICY_HISTORY_KEEP_LAST);
+  EXPECT_EQ(profile.depth, 1u);
+
+  const auto older = stampAgo(*node, 2.0);
+  const auto newer = stampAgo(*node, 1.0);
+  EXPECT_FALSE(latest_only.stale(newer));
+  EXPECT_TRUE(latest_only.stale(older));
+  // The same stamp again, e.g. from a second callback of the node, is taken
+  EXPECT_FALSE(latest_only.stale(newer));
+}
+
+TEST(LatestOnlyTest, maxInputAge)
+{
+  auto node = makeNode({rclcpp::Parameter("max_input_age", 0.5)});
+  image_proc::LatestOnly latest_only(node.get());
+
+  EXPECT_FALSE(latest_only.enabled());
+  EXPECT_EQ(latest_only.queueSize(5), 5);
+  EXPECT_TRUE(latest_only.stale(stampAgo(*node, 10.0)));
+  EXPECT_FALSE(latest_only.stale(stampAgo(*node, 0.0)));
+  // Older than the last one, but young enough
+  EXPECT_FALSE(latest_only.stale(stampAgo(*node, 0.1)));
+}
+
+TEST(LatestOnlyTest, admitRejectsStale)
+{
+  auto node = makeNode({rclcpp::Parameter("latest_only", true)});
+  image_proc::LatestOnly latest_only(node.get());
+  image_proc::ProcessingDiagnostics processing(node.get());
+
+  const auto older = stampAgo(*node, 2.0);
+  const auto newer = stampAgo(*node, 1.0);
+  {
+    image_proc::ProcessingDiagnostics::Frame frame(processing);
+    EXPECT_TRUE(latest_only.admit(newer, frame));
+  }
+  {
+    image_proc::ProcessingDiagnostics::Frame frame(processing);
+    EXPECT_FALSE(latest_only.admit(older, frame));
+  }
+  EXPECT_TRUE(latest_only.admit(newer, processing));
+  EXPECT_FALSE(latest_only.admit(older, processing));
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
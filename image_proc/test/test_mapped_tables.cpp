@@ -0,0 +1,92 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "image_proc/mapped_tables.hpp"
+
+namespace
+{
+
+std::string makeDirectory()
+{
+  char path[] = "/tmp/test_mapped_tables_XXXXXX";
+  return mkdtemp(path) ? path : "";
+}
+
+}  // namespace
+
+TEST(MappedTables, offWithoutDirectory)
+{
+  image_proc::MappedTables::setDirectory("");
+  EXPECT_FALSE(image_proc::MappedTables::store("test", 1, {cv::Mat::eye(4, 4, CV_32FC1)}));
+  EXPECT_EQ(image_proc::MappedTables::load("test", 1), nullptr);
+}
+
+TEST(MappedTables, mapsStoredTables)
+{
+  const std::string directory = makeDirectory();
+  ASSERT_FALSE(directory.empty());
+  image_proc::MappedTables::setDirectory(directory);
+
+  cv::Mat map(37, 53, CV_16SC2);
+  cv::randu(map, cv::Scalar::all(-1000), cv::Scalar::all(1000));
+  cv::Mat plane(40, 80, CV_32FC1);
+  cv::randu(plane, cv::Scalar::all(-1.0), cv::Scalar::all(1.0));
+  // A view, not continuous in memory
+  const cv::Mat window = plane(cv::Rect(5, 3, 61, 29));
+
+  ASSERT_TRUE(image_proc::MappedTables::store("test", 7, {map, window}));
+  EXPECT_EQ(image_proc::MappedTables::load("test", 8), nullptr);
+  EXPECT_EQ(image_proc::MappedTables::load("other", 7), nullptr);
+
+  const auto mapped = image_proc::MappedTables::load("test", 7);
+  ASSERT_NE(mapped, nullptr);
+  ASSERT_EQ(mapped->tables().size(), 2u);
+  const cv::Mat & mapped_map = mapped->tables()[0];
+  const cv::Mat & mapped_window = mapped->tables()[1];
+  ASSERT_EQ(mapped_map.type(), map.type());
+  ASSERT_EQ(mapped_map.size(), map.size());
+  EXPECT_EQ(cv::norm(mapped_map, map, cv::NORM_INF), 0.0);
+  ASSERT_EQ(mapped_window.type(), window.type());
+  ASSERT_EQ(mapped_window.size(), window.size());
+  EXPECT_EQ(cv::norm(mapped_window, window, cv::NORM_INF), 0.0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped_window.data) % 64, 0u);
+
+  image_proc::MappedTables::setDirectory("");
+}
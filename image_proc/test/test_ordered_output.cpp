@@ -0,0 +1,180 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "image_proc/ordered_output.hpp"
+
+namespace
+{
+
+using image_proc::OrderedOutput;
+
+// Outputs published by the frames, in publication order
+class Outputs
+{
+public:
+  void publish(int frame)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_.push_back(frame);
+  }
+
+  std::vector<int> frames()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<int> frames_;
+};
+
+}  // namespace
+
+TEST(OrderedOutput, publishesInOrder)
+{
+  Outputs outputs;
+  {
+    OrderedOutput ordered(1, 3);
+    // Earlier frames take longer, so they finish last
+    for (int frame = 0; frame < 3; ++frame) {
+      ASSERT_TRUE(
+        ordered.dispatch(
+          [&outputs, frame](OrderedOutput::Ticket & ticket) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(30 * (3 - frame)));
+            ticket.wait();
+            outputs.publish(frame);
+          }));
+    }
+  }
+  EXPECT_EQ(outputs.frames(), (std::vector<int>{0, 1, 2}));
+}
+
+TEST(OrderedOutput, skipsFramesWithoutOutput)
+{
+  Outputs outputs;
+  {
+    OrderedOutput ordered(1, 3);
+    for (int frame = 0; frame < 3; ++frame) {
+      ASSERT_TRUE(
+        ordered.dispatch(
+          [&outputs, frame](OrderedOutput::Ticket & ticket) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10 * (3 - frame)));
+            // Frame 1 returns early, as on an error
+            if (frame == 1) {
+              return;
+            }
+            ticket.wait();
+            outputs.publish(frame);
+          }));
+    }
+  }
+  EXPECT_EQ(outputs.frames(), (std::vector<int>{0, 2}));
+}
+
+TEST(OrderedOutput, dropsFramesBeyondWindow)
+{
+  std::atomic<bool> go(false);
+  std::atomic<int> ran(0);
+  OrderedOutput ordered(1, 2);
+  EXPECT_EQ(ordered.maxInFlight(), 2u);
+
+  auto work = [&go, &ran](OrderedOutput::Ticket &) {
+      while (!go) {
+        std::this_thread::yield();
+      }
+      ++ran;
+    };
+  EXPECT_TRUE(ordered.dispatch(work));
+  EXPECT_TRUE(ordered.dispatch(work));
+  EXPECT_FALSE(ordered.dispatch(work));
+
+  go = true;
+  while (ran < 2) {
+    std::this_thread::yield();
+  }
+  // The window frees up once the frames are done
+  while (!ordered.dispatch(work)) {
+    std::this_thread::yield();
+  }
+}
+
+TEST(OrderedOutput, releasesOutputsIndependently)
+{
+  Outputs first;
+  Outputs second;
+  std::atomic<bool> go(false);
+  {
+    OrderedOutput ordered(2, 2);
+    // Frame 0 is done with its first output, but holds the second one
+    ASSERT_TRUE(
+      ordered.dispatch(
+        [&first, &second, &go](OrderedOutput::Ticket & ticket) {
+          ticket.wait(0);
+          first.publish(0);
+          ticket.release(0);
+          while (!go) {
+            std::this_thread::yield();
+          }
+          ticket.wait(1);
+          second.publish(0);
+        }));
+    ASSERT_TRUE(
+      ordered.dispatch(
+        [&first, &second, &go](OrderedOutput::Ticket & ticket) {
+          ticket.wait(0);
+          first.publish(1);
+          go = true;
+          ticket.wait(1);
+          second.publish(1);
+        }));
+  }
+  EXPECT_EQ(first.frames(), (std::vector<int>{0, 1}));
+  EXPECT_EQ(second.frames(), (std::vector<int>{0, 1}));
+}
+
+TEST(OrderedOutput, defaultTicketIsAlwaysInTurn)
+{
+  OrderedOutput::Ticket ticket;
+  ticket.wait();
+  ticket.release();
+  ticket.wait(3);
+}
@@ -0,0 +1,174 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <image_proc/packed.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+// Packs samples of bits bits least significant bit first, one row at a time
+sensor_msgs::msg::Image pack(
+  const cv::Mat_<uint16_t> & samples, int bits, const std::string & encoding)
+{
+  sensor_msgs::msg::Image packed;
+  packed.encoding = encoding;
+  packed.width = samples.cols;
+  packed.height = samples.rows;
+  // Rows padded by a byte, so that the step is honored
+  packed.step = (samples.cols * bits + 7) / 8 + 1;
+  packed.data.assign(packed.step * packed.height, 0);
+  for (int y = 0; y < samples.rows; ++y) {
+    uint8_t * row = &packed.data[y * packed.step];
+    for (int x = 0; x < samples.cols; ++x) {
+      for (int b = 0; b < bits; ++b) {
+        const size_t bit = static_cast<size_t>(x) * bits + b;
+        if (samples(y, x) & (1 << b)) {
+          row[bit / 8] |= 1 << (bit % 8);
+        }
+      }
+    }
+  }
+  return packed;
+}
+
+cv::Mat_<uint16_t> makeSamples(int width, int height, int bits)
+{
+  cv::Mat_<uint16_t> samples(height, width);
+  cv::randu(samples, 0, 1 << bits);
+  return samples;
+}
+
+}  // namespace
+
+TEST(Packed, encodings)
+{
+  namespace enc = image_proc::packed_encodings;
+  EXPECT_EQ(image_proc::packedBitDepth(enc::MONO10P), 10);
+  EXPECT_EQ(image_proc::packedBitDepth(enc::BAYER_GRBG12P), 12);
+  EXPECT_EQ(image_proc::packedBitDepth(sensor_msgs::image_encodings::BAYER_RGGB16), 0);
+  EXPECT_EQ(image_proc::packedBitDepth("mono14p"), 0);
+
+  EXPECT_EQ(
+    image_proc::unpackedEncoding(enc::MONO12P, CV_8U), sensor_msgs::image_encodings::MONO8);
+  EXPECT_EQ(
+    image_proc::unpackedEncoding(enc::BAYER_BGGR10P, CV_16U),
+    sensor_msgs::image_encodings::BAYER_BGGR16);
+}
+
+TEST(Packed, unpacksWholeImage)
+{
+  for (int bits : {10, 12}) {
+    // Wide enough for the vectorized groups, odd to leave a partial group
+    const auto samples = makeSamples(101, 7, bits);
+    const auto packed = pack(
+      samples, bits,
+      bits == 10 ? image_proc::packed_encodings::MONO10P : image_proc::packed_encodings::MONO12P);
+    const cv::Rect all(0, 0, samples.cols, samples.rows);
+
+    cv::Mat wide, narrow;
+    ASSERT_TRUE(image_proc::unpackImage(packed, all, CV_16U, wide));
+    ASSERT_TRUE(image_proc::unpackImage(packed, all, CV_8U, narrow));
+    ASSERT_EQ(wide.type(), CV_16UC1);
+    ASSERT_EQ(narrow.type(), CV_8UC1);
+
+    for (int y = 0; y < samples.rows; ++y) {
+      for (int x = 0; x < samples.cols; ++x) {
+        ASSERT_EQ(wide.at<uint16_t>(y, x), samples(y, x) << (16 - bits)) << bits;
+        ASSERT_EQ(narrow.at<uint8_t>(y, x), samples(y, x) >> (bits - 8)) << bits;
+      }
+    }
+  }
+}
+
+TEST(Packed, unpacksWindowAndRowPairs)
+{
+  for (int bits : {10, 12}) {
+    const auto samples = makeSamples(80, 24, bits);
+    const auto packed = pack(
+      samples, bits, bits == 10 ? image_proc::packed_encodings::BAYER_RGGB10P :
+      image_proc::packed_encodings::BAYER_RGGB12P);
+
+    // Starting within a group of samples
+    const cv::Rect window(3, 2, 70, 20);
+    cv::Mat cropped;
+    ASSERT_TRUE(image_proc::unpackImage(packed, window, CV_16U, cropped));
+    ASSERT_EQ(cropped.size(), window.size());
+    for (int y = 0; y < window.height; ++y) {
+      for (int x = 0; x < window.width; ++x) {
+        ASSERT_EQ(
+          cropped.at<uint16_t>(y, x), samples(window.y + y, window.x + x) << (16 - bits));
+      }
+    }
+
+    cv::Mat pairs;
+    ASSERT_TRUE(image_proc::unpackImage(packed, window, CV_16U, pairs, 4));
+    ASSERT_EQ(pairs.rows, window.height / 4 * 2);
+    for (int y = 0; y < pairs.rows; ++y) {
+      const int src_y = window.y + y / 2 * 4 + y % 2;
+      for (int x = 0; x < window.width; ++x) {
+        ASSERT_EQ(pairs.at<uint16_t>(y, x), samples(src_y, window.x + x) << (16 - bits));
+      }
+    }
+  }
+}
+
+TEST(Packed, unpacksMessage)
+{
+  const auto samples = makeSamples(64, 4, 12);
+  const auto packed = pack(samples, 12, image_proc::packed_encodings::BAYER_GBRG12P);
+
+  for (bool pooled : {false, true}) {
+    const auto msg = image_proc::unpackImageMessage(packed, CV_8U, pooled);
+    ASSERT_TRUE(msg);
+    EXPECT_EQ(msg->encoding, sensor_msgs::image_encodings::BAYER_GBRG8);
+    EXPECT_EQ(msg->step, 64u);
+    EXPECT_EQ(msg->data[65], samples(1, 1) >> 4);
+  }
+
+  auto truncated = packed;
+  truncated.data.resize(truncated.data.size() - 1);
+  EXPECT_FALSE(image_proc::unpackImageMessage(truncated, CV_8U, false));
+
+  auto unpacked = packed;
+  unpacked.encoding = sensor_msgs::image_encodings::MONO16;
+  EXPECT_FALSE(image_proc::unpackImageMessage(unpacked, CV_16U, false));
+}
@@ -0,0 +1,93 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "image_proc/parameter_snapshot.hpp"
+
+namespace
+{
+
+struct Config
+{
+  int width = 0;
+  int height = 0;
+};
+
+}  // namespace
+
+TEST(ParameterSnapshotTest, heldSnapshotsStayUnchanged)
+{
+  image_proc::ParameterSnapshot<Config> snapshot(Config{640, 480});
+  const auto before = snapshot.get();
+  EXPECT_EQ(before, snapshot.get());
+
+  snapshot.update([](Config & config) {config.width = 1280;});
+  const auto after = snapshot.get();
+  EXPECT_NE(before, after);
+  EXPECT_EQ(before->width, 640);
+  EXPECT_EQ(after->width, 1280);
+  EXPECT_EQ(after->height, 480);
+
+  snapshot.set(Config{1, 2});
+  EXPECT_EQ(after->width, 1280);
+  EXPECT_EQ(snapshot.get()->width, 1);
+  EXPECT_EQ(snapshot.get()->height, 2);
+}
+
+TEST(ParameterSnapshotTest, readersSeeConsistentSnapshots)
+{
+  // The writer keeps width and height equal, no reader may see them differ
+  image_proc::ParameterSnapshot<Config> snapshot;
+  std::atomic<bool> done{false};
+  std::thread writer(
+    [&]() {
+      for (int i = 1; i <= 10000; ++i) {
+        snapshot.set(Config{i, i});
+      }
+      done = true;
+    });
+  int last = 0;
+  while (!done) {
+    const auto config = snapshot.get();
+    ASSERT_EQ(config->width, config->height);
+    // Snapshots are published in order
+    ASSERT_GE(config->width, last);
+    last = config->width;
+  }
+  writer.join();
+  EXPECT_EQ(snapshot.get()->width, 10000);
+}
@@ -0,0 +1,91 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include "buffer_pool_test.hpp"
+#include "image_proc/point_cloud_buffer_pool.hpp"
+#include "sensor_msgs/point_cloud2_iterator.hpp"
+
+using PointCloudBufferPool = BufferPoolTest<image_proc::PointCloudBufferPool>;
+
+TEST_F(PointCloudBufferPool, recyclesReleasedClouds)
+{
+  const auto before = pool.statistics();
+
+  sensor_msgs::msg::PointCloud2 layout;
+  sensor_msgs::PointCloud2Modifier(layout).setPointCloud2FieldsByString(1, "xyz");
+
+  const uint8_t * data;
+  {
+    auto cloud = pool.acquire(layout, 480, 640);
+    ASSERT_EQ(cloud->data.size(), 640u * 480u * layout.point_step);
+    EXPECT_EQ(cloud->fields, layout.fields);
+    EXPECT_EQ(cloud->row_step, 640u * layout.point_step);
+    data = cloud->data.data();
+  }
+
+  auto after_release = pool.statistics();
+  EXPECT_EQ(after_release.misses, before.misses + 1);
+  EXPECT_EQ(after_release.returns, before.returns + 1);
+
+  // A somewhat smaller cloud reuses the buffer
+  auto cloud = pool.acquire(layout, 400, 640);
+  EXPECT_EQ(cloud->data.data(), data);
+  EXPECT_EQ(cloud->height, 400u);
+  EXPECT_EQ(pool.statistics().hits, before.hits + 1);
+
+  // A tiny one does not tie it up
+  cloud.reset();
+  auto tiny = pool.acquire(1024);
+  EXPECT_NE(tiny->data.data(), data);
+  EXPECT_EQ(pool.statistics().misses, before.misses + 2);
+}
+
+TEST_F(PointCloudBufferPool, respectsLimit)
+{
+  pool.setMaxPooledBytes(0);
+  const auto before = pool.statistics();
+
+  pool.acquire(4096);
+
+  const auto after = pool.statistics();
+  EXPECT_EQ(after.evictions, before.evictions + 1);
+  EXPECT_EQ(after.pooled_bytes, 0u);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
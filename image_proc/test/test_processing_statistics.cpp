@@ -0,0 +1,120 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "tracetools_image_pipeline/processing_statistics.hpp"
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using tracetools_image_pipeline::ProcessingStatistics;
+
+TEST(ProcessingStatistics, percentilesWithinBucket)
+{
+  ProcessingStatistics statistics;
+  // 1 to 100 ms latencies, and a constant 2 ms on top for the age
+  for (int i = 1; i <= 100; ++i) {
+    statistics.record(milliseconds(i), milliseconds(i + 2));
+  }
+  statistics.drop();
+  statistics.skip();
+  statistics.skip();
+
+  const auto summary = statistics.collect();
+  EXPECT_EQ(summary.published, 100u);
+  EXPECT_EQ(summary.dropped, 1u);
+  EXPECT_EQ(summary.skipped, 2u);
+  EXPECT_GT(summary.period, 0.0);
+
+  // Upper bounds of the buckets, at most 25% above the exact percentile
+  EXPECT_GE(summary.latency.p50, 0.050);
+  EXPECT_LE(summary.latency.p50, 0.050 * 1.25);
+  EXPECT_GE(summary.latency.p99, 0.099);
+  EXPECT_LE(summary.latency.p99, 0.100);
+  EXPECT_DOUBLE_EQ(summary.latency.max, 0.100);
+  EXPECT_DOUBLE_EQ(summary.age.max, 0.102);
+}
+
+TEST(ProcessingStatistics, collectResetsWindow)
+{
+  ProcessingStatistics statistics;
+  statistics.record(microseconds(10), microseconds(-5));
+  auto summary = statistics.collect();
+  EXPECT_EQ(summary.published, 1u);
+  EXPECT_DOUBLE_EQ(summary.age.max, 0.0);
+
+  summary = statistics.collect();
+  EXPECT_EQ(summary.published, 0u);
+  EXPECT_EQ(summary.dropped, 0u);
+  EXPECT_DOUBLE_EQ(summary.latency.max, 0.0);
+  EXPECT_DOUBLE_EQ(summary.rate, 0.0);
+}
+
+TEST(ProcessingStatistics, outOfRangeReportsMax)
+{
+  ProcessingStatistics statistics;
+  statistics.record(std::chrono::hours(1), std::chrono::hours(1));
+  const auto summary = statistics.collect();
+  EXPECT_DOUBLE_EQ(summary.latency.p50, 3600.0);
+  EXPECT_DOUBLE_EQ(summary.latency.p99, 3600.0);
+}
+
+TEST(ProcessingStatistics, concurrentRecording)
+{
+  ProcessingStatistics statistics;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back(
+      [&statistics]() {
+        for (int i = 0; i < 1000; ++i) {
+          statistics.record(microseconds(100), microseconds(200));
+          statistics.drop();
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  const auto summary = statistics.collect();
+  EXPECT_EQ(summary.published, 4000u);
+  EXPECT_EQ(summary.dropped, 4000u);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "image_geometry/pinhole_camera_model.hpp"
+#include "image_proc/mapped_tables.hpp"
+#include "image_proc/rectification_maps.hpp"
+
+#include <sensor_msgs/distortion_models.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+
+namespace
+{
+
+sensor_msgs::msg::CameraInfo makeCameraInfo()
+{
+  // Taken from vision_opencv/image_geometry/test/utest.cpp
+  sensor_msgs::msg::CameraInfo info;
+  info.width = 640;
+  info.height = 480;
+  info.distortion_model = sensor_msgs::distortion_models::PLUMB_BOB;
+  info.d = {-0.363528858080088, 0.16117037733986861, -8.1109585007538829e-05,
+    -0.00044776712298447841, 0.0};
+  info.k = {430.15433020105519, 0.0, 311.71339830549732,
+    0.0, 430.60920415473657, 221.06824942698509,
+    0.0, 0.0, 1.0};
+  info.r = {0.99806560714807102, 0.0068562422224214027, 0.061790256276695904,
+    -0.0067522959054715113, 0.99997541519165112, -0.0018909025066874664,
+    -0.061801701660692349, 0.0014700186639396652, 0.99808736527268516};
+  info.p = {295.53402059708782, 0.0, 285.55760765075684, 0.0,
+    0.0, 295.53402059708782, 223.29617881774902, 0.0,
+    0.0, 0.0, 1.0, 0.0};
+  return info;
+}
+
+cv::Mat makeImage(int width, int height)
+{
+  cv::Mat image(height, width, CV_8UC3);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+  return image;
+}
+
+}  // namespace
+
+TEST(RectificationMaps, rebuildsOnlyOnCalibrationChange)
+{
+  auto info = makeCameraInfo();
+  image_proc::RectificationMaps maps;
+
+  EXPECT_TRUE(maps.update(info));
+  EXPECT_FALSE(maps.update(info));
+  EXPECT_FALSE(maps.update(info));
+  EXPECT_EQ(maps.rebuildCount(), 1u);
+  EXPECT_EQ(maps.hitCount(), 2u);
+
+  info.k[0] += 1.0;
+  EXPECT_TRUE(maps.update(info));
+  EXPECT_EQ(maps.rebuildCount(), 2u);
+
+  info.binning_x = 2;
+  EXPECT_TRUE(maps.update(info));
+  EXPECT_EQ(maps.size(), cv::Size(320, 480));
+}
+
+TEST(RectificationMaps, matchesCameraModel)
+{
+  auto info = makeCameraInfo();
+  image_proc::RectificationMaps maps;
+  image_geometry::PinholeCameraModel model;
+
+  for (int binning : {1, 2}) {
+    info.binning_x = binning;
+    info.binning_y = binning;
+    info.roi.x_offset = 64;
+    info.roi.y_offset = 32;
+    info.roi.width = 320;
+    info.roi.height = 240;
+    model.fromCameraInfo(info);
+    maps.update(info);
+
+    const cv::Mat image = makeImage(320 / binning, 240 / binning);
+    cv::Mat expected, rect;
+    model.rectifyImage(image, expected, cv::INTER_LINEAR);
+    maps.remap(image, rect, cv::INTER_LINEAR);
+
+    ASSERT_EQ(rect.size(), expected.size());
+    EXPECT_EQ(cv::norm(rect, expected, cv::NORM_INF), 0.0);
+  }
+}
+
+TEST(RectificationMaps, mapsCachedMaps)
+{
+  char directory[] = "/tmp/test_rectification_maps_XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+  image_proc::MappedTables::setDirectory(directory);
+
+  auto info = makeCameraInfo();
+  info.roi.x_offset = 64;
+  info.roi.y_offset = 32;
+  info.roi.width = 320;
+  info.roi.height = 240;
+  image_proc::RectificationMaps built;
+  EXPECT_TRUE(built.update(info));
+  // Loaded from the file the first one wrote
+  image_proc::RectificationMaps loaded;
+  EXPECT_TRUE(loaded.update(info));
+  EXPECT_FALSE(loaded.update(info));
+  image_proc::MappedTables::setDirectory("");
+
+  const cv::Mat image = makeImage(320, 240);
+  cv::Mat expected, rect;
+  built.remap(image, expected, cv::INTER_LINEAR);
+  loaded.remap(image, rect, cv::INTER_LINEAR);
+  ASSERT_EQ(rect.size(), expected.size());
+  EXPECT_EQ(cv::norm(rect, expected, cv::NORM_INF), 0.0);
+}
+
+TEST(RectificationMaps, remapsOnlyWindow)
+{
+  const auto info = makeCameraInfo();
+  image_proc::RectificationMaps maps;
+  maps.update(info);
+
+  const cv::Mat image = makeImage(640, 480);
+  cv::Mat expected;
+  maps.remap(image, expected, cv::INTER_LINEAR);
+
+  const cv::Rect window(100, 50, 200, 150);
+  cv::Mat rect(expected.size(), expected.type(), cv::Scalar::all(7));
+  maps.remap(image, rect, cv::INTER_LINEAR, window);
+
+  EXPECT_EQ(cv::norm(rect(window), expected(window), cv::NORM_INF), 0.0);
+  cv::Mat outside = rect.clone();
+  outside(window).setTo(cv::Scalar::all(7));
+  EXPECT_EQ(cv::countNonZero(outside.reshape(1) != 7), 0);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
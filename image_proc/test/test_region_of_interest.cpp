@@ -0,0 +1,170 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+#include "image_proc/region_of_interest.hpp"
+
+namespace
+{
+
+sensor_msgs::msg::Image::ConstSharedPtr makeImage(int width, int height)
+{
+  auto image = std::make_shared<sensor_msgs::msg::Image>();
+  image->encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+  image->width = width;
+  image->height = height;
+  image->step = width * sizeof(uint16_t);
+  image->data.resize(image->step * height);
+  // Every pixel holds its own coordinates
+  uint16_t * pixels = reinterpret_cast<uint16_t *>(image->data.data());
+  for (int v = 0; v < height; ++v) {
+    for (int u = 0; u < width; ++u) {
+      pixels[v * width + u] = static_cast<uint16_t>(v * 1000 + u);
+    }
+  }
+  return image;
+}
+
+sensor_msgs::msg::CameraInfo::ConstSharedPtr makeCameraInfo(int width, int height)
+{
+  auto info = std::make_shared<sensor_msgs::msg::CameraInfo>();
+  info->width = width;
+  info->height = height;
+  info->k = {500.0, 0.0, width / 2.0, 0.0, 500.0, height / 2.0, 0.0, 0.0, 1.0};
+  info->p = {500.0, 0.0, width / 2.0, 0.0, 0.0, 500.0, height / 2.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  return info;
+}
+
+uint16_t pixel(const sensor_msgs::msg::Image & image, int u, int v)
+{
+  return reinterpret_cast<const uint16_t *>(&image.data[v * image.step])[u];
+}
+
+}  // namespace
+
+TEST(RegionOfInterestTest, cropImage)
+{
+  const auto image = makeImage(64, 48);
+  const auto cropped = image_proc::cropImage(*image, cv::Rect(10, 20, 30, 5));
+
+  ASSERT_EQ(cropped->width, 30u);
+  ASSERT_EQ(cropped->height, 5u);
+  EXPECT_EQ(cropped->step, 30u * sizeof(uint16_t));
+  EXPECT_EQ(pixel(*cropped, 0, 0), 20 * 1000 + 10);
+  EXPECT_EQ(pixel(*cropped, 29, 4), 24 * 1000 + 39);
+}
+
+TEST(RegionOfInterestTest, cropCameraInfo)
+{
+  auto info = std::make_shared<sensor_msgs::msg::CameraInfo>(*makeCameraInfo(640, 480));
+  info->binning_x = 2;
+  info->binning_y = 2;
+  const auto cropped = image_proc::cropCameraInfo(*info, cv::Rect(10, 20, 100, 50));
+
+  // The same point projects to the same pixel of the full resolution sensor
+  EXPECT_EQ(cropped->width, 200u);
+  EXPECT_EQ(cropped->height, 100u);
+  EXPECT_DOUBLE_EQ(cropped->k[2], 320.0 - 20.0);
+  EXPECT_DOUBLE_EQ(cropped->k[5], 240.0 - 40.0);
+  EXPECT_DOUBLE_EQ(cropped->p[2], 320.0 - 20.0);
+  EXPECT_DOUBLE_EQ(cropped->p[6], 240.0 - 40.0);
+  EXPECT_DOUBLE_EQ(cropped->k[0], info->k[0]);
+}
+
+TEST(RegionOfInterestTest, scaleWindow)
+{
+  const cv::Size depth(320, 240);
+  const cv::Size color(640, 480);
+  EXPECT_EQ(
+    image_proc::scaleWindow(cv::Rect(10, 20, 30, 40), depth, color), cv::Rect(20, 40, 60, 80));
+  EXPECT_EQ(
+    image_proc::scaleWindow(cv::Rect(10, 20, 30, 40), depth, depth), cv::Rect(10, 20, 30, 40));
+  // Rounded outwards, and clipped to the image
+  EXPECT_EQ(
+    image_proc::scaleWindow(cv::Rect(1, 1, 319, 239), color, depth), cv::Rect(0, 0, 160, 120));
+}
+
+TEST(RegionOfInterestTest, parameters)
+{
+  rclcpp::NodeOptions options;
+  options.parameter_overrides(
+    {rclcpp::Parameter("roi.x_offset", 8), rclcpp::Parameter("roi.y_offset", 4),
+      rclcpp::Parameter("roi.width", 16), rclcpp::Parameter("roi.height", 100)});
+  auto node = std::make_shared<rclcpp::Node>("test_region_of_interest", options);
+  image_proc::RegionOfInterest roi(node.get());
+
+  EXPECT_TRUE(roi.enabled());
+  // Clipped to the image
+  EXPECT_EQ(roi.window(cv::Size(64, 48)), cv::Rect(8, 4, 16, 44));
+
+  auto depth = makeImage(64, 48);
+  auto color = makeImage(128, 96);
+  auto info = makeCameraInfo(128, 96);
+  EXPECT_EQ(roi.crop(depth, color, info), cv::Rect(8, 4, 16, 44));
+  EXPECT_EQ(depth->width, 16u);
+  EXPECT_EQ(pixel(*depth, 0, 0), 4 * 1000 + 8);
+  EXPECT_EQ(color->width, 32u);
+  EXPECT_EQ(color->height, 88u);
+  EXPECT_EQ(pixel(*color, 0, 0), 8 * 1000 + 16);
+  EXPECT_DOUBLE_EQ(info->k[2], 64.0 - 16.0);
+
+  // Disabled at runtime
+  node->set_parameter(rclcpp::Parameter("roi.width", 0));
+  EXPECT_FALSE(roi.enabled());
+  EXPECT_EQ(roi.window(cv::Size(64, 48)), cv::Rect(0, 0, 64, 48));
+  auto full = makeImage(64, 48);
+  const auto full_ptr = full.get();
+  auto full_info = makeCameraInfo(64, 48);
+  EXPECT_EQ(roi.crop(full, full_info), cv::Rect(0, 0, 64, 48));
+  EXPECT_EQ(full.get(), full_ptr);
+}
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  rclcpp::shutdown();
+  return result;
+}
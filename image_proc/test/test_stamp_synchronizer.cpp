@@ -0,0 +1,164 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+#include "image_proc/stamp_synchronizer.hpp"
+
+namespace
+{
+
+using sensor_msgs::msg::CameraInfo;
+using sensor_msgs::msg::Image;
+using Synchronizer = image_proc::StampSynchronizer<Image, CameraInfo, Image>;
+
+template<typename M>
+std::shared_ptr<const M> stamped(int32_t sec, uint32_t nanosec = 0)
+{
+  auto msg = std::make_shared<M>();
+  msg->header.stamp.sec = sec;
+  msg->header.stamp.nanosec = nanosec;
+  return msg;
+}
+
+// Records the stamps of the emitted sets, checking every set has one stamp
+struct Recorder
+{
+  std::vector<int32_t> seconds;
+
+  Synchronizer::Callback callback()
+  {
+    return [this](
+      const Image::ConstSharedPtr & a, const CameraInfo::ConstSharedPtr & b,
+      const Image::ConstSharedPtr & c)
+      {
+        ASSERT_TRUE(a && b && c);
+        EXPECT_EQ(a->header.stamp, b->header.stamp);
+        EXPECT_EQ(a->header.stamp, c->header.stamp);
+        seconds.push_back(a->header.stamp.sec);
+      };
+  }
+};
+
+}  // namespace
+
+TEST(StampSynchronizerTest, emitsCompleteSets)
+{
+  Synchronizer sync(3);
+  Recorder recorder;
+  sync.registerCallback(recorder.callback());
+
+  sync.add<0>(stamped<Image>(1));
+  sync.add<1>(stamped<CameraInfo>(1));
+  EXPECT_TRUE(recorder.seconds.empty());
+  // Emitted with the last input, without waiting for the next stamp
+  sync.add<2>(stamped<Image>(1));
+  EXPECT_EQ(recorder.seconds, std::vector<int32_t>({1}));
+
+  // Interleaved captures, completed out of order
+  sync.add<0>(stamped<Image>(2));
+  sync.add<0>(stamped<Image>(3));
+  sync.add<1>(stamped<CameraInfo>(3));
+  sync.add<1>(stamped<CameraInfo>(2));
+  sync.add<2>(stamped<Image>(3));
+  sync.add<2>(stamped<Image>(2));
+  EXPECT_EQ(recorder.seconds, std::vector<int32_t>({1, 3, 2}));
+
+  const auto statistics = sync.statistics();
+  EXPECT_EQ(statistics.matched, 3u);
+  EXPECT_EQ(statistics.missed, 0u);
+  EXPECT_EQ(statistics.duplicates, 0u);
+  EXPECT_EQ(statistics.pending, 0u);
+}
+
+TEST(StampSynchronizerTest, matchesNanoseconds)
+{
+  Synchronizer sync(2);
+  Recorder recorder;
+  sync.registerCallback(recorder.callback());
+
+  sync.add<0>(stamped<Image>(1, 500));
+  sync.add<1>(stamped<CameraInfo>(1, 500));
+  sync.add<2>(stamped<Image>(1, 501));
+  EXPECT_TRUE(recorder.seconds.empty());
+  EXPECT_EQ(sync.statistics().pending, 2u);
+}
+
+TEST(StampSynchronizerTest, missesOldestIncompleteSet)
+{
+  Synchronizer sync(2);
+  Recorder recorder;
+  sync.registerCallback(recorder.callback());
+
+  // The camera info of 1 never arrives
+  sync.add<0>(stamped<Image>(1));
+  sync.add<2>(stamped<Image>(1));
+  sync.add<0>(stamped<Image>(2));
+  // No room left for 3, 1 is dropped
+  sync.add<0>(stamped<Image>(3));
+  EXPECT_EQ(sync.statistics().missed, 1u);
+  EXPECT_EQ(sync.statistics().pending, 2u);
+
+  // Too late, older than every set waiting
+  sync.add<1>(stamped<CameraInfo>(1));
+  EXPECT_EQ(sync.statistics().missed, 2u);
+
+  sync.add<1>(stamped<CameraInfo>(2));
+  sync.add<2>(stamped<Image>(2));
+  EXPECT_EQ(recorder.seconds, std::vector<int32_t>({2}));
+  // The slot freed by 2 starts empty for a new stamp
+  sync.add<1>(stamped<CameraInfo>(4));
+  sync.add<2>(stamped<Image>(4));
+  EXPECT_EQ(recorder.seconds.size(), 1u);
+  sync.add<0>(stamped<Image>(4));
+  EXPECT_EQ(recorder.seconds, std::vector<int32_t>({2, 4}));
+}
+
+TEST(StampSynchronizerTest, countsDuplicates)
+{
+  Synchronizer sync(2);
+  Recorder recorder;
+  sync.registerCallback(recorder.callback());
+
+  sync.add<0>(stamped<Image>(1));
+  sync.add<0>(stamped<Image>(1));
+  sync.add<1>(stamped<CameraInfo>(1));
+  sync.add<2>(stamped<Image>(1));
+  EXPECT_EQ(recorder.seconds, std::vector<int32_t>({1}));
+  EXPECT_EQ(sync.statistics().duplicates, 1u);
+}
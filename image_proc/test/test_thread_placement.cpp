@@ -0,0 +1,61 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "image_proc/thread_placement.hpp"
+
+using image_proc::ThreadPlacement;
+
+TEST(ThreadPlacementTest, parsesCpuLists)
+{
+  EXPECT_EQ(ThreadPlacement::parseCpuList("0-3"), (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(ThreadPlacement::parseCpuList("0-1,4,6-7\n"), (std::vector<int>{0, 1, 4, 6, 7}));
+  EXPECT_EQ(ThreadPlacement::parseCpuList("5,2,2"), (std::vector<int>{2, 5}));
+  EXPECT_TRUE(ThreadPlacement::parseCpuList("").empty());
+  EXPECT_TRUE(ThreadPlacement::parseCpuList("x").empty());
+}
+
+TEST(ThreadPlacementTest, formatsCpuLists)
+{
+  EXPECT_EQ(ThreadPlacement::formatCpuList({0, 1, 2, 3}), "0-3");
+  EXPECT_EQ(ThreadPlacement::formatCpuList({7, 6, 0, 1, 4}), "0-1,4,6-7");
+  EXPECT_EQ(ThreadPlacement::formatCpuList({3}), "3");
+  EXPECT_EQ(ThreadPlacement::formatCpuList({}), "");
+
+  const std::string list = "0-2,8,10-11";
+  EXPECT_EQ(ThreadPlacement::formatCpuList(ThreadPlacement::parseCpuList(list)), list);
+}
@@ -0,0 +1,165 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+
+#include <image_proc/yuv.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace
+{
+
+// A YUV image of random samples, rows padded by two bytes
+sensor_msgs::msg::Image makeImage(const std::string & encoding, int width, int height)
+{
+  sensor_msgs::msg::Image image;
+  image.encoding = encoding;
+  image.width = width;
+  image.height = height;
+  const bool nv12 = encoding == image_proc::yuv_encodings::NV12;
+  image.step = width * (nv12 ? 1 : 2) + 2;
+  image.data.resize(image.step * image_proc::yuvRows(encoding, height));
+  cv::Mat data(static_cast<int>(image.data.size()), 1, CV_8UC1, image.data.data());
+  cv::randu(data, cv::Scalar::all(0), cv::Scalar::all(256));
+  return image;
+}
+
+const char * const ENCODINGS[] = {
+  sensor_msgs::image_encodings::YUV422, sensor_msgs::image_encodings::YUV422_YUY2,
+  image_proc::yuv_encodings::NV12,
+};
+
+}  // namespace
+
+TEST(Yuv, viewsOnlyWholeImages)
+{
+  auto image = makeImage(image_proc::yuv_encodings::NV12, 64, 48);
+  const cv::Mat view = image_proc::yuvView(image);
+  EXPECT_EQ(view.size(), cv::Size(64, 72));
+  EXPECT_EQ(image_proc::yuvSize(image.encoding, view), cv::Size(64, 48));
+
+  image.data.pop_back();
+  EXPECT_TRUE(image_proc::yuvView(image).empty());
+
+  auto odd = makeImage(sensor_msgs::image_encodings::YUV422, 63, 48);
+  EXPECT_TRUE(image_proc::yuvView(odd).empty());
+
+  odd.encoding = sensor_msgs::image_encodings::MONO8;
+  EXPECT_FALSE(image_proc::isYuv(odd.encoding));
+}
+
+TEST(Yuv, monoIsLuma)
+{
+  for (const char * encoding : ENCODINGS) {
+    const auto image = makeImage(encoding, 64, 48);
+    cv::Mat mono;
+    ASSERT_TRUE(image_proc::yuvToMono(image, mono));
+    ASSERT_EQ(mono.size(), cv::Size(64, 48));
+
+    // Y is the second byte of UYVY pairs, the first of YUYV ones
+    const std::string enc = encoding;
+    const int pixel_size = enc == image_proc::yuv_encodings::NV12 ? 1 : 2;
+    const int offset = enc == sensor_msgs::image_encodings::YUV422 ? 1 : 0;
+    for (int y = 0; y < mono.rows; ++y) {
+      for (int x = 0; x < mono.cols; ++x) {
+        ASSERT_EQ(
+          mono.at<uint8_t>(y, x), image.data[y * image.step + x * pixel_size + offset]) << enc;
+      }
+    }
+  }
+}
+
+TEST(Yuv, convertsToColor)
+{
+  for (const char * encoding : ENCODINGS) {
+    const auto image = makeImage(encoding, 64, 48);
+    cv::Mat bgr;
+    ASSERT_TRUE(image_proc::yuvToBgr(image, bgr));
+    ASSERT_EQ(bgr.type(), CV_8UC3);
+    ASSERT_EQ(bgr.size(), cv::Size(64, 48));
+  }
+}
+
+TEST(Yuv, resizesPlanesSeparately)
+{
+  for (const char * encoding : ENCODINGS) {
+    // Constant planes, with U and V apart, stay constant when resized
+    auto image = makeImage(encoding, 64, 48);
+    const std::string enc = encoding;
+    const bool nv12 = enc == image_proc::yuv_encodings::NV12;
+    const int luma = enc == sensor_msgs::image_encodings::YUV422 ? 1 : 0;
+    cv::Mat view = image_proc::yuvView(image);
+    if (nv12) {
+      view.rowRange(0, 48).setTo(100);
+      view.rowRange(48, 72).reshape(2).setTo(cv::Scalar(20, 220));
+    } else {
+      for (int y = 0; y < view.rows; ++y) {
+        for (int x = 0; x < view.cols; ++x) {
+          view.at<cv::Vec2b>(y, x)[luma] = 100;
+          view.at<cv::Vec2b>(y, x)[1 - luma] = x % 2 == 0 ? 20 : 220;
+        }
+      }
+    }
+
+    const cv::Size size = image_proc::yuvAlignedSize(enc, cv::Size(33, 21));
+    EXPECT_EQ(size, cv::Size(32, nv12 ? 20 : 21));
+    cv::Mat resized;
+    image_proc::resizeYuv(view, enc, size, cv::INTER_LINEAR, resized);
+    ASSERT_EQ(image_proc::yuvSize(enc, resized), size);
+
+    sensor_msgs::msg::Image out;
+    out.encoding = enc;
+    out.width = size.width;
+    out.height = size.height;
+    out.step = static_cast<uint32_t>(resized.step[0]);
+    out.data.assign(resized.datastart, resized.dataend);
+    cv::Mat mono;
+    ASSERT_TRUE(image_proc::yuvToMono(out, mono));
+    EXPECT_EQ(cv::norm(mono, cv::Scalar(100), cv::NORM_INF), 0.0) << enc;
+
+    if (nv12) {
+      const cv::Mat chroma = resized.rowRange(size.height, resized.rows).reshape(2);
+      EXPECT_EQ(cv::norm(chroma, cv::Scalar(20, 220), cv::NORM_INF), 0.0);
+    } else {
+      for (int x = 0; x < resized.cols; ++x) {
+        EXPECT_EQ(resized.at<cv::Vec2b>(0, x)[1 - luma], x % 2 == 0 ? 20 : 220) << enc;
+      }
+    }
+  }
+}
@@ -0,0 +1,73 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PUBLISHER__BENCHMARK_SEQUENCE_HPP_
+#define IMAGE_PUBLISHER__BENCHMARK_SEQUENCE_HPP_
+
+#include <cstdint>
+
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_publisher
+{
+
+// Frames published in benchmark mode carry their sequence number in the first
+// BENCHMARK_SEQUENCE_SIZE bytes of their data, little endian, as a ROS 2 header
+// has no sequence field. The pixels they overwrite are part of the load.
+constexpr size_t BENCHMARK_SEQUENCE_SIZE = sizeof(uint64_t);
+
+inline bool writeBenchmarkSequence(sensor_msgs::msg::Image & image, uint64_t sequence)
+{
+  if (image.data.size() < BENCHMARK_SEQUENCE_SIZE) {
+    return false;
+  }
+  for (size_t i = 0; i < BENCHMARK_SEQUENCE_SIZE; ++i) {
+    image.data[i] = static_cast<uint8_t>(sequence >> (8 * i));
+  }
+  return true;
+}
+
+inline bool readBenchmarkSequence(const sensor_msgs::msg::Image & image, uint64_t & sequence)
+{
+  if (image.data.size() < BENCHMARK_SEQUENCE_SIZE) {
+    return false;
+  }
+  sequence = 0;
+  for (size_t i = 0; i < BENCHMARK_SEQUENCE_SIZE; ++i) {
+    sequence |= static_cast<uint64_t>(image.data[i]) << (8 * i);
+  }
+  return true;
+}
+
+}  // namespace image_publisher
+
+#endif  // IMAGE_PUBLISHER__BENCHMARK_SEQUENCE_HPP_
@@ -0,0 +1,74 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef IMAGE_PUBLISHER__BENCHMARK_SINK_HPP_
+#define IMAGE_PUBLISHER__BENCHMARK_SINK_HPP_
+
+#include <cstdint>
+#include <mutex>
+
+#include <image_transport/image_transport.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+namespace image_publisher
+{
+
+// Receives the frames of an ImagePublisher in benchmark mode and reports, every
+// report_period, the frames received and dropped and their end to end latency.
+class BenchmarkSink : public rclcpp::Node
+{
+public:
+  explicit BenchmarkSink(const rclcpp::NodeOptions & options);
+
+private:
+  void imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg);
+  void report();
+
+  image_transport::Subscriber sub_;
+  rclcpp::TimerBase::SharedPtr timer_;
+
+  std::mutex mutex_;
+  bool started_;
+  uint64_t expected_;  // Sequence number of the next frame
+  // Counts over the current report period
+  size_t received_;
+  size_t dropped_;
+  size_t out_of_order_;
+  double latency_sum_;
+  double latency_max_;
+  rclcpp::Time period_start_;
+};
+
+}  // namespace image_publisher
+
+#endif  // IMAGE_PUBLISHER__BENCHMARK_SINK_HPP_
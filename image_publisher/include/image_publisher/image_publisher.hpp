@@ -33,12 +33,19 @@
 #ifndef IMAGE_PUBLISHER__IMAGE_PUBLISHER_HPP_
 #define IMAGE_PUBLISHER__IMAGE_PUBLISHER_HPP_
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <image_transport/image_transport.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
 
 namespace image_publisher
 {
@@ -49,11 +56,19 @@ public:
   ImagePublisher(
     const rclcpp::NodeOptions & options,
     const std::string & filename = "");
+  ~ImagePublisher();
 
 protected:
   void onInit();
   void doWork();
   void reconfigureCallback();
+  void startDecoder();
+  void stopDecoder();
+  void decode();
+  void preloadFrames();
+  void startBenchmark();
+  void stopBenchmark();
+  void benchmark();
 
 private:
   image_transport::CameraPublisher pub_;
@@ -78,6 +93,28 @@ private:
   bool flip_image_;
   int flip_value_;
   sensor_msgs::msg::CameraInfo camera_info_;
+
+  // Message of a still image, built once and published with a new stamp
+  bool cache_message_;
+  sensor_msgs::msg::Image::SharedPtr cached_image_;
+  sensor_msgs::msg::CameraInfo::SharedPtr cached_camera_info_;
+
+  // Frames of a video or camera source, decoded ahead by decoder_thread_
+  int prefetch_depth_;
+  std::thread decoder_thread_;
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_condition_;
+  std::deque<sensor_msgs::msg::Image::SharedPtr> prefetched_;
+  bool decoder_stopping_;
+  size_t underruns_;
+
+  // Benchmark mode publishes preloaded frames from benchmark_thread_, either
+  // back to back or on a busy waited schedule of publish_rate
+  std::string benchmark_mode_;
+  int benchmark_frames_limit_;
+  std::vector<sensor_msgs::msg::Image::SharedPtr> benchmark_frames_;
+  std::thread benchmark_thread_;
+  std::atomic<bool> benchmark_stopping_;
 };
 
 }  // namespace image_publisher
@@ -0,0 +1,127 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include <image_publisher/benchmark_sequence.hpp>
+#include <image_publisher/benchmark_sink.hpp>
+#include <image_transport/image_transport.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_publisher
+{
+
+BenchmarkSink::BenchmarkSink(const rclcpp::NodeOptions & options)
+: rclcpp::Node("BenchmarkSink", options),
+  started_(false),
+  expected_(0),
+  received_(0),
+  dropped_(0),
+  out_of_order_(0),
+  latency_sum_(0.0),
+  latency_max_(0.0),
+  period_start_(this->now())
+{
+  // For compressed topics to remap appropriately, we need to pass a
+  // fully expanded and remapped topic name to image_transport
+  auto node_base = this->get_node_base_interface();
+  std::string topic = node_base->resolve_topic_or_service_name("image", false);
+
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("image_transport", "raw");
+  image_transport::TransportHints hints(this);
+  sub_ = image_transport::create_subscription(
+    this, topic, std::bind(&BenchmarkSink::imageCb, this, std::placeholders::_1),
+    hints.getTransport());
+
+  double report_period = std::max(this->declare_parameter("report_period", 1.0), 0.001);
+  timer_ = this->create_wall_timer(
+    std::chrono::duration<double>(report_period), std::bind(&BenchmarkSink::report, this));
+}
+
+void BenchmarkSink::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg)
+{
+  // The stamp is the time of publication, on the clock of the publisher
+  double latency = (this->now() - rclcpp::Time(image_msg->header.stamp)).seconds();
+
+  uint64_t sequence;
+  if (!readBenchmarkSequence(*image_msg, sequence)) {
+    RCLCPP_WARN_ONCE(get_logger(), "Received an image too small to carry a sequence number");
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++received_;
+  latency_sum_ += latency;
+  latency_max_ = std::max(latency_max_, latency);
+  if (!started_ || sequence == 0) {
+    // First frame, or the publisher restarted
+    started_ = true;
+  } else if (sequence >= expected_) {
+    dropped_ += sequence - expected_;
+  } else {
+    ++out_of_order_;
+    return;
+  }
+  expected_ = sequence + 1;
+}
+
+void BenchmarkSink::report()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  rclcpp::Time now = this->now();
+  double elapsed = (now - period_start_).seconds();
+  size_t sent = received_ + dropped_;
+  RCLCPP_INFO(
+    get_logger(),
+    "%zu frames (%.1f Hz), %zu dropped (%.2f%%), %zu out of order, "
+    "latency mean %.3f ms, max %.3f ms",
+    received_, elapsed > 0.0 ? received_ / elapsed : 0.0,
+    dropped_, sent > 0 ? 100.0 * dropped_ / sent : 0.0, out_of_order_,
+    received_ > 0 ? 1000.0 * latency_sum_ / received_ : 0.0, 1000.0 * latency_max_);
+
+  received_ = 0;
+  dropped_ = 0;
+  out_of_order_ = 0;
+  latency_sum_ = 0.0;
+  latency_max_ = 0.0;
+  period_start_ = now;
+}
+
+}  // namespace image_publisher
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+// Register the component with class_loader.
+RCLCPP_COMPONENTS_REGISTER_NODE(image_publisher::BenchmarkSink)
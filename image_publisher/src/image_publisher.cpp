@@ -31,9 +31,13 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
 #include <cmath>
 #include <chrono>
+#include <cstdint>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -41,11 +45,14 @@
 #include "cv_bridge/cv_bridge.hpp"
 
 #include <camera_info_manager/camera_info_manager.hpp>
+#include <image_publisher/benchmark_sequence.hpp>
 #include <image_publisher/image_publisher.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <rcl_interfaces/msg/set_parameters_result.hpp>
 
+#include <opencv2/core/utils/filesystem.hpp>
+
 namespace image_publisher
 {
 
@@ -54,7 +61,10 @@ using namespace std::chrono_literals;
 ImagePublisher::ImagePublisher(
   const rclcpp::NodeOptions & options,
   const std::string & filename)
-: rclcpp::Node("ImagePublisher", options)
+: rclcpp::Node("ImagePublisher", options),
+  decoder_stopping_(false),
+  underruns_(0),
+  benchmark_stopping_(false)
 {
   // For compressed topics to remap appropriately, we need to pass a
   // fully expanded and remapped topic name to image_transport
@@ -70,6 +80,10 @@ ImagePublisher::ImagePublisher(
   camera_info_url_ = this->declare_parameter("camera_info_url", std::string(""));
   retry_ = this->declare_parameter("retry", false);
   timeout_ = this->declare_parameter("timeout", 2000);
+  cache_message_ = this->declare_parameter("cache_message", true);
+  prefetch_depth_ = this->declare_parameter("prefetch_depth", 0);
+  benchmark_mode_ = this->declare_parameter("benchmark_mode", std::string(""));
+  benchmark_frames_limit_ = this->declare_parameter("benchmark_frames", 100);
 
   auto param_change_callback =
     [this](std::vector<rclcpp::Parameter> parameters) -> rcl_interfaces::msg::SetParametersResult
@@ -99,6 +113,8 @@ ImagePublisher::ImagePublisher(
         } else if (parameter.get_name() == "frame_id") {
           frame_id_ = parameter.as_string();
           RCLCPP_INFO(get_logger(), "Reset frame_id as '%s'", frame_id_.c_str());
+          // The benchmark thread reads it only when it starts
+          call_reconfigure = !benchmark_mode_.empty();
         } else if (parameter.get_name() == "publish_rate") {
           publish_rate_ = parameter.as_double();
           RCLCPP_INFO(get_logger(), "Reset publish_rate as '%lf'", publish_rate_);
@@ -107,6 +123,14 @@ ImagePublisher::ImagePublisher(
           camera_info_url_ = parameter.as_string();
           RCLCPP_INFO(get_logger(), "Reset camera_info_rul as '%s'", camera_info_url_.c_str());
           call_reconfigure = true;
+        } else if (parameter.get_name() == "benchmark_mode") {
+          benchmark_mode_ = parameter.as_string();
+          RCLCPP_INFO(get_logger(), "Reset benchmark_mode as '%s'", benchmark_mode_.c_str());
+          call_init = true;
+        } else if (parameter.get_name() == "benchmark_frames") {
+          benchmark_frames_limit_ = parameter.as_int();
+          RCLCPP_INFO(get_logger(), "Reset benchmark_frames as '%i'", benchmark_frames_limit_);
+          call_init = !benchmark_mode_.empty();
         }
       }
       // reconfigureCallback() is called within onInit() so there is no need to call it twice
@@ -124,11 +148,22 @@ ImagePublisher::ImagePublisher(
   filename_ = this->declare_parameter("filename", filename);
 }
 
+ImagePublisher::~ImagePublisher()
+{
+  stopBenchmark();
+  stopDecoder();
+}
+
 void ImagePublisher::reconfigureCallback()
 {
-  timer_ = this->create_wall_timer(
-    std::chrono::milliseconds(static_cast<int>(1000 / publish_rate_)),
-    std::bind(&ImagePublisher::doWork, this));
+  stopBenchmark();
+  if (benchmark_mode_.empty()) {
+    timer_ = this->create_wall_timer(
+      std::chrono::milliseconds(static_cast<int>(1000 / publish_rate_)),
+      std::bind(&ImagePublisher::doWork, this));
+  } else {
+    timer_.reset();
+  }
 
   camera_info_manager::CameraInfoManager c(this);
   if (!camera_info_url_.empty()) {
@@ -145,6 +180,11 @@ void ImagePublisher::reconfigureCallback()
   } else {
     RCLCPP_INFO(get_logger(), "no camera_info_url exist");
   }
+  cached_camera_info_.reset();
+
+  if (!benchmark_mode_.empty() && !benchmark_frames_.empty()) {
+    startBenchmark();
+  }
 }
 
 void ImagePublisher::doWork()
@@ -153,6 +193,34 @@ void ImagePublisher::doWork()
   if (image_.empty() && retry_) {
     ImagePublisher::onInit();
   }
+  // Publish the next frame decoded ahead, if there is one ready
+  if (decoder_thread_.joinable()) {
+    sensor_msgs::msg::Image::SharedPtr out_img;
+    {
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      if (!prefetched_.empty()) {
+        out_img = prefetched_.front();
+        prefetched_.pop_front();
+      }
+    }
+    prefetch_condition_.notify_one();
+
+    if (!out_img) {
+      ++underruns_;
+      RCLCPP_WARN_THROTTLE(
+        this->get_logger(), *this->get_clock(), 1000,
+        "Decoder is falling behind, %zu frames not published", underruns_);
+      return;
+    }
+    out_img->header.frame_id = frame_id_;
+    out_img->header.stamp = this->now();
+    camera_info_.header.frame_id = out_img->header.frame_id;
+    camera_info_.header.stamp = out_img->header.stamp;
+
+    pub_.publish(*out_img, camera_info_);
+    return;
+  }
+
   // Transform the image.
   try {
     if (cap_.isOpened()) {
@@ -166,6 +234,24 @@ void ImagePublisher::doWork()
       image_flipped_ = true;
     }
 
+    // A still image doesn't change between ticks. Publishers copy or
+    // serialize the message before returning, so only the header of the
+    // same messages has to be updated.
+    if (cache_message_ && !cap_.isOpened()) {
+      if (!cached_image_) {
+        cached_image_ = cv_bridge::CvImage(std_msgs::msg::Header(), "bgr8", image_).toImageMsg();
+      }
+      if (!cached_camera_info_) {
+        cached_camera_info_ = std::make_shared<sensor_msgs::msg::CameraInfo>(camera_info_);
+      }
+      cached_image_->header.frame_id = frame_id_;
+      cached_image_->header.stamp = this->now();
+      cached_camera_info_->header = cached_image_->header;
+
+      pub_.publish(cached_image_, cached_camera_info_);
+      return;
+    }
+
     sensor_msgs::msg::Image::SharedPtr out_img =
       cv_bridge::CvImage(std_msgs::msg::Header(), "bgr8", image_).toImageMsg();
     out_img->header.frame_id = frame_id_;
@@ -184,9 +270,32 @@ void ImagePublisher::doWork()
 void ImagePublisher::onInit()
 {
   RCLCPP_INFO(this->get_logger(), "File name for publishing image is: %s", filename_.c_str());
+  stopBenchmark();
+  stopDecoder();
+  cached_image_.reset();
+  benchmark_frames_.clear();
+  if (!benchmark_mode_.empty() && benchmark_mode_ != "unthrottled" &&
+    benchmark_mode_ != "busy_wait")
+  {
+    RCLCPP_WARN(
+      get_logger(), "Unknown benchmark_mode '%s', using 'busy_wait'", benchmark_mode_.c_str());
+    benchmark_mode_ = "busy_wait";
+  }
   try {
-    image_ = cv::imread(filename_, cv::IMREAD_COLOR);
-    if (image_.empty()) {  // if filename not exist, open video device
+    bool directory = cv::utils::fs::isDirectory(filename_);
+    if (directory) {
+      // The images of a directory are only published as preloaded frames
+      CV_Assert(!benchmark_mode_.empty());
+      std::vector<cv::String> files;
+      cv::glob(filename_, files);
+      image_ = cv::Mat();
+      for (size_t i = 0; i < files.size() && image_.empty(); ++i) {
+        image_ = cv::imread(files[i], cv::IMREAD_COLOR);
+      }
+    } else {
+      image_ = cv::imread(filename_, cv::IMREAD_COLOR);
+    }
+    if (image_.empty() && !directory) {  // if filename not exist, open video device
       try {  // if filename is number
         int num = std::stoi(filename_);  // num is 1234798797
         cap_.open(num);
@@ -232,6 +341,12 @@ void ImagePublisher::onInit()
   }
   image_flipped_ = false;  // Image newly read, needs to be flipped
 
+  if (!benchmark_mode_.empty()) {
+    preloadFrames();
+  } else if (cap_.isOpened() && prefetch_depth_ > 0) {
+    startDecoder();
+  }
+
   camera_info_.width = image_.cols;
   camera_info_.height = image_.rows;
   camera_info_.distortion_model = "plumb_bob";
@@ -251,6 +366,170 @@ void ImagePublisher::onInit()
   ImagePublisher::reconfigureCallback();
 }
 
+void ImagePublisher::startDecoder()
+{
+  decoder_stopping_ = false;
+  decoder_thread_ = std::thread(&ImagePublisher::decode, this);
+}
+
+void ImagePublisher::stopDecoder()
+{
+  if (!decoder_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(prefetch_mutex_);
+    decoder_stopping_ = true;
+  }
+  prefetch_condition_.notify_one();
+  decoder_thread_.join();
+  prefetched_.clear();
+}
+
+void ImagePublisher::decode()
+{
+  cv::Mat frame;
+  while (true) {
+    {
+      // Wait for room in the ring
+      std::unique_lock<std::mutex> lock(prefetch_mutex_);
+      prefetch_condition_.wait(
+        lock, [this] {
+          return decoder_stopping_ ||
+          prefetched_.size() < static_cast<size_t>(prefetch_depth_);
+        });
+      if (decoder_stopping_) {
+        return;
+      }
+    }
+
+    // Loop over the video
+    if (!cap_.read(frame)) {
+      cap_.set(cv::CAP_PROP_POS_FRAMES, 0);
+      if (!cap_.read(frame)) {
+        RCLCPP_ERROR(this->get_logger(), "Unable to read a frame from %s", filename_.c_str());
+        return;
+      }
+    }
+
+    try {
+      if (flip_image_) {
+        cv::flip(frame, frame, flip_value_);
+      }
+      sensor_msgs::msg::Image::SharedPtr msg =
+        cv_bridge::CvImage(std_msgs::msg::Header(), "bgr8", frame).toImageMsg();
+
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      prefetched_.push_back(msg);
+    } catch (cv::Exception & e) {
+      RCLCPP_ERROR(
+        this->get_logger(), "Image processing error: %s %s %s %i",
+        e.err.c_str(), e.func.c_str(), e.file.c_str(), e.line);
+    }
+  }
+}
+
+void ImagePublisher::preloadFrames()
+{
+  // Frames are converted ahead, so that publishing measures only the transport
+  auto add = [this](cv::Mat & frame) {
+      if (flip_image_) {
+        cv::flip(frame, frame, flip_value_);
+      }
+      benchmark_frames_.push_back(
+        cv_bridge::CvImage(std_msgs::msg::Header(), "bgr8", frame).toImageMsg());
+    };
+  size_t limit = static_cast<size_t>(std::max(benchmark_frames_limit_, 1));
+
+  try {
+    cv::Mat frame;
+    if (cv::utils::fs::isDirectory(filename_)) {
+      std::vector<cv::String> files;
+      cv::glob(filename_, files);
+      for (size_t i = 0; i < files.size() && benchmark_frames_.size() < limit; ++i) {
+        frame = cv::imread(files[i], cv::IMREAD_COLOR);
+        if (!frame.empty()) {
+          add(frame);
+        }
+      }
+    } else if (cap_.isOpened()) {
+      cap_.set(cv::CAP_PROP_POS_FRAMES, 0);
+      while (benchmark_frames_.size() < limit && cap_.read(frame)) {
+        add(frame);
+      }
+      cap_.set(cv::CAP_PROP_POS_FRAMES, 0);
+    } else {
+      frame = image_.clone();
+      add(frame);
+    }
+  } catch (cv::Exception & e) {
+    RCLCPP_ERROR(
+      this->get_logger(), "Image processing error: %s %s %s %i",
+      e.err.c_str(), e.func.c_str(), e.file.c_str(), e.line);
+  }
+  RCLCPP_INFO(get_logger(), "Preloaded %zu frames for benchmark", benchmark_frames_.size());
+}
+
+void ImagePublisher::startBenchmark()
+{
+  benchmark_stopping_ = false;
+  benchmark_thread_ = std::thread(&ImagePublisher::benchmark, this);
+}
+
+void ImagePublisher::stopBenchmark()
+{
+  if (!benchmark_thread_.joinable()) {
+    return;
+  }
+  benchmark_stopping_ = true;
+  benchmark_thread_.join();
+}
+
+void ImagePublisher::benchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  const bool busy_wait = benchmark_mode_ == "busy_wait" && publish_rate_ > 0.0;
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(busy_wait ? 1.0 / publish_rate_ : 0.0));
+
+  sensor_msgs::msg::CameraInfo camera_info = camera_info_;
+  const std::string frame_id = frame_id_;
+  uint64_t sequence = 0;
+  size_t late = 0;
+  auto deadline = Clock::now();
+  const auto start = deadline;
+
+  while (!benchmark_stopping_) {
+    if (busy_wait) {
+      // Spin instead of sleeping, as sleeps overshoot by far more than the
+      // period of the rates this mode is meant for
+      deadline += period;
+      while (Clock::now() < deadline && !benchmark_stopping_) {
+      }
+      // Don't publish a burst to catch up on a deadline missed by a period
+      auto now = Clock::now();
+      if (now - deadline > period) {
+        ++late;
+        deadline = now;
+      }
+    }
+
+    sensor_msgs::msg::Image & image = *benchmark_frames_[sequence % benchmark_frames_.size()];
+    writeBenchmarkSequence(image, sequence);
+    image.header.frame_id = frame_id;
+    image.header.stamp = this->now();
+    camera_info.header = image.header;
+    pub_.publish(image, camera_info);
+    ++sequence;
+  }
+
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  RCLCPP_INFO(
+    get_logger(), "Benchmark published %zu frames in %.3f s (%.1f Hz), %zu late",
+    static_cast<size_t>(sequence), elapsed,
+    elapsed > 0.0 ? sequence / elapsed : 0.0, late);
+}
+
 }  // namespace image_publisher
 
 #include "rclcpp_components/register_node_macro.hpp"
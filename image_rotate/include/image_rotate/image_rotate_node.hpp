@@ -33,18 +33,25 @@
 #ifndef IMAGE_ROTATE__IMAGE_ROTATE_NODE_HPP_
 #define IMAGE_ROTATE__IMAGE_ROTATE_NODE_HPP_
 
+#include <map>
 #include <memory>
 #include <string>
 
+#include "diagnostic_updater/diagnostic_updater.hpp"
 #include "tf2_ros/buffer.h"
 #include "tf2_ros/transform_listener.h"
 #include "tf2_ros/transform_broadcaster.h"
 
+#include <opencv2/core/mat.hpp>
+
 #include <geometry_msgs/msg/vector3_stamped.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/processing_diagnostics.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
 #include <sensor_msgs/msg/image.hpp>
+#include <tf2_msgs/msg/tf_message.hpp>
 
 #include "image_rotate/visibility.h"
 
@@ -66,6 +73,8 @@ struct ImageRotateConfig
   bool use_camera_info;
   double max_angular_rate;
   double output_image_size;
+  double angle_tolerance;
+  bool cache_static_transforms;
 };
 
 class ImageRotateNode : public rclcpp::Node
@@ -82,6 +91,22 @@ private:
   void do_work(
     const sensor_msgs::msg::Image::ConstSharedPtr & msg,
     const std::string input_frame_from_msg);
+  // A vector transformed into the input frame through static transforms
+  struct CachedVector
+  {
+    bool valid = false;
+    std::string frame_id;
+    std::string input_frame_id;
+    geometry_msgs::msg::Vector3 vector;
+  };
+  bool isStatic(const std::string & frame_id, const std::string & other_frame_id) const;
+  bool transformVector(
+    const geometry_msgs::msg::Vector3Stamped & vector, const std::string & input_frame_id,
+    const tf2::TimePoint & time, CachedVector & cache,
+    geometry_msgs::msg::Vector3Stamped & transformed);
+  void tfStaticCallback(const tf2_msgs::msg::TFMessage::ConstSharedPtr & msg);
+  void tfDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status);
+  void rotateImage(const cv::Mat & in_image, int out_size, cv::Mat & out_image);
   void onInit();
 
   rclcpp::Node::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_callback_handle_;
@@ -99,9 +124,34 @@ private:
   geometry_msgs::msg::Vector3Stamped target_vector_;
   geometry_msgs::msg::Vector3Stamped source_vector_;
 
+  // Parents of the frames published on /tf_static
+  rclcpp::Subscription<tf2_msgs::msg::TFMessage>::SharedPtr tf_static_sub_;
+  std::map<std::string, std::string> static_parents_;
+  CachedVector target_cache_, source_cache_;
+
+  // Latency, age and rate of the rotated images, through diagnostics_
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+
+  // Time spent looking up transforms, since the last diagnostics
+  std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
+  size_t lookup_frames_, cached_frames_;
+  double lookup_ms_sum_, lookup_ms_max_;
+
   int subscriber_count_;
   double angle_;
   tf2::TimePoint prev_stamp_;
+
+  // Remap tables of the warps done so far, by angle, for images of
+  // maps_image_size_ rotated into a square of maps_out_size_
+  struct RotationMaps
+  {
+    cv::Mat map1, map2;
+  };
+  std::map<double, RotationMaps> rotation_maps_;
+  cv::Size maps_image_size_;
+  int maps_out_size_;
+  cv::Mat rotated_;  // input turned by quarter turns, before centering
 };
 }  // namespace image_rotate
 
@@ -41,9 +41,12 @@
 
 #include "image_rotate/image_rotate_node.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <functional>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -51,6 +54,7 @@
 #include "tf2/LinearMath/Vector3.h"
 #include "tf2/LinearMath/Quaternion.h"
 #include "tf2_ros/buffer.h"
+#include "tf2_ros/qos.hpp"
 #include "tf2_ros/transform_listener.h"
 #include "tf2_ros/transform_broadcaster.h"
 
@@ -60,11 +64,13 @@
 
 #include <geometry_msgs/msg/transform_stamped.hpp>
 #include <geometry_msgs/msg/vector3_stamped.hpp>
+#include <image_proc/latest_only.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <rcl_interfaces/msg/set_parameters_result.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace image_rotate
 {
@@ -99,6 +105,10 @@ ImageRotateNode::ImageRotateNode(const rclcpp::NodeOptions & options)
         }
       }
 
+      // The vectors change, so do their transformed values
+      target_cache_.valid = false;
+      source_cache_.valid = false;
+
       target_vector_.vector.x = config_.target_x;
       target_vector_.vector.y = config_.target_y;
       target_vector_.vector.z = config_.target_z;
@@ -127,6 +137,8 @@ ImageRotateNode::ImageRotateNode(const rclcpp::NodeOptions & options)
   config_.use_camera_info = this->declare_parameter("use_camera_info", true);
   config_.max_angular_rate = this->declare_parameter("max_angular_rate", 10.0);
   config_.output_image_size = this->declare_parameter("output_image_size", 2.0);
+  config_.angle_tolerance = this->declare_parameter("angle_tolerance", 0.0);
+  config_.cache_static_transforms = this->declare_parameter("cache_static_transforms", true);
 
   // TransportHints does not actually declare the parameter
   this->declare_parameter<std::string>("image_transport", "raw");
@@ -160,6 +172,16 @@ void ImageRotateNode::do_work(
   const sensor_msgs::msg::Image::ConstSharedPtr & msg,
   const std::string input_frame_from_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "image_rotate/image_rotate", msg.get(), msg->width, msg->height,
+    msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(msg->header.stamp, frame)) {
+    return;
+  }
+
+  const auto lookup_start = std::chrono::steady_clock::now();
   try {
     std::string input_frame_id = frameWithDefault(config_.input_frame_id, input_frame_from_msg);
     std::string target_frame_id = frameWithDefault(config_.target_frame_id, input_frame_from_msg);
@@ -170,18 +192,18 @@ void ImageRotateNode::do_work(
     target_vector_.header.frame_id = target_frame_id;
     geometry_msgs::msg::Vector3Stamped target_vector_transformed;
     tf2::TimePoint tf2_time = tf2_ros::fromMsg(msg->header.stamp);
-
-    geometry_msgs::msg::TransformStamped transform = tf_buffer_->lookupTransform(
-      target_frame_id, input_frame_id, tf2_time, tf2_time - prev_stamp_);
-    tf2::doTransform(target_vector_, target_vector_transformed, transform);
+    bool cached = transformVector(
+      target_vector_, input_frame_id, tf2_time, target_cache_, target_vector_transformed);
 
     // Transform the source vector into the image frame.
     source_vector_.header.stamp = msg->header.stamp;
     source_vector_.header.frame_id = source_frame_id;
     geometry_msgs::msg::Vector3Stamped source_vector_transformed;
-    transform = tf_buffer_->lookupTransform(
-      source_frame_id, input_frame_id, tf2_time, tf2_time - prev_stamp_);
-    tf2::doTransform(source_vector_, source_vector_transformed, transform);
+    cached &= transformVector(
+      source_vector_, input_frame_id, tf2_time, source_cache_, source_vector_transformed);
+    if (cached) {
+      ++cached_frames_;
+    }
 
     // Calculate the angle of the rotation.
     double angle = angle_;
@@ -217,6 +239,11 @@ void ImageRotateNode::do_work(
   } catch (const tf2::TransformException & e) {
     RCLCPP_ERROR(get_logger(), "Transform error: %s", e.what());
   }
+  const double lookup_ms = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - lookup_start).count();
+  ++lookup_frames_;
+  lookup_ms_sum_ += lookup_ms;
+  lookup_ms_max_ = std::max(lookup_ms_max_, lookup_ms);
 
   // Publish the transform.
   geometry_msgs::msg::TransformStamped transform;
@@ -250,22 +277,20 @@ void ImageRotateNode::do_work(
     out_size = candidates[step] + (candidates[step + 1] - candidates[step]) *
       (config_.output_image_size - step);
 
-    // Compute the rotation matrix.
-    cv::Mat rot_matrix = cv::getRotationMatrix2D(
-      cv::Point2f(in_image.cols / 2.0, in_image.rows / 2.0), 180 * angle_ / M_PI, 1);
-    cv::Mat translation = rot_matrix.col(2);
-    rot_matrix.at<double>(0, 2) += (out_size - in_image.cols) / 2.0;
-    rot_matrix.at<double>(1, 2) += (out_size - in_image.rows) / 2.0;
-
     // Do the rotation
     cv::Mat out_image;
-    cv::warpAffine(in_image, out_image, rot_matrix, cv::Size(out_size, out_size));
+    {
+      tracetools_image_pipeline::StageTrace stage(this, "compute", msg.get());
+      rotateImage(in_image, out_size, out_image);
+    }
 
     // Publish the image.
+    tracetools_image_pipeline::StageTrace stage(this, "publish", msg.get());
     sensor_msgs::msg::Image::SharedPtr out_img =
       cv_bridge::CvImage(msg->header, msg->encoding, out_image).toImageMsg();
     out_img->header.frame_id = transform.child_frame_id;
     img_pub_.publish(out_img);
+    frame.published(msg->header.stamp);
   } catch (const cv::Exception & e) {
     RCLCPP_ERROR(
       get_logger(),
@@ -276,16 +301,213 @@ void ImageRotateNode::do_work(
   prev_stamp_ = tf2_ros::fromMsg(msg->header.stamp);
 }
 
+bool ImageRotateNode::isStatic(
+  const std::string & frame_id, const std::string & other_frame_id) const
+{
+  // Walk up the static transforms from one frame, then from the other until
+  // meeting the first path. The walks are bounded, in case of a loop.
+  std::set<std::string> ancestors;
+  std::string frame = frame_id;
+  for (size_t i = 0; i <= static_parents_.size(); ++i) {
+    ancestors.insert(frame);
+    auto parent = static_parents_.find(frame);
+    if (parent == static_parents_.end()) {
+      break;
+    }
+    frame = parent->second;
+  }
+  frame = other_frame_id;
+  for (size_t i = 0; i <= static_parents_.size(); ++i) {
+    if (ancestors.count(frame) > 0) {
+      return true;
+    }
+    auto parent = static_parents_.find(frame);
+    if (parent == static_parents_.end()) {
+      break;
+    }
+    frame = parent->second;
+  }
+  return false;
+}
+
+bool ImageRotateNode::transformVector(
+  const geometry_msgs::msg::Vector3Stamped & vector, const std::string & input_frame_id,
+  const tf2::TimePoint & time, CachedVector & cache,
+  geometry_msgs::msg::Vector3Stamped & transformed)
+{
+  if (cache.valid && cache.frame_id == vector.header.frame_id &&
+    cache.input_frame_id == input_frame_id)
+  {
+    transformed.header.frame_id = vector.header.frame_id;
+    transformed.header.stamp = vector.header.stamp;
+    transformed.vector = cache.vector;
+    return true;
+  }
+
+  // Static transforms are the same at any time, so are looked up once
+  const bool is_static = config_.cache_static_transforms &&
+    isStatic(vector.header.frame_id, input_frame_id);
+  geometry_msgs::msg::TransformStamped transform = is_static ?
+    tf_buffer_->lookupTransform(vector.header.frame_id, input_frame_id, tf2::TimePointZero) :
+    tf_buffer_->lookupTransform(
+    vector.header.frame_id, input_frame_id, time, time - prev_stamp_);
+  tf2::doTransform(vector, transformed, transform);
+
+  if (is_static) {
+    cache.valid = true;
+    cache.frame_id = vector.header.frame_id;
+    cache.input_frame_id = input_frame_id;
+    cache.vector = transformed.vector;
+  }
+  return false;
+}
+
+void ImageRotateNode::tfStaticCallback(const tf2_msgs::msg::TFMessage::ConstSharedPtr & msg)
+{
+  // The listener may not have seen these yet, so they are given to the
+  // buffer here too, before the next lookup
+  for (const auto & transform : msg->transforms) {
+    static_parents_[transform.child_frame_id] = transform.header.frame_id;
+    tf_buffer_->setTransform(transform, "image_rotate", true);
+  }
+  target_cache_.valid = false;
+  source_cache_.valid = false;
+}
+
+void ImageRotateNode::tfDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status)
+{
+  status.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "OK");
+  status.add("Frames", lookup_frames_);
+  status.add("Frames with cached static transforms", cached_frames_);
+  status.add(
+    "Mean lookup time (ms)", lookup_frames_ > 0 ? lookup_ms_sum_ / lookup_frames_ : 0.0);
+  status.add("Max lookup time (ms)", lookup_ms_max_);
+  lookup_frames_ = 0;
+  cached_frames_ = 0;
+  lookup_ms_sum_ = 0;
+  lookup_ms_max_ = 0;
+}
+
+namespace
+{
+
+// Copies image to the center of a square canvas of out_size, cropping it
+// where it is larger and filling the rest with zeros.
+void centerOnCanvas(const cv::Mat & image, int out_size, cv::Mat & out_image)
+{
+  out_image.create(out_size, out_size, image.type());
+  const int dx = (out_size - image.cols) / 2;
+  const int dy = (out_size - image.rows) / 2;
+  const cv::Rect dst(
+    std::max(dx, 0), std::max(dy, 0),
+    std::min(image.cols, out_size), std::min(image.rows, out_size));
+  if (dst.width < out_size || dst.height < out_size) {
+    out_image.setTo(cv::Scalar::all(0));
+  }
+  image(cv::Rect(std::max(-dx, 0), std::max(-dy, 0), dst.width, dst.height))
+  .copyTo(out_image(dst));
+}
+
+}  // namespace
+
+void ImageRotateNode::rotateImage(const cv::Mat & in_image, int out_size, cv::Mat & out_image)
+{
+  // Angles within angle_tolerance of each other do the same warp
+  double angle = angle_;
+  if (config_.angle_tolerance > 0) {
+    angle = std::round(angle / config_.angle_tolerance) * config_.angle_tolerance;
+  }
+
+  // Multiples of 90 degrees only move pixels, without interpolation
+  const double quarter_turns = std::round(angle / M_PI_2);
+  if (std::abs(angle - quarter_turns * M_PI_2) <= std::max(config_.angle_tolerance, 1e-9)) {
+    // Counter-clockwise, as cv::getRotationMatrix2D
+    switch ((static_cast<int>(quarter_turns) % 4 + 4) % 4) {
+      case 0:
+        centerOnCanvas(in_image, out_size, out_image);
+        return;
+      case 1:
+        cv::rotate(in_image, rotated_, cv::ROTATE_90_COUNTERCLOCKWISE);
+        break;
+      case 2:
+        cv::rotate(in_image, rotated_, cv::ROTATE_180);
+        break;
+      default:
+        cv::rotate(in_image, rotated_, cv::ROTATE_90_CLOCKWISE);
+        break;
+    }
+    centerOnCanvas(rotated_, out_size, out_image);
+    return;
+  }
+
+  // Otherwise remap through the tables of the angle, computed once
+  if (in_image.size() != maps_image_size_ || out_size != maps_out_size_) {
+    rotation_maps_.clear();
+    maps_image_size_ = in_image.size();
+    maps_out_size_ = out_size;
+  }
+  auto maps = rotation_maps_.find(angle);
+  if (maps == rotation_maps_.end()) {
+    // Keep the tables of a few angles, for a rotation going back and forth
+    if (rotation_maps_.size() >= 16) {
+      rotation_maps_.clear();
+    }
+
+    // Compute the rotation matrix.
+    cv::Mat rot_matrix = cv::getRotationMatrix2D(
+      cv::Point2f(in_image.cols / 2.0, in_image.rows / 2.0), 180 * angle / M_PI, 1);
+    rot_matrix.at<double>(0, 2) += (out_size - in_image.cols) / 2.0;
+    rot_matrix.at<double>(1, 2) += (out_size - in_image.rows) / 2.0;
+
+    // Map every output pixel back to the input image, as warpAffine does
+    cv::Mat inverse;
+    cv::invertAffineTransform(rot_matrix, inverse);
+    const double * m = inverse.ptr<double>();
+    cv::Mat map_x(out_size, out_size, CV_32FC1), map_y(out_size, out_size, CV_32FC1);
+    for (int y = 0; y < out_size; ++y) {
+      float * map_x_row = map_x.ptr<float>(y);
+      float * map_y_row = map_y.ptr<float>(y);
+      for (int x = 0; x < out_size; ++x) {
+        map_x_row[x] = static_cast<float>(m[0] * x + m[1] * y + m[2]);
+        map_y_row[x] = static_cast<float>(m[3] * x + m[4] * y + m[5]);
+      }
+    }
+
+    // Fixed point tables, the fastest for cv::remap
+    maps = rotation_maps_.emplace(angle, RotationMaps()).first;
+    cv::convertMaps(map_x, map_y, maps->second.map1, maps->second.map2, CV_16SC2);
+  }
+
+  cv::remap(in_image, out_image, maps->second.map1, maps->second.map2, cv::INTER_LINEAR);
+}
+
 void ImageRotateNode::onInit()
 {
   subscriber_count_ = 0;
   angle_ = 0;
+  maps_out_size_ = 0;
   prev_stamp_ = tf2::get_now();
   rclcpp::Clock::SharedPtr clock = this->get_clock();
   tf_buffer_ = std::make_shared<tf2_ros::Buffer>(clock);
   tf_sub_ = std::make_shared<tf2_ros::TransformListener>(*tf_buffer_);
   tf_pub_ = std::make_shared<tf2_ros::TransformBroadcaster>(*this);
 
+  // Learn which transforms are static, and drop the vectors transformed
+  // through them whenever they are published again
+  tf_static_sub_ = this->create_subscription<tf2_msgs::msg::TFMessage>(
+    "/tf_static", tf2_ros::StaticListenerQoS(),
+    std::bind(&ImageRotateNode::tfStaticCallback, this, std::placeholders::_1));
+
+  lookup_frames_ = 0;
+  cached_frames_ = 0;
+  lookup_ms_sum_ = 0;
+  lookup_ms_max_ = 0;
+  diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+  diagnostics_->setHardwareID("none");
+  diagnostics_->add("TF lookup", this, &ImageRotateNode::tfDiagnostics);
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this, *diagnostics_);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+
   // Create publisher with connect callback
   rclcpp::PublisherOptions pub_options;
   pub_options.event_callbacks.matched_callback =
@@ -317,7 +539,7 @@ void ImageRotateNode::onInit()
 
         if (config_.use_camera_info && config_.input_frame_id.empty()) {
           auto custom_qos = rmw_qos_profile_system_default;
-          custom_qos.depth = 3;
+          custom_qos.depth = latest_only_->queueSize(3);
           cam_sub_ = image_transport::create_camera_subscription(
             this,
             topic_name,
@@ -328,7 +550,7 @@ void ImageRotateNode::onInit()
             custom_qos);
         } else {
           auto custom_qos = rmw_qos_profile_system_default;
-          custom_qos.depth = 3;
+          custom_qos.depth = latest_only_->queueSize(3);
           img_sub_ = image_transport::create_subscription(
             this,
             topic_name,
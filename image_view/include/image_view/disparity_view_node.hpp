@@ -37,9 +37,6 @@ public:
   ~DisparityViewNode();
 
 private:
-  // colormap for disparities, RGB order
-  static unsigned char colormap[];
-
   std::string window_name_;
   bool autosize_;
   rclcpp::Subscription<stereo_msgs::msg::DisparityImage>::SharedPtr sub_;
@@ -49,24 +49,31 @@
 #ifndef IMAGE_VIEW__EXTRACT_IMAGES_NODE_HPP_
 #define IMAGE_VIEW__EXTRACT_IMAGES_NODE_HPP_
 
+#include <memory>
 #include <mutex>
 #include <string>
 
 #include <rclcpp/rclcpp.hpp>
 #include <image_transport/image_transport.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
 #include <sensor_msgs/msg/image.hpp>
 
 namespace image_view
 {
 
+class AsyncImageWriter;
+
 class ExtractImagesNode
   : public rclcpp::Node
 {
 public:
   explicit ExtractImagesNode(const rclcpp::NodeOptions & options);
+  ~ExtractImagesNode();
 
 private:
   image_transport::Subscriber sub_;
+  rclcpp::Subscription<sensor_msgs::msg::CompressedImage>::SharedPtr compressed_sub_;
+  std::unique_ptr<AsyncImageWriter> writer_;
 
   sensor_msgs::msg::Image::ConstSharedPtr last_msg_;
   std::mutex image_mutex_;
@@ -77,7 +84,9 @@ private:
   rclcpp::Time _time;
   double sec_per_frame_;
 
+  bool due();
   void image_cb(const sensor_msgs::msg::Image::ConstSharedPtr & msg);
+  void compressed_cb(const sensor_msgs::msg::CompressedImage::ConstSharedPtr & msg);
 };
 
 }  // namespace image_view
@@ -52,6 +52,7 @@
 #include <memory>
 #include <string>
 
+#include <diagnostic_updater/diagnostic_updater.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <image_transport/image_transport.hpp>
 #include <std_srvs/srv/empty.hpp>
@@ -60,14 +61,18 @@
 namespace image_view
 {
 
+class AsyncImageWriter;
+
 class ImageSaverNode
   : public rclcpp::Node
 {
 public:
   explicit ImageSaverNode(const rclcpp::NodeOptions & options);
+  ~ImageSaverNode();
 
 private:
   std::string g_format;
+  std::string format_;
   bool stamped_filename_;
   bool save_all_image_{false};
   bool save_image_service_{false};
@@ -83,8 +88,13 @@ private:
   rclcpp::Service<std_srvs::srv::Empty>::SharedPtr save_srv_;
   rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr start_srv_;
   rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr end_srv_;
+  std::unique_ptr<AsyncImageWriter> writer_;
+  std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
 
-  bool saveImage(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg, std::string & filename);
+  bool saveImage(
+    const sensor_msgs::msg::Image::ConstSharedPtr & image_msg, std::string & filename,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info = nullptr);
+  void writerDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status);
   bool service(
     const std::shared_ptr<rmw_request_id_t> request_header,
     const std::shared_ptr<std_srvs::srv::Empty::Request> request,
@@ -56,6 +56,8 @@ public:
 
 private:
   ThreadSafeImage queued_image_, shown_image_;
+  // Frame shown_image_ was shrunk from with downscale_to_window, saved instead of it
+  ThreadSafeImage shown_source_;
   bool autosize_;
   int window_height_, window_width_;
   bool g_gui;
@@ -64,6 +66,9 @@ private:
   int count_;
   double min_image_value_, max_image_value_;
   int colormap_;
+  double display_rate_;
+  bool downscale_to_window_;
+  bool opengl_;
   rclcpp::TimerBase::SharedPtr gui_timer_;
   std::shared_ptr<rclcpp::Publisher<sensor_msgs::msg::Image>> pub_;
   std::string window_name_;
@@ -71,6 +76,8 @@ private:
   rclcpp::Node::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_callback_handle_;
 
   void imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & msg);
+  cv_bridge::CvImageConstPtr convertForDisplay(
+    cv_bridge::CvImageConstPtr image, const cv::Size & fit = cv::Size());
   static void mouseCb(int event, int x, int y, int flags, void * param);
   void windowThread();
   rcl_interfaces::msg::SetParametersResult paramCallback(const std::vector<rclcpp::Parameter> &);
@@ -15,7 +15,11 @@
 #ifndef IMAGE_VIEW__VIDEO_RECORDER_NODE_HPP_
 #define IMAGE_VIEW__VIDEO_RECORDER_NODE_HPP_
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include <rclcpp/rclcpp.hpp>
 #include <image_transport/image_transport.hpp>
@@ -43,6 +47,7 @@ private:
   rclcpp::Time g_last_wrote_time;
   std::string encoding;
   std::string codec;
+  std::string pipeline;
   double fps;
   double min_depth_range;
   double max_depth_range;
@@ -52,7 +57,17 @@ private:
   bool recording_started;
   std::string filename;
 
+  // Frames waiting for the encoder thread
+  size_t encoder_queue_size;
+  std::thread encoder_thread;
+  std::mutex encoder_mutex;
+  std::condition_variable encoder_condition;
+  std::deque<sensor_msgs::msg::Image::ConstSharedPtr> encoder_queue;
+  bool encoder_stopping;
+
   void callback(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg);
+  void encoderLoop();
+  void encode(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg);
 };
 
 }  // namespace image_view
@@ -0,0 +1,257 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include "async_image_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+
+namespace image_view
+{
+
+AsyncImageWriter::AsyncImageWriter(const Options & options, const rclcpp::Logger & logger)
+: options_(options), logger_(logger)
+{
+  if (!options_.append_file.empty()) {
+    append_stream_.open(options_.append_file, std::ios::binary | std::ios::app);
+    append_index_.open(options_.append_file + ".index", std::ios::app);
+    if (!append_stream_ || !append_index_) {
+      RCLCPP_ERROR(logger_, "Unable to open %s for appending", options_.append_file.c_str());
+    }
+    append_stream_.seekp(0, std::ios::end);
+    append_offset_ = static_cast<size_t>(append_stream_.tellp());
+  }
+  for (size_t i = 0; i < options_.threads; ++i) {
+    workers_.emplace_back(&AsyncImageWriter::work, this);
+  }
+}
+
+AsyncImageWriter::~AsyncImageWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queued_condition_.notify_all();
+  space_condition_.notify_all();
+  for (std::thread & worker : workers_) {
+    worker.join();
+  }
+}
+
+bool AsyncImageWriter::write(
+  const std::string & filename, const cv_bridge::CvImageConstPtr & image,
+  std::function<void()> after)
+{
+  return queue({filename, image, nullptr, std::move(after)});
+}
+
+bool AsyncImageWriter::write(
+  const std::string & filename, const Payload & payload,
+  std::function<void()> after)
+{
+  return queue({filename, nullptr, payload, std::move(after)});
+}
+
+bool AsyncImageWriter::queue(Job job)
+{
+  if (workers_.empty()) {
+    std::vector<uint8_t> buffer;
+    save(job, buffer);
+    return true;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const size_t queue_size = std::max<size_t>(options_.queue_size, 1);
+    if (jobs_.size() >= queue_size) {
+      if (!options_.block_when_full) {
+        ++stats_.dropped;
+        return false;
+      }
+      space_condition_.wait(
+        lock, [this, queue_size] {return stopping_ || jobs_.size() < queue_size;});
+      if (stopping_) {
+        return false;
+      }
+    }
+    jobs_.push_back(std::move(job));
+    stats_.queued = std::max(stats_.queued, jobs_.size());
+  }
+  queued_condition_.notify_one();
+  return true;
+}
+
+AsyncImageWriter::Stats AsyncImageWriter::stats()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  const size_t done = stats.written + stats.failed;
+  if (done > 0) {
+    stats.encode_ms /= done;
+    stats.write_ms /= done;
+  }
+  // Start the next period from the current depth of the queue
+  stats_ = Stats{};
+  stats_.queued = jobs_.size();
+  return stats;
+}
+
+void AsyncImageWriter::work()
+{
+  std::vector<uint8_t> buffer;
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queued_condition_.wait(lock, [this] {return stopping_ || !jobs_.empty();});
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    space_condition_.notify_one();
+    save(job, buffer);
+  }
+}
+
+void AsyncImageWriter::save(Job & job, std::vector<uint8_t> & buffer)
+{
+  using Clock = std::chrono::steady_clock;
+  const size_t dot = job.filename.rfind('.');
+  const std::string extension = dot == std::string::npos ? "" : job.filename.substr(dot);
+
+  // Encode in the format of the extension, as cv::imwrite does. Raw pixels
+  // are written as they are when there is no padding between rows.
+  const Clock::time_point start = Clock::now();
+  const uint8_t * data = nullptr;
+  size_t size = 0;
+  bool ok = false;
+  const bool raw = job.image && extension == ".raw";
+  if (job.payload) {
+    data = job.payload->data();
+    size = job.payload->size();
+    ok = true;
+  } else if (raw) {
+    const cv::Mat & image = job.image->image;
+    const size_t row_size = image.cols * image.elemSize();
+    size = row_size * image.rows;
+    if (image.isContinuous()) {
+      data = image.data;
+    } else {
+      buffer.resize(size);
+      for (int y = 0; y < image.rows; ++y) {
+        std::memcpy(buffer.data() + y * row_size, image.ptr(y), row_size);
+      }
+      data = buffer.data();
+    }
+    ok = true;
+  } else {
+    try {
+      ok = !extension.empty() &&
+        cv::imencode(extension, job.image->image, buffer, options_.encode_params);
+    } catch (const cv::Exception & e) {
+      RCLCPP_ERROR(logger_, "Unable to encode image %s: %s", job.filename.c_str(), e.what());
+    }
+    data = buffer.data();
+    size = buffer.size();
+  }
+  const Clock::time_point encoded = Clock::now();
+  if (ok) {
+    ok = options_.append_file.empty() ?
+      writeFile(job, data, size, raw) : append(job, data, size);
+  }
+  const Clock::time_point written = Clock::now();
+
+  if (ok) {
+    RCLCPP_INFO(logger_, "Saved image %s", job.filename.c_str());
+  } else {
+    RCLCPP_ERROR(logger_, "Failed to save image to path %s", job.filename.c_str());
+  }
+  if (job.after) {
+    job.after();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++(ok ? stats_.written : stats_.failed);
+  stats_.encode_ms += std::chrono::duration<double, std::milli>(encoded - start).count();
+  stats_.write_ms += std::chrono::duration<double, std::milli>(written - encoded).count();
+}
+
+bool AsyncImageWriter::writeFile(
+  const Job & job, const uint8_t * data, size_t size, bool raw)
+{
+  std::ofstream file(job.filename, std::ios::binary);
+  if (!file.write(reinterpret_cast<const char *>(data), size)) {
+    return false;
+  }
+  if (raw) {
+    const cv::Mat & image = job.image->image;
+    std::ofstream header(job.filename + ".yaml");
+    header << "width: " << image.cols << "\n" <<
+      "height: " << image.rows << "\n" <<
+      "encoding: " << job.image->encoding << "\n" <<
+      "step: " << image.cols * image.elemSize() << "\n" <<
+      "stamp: " << job.image->header.stamp.sec << "." <<
+      std::setw(9) << std::setfill('0') << job.image->header.stamp.nanosec << "\n";
+    return header.good();
+  }
+  return true;
+}
+
+bool AsyncImageWriter::append(const Job & job, const uint8_t * data, size_t size)
+{
+  std::lock_guard<std::mutex> lock(append_mutex_);
+  if (!append_stream_.write(reinterpret_cast<const char *>(data), size)) {
+    return false;
+  }
+  append_index_ << append_offset_ << " " << size << " " << job.filename;
+  if (job.image) {
+    append_index_ << " " << job.image->image.cols << " " << job.image->image.rows << " " <<
+      job.image->encoding << " " << job.image->header.stamp.sec << "." <<
+      std::setw(9) << std::setfill('0') << job.image->header.stamp.nanosec;
+  }
+  append_index_ << "\n";
+  append_offset_ += size;
+  return append_index_.good();
+}
+
+}  // namespace image_view
@@ -0,0 +1,147 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef ASYNC_IMAGE_WRITER_HPP_
+#define ASYNC_IMAGE_WRITER_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cv_bridge/cv_bridge.hpp"
+
+#include <rclcpp/rclcpp.hpp>
+
+namespace image_view
+{
+
+// Encodes and writes images to files on a pool of threads, so that slow
+// storage does not block the callbacks producing them. Images wait in a
+// bounded queue, a full queue either drops the new image or blocks. Without
+// threads, images are written by the caller of write().
+//
+// Images are encoded in the format of the extension of their file name with
+// cv::imencode, except for ".raw": the bare pixels, with their size, encoding
+// and stamp in a "<file name>.yaml" sidecar. Already encoded payloads are
+// written as they are.
+class AsyncImageWriter
+{
+public:
+  // Bytes of an encoded image, usually aliasing a field of its message
+  using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct Options
+  {
+    size_t threads = 1;
+    size_t queue_size = 30;
+    bool block_when_full = false;
+    // Encoder parameters, as for cv::imwrite
+    std::vector<int> encode_params;
+    // If not empty, images are appended to this file instead of written to
+    // their own, with a line per image (offset, size, name and, unless it was
+    // a payload, width, height, encoding, stamp) appended to
+    // "<append_file>.index"
+    std::string append_file;
+  };
+
+  // Counters since the previous call to stats()
+  struct Stats
+  {
+    size_t queued;
+    size_t written;
+    size_t failed;
+    size_t dropped;
+    double encode_ms;  // mean time to encode an image
+    double write_ms;  // mean time to write an encoded image
+  };
+
+  AsyncImageWriter(const Options & options, const rclcpp::Logger & logger);
+
+  // Writes the images still queued, then stops the threads
+  ~AsyncImageWriter();
+
+  // Queues image to be written to filename, in the format of its extension,
+  // and after to be run once it is. Returns false if the queue was full and
+  // the image dropped.
+  bool write(
+    const std::string & filename, const cv_bridge::CvImageConstPtr & image,
+    std::function<void()> after = nullptr);
+
+  // Queues already encoded bytes to be written to filename as they are
+  bool write(
+    const std::string & filename, const Payload & payload,
+    std::function<void()> after = nullptr);
+
+  Stats stats();
+
+private:
+  struct Job
+  {
+    std::string filename;
+    cv_bridge::CvImageConstPtr image;  // null for payloads
+    Payload payload;
+    std::function<void()> after;
+  };
+
+  bool queue(Job job);
+  void work();
+  void save(Job & job, std::vector<uint8_t> & buffer);
+  bool writeFile(const Job & job, const uint8_t * data, size_t size, bool raw);
+  bool append(const Job & job, const uint8_t * data, size_t size);
+
+  const Options options_;
+  rclcpp::Logger logger_;
+
+  std::mutex append_mutex_;
+  std::ofstream append_stream_, append_index_;
+  size_t append_offset_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable queued_condition_, space_condition_;
+  std::deque<Job> jobs_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+
+  // Guarded by mutex_
+  Stats stats_{};
+};
+
+}  // namespace image_view
+
+#endif  // ASYNC_IMAGE_WRITER_HPP_
@@ -46,7 +46,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -55,11 +57,13 @@
 #include <opencv2/highgui/highgui.hpp>
 
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/conversion_cache.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 #include <sensor_msgs/msg/image.hpp>
 
 #include "image_view/extract_images_node.hpp"
+#include "async_image_writer.hpp"
 #include "utils.hpp"
 
 namespace image_view
@@ -79,10 +83,19 @@ ExtractImagesNode::ExtractImagesNode(const rclcpp::NodeOptions & options)
   image_transport::TransportHints hints(this);
   std::string transport = this->get_parameter("transport").as_string();
 
-  sub_ = image_transport::create_subscription(
-    this, topic, std::bind(
-      &ExtractImagesNode::image_cb, this, std::placeholders::_1),
-    hints.getTransport());
+  // Write JPEG and PNG payloads of the compressed transport as they are,
+  // instead of decoding and encoding them again
+  bool write_compressed = this->declare_parameter("write_compressed", false);
+  if (write_compressed && hints.getTransport() == "compressed") {
+    compressed_sub_ = this->create_subscription<sensor_msgs::msg::CompressedImage>(
+      topic + "/compressed", rclcpp::QoS(10),
+      std::bind(&ExtractImagesNode::compressed_cb, this, std::placeholders::_1));
+  } else {
+    sub_ = image_transport::create_subscription(
+      this, topic, std::bind(
+        &ExtractImagesNode::image_cb, this, std::placeholders::_1),
+      hints.getTransport());
+  }
 
   auto topics = this->get_topic_names_and_types();
 
@@ -99,9 +112,34 @@ ExtractImagesNode::ExtractImagesNode(const rclcpp::NodeOptions & options)
   this->declare_parameter<double>("sec_per_frame", 0.1);
   sec_per_frame_ = this->get_parameter("sec_per_frame").as_double();
 
+  // Frames are numbered as they arrive, and encoded and written by
+  // writer_threads threads, or in the callback if 0
+  AsyncImageWriter::Options writer_options;
+  writer_options.threads = std::max<int>(this->declare_parameter("writer_threads", 0), 0);
+  writer_options.queue_size = std::max<int>(this->declare_parameter("writer_queue_size", 30), 1);
+  writer_options.block_when_full = this->declare_parameter("writer_block_when_full", true);
+  writer_ = std::make_unique<AsyncImageWriter>(writer_options, this->get_logger());
+
   RCLCPP_INFO(this->get_logger(), "Initialized sec per frame to %f", sec_per_frame_);
 }
 
+ExtractImagesNode::~ExtractImagesNode()
+{
+  // Write the frames still queued before the node goes away
+  writer_.reset();
+}
+
+bool ExtractImagesNode::due()
+{
+  rclcpp::Duration delay = this->now() - _time;
+
+  if (delay.seconds() < sec_per_frame_) {
+    return false;
+  }
+  _time = this->now();
+  return true;
+}
+
 void ExtractImagesNode::image_cb(const sensor_msgs::msg::Image::ConstSharedPtr & msg)
 {
   std::lock_guard<std::mutex> guard(image_mutex_);
@@ -115,29 +153,68 @@ void ExtractImagesNode::image_cb(const sensor_msgs::msg::Image::ConstSharedPtr &
     std::const_pointer_cast<sensor_msgs::msg::Image>(msg)->encoding = "mono8";
   }
 
-  cv::Mat image;
+  if (!due()) {
+    return;
+  }
+
+  cv_bridge::CvImageConstPtr image;
   try {
-    image = cv_bridge::toCvShare(msg, "bgr8")->image;
+    image = image_proc::ConversionCache::instance().toCvShare(msg, "bgr8");
   } catch (const cv_bridge::Exception &) {
     RCLCPP_ERROR(this->get_logger(), "Unable to convert %s image to bgr8", msg->encoding.c_str());
+    return;
   }
 
-  rclcpp::Duration delay = this->now() - _time;
+  if (!image->image.empty()) {
+    std::string filename = string_format(filename_format_, count_);
 
-  if (delay.seconds() >= sec_per_frame_) {
-    _time = this->now();
+    if (writer_->write(filename, image)) {
+      count_++;
+    }
+  } else {
+    RCLCPP_WARN(this->get_logger(), "Couldn't save image, no data!");
+  }
+}
 
-    if (!image.empty()) {
-      std::string filename = string_format(filename_format_, count_);
+void ExtractImagesNode::compressed_cb(
+  const sensor_msgs::msg::CompressedImage::ConstSharedPtr & msg)
+{
+  std::lock_guard<std::mutex> guard(image_mutex_);
 
-      cv::imwrite(filename, image);
+  if (!due()) {
+    return;
+  }
 
-      RCLCPP_INFO(this->get_logger(), "Saved image %s", filename.c_str());
-      count_++;
-    } else {
-      RCLCPP_WARN(this->get_logger(), "Couldn't save image, no data!");
+  // The format is "jpeg" or "png", or "<encoding>; jpeg compressed <encoding>"
+  // and alike. Depth payloads start with a header and can't be written as is.
+  std::string extension;
+  if (msg->format.find("compressedDepth") == std::string::npos) {
+    if (msg->format.find("png") != std::string::npos) {
+      extension = ".png";
+    } else if (msg->format.find("jpeg") != std::string::npos ||  // NOLINT
+      msg->format.find("jpg") != std::string::npos)
+    {
+      extension = ".jpg";
     }
   }
+  if (extension.empty()) {
+    RCLCPP_ERROR(
+      this->get_logger(), "Unable to write %s compressed image as is", msg->format.c_str());
+    return;
+  }
+  if (msg->data.empty()) {
+    RCLCPP_WARN(this->get_logger(), "Couldn't save image, no data!");
+    return;
+  }
+
+  // Keep the extension in the file name in line with the payload
+  std::string filename = string_format(filename_format_, count_);
+  const size_t dot = filename.rfind('.');
+  filename = filename.substr(0, dot == std::string::npos ? filename.size() : dot) + extension;
+
+  if (writer_->write(filename, AsyncImageWriter::Payload(msg, &msg->data))) {
+    count_++;
+  }
 }
 
 }  // namespace image_view
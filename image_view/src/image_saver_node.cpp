@@ -47,6 +47,8 @@
 // limitations under the License.
 
 #include <chrono>
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -54,11 +56,14 @@
 #include "cv_bridge/cv_bridge.hpp"
 
 #include "image_view/image_saver_node.hpp"
+#include "async_image_writer.hpp"
 
 #include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgcodecs.hpp>
 
 #include <rclcpp/rclcpp.hpp>
 #include <camera_calibration_parsers/parse.hpp>
+#include <image_proc/conversion_cache.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 #include <std_srvs/srv/empty.hpp>
@@ -99,6 +104,31 @@ ImageSaverNode::ImageSaverNode(const rclcpp::NodeOptions & options)
   stamped_filename_ = this->declare_parameter("stamped_filename", false);
   request_start_end_ = this->declare_parameter("request_start_end", false);
 
+  // Format filling the %s of filename_format, and the settings of its encoder
+  format_ = this->declare_parameter("format", std::string("jpg"));
+  int jpeg_quality = this->declare_parameter("jpeg_quality", 95);
+  bool jpeg_optimize = this->declare_parameter("jpeg_optimize", false);
+  int png_compression = this->declare_parameter("png_compression", -1);
+
+  AsyncImageWriter::Options writer_options;
+  writer_options.encode_params = {
+    cv::IMWRITE_JPEG_QUALITY, jpeg_quality,
+    cv::IMWRITE_JPEG_OPTIMIZE, jpeg_optimize ? 1 : 0};
+  if (png_compression >= 0) {
+    writer_options.encode_params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+    writer_options.encode_params.push_back(png_compression);
+  }
+  writer_options.append_file = this->declare_parameter("append_file", std::string(""));
+
+  // Encode and write on other threads, unless writer_threads is 0
+  writer_options.threads = std::max<int>(this->declare_parameter("writer_threads", 1), 0);
+  writer_options.queue_size = std::max<int>(this->declare_parameter("writer_queue_size", 30), 1);
+  writer_options.block_when_full = this->declare_parameter("writer_block_when_full", false);
+  writer_ = std::make_unique<AsyncImageWriter>(writer_options, this->get_logger());
+  diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+  diagnostics_->setHardwareID("none");
+  diagnostics_->add("Image writer", this, &ImageSaverNode::writerDiagnostics);
+
   save_srv_ = this->create_service<std_srvs::srv::Empty>(
     "save",
     std::bind(
@@ -120,12 +150,20 @@ ImageSaverNode::ImageSaverNode(const rclcpp::NodeOptions & options)
   }
 }
 
+ImageSaverNode::~ImageSaverNode()
+{
+  // Write the images still queued before the node goes away
+  writer_.reset();
+}
+
 bool ImageSaverNode::saveImage(
-  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg, std::string & filename)
+  const sensor_msgs::msg::Image::ConstSharedPtr & image_msg, std::string & filename,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & info)
 {
-  cv::Mat image;
+  cv_bridge::CvImageConstPtr cv_image;
   try {
-    image = cv_bridge::toCvShare(image_msg, encoding_)->image;
+    // Converted once per frame for all the nodes of the process
+    cv_image = image_proc::ConversionCache::instance().toCvShare(image_msg, encoding_);
   } catch (const cv_bridge::Exception &) {
     RCLCPP_ERROR(
       this->get_logger(), "Unable to convert %s image to %s",
@@ -133,8 +171,8 @@ bool ImageSaverNode::saveImage(
     return false;
   }
 
-  if (!image.empty()) {
-    filename = string_format(g_format, count_, "jpg");
+  if (!cv_image->image.empty()) {
+    filename = string_format(g_format, count_, format_.c_str());
 
     if (save_all_image_ || save_image_service_) {
       if (stamped_filename_) {
@@ -144,10 +182,21 @@ bool ImageSaverNode::saveImage(
         filename.insert(0, timestamp_str);
       }
 
-      if (cv::imwrite(filename, image)) {
-        RCLCPP_INFO(this->get_logger(), "Saved image %s", filename.c_str());
-      } else {
-        RCLCPP_ERROR(this->get_logger(), "Failed to save image to path %s", filename.c_str());
+      // The CameraInfo is saved next to the image, once it is written
+      std::function<void()> save_info;
+      if (info) {
+        std::string info_filename = filename;
+        info_filename.replace(info_filename.rfind("."), info_filename.length(), ".ini");
+        save_info = [info_filename, info]() {
+            camera_calibration_parsers::writeCalibration(info_filename, "camera", *info);
+          };
+      }
+
+      if (!writer_->write(filename, cv_image, save_info)) {
+        RCLCPP_WARN_THROTTLE(
+          this->get_logger(), *this->get_clock(), 1000,
+          "Image writer queue is full, dropping image %s", filename.c_str());
+        return false;
       }
 
       save_image_service_ = false;
@@ -256,21 +305,33 @@ void ImageSaverNode::callbackWithCameraInfo(
     }
   }
 
-  // save the image
+  // save the image and the CameraInfo
   std::string filename;
-  if (!saveImage(image_msg, filename)) {
+  if (!saveImage(image_msg, filename, info)) {
     return;
   }
 
-  // save the CameraInfo
-  if (info) {
-    filename = filename.replace(filename.rfind("."), filename.length(), ".ini");
-    camera_calibration_parsers::writeCalibration(filename, "camera", *info);
-  }
-
   count_++;
 }
 
+void ImageSaverNode::writerDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status)
+{
+  AsyncImageWriter::Stats stats = writer_->stats();
+  if (stats.dropped > 0 || stats.failed > 0) {
+    status.summary(
+      diagnostic_msgs::msg::DiagnosticStatus::WARN,
+      stats.dropped > 0 ? "Dropping images" : "Failed to save images");
+  } else {
+    status.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "OK");
+  }
+  status.add("Max queue depth", stats.queued);
+  status.add("Images written", stats.written);
+  status.add("Images failed", stats.failed);
+  status.add("Images dropped", stats.dropped);
+  status.add("Mean encode time (ms)", stats.encode_ms);
+  status.add("Mean write time (ms)", stats.write_ms);
+}
+
 }  // namespace image_view
 
 RCLCPP_COMPONENTS_REGISTER_NODE(image_view::ImageSaverNode)
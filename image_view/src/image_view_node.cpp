@@ -46,6 +46,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <mutex>
@@ -59,6 +60,7 @@
 #include "image_view/image_view_node.hpp"
 
 #include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc.hpp>
 
 #include <rclcpp/rclcpp.hpp>
 #include <image_transport/image_transport.hpp>
@@ -93,7 +95,7 @@ cv_bridge::CvImageConstPtr ThreadSafeImage::pop()
     condition_.wait_for(
       lock, std::chrono::milliseconds(100),
       [this] {
-        return !image_;
+        return static_cast<bool>(image_);
       });
 
     image = std::move(image_);
@@ -167,6 +169,12 @@ ImageViewNode::ImageViewNode(const rclcpp::NodeOptions & options)
   max_image_value_ = this->declare_parameter(
     max_image_value_paramDescriptor.name, 0, max_image_value_paramDescriptor);
 
+  // Convert in the window thread only the frames being shown, at most
+  // display_rate times per second, if set
+  display_rate_ = this->declare_parameter("display_rate", 0.0);
+  downscale_to_window_ = this->declare_parameter("downscale_to_window", false);
+  opengl_ = this->declare_parameter("opengl", false);
+
   if (g_gui) {
     window_thread_ = std::thread(&ImageViewNode::windowThread, this);
   }
@@ -183,52 +191,78 @@ ImageViewNode::~ImageViewNode()
 }
 
 void ImageViewNode::imageCb(const sensor_msgs::msg::Image::ConstSharedPtr & msg)
+{
+  if (display_rate_ > 0.0 || downscale_to_window_) {
+    // Only the latest frame is converted, by the window thread, which knows
+    // the size of the window
+    queued_image_.set(cv_bridge::toCvShare(msg));
+  } else {
+    try {
+      queued_image_.set(convertForDisplay(cv_bridge::toCvShare(msg)));
+    } catch (cv_bridge::Exception & e) {
+      RCLCPP_ERROR_EXPRESSION(
+        this->get_logger(), (static_cast<int>(this->now().seconds()) % 30 == 0),
+        "Unable to convert '%s' image for display: '%s'",
+        msg->encoding.c_str(), e.what());
+    }
+  }
+
+  if (pub_->get_subscription_count() > 0) {
+    pub_->publish(*msg);
+  }
+}
+
+cv_bridge::CvImageConstPtr ImageViewNode::convertForDisplay(
+  cv_bridge::CvImageConstPtr image, const cv::Size & fit)
 {
   // We want to scale floating point images so that they display nicely
-  bool do_dynamic_scaling = (msg->encoding.find("F") != std::string::npos);
+  bool do_dynamic_scaling = (image->encoding.find("F") != std::string::npos);
 
   // Convert to OpenCV native BGR color
-  try {
-    cv_bridge::CvtColorForDisplayOptions options;
-    options.do_dynamic_scaling = do_dynamic_scaling;
+  cv_bridge::CvtColorForDisplayOptions options;
+  options.do_dynamic_scaling = do_dynamic_scaling;
 
-    {
-      std::lock_guard<std::mutex> lock(param_mutex_);
-      options.colormap = colormap_;
-
-      // Set min/max value for scaling to visualize depth/float image.
-      if (min_image_value_ == max_image_value_) {
-        // Not specified by rosparam, then set default value.
-        // Because of current sensor limitation, we use 10m as default of max range of depth
-        // with consistency to the configuration in rqt_image_view.
-        options.min_image_value = 0;
-
-        if (msg->encoding == "32FC1") {
-          options.max_image_value = 10;  // 10 [m]
-        } else if (msg->encoding == "16UC1") {
-          options.max_image_value = 10 * 1000;  // 10 * 1000 [mm]
-        }
-      } else {
-        options.min_image_value = min_image_value_;
-        options.max_image_value = max_image_value_;
+  {
+    std::lock_guard<std::mutex> lock(param_mutex_);
+    options.colormap = colormap_;
+
+    // Set min/max value for scaling to visualize depth/float image.
+    if (min_image_value_ == max_image_value_) {
+      // Not specified by rosparam, then set default value.
+      // Because of current sensor limitation, we use 10m as default of max range of depth
+      // with consistency to the configuration in rqt_image_view.
+      options.min_image_value = 0;
+
+      if (image->encoding == "32FC1") {
+        options.max_image_value = 10;  // 10 [m]
+      } else if (image->encoding == "16UC1") {
+        options.max_image_value = 10 * 1000;  // 10 * 1000 [mm]
       }
+    } else {
+      options.min_image_value = min_image_value_;
+      options.max_image_value = max_image_value_;
     }
-
-    std::string encoding = msg->encoding.empty() ? "bgr8" : msg->encoding;
-
-    queued_image_.set(
-      cv_bridge::cvtColorForDisplay(
-        cv_bridge::toCvShare(msg), encoding, options));
-  } catch (cv_bridge::Exception & e) {
-    RCLCPP_ERROR_EXPRESSION(
-      this->get_logger(), (static_cast<int>(this->now().seconds()) % 30 == 0),
-      "Unable to convert '%s' image for display: '%s'",
-      msg->encoding.c_str(), e.what());
   }
 
-  if (pub_->get_subscription_count() > 0) {
-    pub_->publish(*msg);
+  // Shrink the image to the window before the conversion. Depth and float
+  // images take the nearest pixel, not to average invalid readings in, and
+  // Bayer images are left alone, not to mix up their pattern.
+  const cv::Mat & mat = image->image;
+  if (fit.area() > 0 && (mat.cols > fit.width || mat.rows > fit.height) &&
+    image->encoding.find("bayer") == std::string::npos)
+  {
+    const double scale = std::min(
+      static_cast<double>(fit.width) / mat.cols, static_cast<double>(fit.height) / mat.rows);
+    auto small = std::make_shared<cv_bridge::CvImage>(image->header, image->encoding);
+    cv::resize(
+      mat, small->image, cv::Size(), scale, scale,
+      mat.depth() == CV_8U ? cv::INTER_AREA : cv::INTER_NEAREST);
+    image = small;
   }
+
+  std::string encoding = image->encoding.empty() ? "bgr8" : image->encoding;
+
+  return cv_bridge::cvtColorForDisplay(image, encoding, options);
 }
 
 void ImageViewNode::mouseCb(int event, int /* x */, int /* y */, int /* flags */, void * param)
@@ -253,6 +287,19 @@ void ImageViewNode::mouseCb(int event, int /* x */, int /* y */, int /* flags */
     return;
   }
 
+  // Save the frame at its full resolution, not shrunk to the window
+  cv_bridge::CvImageConstPtr source(this_->shown_source_.get());
+  if (source) {
+    try {
+      image = this_->convertForDisplay(source);
+    } catch (cv_bridge::Exception & e) {
+      RCLCPP_ERROR(
+        this_->get_logger(), "Unable to convert '%s' image for saving: '%s'",
+        source->encoding.c_str(), e.what());
+      return;
+    }
+  }
+
   std::string filename = string_format(this_->filename_format_, this_->count_);
 
   if (cv::imwrite(filename, image->image)) {
@@ -268,13 +315,27 @@ void ImageViewNode::windowThread()
 {
   int flags = autosize_ ?
     (cv::WINDOW_AUTOSIZE | cv::WINDOW_KEEPRATIO | cv::WINDOW_GUI_EXPANDED) : 0;
-  cv::namedWindow(window_name_, flags);
+  if (opengl_) {
+    // Draw the frames as textures, if OpenCV was built with OpenGL
+    try {
+      cv::namedWindow(window_name_, flags | cv::WINDOW_OPENGL);
+    } catch (const cv::Exception & e) {
+      RCLCPP_WARN(this->get_logger(), "Unable to create an OpenGL window: %s", e.what());
+      cv::namedWindow(window_name_, flags);
+    }
+  } else {
+    cv::namedWindow(window_name_, flags);
+  }
   cv::setMouseCallback(window_name_, &ImageViewNode::mouseCb, this);
 
   if (!autosize_ && window_width_ > -1 && window_height_ > -1) {
     cv::resizeWindow(window_name_, window_width_, window_height_);
   }
 
+  const auto display_period = std::chrono::duration<double>(
+    display_rate_ > 0.0 ? 1.0 / display_rate_ : 0.0);
+  auto next_display = std::chrono::steady_clock::now();
+
   while (rclcpp::ok()) {
     cv_bridge::CvImageConstPtr image(queued_image_.pop());
 
@@ -282,10 +343,43 @@ void ImageViewNode::windowThread()
       break;
     }
 
+    // The frame image was shrunk from, if it was
+    cv_bridge::CvImageConstPtr source;
+    if (image && (display_rate_ > 0.0 || downscale_to_window_)) {
+      cv::Size fit;
+      if (downscale_to_window_) {
+        fit = cv::getWindowImageRect(window_name_).size();
+      }
+      try {
+        cv_bridge::CvImageConstPtr converted = convertForDisplay(image, fit);
+        if (converted->image.size() != image->image.size()) {
+          source = image;
+        }
+        image = converted;
+      } catch (cv_bridge::Exception & e) {
+        RCLCPP_ERROR_EXPRESSION(
+          this->get_logger(), (static_cast<int>(this->now().seconds()) % 30 == 0),
+          "Unable to convert '%s' image for display: '%s'",
+          image->encoding.c_str(), e.what());
+        image.reset();
+      }
+    }
+
     if (image) {
       cv::imshow(window_name_, image->image);
       shown_image_.set(image);
-      cv::waitKey(1);
+      shown_source_.set(source);
+
+      // Handle the window events until the next frame is due
+      next_display += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        display_period);
+      const auto now = std::chrono::steady_clock::now();
+      if (next_display < now) {
+        next_display = now;
+      }
+      cv::waitKey(
+        std::max<int>(
+          1, std::chrono::duration_cast<std::chrono::milliseconds>(next_display - now).count()));
     }
   }
 
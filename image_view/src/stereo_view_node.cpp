@@ -48,9 +48,11 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 
 #include "cv_bridge/cv_bridge.hpp"
 #include "message_filters/subscriber.hpp"
@@ -59,10 +61,12 @@
 #include "message_filters/synchronizer.hpp"
 
 #include "image_view/stereo_view_node.hpp"
+#include "disparity_colormap.hpp"
 
 #include <opencv2/highgui/highgui.hpp>
 
 #include <rclcpp/rclcpp.hpp>
+#include <image_proc/conversion_cache.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 #include <sensor_msgs/image_encodings.hpp>
@@ -84,8 +88,6 @@ using std::placeholders::_1;
 using std::placeholders::_2;
 using std::placeholders::_3;
 
-constexpr unsigned char StereoViewNode::colormap[768];
-
 StereoViewNode::StereoViewNode(const rclcpp::NodeOptions & options)
 : rclcpp::Node("stereo_view_node", options),
   filename_format_(""), save_count_(0),
@@ -151,8 +153,16 @@ StereoViewNode::StereoViewNode(const rclcpp::NodeOptions & options)
   // Synchronize input topics. Optionally do approximate synchronization.
   queue_size_ = this->declare_parameter("queue_size", 5);
   bool approx = this->declare_parameter("approximate_sync", false);
-
-  if (approx) {
+  bool hardware_sync = this->declare_parameter("hardware_sync", false);
+
+  if (hardware_sync) {
+    stamp_sync_ = std::make_unique<StampSync>(queue_size_);
+    stamp_sync_->connectInput(left_sub_, right_sub_, disparity_sub_);
+    stamp_sync_->registerCallback(std::bind(&StereoViewNode::imageCb, this, _1, _2, _3));
+    diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+    diagnostics_->setHardwareID("none");
+    stamp_sync_->publishDiagnostics(*diagnostics_);
+  } else if (approx) {
     approximate_sync_.reset(
       new ApproximateSync(
         ApproximatePolicy(queue_size_), left_sub_, right_sub_, disparity_sub_));
@@ -195,8 +205,6 @@ void StereoViewNode::imageCb(
 {
   ++all_received_;  // For error checking
 
-  image_mutex_.lock();
-
   // May want to view raw bayer data
   if (left->encoding.find("bayer") != std::string::npos) {
     std::const_pointer_cast<Image>(left)->encoding = "mono8";
@@ -206,13 +214,12 @@ void StereoViewNode::imageCb(
     std::const_pointer_cast<Image>(right)->encoding = "mono8";
   }
 
-  // Hang on to image data for sake of mouseCb
-  last_left_msg_ = left;
-  last_right_msg_ = right;
-
+  // Convert without the mutex, which only guards the images saved by mouseCb
+  cv::Mat left_image, right_image;
   try {
-    last_left_image_ = cv_bridge::toCvShare(left, "bgr8")->image;
-    last_right_image_ = cv_bridge::toCvShare(right, "bgr8")->image;
+    auto & conversions = image_proc::ConversionCache::instance();
+    left_image = conversions.toCvShare(left, "bgr8")->image;
+    right_image = conversions.toCvShare(right, "bgr8")->image;
   } catch (cv_bridge::Exception & e) {
     RCLCPP_ERROR(
       this->get_logger(), "Unable to convert one of '%s' or '%s' to 'bgr8'",
@@ -224,31 +231,32 @@ void StereoViewNode::imageCb(
   float max_disparity = disparity_msg->max_disparity;
   float multiplier = 255.0f / (max_disparity - min_disparity);
 
-  assert(disparity_msg->image.encoding == enc::TYPE_32FC1);
-  const cv::Mat_<float> dmat(
-    disparity_msg->image.height,
-    disparity_msg->image.width,
-    const_cast<float *>(reinterpret_cast<const float *>(&disparity_msg->image.data[0])),
-    disparity_msg->image.step);
-  disparity_color_.create(disparity_msg->image.height, disparity_msg->image.width);
-
-  for (int row = 0; row < disparity_color_.rows; ++row) {
-    const float * d = dmat[row];
-
-    for (int col = 0; col < disparity_color_.cols; ++col) {
-      int index = (d[col] - min_disparity) * multiplier + 0.5;
-      index = std::min(255, std::max(0, index));
-      // Fill as BGR
-      disparity_color_(row, col)[2] = colormap[3 * index + 0];
-      disparity_color_(row, col)[1] = colormap[3 * index + 1];
-      disparity_color_(row, col)[0] = colormap[3 * index + 2];
-    }
+  // Float disparities, or the fixed point ones of the matchers in units of delta_d
+  const sensor_msgs::msg::Image & dimage = disparity_msg->image;
+  const bool fixed_point = dimage.encoding == enc::TYPE_16SC1;
+  assert(fixed_point || dimage.encoding == enc::TYPE_32FC1);
+  // Colormap index of a raw disparity value is value * scale + offset
+  const float scale = (fixed_point ? disparity_msg->delta_d : 1.0f) * multiplier;
+  const float offset = 0.5f - min_disparity * multiplier;
+  const cv::Mat disparity(
+    dimage.height, dimage.width, fixed_point ? CV_16SC1 : CV_32FC1,
+    const_cast<uint8_t *>(dimage.data.data()), dimage.step);
+  colorizeDisparity(disparity, scale, offset, next_disparity_color_);
+
+  {
+    // Hang on to image data for sake of mouseCb. The disparity images are
+    // swapped, so the next one is colored into the previous buffer.
+    std::lock_guard<std::mutex> lock(image_mutex_);
+    last_left_msg_ = left;
+    last_right_msg_ = right;
+    last_left_image_ = left_image;
+    last_right_image_ = right_image;
+    std::swap(disparity_color_, next_disparity_color_);
   }
 
-  // Must release the mutex before calling cv::imshow, or can deadlock against
+  // Only this callback changes the images, so they are shown without the
+  // mutex, which must not be held by cv::imshow, or it can deadlock against
   // OpenCV's window mutex.
-  image_mutex_.unlock();
-
   if (!last_left_image_.empty()) {
     cv::imshow("left", last_left_image_);
     cv::waitKey(1);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -36,7 +37,8 @@ VideoRecorderNode::VideoRecorderNode(const rclcpp::NodeOptions & options)
 : rclcpp::Node("video_recorder_node", options),
   g_count(0),
   g_last_wrote_time(rclcpp::Time((int64_t) 0, RCL_ROS_TIME)),
-  recording_started(false)
+  recording_started(false),
+  encoder_stopping(false)
 {
   bool stamped_filename;
 
@@ -44,12 +46,14 @@ VideoRecorderNode::VideoRecorderNode(const rclcpp::NodeOptions & options)
   stamped_filename = this->declare_parameter("stamped_filename", false);
   fps = this->declare_parameter("fps", 15.0);
   codec = this->declare_parameter("codec", std::string("MJPG"));
+  pipeline = this->declare_parameter("pipeline", std::string(""));
   encoding = this->declare_parameter("encoding", std::string("bgr8"));
   // cv_bridge::CvtColorForDisplayOptions
   min_depth_range = this->declare_parameter("min_depth_range", 0.0);
   max_depth_range = this->declare_parameter("max_depth_range", 0.0);
   use_dynamic_range = this->declare_parameter("use_dynamic_depth_range", false);
   colormap = this->declare_parameter("colormap", -1);
+  encoder_queue_size = std::max<int>(this->declare_parameter("encoder_queue_size", 5), 0);
 
   if (stamped_filename) {
     std::size_t found = filename.find_last_of("/\\");
@@ -61,7 +65,7 @@ VideoRecorderNode::VideoRecorderNode(const rclcpp::NodeOptions & options)
     RCLCPP_INFO(this->get_logger(), "Video recording to %s", filename.c_str());
   }
 
-  if (codec.size() != 4) {
+  if (pipeline.empty() && codec.size() != 4) {
     RCLCPP_ERROR(this->get_logger(), "The video codec must be a FOURCC identifier (4 chars)");
     rclcpp::shutdown();
   }
@@ -80,37 +84,103 @@ VideoRecorderNode::VideoRecorderNode(const rclcpp::NodeOptions & options)
       &VideoRecorderNode::callback, this,
       std::placeholders::_1), hints.getTransport());
 
+  // Convert and encode frames on their own thread, unless encoder_queue_size is 0
+  if (encoder_queue_size > 0) {
+    encoder_thread = std::thread(&VideoRecorderNode::encoderLoop, this);
+  }
+
   RCLCPP_INFO(this->get_logger(), "Waiting for topic %s...", topic.c_str());
 }
 
 VideoRecorderNode::~VideoRecorderNode()
 {
+  // Encode the frames still queued before the video is closed
+  if (encoder_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(encoder_mutex);
+      encoder_stopping = true;
+    }
+    encoder_condition.notify_one();
+    encoder_thread.join();
+  }
   if (recording_started) {
-    std::cout << "\nVideo saved as: " << filename << std::endl;
+    std::cout << "\nVideo saved as: " << (pipeline.empty() ? filename : pipeline) << std::endl;
   }
 }
 
 void VideoRecorderNode::callback(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg)
+{
+  if (
+    (rclcpp::Time(image_msg->header.stamp, RCL_ROS_TIME) - g_last_wrote_time) <
+    rclcpp::Duration::from_seconds(1.0 / fps))
+  {
+    // Skip to get video with correct fps
+    return;
+  }
+
+  if (!encoder_thread.joinable()) {
+    encode(image_msg);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(encoder_mutex);
+    if (encoder_queue.size() >= encoder_queue_size) {
+      RCLCPP_WARN_THROTTLE(
+        this->get_logger(), *this->get_clock(), 1000,
+        "Encoder is falling behind, frame skipped!");
+      return;
+    }
+    encoder_queue.push_back(image_msg);
+  }
+  encoder_condition.notify_one();
+  g_last_wrote_time = rclcpp::Time(image_msg->header.stamp, RCL_ROS_TIME);
+}
+
+void VideoRecorderNode::encoderLoop()
+{
+  while (true) {
+    sensor_msgs::msg::Image::ConstSharedPtr image_msg;
+    {
+      std::unique_lock<std::mutex> lock(encoder_mutex);
+      encoder_condition.wait(lock, [this] {return encoder_stopping || !encoder_queue.empty();});
+      if (encoder_queue.empty()) {
+        return;
+      }
+      image_msg = encoder_queue.front();
+      encoder_queue.pop_front();
+    }
+    encode(image_msg);
+  }
+}
+
+void VideoRecorderNode::encode(const sensor_msgs::msg::Image::ConstSharedPtr & image_msg)
 {
   if (!outputVideo.isOpened()) {
     cv::Size size(image_msg->width, image_msg->height);
 
-    outputVideo.open(
-      filename,
-      cv::VideoWriter::fourcc(
-        codec.c_str()[0],
-        codec.c_str()[1],
-        codec.c_str()[2],
-        codec.c_str()[3]),
-      fps,
-      size,
-      true);
+    if (pipeline.empty()) {
+      outputVideo.open(
+        filename,
+        cv::VideoWriter::fourcc(
+          codec.c_str()[0],
+          codec.c_str()[1],
+          codec.c_str()[2],
+          codec.c_str()[3]),
+        fps,
+        size,
+        true);
+    } else {
+      // The pipeline encodes, e.g. with a hardware encoder, and writes the video
+      outputVideo.open(pipeline, cv::CAP_GSTREAMER, 0, fps, size, true);
+    }
 
     if (!outputVideo.isOpened()) {
       RCLCPP_ERROR(
         this->get_logger(),
         "Could not create the output video! Check filename and/or support for codec.");
       rclcpp::shutdown();
+      return;
     }
 
     recording_started = true;
@@ -118,15 +188,7 @@ void VideoRecorderNode::callback(const sensor_msgs::msg::Image::ConstSharedPtr &
     RCLCPP_INFO(
       this->get_logger(),
       "Starting to record %s video at %ix%i@%.2f fps. Press Ctrl+C to stop recording.",
-      codec.c_str(), size.height, size.width, fps);
-  }
-
-  if (
-    (rclcpp::Time(image_msg->header.stamp, RCL_ROS_TIME) - g_last_wrote_time) <
-    rclcpp::Duration::from_seconds(1.0 / fps))
-  {
-    // Skip to get video with correct fps
-    return;
+      pipeline.empty() ? codec.c_str() : "GStreamer", size.height, size.width, fps);
   }
 
   try {
@@ -143,7 +205,9 @@ void VideoRecorderNode::callback(const sensor_msgs::msg::Image::ConstSharedPtr &
       outputVideo << image;
       RCLCPP_INFO(this->get_logger(), "Recording frame %i\x1b[1F", g_count);
       g_count++;
-      g_last_wrote_time = rclcpp::Time(image_msg->header.stamp, RCL_ROS_TIME);
+      if (!encoder_thread.joinable()) {
+        g_last_wrote_time = rclcpp::Time(image_msg->header.stamp, RCL_ROS_TIME);
+      }
     } else {
       RCLCPP_WARN(this->get_logger(), "Frame skipped, no data!");
     }
@@ -0,0 +1,107 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
+#include "disparity_colormap.hpp"
+
+namespace enc = sensor_msgs::image_encodings;
+
+namespace
+{
+
+// Resolutions to run every benchmark at
+const std::vector<std::pair<int, int>> kResolutions = {{640, 480}, {1280, 720}, {1920, 1080}};
+
+// Disparity image made from the brightness of the logo of the test
+// resources, 0 to 64 pixels, in float or in the fixed point of the matchers
+cv::Mat disparityImage(int width, int height, bool fixed_point)
+{
+  cv::Mat logo = cv::imread(
+    std::string(_SRC_RESOURCES_DIR_PATH) + "/logo.png", cv::IMREAD_GRAYSCALE);
+  if (logo.empty()) {
+    // Gradient so the colormap still sees varying input
+    logo.create(256, 256, CV_8UC1);
+    for (int y = 0; y < logo.rows; ++y) {
+      for (int x = 0; x < logo.cols; ++x) {
+        logo.at<uint8_t>(y, x) = (x + y) / 2;
+      }
+    }
+  }
+  cv::resize(logo, logo, cv::Size(width, height), 0.0, 0.0, cv::INTER_LINEAR);
+  cv::Mat disparity;
+  logo.convertTo(disparity, fixed_point ? CV_16S : CV_32F, (fixed_point ? 16.0 : 1.0) * 64 / 255);
+  return disparity;
+}
+
+// Arguments: width, height, fixed point disparity
+void colorizeArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "fixed_point"});
+  for (const auto & resolution : kResolutions) {
+    for (int fixed_point : {0, 1}) {
+      benchmark->Args({resolution.first, resolution.second, fixed_point});
+    }
+  }
+}
+
+// The colormap of DisparityViewNode and StereoViewNode, with their scale and
+// offset for a 0 to 64 pixel disparity range
+void BM_ColorizeDisparity(benchmark::State & state)
+{
+  const bool fixed_point = state.range(2) != 0;
+  const cv::Mat disparity = disparityImage(state.range(0), state.range(1), fixed_point);
+  const float multiplier = 255.0f / 64.0f;
+  const float scale = (fixed_point ? 1.0f / 16 : 1.0f) * multiplier;
+  const float offset = 0.5f;
+
+  cv::Mat_<cv::Vec3b> color;
+  for (auto _ : state) {
+    image_view::colorizeDisparity(disparity, scale, offset, color);
+    benchmark::DoNotOptimize(color.data);
+  }
+  state.SetLabel(fixed_point ? enc::TYPE_16SC1 : enc::TYPE_32FC1);
+  state.SetItemsProcessed(
+    static_cast<int64_t>(state.iterations()) * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_ColorizeDisparity)->Apply(colorizeArguments)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,82 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef STEREO_IMAGE_PROC__DISPARITY_PROJECTION_HPP_
+#define STEREO_IMAGE_PROC__DISPARITY_PROJECTION_HPP_
+
+#include "image_geometry/stereo_camera_model.hpp"
+
+#include <opencv2/core/types.hpp>
+
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <stereo_msgs/msg/disparity_image.hpp>
+
+namespace stereo_image_proc
+{
+
+/**
+ * Reproject a disparity image through the Q matrix of model straight into an
+ * organized cloud, in a single pass over bands of rows in parallel, instead
+ * of going through a dense cv::Mat of points. Points are marked invalid with
+ * NaNs exactly where StereoCameraModel::projectDisparityImageTo3d with
+ * missing value handling gives MISSING_Z or an infinite depth. Both 32FC1
+ * disparities and 16SC1 fixed point ones, in units of delta_d, are projected.
+ *
+ * points must already have the size of the disparity image, and start every
+ * point with float x, y and z fields. If color is not null, it must have that
+ * size too, and its pixels are packed into the rgb field. MONO8, RGB8, BGR8,
+ * RGBA8 and BGRA8 are supported. Returns false if color has another
+ * encoding, the rgb fields are then zeroed.
+ */
+bool projectDisparityToCloud(
+  const stereo_msgs::msg::DisparityImage & disparity,
+  const sensor_msgs::msg::Image::ConstSharedPtr & color,
+  const image_geometry::StereoCameraModel & model,
+  sensor_msgs::msg::PointCloud2 & points);
+
+/**
+ * Same, for the pixels of the disparity image in window only, so that points
+ * must have the size of the window, whose top-left pixel is the first point.
+ * color still has the size of the disparity image. The missing value is the
+ * smallest disparity of the window.
+ */
+bool projectDisparityToCloud(
+  const stereo_msgs::msg::DisparityImage & disparity,
+  const sensor_msgs::msg::Image::ConstSharedPtr & color,
+  const image_geometry::StereoCameraModel & model,
+  const cv::Rect & window,
+  sensor_msgs::msg::PointCloud2 & points);
+
+}  // namespace stereo_image_proc
+
+#endif  // STEREO_IMAGE_PROC__DISPARITY_PROJECTION_HPP_
@@ -0,0 +1,103 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef STEREO_IMAGE_PROC__MATCHER_PARAMETERS_HPP_
+#define STEREO_IMAGE_PROC__MATCHER_PARAMETERS_HPP_
+
+#include <stereo_image_proc/stereo_processor.hpp>
+
+#include <rcl_interfaces/msg/set_parameters_result.hpp>
+#include <rclcpp/rclcpp.hpp>
+
+namespace stereo_image_proc
+{
+
+/**
+ * Declare the parameters of the stereo matcher (stereo_algorithm,
+ * disparity_range, ...) on node. Declaring them triggers the on set
+ * parameters callbacks of node, so register the one applying them first.
+ */
+void declareMatcherParameters(rclcpp::Node & node);
+
+/**
+ * Values of the matcher parameters, kept by nodes as a snapshot that their
+ * parameter callbacks replace and their matching applies, so that parameter
+ * updates never wait for a frame being matched.
+ */
+struct MatcherConfig
+{
+  StereoProcessor::StereoType stereo_type = StereoProcessor::BM;
+  int prefilter_size = 9;
+  int prefilter_cap = 31;
+  int correlation_window_size = 15;
+  int min_disparity = 0;
+  int disparity_range = 64;
+  double uniqueness_ratio = 15.0;
+  int texture_threshold = 10;
+  int speckle_size = 100;
+  int speckle_range = 4;
+  int sgbm_mode = 0;
+  double p1 = 200.0;
+  double p2 = 400.0;
+  int disp12_max_diff = 0;
+  bool adaptive_range = false;
+  int adaptive_range_bands = 8;
+  bool fixed_point_disparity = false;
+  int coarse_to_fine_levels = 0;
+  bool fused_post_filter = false;
+  bool left_right_check = false;
+  int left_right_max_diff = 1;
+  int stripe_rows = 0;
+  bool parallel_stripes = false;
+};
+
+bool operator==(const MatcherConfig & a, const MatcherConfig & b);
+bool operator!=(const MatcherConfig & a, const MatcherConfig & b);
+
+/**
+ * Store param in config if it is one of the matcher parameters. A rejected
+ * value makes result unsuccessful, with the reason why.
+ */
+void updateMatcherConfig(
+  const rclcpp::Parameter & param, const rclcpp::Logger & logger,
+  MatcherConfig & config, rcl_interfaces::msg::SetParametersResult & result);
+
+/**
+ * Apply config to processor, only the values that differ from applied, the
+ * config processor was last configured with, unless it is null.
+ */
+void configureMatcher(
+  const MatcherConfig & config, const MatcherConfig * applied, StereoProcessor & processor);
+
+}  // namespace stereo_image_proc
+
+#endif  // STEREO_IMAGE_PROC__MATCHER_PARAMETERS_HPP_
@@ -0,0 +1,161 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef STEREO_IMAGE_PROC__STEREO_BATCH_PROCESSOR_HPP_
+#define STEREO_IMAGE_PROC__STEREO_BATCH_PROCESSOR_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "image_geometry/stereo_camera_model.hpp"
+
+#include <stereo_image_proc/stereo_processor.hpp>
+
+#include <sensor_msgs/msg/image.hpp>
+
+namespace stereo_image_proc
+{
+
+/**
+ * Processes the synchronized pairs of several stereo cameras on one shared
+ * pool of threads, instead of every camera having threads of its own.
+ *
+ * Every pair has its own StereoProcessor, so its matchers and scratch buffers,
+ * and a priority. A submitted pair is split into the monocular processing of
+ * each camera, run concurrently if the processor has parallel mono set and
+ * one after the other otherwise, then the stereo stage. The idle threads take
+ * the queued stage of the highest priority first, and of the oldest pair
+ * among equal priorities, so a pair is never starved by the ones of lower
+ * priority and a frame whose cameras are done is matched before newer frames
+ * of the same priority are rectified.
+ */
+class StereoBatchProcessor
+{
+public:
+  /// Called from a pool thread once a pair is processed, ok is false if it failed.
+  using Callback = std::function<void(bool ok, const StereoImageSet & output)>;
+
+  /// Starts threads threads, or one per core if 0.
+  explicit StereoBatchProcessor(size_t threads = 0);
+
+  /// Stops the threads. Queued pairs are dropped without calling their callback.
+  ~StereoBatchProcessor();
+
+  /// Adds a camera, scheduled before those of lower priority. Returns its index.
+  /// Cameras are all added before the first submit().
+  size_t addPair(int priority = 0);
+
+  size_t size() const;
+
+  /// Calls configure on the processor of every camera, while none is matching.
+  void configure(const std::function<void(StereoProcessor &)> & configure);
+
+  /**
+   * Queues a synchronized pair of camera pair for processing with flags, as
+   * StereoProcessor::process does. Returns false, dropping it, while the
+   * previous pair of that camera is still being processed.
+   */
+  bool submit(
+    size_t pair,
+    const sensor_msgs::msg::Image::ConstSharedPtr & left_raw,
+    const sensor_msgs::msg::Image::ConstSharedPtr & right_raw,
+    const image_geometry::StereoCameraModel & model,
+    int flags,
+    Callback done);
+
+private:
+  struct Pair
+  {
+    int priority = 0;
+    StereoProcessor processor;
+    /// Held while matching, so that configure() waits for it.
+    std::mutex mutex;
+    /// Set from submit() until the callback returned.
+    std::atomic<bool> busy{false};
+    /// Cameras still in their monocular stage.
+    std::atomic<int> pending{0};
+
+    // The pair being processed
+    sensor_msgs::msg::Image::ConstSharedPtr left_raw, right_raw;
+    image_geometry::StereoCameraModel model;
+    int flags = 0;
+    Callback done;
+    bool ok[2] = {false, false};
+    StereoImageSet output;
+    /// Image buffers of the pair, reused from one submission to the next.
+    StereoFrameArena arena;
+  };
+
+  struct Task
+  {
+    int priority;
+    /// Submission order of the pair the task belongs to.
+    uint64_t sequence;
+    std::function<void()> run;
+  };
+
+  // Orders the queue with the highest priority, then the oldest, on top
+  struct TaskOrder
+  {
+    bool operator()(const Task & a, const Task & b) const
+    {
+      if (a.priority != b.priority) {
+        return a.priority < b.priority;
+      }
+      return a.sequence > b.sequence;
+    }
+  };
+
+  void push(Task task);
+  void work();
+  void processMono(Pair & pair, bool right, uint64_t sequence);
+  void processStereo(Pair & pair);
+
+  std::vector<std::unique_ptr<Pair>> pairs_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::priority_queue<Task, std::vector<Task>, TaskOrder> tasks_;
+  uint64_t sequence_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace stereo_image_proc
+
+#endif  // STEREO_IMAGE_PROC__STEREO_BATCH_PROCESSOR_HPP_
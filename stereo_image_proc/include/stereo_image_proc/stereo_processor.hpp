@@ -34,10 +34,17 @@
 #define STEREO_IMAGE_PROC__STEREO_PROCESSOR_HPP_
 
 #include <string>
+#include <vector>
 
 #include "image_geometry/stereo_camera_model.hpp"
 
 #include <image_proc/processor.hpp>
+#include <opencv2/opencv_modules.hpp>
+#ifdef HAVE_OPENCV_CUDASTEREO
+#include <opencv2/core/cuda.hpp>
+#include <opencv2/cudastereo.hpp>
+#endif
+#include <sensor_msgs/msg/image.hpp>
 #include <sensor_msgs/msg/point_cloud.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <stereo_msgs/msg/disparity_image.hpp>
@@ -54,20 +61,53 @@ struct StereoImageSet
   sensor_msgs::msg::PointCloud2 points2;
 };
 
+/// Buffers of the images StereoProcessor::process computes for both cameras,
+/// kept from frame to frame, as image_proc::FrameArena is for one camera.
+/// The disparity image and the point clouds are written into the messages of
+/// the StereoImageSet, so keep the same output to reuse their buffers too.
+struct StereoFrameArena
+{
+  image_proc::FrameArena left;
+  image_proc::FrameArena right;
+};
+
+/// Cost of one level of the last coarse-to-fine disparity computation.
+struct CoarseToFineLevel
+{
+  /// Size of the images matched at this level.
+  cv::Size size;
+  /// Mean number of disparities searched per pixel, in pixels of this level.
+  double disparities;
+  /// Wall time spent matching this level.
+  double milliseconds;
+  /// Pixel-disparities of a full range match at full resolution, divided by those of this level.
+  double speedup;
+};
+
 class StereoProcessor
 {
 public:
   StereoProcessor()
+  : parallel_mono_(false), adaptive_range_(false), adaptive_bands_(8),
+    fixed_point_disparity_(false), coarse_to_fine_levels_(0),
+    fused_post_filter_(false), lr_check_(false), lr_check_max_diff_(1),
+    stripe_rows_(0), parallel_stripes_(false), current_stereo_algorithm_(BM)
   {
     block_matcher_ = cv::StereoBM::create();
     sg_block_matcher_ = cv::StereoSGBM::create(1, 1, 10);
   }
 
+  // CUDA_BM and CUDA_SGM run cv::cuda::StereoBM and cv::cuda::StereoSGM,
+  // configured through the same setters as BM and SGBM
   enum StereoType
   {
-    BM, SGBM
+    BM, SGBM, CUDA_BM, CUDA_SGM
   };
 
+  // Whether the CUDA stereo types can be used: OpenCV was built with its
+  // cudastereo module and a CUDA device is present
+  static bool cudaAvailable();
+
   enum
   {
     LEFT_MONO        = 1 << 0,
@@ -107,9 +147,166 @@ public:
     mono_processor_.interpolation_ = interp;
   }
 
+  inline bool getFusedDebayerRectify() const
+  {
+    return mono_processor_.fused_debayer_rectify_;
+  }
+
+  inline void setFusedDebayerRectify(bool fused)
+  {
+    mono_processor_.fused_debayer_rectify_ = fused;
+  }
+
+  inline bool getRectFromRectColor() const
+  {
+    return mono_processor_.rect_from_rect_color_;
+  }
+
+  // For point clouds, rectify the left color image once and match on its
+  // luma, instead of rectifying the left image as mono and as color
+  inline void setRectFromRectColor(bool rect_once)
+  {
+    mono_processor_.rect_from_rect_color_ = rect_once;
+  }
+
+  inline bool getParallelMono() const
+  {
+    return parallel_mono_;
+  }
+
+  // Run the monocular processing of the right image on a thread of its own,
+  // concurrently with the left one, instead of one after the other
+  inline void setParallelMono(bool parallel)
+  {
+    parallel_mono_ = parallel;
+  }
+
+  inline bool getAdaptiveRange() const
+  {
+    return adaptive_range_;
+  }
+
+  // Match horizontal bands of the image separately, each over the disparities
+  // found in it in the previous frame rather than the whole disparity range.
+  // Only used by the CPU matchers.
+  inline void setAdaptiveRange(bool adaptive)
+  {
+    adaptive_range_ = adaptive;
+    band_windows_.clear();
+  }
+
+  inline int getAdaptiveBands() const
+  {
+    return adaptive_bands_;
+  }
+
+  inline void setAdaptiveBands(int bands)
+  {
+    adaptive_bands_ = bands;
+    band_windows_.clear();
+  }
+
+  inline int getCoarseToFineLevels() const
+  {
+    return coarse_to_fine_levels_;
+  }
+
+  // Match the pair downsampled levels times by two first, then every finer
+  // level in bands around the disparities of the coarser one, instead of over
+  // the whole disparity range. 0 disables it. Only used by the CPU matchers,
+  // and takes precedence over the adaptive range.
+  inline void setCoarseToFineLevels(int levels)
+  {
+    coarse_to_fine_levels_ = levels;
+  }
+
+  // Cost of every level of the last coarse-to-fine computation, coarsest first
+  inline const std::vector<CoarseToFineLevel> & getCoarseToFineStats() const
+  {
+    return coarse_to_fine_stats_;
+  }
+
+  inline bool getFusedPostFilter() const
+  {
+    return fused_post_filter_;
+  }
+
+  // Remove speckles in one pass over the fixed point disparity fused with
+  // the left-right check and the conversion to the published disparity,
+  // instead of with the matcher's own filter. Only used by the CPU matchers.
+  inline void setFusedPostFilter(bool fused)
+  {
+    fused_post_filter_ = fused;
+  }
+
+  inline bool getLeftRightCheck() const
+  {
+    return lr_check_;
+  }
+
+  // Invalidate matches whose right image pixel is claimed by a match with a
+  // larger disparity, by more than getLeftRightMaxDiff() pixels. Runs in the
+  // fused post filter, which it enables.
+  inline void setLeftRightCheck(bool check)
+  {
+    lr_check_ = check;
+  }
+
+  inline int getLeftRightMaxDiff() const
+  {
+    return lr_check_max_diff_;
+  }
+
+  inline void setLeftRightMaxDiff(int max_diff)
+  {
+    lr_check_max_diff_ = max_diff;
+  }
+
+  inline int getStripeRows() const
+  {
+    return stripe_rows_;
+  }
+
+  // Match and reproject horizontal stripes of this many rows one at a time,
+  // each with the rows its matching windows reach into above and below, so
+  // that the scratch memory of the matcher and of the dense points is that
+  // of a stripe rather than of the whole image. 0 processes the whole image
+  // at once. Only used by the CPU matchers, without the adaptive range or
+  // coarse-to-fine matching. Exact for Block Matching. Semi-Global Block
+  // Matching aggregates its paths within the stripes only, which makes its
+  // disparities near the seams approximate.
+  inline void setStripeRows(int rows)
+  {
+    stripe_rows_ = rows;
+  }
+
+  inline bool getParallelStripes() const
+  {
+    return parallel_stripes_;
+  }
+
+  // Process the stripes concurrently on the OpenCV thread pool, each thread
+  // with the scratch memory of one stripe
+  inline void setParallelStripes(bool parallel)
+  {
+    parallel_stripes_ = parallel;
+  }
+
+  inline bool getFixedPointDisparity() const
+  {
+    return fixed_point_disparity_;
+  }
+
+  // Publish the 16-bit fixed point disparity of the matchers (16SC1, in units
+  // of delta_d = 1/16 pixel) instead of converting it to 32FC1
+  inline void setFixedPointDisparity(bool fixed_point)
+  {
+    fixed_point_disparity_ = fixed_point;
+  }
+
   inline int getPreFilterCap() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getPreFilterCap();
     }
     return sg_block_matcher_->getPreFilterCap();
@@ -123,7 +320,7 @@ public:
 
   inline int getCorrelationWindowSize() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getBlockSize();
     }
     return sg_block_matcher_->getBlockSize();
@@ -137,7 +334,7 @@ public:
 
   inline int getMinDisparity() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getMinDisparity();
     }
     return sg_block_matcher_->getMinDisparity();
@@ -151,7 +348,7 @@ public:
 
   inline int getDisparityRange() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getNumDisparities();
     }
     return sg_block_matcher_->getNumDisparities();
@@ -165,7 +362,7 @@ public:
 
   inline float getUniquenessRatio() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getUniquenessRatio();
     }
     return sg_block_matcher_->getUniquenessRatio();
@@ -179,7 +376,7 @@ public:
 
   inline int getSpeckleSize() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getSpeckleWindowSize();
     }
     return sg_block_matcher_->getSpeckleWindowSize();
@@ -193,7 +390,7 @@ public:
 
   inline int getSpeckleRange() const
   {
-    if (current_stereo_algorithm_ == BM) {
+    if (isBlockMatching()) {
       return block_matcher_->getSpeckleRange();
     }
     return sg_block_matcher_->getSpeckleRange();
@@ -278,11 +475,60 @@ public:
     StereoImageSet & output,
     int flags) const;
 
+  // Same, computing the images of both cameras into the buffers of arena
+  bool process(
+    const sensor_msgs::msg::Image::ConstSharedPtr & left_raw,
+    const sensor_msgs::msg::Image::ConstSharedPtr & right_raw,
+    const image_geometry::StereoCameraModel & model,
+    StereoImageSet & output,
+    StereoFrameArena & arena,
+    int flags) const;
+
+  // The monocular stage of process() for the left or the right camera, so that
+  // both cameras and the stereo stage can be scheduled separately
+  bool processMono(
+    const sensor_msgs::msg::Image::ConstSharedPtr & raw,
+    const image_geometry::StereoCameraModel & model,
+    bool right,
+    StereoImageSet & output,
+    int flags) const;
+
+  // Same, computing the images into the buffers of arena for that camera
+  bool processMono(
+    const sensor_msgs::msg::Image::ConstSharedPtr & raw,
+    const image_geometry::StereoCameraModel & model,
+    bool right,
+    StereoImageSet & output,
+    StereoFrameArena & arena,
+    int flags) const;
+
+  // The stereo stage of process(), once processMono succeeded for both cameras
+  void processStereo(
+    const image_geometry::StereoCameraModel & model,
+    StereoImageSet & output,
+    int flags) const;
+
+  // If depth is given, also fills it with the depth f * T / d of every pixel,
+  // in meters (32FC1, NaN where invalid) or in millimeters if its encoding is
+  // already set to 16UC1 (0 where invalid or out of range). On the CPU without
+  // a post filter it is computed in the same pass as the float disparity.
+  void processDisparity(
+    const cv::Mat & left_rect,
+    const cv::Mat & right_rect,
+    const image_geometry::StereoCameraModel & model,
+    stereo_msgs::msg::DisparityImage & disparity,
+    sensor_msgs::msg::Image * depth = nullptr) const;
+
+  // Same, matching only the pixels of the left image in window, and the
+  // margins their block matching needs. The disparities outside of it are
+  // invalid, and valid_window is set to it. The window is clipped to the image.
   void processDisparity(
     const cv::Mat & left_rect,
     const cv::Mat & right_rect,
     const image_geometry::StereoCameraModel & model,
-    stereo_msgs::msg::DisparityImage & disparity) const;
+    const cv::Rect & window,
+    stereo_msgs::msg::DisparityImage & disparity,
+    sensor_msgs::msg::Image * depth = nullptr) const;
 
   void processPoints(
     const stereo_msgs::msg::DisparityImage & disparity,
@@ -299,14 +545,129 @@ public:
     sensor_msgs::msg::PointCloud2 & points) const;
 
 private:
+  inline bool isBlockMatching() const
+  {
+    return current_stereo_algorithm_ == BM || current_stereo_algorithm_ == CUDA_BM;
+  }
+
+  // Computes disparity16_ band by band with the adaptive search windows, and
+  // derives the windows of the next frame from the result
+  void computeAdaptiveDisparity(
+    const cv::Mat & left_rect, const cv::Mat & right_rect,
+    cv::StereoMatcher & matcher) const;
+
+  // Computes disparity band by band, each over its window, within the range
+  // of matcher, then replaces every window by the disparities found in its
+  // band plus a margin. Returns the mean number of disparities searched.
+  double computeBandedDisparity(
+    const cv::Mat & left_rect, const cv::Mat & right_rect, cv::StereoMatcher & matcher,
+    std::vector<cv::Vec2i> & windows, cv::Mat_<int16_t> & disparity) const;
+
+  // Number of workers processing the stripes, each taking every n-th one
+  int stripeWorkers(int stripes) const;
+
+  // Computes disparity16_ stripe by stripe, each with its own copy of matcher
+  void computeStripedDisparity(
+    const cv::Mat & left_rect, const cv::Mat & right_rect,
+    cv::StereoMatcher & matcher) const;
+
+  // processPoints2 stripe by stripe, returns false if the color encoding is unknown
+  bool processPoints2Striped(
+    const stereo_msgs::msg::DisparityImage & disparity,
+    const cv::Mat & color,
+    const std::string & encoding,
+    const image_geometry::StereoCameraModel & model,
+    sensor_msgs::msg::PointCloud2 & points) const;
+
+  // Writes the points dense, with the colors of color, of the same size, into
+  // the rows of points from first_row on. Returns false if the color
+  // encoding is unknown, the color fields are then left as they are.
+  bool writePoints2(
+    const cv::Mat_<cv::Vec3f> & dense,
+    const cv::Mat & color,
+    const std::string & encoding,
+    int first_row,
+    sensor_msgs::msg::PointCloud2 & points) const;
+
+  // Computes disparity16_ from the coarsest level of an image pyramid down,
+  // every level searching the windows of the coarser one scaled up
+  void computeCoarseToFineDisparity(
+    const cv::Mat & left_rect, const cv::Mat & right_rect,
+    cv::StereoMatcher & matcher) const;
+
+  // Runs the left-right check and the removal of speckles of at most
+  // speckle_size pixels on disparity16_, then writes it plus disparity_offset
+  // into dmat (32FC1, or 16SC1 in fixed point)
+  void postFilterDisparity(
+    int min_disparity, int speckle_size, int speckle_range, double disparity_offset,
+    cv::Mat & dmat) const;
+
+  // Computes the disparity of a rectified pair with the CUDA matchers into
+  // disparity16_, as the CPU matchers do: in fixed point, invalid pixels at
+  // (min_disparity - 1) * 16 and speckles removed
+  void processDisparityCuda(const cv::Mat & left_rect, const cv::Mat & right_rect) const;
+
+  // Writes the depth focal_baseline / d of the disparities d = disparity * scale + offset
+  // (16SC1 or 32FC1) into depth as processDisparity does, and d into float_disparity
+  // unless it is empty. Disparities below min_valid, in the units of disparity, are invalid.
+  void writeDepth(
+    const cv::Mat & disparity, double scale, double offset, double min_valid,
+    double focal_baseline, cv::Mat & float_disparity, sensor_msgs::msg::Image & depth) const;
+
+  // The disparity image as 32FC1, converting a fixed point one into disparity32_
+  cv::Mat floatDisparity(const stereo_msgs::msg::DisparityImage & disparity) const;
+
   image_proc::Processor mono_processor_;
+  bool parallel_mono_;
+  bool adaptive_range_;
+  int adaptive_bands_;
+  /// Minimum disparity and number of disparities to search in every band of the next frame.
+  mutable std::vector<cv::Vec2i> band_windows_;
+  /// Image size the band windows were found for.
+  mutable cv::Size band_image_size_;
+  /// Scratch buffer for the disparity of one band.
+  mutable cv::Mat_<int16_t> band_disparity16_;
+  bool fixed_point_disparity_;
+  int coarse_to_fine_levels_;
+  bool fused_post_filter_;
+  bool lr_check_;
+  int lr_check_max_diff_;
+  int stripe_rows_;
+  bool parallel_stripes_;
+  /// Matchers and scratch buffers of the workers of striped processing.
+  mutable std::vector<cv::Ptr<cv::StereoMatcher>> stripe_matchers_;
+  mutable std::vector<cv::Mat_<int16_t>> stripe_disparity16_;
+  mutable std::vector<cv::Mat_<cv::Vec3f>> stripe_points_;
+  /// Scratch buffer of cv::filterSpeckles, run on striped and CUDA disparities.
+  mutable cv::Mat speckle_buffer_;
+  /// Scratch buffers of the fused post filter: the speckle region of every
+  /// pixel, the union-find forest of the regions and their sizes, and the
+  /// largest disparity matched to every right image pixel of a row.
+  mutable cv::Mat_<int32_t> speckle_labels_;
+  mutable std::vector<int32_t> speckle_parent_, speckle_area_;
+  mutable std::vector<int> lr_best_;
+  mutable std::vector<CoarseToFineLevel> coarse_to_fine_stats_;
+  /// Scratch buffers for the downsampled pairs and their disparities, finest first.
+  mutable std::vector<cv::Mat> pyramid_left_, pyramid_right_;
+  mutable std::vector<cv::Mat_<int16_t>> pyramid_disparity16_;
+  /// Search windows of every band of the level being matched.
+  mutable std::vector<cv::Vec2i> level_windows_;
 
   /// Scratch buffer for 16-bit signed disparity image
   mutable cv::Mat_<int16_t> disparity16_;
+  /// Scratch buffer for a fixed point disparity image converted to float
+  mutable cv::Mat_<float> disparity32_;
   /// Contains scratch buffers for block matching.
   mutable cv::Ptr<cv::StereoBM> block_matcher_;
   mutable cv::Ptr<cv::StereoSGBM> sg_block_matcher_;
   StereoType current_stereo_algorithm_;
+#ifdef HAVE_OPENCV_CUDASTEREO
+  /// Created on first use, with the parameters of the CPU matchers copied in before each frame.
+  mutable cv::Ptr<cv::cuda::StereoBM> cuda_block_matcher_;
+  mutable cv::Ptr<cv::cuda::StereoSGM> cuda_sg_block_matcher_;
+  /// Device buffers, so that only the input pair and the fixed point disparity cross the bus.
+  mutable cv::cuda::GpuMat cuda_left_, cuda_right_, cuda_disparity16_, cuda_disparity_;
+#endif
   /// Scratch buffer for dense point cloud.
   mutable cv::Mat_<cv::Vec3f> dense_points_;
 };
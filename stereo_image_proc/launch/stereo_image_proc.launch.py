@@ -49,6 +49,10 @@ from launch_ros.substitutions import FindPackageShare
 
 
 def generate_launch_description():
+    # Pass messages between the components, including those of image_proc.launch.py,
+    # as pointers rather than through the middleware
+    intra_process = [{'use_intra_process_comms': True}]
+
     composable_nodes = [
         ComposableNode(
             package='stereo_image_proc',
@@ -71,6 +75,7 @@ def generate_launch_description():
                 'P2': LaunchConfiguration('P2'),
                 'sgbm_mode': LaunchConfiguration('sgbm_mode'),
             }],
+            extra_arguments=intra_process,
             remappings=[
                 ('left/image_rect', [LaunchConfiguration('left_namespace'), '/image_rect']),
                 ('left/camera_info', [LaunchConfiguration('left_namespace'), '/camera_info']),
@@ -87,6 +92,7 @@ def generate_launch_description():
                 'avoid_point_cloud_padding': LaunchConfiguration('avoid_point_cloud_padding'),
                 'use_color': LaunchConfiguration('use_color'),
             }],
+            extra_arguments=intra_process,
             remappings=[
                 ('left/camera_info', [LaunchConfiguration('left_namespace'), '/camera_info']),
                 ('right/camera_info', [LaunchConfiguration('right_namespace'), '/camera_info']),
@@ -145,7 +151,10 @@ def generate_launch_description():
         # Stereo algorithm parameters
         DeclareLaunchArgument(
             name='stereo_algorithm', default_value='0',
-            description='Stereo algorithm: Block Matching (0) or Semi-Global Block Matching (1)'
+            description=(
+                'Stereo algorithm: Block Matching (0), Semi-Global Block Matching (1), '
+                'CUDA Block Matching (2) or CUDA Semi-Global Matching (3)'
+            )
         ),
         DeclareLaunchArgument(
             name='prefilter_size', default_value='9',
@@ -31,14 +31,18 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
-#include <map>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <sstream>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "cv_bridge/cv_bridge.hpp"
+#include "diagnostic_updater/diagnostic_updater.hpp"
 #include "image_geometry/stereo_camera_model.hpp"
 #include "message_filters/subscriber.hpp"
 #include "message_filters/synchronizer.hpp"
@@ -46,33 +50,101 @@
 #include "message_filters/sync_policies/approximate_epsilon_time.hpp"
 #include "message_filters/sync_policies/exact_time.hpp"
 
+#include <stereo_image_proc/matcher_parameters.hpp>
 #include <stereo_image_proc/stereo_processor.hpp>
 
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/conversion_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/parameter_snapshot.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
+#include <image_proc/stamp_synchronizer.hpp>
+#include <image_proc/thread_placement.hpp>
 #include <image_transport/camera_common.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber_filter.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 #include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
 #include <stereo_msgs/msg/disparity_image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 #include <opencv2/calib3d/calib3d.hpp>
 
 namespace stereo_image_proc
 {
 
+// Hands entries from one pipeline stage to the next. When full, either the
+// oldest queued entry or the pushed one is dropped, so the stage upstream
+// never waits.
+template<typename T>
+class StageQueue
+{
+public:
+  StageQueue(size_t capacity, bool drop_oldest)
+  : capacity_(std::max<size_t>(capacity, 1)), drop_oldest_(drop_oldest)
+  {
+  }
+
+  // Returns false if an entry was dropped
+  bool push(T value)
+  {
+    bool dropped = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (entries_.size() >= capacity_) {
+        if (!drop_oldest_) {
+          return false;
+        }
+        entries_.pop_front();
+        dropped = true;
+      }
+      entries_.push_back(std::move(value));
+    }
+    condition_.notify_one();
+    return !dropped;
+  }
+
+  // Waits for an entry, returns false once the queue is closed
+  bool pop(T & value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] {return closed_ || !entries_.empty();});
+    if (closed_) {
+      return false;
+    }
+    value = std::move(entries_.front());
+    entries_.pop_front();
+    return true;
+  }
+
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    condition_.notify_all();
+  }
+
+private:
+  const size_t capacity_;
+  const bool drop_oldest_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<T> entries_;
+  bool closed_ = false;
+};
+
 class DisparityNode : public rclcpp::Node
 {
 public:
   explicit DisparityNode(const rclcpp::NodeOptions & options);
+  ~DisparityNode() override;
 
 private:
-  enum StereoAlgorithm
-  {
-    BLOCK_MATCHING = 0,
-    SEMI_GLOBAL_BLOCK_MATCHING
-  };
-
   // Subscriptions
   image_transport::SubscriberFilter sub_l_image_, sub_r_image_;
   message_filters::Subscriber<sensor_msgs::msg::CameraInfo> sub_l_info_, sub_r_info_;
@@ -97,16 +169,69 @@ private:
   std::shared_ptr<ExactSync> exact_sync_;
   std::shared_ptr<ApproximateSync> approximate_sync_;
   std::shared_ptr<ApproximateEpsilonSync> approximate_epsilon_sync_;
+  using StampSync = image_proc::StampSynchronizer<
+    sensor_msgs::msg::Image,
+    sensor_msgs::msg::CameraInfo,
+    sensor_msgs::msg::Image,
+    sensor_msgs::msg::CameraInfo>;
+  std::unique_ptr<StampSync> stamp_sync_;
   // Publications
   std::shared_ptr<rclcpp::Publisher<stereo_msgs::msg::DisparityImage>> pub_disparity_;
+  std::shared_ptr<rclcpp::Publisher<sensor_msgs::msg::Image>> pub_depth_;
+  // Encoding of the depth image, 32FC1 or 16UC1
+  std::string depth_encoding_;
+  std::mutex connect_mutex_;
 
   // Handle to parameters callback
   rclcpp::Node::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_callback_handle_;
 
-  // Processing state (note: only safe because we're single-threaded!)
-  image_geometry::StereoCameraModel model_;
+  // Processing state, only touched by the matching stage
+  // Shared with the other nodes of the process
+  std::shared_ptr<const image_geometry::StereoCameraModel> model_;
   // contains scratch buffers for block matching
   stereo_image_proc::StereoProcessor block_matcher_;
+  // Guards block_matcher_ between matching and its diagnostics
+  std::mutex matcher_mutex_;
+  // Matcher parameters, replaced by parameterSetCb and applied to
+  // block_matcher_ before the next match if they changed
+  image_proc::ParameterSnapshot<MatcherConfig> matcher_config_;
+  std::shared_ptr<const MatcherConfig> applied_config_;
+
+  // A synchronized pair, converted to mono and ready for matching
+  struct Frame
+  {
+    sensor_msgs::msg::CameraInfo::ConstSharedPtr l_info_msg;
+    sensor_msgs::msg::CameraInfo::ConstSharedPtr r_info_msg;
+    cv_bridge::CvImageConstPtr l_image;
+    cv_bridge::CvImageConstPtr r_image;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // A disparity image, and the depth image if subscribed, waiting to be published
+  struct Output
+  {
+    stereo_msgs::msg::DisparityImage::UniquePtr disp_msg;
+    sensor_msgs::msg::Image::UniquePtr depth_msg;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // Pipelined mode: the callback converts the images, one thread matches
+  // them and another publishes, so the next pair is converted while the
+  // current one is matched
+  std::unique_ptr<StageQueue<Frame>> match_queue_;
+  std::unique_ptr<StageQueue<Output>> publish_queue_;
+  std::thread match_thread_;
+  std::thread publish_thread_;
+
+  // Latency, age and drops of the pairs, through diagnostics_
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+  std::unique_ptr<image_proc::ThreadPlacement> placement_;
+
+  // Reports the cost of every level of coarse-to-fine matching, and the
+  // synchronization statistics with hardware_sync
+  std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
 
   void imageCb(
     const sensor_msgs::msg::Image::ConstSharedPtr & l_image_msg,
@@ -114,48 +239,17 @@ private:
     const sensor_msgs::msg::Image::ConstSharedPtr & r_image_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & r_info_msg);
 
+  void connectCb();
+
+  Output match(const Frame & frame);
+
+  void publish(Output output);
+
   rcl_interfaces::msg::SetParametersResult parameterSetCb(
     const std::vector<rclcpp::Parameter> & parameters);
-};
-
-// Some helper functions for adding a parameter to a collection
-static void add_param_to_map(
-  std::map<std::string, std::pair<int, rcl_interfaces::msg::ParameterDescriptor>> & parameters,
-  const std::string & name,
-  const std::string & description,
-  const int default_value,
-  const int from_value,
-  const int to_value,
-  const int step)
-{
-  rcl_interfaces::msg::IntegerRange integer_range;
-  integer_range.from_value = from_value;
-  integer_range.to_value = to_value;
-  integer_range.step = step;
-  rcl_interfaces::msg::ParameterDescriptor descriptor;
-  descriptor.description = description;
-  descriptor.integer_range = {integer_range};
-  parameters[name] = std::make_pair(default_value, descriptor);
-}
 
-static void add_param_to_map(
-  std::map<std::string, std::pair<double, rcl_interfaces::msg::ParameterDescriptor>> & parameters,
-  const std::string & name,
-  const std::string & description,
-  const double default_value,
-  const double from_value,
-  const double to_value,
-  const double step)
-{
-  rcl_interfaces::msg::FloatingPointRange floating_point_range;
-  floating_point_range.from_value = from_value;
-  floating_point_range.to_value = to_value;
-  floating_point_range.step = step;
-  rcl_interfaces::msg::ParameterDescriptor descriptor;
-  descriptor.description = description;
-  descriptor.floating_point_range = {floating_point_range};
-  parameters[name] = std::make_pair(default_value, descriptor);
-}
+  void coarseToFineDiagnostics(diagnostic_updater::DiagnosticStatusWrapper & status);
+};
 
 DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
 : rclcpp::Node("disparity_node", options)
@@ -166,13 +260,33 @@ DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
   this->declare_parameter<std::string>("image_transport", "raw");
 
   // Declare/read parameters
-  int queue_size = this->declare_parameter("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  int queue_size = latest_only_->queueSize(this->declare_parameter("queue_size", 5));
   bool approx = this->declare_parameter("approximate_sync", false);
   double approx_sync_epsilon = this->declare_parameter("approximate_sync_tolerance_seconds", 0.0);
+  bool hardware_sync = this->declare_parameter("hardware_sync", false);
   this->declare_parameter("use_system_default_qos", false);
+  bool pipelined = this->declare_parameter("pipelined", false);
+  int pipeline_depth = this->declare_parameter("pipeline_depth", 1);
+  bool pipeline_drop_oldest = this->declare_parameter("pipeline_drop_oldest", true);
+  depth_encoding_ = this->declare_parameter<std::string>(
+    "depth_encoding", sensor_msgs::image_encodings::TYPE_32FC1);
+  if (depth_encoding_ != sensor_msgs::image_encodings::TYPE_32FC1 &&
+    depth_encoding_ != sensor_msgs::image_encodings::TYPE_16UC1)
+  {
+    RCLCPP_WARN(
+      get_logger(), "Unsupported depth_encoding '%s', publishing depth as 32FC1",
+      depth_encoding_.c_str());
+    depth_encoding_ = sensor_msgs::image_encodings::TYPE_32FC1;
+  }
 
   // Synchronize callbacks
-  if (approx) {
+  if (hardware_sync) {
+    stamp_sync_ = std::make_unique<StampSync>(queue_size);
+    stamp_sync_->connectInput(sub_l_image_, sub_l_info_, sub_r_image_, sub_r_info_);
+    stamp_sync_->registerCallback(std::bind(&DisparityNode::imageCb, this, _1, _2, _3, _4));
+  } else if (approx) {
     if (0.0 == approx_sync_epsilon) {
       approximate_sync_.reset(
         new ApproximateSync(
@@ -205,137 +319,108 @@ DisparityNode::DisparityNode(const rclcpp::NodeOptions & options)
   on_set_parameters_callback_handle_ = this->add_on_set_parameters_callback(
     std::bind(&DisparityNode::parameterSetCb, this, _1));
 
-  // Describe int parameters
-  std::map<std::string, std::pair<int, rcl_interfaces::msg::ParameterDescriptor>> int_params;
-  add_param_to_map(
-    int_params,
-    "stereo_algorithm",
-    "Stereo algorithm: Block Matching (0) or Semi-Global Block Matching (1)",
-    0, 0, 1, 1);  // default, from, to, step
-  add_param_to_map(
-    int_params,
-    "prefilter_size",
-    "Normalization window size in pixels (must be odd)",
-    9, 5, 255, 2);
-  add_param_to_map(
-    int_params,
-    "prefilter_cap",
-    "Bound on normalized pixel values",
-    31, 1, 63, 1);
-  add_param_to_map(
-    int_params,
-    "correlation_window_size",
-    "SAD correlation window width in pixels (must be odd)",
-    15, 5, 255, 2);
-  add_param_to_map(
-    int_params,
-    "min_disparity",
-    "Disparity to begin search at in pixels",
-    0, -2048, 2048, 1);
-  add_param_to_map(
-    int_params,
-    "disparity_range",
-    "Number of disparities to search in pixels (must be a multiple of 16)",
-    64, 32, 4096, 16);
-  add_param_to_map(
-    int_params,
-    "texture_threshold",
-    "Filter out if SAD window response does not exceed texture threshold",
-    10, 0, 10000, 1);
-  add_param_to_map(
-    int_params,
-    "speckle_size",
-    "Reject regions smaller than this size in pixels",
-    100, 0, 1000, 1);
-  add_param_to_map(
-    int_params,
-    "speckle_range",
-    "Maximum allowed difference between detected disparities",
-    4, 0, 31, 1);
-  add_param_to_map(
-    int_params,
-    "disp12_max_diff",
-    "Maximum allowed difference in the left-right disparity check in pixels"
-    " (Semi-Global Block Matching only)",
-    0, 0, 128, 1);
-  add_param_to_map(
-    int_params,
-    "sgbm_mode",
-    "Mode of the SGBM stereo matcher."
-    "",
-    0, 0, 3, 1);
-
-  // Describe double parameters
-  std::map<std::string, std::pair<double, rcl_interfaces::msg::ParameterDescriptor>> double_params;
-  add_param_to_map(
-    double_params,
-    "uniqueness_ratio",
-    "Filter out if best match does not sufficiently exceed the next-best match",
-    15.0, 0.0, 100.0, 0.0);
-  add_param_to_map(
-    double_params,
-    "P1",
-    "The first parameter ccontrolling the disparity smoothness (Semi-Global Block Matching only)",
-    200.0, 0.0, 4000.0, 0.0);
-  add_param_to_map(
-    double_params,
-    "P2",
-    "The second parameter ccontrolling the disparity smoothness (Semi-Global Block Matching only)",
-    400.0, 0.0, 4000.0, 0.0);
-
   // Declaring parameters triggers the previously registered callback
-  this->declare_parameters("", int_params);
-  this->declare_parameters("", double_params);
+  declareMatcherParameters(*this);
+
+  diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+  diagnostics_->setHardwareID("none");
+  diagnostics_->add("Coarse-to-fine matching", this, &DisparityNode::coarseToFineDiagnostics);
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this, *diagnostics_);
+  if (stamp_sync_) {
+    stamp_sync_->publishDiagnostics(*diagnostics_);
+  }
+  placement_ = std::make_unique<image_proc::ThreadPlacement>(this, pipelined);
+
+  // Start the matching and publishing stages before anything can subscribe
+  if (pipelined) {
+    match_queue_ = std::make_unique<StageQueue<Frame>>(pipeline_depth, pipeline_drop_oldest);
+    publish_queue_ = std::make_unique<StageQueue<Output>>(pipeline_depth, pipeline_drop_oldest);
+    match_thread_ = std::thread(
+      [this]() {
+        placement_->placeCurrentThread("match");
+        Frame frame;
+        while (match_queue_->pop(frame)) {
+          if (!publish_queue_->push(match(frame))) {
+            processing_->dropped();
+          }
+        }
+      });
+    publish_thread_ = std::thread(
+      [this]() {
+        placement_->placeCurrentThread("publish");
+        Output output;
+        while (publish_queue_->pop(output)) {
+          publish(std::move(output));
+        }
+      });
+  }
 
   // Publisher options to allow reconfigurable qos settings and connect callback
   rclcpp::PublisherOptions pub_opts;
   pub_opts.qos_overriding_options = rclcpp::QosOverridingOptions::with_default_policies();
   pub_opts.event_callbacks.matched_callback =
-    [this](rclcpp::MatchedInfo & s)
-    {
-      if (s.current_count == 0) {
-        sub_l_image_.unsubscribe();
-        sub_l_info_.unsubscribe();
-        sub_r_image_.unsubscribe();
-        sub_r_info_.unsubscribe();
-      } else if (!sub_l_image_.getSubscriber()) {
-        // For compressed topics to remap appropriately, we need to pass a
-        // fully expanded and remapped topic name to image_transport
-        auto node_base = this->get_node_base_interface();
-        std::string left_topic =
-          node_base->resolve_topic_or_service_name("left/image_rect", false);
-        std::string right_topic =
-          node_base->resolve_topic_or_service_name("right/image_rect", false);
-        // Allow also remapping camera_info to something different than default
-        std::string left_info_topic =
-          node_base->resolve_topic_or_service_name(
-          image_transport::getCameraInfoTopic(left_topic), false);
-        std::string right_info_topic =
-          node_base->resolve_topic_or_service_name(
-          image_transport::getCameraInfoTopic(right_topic), false);
-
-        // REP-2003 specifies that subscriber should be SensorDataQoS
-        const auto sensor_data_qos = rclcpp::SensorDataQoS();
-
-        // Support image transport for compression
-        image_transport::TransportHints hints(this);
-
-        // Allow overriding QoS settings (history, depth, reliability)
-        auto sub_opts = rclcpp::SubscriptionOptions();
-        sub_opts.qos_overriding_options = rclcpp::QosOverridingOptions::with_default_policies();
-
-        sub_l_image_.subscribe(
-          this, left_topic, hints.getTransport(), sensor_data_qos.get_rmw_qos_profile(), sub_opts);
-        sub_l_info_.subscribe(this, left_info_topic,
-          sensor_data_qos, sub_opts);
-        sub_r_image_.subscribe(
-          this, right_topic, hints.getTransport(), sensor_data_qos.get_rmw_qos_profile(), sub_opts);
-        sub_r_info_.subscribe(this, right_info_topic,
-          sensor_data_qos, sub_opts);
-      }
-    };
+    [this](rclcpp::MatchedInfo &) {connectCb();};
 
   pub_disparity_ = create_publisher<stereo_msgs::msg::DisparityImage>("disparity", 1, pub_opts);
+  pub_depth_ = create_publisher<sensor_msgs::msg::Image>("depth", 1, pub_opts);
+}
+
+DisparityNode::~DisparityNode()
+{
+  if (match_queue_) {
+    match_queue_->close();
+    publish_queue_->close();
+    match_thread_.join();
+    publish_thread_.join();
+  }
+}
+
+void DisparityNode::connectCb()
+{
+  std::lock_guard<std::mutex> lock(connect_mutex_);
+  // Called for both publishers, possibly before the second one is created
+  if (pub_disparity_->get_subscription_count() == 0u &&
+    (!pub_depth_ || pub_depth_->get_subscription_count() == 0u))
+  {
+    sub_l_image_.unsubscribe();
+    sub_l_info_.unsubscribe();
+    sub_r_image_.unsubscribe();
+    sub_r_info_.unsubscribe();
+  } else if (!sub_l_image_.getSubscriber()) {
+    // For compressed topics to remap appropriately, we need to pass a
+    // fully expanded and remapped topic name to image_transport
+    auto node_base = this->get_node_base_interface();
+    std::string left_topic =
+      node_base->resolve_topic_or_service_name("left/image_rect", false);
+    std::string right_topic =
+      node_base->resolve_topic_or_service_name("right/image_rect", false);
+    // Allow also remapping camera_info to something different than default
+    std::string left_info_topic =
+      node_base->resolve_topic_or_service_name(
+      image_transport::getCameraInfoTopic(left_topic), false);
+    std::string right_info_topic =
+      node_base->resolve_topic_or_service_name(
+      image_transport::getCameraInfoTopic(right_topic), false);
+
+    // REP-2003 specifies that subscriber should be SensorDataQoS
+    const auto sensor_data_qos = latest_only_->qos(rclcpp::SensorDataQoS());
+
+    // Support image transport for compression
+    image_transport::TransportHints hints(this);
+
+    // Allow overriding QoS settings (history, depth, reliability)
+    auto sub_opts = rclcpp::SubscriptionOptions();
+    sub_opts.qos_overriding_options = rclcpp::QosOverridingOptions::with_default_policies();
+
+    sub_l_image_.subscribe(
+      this, left_topic, hints.getTransport(), sensor_data_qos.get_rmw_qos_profile(), sub_opts);
+    sub_l_info_.subscribe(this, left_info_topic,
+      sensor_data_qos, sub_opts);
+    sub_r_image_.subscribe(
+      this, right_topic, hints.getTransport(), sensor_data_qos.get_rmw_qos_profile(), sub_opts);
+    sub_r_info_.subscribe(this, right_info_topic,
+      sensor_data_qos, sub_opts);
+  }
 }
 
 void DisparityNode::imageCb(
@@ -344,18 +429,92 @@ void DisparityNode::imageCb(
   const sensor_msgs::msg::Image::ConstSharedPtr & r_image_msg,
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr & r_info_msg)
 {
-  // If there are no subscriptions for the disparity image, do nothing
-  if (pub_disparity_->get_subscription_count() == 0u) {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "stereo_image_proc/disparity", l_image_msg.get(),
+    l_image_msg->width, l_image_msg->height, l_image_msg->encoding.c_str());
+  const auto start = std::chrono::steady_clock::now();
+
+  if (!latest_only_->admit(l_image_msg->header.stamp, *processing_)) {
     return;
   }
 
+  // If there are no subscriptions for the disparity or depth image, do nothing
+  if (pub_disparity_->get_subscription_count() == 0u &&
+    pub_depth_->get_subscription_count() == 0u)
+  {
+    processing_->skipped();
+    return;
+  }
+
+  // Create cv::Mat views onto all buffers
+  Frame frame;
+  frame.start = start;
+  frame.l_info_msg = l_info_msg;
+  frame.r_info_msg = r_info_msg;
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "convert", l_image_msg.get());
+    // Shared with the other nodes of the process converting the same images
+    auto & conversions = image_proc::ConversionCache::instance();
+    frame.l_image = conversions.toCvShare(l_image_msg, sensor_msgs::image_encodings::MONO8);
+    frame.r_image = conversions.toCvShare(r_image_msg, sensor_msgs::image_encodings::MONO8);
+  }
+
+  if (match_queue_) {
+    if (!match_queue_->push(std::move(frame))) {
+      processing_->dropped();
+      RCLCPP_DEBUG(get_logger(), "Matching is behind, dropped a stereo pair");
+    }
+    return;
+  }
+
+  Output output;
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", l_image_msg.get());
+    output = match(frame);
+  }
+
+  tracetools_image_pipeline::StageTrace stage(this, "publish", l_image_msg.get());
+  publish(std::move(output));
+}
+
+DisparityNode::Output DisparityNode::match(const Frame & frame)
+{
+  std::lock_guard<std::mutex> lock(matcher_mutex_);
+
+  // Reconfigure the matcher only if a parameter changed since the last pair
+  const auto config = matcher_config_.get();
+  if (config != applied_config_) {
+    configureMatcher(*config, applied_config_.get(), block_matcher_);
+    applied_config_ = config;
+  }
+
   // Update the camera model
-  model_.fromCameraInfo(l_info_msg, r_info_msg);
+  model_ = image_proc::CameraCache::instance().stereoModel(*frame.l_info_msg, *frame.r_info_msg);
+
+  // Allocate new disparity image message, uniquely owned so that intra-process
+  // subscribers take it without a copy
+  auto disp_msg = std::make_unique<stereo_msgs::msg::DisparityImage>();
+  disp_msg->header = frame.l_info_msg->header;
+  disp_msg->image.header = frame.l_info_msg->header;
+
+  // The depth image comes out of the same pass, if anyone takes it
+  sensor_msgs::msg::Image::UniquePtr depth_msg;
+  if (pub_depth_->get_subscription_count() > 0u) {
+    depth_msg = std::make_unique<sensor_msgs::msg::Image>();
+    depth_msg->header = frame.l_info_msg->header;
+    depth_msg->encoding = depth_encoding_;
+  }
 
-  // Allocate new disparity image message
-  auto disp_msg = std::make_shared<stereo_msgs::msg::DisparityImage>();
-  disp_msg->header = l_info_msg->header;
-  disp_msg->image.header = l_info_msg->header;
+  // Perform block matching to find the disparities, only in the requested window
+  const cv::Mat_<uint8_t> l_image = frame.l_image->image;
+  const cv::Mat_<uint8_t> r_image = frame.r_image->image;
+  const cv::Rect window = roi_->window(l_image.size());
+  if (window.size() == l_image.size()) {
+    block_matcher_.processDisparity(l_image, r_image, *model_, *disp_msg, depth_msg.get());
+  } else {
+    block_matcher_.processDisparity(
+      l_image, r_image, *model_, window, *disp_msg, depth_msg.get());
+  }
 
   // Compute window of (potentially) valid disparities
   int border = block_matcher_.getCorrelationWindowSize() / 2;
@@ -366,25 +525,30 @@ void DisparityNode::imageCb(
   } else {
     wtf = std::max(border, -block_matcher_.getMinDisparity());
   }
-  // TODO(jacobperron): the message width has not been set yet! What should we do here?
-  int right = disp_msg->image.width - 1 - wtf;
+  int right = l_image.cols - 1 - wtf;
   int top = border;
-  int bottom = disp_msg->image.height - 1 - border;
-  disp_msg->valid_window.x_offset = left;
-  disp_msg->valid_window.y_offset = top;
-  disp_msg->valid_window.width = right - left;
-  disp_msg->valid_window.height = bottom - top;
-
-  // Create cv::Mat views onto all buffers
-  const cv::Mat_<uint8_t> l_image =
-    cv_bridge::toCvShare(l_image_msg, sensor_msgs::image_encodings::MONO8)->image;
-  const cv::Mat_<uint8_t> r_image =
-    cv_bridge::toCvShare(r_image_msg, sensor_msgs::image_encodings::MONO8)->image;
-
-  // Perform block matching to find the disparities
-  block_matcher_.processDisparity(l_image, r_image, model_, *disp_msg);
+  int bottom = l_image.rows - 1 - border;
+  const cv::Rect valid = cv::Rect(left, top, right - left, bottom - top) & window;
+  disp_msg->valid_window.x_offset = valid.x;
+  disp_msg->valid_window.y_offset = valid.y;
+  disp_msg->valid_window.width = valid.width;
+  disp_msg->valid_window.height = valid.height;
+
+  Output output;
+  output.disp_msg = std::move(disp_msg);
+  output.depth_msg = std::move(depth_msg);
+  output.start = frame.start;
+  return output;
+}
 
-  pub_disparity_->publish(*disp_msg);
+void DisparityNode::publish(Output output)
+{
+  const auto stamp = output.disp_msg->header.stamp;
+  if (output.depth_msg) {
+    pub_depth_->publish(std::move(output.depth_msg));
+  }
+  pub_disparity_->publish(std::move(output.disp_msg));
+  processing_->published(output.start, stamp);
 }
 
 rcl_interfaces::msg::SetParametersResult DisparityNode::parameterSetCb(
@@ -392,51 +556,49 @@ rcl_interfaces::msg::SetParametersResult DisparityNode::parameterSetCb(
 {
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
+  // Never waits for the pair being matched
+  MatcherConfig config = *matcher_config_.get();
   for (const auto & param : parameters) {
-    const std::string param_name = param.get_name();
-    if ("stereo_algorithm" == param_name) {
-      const int stereo_algorithm_value = param.as_int();
-      if (BLOCK_MATCHING == stereo_algorithm_value) {
-        block_matcher_.setStereoType(StereoProcessor::BM);
-      } else if (SEMI_GLOBAL_BLOCK_MATCHING == stereo_algorithm_value) {
-        block_matcher_.setStereoType(StereoProcessor::SGBM);
-      } else {
-        result.successful = false;
-        std::ostringstream oss;
-        oss << "Unknown stereo algorithm type '" << stereo_algorithm_value << "'";
-        result.reason = oss.str();
-      }
-    } else if ("prefilter_size" == param_name) {
-      block_matcher_.setPreFilterSize(param.as_int());
-    } else if ("prefilter_cap" == param_name) {
-      block_matcher_.setPreFilterCap(param.as_int());
-    } else if ("correlation_window_size" == param_name) {
-      block_matcher_.setCorrelationWindowSize(param.as_int());
-    } else if ("min_disparity" == param_name) {
-      block_matcher_.setMinDisparity(param.as_int());
-    } else if ("disparity_range" == param_name) {
-      block_matcher_.setDisparityRange(param.as_int());
-    } else if ("uniqueness_ratio" == param_name) {
-      block_matcher_.setUniquenessRatio(param.as_double());
-    } else if ("texture_threshold" == param_name) {
-      block_matcher_.setTextureThreshold(param.as_int());
-    } else if ("speckle_size" == param_name) {
-      block_matcher_.setSpeckleSize(param.as_int());
-    } else if ("speckle_range" == param_name) {
-      block_matcher_.setSpeckleRange(param.as_int());
-    } else if ("sgbm_mode" == param_name) {
-      block_matcher_.setSgbmMode(param.as_int());
-    } else if ("P1" == param_name) {
-      block_matcher_.setP1(param.as_double());
-    } else if ("P2" == param_name) {
-      block_matcher_.setP2(param.as_double());
-    } else if ("disp12_max_diff" == param_name) {
-      block_matcher_.setDisp12MaxDiff(param.as_int());
-    }
+    updateMatcherConfig(param, get_logger(), config, result);
+  }
+  if (result.successful) {
+    matcher_config_.set(config);
   }
   return result;
 }
 
+void DisparityNode::coarseToFineDiagnostics(
+  diagnostic_updater::DiagnosticStatusWrapper & status)
+{
+  std::vector<CoarseToFineLevel> levels;
+  {
+    std::lock_guard<std::mutex> lock(matcher_mutex_);
+    levels = block_matcher_.getCoarseToFineStats();
+  }
+  if (levels.empty()) {
+    status.summary(diagnostic_msgs::msg::DiagnosticStatus::OK, "Disabled");
+    return;
+  }
+
+  // Levels are numbered by how many times they were downsampled
+  double milliseconds = 0.0;
+  double inverse_speedup = 0.0;
+  for (size_t i = 0; i < levels.size(); ++i) {
+    const CoarseToFineLevel & level = levels[i];
+    const std::string name = "Level " + std::to_string(levels.size() - 1 - i);
+    status.addf(name + " size", "%dx%d", level.size.width, level.size.height);
+    status.addf(name + " disparities searched", "%.1f", level.disparities);
+    status.addf(name + " time (ms)", "%.2f", level.milliseconds);
+    status.addf(name + " speedup", "%.1f", level.speedup);
+    milliseconds += level.milliseconds;
+    inverse_speedup += 1.0 / level.speedup;
+  }
+  status.addf("Total time (ms)", "%.2f", milliseconds);
+  status.addf("Total speedup", "%.1f", 1.0 / inverse_speedup);
+  status.summaryf(
+    diagnostic_msgs::msg::DiagnosticStatus::OK, "Matching over %zu levels", levels.size());
+}
+
 }  // namespace stereo_image_proc
 
 // Register component
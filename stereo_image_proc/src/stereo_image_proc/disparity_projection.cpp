@@ -0,0 +1,273 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <stereo_image_proc/disparity_projection.hpp>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+
+namespace stereo_image_proc
+{
+
+namespace
+{
+
+// Byte offset in every point of the field called name, or -1
+int fieldOffset(const sensor_msgs::msg::PointCloud2 & points, const std::string & name)
+{
+  for (const auto & field : points.fields) {
+    if (field.name == name) {
+      return static_cast<int>(field.offset);
+    }
+  }
+  return -1;
+}
+
+// Packs a row of pixels as the bytes of rgb fields: blue, green, red, unused
+void packColorRow(
+  const uint8_t * row, int width, int channels, int red, int green, int blue, uint32_t * out)
+{
+  for (int u = 0; u < width; ++u, row += channels) {
+    out[u] = (static_cast<uint32_t>(row[red]) << 16) |
+      (static_cast<uint32_t>(row[green]) << 8) | row[blue];
+  }
+}
+
+// Rows of Q folded with the row coordinate v, the first column u0 of the row
+// and the disparity unit delta_d: component i of the homogeneous point of
+// (u0 + u, v, d) is q[i][0] * u + q[i][1] * d + q[i][2], with d in units of
+// delta_d
+struct RowTransform
+{
+  float q[4][3];
+
+  RowTransform(const cv::Matx44d & Q, int u0, int v, double delta_d)
+  {
+    for (int i = 0; i < 4; ++i) {
+      q[i][0] = static_cast<float>(Q(i, 0));
+      q[i][1] = static_cast<float>(Q(i, 2) * delta_d);
+      q[i][2] = static_cast<float>(Q(i, 0) * u0 + Q(i, 1) * v + Q(i, 3));
+    }
+  }
+};
+
+#if CV_SIMD128
+inline cv::v_float32x4 loadDisparity(const float * disparity)
+{
+  return cv::v_load(disparity);
+}
+
+inline cv::v_float32x4 loadDisparity(const int16_t * disparity)
+{
+  return cv::v_cvt_f32(cv::v_load_expand(disparity));
+}
+#endif
+
+// Writes the point of every disparity of a row as x, y and z floats at the
+// start of every point_step bytes of out, and the packed colors, if any, at
+// rgb_offset. Rows of 12 byte xyz points, or of 16 byte xyz points followed
+// by padding or rgb, are stored four points at a time.
+template<typename T>
+void projectRow(
+  const T * disparity, int width, const RowTransform & t, float min_disparity,
+  const uint32_t * colors, uint8_t * out, int point_step, int rgb_offset)
+{
+  const float bad_point = std::numeric_limits<float>::quiet_NaN();
+  int u = 0;
+  // First point whose color is still to be written
+  int color_start = 0;
+#if CV_SIMD128
+  if (point_step == 12 || point_step == 16) {
+    float * points = reinterpret_cast<float *>(out);
+    const bool color_last = colors && rgb_offset == 12;
+    const cv::v_float32x4 v_bad = cv::v_setall_f32(bad_point);
+    const cv::v_float32x4 v_min = cv::v_setall_f32(min_disparity);
+    const cv::v_float32x4 v_eps = cv::v_setall_f32(FLT_EPSILON);
+    const cv::v_float32x4 v_inf = cv::v_setall_f32(std::numeric_limits<float>::infinity());
+    const cv::v_float32x4 v_one = cv::v_setall_f32(1.0f);
+    const cv::v_float32x4 v_step = cv::v_setall_f32(4.0f);
+    cv::v_float32x4 v_u(0.0f, 1.0f, 2.0f, 3.0f);
+    cv::v_float32x4 q[4][3];
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        q[i][j] = cv::v_setall_f32(t.q[i][j]);
+      }
+    }
+    for (; u + 4 <= width; u += 4, v_u = v_u + v_step) {
+      const cv::v_float32x4 d = loadDisparity(disparity + u);
+      const cv::v_float32x4 inv_w =
+        v_one / cv::v_muladd(q[3][0], v_u, cv::v_muladd(q[3][1], d, q[3][2]));
+      cv::v_float32x4 x = cv::v_muladd(q[0][0], v_u, cv::v_muladd(q[0][1], d, q[0][2])) * inv_w;
+      cv::v_float32x4 y = cv::v_muladd(q[1][0], v_u, cv::v_muladd(q[1][1], d, q[1][2])) * inv_w;
+      cv::v_float32x4 z = cv::v_muladd(q[2][0], v_u, cv::v_muladd(q[2][1], d, q[2][2])) * inv_w;
+      // Neither missing nor projected to infinity
+      const cv::v_float32x4 valid = (cv::v_abs(d - v_min) > v_eps) & (cv::v_abs(z) < v_inf);
+      x = cv::v_select(valid, x, v_bad);
+      y = cv::v_select(valid, y, v_bad);
+      z = cv::v_select(valid, z, v_bad);
+      if (point_step == 12) {
+        cv::v_store_interleave(points + 3 * u, x, y, z);
+      } else {
+        const cv::v_float32x4 last = color_last ?
+          cv::v_reinterpret_as_f32(cv::v_load(colors + u)) : cv::v_setzero_f32();
+        cv::v_store_interleave(points + 4 * u, x, y, z, last);
+      }
+    }
+    if (color_last) {
+      color_start = u;
+    }
+  }
+#endif
+  for (; u < width; ++u) {
+    const float d = static_cast<float>(disparity[u]);
+    const float inv_w = 1.0f / (t.q[3][0] * u + t.q[3][1] * d + t.q[3][2]);
+    float point[3];
+    for (int i = 0; i < 3; ++i) {
+      point[i] = (t.q[i][0] * u + t.q[i][1] * d + t.q[i][2]) * inv_w;
+    }
+    if (std::fabs(d - min_disparity) <= FLT_EPSILON || !std::isfinite(point[2])) {
+      point[0] = point[1] = point[2] = bad_point;
+    }
+    std::memcpy(out + u * point_step, point, sizeof(point));
+  }
+  if (colors) {
+    for (u = color_start; u < width; ++u) {
+      std::memcpy(out + u * point_step + rgb_offset, colors + u, sizeof(uint32_t));
+    }
+  }
+}
+
+}  // namespace
+
+bool projectDisparityToCloud(
+  const stereo_msgs::msg::DisparityImage & disparity,
+  const sensor_msgs::msg::Image::ConstSharedPtr & color,
+  const image_geometry::StereoCameraModel & model,
+  sensor_msgs::msg::PointCloud2 & points)
+{
+  const cv::Rect window(
+    0, 0, static_cast<int>(disparity.image.width), static_cast<int>(disparity.image.height));
+  return projectDisparityToCloud(disparity, color, model, window, points);
+}
+
+bool projectDisparityToCloud(
+  const stereo_msgs::msg::DisparityImage & disparity,
+  const sensor_msgs::msg::Image::ConstSharedPtr & color,
+  const image_geometry::StereoCameraModel & model,
+  const cv::Rect & window,
+  sensor_msgs::msg::PointCloud2 & points)
+{
+  const sensor_msgs::msg::Image & dimage = disparity.image;
+  const int width = window.width;
+  const int height = window.height;
+  if (window.area() == 0) {
+    return true;
+  }
+
+  // Float disparities, or fixed point ones in units of delta_d
+  const bool fixed_point = dimage.encoding == sensor_msgs::image_encodings::TYPE_16SC1;
+  const double delta_d = fixed_point ? disparity.delta_d : 1.0;
+
+  // Same missing value as projectDisparityImageTo3d: the smallest disparity
+  const cv::Mat dmat(
+    dimage.height, dimage.width, fixed_point ? CV_16SC1 : CV_32FC1,
+    const_cast<uint8_t *>(&dimage.data[0]), dimage.step);
+  double min_disparity = 0.0;
+  cv::minMaxLoc(dmat(window), &min_disparity);
+
+  // Channel of red, green and blue in every pixel of color
+  namespace enc = sensor_msgs::image_encodings;
+  int channels = 0, red = 0, green = 0, blue = 0;
+  const int rgb_offset = fieldOffset(points, "rgb");
+  bool supported = true;
+  if (color && rgb_offset >= 0) {
+    const std::string & encoding = color->encoding;
+    if (encoding == enc::MONO8) {
+      channels = 1;
+    } else if (encoding == enc::RGB8 || encoding == enc::RGBA8) {
+      channels = encoding == enc::RGB8 ? 3 : 4;
+      green = 1;
+      blue = 2;
+    } else if (encoding == enc::BGR8 || encoding == enc::BGRA8) {
+      channels = encoding == enc::BGR8 ? 3 : 4;
+      red = 2;
+      green = 1;
+    } else {
+      supported = false;
+    }
+  }
+
+  const cv::Matx44d & Q = model.reprojectionMatrix();
+  const size_t disparity_size = fixed_point ? sizeof(int16_t) : sizeof(float);
+  const int point_step = static_cast<int>(points.point_step);
+  cv::parallel_for_(
+    cv::Range(0, height), [&](const cv::Range & range) {
+      std::vector<uint32_t> colors;
+      if (rgb_offset >= 0 && color) {
+        colors.resize(width, 0);
+      }
+      for (int row = range.start; row < range.end; ++row) {
+        const int v = window.y + row;
+        if (channels > 0) {
+          packColorRow(
+            &color->data[v * color->step + window.x * channels], width, channels,
+            red, green, blue, colors.data());
+        }
+        const uint8_t * disparity_row = &dimage.data[v * dimage.step + window.x * disparity_size];
+        const RowTransform t(Q, window.x, v, delta_d);
+        const uint32_t * row_colors = colors.empty() ? nullptr : colors.data();
+        uint8_t * out = &points.data[row * points.row_step];
+        if (fixed_point) {
+          projectRow(
+            reinterpret_cast<const int16_t *>(disparity_row), width, t,
+            static_cast<float>(min_disparity), row_colors, out, point_step, rgb_offset);
+        } else {
+          projectRow(
+            reinterpret_cast<const float *>(disparity_row), width, t,
+            static_cast<float>(min_disparity), row_colors, out, point_step, rgb_offset);
+        }
+      }
+    });
+  return supported;
+}
+
+}  // namespace stereo_image_proc
@@ -0,0 +1,338 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <stereo_image_proc/matcher_parameters.hpp>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace stereo_image_proc
+{
+
+namespace
+{
+
+enum StereoAlgorithm
+{
+  BLOCK_MATCHING = 0,
+  SEMI_GLOBAL_BLOCK_MATCHING,
+  CUDA_BLOCK_MATCHING,
+  CUDA_SEMI_GLOBAL_MATCHING
+};
+
+// Some helper functions for adding a parameter to a collection
+void add_param_to_map(
+  std::map<std::string, std::pair<int, rcl_interfaces::msg::ParameterDescriptor>> & parameters,
+  const std::string & name,
+  const std::string & description,
+  const int default_value,
+  const int from_value,
+  const int to_value,
+  const int step)
+{
+  rcl_interfaces::msg::IntegerRange integer_range;
+  integer_range.from_value = from_value;
+  integer_range.to_value = to_value;
+  integer_range.step = step;
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.description = description;
+  descriptor.integer_range = {integer_range};
+  parameters[name] = std::make_pair(default_value, descriptor);
+}
+
+void add_param_to_map(
+  std::map<std::string, std::pair<double, rcl_interfaces::msg::ParameterDescriptor>> & parameters,
+  const std::string & name,
+  const std::string & description,
+  const double default_value,
+  const double from_value,
+  const double to_value,
+  const double step)
+{
+  rcl_interfaces::msg::FloatingPointRange floating_point_range;
+  floating_point_range.from_value = from_value;
+  floating_point_range.to_value = to_value;
+  floating_point_range.step = step;
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.description = description;
+  descriptor.floating_point_range = {floating_point_range};
+  parameters[name] = std::make_pair(default_value, descriptor);
+}
+
+// Calls visit(field, setter) with the MatcherConfig field and the
+// StereoProcessor setter of every matcher parameter
+template<typename Visit>
+void forEachSetting(Visit visit)
+{
+  visit(&MatcherConfig::stereo_type, &StereoProcessor::setStereoType);
+  visit(&MatcherConfig::prefilter_size, &StereoProcessor::setPreFilterSize);
+  visit(&MatcherConfig::prefilter_cap, &StereoProcessor::setPreFilterCap);
+  visit(&MatcherConfig::correlation_window_size, &StereoProcessor::setCorrelationWindowSize);
+  visit(&MatcherConfig::min_disparity, &StereoProcessor::setMinDisparity);
+  visit(&MatcherConfig::disparity_range, &StereoProcessor::setDisparityRange);
+  visit(&MatcherConfig::uniqueness_ratio, &StereoProcessor::setUniquenessRatio);
+  visit(&MatcherConfig::texture_threshold, &StereoProcessor::setTextureThreshold);
+  visit(&MatcherConfig::speckle_size, &StereoProcessor::setSpeckleSize);
+  visit(&MatcherConfig::speckle_range, &StereoProcessor::setSpeckleRange);
+  visit(&MatcherConfig::sgbm_mode, &StereoProcessor::setSgbmMode);
+  visit(&MatcherConfig::p1, &StereoProcessor::setP1);
+  visit(&MatcherConfig::p2, &StereoProcessor::setP2);
+  visit(&MatcherConfig::disp12_max_diff, &StereoProcessor::setDisp12MaxDiff);
+  visit(&MatcherConfig::adaptive_range, &StereoProcessor::setAdaptiveRange);
+  visit(&MatcherConfig::adaptive_range_bands, &StereoProcessor::setAdaptiveBands);
+  visit(&MatcherConfig::fixed_point_disparity, &StereoProcessor::setFixedPointDisparity);
+  visit(&MatcherConfig::coarse_to_fine_levels, &StereoProcessor::setCoarseToFineLevels);
+  visit(&MatcherConfig::fused_post_filter, &StereoProcessor::setFusedPostFilter);
+  visit(&MatcherConfig::left_right_check, &StereoProcessor::setLeftRightCheck);
+  visit(&MatcherConfig::left_right_max_diff, &StereoProcessor::setLeftRightMaxDiff);
+  visit(&MatcherConfig::stripe_rows, &StereoProcessor::setStripeRows);
+  visit(&MatcherConfig::parallel_stripes, &StereoProcessor::setParallelStripes);
+}
+
+}  // namespace
+
+void declareMatcherParameters(rclcpp::Node & node)
+{
+  // Describe int parameters
+  std::map<std::string, std::pair<int, rcl_interfaces::msg::ParameterDescriptor>> int_params;
+  add_param_to_map(
+    int_params,
+    "stereo_algorithm",
+    "Stereo algorithm: Block Matching (0), Semi-Global Block Matching (1), "
+    "or their CUDA counterparts (2, 3)",
+    0, 0, 3, 1);  // default, from, to, step
+  add_param_to_map(
+    int_params,
+    "prefilter_size",
+    "Normalization window size in pixels (must be odd)",
+    9, 5, 255, 2);
+  add_param_to_map(
+    int_params,
+    "prefilter_cap",
+    "Bound on normalized pixel values",
+    31, 1, 63, 1);
+  add_param_to_map(
+    int_params,
+    "correlation_window_size",
+    "SAD correlation window width in pixels (must be odd)",
+    15, 5, 255, 2);
+  add_param_to_map(
+    int_params,
+    "min_disparity",
+    "Disparity to begin search at in pixels",
+    0, -2048, 2048, 1);
+  add_param_to_map(
+    int_params,
+    "disparity_range",
+    "Number of disparities to search in pixels (must be a multiple of 16)",
+    64, 32, 4096, 16);
+  add_param_to_map(
+    int_params,
+    "texture_threshold",
+    "Filter out if SAD window response does not exceed texture threshold",
+    10, 0, 10000, 1);
+  add_param_to_map(
+    int_params,
+    "speckle_size",
+    "Reject regions smaller than this size in pixels",
+    100, 0, 1000, 1);
+  add_param_to_map(
+    int_params,
+    "speckle_range",
+    "Maximum allowed difference between detected disparities",
+    4, 0, 31, 1);
+  add_param_to_map(
+    int_params,
+    "disp12_max_diff",
+    "Maximum allowed difference in the left-right disparity check in pixels"
+    " (Semi-Global Block Matching only)",
+    0, 0, 128, 1);
+  add_param_to_map(
+    int_params,
+    "adaptive_range_bands",
+    "Number of horizontal bands matched with their own disparity range in adaptive mode",
+    8, 1, 64, 1);
+  add_param_to_map(
+    int_params,
+    "left_right_max_diff",
+    "Disparity in pixels by which a match may fall behind the one seen in its right image pixel",
+    1, 0, 128, 1);
+  add_param_to_map(
+    int_params,
+    "coarse_to_fine_levels",
+    "Number of times the pair is downsampled by two for coarse-to-fine matching, 0 to disable",
+    0, 0, 4, 1);
+  add_param_to_map(
+    int_params,
+    "stripe_rows",
+    "Number of rows of the stripes matched and reprojected one at a time, 0 for the whole image",
+    0, 0, 8192, 1);
+  add_param_to_map(
+    int_params,
+    "sgbm_mode",
+    "Mode of the SGBM stereo matcher."
+    "",
+    0, 0, 3, 1);
+
+  // Describe double parameters
+  std::map<std::string, std::pair<double, rcl_interfaces::msg::ParameterDescriptor>> double_params;
+  add_param_to_map(
+    double_params,
+    "uniqueness_ratio",
+    "Filter out if best match does not sufficiently exceed the next-best match",
+    15.0, 0.0, 100.0, 0.0);
+  add_param_to_map(
+    double_params,
+    "P1",
+    "The first parameter ccontrolling the disparity smoothness (Semi-Global Block Matching only)",
+    200.0, 0.0, 4000.0, 0.0);
+  add_param_to_map(
+    double_params,
+    "P2",
+    "The second parameter ccontrolling the disparity smoothness (Semi-Global Block Matching only)",
+    400.0, 0.0, 4000.0, 0.0);
+
+  node.declare_parameters("", int_params);
+  node.declare_parameters("", double_params);
+  node.declare_parameter("adaptive_range", false);
+  node.declare_parameter("fixed_point_disparity", false);
+  node.declare_parameter("fused_post_filter", false);
+  node.declare_parameter("left_right_check", false);
+  node.declare_parameter("parallel_stripes", false);
+}
+
+void updateMatcherConfig(
+  const rclcpp::Parameter & param, const rclcpp::Logger & logger,
+  MatcherConfig & config, rcl_interfaces::msg::SetParametersResult & result)
+{
+  const std::string param_name = param.get_name();
+  if ("stereo_algorithm" == param_name) {
+    const int stereo_algorithm_value = param.as_int();
+    if (BLOCK_MATCHING == stereo_algorithm_value) {
+      config.stereo_type = StereoProcessor::BM;
+    } else if (SEMI_GLOBAL_BLOCK_MATCHING == stereo_algorithm_value) {
+      config.stereo_type = StereoProcessor::SGBM;
+    } else if (CUDA_BLOCK_MATCHING == stereo_algorithm_value ||
+      CUDA_SEMI_GLOBAL_MATCHING == stereo_algorithm_value)
+    {
+      const bool sgm = CUDA_SEMI_GLOBAL_MATCHING == stereo_algorithm_value;
+      if (StereoProcessor::cudaAvailable()) {
+        config.stereo_type = sgm ? StereoProcessor::CUDA_SGM : StereoProcessor::CUDA_BM;
+      } else {
+        RCLCPP_WARN(
+          logger, "CUDA stereo matching requested, but OpenCV has no cudastereo module "
+          "or no CUDA device is available. Falling back to the CPU.");
+        config.stereo_type = sgm ? StereoProcessor::SGBM : StereoProcessor::BM;
+      }
+    } else {
+      result.successful = false;
+      std::ostringstream oss;
+      oss << "Unknown stereo algorithm type '" << stereo_algorithm_value << "'";
+      result.reason = oss.str();
+    }
+  } else if ("prefilter_size" == param_name) {
+    config.prefilter_size = param.as_int();
+  } else if ("prefilter_cap" == param_name) {
+    config.prefilter_cap = param.as_int();
+  } else if ("correlation_window_size" == param_name) {
+    config.correlation_window_size = param.as_int();
+  } else if ("min_disparity" == param_name) {
+    config.min_disparity = param.as_int();
+  } else if ("disparity_range" == param_name) {
+    config.disparity_range = param.as_int();
+  } else if ("uniqueness_ratio" == param_name) {
+    config.uniqueness_ratio = param.as_double();
+  } else if ("texture_threshold" == param_name) {
+    config.texture_threshold = param.as_int();
+  } else if ("speckle_size" == param_name) {
+    config.speckle_size = param.as_int();
+  } else if ("speckle_range" == param_name) {
+    config.speckle_range = param.as_int();
+  } else if ("sgbm_mode" == param_name) {
+    config.sgbm_mode = param.as_int();
+  } else if ("P1" == param_name) {
+    config.p1 = param.as_double();
+  } else if ("P2" == param_name) {
+    config.p2 = param.as_double();
+  } else if ("disp12_max_diff" == param_name) {
+    config.disp12_max_diff = param.as_int();
+  } else if ("adaptive_range" == param_name) {
+    config.adaptive_range = param.as_bool();
+  } else if ("adaptive_range_bands" == param_name) {
+    config.adaptive_range_bands = param.as_int();
+  } else if ("fixed_point_disparity" == param_name) {
+    config.fixed_point_disparity = param.as_bool();
+  } else if ("coarse_to_fine_levels" == param_name) {
+    config.coarse_to_fine_levels = param.as_int();
+  } else if ("fused_post_filter" == param_name) {
+    config.fused_post_filter = param.as_bool();
+  } else if ("left_right_check" == param_name) {
+    config.left_right_check = param.as_bool();
+  } else if ("left_right_max_diff" == param_name) {
+    config.left_right_max_diff = param.as_int();
+  } else if ("stripe_rows" == param_name) {
+    config.stripe_rows = param.as_int();
+  } else if ("parallel_stripes" == param_name) {
+    config.parallel_stripes = param.as_bool();
+  }
+}
+
+bool operator==(const MatcherConfig & a, const MatcherConfig & b)
+{
+  bool equal = true;
+  forEachSetting(
+    [&a, &b, &equal](auto field, auto) {
+      equal = equal && a.*field == b.*field;
+    });
+  return equal;
+}
+
+bool operator!=(const MatcherConfig & a, const MatcherConfig & b)
+{
+  return !(a == b);
+}
+
+void configureMatcher(
+  const MatcherConfig & config, const MatcherConfig * applied, StereoProcessor & processor)
+{
+  // Calls the setter of a field only when it changed, setters may rebuild matcher state
+  forEachSetting(
+    [&config, applied, &processor](auto field, auto setter) {
+      if (!applied || applied->*field != config.*field) {
+        (processor.*setter)(config.*field);
+      }
+    });
+}
+
+}  // namespace stereo_image_proc
@@ -30,9 +30,10 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
-#include <limits>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "image_geometry/stereo_camera_model.hpp"
 #include "message_filters/subscriber.hpp"
@@ -42,6 +43,13 @@
 #include "message_filters/sync_policies/exact_time.hpp"
 #include "rcutils/logging_macros.h"
 
+#include <image_proc/point_cloud_buffer_pool.hpp>
+#include <image_proc/camera_cache.hpp>
+#include <image_proc/latest_only.hpp>
+#include <image_proc/parameter_snapshot.hpp>
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_proc/region_of_interest.hpp>
+#include <image_proc/stamp_synchronizer.hpp>
 #include <image_transport/camera_common.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber_filter.hpp>
@@ -50,7 +58,9 @@
 #include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <stereo_image_proc/disparity_projection.hpp>
 #include <stereo_msgs/msg/disparity_image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
 
 namespace stereo_image_proc
 {
@@ -86,19 +96,52 @@ private:
   std::shared_ptr<ExactSync> exact_sync_;
   std::shared_ptr<ApproximateSync> approximate_sync_;
   std::shared_ptr<ApproximateEpsilonSync> approximate_epsilon_sync_;
+  using StampSync = image_proc::StampSynchronizer<
+    sensor_msgs::msg::Image,
+    sensor_msgs::msg::CameraInfo,
+    sensor_msgs::msg::CameraInfo,
+    stereo_msgs::msg::DisparityImage>;
+  std::unique_ptr<StampSync> stamp_sync_;
 
   // Publications
   std::shared_ptr<rclcpp::Publisher<sensor_msgs::msg::PointCloud2>> pub_points2_;
 
+  // Handle to parameters callback
+  rclcpp::Node::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_callback_handle_;
+
   // Processing state (note: only safe because we're single-threaded!)
-  image_geometry::StereoCameraModel model_;
-  cv::Mat_<cv::Vec3f> points_mat_;  // scratch buffer
+  // Shared with the other nodes of the process
+  std::shared_ptr<const image_geometry::StereoCameraModel> model_;
+  // Snapshot of the use_color and avoid_point_cloud_padding parameters
+  struct Config
+  {
+    bool use_color = true;
+    bool avoid_padding = false;
+  };
+  image_proc::ParameterSnapshot<Config> config_;
+  // Fields of the published clouds, and the use_color and
+  // avoid_point_cloud_padding values they are for
+  sensor_msgs::msg::PointCloud2 points_layout_;
+  int points_layout_key_ = -1;
+  // Clouds are uniquely owned with intra-process communication, so that
+  // subscribers in the same process take them without a copy, and borrowed
+  // from a shared pool otherwise
+  bool intra_process_;
 
   void imageCb(
     const sensor_msgs::msg::Image::ConstSharedPtr & l_image_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & l_info_msg,
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr & r_info_msg,
     const stereo_msgs::msg::DisparityImage::ConstSharedPtr & disp_msg);
+
+  rcl_interfaces::msg::SetParametersResult parameterSetCb(
+    const std::vector<rclcpp::Parameter> & parameters);
+
+  std::unique_ptr<image_proc::RegionOfInterest> roi_;
+  std::unique_ptr<image_proc::LatestOnly> latest_only_;
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+  // Publishes processing_ and the synchronization statistics, destroyed first
+  std::unique_ptr<diagnostic_updater::Updater> diagnostics_;
 };
 
 PointCloudNode::PointCloudNode(const rclcpp::NodeOptions & options)
@@ -110,9 +153,12 @@ PointCloudNode::PointCloudNode(const rclcpp::NodeOptions & options)
   this->declare_parameter<std::string>("image_transport", "raw");
 
   // Declare/read parameters
-  int queue_size = this->declare_parameter("queue_size", 5);
+  roi_ = std::make_unique<image_proc::RegionOfInterest>(this);
+  latest_only_ = std::make_unique<image_proc::LatestOnly>(this);
+  int queue_size = latest_only_->queueSize(this->declare_parameter("queue_size", 5));
   bool approx = this->declare_parameter("approximate_sync", false);
   double approx_sync_epsilon = this->declare_parameter("approximate_sync_tolerance_seconds", 0.0);
+  bool hardware_sync = this->declare_parameter("hardware_sync", false);
   rcl_interfaces::msg::ParameterDescriptor descriptor;
   // TODO(ivanpauno): Confirm if using point cloud padding in `sensor_msgs::msg::PointCloud2`
   // can improve performance in some cases or not.
@@ -120,11 +166,22 @@ PointCloudNode::PointCloudNode(const rclcpp::NodeOptions & options)
     "This parameter avoids using alignment padding in the generated point cloud."
     "This reduces bandwidth requirements, as the point cloud size is halved."
     "Using point clouds without alignment padding might degrade performance for some algorithms.";
-  this->declare_parameter("avoid_point_cloud_padding", false, descriptor);
-  this->declare_parameter("use_color", true);
+  Config config;
+  config.avoid_padding = this->declare_parameter("avoid_point_cloud_padding", false, descriptor);
+  config.use_color = this->declare_parameter("use_color", true);
+  config_.set(config);
+  intra_process_ = options.use_intra_process_comms();
+
+  // Keep the snapshot up to date, rather than reading parameters per frame
+  on_set_parameters_callback_handle_ = this->add_on_set_parameters_callback(
+    std::bind(&PointCloudNode::parameterSetCb, this, _1));
 
   // Synchronize callbacks
-  if (approx) {
+  if (hardware_sync) {
+    stamp_sync_ = std::make_unique<StampSync>(queue_size);
+    stamp_sync_->connectInput(sub_l_image_, sub_l_info_, sub_r_info_, sub_disparity_);
+    stamp_sync_->registerCallback(std::bind(&PointCloudNode::imageCb, this, _1, _2, _3, _4));
+  } else if (approx) {
     if (0.0 == approx_sync_epsilon) {
       approximate_sync_.reset(
         new ApproximateSync(
@@ -180,7 +237,7 @@ PointCloudNode::PointCloudNode(const rclcpp::NodeOptions & options)
           image_transport::getCameraInfoTopic(left_topic), false);
 
         // REP-2003 specifies that subscriber should be SensorDataQoS
-        const auto sensor_data_qos = rclcpp::SensorDataQoS();
+        const auto sensor_data_qos = latest_only_->qos(rclcpp::SensorDataQoS());
 
         // Support image transport for compression
         image_transport::TransportHints hints(this);
@@ -200,13 +257,13 @@ PointCloudNode::PointCloudNode(const rclcpp::NodeOptions & options)
       }
     };
   pub_points2_ = create_publisher<sensor_msgs::msg::PointCloud2>("points2", 1, pub_opts);
-}
 
-inline bool isValidPoint(const cv::Vec3f & pt)
-{
-  // Check both for disparities explicitly marked as invalid (where OpenCV maps pt.z to MISSING_Z)
-  // and zero disparities (point mapped to infinity).
-  return pt[2] != image_geometry::StereoCameraModel::MISSING_Z && !std::isinf(pt[2]);
+  diagnostics_ = std::make_unique<diagnostic_updater::Updater>(this);
+  diagnostics_->setHardwareID("none");
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this, *diagnostics_);
+  if (stamp_sync_) {
+    stamp_sync_->publishDiagnostics(*diagnostics_);
+  }
 }
 
 void PointCloudNode::imageCb(
@@ -215,143 +272,143 @@ void PointCloudNode::imageCb(
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr & r_info_msg,
   const stereo_msgs::msg::DisparityImage::ConstSharedPtr & disp_msg)
 {
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "stereo_image_proc/point_cloud", l_image_msg.get(),
+    l_image_msg->width, l_image_msg->height, l_image_msg->encoding.c_str());
+  image_proc::ProcessingDiagnostics::Frame frame(*processing_);
+
+  if (!latest_only_->admit(l_image_msg->header.stamp, frame)) {
+    return;
+  }
+
   // If there are no subscriptions for the point cloud, do nothing
   if (pub_points2_->get_subscription_count() == 0u) {
     return;
   }
 
   // Update the camera model
-  model_.fromCameraInfo(l_info_msg, r_info_msg);
+  model_ = image_proc::CameraCache::instance().stereoModel(*l_info_msg, *r_info_msg);
 
-  // Calculate point cloud
   const sensor_msgs::msg::Image & dimage = disp_msg->image;
-  // The cv::Mat_ constructor doesn't accept a const data data pointer
-  // so we remove the constness before reinterpreting into float.
-  // This is "safe" since our cv::Mat is const.
-  float * data = reinterpret_cast<float *>(const_cast<uint8_t *>(&dimage.data[0]));
-
-  const cv::Mat_<float> dmat(dimage.height, dimage.width, data, dimage.step);
-  model_.projectDisparityImageTo3d(dmat, points_mat_, true);
-  cv::Mat_<cv::Vec3f> mat = points_mat_;
-
-  // Fill in new PointCloud2 message (2D image-like layout)
-  auto points_msg = std::make_shared<sensor_msgs::msg::PointCloud2>();
-  points_msg->header = disp_msg->header;
-  points_msg->height = mat.rows;
-  points_msg->width = mat.cols;
-  points_msg->is_bigendian = false;
-  points_msg->is_dense = false;  // there may be invalid points
+  if (dimage.encoding != sensor_msgs::image_encodings::TYPE_32FC1 &&
+    dimage.encoding != sensor_msgs::image_encodings::TYPE_16SC1)
+  {
+    RCLCPP_ERROR(
+      get_logger(), "Disparity image has unsupported encoding [%s]", dimage.encoding.c_str());
+    return;
+  }
+  const auto config = config_.get();
+  const bool use_color = config->use_color;
+  const bool avoid_padding = config->avoid_padding;
+  if (use_color && (l_image_msg->width != dimage.width || l_image_msg->height != dimage.height)) {
+    RCLCPP_ERROR(
+      get_logger(), "Image size (%ux%u) does not match disparity size (%ux%u)",
+      l_image_msg->width, l_image_msg->height, dimage.width, dimage.height);
+    return;
+  }
 
-  sensor_msgs::PointCloud2Modifier pcd_modifier(*points_msg);
+  const int layout_key = (avoid_padding ? 2 : 0) + (use_color ? 1 : 0);
+  if (layout_key != points_layout_key_) {
+    sensor_msgs::PointCloud2Modifier pcd_modifier(points_layout_);
 
-  if (!this->get_parameter("avoid_point_cloud_padding").as_bool()) {
-    if (this->get_parameter("use_color").as_bool()) {
-      // Data will be packed as (DC=don't care, each item is a float):
-      //   x, y, z, DC, rgb, DC, DC, DC
-      // Resulting step size: 32 bytes
-      pcd_modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
-    } else {
-      // Data will be packed as:
-      //   x, y, z, DC
-      // Resulting step size: 16 bytes
-      pcd_modifier.setPointCloud2FieldsByString(1, "xyz");
-    }
-  } else {
-    if (this->get_parameter("use_color").as_bool()) {
-      // Data will be packed as:
-      //   x, y, z, rgb
-      // Resulting step size: 16 bytes
-      pcd_modifier.setPointCloud2Fields(
-        4,
-        "x", 1, sensor_msgs::msg::PointField::FLOAT32,
-        "y", 1, sensor_msgs::msg::PointField::FLOAT32,
-        "z", 1, sensor_msgs::msg::PointField::FLOAT32,
-        "rgb", 1, sensor_msgs::msg::PointField::FLOAT32);
+    if (!avoid_padding) {
+      if (use_color) {
+        // Data will be packed as (DC=don't care, each item is a float):
+        //   x, y, z, DC, rgb, DC, DC, DC
+        // Resulting step size: 32 bytes
+        pcd_modifier.setPointCloud2FieldsByString(2, "xyz", "rgb");
+      } else {
+        // Data will be packed as:
+        //   x, y, z, DC
+        // Resulting step size: 16 bytes
+        pcd_modifier.setPointCloud2FieldsByString(1, "xyz");
+      }
     } else {
-      // Data will be packed as:
-      //   x, y, z
-      // Resulting step size: 12 bytes
-      pcd_modifier.setPointCloud2Fields(
-        3,
-        "x", 1, sensor_msgs::msg::PointField::FLOAT32,
-        "y", 1, sensor_msgs::msg::PointField::FLOAT32,
-        "z", 1, sensor_msgs::msg::PointField::FLOAT32);
-    }
-  }
-
-  sensor_msgs::PointCloud2Iterator<float> iter_x(*points_msg, "x");
-  sensor_msgs::PointCloud2Iterator<float> iter_y(*points_msg, "y");
-  sensor_msgs::PointCloud2Iterator<float> iter_z(*points_msg, "z");
-
-  float bad_point = std::numeric_limits<float>::quiet_NaN();
-  for (int v = 0; v < mat.rows; ++v) {
-    for (int u = 0; u < mat.cols; ++u, ++iter_x, ++iter_y, ++iter_z) {
-      if (isValidPoint(mat(v, u))) {
-        // x,y,z
-        *iter_x = mat(v, u)[0];
-        *iter_y = mat(v, u)[1];
-        *iter_z = mat(v, u)[2];
+      if (use_color) {
+        // Data will be packed as:
+        //   x, y, z, rgb
+        // Resulting step size: 16 bytes
+        pcd_modifier.setPointCloud2Fields(
+          4,
+          "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+          "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+          "z", 1, sensor_msgs::msg::PointField::FLOAT32,
+          "rgb", 1, sensor_msgs::msg::PointField::FLOAT32);
       } else {
-        *iter_x = *iter_y = *iter_z = bad_point;
+        // Data will be packed as:
+        //   x, y, z
+        // Resulting step size: 12 bytes
+        pcd_modifier.setPointCloud2Fields(
+          3,
+          "x", 1, sensor_msgs::msg::PointField::FLOAT32,
+          "y", 1, sensor_msgs::msg::PointField::FLOAT32,
+          "z", 1, sensor_msgs::msg::PointField::FLOAT32);
       }
     }
+    points_layout_key_ = layout_key;
   }
 
-  if (this->get_parameter("use_color").as_bool()) {
-    sensor_msgs::PointCloud2Iterator<uint8_t> iter_r(*points_msg, "r");
-    sensor_msgs::PointCloud2Iterator<uint8_t> iter_g(*points_msg, "g");
-    sensor_msgs::PointCloud2Iterator<uint8_t> iter_b(*points_msg, "b");
-
-    // Fill in color
-    namespace enc = sensor_msgs::image_encodings;
-    const std::string & encoding = l_image_msg->encoding;
-    if (encoding == enc::MONO8) {
-      const cv::Mat_<uint8_t> color(
-        l_image_msg->height, l_image_msg->width,
-        const_cast<uint8_t *>(&l_image_msg->data[0]),
-        l_image_msg->step);
-      for (int v = 0; v < mat.rows; ++v) {
-        for (int u = 0; u < mat.cols; ++u, ++iter_r, ++iter_g, ++iter_b) {
-          uint8_t g = color(v, u);
-          *iter_r = *iter_g = *iter_b = g;
-        }
-      }
-    } else if (encoding == enc::RGB8) {
-      const cv::Mat_<cv::Vec3b> color(
-        l_image_msg->height, l_image_msg->width,
-        (cv::Vec3b *)(&l_image_msg->data[0]),
-        l_image_msg->step);
-      for (int v = 0; v < mat.rows; ++v) {
-        for (int u = 0; u < mat.cols; ++u, ++iter_r, ++iter_g, ++iter_b) {
-          const cv::Vec3b & rgb = color(v, u);
-          *iter_r = rgb[0];
-          *iter_g = rgb[1];
-          *iter_b = rgb[2];
-        }
-      }
-    } else if (encoding == enc::BGR8) {
-      const cv::Mat_<cv::Vec3b> color(
-        l_image_msg->height, l_image_msg->width,
-        (cv::Vec3b *)(&l_image_msg->data[0]),
-        l_image_msg->step);
-      for (int v = 0; v < mat.rows; ++v) {
-        for (int u = 0; u < mat.cols; ++u, ++iter_r, ++iter_g, ++iter_b) {
-          const cv::Vec3b & bgr = color(v, u);
-          *iter_r = bgr[2];
-          *iter_g = bgr[1];
-          *iter_b = bgr[0];
-        }
-      }
-    } else {
+  // Fill in new PointCloud2 message (2D image-like layout), of the requested
+  // window of the disparity image only
+  const cv::Rect window = roi_->window(
+    cv::Size(static_cast<int>(dimage.width), static_cast<int>(dimage.height)));
+  sensor_msgs::msg::PointCloud2::UniquePtr owned_msg;
+  sensor_msgs::msg::PointCloud2::SharedPtr pooled_msg;
+  if (intra_process_) {
+    owned_msg = std::make_unique<sensor_msgs::msg::PointCloud2>(points_layout_);
+    owned_msg->height = window.height;
+    owned_msg->width = window.width;
+    owned_msg->row_step = owned_msg->point_step * window.width;
+    owned_msg->data.resize(static_cast<size_t>(owned_msg->row_step) * window.height);
+  } else {
+    pooled_msg = image_proc::PointCloudBufferPool::instance().acquire(
+      points_layout_, window.height, window.width);
+  }
+  sensor_msgs::msg::PointCloud2 * points_msg = owned_msg ? owned_msg.get() : pooled_msg.get();
+  points_msg->header = disp_msg->header;
+  points_msg->is_dense = false;  // there may be invalid points
+
+  // Reproject the disparities and fill in color in a single pass
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "compute", l_image_msg.get());
+    if (!projectDisparityToCloud(
+        *disp_msg, use_color ? l_image_msg : nullptr, *model_, window, *points_msg))
+    {
       // Throttle duration in milliseconds
       RCUTILS_LOG_WARN_THROTTLE(
         RCUTILS_STEADY_TIME, 30000,
         "Could not fill color channel of the point cloud, "
-        "unsupported encoding '%s'", encoding.c_str());
+        "unsupported encoding '%s'", l_image_msg->encoding.c_str());
     }
   }
 
-  pub_points2_->publish(*points_msg);
+  {
+    tracetools_image_pipeline::StageTrace stage(this, "publish", l_image_msg.get());
+    if (owned_msg) {
+      pub_points2_->publish(std::move(owned_msg));
+    } else {
+      pub_points2_->publish(*pooled_msg);
+    }
+    frame.published(l_image_msg->header.stamp);
+  }
+}
+
+rcl_interfaces::msg::SetParametersResult PointCloudNode::parameterSetCb(
+  const std::vector<rclcpp::Parameter> & parameters)
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+  config_.update(
+    [&parameters](Config & config) {
+      for (const auto & param : parameters) {
+        if ("use_color" == param.get_name()) {
+          config.use_color = param.as_bool();
+        } else if ("avoid_point_cloud_padding" == param.get_name()) {
+          config.avoid_padding = param.as_bool();
+        }
+      }
+    });
+  return result;
 }
 
 }  // namespace stereo_image_proc
@@ -0,0 +1,290 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "image_geometry/stereo_camera_model.hpp"
+#include "message_filters/subscriber.hpp"
+#include "message_filters/synchronizer.hpp"
+#include "message_filters/sync_policies/exact_time.hpp"
+
+#include <stereo_image_proc/matcher_parameters.hpp>
+#include <stereo_image_proc/stereo_batch_processor.hpp>
+#include <stereo_image_proc/stereo_processor.hpp>
+
+#include <image_proc/processing_diagnostics.hpp>
+#include <image_transport/camera_common.hpp>
+#include <image_transport/image_transport.hpp>
+#include <image_transport/subscriber_filter.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_components/register_node_macro.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <stereo_msgs/msg/disparity_image.hpp>
+#include <tracetools_image_pipeline/scoped_trace.hpp>
+
+namespace stereo_image_proc
+{
+
+// Rectifies and matches the raw pairs of several stereo cameras on one shared
+// pool of threads, scheduled by the priority of every camera
+class StereoBatchNode : public rclcpp::Node
+{
+public:
+  explicit StereoBatchNode(const rclcpp::NodeOptions & options);
+
+private:
+  using ExactPolicy = message_filters::sync_policies::ExactTime<
+    sensor_msgs::msg::Image,
+    sensor_msgs::msg::CameraInfo,
+    sensor_msgs::msg::Image,
+    sensor_msgs::msg::CameraInfo>;
+  using ExactSync = message_filters::Synchronizer<ExactPolicy>;
+
+  // Topics and camera model of one stereo camera
+  struct Camera
+  {
+    std::string name;
+    image_transport::SubscriberFilter sub_l_image, sub_r_image;
+    message_filters::Subscriber<sensor_msgs::msg::CameraInfo> sub_l_info, sub_r_info;
+    std::shared_ptr<ExactSync> exact_sync;
+    std::shared_ptr<rclcpp::Publisher<stereo_msgs::msg::DisparityImage>> pub_disparity;
+    image_geometry::StereoCameraModel model;
+  };
+
+  void connectCb(size_t index, const rclcpp::MatchedInfo & info);
+
+  void imageCb(
+    size_t index,
+    const sensor_msgs::msg::Image::ConstSharedPtr & l_image_msg,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & l_info_msg,
+    const sensor_msgs::msg::Image::ConstSharedPtr & r_image_msg,
+    const sensor_msgs::msg::CameraInfo::ConstSharedPtr & r_info_msg);
+
+  rcl_interfaces::msg::SetParametersResult parameterSetCb(
+    const std::vector<rclcpp::Parameter> & parameters);
+
+  // Statistics of the pairs of all cameras, declared first so batch_ and its
+  // threads are gone before it is
+  std::unique_ptr<image_proc::ProcessingDiagnostics> processing_;
+  std::vector<std::unique_ptr<Camera>> cameras_;
+  std::unique_ptr<StereoBatchProcessor> batch_;
+  std::mutex connect_mutex_;
+  // Matcher parameters the processors are configured with, null before the first ones
+  std::unique_ptr<MatcherConfig> matcher_config_;
+
+  // Handle to parameters callback
+  rclcpp::Node::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_callback_handle_;
+};
+
+StereoBatchNode::StereoBatchNode(const rclcpp::NodeOptions & options)
+: rclcpp::Node("stereo_batch_node", options)
+{
+  using namespace std::placeholders;
+
+  // TransportHints does not actually declare the parameter
+  this->declare_parameter<std::string>("image_transport", "raw");
+
+  // Declare/read parameters
+  const int queue_size = this->declare_parameter("queue_size", 5);
+  const int threads = this->declare_parameter("threads", 0);
+  const auto names = this->declare_parameter("cameras", std::vector<std::string>());
+  const auto priorities = this->declare_parameter("priorities", std::vector<int64_t>());
+  const bool parallel_mono = this->declare_parameter("parallel_mono", true);
+  if (names.empty()) {
+    RCLCPP_WARN(get_logger(), "No stereo cameras given in the 'cameras' parameter");
+  }
+  if (!priorities.empty() && priorities.size() != names.size()) {
+    RCLCPP_WARN(
+      get_logger(), "Got %zu priorities for %zu cameras, the others have priority 0",
+      priorities.size(), names.size());
+  }
+
+  processing_ = std::make_unique<image_proc::ProcessingDiagnostics>(this);
+  batch_ = std::make_unique<StereoBatchProcessor>(threads);
+  for (size_t i = 0; i < names.size(); ++i) {
+    batch_->addPair(i < priorities.size() ? static_cast<int>(priorities[i]) : 0);
+    auto camera = std::make_unique<Camera>();
+    camera->name = names[i];
+    camera->exact_sync = std::make_shared<ExactSync>(
+      ExactPolicy(queue_size),
+      camera->sub_l_image, camera->sub_l_info,
+      camera->sub_r_image, camera->sub_r_info);
+    camera->exact_sync->registerCallback(
+      std::bind(&StereoBatchNode::imageCb, this, i, _1, _2, _3, _4));
+    cameras_.push_back(std::move(camera));
+  }
+  batch_->configure(
+    [parallel_mono](StereoProcessor & processor)
+    {
+      processor.setParallelMono(parallel_mono);
+    });
+
+  // Register a callback for when parameters are set, applied to every camera
+  on_set_parameters_callback_handle_ = this->add_on_set_parameters_callback(
+    std::bind(&StereoBatchNode::parameterSetCb, this, _1));
+
+  // Declaring parameters triggers the previously registered callback
+  declareMatcherParameters(*this);
+
+  // Publish the disparity of every camera in its namespace, subscribing to
+  // its images only while someone listens
+  for (size_t i = 0; i < cameras_.size(); ++i) {
+    rclcpp::PublisherOptions pub_opts;
+    pub_opts.qos_overriding_options = rclcpp::QosOverridingOptions::with_default_policies();
+    pub_opts.event_callbacks.matched_callback =
+      [this, i](rclcpp::MatchedInfo & s)
+      {
+        connectCb(i, s);
+      };
+    cameras_[i]->pub_disparity = create_publisher<stereo_msgs::msg::DisparityImage>(
+      cameras_[i]->name + "/disparity", 1, pub_opts);
+  }
+}
+
+void StereoBatchNode::connectCb(size_t index, const rclcpp::MatchedInfo & info)
+{
+  std::lock_guard<std::mutex> lock(connect_mutex_);
+  Camera & camera = *cameras_[index];
+  if (info.current_count == 0) {
+    camera.sub_l_image.unsubscribe();
+    camera.sub_l_info.unsubscribe();
+    camera.sub_r_image.unsubscribe();
+    camera.sub_r_info.unsubscribe();
+  } else if (!camera.sub_l_image.getSubscriber()) {
+    // For compressed topics to remap appropriately, we need to pass a
+    // fully expanded and remapped topic name to image_transport
+    auto node_base = this->get_node_base_interface();
+    std::string left_topic =
+      node_base->resolve_topic_or_service_name(camera.name + "/left/image_raw", false);
+    std::string right_topic =
+      node_base->resolve_topic_or_service_name(camera.name + "/right/image_raw", false);
+    std::string left_info_topic = image_transport::getCameraInfoTopic(left_topic);
+    std::string right_info_topic = image_transport::getCameraInfoTopic(right_topic);
+
+    // REP-2003 specifies that subscriber should be SensorDataQoS
+    const auto sensor_data_qos = rclcpp::SensorDataQoS();
+
+    // Support image transport for compression
+    image_transport::TransportHints hints(this);
+
+    camera.sub_l_image.subscribe(
+      this, left_topic, hints.getTransport(), sensor_data_qos.get_rmw_qos_profile());
+    camera.sub_l_info.subscribe(this, left_info_topic, sensor_data_qos);
+    camera.sub_r_image.subscribe(
+      this, right_topic, hints.getTransport(), sensor_data_qos.get_rmw_qos_profile());
+    camera.sub_r_info.subscribe(this, right_info_topic, sensor_data_qos);
+  }
+}
+
+void StereoBatchNode::imageCb(
+  size_t index,
+  const sensor_msgs::msg::Image::ConstSharedPtr & l_image_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & l_info_msg,
+  const sensor_msgs::msg::Image::ConstSharedPtr & r_image_msg,
+  const sensor_msgs::msg::CameraInfo::ConstSharedPtr & r_info_msg)
+{
+  tracetools_image_pipeline::ComponentTrace trace(
+    this, "stereo_image_proc/stereo_batch", l_image_msg.get(),
+    l_image_msg->width, l_image_msg->height, l_image_msg->encoding.c_str());
+  const auto start = std::chrono::steady_clock::now();
+
+  Camera & camera = *cameras_[index];
+
+  // If there are no subscriptions for the disparity image, do nothing
+  if (camera.pub_disparity->get_subscription_count() == 0u) {
+    processing_->skipped();
+    return;
+  }
+
+  // Update the camera model
+  camera.model.fromCameraInfo(l_info_msg, r_info_msg);
+
+  const std_msgs::msg::Header header = l_info_msg->header;
+  const void * traced_msg = l_image_msg.get();
+  const bool queued = batch_->submit(
+    index, l_image_msg, r_image_msg, camera.model, StereoProcessor::DISPARITY,
+    [this, &camera, header, traced_msg, start](bool ok, const StereoImageSet & output)
+    {
+      if (!ok) {
+        processing_->skipped();
+        RCLCPP_ERROR(
+          get_logger(), "Could not rectify the images of stereo camera '%s'",
+          camera.name.c_str());
+        return;
+      }
+      // Completes on a pool thread, after the component fini of the pair
+      tracetools_image_pipeline::StageTrace stage(this, "publish", traced_msg);
+      auto disp_msg = std::make_unique<stereo_msgs::msg::DisparityImage>(output.disparity);
+      disp_msg->header = header;
+      disp_msg->image.header = header;
+      camera.pub_disparity->publish(std::move(disp_msg));
+      processing_->published(start, header.stamp);
+    });
+  if (!queued) {
+    processing_->dropped();
+    RCLCPP_DEBUG(
+      get_logger(), "Stereo camera '%s' is behind, dropped a stereo pair", camera.name.c_str());
+  }
+}
+
+rcl_interfaces::msg::SetParametersResult StereoBatchNode::parameterSetCb(
+  const std::vector<rclcpp::Parameter> & parameters)
+{
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+  MatcherConfig config = matcher_config_ ? *matcher_config_ : MatcherConfig();
+  for (const auto & param : parameters) {
+    updateMatcherConfig(param, get_logger(), config, result);
+  }
+
+  // Only wait for the cameras being matched if a matcher parameter changed
+  if (result.successful && (!matcher_config_ || config != *matcher_config_)) {
+    batch_->configure(
+      [&](StereoProcessor & processor)
+      {
+        configureMatcher(config, matcher_config_.get(), processor);
+      });
+    matcher_config_ = std::make_unique<MatcherConfig>(config);
+  }
+  return result;
+}
+
+}  // namespace stereo_image_proc
+
+// Register component
+RCLCPP_COMPONENTS_REGISTER_NODE(stereo_image_proc::StereoBatchNode)
@@ -0,0 +1,184 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <stereo_image_proc/stereo_batch_processor.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace stereo_image_proc
+{
+
+StereoBatchProcessor::StereoBatchProcessor(size_t threads)
+{
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < threads; ++i) {
+    workers_.emplace_back(&StereoBatchProcessor::work, this);
+  }
+}
+
+StereoBatchProcessor::~StereoBatchProcessor()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (std::thread & worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t StereoBatchProcessor::addPair(int priority)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  pairs_.push_back(std::make_unique<Pair>());
+  pairs_.back()->priority = priority;
+  return pairs_.size() - 1;
+}
+
+size_t StereoBatchProcessor::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pairs_.size();
+}
+
+void StereoBatchProcessor::configure(const std::function<void(StereoProcessor &)> & configure)
+{
+  for (const auto & pair : pairs_) {
+    std::lock_guard<std::mutex> lock(pair->mutex);
+    configure(pair->processor);
+  }
+}
+
+bool StereoBatchProcessor::submit(
+  size_t index,
+  const sensor_msgs::msg::Image::ConstSharedPtr & left_raw,
+  const sensor_msgs::msg::Image::ConstSharedPtr & right_raw,
+  const image_geometry::StereoCameraModel & model,
+  int flags,
+  Callback done)
+{
+  Pair & pair = *pairs_[index];
+  if (pair.busy.exchange(true)) {
+    return false;
+  }
+  pair.left_raw = left_raw;
+  pair.right_raw = right_raw;
+  pair.model = model;
+  pair.flags = flags;
+  pair.done = std::move(done);
+  pair.ok[0] = pair.ok[1] = false;
+  pair.pending = 2;
+
+  uint64_t sequence;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sequence = sequence_++;
+  }
+  if (pair.processor.getParallelMono()) {
+    for (bool right : {false, true}) {
+      push(
+        {pair.priority, sequence, [this, &pair, right, sequence]() {
+            processMono(pair, right, sequence);
+          }});
+    }
+  } else {
+    push(
+      {pair.priority, sequence, [this, &pair, sequence]() {
+          processMono(pair, false, sequence);
+          processMono(pair, true, sequence);
+        }});
+  }
+  return true;
+}
+
+void StereoBatchProcessor::push(Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push(std::move(task));
+  }
+  condition_.notify_one();
+}
+
+void StereoBatchProcessor::work()
+{
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] {return stopping_ || !tasks_.empty();});
+      if (stopping_) {
+        return;
+      }
+      task = tasks_.top();
+      tasks_.pop();
+    }
+    task.run();
+  }
+}
+
+void StereoBatchProcessor::processMono(Pair & pair, bool right, uint64_t sequence)
+{
+  pair.ok[right] = pair.processor.processMono(
+    right ? pair.right_raw : pair.left_raw, pair.model, right, pair.output, pair.arena,
+    pair.flags);
+
+  // The last camera done queues the stereo stage, ahead of newer pairs
+  if (--pair.pending == 0) {
+    push({pair.priority, sequence, [this, &pair]() {processStereo(pair);}});
+  }
+}
+
+void StereoBatchProcessor::processStereo(Pair & pair)
+{
+  const bool ok = pair.ok[0] && pair.ok[1];
+  if (ok) {
+    std::lock_guard<std::mutex> lock(pair.mutex);
+    pair.processor.processStereo(pair.model, pair.output, pair.flags);
+  }
+  pair.left_raw.reset();
+  pair.right_raw.reset();
+  const Callback done = std::move(pair.done);
+  if (done) {
+    done(ok, pair.output);
+  }
+  pair.busy = false;
+}
+
+}  // namespace stereo_image_proc
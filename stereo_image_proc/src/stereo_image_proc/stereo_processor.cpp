@@ -30,14 +30,26 @@
 // ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include <limits>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "rcutils/logging_macros.h"
 
 #include "stereo_image_proc/stereo_processor.hpp"
 
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
 #include <sensor_msgs/image_encodings.hpp>
 
 // TODO(jacobperron): Remove this after it's implemented upstream
@@ -51,6 +63,148 @@
 namespace stereo_image_proc
 {
 
+namespace
+{
+
+// Flags of the monocular stage of a camera, with those the stereo stage needs
+int monoFlags(int flags, bool right)
+{
+  if (right) {
+    int right_flags = flags & StereoProcessor::RIGHT_ALL;
+    if (flags & StereoProcessor::STEREO_ALL) {
+      // Need the rectified images for stereo processing
+      right_flags |= StereoProcessor::RIGHT_RECT;
+    }
+    return right_flags >> 4;
+  }
+  int left_flags = flags & StereoProcessor::LEFT_ALL;
+  if (flags & StereoProcessor::STEREO_ALL) {
+    // Need the rectified images for stereo processing
+    left_flags |= StereoProcessor::LEFT_RECT;
+  }
+  if (flags & (StereoProcessor::POINT_CLOUD | StereoProcessor::POINT_CLOUD2)) {
+    // Need the color channels for the point cloud
+    left_flags |= StereoProcessor::LEFT_RECT_COLOR;
+  }
+  return left_flags;
+}
+
+// Runs the monocular stage of both cameras, the right one on a thread of its
+// own if parallel. Not as a two-task cv::parallel_for_, which would run the
+// debayer and remap kernels of each camera serially.
+template<typename ProcessMono>
+bool processBothMono(bool parallel, ProcessMono process_mono)
+{
+  if (parallel) {
+    // The two cameras share nothing but the internally guarded map cache
+    std::future<bool> right = std::async(std::launch::async, process_mono, true);
+    const bool left_ok = process_mono(false);
+    // Joined before the stereo stage reads the rectified images
+    return right.get() && left_ok;
+  }
+  return process_mono(false) && process_mono(true);
+}
+
+// The matchers take 8-bit images, while image_proc::Processor also debayers
+// 16-bit mosaics
+bool matchableEncoding(const std::string & encoding)
+{
+  if (sensor_msgs::image_encodings::isBayer(encoding) &&
+    sensor_msgs::image_encodings::bitDepth(encoding) != 8)
+  {
+    RCUTILS_LOG_ERROR("[stereo_image_proc] Unsupported encoding '%s'", encoding.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Gives to a matcher of the same type, StereoBM or StereoSGBM, the parameters of from
+void copyMatcherParameters(const cv::StereoMatcher & from, cv::StereoMatcher & to)
+{
+  to.setMinDisparity(from.getMinDisparity());
+  to.setNumDisparities(from.getNumDisparities());
+  to.setBlockSize(from.getBlockSize());
+  to.setSpeckleWindowSize(from.getSpeckleWindowSize());
+  to.setSpeckleRange(from.getSpeckleRange());
+  to.setDisp12MaxDiff(from.getDisp12MaxDiff());
+  const auto * from_bm = dynamic_cast<const cv::StereoBM *>(&from);
+  auto * to_bm = dynamic_cast<cv::StereoBM *>(&to);
+  if (from_bm && to_bm) {
+    to_bm->setPreFilterType(from_bm->getPreFilterType());
+    to_bm->setPreFilterSize(from_bm->getPreFilterSize());
+    to_bm->setPreFilterCap(from_bm->getPreFilterCap());
+    to_bm->setTextureThreshold(from_bm->getTextureThreshold());
+    to_bm->setUniquenessRatio(from_bm->getUniquenessRatio());
+    to_bm->setSmallerBlockSize(from_bm->getSmallerBlockSize());
+  }
+  const auto * from_sgbm = dynamic_cast<const cv::StereoSGBM *>(&from);
+  auto * to_sgbm = dynamic_cast<cv::StereoSGBM *>(&to);
+  if (from_sgbm && to_sgbm) {
+    to_sgbm->setPreFilterCap(from_sgbm->getPreFilterCap());
+    to_sgbm->setUniquenessRatio(from_sgbm->getUniquenessRatio());
+    to_sgbm->setP1(from_sgbm->getP1());
+    to_sgbm->setP2(from_sgbm->getP2());
+    to_sgbm->setMode(from_sgbm->getMode());
+  }
+}
+
+// Stores the depth of a pixel in meters, NaN if invalid
+inline void storeDepth(bool valid, float depth, float & out)
+{
+  out = valid ? depth : std::numeric_limits<float>::quiet_NaN();
+}
+
+// Stores the depth of a pixel in millimeters, 0 if invalid or out of range
+inline void storeDepth(bool valid, float depth, uint16_t & out)
+{
+  out = valid && depth < 65535.5f ? static_cast<uint16_t>(depth + 0.5f) : 0;
+}
+
+// Writes the depth focal_baseline / d of the disparities d = src * scale + offset
+// of one row from column x on, and d into disparity unless null
+template<typename T, typename D>
+void depthRow(
+  const T * src, int cols, float scale, float offset, float min_valid,
+  float focal_baseline, float * disparity, D * depth, int x = 0)
+{
+  for (; x < cols; ++x) {
+    const float d = src[x] * scale + offset;
+    if (disparity) {
+      disparity[x] = d;
+    }
+    storeDepth(src[x] >= min_valid && d > 0.0f, focal_baseline / d, depth[x]);
+  }
+}
+
+// Same from the fixed point disparities of the matchers to meters, vectorized
+void depthRow(
+  const int16_t * src, int cols, float scale, float offset, float min_valid,
+  float focal_baseline, float * disparity, float * depth)
+{
+  int x = 0;
+#if CV_SIMD128
+  const cv::v_float32x4 v_scale = cv::v_setall_f32(scale);
+  const cv::v_float32x4 v_offset = cv::v_setall_f32(offset);
+  const cv::v_float32x4 v_min_valid = cv::v_setall_f32(min_valid);
+  const cv::v_float32x4 v_focal_baseline = cv::v_setall_f32(focal_baseline);
+  const cv::v_float32x4 v_zero = cv::v_setzero_f32();
+  const cv::v_float32x4 v_nan = cv::v_setall_f32(std::numeric_limits<float>::quiet_NaN());
+  for (; x + 4 <= cols; x += 4) {
+    const cv::v_float32x4 v = cv::v_cvt_f32(cv::v_load_expand(src + x));
+    const cv::v_float32x4 d = cv::v_muladd(v, v_scale, v_offset);
+    if (disparity) {
+      cv::v_store(disparity + x, d);
+    }
+    const cv::v_float32x4 valid = (v >= v_min_valid) & (d > v_zero);
+    cv::v_store(depth + x, cv::v_select(valid, v_focal_baseline / d, v_nan));
+  }
+#endif
+  depthRow<int16_t, float>(
+    src, cols, scale, offset, min_valid, focal_baseline, disparity, depth, x);
+}
+
+}  // namespace
+
 bool StereoProcessor::process(
   const sensor_msgs::msg::Image::ConstSharedPtr & left_raw,
   const sensor_msgs::msg::Image::ConstSharedPtr & right_raw,
@@ -59,24 +213,81 @@ bool StereoProcessor::process(
   int flags) const
 {
   // Do monocular processing on left and right images
-  int left_flags = flags & LEFT_ALL;
-  int right_flags = flags & RIGHT_ALL;
-  if (flags & STEREO_ALL) {
-    // Need the rectified images for stereo processing
-    left_flags |= LEFT_RECT;
-    right_flags |= RIGHT_RECT;
+  if (!processBothMono(
+      parallel_mono_, [&](bool right) {
+        return processMono(right ? right_raw : left_raw, model, right, output, flags);
+      }))
+  {
+    return false;
   }
-  if (flags & (POINT_CLOUD | POINT_CLOUD2)) {
-    flags |= DISPARITY;
-    // Need the color channels for the point cloud
-    left_flags |= LEFT_RECT_COLOR;
+
+  processStereo(model, output, flags);
+  return true;
+}
+
+bool StereoProcessor::process(
+  const sensor_msgs::msg::Image::ConstSharedPtr & left_raw,
+  const sensor_msgs::msg::Image::ConstSharedPtr & right_raw,
+  const image_geometry::StereoCameraModel & model,
+  StereoImageSet & output,
+  StereoFrameArena & arena,
+  int flags) const
+{
+  if (!processBothMono(
+      parallel_mono_, [&](bool right) {
+        return processMono(right ? right_raw : left_raw, model, right, output, arena, flags);
+      }))
+  {
+    return false;
   }
-  if (!mono_processor_.process(left_raw, model.left(), output.left, left_flags)) {
+
+  processStereo(model, output, flags);
+  return true;
+}
+
+bool StereoProcessor::processMono(
+  const sensor_msgs::msg::Image::ConstSharedPtr & raw,
+  const image_geometry::StereoCameraModel & model,
+  bool right,
+  StereoImageSet & output,
+  int flags) const
+{
+  if (!matchableEncoding(raw->encoding)) {
     return false;
   }
-  if (!mono_processor_.process(right_raw, model.right(), output.right, right_flags >> 4)) {
+  if (right) {
+    return mono_processor_.process(raw, model.right(), output.right, monoFlags(flags, true));
+  }
+  return mono_processor_.process(raw, model.left(), output.left, monoFlags(flags, false));
+}
+
+bool StereoProcessor::processMono(
+  const sensor_msgs::msg::Image::ConstSharedPtr & raw,
+  const image_geometry::StereoCameraModel & model,
+  bool right,
+  StereoImageSet & output,
+  StereoFrameArena & arena,
+  int flags) const
+{
+  if (!matchableEncoding(raw->encoding)) {
     return false;
   }
+  if (right) {
+    return mono_processor_.process(
+      raw, model.right(), output.right, arena.right, monoFlags(flags, true));
+  }
+  return mono_processor_.process(
+    raw, model.left(), output.left, arena.left, monoFlags(flags, false));
+}
+
+void StereoProcessor::processStereo(
+  const image_geometry::StereoCameraModel & model,
+  StereoImageSet & output,
+  int flags) const
+{
+  if (flags & (POINT_CLOUD | POINT_CLOUD2)) {
+    flags |= DISPARITY;
+  }
 
   // Do block matching to produce the disparity image
   if (flags & DISPARITY) {
@@ -94,39 +305,122 @@ bool StereoProcessor::process(
     processPoints2(
       output.disparity, output.left.rect_color, output.left.color_encoding, model, output.points2);
   }
+}
 
-  return true;
+bool StereoProcessor::cudaAvailable()
+{
+#ifdef HAVE_OPENCV_CUDASTEREO
+  return cv::cuda::getCudaEnabledDeviceCount() > 0;
+#else
+  return false;
+#endif
 }
 
 void StereoProcessor::processDisparity(
   const cv::Mat & left_rect,
   const cv::Mat & right_rect,
   const image_geometry::StereoCameraModel & model,
-  stereo_msgs::msg::DisparityImage & disparity) const
+  stereo_msgs::msg::DisparityImage & disparity,
+  sensor_msgs::msg::Image * depth) const
 {
   // Fixed-point disparity is 16 times the true value: d = d_fp / 16.0 = x_l - x_r.
   static const int DPP = 16;  // disparities per pixel
   static const double inv_dpp = 1.0 / DPP;
 
+  // We convert from fixed-point to float disparity and also adjust for any x-offset between
+  // the principal points: d = d_fp*inv_dpp - (cx_l - cx_r)
+  const double disparity_offset = -(model.left().cx() - model.right().cx());
+  const bool cuda = current_stereo_algorithm_ == CUDA_BM || current_stereo_algorithm_ == CUDA_SGM;
+
+  // Fill in DisparityImage image data, either 32-bit float or the 16-bit fixed point
+  // disparity of the matchers
+  sensor_msgs::msg::Image & dimage = disparity.image;
+  dimage.height = left_rect.rows;
+  dimage.width = left_rect.cols;
+  dimage.encoding = fixed_point_disparity_ ?
+    sensor_msgs::image_encodings::TYPE_16SC1 : sensor_msgs::image_encodings::TYPE_32FC1;
+  dimage.step = dimage.width * (fixed_point_disparity_ ? sizeof(int16_t) : sizeof(float));
+  dimage.data.resize(dimage.step * dimage.height);
+  cv::Mat dmat(
+    dimage.height, dimage.width, fixed_point_disparity_ ? CV_16SC1 : CV_32FC1,
+    &dimage.data[0], dimage.step);
+
+  // In fixed point the matchers write straight into the message buffer
+  if (fixed_point_disparity_) {
+    disparity16_ = dmat;
+  }
+
+  if (cuda || coarse_to_fine_levels_ <= 0) {
+    coarse_to_fine_stats_.clear();
+  }
+
   // Block matcher produces 16-bit signed (fixed point) disparity image
+  cv::StereoMatcher * matcher = nullptr;
   if (current_stereo_algorithm_ == BM) {
-    block_matcher_->compute(left_rect, right_rect, disparity16_);
-  } else {
-    sg_block_matcher_->compute(left_rect, right_rect, disparity16_);
+    matcher = block_matcher_.get();
+  } else if (current_stereo_algorithm_ == SGBM) {
+    matcher = sg_block_matcher_.get();
   }
 
-  // Fill in DisparityImage image data, converting to 32-bit float
-  sensor_msgs::msg::Image & dimage = disparity.image;
-  dimage.height = disparity16_.rows;
-  dimage.width = disparity16_.cols;
-  dimage.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-  dimage.step = dimage.width * sizeof(float);
-  dimage.data.resize(dimage.step * dimage.height);
-  cv::Mat_<float> dmat(
-    dimage.height, dimage.width, reinterpret_cast<float *>(&dimage.data[0]), dimage.step);
-  // We convert from fixed-point to float disparity and also adjust for any x-offset between
-  // the principal points: d = d_fp*inv_dpp - (cx_l - cx_r)
-  disparity16_.convertTo(dmat, dmat.type(), inv_dpp, -(model.left().cx() - model.right().cx()));
+  // The fused post filter replaces the speckle filter of the matcher
+  const bool post_filter = matcher && (fused_post_filter_ || lr_check_);
+  const int speckle_size = matcher ? matcher->getSpeckleWindowSize() : 0;
+  if (post_filter) {
+    matcher->setSpeckleWindowSize(0);
+  }
+  if (cuda) {
+    processDisparityCuda(left_rect, right_rect);
+  } else if (matcher) {
+    if (coarse_to_fine_levels_ > 0) {
+      computeCoarseToFineDisparity(left_rect, right_rect, *matcher);
+    } else if (adaptive_range_) {
+      computeAdaptiveDisparity(left_rect, right_rect, *matcher);
+    } else if (stripe_rows_ > 0 && left_rect.rows > stripe_rows_) {
+      computeStripedDisparity(left_rect, right_rect, *matcher);
+    } else {
+      matcher->compute(left_rect, right_rect, disparity16_);
+    }
+  }
+  if (post_filter) {
+    matcher->setSpeckleWindowSize(speckle_size);
+  }
+
+  if (post_filter) {
+    // Block matching compares fixed point disparities to its speckle range
+    // as is, Semi-Global Block Matching scales the range to fixed point first
+    const int speckle_range = matcher->getSpeckleRange() * (isBlockMatching() ? 1 : DPP);
+    postFilterDisparity(
+      matcher->getMinDisparity(), speckle_size, speckle_range, disparity_offset, dmat);
+  } else if (fixed_point_disparity_) {
+    // The x-offset between the principal points, rounded to the nearest 1/16 pixel
+    const int offset16 = cvRound(disparity_offset * DPP);
+    if (offset16 != 0) {
+      disparity16_ += offset16;
+    }
+  } else if (depth) {
+    // Depth straight from the fixed point disparities, in the pass converting them
+    writeDepth(
+      disparity16_, inv_dpp, disparity_offset, getMinDisparity() * DPP,
+      model.right().fx() * model.baseline(), dmat, *depth);
+  } else {
+    disparity16_.convertTo(dmat, dmat.type(), inv_dpp, disparity_offset);
+  }
+  if (depth && (post_filter || fixed_point_disparity_)) {
+    // From the published disparities, which already hold the x-offset. Invalid
+    // ones are a whole pixel below the minimum, the threshold is halfway.
+    const double min_valid = fixed_point_disparity_ ?
+      getMinDisparity() * DPP + cvRound(disparity_offset * DPP) - DPP / 2 :
+      getMinDisparity() + disparity_offset - 0.5;
+    cv::Mat no_float_disparity;
+    writeDepth(
+      dmat, fixed_point_disparity_ ? inv_dpp : 1.0, 0.0, min_valid,
+      model.right().fx() * model.baseline(), no_float_disparity, *depth);
+  }
+  if (fixed_point_disparity_) {
+    RCUTILS_ASSERT(disparity16_.data == dmat.data);
+    // Do not keep a reference to the message buffer past this frame
+    disparity16_.release();
+  }
   RCUTILS_ASSERT(dmat.data == &dimage.data[0]);
   // TODO(unknown): is_bigendian?
 
@@ -142,113 +436,692 @@ void StereoProcessor::processDisparity(
   disparity.delta_d = inv_dpp;
 }
 
-inline bool isValidPoint(const cv::Vec3f & pt)
+void StereoProcessor::processDisparity(
+  const cv::Mat & left_rect,
+  const cv::Mat & right_rect,
+  const image_geometry::StereoCameraModel & model,
+  const cv::Rect & window,
+  stereo_msgs::msg::DisparityImage & disparity,
+  sensor_msgs::msg::Image * depth) const
 {
-  // Check both for disparities explicitly marked as invalid (where OpenCV maps pt.z to MISSING_Z)
-  // and zero disparities (point mapped to infinity).
-  return pt[2] != image_geometry::StereoCameraModel::MISSING_Z && !std::isinf(pt[2]);
+  const cv::Rect image(cv::Point(), left_rect.size());
+  const cv::Rect clipped = window & image;
+
+  // Match the window with the columns on its left that the disparity search
+  // needs, the columns on its right for negative disparities, and the borders
+  // of the correlation and prefilter windows around it
+  const int border =
+    std::max(getCorrelationWindowSize(), isBlockMatching() ? getPreFilterSize() : 0) / 2;
+  const int left_margin = std::max(0, getMinDisparity() + getDisparityRange() - 1) + border;
+  const int right_margin = std::max(0, -getMinDisparity()) + border;
+  const cv::Rect padded = cv::Rect(
+    clipped.x - left_margin, clipped.y - border,
+    clipped.width + left_margin + right_margin, clipped.height + 2 * border) & image;
+
+  static const int DPP = 16;  // disparities per pixel
+  stereo_msgs::msg::DisparityImage matched;
+  if (clipped.empty()) {
+    // Nothing to match, all disparities are invalid
+    matched.image.encoding = fixed_point_disparity_ ?
+      sensor_msgs::image_encodings::TYPE_16SC1 : sensor_msgs::image_encodings::TYPE_32FC1;
+    matched.f = model.right().fx();
+    matched.t = model.baseline();
+    matched.min_disparity = getMinDisparity();
+    matched.max_disparity = getMinDisparity() + getDisparityRange() - 1;
+    matched.delta_d = 1.0 / DPP;
+  } else {
+    processDisparity(left_rect(padded), right_rect(padded), model, matched);
+  }
+
+  // Same invalid value as the matchers, moved by the x-offset between the principal points
+  const double disparity_offset = -(model.left().cx() - model.right().cx());
+  const bool fixed_point = matched.image.encoding == sensor_msgs::image_encodings::TYPE_16SC1;
+  const double invalid = fixed_point ?
+    (getMinDisparity() - 1) * DPP + cvRound(disparity_offset * DPP) :
+    getMinDisparity() - 1 + disparity_offset;
+
+  disparity.image.height = left_rect.rows;
+  disparity.image.width = left_rect.cols;
+  disparity.image.encoding = matched.image.encoding;
+  disparity.image.step = disparity.image.width * (fixed_point ? sizeof(int16_t) : sizeof(float));
+  disparity.image.data.resize(disparity.image.step * disparity.image.height);
+  const int type = fixed_point ? CV_16SC1 : CV_32FC1;
+  cv::Mat dmat(
+    disparity.image.height, disparity.image.width, type,
+    &disparity.image.data[0], disparity.image.step);
+  dmat.setTo(cv::Scalar::all(invalid));
+  if (!clipped.empty()) {
+    const cv::Mat matched_mat(
+      matched.image.height, matched.image.width, type,
+      &matched.image.data[0], matched.image.step);
+    matched_mat(clipped - padded.tl()).copyTo(dmat(clipped));
+  }
+
+  disparity.f = matched.f;
+  disparity.t = matched.t;
+  disparity.min_disparity = matched.min_disparity;
+  disparity.max_disparity = matched.max_disparity;
+  disparity.delta_d = matched.delta_d;
+  disparity.valid_window.x_offset = clipped.x;
+  disparity.valid_window.y_offset = clipped.y;
+  disparity.valid_window.width = clipped.width;
+  disparity.valid_window.height = clipped.height;
+
+  // From the whole disparity image, so that the pixels outside of the window are invalid too
+  if (depth) {
+    cv::Mat no_float_disparity;
+    writeDepth(
+      dmat, fixed_point ? 1.0 / DPP : 1.0, 0.0, invalid + (fixed_point ? DPP / 2 : 0.5),
+      matched.f * matched.t, no_float_disparity, *depth);
+  }
 }
 
-void StereoProcessor::processPoints(
-  const stereo_msgs::msg::DisparityImage & disparity,
-  const cv::Mat & color,
-  const std::string & encoding,
-  const image_geometry::StereoCameraModel & model,
-  sensor_msgs::msg::PointCloud & points) const
+int StereoProcessor::stripeWorkers(int stripes) const
 {
-  // Calculate dense point cloud
-  const sensor_msgs::msg::Image & dimage = disparity.image;
-  // The cv::Mat_ constructor doesn't accept a const data data pointer
-  // so we remove the constness before reinterpreting into float.
-  // This is "safe" since our cv::Mat is const.
-  float * data = reinterpret_cast<float *>(const_cast<uint8_t *>(&dimage.data[0]));
-  const cv::Mat_<float> dmat(dimage.height, dimage.width, data, dimage.step);
-  model.projectDisparityImageTo3d(dmat, dense_points_, true);
+  return parallel_stripes_ ? std::max(1, std::min(cv::getNumThreads(), stripes)) : 1;
+}
 
-  // Fill in sparse point cloud message
-  points.points.resize(0);
-  points.channels.resize(3);
-  points.channels[0].name = "rgb";
-  points.channels[0].values.resize(0);
-  points.channels[1].name = "u";
-  points.channels[1].values.resize(0);
-  points.channels[2].name = "v";
-  points.channels[2].values.resize(0);
-
-  for (int32_t u = 0; u < dense_points_.rows; ++u) {
-    for (int32_t v = 0; v < dense_points_.cols; ++v) {
-      if (isValidPoint(dense_points_(u, v))) {
-        // x,y,z
-        geometry_msgs::msg::Point32 pt;
-        pt.x = dense_points_(u, v)[0];
-        pt.y = dense_points_(u, v)[1];
-        pt.z = dense_points_(u, v)[2];
-        points.points.push_back(pt);
-        // u,v
-        points.channels[1].values.push_back(u);
-        points.channels[2].values.push_back(v);
-      }
+void StereoProcessor::computeStripedDisparity(
+  const cv::Mat & left_rect, const cv::Mat & right_rect,
+  cv::StereoMatcher & matcher) const
+{
+  const int rows = left_rect.rows;
+  const int stripes = (rows + stripe_rows_ - 1) / stripe_rows_;
+  const int workers = stripeWorkers(stripes);
+  // Rows above and below a stripe that its correlation and prefilter windows
+  // reach into, matched with it and dropped
+  const int overlap =
+    std::max(getCorrelationWindowSize(), isBlockMatching() ? getPreFilterSize() : 0);
+
+  // A matcher per worker, so that only as many stripes as workers have
+  // scratch buffers at once. Speckles are removed once stripes are put
+  // together, so that regions crossing a seam are measured whole.
+  const bool bm = dynamic_cast<cv::StereoBM *>(&matcher) != nullptr;
+  stripe_matchers_.resize(workers);
+  stripe_disparity16_.resize(workers);
+  for (auto & stripe_matcher : stripe_matchers_) {
+    if (!stripe_matcher || (dynamic_cast<cv::StereoBM *>(stripe_matcher.get()) != nullptr) != bm) {
+      stripe_matcher = bm ?
+        cv::Ptr<cv::StereoMatcher>(cv::StereoBM::create()) :
+        cv::Ptr<cv::StereoMatcher>(cv::StereoSGBM::create());
     }
+    copyMatcherParameters(matcher, *stripe_matcher);
+    stripe_matcher->setSpeckleWindowSize(0);
   }
 
-  // Fill in color
-  namespace enc = sensor_msgs::image_encodings;
-  points.channels[0].values.reserve(points.points.size());
-  if (encoding == enc::MONO8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v) {
-        if (isValidPoint(dense_points_(u, v))) {
-          uint8_t g = color.at<uint8_t>(u, v);
-          int32_t rgb = (g << 16) | (g << 8) | g;
-          points.channels[0].values.push_back(*reinterpret_cast<float *>(&rgb));
+  disparity16_.create(left_rect.size());
+  cv::parallel_for_(
+    cv::Range(0, workers), [&](const cv::Range & range) {
+      for (int w = range.start; w < range.end; ++w) {
+        // Every workers-th stripe, one after the other in the buffers of the worker
+        for (int s = w; s < stripes; s += workers) {
+          const int y0 = s * stripe_rows_;
+          const int y1 = std::min(rows, y0 + stripe_rows_);
+          const int top = std::max(0, y0 - overlap);
+          const int bottom = std::min(rows, y1 + overlap);
+          cv::Mat_<int16_t> & stripe = stripe_disparity16_[w];
+          stripe_matchers_[w]->compute(
+            left_rect.rowRange(top, bottom), right_rect.rowRange(top, bottom), stripe);
+          stripe.rowRange(y0 - top, y1 - top).copyTo(disparity16_.rowRange(y0, y1));
         }
       }
-    }
-  } else if (encoding == enc::RGB8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v) {
-        if (isValidPoint(dense_points_(u, v))) {
-          const cv::Vec3b & rgb = color.at<cv::Vec3b>(u, v);
-          int32_t rgb_packed = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
-          points.channels[0].values.push_back(*reinterpret_cast<float *>(&rgb_packed));
+    }, workers);
+
+  // As the matchers do: Block Matching compares fixed point disparities to
+  // its speckle range as is, Semi-Global Block Matching scales it first
+  static const int DPP = 16;  // disparities per pixel
+  const int speckle_size = matcher.getSpeckleWindowSize();
+  const int speckle_range = matcher.getSpeckleRange();
+  if (speckle_size > 0 && speckle_range >= 0) {
+    cv::filterSpeckles(
+      disparity16_, (matcher.getMinDisparity() - 1) * DPP, speckle_size,
+      speckle_range * (bm ? 1 : DPP), speckle_buffer_);
+  }
+}
+
+void StereoProcessor::computeAdaptiveDisparity(
+  const cv::Mat & left_rect, const cv::Mat & right_rect,
+  cv::StereoMatcher & matcher) const
+{
+  const int bands = std::max(1, std::min(adaptive_bands_, left_rect.rows));
+  if (static_cast<int>(band_windows_.size()) != bands || band_image_size_ != left_rect.size()) {
+    band_windows_.assign(bands, cv::Vec2i(matcher.getMinDisparity(), matcher.getNumDisparities()));
+    band_image_size_ = left_rect.size();
+  }
+  computeBandedDisparity(left_rect, right_rect, matcher, band_windows_, disparity16_);
+}
+
+double StereoProcessor::computeBandedDisparity(
+  const cv::Mat & left_rect, const cv::Mat & right_rect, cv::StereoMatcher & matcher,
+  std::vector<cv::Vec2i> & windows, cv::Mat_<int16_t> & disparity) const
+{
+  static const int DPP = 16;  // disparities per pixel
+  // Extra disparities searched on both sides of those seen in a band
+  static const int MARGIN = 8;
+
+  const int min_disparity = matcher.getMinDisparity();
+  const int num_disparities = matcher.getNumDisparities();
+  const int rows = left_rect.rows;
+  const int bands = static_cast<int>(windows.size());
+  disparity.create(left_rect.size());
+  double searched = 0.0;
+
+  // Every band is matched with a margin of rows, so that its correlation
+  // windows see the same pixels as in a single pass
+  const int pad = matcher.getBlockSize();
+  const int16_t invalid = static_cast<int16_t>((min_disparity - 1) * DPP);
+  for (int b = 0; b < bands; ++b) {
+    // Keep the window within the configured range
+    cv::Vec2i & window = windows[b];
+    window[1] = std::min(window[1], num_disparities);
+    window[0] = std::max(
+      min_disparity, std::min(window[0], min_disparity + num_disparities - window[1]));
+
+    const int y0 = b * rows / bands;
+    const int y1 = (b + 1) * rows / bands;
+    const int a0 = std::max(0, y0 - pad);
+    const int a1 = std::min(rows, y1 + pad);
+    matcher.setMinDisparity(window[0]);
+    matcher.setNumDisparities(window[1]);
+    matcher.compute(left_rect.rowRange(a0, a1), right_rect.rowRange(a0, a1), band_disparity16_);
+    searched += static_cast<double>(window[1]) * (y1 - y0) / rows;
+
+    // Copy the rows of the band, giving its missing values the value of the
+    // full range, and find the disparities it spans
+    const int band_min = window[0] * DPP;
+    const int band_max = (window[0] + window[1] - 1) * DPP;
+    const bool low_edge = window[0] > min_disparity;
+    const bool high_edge = window[0] + window[1] < min_disparity + num_disparities;
+    int lo = std::numeric_limits<int>::max();
+    int hi = std::numeric_limits<int>::min();
+    int valid = 0;
+    int at_edge = 0;
+    for (int y = y0; y < y1; ++y) {
+      const int16_t * src = band_disparity16_[y - a0];
+      int16_t * dst = disparity[y];
+      for (int x = 0; x < left_rect.cols; ++x) {
+        const int d = src[x];
+        if (d < band_min) {
+          dst[x] = invalid;
+          continue;
+        }
+        dst[x] = static_cast<int16_t>(d);
+        lo = std::min(lo, d);
+        hi = std::max(hi, d);
+        ++valid;
+        if ((low_edge && d < band_min + DPP) || (high_edge && d >= band_max)) {
+          ++at_edge;
         }
       }
     }
-  } else if (encoding == enc::RGBA8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v) {
-        if (isValidPoint(dense_points_(u, v))) {
-          const cv::Vec4b & rgb = color.at<cv::Vec4b>(u, v);
-          int32_t rgb_packed = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
-          points.channels[0].values.push_back(*reinterpret_cast<float *>(&rgb_packed));
+
+    // Confidence check: a band with few matches, or whose matches pile up at
+    // the edges of its window, likely lost its true disparities and goes
+    // back to the full range
+    const int area = (y1 - y0) * left_rect.cols;
+    if (valid * 20 < area || at_edge * 10 > valid) {
+      window = cv::Vec2i(min_disparity, num_disparities);
+      continue;
+    }
+    const int first = cvFloor(lo * (1.0 / DPP)) - MARGIN;
+    const int last = cvCeil(hi * (1.0 / DPP)) + MARGIN;
+    window[1] = std::max(DPP, (last - first + DPP) / DPP * DPP);
+    window[0] = first;
+  }
+
+  matcher.setMinDisparity(min_disparity);
+  matcher.setNumDisparities(num_disparities);
+  return searched;
+}
+
+void StereoProcessor::computeCoarseToFineDisparity(
+  const cv::Mat & left_rect, const cv::Mat & right_rect,
+  cv::StereoMatcher & matcher) const
+{
+  static const int DPP = 16;  // disparities per pixel
+
+  const int min_disparity = matcher.getMinDisparity();
+  const int num_disparities = matcher.getNumDisparities();
+  const int block_size = matcher.getBlockSize();
+
+  // Disparity range of the pair downsampled level times, in pixels of that level
+  auto level_range = [&](int level) {
+      const double scale = 1.0 / (1 << level);
+      const int first = cvFloor(min_disparity * scale);
+      const int last = cvCeil((min_disparity + num_disparities) * scale);
+      return cv::Vec2i(first, std::max(DPP, (last - first + DPP - 1) / DPP * DPP));
+    };
+
+  // Downsample the pair while a level still fits the correlation windows
+  // and its disparity range
+  pyramid_left_.resize(1);
+  pyramid_right_.resize(1);
+  pyramid_left_[0] = left_rect;
+  pyramid_right_[0] = right_rect;
+  for (int level = 1; level <= coarse_to_fine_levels_; ++level) {
+    const cv::Mat & finer = pyramid_left_[level - 1];
+    if (finer.rows / 2 < 2 * block_size ||
+      finer.cols / 2 <= level_range(level)[1] + block_size)
+    {
+      break;
+    }
+    pyramid_left_.emplace_back();
+    pyramid_right_.emplace_back();
+    cv::pyrDown(finer, pyramid_left_[level]);
+    cv::pyrDown(pyramid_right_[level - 1], pyramid_right_[level]);
+  }
+  const int levels = static_cast<int>(pyramid_left_.size()) - 1;
+  pyramid_disparity16_.resize(levels + 1);
+
+  // The coarsest level is searched over its whole range, with as many bands
+  // as every finer level
+  const int bands = std::max(1, std::min(adaptive_bands_, pyramid_left_[levels].rows));
+  level_windows_.assign(bands, level_range(levels));
+
+  const double full_cost = static_cast<double>(left_rect.total()) * num_disparities;
+  coarse_to_fine_stats_.clear();
+  for (int level = levels; level >= 0; --level) {
+    const cv::Vec2i range = level_range(level);
+    matcher.setMinDisparity(range[0]);
+    matcher.setNumDisparities(range[1]);
+
+    const int64 start = cv::getTickCount();
+    const double searched = computeBandedDisparity(
+      pyramid_left_[level], pyramid_right_[level], matcher, level_windows_,
+      level == 0 ? disparity16_ : pyramid_disparity16_[level]);
+    CoarseToFineLevel stats;
+    stats.size = pyramid_left_[level].size();
+    stats.disparities = searched;
+    stats.milliseconds = (cv::getTickCount() - start) * 1000.0 / cv::getTickFrequency();
+    stats.speedup = full_cost / std::max(1.0, stats.size.area() * searched);
+    coarse_to_fine_stats_.push_back(stats);
+
+    // Disparities double with the resolution. Bands that went back to the
+    // full range of this level search the full range of the next one.
+    for (cv::Vec2i & window : level_windows_) {
+      window *= 2;
+    }
+  }
+
+  // Do not keep a reference to the input pair past this frame
+  pyramid_left_[0].release();
+  pyramid_right_[0].release();
+  matcher.setMinDisparity(min_disparity);
+  matcher.setNumDisparities(num_disparities);
+}
+
+void StereoProcessor::postFilterDisparity(
+  int min_disparity, int speckle_size, int speckle_range, double disparity_offset,
+  cv::Mat & dmat) const
+{
+  static const int DPP = 16;  // disparities per pixel
+  static const double inv_dpp = 1.0 / DPP;
+
+  const int rows = disparity16_.rows;
+  const int cols = disparity16_.cols;
+  const int16_t invalid = static_cast<int16_t>((min_disparity - 1) * DPP);
+  const int valid_min = min_disparity * DPP;
+  const bool speckles = speckle_size > 0 && speckle_range >= 0;
+  const int lr_max_diff = lr_check_max_diff_ * DPP;
+
+  // Union-find forest of the speckle regions, label 0 marks no region. Roots
+  // are always the smallest label of their region, so that parents come
+  // before their children.
+  auto find = [this](int32_t label) {
+      while (speckle_parent_[label] != label) {
+        speckle_parent_[label] = speckle_parent_[speckle_parent_[label]];
+        label = speckle_parent_[label];
+      }
+      return label;
+    };
+  auto unite = [this, &find](int32_t a, int32_t b) {
+      a = find(a);
+      b = find(b);
+      if (a != b) {
+        if (a > b) {
+          std::swap(a, b);
         }
+        speckle_parent_[b] = a;
+        speckle_area_[a] += speckle_area_[b];
       }
-    }
-  } else if (encoding == enc::BGRA8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v) {
-        if (isValidPoint(dense_points_(u, v))) {
-          const cv::Vec4b & bgr = color.at<cv::Vec4b>(u, v);
-          int32_t rgb_packed = (bgr[2] << 16) | (bgr[1] << 8) | bgr[0];
-          points.channels[0].values.push_back(*reinterpret_cast<float *>(&rgb_packed));
+      return a;
+    };
+  if (speckles) {
+    speckle_labels_.create(rows, cols);
+    speckle_parent_.assign(1, 0);
+    speckle_area_.assign(1, 0);
+  }
+  if (lr_check_) {
+    lr_best_.resize(cols);
+  }
+
+  // First pass, row by row: left-right check, then the region of every
+  // pixel from its left and upper neighbors
+  for (int y = 0; y < rows; ++y) {
+    int16_t * d = disparity16_[y];
+
+    // A right image pixel matched by several left ones can only be seen by
+    // the closest, which has the largest disparity
+    if (lr_check_) {
+      std::fill(lr_best_.begin(), lr_best_.end(), std::numeric_limits<int>::min());
+      for (int x = 0; x < cols; ++x) {
+        const int xr = x - (d[x] + DPP / 2) / DPP;
+        if (d[x] >= valid_min && xr >= 0 && xr < cols) {
+          lr_best_[xr] = std::max<int>(lr_best_[xr], d[x]);
+        }
+      }
+      for (int x = 0; x < cols; ++x) {
+        const int xr = x - (d[x] + DPP / 2) / DPP;
+        if (d[x] >= valid_min && xr >= 0 && xr < cols && d[x] < lr_best_[xr] - lr_max_diff) {
+          d[x] = invalid;
         }
       }
     }
-  } else if (encoding == enc::BGR8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v) {
-        if (isValidPoint(dense_points_(u, v))) {
-          const cv::Vec3b & bgr = color.at<cv::Vec3b>(u, v);
-          int32_t rgb_packed = (bgr[2] << 16) | (bgr[1] << 8) | bgr[0];
-          points.channels[0].values.push_back(*reinterpret_cast<float *>(&rgb_packed));
+
+    if (!speckles) {
+      continue;
+    }
+    int32_t * label = speckle_labels_[y];
+    const int16_t * d_up = y > 0 ? disparity16_[y - 1] : nullptr;
+    const int32_t * label_up = y > 0 ? speckle_labels_[y - 1] : nullptr;
+    for (int x = 0; x < cols; ++x) {
+      if (d[x] < valid_min) {
+        label[x] = 0;
+        continue;
+      }
+      int32_t region = 0;
+      if (x > 0 && label[x - 1] && std::abs(d[x] - d[x - 1]) <= speckle_range) {
+        region = label[x - 1];
+      }
+      if (label_up && label_up[x] && std::abs(d[x] - d_up[x]) <= speckle_range) {
+        region = region ? unite(region, label_up[x]) : label_up[x];
+      }
+      if (!region) {
+        region = static_cast<int32_t>(speckle_parent_.size());
+        speckle_parent_.push_back(region);
+        speckle_area_.push_back(0);
+      }
+      label[x] = region;
+      ++speckle_area_[find(region)];
+    }
+  }
+
+  // Point every label straight at its root, parents being already resolved
+  if (speckles) {
+    for (size_t i = 1; i < speckle_parent_.size(); ++i) {
+      speckle_parent_[i] = speckle_parent_[speckle_parent_[i]];
+    }
+  }
+
+  // Second pass: drop the regions of at most speckle_size pixels and write
+  // the published disparity, rows in parallel
+  const bool fixed_point = dmat.type() == CV_16SC1;
+  const int offset16 = cvRound(disparity_offset * DPP);
+  const float scale = static_cast<float>(inv_dpp);
+  const float offset = static_cast<float>(disparity_offset);
+  cv::parallel_for_(
+    cv::Range(0, rows), [&](const cv::Range & range) {
+      for (int y = range.start; y < range.end; ++y) {
+        int16_t * d = disparity16_[y];
+        if (speckles) {
+          const int32_t * label = speckle_labels_[y];
+          for (int x = 0; x < cols; ++x) {
+            if (label[x] && speckle_area_[speckle_parent_[label[x]]] <= speckle_size) {
+              d[x] = invalid;
+            }
+          }
+        }
+        if (fixed_point) {
+          // In place, disparity16_ is the message buffer
+          if (offset16 != 0) {
+            for (int x = 0; x < cols; ++x) {
+              d[x] = cv::saturate_cast<int16_t>(d[x] + offset16);
+            }
+          }
+          continue;
+        }
+        float * out = dmat.ptr<float>(y);
+        int x = 0;
+#if CV_SIMD128
+        const cv::v_float32x4 v_scale = cv::v_setall_f32(scale);
+        const cv::v_float32x4 v_offset = cv::v_setall_f32(offset);
+        for (; x + 4 <= cols; x += 4) {
+          const cv::v_float32x4 v = cv::v_cvt_f32(cv::v_load_expand(d + x));
+          cv::v_store(out + x, cv::v_muladd(v, v_scale, v_offset));
+        }
+#endif
+        for (; x < cols; ++x) {
+          out[x] = d[x] * scale + offset;
         }
       }
+    });
+}
+
+void StereoProcessor::processDisparityCuda(
+  const cv::Mat & left_rect, const cv::Mat & right_rect) const
+{
+#ifdef HAVE_OPENCV_CUDASTEREO
+  // Parameters shared by every matcher
+  auto copy_parameters = [](const cv::StereoMatcher & from, cv::StereoMatcher & to) {
+      to.setMinDisparity(from.getMinDisparity());
+      to.setNumDisparities(from.getNumDisparities());
+      to.setBlockSize(from.getBlockSize());
+      to.setSpeckleWindowSize(from.getSpeckleWindowSize());
+      to.setSpeckleRange(from.getSpeckleRange());
+      to.setDisp12MaxDiff(from.getDisp12MaxDiff());
+    };
+  static const int DPP = 16;  // disparities per pixel
+
+  cuda_left_.upload(left_rect);
+  cuda_right_.upload(right_rect);
+
+  const bool bm = current_stereo_algorithm_ == CUDA_BM;
+  const cv::StereoMatcher & settings = bm ?
+    static_cast<const cv::StereoMatcher &>(*block_matcher_) : *sg_block_matcher_;
+  const int invalid = (settings.getMinDisparity() - 1) * DPP;
+  if (bm) {
+    if (!cuda_block_matcher_) {
+      cuda_block_matcher_ = cv::cuda::createStereoBM();
+    }
+    copy_parameters(*block_matcher_, *cuda_block_matcher_);
+    cuda_block_matcher_->setPreFilterCap(block_matcher_->getPreFilterCap());
+    cuda_block_matcher_->setPreFilterSize(block_matcher_->getPreFilterSize());
+    cuda_block_matcher_->setTextureThreshold(block_matcher_->getTextureThreshold());
+    cuda_block_matcher_->setUniquenessRatio(block_matcher_->getUniquenessRatio());
+    cuda_block_matcher_->compute(cuda_left_, cuda_right_, cuda_disparity16_);
+    if (cuda_disparity16_.type() == CV_8UC1) {
+      // Whole pixels, 0 where no disparity passed the texture and uniqueness
+      // checks. Scaled to fixed point on the device, and the invalid ones
+      // marked as the CPU matcher marks them on the host.
+      cuda_disparity16_.convertTo(cuda_disparity_, CV_16SC1, DPP);
+      cuda_disparity_.download(disparity16_);
+      disparity16_.setTo(invalid, disparity16_ == 0);
+    } else {
+      cuda_disparity16_.download(disparity16_);
     }
+  } else {
+    if (!cuda_sg_block_matcher_) {
+      cuda_sg_block_matcher_ = cv::cuda::createStereoSGM();
+    }
+    copy_parameters(*sg_block_matcher_, *cuda_sg_block_matcher_);
+    cuda_sg_block_matcher_->setPreFilterCap(sg_block_matcher_->getPreFilterCap());
+    cuda_sg_block_matcher_->setUniquenessRatio(sg_block_matcher_->getUniquenessRatio());
+    cuda_sg_block_matcher_->setP1(sg_block_matcher_->getP1());
+    cuda_sg_block_matcher_->setP2(sg_block_matcher_->getP2());
+    // Only the 4 and 8 path variants exist on the device
+    cuda_sg_block_matcher_->setMode(
+      sg_block_matcher_->getMode() == cv::StereoSGBM::MODE_HH ?
+      cv::StereoSGBM::MODE_HH : cv::StereoSGBM::MODE_HH4);
+    // Fixed point like the CPU matcher
+    cuda_sg_block_matcher_->compute(cuda_left_, cuda_right_, cuda_disparity16_);
+    cuda_disparity16_.download(disparity16_);
+  }
+
+  // The device matchers leave out the speckle filter, applied here as the
+  // CPU matchers apply it
+  const int speckle_size = settings.getSpeckleWindowSize();
+  const int speckle_range = settings.getSpeckleRange();
+  if (speckle_size > 0 && speckle_range >= 0) {
+    cv::filterSpeckles(
+      disparity16_, invalid, speckle_size, speckle_range * (bm ? 1 : DPP), speckle_buffer_);
+  }
+#else
+  (void) left_rect;
+  (void) right_rect;
+  CV_Error(cv::Error::StsNotImplemented, "OpenCV was built without the cudastereo module");
+#endif
+}
+
+void StereoProcessor::writeDepth(
+  const cv::Mat & disparity, double scale, double offset, double min_valid,
+  double focal_baseline, cv::Mat & float_disparity, sensor_msgs::msg::Image & depth) const
+{
+  const bool millimeters = depth.encoding == sensor_msgs::image_encodings::TYPE_16UC1;
+  depth.encoding = millimeters ?
+    sensor_msgs::image_encodings::TYPE_16UC1 : sensor_msgs::image_encodings::TYPE_32FC1;
+  depth.height = disparity.rows;
+  depth.width = disparity.cols;
+  depth.step = depth.width * (millimeters ? sizeof(uint16_t) : sizeof(float));
+  depth.data.resize(depth.step * depth.height);
+
+  const int cols = disparity.cols;
+  const float s = static_cast<float>(scale);
+  const float o = static_cast<float>(offset);
+  const float m = static_cast<float>(min_valid);
+  const float fb = static_cast<float>(focal_baseline * (millimeters ? 1000.0 : 1.0));
+  cv::parallel_for_(
+    cv::Range(0, disparity.rows), [&](const cv::Range & range) {
+      for (int y = range.start; y < range.end; ++y) {
+        float * out = float_disparity.empty() ? nullptr : float_disparity.ptr<float>(y);
+        uint8_t * row = &depth.data[y * depth.step];
+        if (disparity.type() == CV_16SC1) {
+          const int16_t * src = disparity.ptr<int16_t>(y);
+          if (millimeters) {
+            depthRow(src, cols, s, o, m, fb, out, reinterpret_cast<uint16_t *>(row));
+          } else {
+            depthRow(src, cols, s, o, m, fb, out, reinterpret_cast<float *>(row));
+          }
+        } else {
+          const float * src = disparity.ptr<float>(y);
+          if (millimeters) {
+            depthRow(src, cols, s, o, m, fb, out, reinterpret_cast<uint16_t *>(row));
+          } else {
+            depthRow(src, cols, s, o, m, fb, out, reinterpret_cast<float *>(row));
+          }
+        }
+      }
+    });
+}
+
+cv::Mat StereoProcessor::floatDisparity(const stereo_msgs::msg::DisparityImage & disparity) const
+{
+  const sensor_msgs::msg::Image & dimage = disparity.image;
+  // The cv::Mat constructor doesn't accept a const data pointer so we remove
+  // the constness. This is "safe" since the data is only ever read.
+  uint8_t * data = const_cast<uint8_t *>(&dimage.data[0]);
+  if (dimage.encoding == sensor_msgs::image_encodings::TYPE_16SC1) {
+    const cv::Mat dmat16(dimage.height, dimage.width, CV_16SC1, data, dimage.step);
+    dmat16.convertTo(disparity32_, CV_32F, disparity.delta_d);
+    return disparity32_;
+  }
+  return cv::Mat(dimage.height, dimage.width, CV_32FC1, data, dimage.step);
+}
+
+inline bool isValidPoint(const cv::Vec3f & pt)
+{
+  // Check both for disparities explicitly marked as invalid (where OpenCV maps pt.z to MISSING_Z)
+  // and zero disparities (point mapped to infinity).
+  return pt[2] != image_geometry::StereoCameraModel::MISSING_Z && !std::isinf(pt[2]);
+}
+
+void StereoProcessor::processPoints(
+  const stereo_msgs::msg::DisparityImage & disparity,
+  const cv::Mat & color,
+  const std::string & encoding,
+  const image_geometry::StereoCameraModel & model,
+  sensor_msgs::msg::PointCloud & points) const
+{
+  // Calculate dense point cloud
+  model.projectDisparityImageTo3d(floatDisparity(disparity), dense_points_, true);
+
+  // Channel of red, green and blue in every pixel of color
+  namespace enc = sensor_msgs::image_encodings;
+  int channels = 0, red = 0, green = 0, blue = 0;
+  if (encoding == enc::MONO8) {
+    channels = 1;
+  } else if (encoding == enc::RGB8 || encoding == enc::RGBA8) {
+    channels = encoding == enc::RGB8 ? 3 : 4;
+    green = 1;
+    blue = 2;
+  } else if (encoding == enc::BGR8 || encoding == enc::BGRA8) {
+    channels = encoding == enc::BGR8 ? 3 : 4;
+    red = 2;
+    green = 1;
   } else {
     RCUTILS_LOG_WARN(
       "Could not fill color channel of the point cloud, unrecognized encoding '%s'",
       encoding.c_str());
   }
+
+  // Count the valid points of every row, so that each row knows where its
+  // points start in the sparse cloud
+  const int rows = dense_points_.rows;
+  const int cols = dense_points_.cols;
+  std::vector<size_t> row_start(rows + 1, 0);
+  cv::parallel_for_(
+    cv::Range(0, rows), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const cv::Vec3f * row = dense_points_[v];
+        size_t count = 0;
+        for (int u = 0; u < cols; ++u) {
+          count += isValidPoint(row[u]);
+        }
+        row_start[v + 1] = count;
+      }
+    });
+  for (int v = 0; v < rows; ++v) {
+    row_start[v + 1] += row_start[v];
+  }
+  const size_t total = row_start[rows];
+
+  // Fill in sparse point cloud message
+  points.points.resize(total);
+  points.channels.resize(3);
+  points.channels[0].name = "rgb";
+  points.channels[0].values.resize(channels > 0 ? total : 0);
+  points.channels[1].name = "u";
+  points.channels[1].values.resize(total);
+  points.channels[2].name = "v";
+  points.channels[2].values.resize(total);
+
+  // Position, pixel and color of every valid point in a single pass. As
+  // always, the "u" channel holds the row and the "v" channel the column.
+  cv::parallel_for_(
+    cv::Range(0, rows), [&](const cv::Range & range) {
+      for (int v = range.start; v < range.end; ++v) {
+        const cv::Vec3f * row = dense_points_[v];
+        const uint8_t * color_row = channels > 0 ? color.ptr<uint8_t>(v) : nullptr;
+        size_t i = row_start[v];
+        for (int u = 0; u < cols; ++u) {
+          if (!isValidPoint(row[u])) {
+            continue;
+          }
+          geometry_msgs::msg::Point32 & pt = points.points[i];
+          pt.x = row[u][0];
+          pt.y = row[u][1];
+          pt.z = row[u][2];
+          points.channels[1].values[i] = v;
+          points.channels[2].values[i] = u;
+          if (color_row) {
+            const uint8_t * pixel = color_row + u * channels;
+            const uint32_t rgb_packed = (static_cast<uint32_t>(pixel[red]) << 16) |
+              (static_cast<uint32_t>(pixel[green]) << 8) | pixel[blue];
+            std::memcpy(&points.channels[0].values[i], &rgb_packed, sizeof(float));
+          }
+          ++i;
+        }
+      }
+    });
 }
 
 void StereoProcessor::processPoints2(
@@ -258,18 +1131,9 @@ void StereoProcessor::processPoints2(
   const image_geometry::StereoCameraModel & model,
   sensor_msgs::msg::PointCloud2 & points) const
 {
-  // Calculate dense point cloud
-  const sensor_msgs::msg::Image & dimage = disparity.image;
-  // The cv::Mat_ constructor doesn't accept a const data data pointer
-  // so we remove the constness before reinterpreting into float.
-  // This is "safe" since our cv::Mat is const.
-  float * data = reinterpret_cast<float *>(const_cast<uint8_t *>(&dimage.data[0]));
-  const cv::Mat_<float> dmat(dimage.height, dimage.width, data, dimage.step);
-  model.projectDisparityImageTo3d(dmat, dense_points_, true);
-
   // Fill in sparse point cloud message
-  points.height = dense_points_.rows;
-  points.width = dense_points_.cols;
+  points.height = disparity.image.height;
+  points.width = disparity.image.width;
   points.fields.resize(4);
   points.fields[0].name = "x";
   points.fields[0].offset = 0;
@@ -293,15 +1157,88 @@ void StereoProcessor::processPoints2(
   points.data.resize(points.row_step * points.height);
   points.is_dense = false;  // there may be invalid points
 
+  bool color_filled;
+  if (stripe_rows_ > 0 && static_cast<int>(points.height) > stripe_rows_) {
+    color_filled = processPoints2Striped(disparity, color, encoding, model, points);
+  } else {
+    // Calculate dense point cloud
+    model.projectDisparityImageTo3d(floatDisparity(disparity), dense_points_, true);
+    color_filled = writePoints2(dense_points_, color, encoding, 0, points);
+  }
+  if (!color_filled) {
+    RCUTILS_LOG_WARN(
+      "Could not fill color channel of the point cloud, unrecognized encoding '%s'",
+      encoding.c_str());
+  }
+}
+
+bool StereoProcessor::processPoints2Striped(
+  const stereo_msgs::msg::DisparityImage & disparity,
+  const cv::Mat & color,
+  const std::string & encoding,
+  const image_geometry::StereoCameraModel & model,
+  sensor_msgs::msg::PointCloud2 & points) const
+{
+  const cv::Mat float_disparity = floatDisparity(disparity);
+  const int rows = float_disparity.rows;
+  const int stripes = (rows + stripe_rows_ - 1) / stripe_rows_;
+  const int workers = stripeWorkers(stripes);
+
+  // The missing value of projectDisparityImageTo3d is the smallest disparity
+  // of the whole image, not of a stripe
+  double missing = 0.0;
+  cv::minMaxLoc(float_disparity, &missing);
+
+  stripe_points_.resize(workers);
+  std::atomic<bool> color_filled{true};
+  cv::parallel_for_(
+    cv::Range(0, workers), [&](const cv::Range & range) {
+      for (int w = range.start; w < range.end; ++w) {
+        for (int s = w; s < stripes; s += workers) {
+          const int y0 = s * stripe_rows_;
+          const int y1 = std::min(rows, y0 + stripe_rows_);
+          // Q with the rows of the stripe moved down to where they are in the image
+          cv::Matx44d shift = cv::Matx44d::eye();
+          shift(1, 3) = y0;
+          const cv::Matx44d q = model.reprojectionMatrix() * shift;
+
+          const cv::Mat stripe = float_disparity.rowRange(y0, y1);
+          cv::Mat_<cv::Vec3f> & dense = stripe_points_[w];
+          cv::reprojectImageTo3D(stripe, dense, cv::Mat(q), false);
+          for (int v = 0; v < dense.rows; ++v) {
+            const float * d = stripe.ptr<float>(v);
+            for (int u = 0; u < dense.cols; ++u) {
+              if (d[u] == missing) {
+                dense(v, u)[2] = static_cast<float>(image_geometry::StereoCameraModel::MISSING_Z);
+              }
+            }
+          }
+          if (!writePoints2(dense, color.rowRange(y0, y1), encoding, y0, points)) {
+            color_filled = false;
+          }
+        }
+      }
+    }, workers);
+  return color_filled;
+}
+
+bool StereoProcessor::writePoints2(
+  const cv::Mat_<cv::Vec3f> & dense,
+  const cv::Mat & color,
+  const std::string & encoding,
+  int first_row,
+  sensor_msgs::msg::PointCloud2 & points) const
+{
   float bad_point = std::numeric_limits<float>::quiet_NaN();
-  int i = 0;
-  for (int32_t u = 0; u < dense_points_.rows; ++u) {
-    for (int32_t v = 0; v < dense_points_.cols; ++v, ++i) {
-      if (isValidPoint(dense_points_(u, v))) {
+  const size_t first = static_cast<size_t>(first_row) * dense.cols;
+  size_t i = first;
+  for (int32_t u = 0; u < dense.rows; ++u) {
+    for (int32_t v = 0; v < dense.cols; ++v, ++i) {
+      if (isValidPoint(dense(u, v))) {
         // x,y,z,rgba
-        memcpy(&points.data[i * points.point_step + 0], &dense_points_(u, v)[0], sizeof(float));
-        memcpy(&points.data[i * points.point_step + 4], &dense_points_(u, v)[1], sizeof(float));
-        memcpy(&points.data[i * points.point_step + 8], &dense_points_(u, v)[2], sizeof(float));
+        memcpy(&points.data[i * points.point_step + 0], &dense(u, v)[0], sizeof(float));
+        memcpy(&points.data[i * points.point_step + 4], &dense(u, v)[1], sizeof(float));
+        memcpy(&points.data[i * points.point_step + 8], &dense(u, v)[2], sizeof(float));
       } else {
         memcpy(&points.data[i * points.point_step + 0], &bad_point, sizeof(float));
         memcpy(&points.data[i * points.point_step + 4], &bad_point, sizeof(float));
@@ -312,11 +1249,11 @@ void StereoProcessor::processPoints2(
 
   // Fill in color
   namespace enc = sensor_msgs::image_encodings;
-  i = 0;
+  i = first;
   if (encoding == enc::MONO8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v, ++i) {
-        if (isValidPoint(dense_points_(u, v))) {
+    for (int32_t u = 0; u < dense.rows; ++u) {
+      for (int32_t v = 0; v < dense.cols; ++v, ++i) {
+        if (isValidPoint(dense(u, v))) {
           uint8_t g = color.at<uint8_t>(u, v);
           int32_t rgb = (g << 16) | (g << 8) | g;
           memcpy(&points.data[i * points.point_step + 12], &rgb, sizeof(int32_t));
@@ -326,9 +1263,9 @@ void StereoProcessor::processPoints2(
       }
     }
   } else if (encoding == enc::RGB8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v, ++i) {
-        if (isValidPoint(dense_points_(u, v))) {
+    for (int32_t u = 0; u < dense.rows; ++u) {
+      for (int32_t v = 0; v < dense.cols; ++v, ++i) {
+        if (isValidPoint(dense(u, v))) {
           const cv::Vec3b & rgb = color.at<cv::Vec3b>(u, v);
           int32_t rgb_packed = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
           memcpy(&points.data[i * points.point_step + 12], &rgb_packed, sizeof(int32_t));
@@ -338,9 +1275,9 @@ void StereoProcessor::processPoints2(
       }
     }
   } else if (encoding == enc::RGBA8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v, ++i) {
-        if (isValidPoint(dense_points_(u, v))) {
+    for (int32_t u = 0; u < dense.rows; ++u) {
+      for (int32_t v = 0; v < dense.cols; ++v, ++i) {
+        if (isValidPoint(dense(u, v))) {
           const cv::Vec4b & rgb = color.at<cv::Vec4b>(u, v);
           int32_t rgb_packed = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
           memcpy(&points.data[i * points.point_step + 12], &rgb_packed, sizeof(int32_t));
@@ -350,9 +1287,9 @@ void StereoProcessor::processPoints2(
       }
     }
   } else if (encoding == enc::BGR8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v, ++i) {
-        if (isValidPoint(dense_points_(u, v))) {
+    for (int32_t u = 0; u < dense.rows; ++u) {
+      for (int32_t v = 0; v < dense.cols; ++v, ++i) {
+        if (isValidPoint(dense(u, v))) {
           const cv::Vec3b & bgr = color.at<cv::Vec3b>(u, v);
           int32_t rgb_packed = (bgr[2] << 16) | (bgr[1] << 8) | bgr[0];
           memcpy(&points.data[i * points.point_step + 12], &rgb_packed, sizeof(int32_t));
@@ -362,9 +1299,9 @@ void StereoProcessor::processPoints2(
       }
     }
   } else if (encoding == enc::BGRA8) {
-    for (int32_t u = 0; u < dense_points_.rows; ++u) {
-      for (int32_t v = 0; v < dense_points_.cols; ++v, ++i) {
-        if (isValidPoint(dense_points_(u, v))) {
+    for (int32_t u = 0; u < dense.rows; ++u) {
+      for (int32_t v = 0; v < dense.cols; ++v, ++i) {
+        if (isValidPoint(dense(u, v))) {
           const cv::Vec4b & bgr = color.at<cv::Vec4b>(u, v);
           int32_t rgb_packed = (bgr[2] << 16) | (bgr[1] << 8) | bgr[0];
           memcpy(&points.data[i * points.point_step + 12], &rgb_packed, sizeof(int32_t));
@@ -374,10 +1311,9 @@ void StereoProcessor::processPoints2(
       }
     }
   } else {
-    RCUTILS_LOG_WARN(
-      "Could not fill color channel of the point cloud, unrecognized encoding '%s'",
-      encoding.c_str());
+    return false;
   }
+  return true;
 }
 
 }  // namespace stereo_image_proc
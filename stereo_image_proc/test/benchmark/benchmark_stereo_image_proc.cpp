@@ -0,0 +1,248 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "image_geometry/stereo_camera_model.hpp"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <stereo_image_proc/stereo_processor.hpp>
+#include <stereo_msgs/msg/disparity_image.hpp>
+
+namespace enc = sensor_msgs::image_encodings;
+
+using stereo_image_proc::StereoProcessor;
+
+namespace
+{
+
+// Resolutions to run every benchmark at
+const std::vector<std::pair<int, int>> kResolutions = {{640, 480}, {1280, 720}, {1920, 1080}};
+
+// Disparity of the synthetic pair, in pixels
+constexpr int kShift = 24;
+
+// The left image of the aloe pair of the test data at the given resolution, BGR8
+const cv::Mat & colorImage(int width, int height)
+{
+  static std::map<std::pair<int, int>, cv::Mat> images;
+  cv::Mat & image = images[{width, height}];
+  if (image.empty()) {
+    cv::Mat scene = cv::imread(
+      std::string(_SRC_RESOURCES_DIR_PATH) + "/aloe-L.png", cv::IMREAD_COLOR);
+    if (scene.empty()) {
+      // Gradient so the matchers still see varying input
+      scene.create(256, 256, CV_8UC3);
+      for (int y = 0; y < scene.rows; ++y) {
+        for (int x = 0; x < scene.cols; ++x) {
+          scene.at<cv::Vec3b>(y, x) = cv::Vec3b(x, y, (x + y) / 2);
+        }
+      }
+    }
+    cv::resize(scene, image, cv::Size(width, height), 0.0, 0.0, cv::INTER_LINEAR);
+  }
+  return image;
+}
+
+// Rectified pair of colorImage, the right image shifted left by kShift
+void rectifiedPair(int width, int height, cv::Mat & left, cv::Mat & right)
+{
+  cv::cvtColor(colorImage(width, height), left, cv::COLOR_BGR2GRAY);
+  right = cv::Mat::zeros(left.size(), left.type());
+  left.colRange(kShift, width).copyTo(right.colRange(0, width - kShift));
+}
+
+// Pair of cameras 10 cm apart with a 70 degree horizontal field of view
+image_geometry::StereoCameraModel stereoModel(int width, int height)
+{
+  sensor_msgs::msg::CameraInfo left, right;
+  left.width = width;
+  left.height = height;
+  const double f = 0.7 * width;
+  left.k = {f, 0.0, width / 2.0, 0.0, f, height / 2.0, 0.0, 0.0, 1.0};
+  left.r = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+  left.p = {f, 0.0, width / 2.0, 0.0, 0.0, f, height / 2.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  left.distortion_model = "plumb_bob";
+  left.d.assign(5, 0.0);
+  right = left;
+  right.p[3] = -f * 0.1;
+
+  image_geometry::StereoCameraModel model;
+  model.fromCameraInfo(left, right);
+  return model;
+}
+
+// Arguments: width, height, stereo algorithm, fixed point disparity
+void disparityArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "algorithm", "fixed_point"});
+  for (const auto & resolution : kResolutions) {
+    for (int algorithm : {StereoProcessor::BM, StereoProcessor::SGBM}) {
+      for (int fixed_point : {0, 1}) {
+        benchmark->Args({resolution.first, resolution.second, algorithm, fixed_point});
+      }
+    }
+  }
+}
+
+void configure(StereoProcessor & processor, int algorithm, bool fixed_point)
+{
+  processor.setStereoType(static_cast<StereoProcessor::StereoType>(algorithm));
+  processor.setDisparityRange(64);
+  processor.setCorrelationWindowSize(algorithm == StereoProcessor::BM ? 15 : 5);
+  processor.setFixedPointDisparity(fixed_point);
+}
+
+void setPixelsProcessed(benchmark::State & state)
+{
+  state.SetItemsProcessed(
+    static_cast<int64_t>(state.iterations()) * state.range(0) * state.range(1));
+}
+
+void BM_ProcessDisparity(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const bool fixed_point = state.range(3) != 0;
+  cv::Mat left, right;
+  rectifiedPair(width, height, left, right);
+  const auto model = stereoModel(width, height);
+  StereoProcessor processor;
+  configure(processor, state.range(2), fixed_point);
+
+  stereo_msgs::msg::DisparityImage disparity;
+  for (auto _ : state) {
+    processor.processDisparity(left, right, model, disparity);
+    benchmark::DoNotOptimize(disparity.image.data.data());
+  }
+  state.SetLabel(fixed_point ? enc::TYPE_16SC1 : enc::TYPE_32FC1);
+  setPixelsProcessed(state);
+}
+BENCHMARK(BM_ProcessDisparity)->Apply(disparityArguments)->UseRealTime();
+
+const std::vector<std::string> kDepthEncodings = {enc::TYPE_32FC1, enc::TYPE_16UC1};
+
+// Arguments: width, height, stereo algorithm, index in kDepthEncodings
+void depthArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "algorithm", "encoding"});
+  for (const auto & resolution : kResolutions) {
+    for (int algorithm : {StereoProcessor::BM, StereoProcessor::SGBM}) {
+      for (int encoding = 0; encoding < static_cast<int>(kDepthEncodings.size()); ++encoding) {
+        benchmark->Args({resolution.first, resolution.second, algorithm, encoding});
+      }
+    }
+  }
+}
+
+// The float disparity and the depth image of a pair, in one pass
+void BM_ProcessDisparityDepth(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kDepthEncodings[state.range(3)];
+  cv::Mat left, right;
+  rectifiedPair(width, height, left, right);
+  const auto model = stereoModel(width, height);
+  StereoProcessor processor;
+  configure(processor, state.range(2), false);
+
+  stereo_msgs::msg::DisparityImage disparity;
+  sensor_msgs::msg::Image depth;
+  for (auto _ : state) {
+    depth.encoding = encoding;
+    processor.processDisparity(left, right, model, disparity, &depth);
+    benchmark::DoNotOptimize(depth.data.data());
+  }
+  state.SetLabel(encoding);
+  setPixelsProcessed(state);
+}
+BENCHMARK(BM_ProcessDisparityDepth)->Apply(depthArguments)->UseRealTime();
+
+const std::vector<std::string> kColorEncodings = {enc::MONO8, enc::BGR8, enc::RGB8};
+
+// Arguments: width, height, index in kColorEncodings, fixed point disparity
+void pointsArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"width", "height", "encoding", "fixed_point"});
+  for (const auto & resolution : kResolutions) {
+    for (size_t i = 0; i < kColorEncodings.size(); ++i) {
+      for (int fixed_point : {0, 1}) {
+        benchmark->Args(
+          {resolution.first, resolution.second, static_cast<int64_t>(i), fixed_point});
+      }
+    }
+  }
+}
+
+void BM_ProcessPoints2(benchmark::State & state)
+{
+  const int width = state.range(0);
+  const int height = state.range(1);
+  const std::string & encoding = kColorEncodings[state.range(2)];
+  cv::Mat left, right;
+  rectifiedPair(width, height, left, right);
+  const auto model = stereoModel(width, height);
+  StereoProcessor processor;
+  configure(processor, StereoProcessor::BM, state.range(3) != 0);
+  stereo_msgs::msg::DisparityImage disparity;
+  processor.processDisparity(left, right, model, disparity);
+
+  cv::Mat color = colorImage(width, height);
+  if (encoding == enc::MONO8) {
+    color = left;
+  } else if (encoding == enc::RGB8) {
+    cv::cvtColor(color, color, cv::COLOR_BGR2RGB);
+  }
+
+  sensor_msgs::msg::PointCloud2 points;
+  for (auto _ : state) {
+    processor.processPoints2(disparity, color, encoding, model, points);
+    benchmark::DoNotOptimize(points.data.data());
+  }
+  state.SetLabel(encoding + "/" + disparity.image.encoding);
+  setPixelsProcessed(state);
+}
+BENCHMARK(BM_ProcessPoints2)->Apply(pointsArguments)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,94 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef STEREO_PAIR_HPP_
+#define STEREO_PAIR_HPP_
+
+#include <cstring>
+#include <memory>
+
+#include <opencv2/core/core.hpp>
+
+#include "image_geometry/stereo_camera_model.hpp"
+
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
+#include <sensor_msgs/msg/image.hpp>
+
+// Disparity of the synthetic pair, in pixels
+constexpr int kShift = 16;
+
+// Rectified pair of random texture, the right image shifted left by kShift
+inline void rectifiedPair(int width, int height, cv::Mat & left, cv::Mat & right)
+{
+  left.create(height, width, CV_8UC1);
+  cv::RNG rng(42);
+  rng.fill(left, cv::RNG::UNIFORM, 0, 256);
+  right = cv::Mat::zeros(left.size(), left.type());
+  left.colRange(kShift, width).copyTo(right.colRange(0, width - kShift));
+}
+
+// Pair of cameras 10 cm apart
+inline image_geometry::StereoCameraModel stereoModel(int width, int height)
+{
+  sensor_msgs::msg::CameraInfo left, right;
+  left.width = width;
+  left.height = height;
+  const double f = 0.7 * width;
+  left.k = {f, 0.0, width / 2.0, 0.0, f, height / 2.0, 0.0, 0.0, 1.0};
+  left.r = {1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0};
+  left.p = {f, 0.0, width / 2.0, 0.0, 0.0, f, height / 2.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  left.distortion_model = "plumb_bob";
+  left.d.assign(5, 0.0);
+  right = left;
+  right.p[3] = -f * 0.1;
+
+  image_geometry::StereoCameraModel model;
+  model.fromCameraInfo(left, right);
+  return model;
+}
+
+// Raw mono8 message of image
+inline sensor_msgs::msg::Image::ConstSharedPtr imageMessage(const cv::Mat & image)
+{
+  auto msg = std::make_shared<sensor_msgs::msg::Image>();
+  msg->width = image.cols;
+  msg->height = image.rows;
+  msg->encoding = sensor_msgs::image_encodings::MONO8;
+  msg->step = image.cols;
+  msg->data.resize(image.total());
+  std::memcpy(msg->data.data(), image.data, image.total());
+  return msg;
+}
+
+#endif  // STEREO_PAIR_HPP_
@@ -0,0 +1,193 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <opencv2/core/core.hpp>
+
+#include "image_geometry/stereo_camera_model.hpp"
+#include "stereo_image_proc/disparity_projection.hpp"
+#include "stereo_pair.hpp"
+
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <sensor_msgs/msg/point_field.hpp>
+#include <stereo_msgs/msg/disparity_image.hpp>
+
+using image_geometry::StereoCameraModel;
+
+namespace
+{
+
+constexpr int kWidth = 83;
+constexpr int kHeight = 37;
+// Not a multiple of four wide, so that rows end past the vectorized points
+const cv::Rect kWindow(10, 5, 41, 20);
+
+// Fixed point disparities of 1 to 64 pixels, with invalid ones one pixel below
+// the minimum and zero ones projected to infinity, both inside kWindow too
+cv::Mat_<int16_t> fixedPointDisparities()
+{
+  cv::Mat_<int16_t> disparity(kHeight, kWidth);
+  cv::RNG rng(7);
+  rng.fill(disparity, cv::RNG::UNIFORM, 16, 64 * 16);
+  for (int i = 0; i < 200; ++i) {
+    disparity(rng.uniform(0, kHeight), rng.uniform(0, kWidth)) = -16;
+    disparity(rng.uniform(0, kHeight), rng.uniform(0, kWidth)) = 0;
+  }
+  disparity(kWindow.y + 1, kWindow.x + 2) = -16;
+  disparity(kWindow.y + 3, kWindow.x + 4) = 0;
+  return disparity;
+}
+
+stereo_msgs::msg::DisparityImage disparityMessage(
+  const cv::Mat_<int16_t> & disparity16, bool fixed_point)
+{
+  stereo_msgs::msg::DisparityImage disparity;
+  disparity.delta_d = 1.0f / 16;
+  sensor_msgs::msg::Image & image = disparity.image;
+  image.width = disparity16.cols;
+  image.height = disparity16.rows;
+  image.encoding = fixed_point ?
+    sensor_msgs::image_encodings::TYPE_16SC1 : sensor_msgs::image_encodings::TYPE_32FC1;
+  cv::Mat mat = disparity16;
+  if (!fixed_point) {
+    disparity16.convertTo(mat, CV_32FC1, disparity.delta_d);
+  }
+  image.step = static_cast<uint32_t>(mat.cols * mat.elemSize());
+  image.data.resize(image.step * image.height);
+  std::memcpy(image.data.data(), mat.data, image.data.size());
+  return disparity;
+}
+
+// Organized cloud of float x, y and z at the start of every point_step bytes,
+// and of rgb at rgb_offset unless it is negative
+sensor_msgs::msg::PointCloud2 cloud(int width, int height, int point_step, int rgb_offset)
+{
+  sensor_msgs::msg::PointCloud2 points;
+  points.width = width;
+  points.height = height;
+  points.point_step = point_step;
+  points.row_step = width * point_step;
+  points.data.resize(points.row_step * height);
+  const std::string names[] = {"x", "y", "z", "rgb"};
+  for (int i = 0; i < (rgb_offset >= 0 ? 4 : 3); ++i) {
+    sensor_msgs::msg::PointField field;
+    field.name = names[i];
+    field.offset = i < 3 ? 4 * i : rgb_offset;
+    field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+    field.count = 1;
+    points.fields.push_back(field);
+  }
+  return points;
+}
+
+}  // namespace
+
+TEST(DisparityProjection, matchesProjectDisparityImageTo3d)
+{
+  const auto model = stereoModel(kWidth, kHeight);
+  const cv::Mat_<int16_t> disparity16 = fixedPointDisparities();
+
+  // What the point cloud nodes did before: the whole image through OpenCV.
+  // The invalid disparities being the smallest of kWindow as well, the points
+  // of the window are a crop of it.
+  cv::Mat disparity32, expected;
+  disparity16.convertTo(disparity32, CV_32FC1, 1.0 / 16);
+  model.projectDisparityImageTo3d(disparity32, expected, true);
+
+  cv::Mat color(kHeight, kWidth, CV_8UC3);
+  cv::RNG(3).fill(color, cv::RNG::UNIFORM, 0, 256);
+  auto color_msg = std::make_shared<sensor_msgs::msg::Image>();
+  color_msg->width = kWidth;
+  color_msg->height = kHeight;
+  color_msg->encoding = sensor_msgs::image_encodings::BGR8;
+  color_msg->step = kWidth * 3;
+  color_msg->data.assign(color.data, color.data + color.total() * 3);
+
+  // Point step and rgb offset, none with a negative one
+  const std::pair<int, int> layouts[] = {{12, -1}, {16, -1}, {16, 12}, {32, 16}};
+  for (bool fixed_point : {false, true}) {
+    const auto disparity = disparityMessage(disparity16, fixed_point);
+    for (const auto & layout : layouts) {
+      for (bool windowed : {false, true}) {
+        SCOPED_TRACE(
+          std::string(fixed_point ? "16SC1" : "32FC1") +
+          ", point step " + std::to_string(layout.first) +
+          ", rgb offset " + std::to_string(layout.second) + (windowed ? ", window" : ""));
+        const cv::Rect window = windowed ? kWindow : cv::Rect(0, 0, kWidth, kHeight);
+        auto points = cloud(window.width, window.height, layout.first, layout.second);
+        const sensor_msgs::msg::Image::ConstSharedPtr rgb =
+          layout.second >= 0 ? color_msg : nullptr;
+        ASSERT_TRUE(
+          windowed ?
+          stereo_image_proc::projectDisparityToCloud(disparity, rgb, model, window, points) :
+          stereo_image_proc::projectDisparityToCloud(disparity, rgb, model, points));
+
+        for (int v = 0; v < window.height; ++v) {
+          for (int u = 0; u < window.width; ++u) {
+            const uint8_t * point = &points.data[v * points.row_step + u * points.point_step];
+            float xyz[3];
+            std::memcpy(xyz, point, sizeof(xyz));
+            const cv::Vec3f & ref = expected.at<cv::Vec3f>(window.y + v, window.x + u);
+            const bool ref_valid =
+              ref[2] != StereoCameraModel::MISSING_Z && !std::isinf(ref[2]);
+            for (int i = 0; i < 3; ++i) {
+              if (!ref_valid) {
+                ASSERT_TRUE(std::isnan(xyz[i])) << "at (" << u << ", " << v << ")";
+              } else {
+                ASSERT_NEAR(xyz[i], ref[i], 1e-4 * std::abs(ref[i]) + 1e-5) <<
+                  "at (" << u << ", " << v << ")";
+              }
+            }
+            if (layout.second >= 0) {
+              const cv::Vec3b & bgr = color.at<cv::Vec3b>(window.y + v, window.x + u);
+              uint32_t rgb_value;
+              std::memcpy(&rgb_value, point + layout.second, sizeof(rgb_value));
+              const uint32_t expected_rgb = (static_cast<uint32_t>(bgr[2]) << 16) |
+                (static_cast<uint32_t>(bgr[1]) << 8) | bgr[0];
+              EXPECT_EQ(rgb_value, expected_rgb) << "at (" << u << ", " << v << ")";
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,137 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "stereo_image_proc/stereo_batch_processor.hpp"
+#include "stereo_image_proc/stereo_processor.hpp"
+#include "stereo_pair.hpp"
+
+using stereo_image_proc::StereoBatchProcessor;
+using stereo_image_proc::StereoImageSet;
+using stereo_image_proc::StereoProcessor;
+
+namespace
+{
+
+void configure(StereoProcessor & processor)
+{
+  processor.setDisparityRange(32);
+  processor.setCorrelationWindowSize(15);
+  processor.setSpeckleSize(100);
+  processor.setSpeckleRange(4);
+  // As StereoBatchNode does by default
+  processor.setParallelMono(true);
+}
+
+}  // namespace
+
+TEST(StereoBatchProcessor, matchesSingleProcessor)
+{
+  cv::Mat left, right;
+  rectifiedPair(320, 240, left, right);
+  const auto model = stereoModel(320, 240);
+  const auto left_msg = imageMessage(left);
+  const auto right_msg = imageMessage(right);
+  const int flags = StereoProcessor::LEFT_RECT | StereoProcessor::RIGHT_RECT |
+    StereoProcessor::DISPARITY | StereoProcessor::POINT_CLOUD2;
+
+  StereoProcessor single;
+  configure(single);
+  StereoImageSet expected;
+  ASSERT_TRUE(single.process(left_msg, right_msg, model, expected, flags));
+
+  // Outputs of the pairs, destroyed after the processor stopped calling back
+  constexpr size_t kPairs = 3;
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t done = 0;
+  std::vector<bool> ok(kPairs);
+  std::vector<StereoImageSet> outputs(kPairs);
+
+  // Pairs of different priorities on fewer threads than they have cameras
+  StereoBatchProcessor batch(2);
+  for (int priority : {0, 1, 0}) {
+    batch.addPair(priority);
+  }
+  batch.configure(configure);
+
+  // Twice, so that the second round reuses the buffers of the first
+  for (int round = 0; round < 2; ++round) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      done = 0;
+      ok.assign(kPairs, false);
+    }
+    for (size_t i = 0; i < kPairs; ++i) {
+      auto callback = [&, i](bool pair_ok, const StereoImageSet & output) {
+          std::lock_guard<std::mutex> lock(mutex);
+          // The images borrow the buffers of the pair, keep copies
+          ok[i] = pair_ok;
+          outputs[i] = output;
+          outputs[i].left.rect = output.left.rect.clone();
+          outputs[i].right.rect = output.right.rect.clone();
+          ++done;
+          condition.notify_all();
+        };
+      // A pair is busy until its callback of the previous round returned
+      while (!batch.submit(i, left_msg, right_msg, model, flags, callback)) {
+        std::this_thread::yield();
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(
+      condition.wait_for(
+        lock, std::chrono::seconds(30), [&] {return done == kPairs;}));
+    for (size_t i = 0; i < kPairs; ++i) {
+      ASSERT_TRUE(ok[i]) << "pair " << i;
+      const StereoImageSet & output = outputs[i];
+      EXPECT_EQ(cv::norm(output.left.rect, expected.left.rect, cv::NORM_INF), 0.0);
+      EXPECT_EQ(cv::norm(output.right.rect, expected.right.rect, cv::NORM_INF), 0.0);
+      EXPECT_EQ(output.disparity.image.encoding, expected.disparity.image.encoding);
+      EXPECT_EQ(output.disparity.image.data, expected.disparity.image.data);
+      EXPECT_EQ(output.disparity.min_disparity, expected.disparity.min_disparity);
+      EXPECT_EQ(output.disparity.max_disparity, expected.disparity.max_disparity);
+      EXPECT_EQ(output.points2.data, expected.points2.data);
+    }
+  }
+}
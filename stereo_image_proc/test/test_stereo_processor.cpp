@@ -0,0 +1,293 @@
+// Copyright 2026, image_pipeline contributors
+// All rights reserved.
+//
+// Software License Agreement (BSD License 2.0)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// * Redistributions of source code must retain the above copyright
+//   notice, this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above
+//   copyright notice, this list of conditions and the following
+//   disclaimer in the documentation and/or other materials provided
+//   with the distribution.
+// * Neither the name of {copyright_holder} nor the names of its
+//   contributors may be used to endorse or promote products derived
+//   from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "image_geometry/stereo_camera_model.hpp"
+#include "stereo_image_proc/stereo_processor.hpp"
+#include "stereo_pair.hpp"
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <stereo_msgs/msg/disparity_image.hpp>
+
+using stereo_image_proc::StereoProcessor;
+
+// The aloe pair of the test data, mono8
+void aloePair(cv::Mat & left, cv::Mat & right)
+{
+  left = cv::imread(std::string(_SRC_RESOURCES_DIR_PATH) + "/aloe-L.png", cv::IMREAD_GRAYSCALE);
+  right = cv::imread(std::string(_SRC_RESOURCES_DIR_PATH) + "/aloe-R.png", cv::IMREAD_GRAYSCALE);
+}
+
+// Matcher of the given type, filtering regions of up to 100 pixels
+void configureSpeckleFilter(
+  StereoProcessor & processor, StereoProcessor::StereoType type, bool fixed_point)
+{
+  processor.setStereoType(type);
+  processor.setDisparityRange(64);
+  processor.setCorrelationWindowSize(type == StereoProcessor::BM ? 15 : 7);
+  processor.setSpeckleSize(100);
+  processor.setSpeckleRange(4);
+  processor.setFixedPointDisparity(fixed_point);
+}
+
+// Disparity of the matcher as published, in fixed point
+cv::Mat_<int16_t> disparity16(const stereo_msgs::msg::DisparityImage & disparity)
+{
+  const sensor_msgs::msg::Image & image = disparity.image;
+  const cv::Mat_<int16_t> mat(
+    image.height, image.width,
+    reinterpret_cast<int16_t *>(const_cast<uint8_t *>(image.data.data())), image.step);
+  return mat.clone();
+}
+
+TEST(StereoProcessor, windowKeepsHeader)
+{
+  cv::Mat left, right;
+  rectifiedPair(320, 240, left, right);
+  const auto model = stereoModel(320, 240);
+  StereoProcessor processor;
+  processor.setDisparityRange(32);
+
+  stereo_msgs::msg::DisparityImage disparity;
+  disparity.header.frame_id = "left_camera";
+  disparity.header.stamp.sec = 12;
+  disparity.header.stamp.nanosec = 345;
+  disparity.image.header = disparity.header;
+  processor.processDisparity(left, right, model, cv::Rect(100, 80, 64, 48), disparity);
+
+  EXPECT_EQ(disparity.image.header.frame_id, "left_camera");
+  EXPECT_EQ(disparity.image.header.stamp.sec, 12);
+  EXPECT_EQ(disparity.image.header.stamp.nanosec, 345u);
+  EXPECT_EQ(disparity.image.width, 320u);
+  EXPECT_EQ(disparity.valid_window.width, 64u);
+}
+
+TEST(StereoProcessor, stripedMatchesWholeImage)
+{
+  cv::Mat left, right;
+  rectifiedPair(320, 240, left, right);
+  const auto model = stereoModel(320, 240);
+
+  for (bool fixed_point : {false, true}) {
+    StereoProcessor whole;
+    whole.setDisparityRange(32);
+    whole.setCorrelationWindowSize(15);
+    whole.setSpeckleSize(100);
+    whole.setSpeckleRange(4);
+    whole.setFixedPointDisparity(fixed_point);
+    stereo_msgs::msg::DisparityImage expected;
+    whole.processDisparity(left, right, model, expected);
+
+    // Stripes that do not divide the image, matched one after the other and
+    // concurrently
+    for (bool parallel : {false, true}) {
+      StereoProcessor striped;
+      striped.setDisparityRange(32);
+      striped.setCorrelationWindowSize(15);
+      striped.setSpeckleSize(100);
+      striped.setSpeckleRange(4);
+      striped.setFixedPointDisparity(fixed_point);
+      striped.setStripeRows(50);
+      striped.setParallelStripes(parallel);
+      stereo_msgs::msg::DisparityImage disparity;
+      striped.processDisparity(left, right, model, disparity);
+
+      EXPECT_EQ(disparity.image.encoding, expected.image.encoding);
+      EXPECT_EQ(disparity.image.data, expected.image.data);
+      EXPECT_EQ(disparity.min_disparity, expected.min_disparity);
+      EXPECT_EQ(disparity.max_disparity, expected.max_disparity);
+    }
+  }
+}
+
+TEST(StereoProcessor, stripedPointsMatchWholeImage)
+{
+  cv::Mat left, right;
+  rectifiedPair(320, 240, left, right);
+  const auto model = stereoModel(320, 240);
+  cv::Mat color;
+  cv::cvtColor(left, color, cv::COLOR_GRAY2BGR);
+
+  StereoProcessor whole;
+  whole.setDisparityRange(32);
+  stereo_msgs::msg::DisparityImage disparity;
+  whole.processDisparity(left, right, model, disparity);
+  sensor_msgs::msg::PointCloud2 expected;
+  whole.processPoints2(disparity, color, "bgr8", model, expected);
+
+  StereoProcessor striped;
+  striped.setDisparityRange(32);
+  striped.setStripeRows(50);
+  striped.setParallelStripes(true);
+  sensor_msgs::msg::PointCloud2 points;
+  striped.processPoints2(disparity, color, "bgr8", model, points);
+
+  ASSERT_EQ(points.data.size(), expected.data.size());
+  const float * xyz = reinterpret_cast<const float *>(points.data.data());
+  const float * expected_xyz = reinterpret_cast<const float *>(expected.data.data());
+  for (size_t i = 0; i < points.width * points.height; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      const float a = xyz[4 * i + c];
+      const float b = expected_xyz[4 * i + c];
+      if (std::isnan(b)) {
+        EXPECT_TRUE(std::isnan(a)) << "point " << i;
+      } else {
+        EXPECT_NEAR(a, b, 1e-4f * std::max(1.0f, std::abs(b))) << "point " << i;
+      }
+    }
+    uint32_t rgb, expected_rgb;
+    std::memcpy(&rgb, &xyz[4 * i + 3], sizeof(rgb));
+    std::memcpy(&expected_rgb, &expected_xyz[4 * i + 3], sizeof(expected_rgb));
+    EXPECT_EQ(rgb, expected_rgb) << "point " << i;
+  }
+}
+
+TEST(StereoProcessor, parallelMonoMatchesSequential)
+{
+  cv::Mat left, right;
+  rectifiedPair(320, 240, left, right);
+  const auto model = stereoModel(320, 240);
+  const auto left_msg = imageMessage(left);
+  const auto right_msg = imageMessage(right);
+  const int flags = StereoProcessor::LEFT_RECT | StereoProcessor::RIGHT_RECT |
+    StereoProcessor::DISPARITY | StereoProcessor::POINT_CLOUD2;
+
+  StereoProcessor sequential;
+  sequential.setDisparityRange(32);
+  stereo_image_proc::StereoImageSet expected;
+  ASSERT_TRUE(sequential.process(left_msg, right_msg, model, expected, flags));
+
+  StereoProcessor parallel;
+  parallel.setDisparityRange(32);
+  parallel.setParallelMono(true);
+  // Without and with an arena, twice so that the arena buffers are reused
+  stereo_image_proc::StereoFrameArena arena;
+  for (int run = 0; run < 3; ++run) {
+    stereo_image_proc::StereoImageSet output;
+    ASSERT_TRUE(
+      run == 0 ?
+      parallel.process(left_msg, right_msg, model, output, flags) :
+      parallel.process(left_msg, right_msg, model, output, arena, flags));
+
+    EXPECT_EQ(cv::norm(output.left.rect, expected.left.rect, cv::NORM_INF), 0.0);
+    EXPECT_EQ(cv::norm(output.right.rect, expected.right.rect, cv::NORM_INF), 0.0);
+    EXPECT_EQ(output.disparity.image.data, expected.disparity.image.data);
+    EXPECT_EQ(output.points2.data, expected.points2.data);
+  }
+}
+
+TEST(StereoProcessor, fusedPostFilterMatchesSpeckleFilter)
+{
+  cv::Mat left, right;
+  aloePair(left, right);
+  ASSERT_FALSE(left.empty());
+  ASSERT_FALSE(right.empty());
+  const auto model = stereoModel(left.cols, left.rows);
+
+  for (auto type : {StereoProcessor::BM, StereoProcessor::SGBM}) {
+    for (bool fixed_point : {false, true}) {
+      SCOPED_TRACE(std::string(type == StereoProcessor::BM ? "BM" : "SGBM") +
+        (fixed_point ? ", fixed point" : ", float"));
+
+      StereoProcessor builtin;
+      configureSpeckleFilter(builtin, type, fixed_point);
+      stereo_msgs::msg::DisparityImage expected;
+      builtin.processDisparity(left, right, model, expected);
+
+      StereoProcessor fused;
+      configureSpeckleFilter(fused, type, fixed_point);
+      fused.setFusedPostFilter(true);
+      stereo_msgs::msg::DisparityImage disparity;
+      fused.processDisparity(left, right, model, disparity);
+
+      ASSERT_EQ(disparity.image.encoding, expected.image.encoding);
+      ASSERT_EQ(disparity.image.data.size(), expected.image.data.size());
+      if (fixed_point) {
+        EXPECT_EQ(disparity.image.data, expected.image.data);
+      } else {
+        // Scaled in float rather than double
+        const cv::Mat actual_mat(
+          disparity.image.height, disparity.image.width, CV_32FC1,
+          disparity.image.data.data(), disparity.image.step);
+        const cv::Mat expected_mat(
+          expected.image.height, expected.image.width, CV_32FC1,
+          expected.image.data.data(), expected.image.step);
+        EXPECT_LE(cv::norm(actual_mat, expected_mat, cv::NORM_INF), 1e-4);
+      }
+    }
+  }
+}
+
+TEST(StereoProcessor, leftRightCheckOnlyInvalidates)
+{
+  cv::Mat left, right;
+  aloePair(left, right);
+  ASSERT_FALSE(left.empty());
+  ASSERT_FALSE(right.empty());
+  const auto model = stereoModel(left.cols, left.rows);
+
+  StereoProcessor processor;
+  configureSpeckleFilter(processor, StereoProcessor::SGBM, true);
+  processor.setFusedPostFilter(true);
+  stereo_msgs::msg::DisparityImage disparity;
+  processor.processDisparity(left, right, model, disparity);
+  const cv::Mat_<int16_t> unchecked = disparity16(disparity);
+
+  processor.setLeftRightCheck(true);
+  processor.processDisparity(left, right, model, disparity);
+  const cv::Mat_<int16_t> checked = disparity16(disparity);
+
+  // One pixel below the minimum disparity, the principal points being aligned
+  const int16_t invalid = static_cast<int16_t>((processor.getMinDisparity() - 1) * 16);
+  int invalidated = 0;
+  for (int y = 0; y < checked.rows; ++y) {
+    for (int x = 0; x < checked.cols; ++x) {
+      if (checked(y, x) != unchecked(y, x)) {
+        ASSERT_EQ(checked(y, x), invalid) << "at (" << x << ", " << y << ")";
+        ++invalidated;
+      }
+    }
+  }
+  // The occlusions of the aloe leaves
+  EXPECT_GT(invalidated, 0);
+}
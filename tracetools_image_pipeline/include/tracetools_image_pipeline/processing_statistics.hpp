@@ -0,0 +1,107 @@
+// Copyright 2026, image_pipeline contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef TRACETOOLS_IMAGE_PIPELINE__PROCESSING_STATISTICS_HPP_
+#define TRACETOOLS_IMAGE_PIPELINE__PROCESSING_STATISTICS_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include "tracetools_image_pipeline/visibility_control.hpp"
+
+namespace tracetools_image_pipeline
+{
+
+/// Log-linear histogram of durations, for ProcessingStatistics.
+class TRACETOOLS_PUBLIC DurationHistogram
+{
+public:
+  struct Distribution
+  {
+    // Upper bounds of the buckets holding the percentiles, and the exact
+    // maximum, in seconds
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+  };
+
+  static constexpr size_t kBuckets = 112;
+
+  DurationHistogram();
+
+  void add(std::chrono::nanoseconds value);
+
+  /// Empty the histogram into distribution, return the number of values.
+  uint64_t collect(Distribution & distribution);
+
+private:
+  std::array<std::atomic<uint64_t>, kBuckets> counts_;
+  std::atomic<int64_t> max_;
+};
+
+/// Always-on latency and throughput statistics of a processing node.
+/**
+ * The callback latency and the input-to-publish age of every published frame
+ * go into log-linear histograms (four buckets per power of two of
+ * microseconds, so percentiles are within 25%), next to counters of dropped
+ * and skipped frames. Recording is wait-free and may happen from any number
+ * of threads; collect() summarizes and resets the window, and must only be
+ * called from one thread at a time, typically a diagnostics timer.
+ */
+class TRACETOOLS_PUBLIC ProcessingStatistics
+{
+public:
+  using Distribution = DurationHistogram::Distribution;
+
+  struct Summary
+  {
+    // Frames published, dropped because the node was behind, and skipped
+    // (not published for any other reason) during the window
+    uint64_t published = 0;
+    uint64_t dropped = 0;
+    uint64_t skipped = 0;
+    // Length of the window in seconds, and published frames per second
+    double period = 0.0;
+    double rate = 0.0;
+    Distribution latency;
+    Distribution age;
+  };
+
+  ProcessingStatistics();
+
+  /// Record a published frame. Negative ages (clock skew) count as zero.
+  void record(std::chrono::nanoseconds latency, std::chrono::nanoseconds age);
+
+  void drop();
+
+  void skip();
+
+  Summary collect();
+
+private:
+  DurationHistogram latency_;
+  DurationHistogram age_;
+  std::atomic<uint64_t> dropped_;
+  std::atomic<uint64_t> skipped_;
+  std::chrono::steady_clock::time_point window_start_;
+};
+
+}  // namespace tracetools_image_pipeline
+
+#endif  // TRACETOOLS_IMAGE_PIPELINE__PROCESSING_STATISTICS_HPP_
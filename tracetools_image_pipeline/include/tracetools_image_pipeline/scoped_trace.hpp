@@ -0,0 +1,86 @@
+// Copyright 2026, image_pipeline contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRACETOOLS_IMAGE_PIPELINE__SCOPED_TRACE_HPP_
+#define TRACETOOLS_IMAGE_PIPELINE__SCOPED_TRACE_HPP_
+
+#include <stdint.h>
+
+#include "tracetools_image_pipeline/tracetools.h"
+
+namespace tracetools_image_pipeline
+{
+
+/// Traces a component callback, from construction to destruction.
+/**
+ * Calls `image_pipeline_component_init` when constructed and
+ * `image_pipeline_component_fini` when destroyed, so every return of the
+ * callback is covered.
+ */
+class ComponentTrace
+{
+public:
+  ComponentTrace(
+    const void * node, const char * component, const void * image_msg,
+    uint32_t width, uint32_t height, const char * encoding)
+  : node_(node), component_(component), image_msg_(image_msg)
+  {
+    // Unused when tracing is disabled
+    (void)width;
+    (void)height;
+    (void)encoding;
+    TRACEPOINT(image_pipeline_component_init, node, component, image_msg, width, height, encoding);
+  }
+
+  ~ComponentTrace()
+  {
+    TRACEPOINT(image_pipeline_component_fini, node_, component_, image_msg_);
+  }
+
+  ComponentTrace(const ComponentTrace &) = delete;
+  ComponentTrace & operator=(const ComponentTrace &) = delete;
+
+private:
+  const void * node_;
+  const char * component_;
+  const void * image_msg_;
+};
+
+/// Traces a stage of a component callback, from construction to destruction.
+class StageTrace
+{
+public:
+  StageTrace(const void * node, const char * stage, const void * image_msg)
+  : node_(node), stage_(stage), image_msg_(image_msg)
+  {
+    TRACEPOINT(image_pipeline_stage_init, node, stage, image_msg);
+  }
+
+  ~StageTrace()
+  {
+    TRACEPOINT(image_pipeline_stage_fini, node_, stage_, image_msg_);
+  }
+
+  StageTrace(const StageTrace &) = delete;
+  StageTrace & operator=(const StageTrace &) = delete;
+
+private:
+  const void * node_;
+  const char * stage_;
+  const void * image_msg_;
+};
+
+}  // namespace tracetools_image_pipeline
+
+#endif  // TRACETOOLS_IMAGE_PIPELINE__SCOPED_TRACE_HPP_
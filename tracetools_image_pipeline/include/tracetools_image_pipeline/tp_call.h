@@ -98,6 +98,74 @@ TRACEPOINT_EVENT(
   )
 )
 
+// Start of the callback of any component, with the input image
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  image_pipeline_component_init,
+  TP_ARGS(
+    const void *, node_arg,
+    const char *, component_arg,
+    const void *, image_msg_arg,
+    uint32_t, width_arg,
+    uint32_t, height_arg,
+    const char *, encoding_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, node, node_arg)
+    ctf_string(component, component_arg)
+    ctf_integer_hex(const void *, image_msg, image_msg_arg)
+    ctf_integer(uint32_t, width, width_arg)
+    ctf_integer(uint32_t, height, height_arg)
+    ctf_string(encoding, encoding_arg)
+    ctf_string(version, tracetools_image_pipeline_VERSION)
+  )
+)
+// End of the callback of any component (after publication)
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  image_pipeline_component_fini,
+  TP_ARGS(
+    const void *, node_arg,
+    const char *, component_arg,
+    const void *, image_msg_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, node, node_arg)
+    ctf_string(component, component_arg)
+    ctf_integer_hex(const void *, image_msg, image_msg_arg)
+    ctf_string(version, tracetools_image_pipeline_VERSION)
+  )
+)
+
+// Start of a stage (convert, compute, publish) of a component callback
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  image_pipeline_stage_init,
+  TP_ARGS(
+    const void *, node_arg,
+    const char *, stage_arg,
+    const void *, image_msg_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, node, node_arg)
+    ctf_string(stage, stage_arg)
+    ctf_integer_hex(const void *, image_msg, image_msg_arg)
+    ctf_string(version, tracetools_image_pipeline_VERSION)
+  )
+)
+// End of a stage of a component callback
+TRACEPOINT_EVENT(
+  TRACEPOINT_PROVIDER,
+  image_pipeline_stage_fini,
+  TP_ARGS(
+    const void *, node_arg,
+    const char *, stage_arg,
+    const void *, image_msg_arg),
+  TP_FIELDS(
+    ctf_integer_hex(const void *, node, node_arg)
+    ctf_string(stage, stage_arg)
+    ctf_integer_hex(const void *, image_msg, image_msg_arg)
+    ctf_string(version, tracetools_image_pipeline_VERSION)
+  )
+)
+
 #endif  // _TRACETOOLS_IMAGE_PIPELINE__TP_CALL_H_
 
 #include <lttng/tracepoint-event.h>
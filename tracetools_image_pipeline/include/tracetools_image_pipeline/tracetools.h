@@ -123,6 +123,76 @@ DECLARE_TRACEPOINT(
   const void * rectify_image_msg,
   const void * rectify_info_msg)
 
+/// `image_pipeline_component_init`
+/**
+ * Tracepoint while initiating the callback of any image_pipeline component
+ *
+ * Notes the `tracetools_image_pipeline` version automatically.
+ *
+ * \param[in] node rclcpp::node::Node subject to the callback
+ * \param[in] component name of the component, e.g. "image_proc/debayer"
+ * \param[in] image_msg input ROS message of the callback
+ * \param[in] width width of the input image
+ * \param[in] height height of the input image
+ * \param[in] encoding encoding of the input image
+ */
+DECLARE_TRACEPOINT(
+  image_pipeline_component_init,
+  const void * node,
+  const char * component,
+  const void * image_msg,
+  uint32_t width,
+  uint32_t height,
+  const char * encoding)
+
+/// `image_pipeline_component_fini`
+/**
+ * Tracepoint while finishing the callback of any image_pipeline component
+ *
+ * Notes the `tracetools_image_pipeline` version automatically.
+ *
+ * \param[in] node rclcpp::node::Node subject to the callback
+ * \param[in] component name of the component, as in the init tracepoint
+ * \param[in] image_msg input ROS message of the callback
+ */
+DECLARE_TRACEPOINT(
+  image_pipeline_component_fini,
+  const void * node,
+  const char * component,
+  const void * image_msg)
+
+/// `image_pipeline_stage_init`
+/**
+ * Tracepoint while starting a stage of the callback of a component
+ *
+ * Notes the `tracetools_image_pipeline` version automatically.
+ *
+ * \param[in] node rclcpp::node::Node subject to the callback
+ * \param[in] stage name of the stage: "convert", "compute" or "publish"
+ * \param[in] image_msg input ROS message of the callback
+ */
+DECLARE_TRACEPOINT(
+  image_pipeline_stage_init,
+  const void * node,
+  const char * stage,
+  const void * image_msg)
+
+/// `image_pipeline_stage_fini`
+/**
+ * Tracepoint while finishing a stage of the callback of a component
+ *
+ * Notes the `tracetools_image_pipeline` version automatically.
+ *
+ * \param[in] node rclcpp::node::Node subject to the callback
+ * \param[in] stage name of the stage, as in the init tracepoint
+ * \param[in] image_msg input ROS message of the callback
+ */
+DECLARE_TRACEPOINT(
+  image_pipeline_stage_fini,
+  const void * node,
+  const char * stage,
+  const void * image_msg)
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,145 @@
+// Copyright 2026, image_pipeline contributors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "tracetools_image_pipeline/processing_statistics.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace tracetools_image_pipeline
+{
+
+namespace
+{
+
+// Buckets 0 to 3 hold 0 to 3 us, then every power of two [2^k, 2^(k+1)) us
+// is split into four buckets of [(4 + s) << (k - 2), (5 + s) << (k - 2)).
+size_t bucketOf(uint64_t us, size_t buckets)
+{
+  if (us < 4) {
+    return static_cast<size_t>(us);
+  }
+  size_t k = 2;
+  while ((us >> (k + 1)) != 0) {
+    ++k;
+  }
+  const size_t sub = static_cast<size_t>(us >> (k - 2)) & 3u;
+  return std::min(4 * (k - 1) + sub, buckets - 1);
+}
+
+// Exclusive upper bound of a bucket, in microseconds
+uint64_t bucketEnd(size_t bucket)
+{
+  if (bucket < 4) {
+    return bucket + 1;
+  }
+  const size_t k = bucket / 4 + 1;
+  const uint64_t sub = bucket % 4;
+  return (5 + sub) << (k - 2);
+}
+
+}  // namespace
+
+constexpr size_t DurationHistogram::kBuckets;
+
+DurationHistogram::DurationHistogram()
+: max_(0)
+{
+  for (auto & count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+void DurationHistogram::add(std::chrono::nanoseconds value)
+{
+  const int64_t ns = std::max<int64_t>(value.count(), 0);
+  counts_[bucketOf(static_cast<uint64_t>(ns) / 1000, kBuckets)].fetch_add(
+    1, std::memory_order_relaxed);
+  int64_t max = max_.load(std::memory_order_relaxed);
+  while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t DurationHistogram::collect(Distribution & distribution)
+{
+  std::array<uint64_t, kBuckets> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    counts[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+    total += counts[i];
+  }
+  const double max = max_.exchange(0, std::memory_order_relaxed) * 1e-9;
+
+  distribution = Distribution();
+  if (total == 0) {
+    return 0;
+  }
+  // Smallest bucket holding at least the requested share of the values
+  const auto percentile = [&](double share) {
+      const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(share * total + 0.5), 1);
+      uint64_t seen = 0;
+      for (size_t i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+          // The last bucket also holds everything beyond it
+          return i + 1 < kBuckets ? std::min(bucketEnd(i) * 1e-6, max) : max;
+        }
+      }
+      return max;
+    };
+  distribution.p50 = percentile(0.5);
+  distribution.p99 = percentile(0.99);
+  distribution.max = max;
+  return total;
+}
+
+ProcessingStatistics::ProcessingStatistics()
+: dropped_(0), skipped_(0), window_start_(std::chrono::steady_clock::now())
+{
+}
+
+void ProcessingStatistics::record(
+  std::chrono::nanoseconds latency, std::chrono::nanoseconds age)
+{
+  latency_.add(latency);
+  age_.add(age);
+}
+
+void ProcessingStatistics::drop()
+{
+  dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ProcessingStatistics::skip()
+{
+  skipped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ProcessingStatistics::Summary ProcessingStatistics::collect()
+{
+  Summary summary;
+  const auto now = std::chrono::steady_clock::now();
+  summary.period = std::chrono::duration<double>(now - window_start_).count();
+  window_start_ = now;
+
+  summary.published = latency_.collect(summary.latency);
+  age_.collect(summary.age);
+  summary.dropped = dropped_.exchange(0, std::memory_order_relaxed);
+  summary.skipped = skipped_.exchange(0, std::memory_order_relaxed);
+  summary.rate = summary.period > 0.0 ? summary.published / summary.period : 0.0;
+  return summary;
+}
+
+}  // namespace tracetools_image_pipeline
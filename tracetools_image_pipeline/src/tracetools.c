@@ -94,6 +94,64 @@ void TRACEPOINT(
     rectify_info_msg_arg);
 }
 
+void TRACEPOINT(
+  image_pipeline_component_init,
+  const void * node_arg,
+  const char * component_arg,
+  const void * image_msg_arg,
+  uint32_t width_arg,
+  uint32_t height_arg,
+  const char * encoding_arg)
+{
+  CONDITIONAL_TP(
+    image_pipeline_component_init,
+    node_arg,
+    component_arg,
+    image_msg_arg,
+    width_arg,
+    height_arg,
+    encoding_arg);
+}
+
+void TRACEPOINT(
+  image_pipeline_component_fini,
+  const void * node_arg,
+  const char * component_arg,
+  const void * image_msg_arg)
+{
+  CONDITIONAL_TP(
+    image_pipeline_component_fini,
+    node_arg,
+    component_arg,
+    image_msg_arg);
+}
+
+void TRACEPOINT(
+  image_pipeline_stage_init,
+  const void * node_arg,
+  const char * stage_arg,
+  const void * image_msg_arg)
+{
+  CONDITIONAL_TP(
+    image_pipeline_stage_init,
+    node_arg,
+    stage_arg,
+    image_msg_arg);
+}
+
+void TRACEPOINT(
+  image_pipeline_stage_fini,
+  const void * node_arg,
+  const char * stage_arg,
+  const void * image_msg_arg)
+{
+  CONDITIONAL_TP(
+    image_pipeline_stage_fini,
+    node_arg,
+    stage_arg,
+    image_msg_arg);
+}
+
 #ifndef _WIN32
 # pragma GCC diagnostic pop
 #else